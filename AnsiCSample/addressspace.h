@@ -79,6 +79,7 @@ typedef struct{
 
 typedef union 
 {
+    OpcUa_Void*              Array;
     OpcUa_UInt32*            UInt32Array;
     OpcUa_Double*            DoubleArray;
     OpcUa_StringA*           StringArray;
@@ -147,6 +148,23 @@ typedef struct{
 }_VariableKnoten_;
 
 
+/* the node arrays the services work on: the ones compiled into the server or the views of a mapped image */
+typedef struct{
+	_ObjectTypeKnoten_*		ObjectTypes;
+	OpcUa_Int				NoOfObjectTypes;
+	_ObjectKnoten_*			Objects;
+	OpcUa_Int				NoOfObjects;
+	_ReferenceTypeKnoten_*	ReferenceTypes;
+	OpcUa_Int				NoOfReferenceTypes;
+	_VariableKnoten_*		Variables;
+	OpcUa_Int				NoOfVariables;
+	_VariableTypeKnoten_*	VariableTypes;
+	OpcUa_Int				NoOfVariableTypes;
+	_DataTypeKnoten_*		DataTypes;
+	OpcUa_Int				NoOfDataTypes;
+}_AddressSpaceTables_;
+
+
 
 
 #endif/*_my_addressspace*/
\ No newline at end of file
@@ -0,0 +1,648 @@
+/* ========================================================================
+ * Copyright (c) 2005-2016 The OPC Foundation, Inc. All rights reserved.
+ *
+ * OPC Foundation MIT License 1.00
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * The complete license agreement can be found here:
+ * http://opcfoundation.org/License/MIT/1.00/
+ * ======================================================================*/
+
+/* serverstub (basic includes for implementing a server based on the stack) */
+#include <opcua_serverstub.h>
+#include <opcua_memory.h>
+
+#include <stdio.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "addressspace.h"
+#include "addressspace_image.h"
+
+
+/* the mapped image and the node views built on top of it */
+static OpcUa_Void*			image_base			= OpcUa_Null;
+static OpcUa_UInt32			image_size			= 0;
+static _AddressSpaceTables_	image_tables;
+static _ReferenceNode_*		image_references	= OpcUa_Null;
+
+
+/*============================================================================
+ * compiling: the address space is emitted twice, first with no buffers to
+ * get the sizes, then into the image.
+ *===========================================================================*/
+typedef struct
+{
+	_ImageNode_*		pNodes;				/* OpcUa_Null while counting */
+	_ImageReference_*	pReferences;		/* OpcUa_Null while counting */
+	OpcUa_CharA*		pStrings;			/* OpcUa_Null while counting */
+	OpcUa_UInt32		uNoOfNodes;
+	OpcUa_UInt32		uNoOfReferences;
+	OpcUa_UInt32		uStringsLength;
+	OpcUa_StringA		sLastUri;			/* the namespace uri repeats for nearly every reference */
+	OpcUa_UInt32		uLastUri;
+}_ImageBuilder_;
+
+static OpcUa_UInt32 image_add_string(_ImageBuilder_* pBuilder, OpcUa_StringA sString)
+{
+	OpcUa_UInt32 uOffset = pBuilder->uStringsLength;
+	OpcUa_UInt32 uLength;
+
+	if(sString==OpcUa_Null)
+		return ADDRESSSPACE_IMAGE_NO_STRING;
+
+	uLength=OpcUa_StrLenA(sString)+1;
+	if(pBuilder->pStrings!=OpcUa_Null)
+		OpcUa_MemCpy(pBuilder->pStrings+uOffset,uLength,sString,uLength);
+	pBuilder->uStringsLength+=uLength;
+	return uOffset;
+}
+
+static OpcUa_StatusCode image_nodeid(const OpcUa_NodeId* pNodeId, _ImageNodeId_* pImageNodeId)
+{
+	if(pNodeId->IdentifierType!=OpcUa_IdentifierType_Numeric)
+		return OpcUa_BadNotSupported;
+
+	pImageNodeId->NamespaceIndex=pNodeId->NamespaceIndex;
+	pImageNodeId->Reserved=0;
+	pImageNodeId->Identifier=pNodeId->Identifier.Numeric;
+	return OpcUa_Good;
+}
+
+/* emits the common attributes and the references of a node; *ppNode receives the record for the node class specific attributes */
+static OpcUa_StatusCode image_add_node(_ImageBuilder_* pBuilder, const _BaseAttribute_* pBase, _ImageNode_* pScratch, _ImageNode_** ppNode)
+{
+	_ImageNode_*		pNode = (pBuilder->pNodes!=OpcUa_Null)?&pBuilder->pNodes[pBuilder->uNoOfNodes]:pScratch;
+	_ImageReference_	ScratchReference;
+	_ImageReference_*	pReference;
+	_ReferenceNode_*	pSource;
+	OpcUa_Int32			i;
+
+	OpcUa_InitializeStatus(OpcUa_Module_Server, "image_add_node");
+
+	OpcUa_MemSet(pNode,0,sizeof(_ImageNode_));
+	uStatus=image_nodeid(&pBase->NodeId,&pNode->NodeId);
+	OpcUa_GotoErrorIfBad(uStatus);
+	pNode->NodeClass			=(OpcUa_UInt32)pBase->NodeClass;
+	pNode->BrowseName			=image_add_string(pBuilder,pBase->BrowseName);
+	pNode->DisplayName			=image_add_string(pBuilder,pBase->DisplayName);
+	pNode->FirstReference		=pBuilder->uNoOfReferences;
+	pNode->NoOfReferences		=(pBase->NoOfReferences>0)?(OpcUa_UInt32)pBase->NoOfReferences:0;
+	pNode->ValueIndex			=-1;
+	pNode->InverseName_text		=ADDRESSSPACE_IMAGE_NO_STRING;
+	pNode->InverseName_locale	=ADDRESSSPACE_IMAGE_NO_STRING;
+
+	for(i=0;i<pBase->NoOfReferences;i++)
+	{
+		pSource=pBase->References+i;
+		pReference=(pBuilder->pReferences!=OpcUa_Null)?&pBuilder->pReferences[pBuilder->uNoOfReferences]:&ScratchReference;
+
+		uStatus=image_nodeid(&pSource->ReferenceTypeId,&pReference->ReferenceTypeId);
+		OpcUa_GotoErrorIfBad(uStatus);
+		uStatus=image_nodeid(&pSource->Target_NodeId,&pReference->Target_NodeId);
+		OpcUa_GotoErrorIfBad(uStatus);
+		pReference->IsInverse=(pSource->IsInverse!=OpcUa_False);
+
+		if(pSource->Target_NamespaceUri!=OpcUa_Null && pBuilder->sLastUri!=OpcUa_Null && OpcUa_StrCmpA(pSource->Target_NamespaceUri,pBuilder->sLastUri)==0)
+		{
+			pReference->Target_NamespaceUri=pBuilder->uLastUri;
+		}
+		else
+		{
+			pReference->Target_NamespaceUri=image_add_string(pBuilder,pSource->Target_NamespaceUri);
+			pBuilder->sLastUri=pSource->Target_NamespaceUri;
+			pBuilder->uLastUri=pReference->Target_NamespaceUri;
+		}
+		pBuilder->uNoOfReferences++;
+	}
+	pBuilder->uNoOfNodes++;
+	*ppNode=pNode;
+
+	OpcUa_ReturnStatusCode;
+	OpcUa_BeginErrorHandling;
+	OpcUa_FinishErrorHandling;
+}
+
+static OpcUa_StatusCode image_add_tables(_ImageBuilder_* pBuilder, const _AddressSpaceTables_* pTables)
+{
+	_ImageNode_		Scratch;
+	_ImageNode_*	pNode;
+	OpcUa_Int		i;
+
+	OpcUa_InitializeStatus(OpcUa_Module_Server, "image_add_tables");
+
+	for(i=0;i<pTables->NoOfObjectTypes;i++)
+	{
+		uStatus=image_add_node(pBuilder,&pTables->ObjectTypes[i].BaseAttribute,&Scratch,&pNode);
+		OpcUa_GotoErrorIfBad(uStatus);
+		pNode->IsAbstract=pTables->ObjectTypes[i].IsAbstract;
+	}
+	for(i=0;i<pTables->NoOfObjects;i++)
+	{
+		uStatus=image_add_node(pBuilder,&pTables->Objects[i].BaseAttribute,&Scratch,&pNode);
+		OpcUa_GotoErrorIfBad(uStatus);
+		pNode->EventNotifier=pTables->Objects[i].EventNotifier;
+	}
+	for(i=0;i<pTables->NoOfReferenceTypes;i++)
+	{
+		uStatus=image_add_node(pBuilder,&pTables->ReferenceTypes[i].BaseAttribute,&Scratch,&pNode);
+		OpcUa_GotoErrorIfBad(uStatus);
+		pNode->IsAbstract			=pTables->ReferenceTypes[i].IsAbstract;
+		pNode->Symmetric			=pTables->ReferenceTypes[i].Symmetric;
+		pNode->InverseName_text		=image_add_string(pBuilder,pTables->ReferenceTypes[i].InverseName_text);
+		pNode->InverseName_locale	=image_add_string(pBuilder,pTables->ReferenceTypes[i].InverseName_locale);
+	}
+	for(i=0;i<pTables->NoOfVariables;i++)
+	{
+		uStatus=image_add_node(pBuilder,&pTables->Variables[i].BaseAttribute,&Scratch,&pNode);
+		OpcUa_GotoErrorIfBad(uStatus);
+		uStatus=image_nodeid(&pTables->Variables[i].DataType,&pNode->DataType);
+		OpcUa_GotoErrorIfBad(uStatus);
+		pNode->ValueIndex			=pTables->Variables[i].ValueIndex;
+		pNode->ValueRank			=pTables->Variables[i].ValueRank;
+		pNode->NoOfArrayDimensions	=pTables->Variables[i].NoOfArrayDimensions;
+		pNode->ArrayDimensions		=pTables->Variables[i].ArrayDimensions;
+		pNode->AccessLevel			=pTables->Variables[i].AccessLevel;
+		pNode->UserAccessLevel		=pTables->Variables[i].UserAccessLevel;
+		pNode->Historizing			=pTables->Variables[i].Historizing;
+	}
+	for(i=0;i<pTables->NoOfVariableTypes;i++)
+	{
+		uStatus=image_add_node(pBuilder,&pTables->VariableTypes[i].BaseAttribute,&Scratch,&pNode);
+		OpcUa_GotoErrorIfBad(uStatus);
+		uStatus=image_nodeid(&pTables->VariableTypes[i].DataType,&pNode->DataType);
+		OpcUa_GotoErrorIfBad(uStatus);
+		pNode->ValueIndex			=pTables->VariableTypes[i].ValueIndex;
+		pNode->ValueRank			=pTables->VariableTypes[i].ValueRank;
+		pNode->NoOfArrayDimensions	=pTables->VariableTypes[i].NoOfArrayDimensions;
+		pNode->ArrayDimensions		=pTables->VariableTypes[i].ArrayDimensions;
+		pNode->IsAbstract			=pTables->VariableTypes[i].IsAbstract;
+	}
+	for(i=0;i<pTables->NoOfDataTypes;i++)
+	{
+		uStatus=image_add_node(pBuilder,&pTables->DataTypes[i].BaseAttribute,&Scratch,&pNode);
+		OpcUa_GotoErrorIfBad(uStatus);
+		pNode->IsAbstract=pTables->DataTypes[i].IsAbstract;
+	}
+
+	OpcUa_ReturnStatusCode;
+	OpcUa_BeginErrorHandling;
+	OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * writes the address space described by pTables as image to sFileName.
+ *===========================================================================*/
+OpcUa_StatusCode compile_addressspace_image(const _AddressSpaceTables_* pTables, OpcUa_StringA sFileName)
+{
+	_ImageBuilder_		Builder;
+	_ImageHeader_*		pHeader;
+	OpcUa_Byte*			pImage		= OpcUa_Null;
+	FILE*				pFile		= OpcUa_Null;
+	OpcUa_UInt32		uReferencesOffset;
+	OpcUa_UInt32		uStringsOffset;
+	OpcUa_UInt32		uSize;
+
+	OpcUa_InitializeStatus(OpcUa_Module_Server, "compile_addressspace_image");
+
+	OpcUa_ReturnErrorIfArgumentNull(pTables);
+	OpcUa_ReturnErrorIfArgumentNull(sFileName);
+
+	/* sizes */
+	OpcUa_MemSet(&Builder,0,sizeof(_ImageBuilder_));
+	uStatus=image_add_tables(&Builder,pTables);
+	OpcUa_GotoErrorIfBad(uStatus);
+
+	uReferencesOffset	=sizeof(_ImageHeader_)+Builder.uNoOfNodes*sizeof(_ImageNode_);
+	uStringsOffset		=uReferencesOffset+Builder.uNoOfReferences*sizeof(_ImageReference_);
+	uSize				=uStringsOffset+Builder.uStringsLength;
+
+	pImage=(OpcUa_Byte*)OpcUa_Alloc(uSize);
+	OpcUa_GotoErrorIfAllocFailed(pImage);
+	OpcUa_MemSet(pImage,0,uSize);
+
+	pHeader=(_ImageHeader_*)pImage;
+	pHeader->Magic				=ADDRESSSPACE_IMAGE_MAGIC;
+	pHeader->Version			=ADDRESSSPACE_IMAGE_VERSION;
+	pHeader->Size				=uSize;
+	pHeader->NoOfNodes			=Builder.uNoOfNodes;
+	pHeader->NodesOffset		=sizeof(_ImageHeader_);
+	pHeader->NoOfReferences		=Builder.uNoOfReferences;
+	pHeader->ReferencesOffset	=uReferencesOffset;
+	pHeader->StringsOffset		=uStringsOffset;
+	pHeader->StringsLength		=Builder.uStringsLength;
+
+	/* contents */
+	OpcUa_MemSet(&Builder,0,sizeof(_ImageBuilder_));
+	Builder.pNodes		=(_ImageNode_*)(pImage+pHeader->NodesOffset);
+	Builder.pReferences	=(_ImageReference_*)(pImage+uReferencesOffset);
+	Builder.pStrings	=(OpcUa_CharA*)(pImage+uStringsOffset);
+	uStatus=image_add_tables(&Builder,pTables);
+	OpcUa_GotoErrorIfBad(uStatus);
+
+	pFile=fopen(sFileName,"wb");
+	if(pFile==OpcUa_Null)
+	{
+		OpcUa_GotoErrorWithStatus(OpcUa_BadNotWritable);
+	}
+	if(fwrite(pImage,1,uSize,pFile)!=uSize)
+	{
+		OpcUa_GotoErrorWithStatus(OpcUa_BadNotWritable);
+	}
+	if(fclose(pFile)!=0)
+	{
+		pFile=OpcUa_Null;
+		OpcUa_GotoErrorWithStatus(OpcUa_BadNotWritable);
+	}
+
+	OpcUa_Free(pImage);
+
+	OpcUa_ReturnStatusCode;
+	OpcUa_BeginErrorHandling;
+
+	if(pFile!=OpcUa_Null)
+	{
+		fclose(pFile);
+	}
+	if(pImage!=OpcUa_Null)
+	{
+		OpcUa_Free(pImage);
+	}
+
+	OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * loading
+ *===========================================================================*/
+static OpcUa_StatusCode image_map_file(OpcUa_StringA sFileName)
+{
+#ifdef _WIN32
+	HANDLE		hFile;
+	HANDLE		hMapping;
+	DWORD		dwSizeHigh	= 0;
+	DWORD		dwSize;
+
+	hFile=CreateFileA(sFileName,GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
+	if(hFile==INVALID_HANDLE_VALUE)
+		return OpcUa_BadNotFound;
+
+	dwSize=GetFileSize(hFile,&dwSizeHigh);
+	if(dwSize==INVALID_FILE_SIZE || dwSizeHigh!=0 || dwSize<sizeof(_ImageHeader_))
+	{
+		CloseHandle(hFile);
+		return OpcUa_BadDecodingError;
+	}
+
+	hMapping=CreateFileMappingA(hFile,NULL,PAGE_READONLY,0,0,NULL);
+	CloseHandle(hFile);
+	if(hMapping==NULL)
+		return OpcUa_BadOutOfMemory;
+
+	/* the view keeps the mapping alive */
+	image_base=MapViewOfFile(hMapping,FILE_MAP_READ,0,0,0);
+	CloseHandle(hMapping);
+	if(image_base==NULL)
+	{
+		image_base=OpcUa_Null;
+		return OpcUa_BadOutOfMemory;
+	}
+	image_size=(OpcUa_UInt32)dwSize;
+#else
+	struct stat	FileStat;
+	void*		pMapping;
+	int			iFile;
+
+	iFile=open(sFileName,O_RDONLY);
+	if(iFile<0)
+		return OpcUa_BadNotFound;
+
+	if(fstat(iFile,&FileStat)!=0 || FileStat.st_size<(off_t)sizeof(_ImageHeader_) || (OpcUa_UInt64)FileStat.st_size>OpcUa_UInt32_Max)
+	{
+		close(iFile);
+		return OpcUa_BadDecodingError;
+	}
+
+	pMapping=mmap(NULL,(size_t)FileStat.st_size,PROT_READ,MAP_SHARED,iFile,0);
+	close(iFile);
+	if(pMapping==MAP_FAILED)
+		return OpcUa_BadOutOfMemory;
+
+	image_base=pMapping;
+	image_size=(OpcUa_UInt32)FileStat.st_size;
+#endif
+	return OpcUa_Good;
+}
+
+static OpcUa_Boolean image_string_is_valid(const _ImageHeader_* pHeader, OpcUa_UInt32 uOffset)
+{
+	return (OpcUa_Boolean)(uOffset==ADDRESSSPACE_IMAGE_NO_STRING || uOffset<pHeader->StringsLength);
+}
+
+/* the image comes from a file: check every count, offset and index before anything is built on it */
+static OpcUa_StatusCode image_check(OpcUa_Void)
+{
+	const _ImageHeader_*	pHeader = (const _ImageHeader_*)image_base;
+	const _ImageNode_*		pNodes;
+	const _ImageReference_*	pReferences;
+	const OpcUa_CharA*		pStrings;
+	OpcUa_UInt32			i;
+
+	if(		pHeader->Magic!=ADDRESSSPACE_IMAGE_MAGIC
+		||	pHeader->Version!=ADDRESSSPACE_IMAGE_VERSION
+		||	pHeader->Size!=image_size)
+	{
+		return OpcUa_BadDecodingError;
+	}
+
+	if(		pHeader->NodesOffset<sizeof(_ImageHeader_) || pHeader->NodesOffset%4!=0 || pHeader->NodesOffset>image_size
+		||	pHeader->NoOfNodes>(image_size-pHeader->NodesOffset)/sizeof(_ImageNode_)
+		||	pHeader->ReferencesOffset<sizeof(_ImageHeader_) || pHeader->ReferencesOffset%4!=0 || pHeader->ReferencesOffset>image_size
+		||	pHeader->NoOfReferences>(image_size-pHeader->ReferencesOffset)/sizeof(_ImageReference_)
+		||	pHeader->StringsOffset>image_size
+		||	pHeader->StringsLength>image_size-pHeader->StringsOffset)
+	{
+		return OpcUa_BadDecodingError;
+	}
+
+	/* every string ends inside the pool */
+	pStrings=(const OpcUa_CharA*)image_base+pHeader->StringsOffset;
+	if(pHeader->StringsLength>0 && pStrings[pHeader->StringsLength-1]!='\0')
+		return OpcUa_BadDecodingError;
+
+	pNodes=(const _ImageNode_*)((const OpcUa_Byte*)image_base+pHeader->NodesOffset);
+	for(i=0;i<pHeader->NoOfNodes;i++)
+	{
+		switch(pNodes[i].NodeClass)
+		{
+		case OpcUa_NodeClass_ObjectType:
+		case OpcUa_NodeClass_Object:
+		case OpcUa_NodeClass_ReferenceType:
+		case OpcUa_NodeClass_Variable:
+		case OpcUa_NodeClass_VariableType:
+		case OpcUa_NodeClass_DataType:
+			break;
+		default:
+			return OpcUa_BadDecodingError;
+		}
+		if(		pNodes[i].FirstReference>pHeader->NoOfReferences
+			||	pNodes[i].NoOfReferences>pHeader->NoOfReferences-pNodes[i].FirstReference
+			||	image_string_is_valid(pHeader,pNodes[i].BrowseName)==OpcUa_False
+			||	image_string_is_valid(pHeader,pNodes[i].DisplayName)==OpcUa_False
+			||	image_string_is_valid(pHeader,pNodes[i].InverseName_text)==OpcUa_False
+			||	image_string_is_valid(pHeader,pNodes[i].InverseName_locale)==OpcUa_False)
+		{
+			return OpcUa_BadDecodingError;
+		}
+	}
+
+	pReferences=(const _ImageReference_*)((const OpcUa_Byte*)image_base+pHeader->ReferencesOffset);
+	for(i=0;i<pHeader->NoOfReferences;i++)
+	{
+		if(image_string_is_valid(pHeader,pReferences[i].Target_NamespaceUri)==OpcUa_False)
+			return OpcUa_BadDecodingError;
+	}
+
+	return OpcUa_Good;
+}
+
+static OpcUa_Void image_nodeid_to_nodeid(const _ImageNodeId_* pImageNodeId, OpcUa_NodeId* pNodeId)
+{
+	OpcUa_NodeId_Initialize(pNodeId);
+	pNodeId->IdentifierType		=OpcUa_IdentifierType_Numeric;
+	pNodeId->NamespaceIndex		=pImageNodeId->NamespaceIndex;
+	pNodeId->Identifier.Numeric	=pImageNodeId->Identifier;
+}
+
+/* strings are used in place, the pages are shared with every other process mapping the image */
+static OpcUa_StringA image_string(const _ImageHeader_* pHeader, OpcUa_UInt32 uOffset)
+{
+	if(uOffset==ADDRESSSPACE_IMAGE_NO_STRING)
+		return OpcUa_Null;
+	return (OpcUa_StringA)((OpcUa_CharA*)image_base+pHeader->StringsOffset+uOffset);
+}
+
+static OpcUa_Void image_base_attribute(const _ImageHeader_* pHeader, const _ImageNode_* pNode, _BaseAttribute_* pBase)
+{
+	image_nodeid_to_nodeid(&pNode->NodeId,&pBase->NodeId);
+	pBase->NodeClass		=(OpcUa_NodeClass)pNode->NodeClass;
+	pBase->BrowseName		=image_string(pHeader,pNode->BrowseName);
+	pBase->DisplayName		=image_string(pHeader,pNode->DisplayName);
+	pBase->NoOfReferences	=(OpcUa_Int32)pNode->NoOfReferences;
+	pBase->References		=(pNode->NoOfReferences>0)?image_references+pNode->FirstReference:OpcUa_Null;
+}
+
+/*============================================================================
+ * maps the image sFileName and fills pTables with views on it. The services
+ * work on the typed node structures, so one array per node class and one for
+ * all references are allocated; the strings stay in the mapping.
+ *===========================================================================*/
+OpcUa_StatusCode map_addressspace_image(OpcUa_StringA sFileName, _AddressSpaceTables_* pTables)
+{
+	const _ImageHeader_*	pHeader;
+	const _ImageNode_*		pNodes;
+	const _ImageReference_*	pReferences;
+	OpcUa_UInt32			i;
+
+	OpcUa_InitializeStatus(OpcUa_Module_Server, "map_addressspace_image");
+
+	OpcUa_ReturnErrorIfArgumentNull(sFileName);
+	OpcUa_ReturnErrorIfArgumentNull(pTables);
+
+	unmap_addressspace_image();
+
+	uStatus=image_map_file(sFileName);
+	OpcUa_GotoErrorIfBad(uStatus);
+	uStatus=image_check();
+	OpcUa_GotoErrorIfBad(uStatus);
+
+	pHeader		=(const _ImageHeader_*)image_base;
+	pNodes		=(const _ImageNode_*)((const OpcUa_Byte*)image_base+pHeader->NodesOffset);
+	pReferences	=(const _ImageReference_*)((const OpcUa_Byte*)image_base+pHeader->ReferencesOffset);
+
+	/* references */
+	if(pHeader->NoOfReferences>0)
+	{
+		image_references=(_ReferenceNode_*)OpcUa_Alloc(pHeader->NoOfReferences*sizeof(_ReferenceNode_));
+		OpcUa_GotoErrorIfAllocFailed(image_references);
+	}
+	for(i=0;i<pHeader->NoOfReferences;i++)
+	{
+		image_nodeid_to_nodeid(&pReferences[i].ReferenceTypeId,&image_references[i].ReferenceTypeId);
+		image_nodeid_to_nodeid(&pReferences[i].Target_NodeId,&image_references[i].Target_NodeId);
+		image_references[i].IsInverse			=(OpcUa_Boolean)(pReferences[i].IsInverse!=0);
+		image_references[i].Target_NamespaceUri	=image_string(pHeader,pReferences[i].Target_NamespaceUri);
+	}
+
+	/* node arrays */
+	for(i=0;i<pHeader->NoOfNodes;i++)
+	{
+		switch(pNodes[i].NodeClass)
+		{
+		case OpcUa_NodeClass_ObjectType:	image_tables.NoOfObjectTypes++;		break;
+		case OpcUa_NodeClass_Object:		image_tables.NoOfObjects++;			break;
+		case OpcUa_NodeClass_ReferenceType:	image_tables.NoOfReferenceTypes++;	break;
+		case OpcUa_NodeClass_Variable:		image_tables.NoOfVariables++;		break;
+		case OpcUa_NodeClass_VariableType:	image_tables.NoOfVariableTypes++;	break;
+		default:							image_tables.NoOfDataTypes++;		break;
+		}
+	}
+
+#define IMAGE_ALLOC_NODES(xArray, xCount, xType)							\
+	if(image_tables.xCount>0)												\
+	{																		\
+		image_tables.xArray=(xType*)OpcUa_Alloc(image_tables.xCount*sizeof(xType));	\
+		OpcUa_GotoErrorIfAllocFailed(image_tables.xArray);					\
+	}
+
+	IMAGE_ALLOC_NODES(ObjectTypes,		NoOfObjectTypes,	_ObjectTypeKnoten_)
+	IMAGE_ALLOC_NODES(Objects,			NoOfObjects,		_ObjectKnoten_)
+	IMAGE_ALLOC_NODES(ReferenceTypes,	NoOfReferenceTypes,	_ReferenceTypeKnoten_)
+	IMAGE_ALLOC_NODES(Variables,		NoOfVariables,		_VariableKnoten_)
+	IMAGE_ALLOC_NODES(VariableTypes,	NoOfVariableTypes,	_VariableTypeKnoten_)
+	IMAGE_ALLOC_NODES(DataTypes,		NoOfDataTypes,		_DataTypeKnoten_)
+
+#undef IMAGE_ALLOC_NODES
+
+	image_tables.NoOfObjectTypes	=0;
+	image_tables.NoOfObjects		=0;
+	image_tables.NoOfReferenceTypes	=0;
+	image_tables.NoOfVariables		=0;
+	image_tables.NoOfVariableTypes	=0;
+	image_tables.NoOfDataTypes		=0;
+
+	for(i=0;i<pHeader->NoOfNodes;i++)
+	{
+		const _ImageNode_* pNode = &pNodes[i];
+
+		switch(pNode->NodeClass)
+		{
+		case OpcUa_NodeClass_ObjectType:
+			{
+				_ObjectTypeKnoten_* pObjectType = &image_tables.ObjectTypes[image_tables.NoOfObjectTypes++];
+				image_base_attribute(pHeader,pNode,&pObjectType->BaseAttribute);
+				pObjectType->IsAbstract=(OpcUa_Boolean)pNode->IsAbstract;
+				break;
+			}
+		case OpcUa_NodeClass_Object:
+			{
+				_ObjectKnoten_* pObject = &image_tables.Objects[image_tables.NoOfObjects++];
+				image_base_attribute(pHeader,pNode,&pObject->BaseAttribute);
+				pObject->EventNotifier=pNode->EventNotifier;
+				break;
+			}
+		case OpcUa_NodeClass_ReferenceType:
+			{
+				_ReferenceTypeKnoten_* pReferenceType = &image_tables.ReferenceTypes[image_tables.NoOfReferenceTypes++];
+				image_base_attribute(pHeader,pNode,&pReferenceType->BaseAttribute);
+				pReferenceType->IsAbstract			=(OpcUa_Boolean)pNode->IsAbstract;
+				pReferenceType->Symmetric			=(OpcUa_Boolean)pNode->Symmetric;
+				pReferenceType->InverseName_text	=image_string(pHeader,pNode->InverseName_text);
+				pReferenceType->InverseName_locale	=image_string(pHeader,pNode->InverseName_locale);
+				break;
+			}
+		case OpcUa_NodeClass_Variable:
+			{
+				_VariableKnoten_* pVariable = &image_tables.Variables[image_tables.NoOfVariables++];
+				image_base_attribute(pHeader,pNode,&pVariable->BaseAttribute);
+				image_nodeid_to_nodeid(&pNode->DataType,&pVariable->DataType);
+				pVariable->ValueIndex			=pNode->ValueIndex;
+				pVariable->ValueRank			=pNode->ValueRank;
+				pVariable->NoOfArrayDimensions	=pNode->NoOfArrayDimensions;
+				pVariable->ArrayDimensions		=pNode->ArrayDimensions;
+				pVariable->AccessLevel			=pNode->AccessLevel;
+				pVariable->UserAccessLevel		=pNode->UserAccessLevel;
+				pVariable->Historizing			=(OpcUa_Boolean)pNode->Historizing;
+				break;
+			}
+		case OpcUa_NodeClass_VariableType:
+			{
+				_VariableTypeKnoten_* pVariableType = &image_tables.VariableTypes[image_tables.NoOfVariableTypes++];
+				image_base_attribute(pHeader,pNode,&pVariableType->BaseAttribute);
+				image_nodeid_to_nodeid(&pNode->DataType,&pVariableType->DataType);
+				pVariableType->ValueIndex			=pNode->ValueIndex;
+				pVariableType->ValueRank			=pNode->ValueRank;
+				pVariableType->NoOfArrayDimensions	=pNode->NoOfArrayDimensions;
+				pVariableType->ArrayDimensions		=pNode->ArrayDimensions;
+				pVariableType->IsAbstract			=(OpcUa_Boolean)pNode->IsAbstract;
+				break;
+			}
+		default:
+			{
+				_DataTypeKnoten_* pDataType = &image_tables.DataTypes[image_tables.NoOfDataTypes++];
+				image_base_attribute(pHeader,pNode,&pDataType->BaseAttribute);
+				pDataType->IsAbstract=(OpcUa_Boolean)pNode->IsAbstract;
+				break;
+			}
+		}
+	}
+
+	*pTables=image_tables;
+
+	OpcUa_ReturnStatusCode;
+	OpcUa_BeginErrorHandling;
+
+	unmap_addressspace_image();
+
+	OpcUa_FinishErrorHandling;
+}
+
+OpcUa_Void unmap_addressspace_image(OpcUa_Void)
+{
+	if(image_tables.ObjectTypes!=OpcUa_Null)
+		OpcUa_Free(image_tables.ObjectTypes);
+	if(image_tables.Objects!=OpcUa_Null)
+		OpcUa_Free(image_tables.Objects);
+	if(image_tables.ReferenceTypes!=OpcUa_Null)
+		OpcUa_Free(image_tables.ReferenceTypes);
+	if(image_tables.Variables!=OpcUa_Null)
+		OpcUa_Free(image_tables.Variables);
+	if(image_tables.VariableTypes!=OpcUa_Null)
+		OpcUa_Free(image_tables.VariableTypes);
+	if(image_tables.DataTypes!=OpcUa_Null)
+		OpcUa_Free(image_tables.DataTypes);
+	OpcUa_MemSet(&image_tables,0,sizeof(_AddressSpaceTables_));
+
+	if(image_references!=OpcUa_Null)
+	{
+		OpcUa_Free(image_references);
+		image_references=OpcUa_Null;
+	}
+
+	if(image_base!=OpcUa_Null)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(image_base);
+#else
+		munmap(image_base,image_size);
+#endif
+		image_base=OpcUa_Null;
+		image_size=0;
+	}
+}
@@ -0,0 +1,109 @@
+/* ========================================================================
+ * Copyright (c) 2005-2016 The OPC Foundation, Inc. All rights reserved.
+ *
+ * OPC Foundation MIT License 1.00
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * The complete license agreement can be found here:
+ * http://opcfoundation.org/License/MIT/1.00/
+ * ======================================================================*/
+ 
+#ifndef _addressspace_image_
+#define _addressspace_image_
+
+#include "addressspace.h"
+
+/*============================================================================
+ * flat address space image.
+ * The image is written once from an address space (-compile) and mapped
+ * read-only at startup (-image). It contains no pointers: nodes refer to
+ * their references by index and to strings by offset into the string pool,
+ * so the same file can be mapped at any address and shared between servers.
+ *
+ *   _ImageHeader_ | _ImageNode_[NoOfNodes] | _ImageReference_[NoOfReferences] | strings
+ *
+ * Nodes are stored in the order ObjectTypes, Objects, ReferenceTypes,
+ * Variables, VariableTypes, DataTypes. Only numeric NodeIds are supported.
+ * The Value attributes are not part of the image; ValueIndex still refers
+ * to the value table of the server.
+ *===========================================================================*/
+#define ADDRESSSPACE_IMAGE_MAGIC		0x53414155u		/* "UAAS" */
+#define ADDRESSSPACE_IMAGE_VERSION		1
+#define ADDRESSSPACE_IMAGE_NO_STRING	0xFFFFFFFFu
+
+typedef struct{
+	OpcUa_UInt16		NamespaceIndex;
+	OpcUa_UInt16		Reserved;
+	OpcUa_UInt32		Identifier;
+}_ImageNodeId_;
+
+typedef struct{
+	OpcUa_UInt32		Magic;
+	OpcUa_UInt32		Version;
+	OpcUa_UInt32		Size;									/* size of the whole image in bytes */
+	OpcUa_UInt32		NoOfNodes;
+	OpcUa_UInt32		NodesOffset;
+	OpcUa_UInt32		NoOfReferences;
+	OpcUa_UInt32		ReferencesOffset;
+	OpcUa_UInt32		StringsOffset;
+	OpcUa_UInt32		StringsLength;
+}_ImageHeader_;
+
+typedef struct{
+	_ImageNodeId_		NodeId;
+	OpcUa_UInt32		NodeClass;
+	OpcUa_UInt32		BrowseName;								/* offset in the string pool */
+	OpcUa_UInt32		DisplayName;							/* offset in the string pool */
+	OpcUa_UInt32		FirstReference;
+	OpcUa_UInt32		NoOfReferences;
+	/* node class specific attributes */
+	OpcUa_Int32			ValueIndex;
+	_ImageNodeId_		DataType;
+	OpcUa_Int32			ValueRank;
+	OpcUa_Int32			NoOfArrayDimensions;
+	OpcUa_UInt32		ArrayDimensions;
+	OpcUa_UInt32		InverseName_text;						/* offset in the string pool */
+	OpcUa_UInt32		InverseName_locale;						/* offset in the string pool */
+	OpcUa_Byte			IsAbstract;
+	OpcUa_Byte			Symmetric;
+	OpcUa_Byte			EventNotifier;
+	OpcUa_Byte			AccessLevel;
+	OpcUa_Byte			UserAccessLevel;
+	OpcUa_Byte			Historizing;
+	OpcUa_Byte			Reserved[2];
+}_ImageNode_;
+
+typedef struct{
+	_ImageNodeId_		ReferenceTypeId;
+	_ImageNodeId_		Target_NodeId;
+	OpcUa_UInt32		Target_NamespaceUri;					/* offset in the string pool */
+	OpcUa_UInt32		IsInverse;
+}_ImageReference_;
+
+
+OpcUa_StatusCode		compile_addressspace_image		(const _AddressSpaceTables_* ,OpcUa_StringA );
+
+OpcUa_StatusCode		map_addressspace_image			(OpcUa_StringA ,_AddressSpaceTables_* );
+
+OpcUa_Void				unmap_addressspace_image		(OpcUa_Void);
+
+#endif /*_addressspace_image_*/
@@ -44,6 +44,14 @@
 #include <windows.h>
 #include <conio.h>
 #endif
+#ifdef __linux__
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/signalfd.h>
+#endif
 #include <stdio.h>
 
 /* serverstub (basic includes for implementing a server based on the stack) */
@@ -67,16 +75,18 @@
 
     /* my headers*/
 #include "addressspace.h"
+#include "addressspace_image.h"
 #include "browseservice.h"
 #include "mytrace.h"
 #include "readservice.h"
+#include "sessiontable.h"
+#include "subscriptionservice.h"
+#include "valuestore.h"
 #include "general_header.h"
 
 #define SESSION_NOT_ACTIVATED	0x80270000
 #define	SESSION_ACTIVATED		0x00000000
 
-#define RESET_SESSION_COUNTER	msec_counter=0;
-
 #define REVISED_SESSIONTIMEOUT  30000    
 
 
@@ -91,29 +101,12 @@
 char * UATESTSERVER_ENDPOINT_URL = "opc.tcp://localhost:4840";
 
 //SESSION DATEN  -----------------------------------------------
-OpcUa_UInt32		securechannelId;
-OpcUa_UInt32		session_flag;
-OpcUa_Double		session_timeout;
-OpcUa_String*		p_user_name;
-OpcUa_Timer         Timer;
-OpcUa_Double		msec_counter;
+OpcUa_Timer         Timer;								/* session timeouts and CurrentTime */
 OpcUa_StatusCode OPCUA_DLLCALL Timer_Callback(  OpcUa_Void*             pvCallbackData, 
                                                 OpcUa_Timer             hTimer,
                                                 OpcUa_UInt32            msecElapsed);
 //---------------------------------------------------------------
 
-//CONTINUATION POINT--------------------------------
- OpcUa_Int			Continuation_Point_Identifier;
- OpcUa_Int			Cont_Point_Counter;
- enum
- {
-	free_to_use=0,
-	occupied=1
-}continuation_point;
-
- OpcUa_UInt32		max_ref_per_node;
-//--------------------------------------------------
-
 //all_ValueAttribute_of_VariableTypeNodes_VariableNodes--------------------------------
 my_Variant			all_ValueAttribute_of_VariableTypeNodes_VariableNodes[ARRAYSIZE_OF_VALUEATTRIBUTE];
 //--------------------------------------------------------------------------------------
@@ -124,6 +117,13 @@ OpcUa_Boolean                               UaTestServer_g_gbStopServer
 OpcUa_UInt32                                UaTestServer_g_uiShutdownBlocked             = 0;                  
 
 OpcUa_Mutex                                 UaTestServer_g_hShutdownFlagMutex            = OpcUa_Null;
+OpcUa_Boolean                               UaTestServer_g_bDaemon                       = OpcUa_False;
+#ifdef _WIN32
+HANDLE                                      UaTestServer_g_hShutdownEvent                = NULL;
+#endif
+#ifdef __linux__
+int                                         UaTestServer_g_iSignalFd                     = -1;
+#endif
 
 
 
@@ -169,7 +169,11 @@ struct _OpcUa_ServiceType my_Read_ServiceType =
 {
     OpcUaId_ReadRequest,
     OpcUa_Null,
+#ifdef READ_ZERO_COPY
+    (OpcUa_PfnBeginInvokeService*)my_BeginRead,
+#else
     OpcUa_Server_BeginRead,
+#endif
     (OpcUa_PfnInvokeService*)my_Read
 };
 
@@ -187,11 +191,19 @@ struct _OpcUa_ServiceType my_Browse_ServiceType =
 /*============================================================================
  * The service dispatch information GetEndpoints  service.
  *===========================================================================*/
+#ifdef OPCUA_SUPPORT_PREENCODED_MESSAGES
+static OpcUa_StatusCode my_BeginGetEndpoints(OpcUa_Endpoint a_hEndpoint, OpcUa_Handle a_hContext, OpcUa_Void** a_ppRequest, OpcUa_EncodeableType* a_pRequestType);
+static OpcUa_StatusCode my_InitializeGetEndpointsKeys(OpcUa_Void);
+static OpcUa_Void my_ClearGetEndpointsKeys(OpcUa_Void);
+#define MY_BEGIN_GETENDPOINTS my_BeginGetEndpoints
+#else
+#define MY_BEGIN_GETENDPOINTS OpcUa_Server_BeginGetEndpoints
+#endif
   
 OpcUa_ServiceType OTServer_ServiceGetEndpoints = 
     { OpcUaId_GetEndpointsRequest,
 	  OpcUa_Null,
-	  (OpcUa_PfnBeginInvokeService*)OpcUa_Server_BeginGetEndpoints,                
+	  (OpcUa_PfnBeginInvokeService*)MY_BEGIN_GETENDPOINTS,                
 	  (OpcUa_PfnInvokeService*) myserverGetEndpointsService};
 
 
@@ -230,11 +242,58 @@ OpcUa_ServiceType CloseSession =
 /*============================================================================
  * The service dispatch information CreateSubscription service.
  *===========================================================================*/
-OpcUa_ServiceType  dummy_CreatSubscription =
-	{	OpcUaId_CreateSubscriptionRequest,
-		OpcUa_Null, /*&OpcUa_CreateSubscriptionResponse_EncodeableType,*/
-		(OpcUa_PfnBeginInvokeService*)OpcUa_Server_BeginCreateSubscription,
-		(OpcUa_PfnInvokeService*)OpcUa_ServerApi_CreateSubscription};
+OpcUa_ServiceType my_CreateSubscription_ServiceType =
+{
+    OpcUaId_CreateSubscriptionRequest,
+    OpcUa_Null,
+    (OpcUa_PfnBeginInvokeService*)OpcUa_Server_BeginCreateSubscription,
+    (OpcUa_PfnInvokeService*)my_CreateSubscription
+};
+
+/*============================================================================
+ * The service dispatch information DeleteSubscriptions service.
+ *===========================================================================*/
+OpcUa_ServiceType my_DeleteSubscriptions_ServiceType =
+{
+    OpcUaId_DeleteSubscriptionsRequest,
+    OpcUa_Null,
+    (OpcUa_PfnBeginInvokeService*)OpcUa_Server_BeginDeleteSubscriptions,
+    (OpcUa_PfnInvokeService*)my_DeleteSubscriptions
+};
+
+/*============================================================================
+ * The service dispatch information CreateMonitoredItems service.
+ *===========================================================================*/
+OpcUa_ServiceType my_CreateMonitoredItems_ServiceType =
+{
+    OpcUaId_CreateMonitoredItemsRequest,
+    OpcUa_Null,
+    (OpcUa_PfnBeginInvokeService*)OpcUa_Server_BeginCreateMonitoredItems,
+    (OpcUa_PfnInvokeService*)my_CreateMonitoredItems
+};
+
+/*============================================================================
+ * The service dispatch information DeleteMonitoredItems service.
+ *===========================================================================*/
+OpcUa_ServiceType my_DeleteMonitoredItems_ServiceType =
+{
+    OpcUaId_DeleteMonitoredItemsRequest,
+    OpcUa_Null,
+    (OpcUa_PfnBeginInvokeService*)OpcUa_Server_BeginDeleteMonitoredItems,
+    (OpcUa_PfnInvokeService*)my_DeleteMonitoredItems
+};
+
+/*============================================================================
+ * The service dispatch information Publish service.
+ * my_BeginPublish parks the response; there is no synchronous handler.
+ *===========================================================================*/
+OpcUa_ServiceType my_Publish_ServiceType =
+{
+    OpcUaId_PublishRequest,
+    OpcUa_Null,
+    (OpcUa_PfnBeginInvokeService*)my_BeginPublish,
+    (OpcUa_PfnInvokeService*)OpcUa_ServerApi_Publish
+};
 
 /** @brief All supported services. */
 OpcUa_ServiceType*  UaTestServer_SupportedServices[] = 
@@ -247,7 +306,11 @@ OpcUa_ServiceType*  UaTestServer_SupportedServices[] =
     &my_Read_ServiceType,
     &my_BrowseNext_ServiceType,
     &my_FindServers_ServiceType,
-    &dummy_CreatSubscription,
+    &my_CreateSubscription_ServiceType,
+    &my_DeleteSubscriptions_ServiceType,
+    &my_CreateMonitoredItems_ServiceType,
+    &my_DeleteMonitoredItems_ServiceType,
+    &my_Publish_ServiceType,
     OpcUa_Null
 };
 
@@ -255,38 +318,164 @@ OpcUa_ServiceType*  UaTestServer_SupportedServices[] =
 /***********************               Internal Helpers               ************************/
 /*********************************************************************************************/
 
-#ifdef __linux__
-#include <sys/select.h>
-int _kbhit(void)
+#ifdef _WIN32
+static BOOL WINAPI UaTestServer_ConsoleCtrlHandler(DWORD a_dwCtrlType)
 {
-        struct timeval tv;
-        fd_set fd;
-        memset(&tv, 0, sizeof(tv));
-        memset(&fd, 0, sizeof(fd));
-        FD_SET(0, &fd);
-        return select(1, &fd, NULL, NULL, &tv)>0;
+    switch(a_dwCtrlType)
+    {
+    case CTRL_C_EVENT:
+    case CTRL_BREAK_EVENT:
+    case CTRL_CLOSE_EVENT:
+    case CTRL_SHUTDOWN_EVENT:
+        SetEvent(UaTestServer_g_hShutdownEvent);
+        return TRUE;
+    default:
+        return FALSE;
+    }
 }
 #endif
 
 /*===========================================================================================*/
-/** @brief Wait for x to be pressed.                                                         */
+/** @brief Routes SIGINT and SIGTERM (CTRL-C and console close on Windows) to                */
+/*         UaTestServer_WaitForShutdown. Must run before the stack starts its threads, so   */
+/*         that they inherit the blocked signals and only the main thread receives them.    */
 /*===========================================================================================*/
-OpcUa_Boolean UaTestServer_CheckForKeypress()
+OpcUa_StatusCode UaTestServer_InitializeShutdownSignals(OpcUa_Void)
 {
-    if(!_kbhit())
-	{
-		 OpcUa_Thread_Sleep(5000);
-	}
-	else
-	{
-		
+#ifdef __linux__
+    sigset_t Signals;
 
-		if (getchar()=='x')
-		{
-			return 1;
-		}
-	}
-	return 0;
+    sigemptyset(&Signals);
+    sigaddset(&Signals, SIGINT);
+    sigaddset(&Signals, SIGTERM);
+    if(pthread_sigmask(SIG_BLOCK, &Signals, NULL) != 0)
+    {
+        return OpcUa_BadInternalError;
+    }
+    UaTestServer_g_iSignalFd = signalfd(-1, &Signals, SFD_CLOEXEC);
+    if(UaTestServer_g_iSignalFd < 0)
+    {
+        return OpcUa_BadInternalError;
+    }
+#endif
+#ifdef _WIN32
+    UaTestServer_g_hShutdownEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if(UaTestServer_g_hShutdownEvent == NULL)
+    {
+        return OpcUa_BadInternalError;
+    }
+    if(!SetConsoleCtrlHandler(UaTestServer_ConsoleCtrlHandler, TRUE))
+    {
+        return OpcUa_BadInternalError;
+    }
+#endif
+    return OpcUa_Good;
+}
+
+OpcUa_Void UaTestServer_ClearShutdownSignals(OpcUa_Void)
+{
+#ifdef __linux__
+    if(UaTestServer_g_iSignalFd >= 0)
+    {
+        close(UaTestServer_g_iSignalFd);
+        UaTestServer_g_iSignalFd = -1;
+    }
+#endif
+#ifdef _WIN32
+    if(UaTestServer_g_hShutdownEvent != NULL)
+    {
+        SetConsoleCtrlHandler(UaTestServer_ConsoleCtrlHandler, FALSE);
+        CloseHandle(UaTestServer_g_hShutdownEvent);
+        UaTestServer_g_hShutdownEvent = NULL;
+    }
+#endif
+}
+
+/*===========================================================================================*/
+/** @brief Blocks until the server is asked to stop: by SIGINT/SIGTERM, or by x on the       */
+/*         console unless it runs as daemon. The main thread takes no CPU while waiting.     */
+/*===========================================================================================*/
+OpcUa_Void UaTestServer_WaitForShutdown(OpcUa_Boolean a_bDaemon)
+{
+#ifdef __linux__
+    struct pollfd           Wait[2];
+    nfds_t                  nWait       = a_bDaemon ? 1 : 2;
+    struct signalfd_siginfo Signal;
+    int                     c;
+
+    Wait[0].fd      = UaTestServer_g_iSignalFd;
+    Wait[0].events  = POLLIN;
+    Wait[1].fd      = 0;
+    Wait[1].events  = POLLIN;
+
+    for(;;)
+    {
+        if(poll(Wait, nWait, -1) < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            return;
+        }
+        if(Wait[0].revents & POLLIN)
+        {
+            if(read(UaTestServer_g_iSignalFd, &Signal, sizeof(Signal)) == sizeof(Signal))
+            {
+                MY_TRACE("\nSignal %u empfangen\n", Signal.ssi_signo);
+            }
+            return;
+        }
+        if(nWait > 1 && (Wait[1].revents & (POLLIN | POLLHUP)))
+        {
+            c = getchar();
+            if(c == 'x')
+            {
+                return;
+            }
+            if(c == EOF)
+            {
+                /* no console any more, only a signal stops the server */
+                nWait = 1;
+            }
+        }
+    }
+#endif
+#ifdef _WIN32
+    HANDLE  Wait[2];
+    DWORD   nWait       = a_bDaemon ? 1 : 2;
+    DWORD   dwResult;
+
+    Wait[0] = UaTestServer_g_hShutdownEvent;
+    Wait[1] = GetStdHandle(STD_INPUT_HANDLE);
+
+    for(;;)
+    {
+        dwResult = WaitForMultipleObjects(nWait, Wait, FALSE, INFINITE);
+        if(dwResult == WAIT_OBJECT_0)
+        {
+            return;
+        }
+        if(dwResult != WAIT_OBJECT_0 + 1)
+        {
+            /* no usable console, only CTRL-C or a shutdown stops the server */
+            nWait = 1;
+            continue;
+        }
+        if(_kbhit())
+        {
+            if(_getch() == 'x')
+            {
+                return;
+            }
+        }
+        else
+        {
+            /* mouse, focus and key release events */
+            FlushConsoleInputBuffer(Wait[1]);
+        }
+    }
+#endif
 }
 
 /*===========================================================================================*/
@@ -333,12 +522,15 @@ OpcUa_InitializeStatus(OpcUa_Module_Server, "Initialize");
     UaTestServer_g_pProxyStubConfiguration.iSecureListener_ThreadPool_MaxJobs    = -1;
     UaTestServer_g_pProxyStubConfiguration.bSecureListener_ThreadPool_BlockOnAdd = OpcUa_True;
     UaTestServer_g_pProxyStubConfiguration.uSecureListener_ThreadPool_Timeout    = OPCUA_INFINITE;
+    UaTestServer_g_pProxyStubConfiguration.iSecureListener_CryptoPool_Threads    = -1;
+    UaTestServer_g_pProxyStubConfiguration.iSecureListener_CryptoPool_MaxJobs    = -1;
     UaTestServer_g_pProxyStubConfiguration.bTcpListener_ClientThreadsEnabled     = OpcUa_False;
     UaTestServer_g_pProxyStubConfiguration.iTcpListener_DefaultChunkSize         = -1;
     UaTestServer_g_pProxyStubConfiguration.iTcpConnection_DefaultChunkSize       = -1;
     UaTestServer_g_pProxyStubConfiguration.iTcpTransport_MaxMessageLength        = -1;
     UaTestServer_g_pProxyStubConfiguration.iTcpTransport_MaxChunkCount           = -1;
     UaTestServer_g_pProxyStubConfiguration.bTcpStream_ExpectWriteToBlock         = OpcUa_True;
+    UaTestServer_g_pProxyStubConfiguration.iHttpsTransport_MaxPipelinedRequests  = -1;
 
     /* initialize platform layer */
     uStatus = OpcUa_P_Initialize(&UaTestServer_g_PlatformLayerHandle); // UaTestServer_g_PlatformLayerHandle is pointer to Servicetable.
@@ -377,10 +569,15 @@ static OpcUa_Void UaTestServer_SecurityClear(OpcUa_Void)
 /*===========================================================================================*/
 OpcUa_Void UaTestServer_Clear(OpcUa_Void)
 {
-	if(p_user_name!=OpcUa_Null)
-		username_free();
-	
-	OpcUa_Timer_Delete(&Timer);
+	clear_subscriptions();
+	clear_sessions();
+	clear_continuationpoints();
+#ifdef OPCUA_SUPPORT_PREENCODED_MESSAGES
+	my_ClearGetEndpointsKeys();
+#endif /* OPCUA_SUPPORT_PREENCODED_MESSAGES */
+	UaTestServer_ClearShutdownSignals();
+	clear_node_index();
+	unmap_addressspace_image();
 	
     UaTestServer_SecurityClear();
     OpcUa_ProxyStub_Clear();
@@ -554,6 +751,228 @@ OpcUa_StatusCode my_FindServers(
 
 
 
+#ifdef OPCUA_SUPPORT_PREENCODED_MESSAGES
+/* the stack finds a stored response by its fingerprint only; the parameters are compared here */
+#define MAX_GETENDPOINTS_RESPONSES	4
+
+typedef struct _my_getendpoints_key_
+{
+	OpcUa_Boolean	bUsed;
+	OpcUa_UInt32	Fingerprint;
+	OpcUa_String	EndpointUrl;
+	OpcUa_Int32		NoOfProfileUris;
+	OpcUa_String*	ProfileUris;
+}_my_getendpoints_key_;
+
+static _my_getendpoints_key_	my_g_GetEndpointsKeys[MAX_GETENDPOINTS_RESPONSES];
+static OpcUa_Mutex				my_g_GetEndpointsMutex		= OpcUa_Null;
+
+/*============================================================================
+ *  fingerprint of the request parameters the GetEndpoints response depends on.
+ *===========================================================================*/
+static OpcUa_UInt32 my_GetEndpointsFingerprint(OpcUa_String* a_pEndpointUrl, OpcUa_Int32 a_nNoOfProfileUris, OpcUa_String* a_pProfileUris)
+{
+	OpcUa_UInt32 uHash = 2166136261u;
+	OpcUa_Int32  i;
+
+	for(i=-1;i<a_nNoOfProfileUris;i++)
+	{
+		OpcUa_CharA* p = OpcUa_String_GetRawString((i<0)?a_pEndpointUrl:a_pProfileUris+i);
+		while(p!=OpcUa_Null && *p!='\0')
+		{
+			uHash = (uHash ^ (OpcUa_Byte)*p++) * 16777619u;
+		}
+		/* separator, so that ("ab","c") differs from ("a","bc") */
+		uHash = (uHash ^ 0xFFu) * 16777619u;
+	}
+	return uHash;
+}
+
+/*============================================================================
+ *  frees the parameters of a stored response.
+ *===========================================================================*/
+static OpcUa_Void my_ClearGetEndpointsKey(_my_getendpoints_key_* a_pKey)
+{
+	OpcUa_Int32 i;
+
+	OpcUa_String_Clear(&a_pKey->EndpointUrl);
+	for(i=0;i<a_pKey->NoOfProfileUris;i++)
+	{
+		OpcUa_String_Clear(a_pKey->ProfileUris+i);
+	}
+	if(a_pKey->ProfileUris!=OpcUa_Null)
+	{
+		OpcUa_Free(a_pKey->ProfileUris);
+	}
+	OpcUa_MemSet(a_pKey,0,sizeof(_my_getendpoints_key_));
+}
+
+/*============================================================================
+ *  true if a stored response was built for exactly these parameters.
+ *===========================================================================*/
+static OpcUa_Boolean my_GetEndpointsKeyEquals(_my_getendpoints_key_* a_pKey, OpcUa_String* a_pEndpointUrl, OpcUa_Int32 a_nNoOfProfileUris, OpcUa_String* a_pProfileUris)
+{
+	OpcUa_Int32 i;
+
+	if(a_pKey->NoOfProfileUris!=a_nNoOfProfileUris)
+		return OpcUa_False;
+	if(OpcUa_String_StrnCmp(&a_pKey->EndpointUrl,a_pEndpointUrl,OPCUA_STRING_LENDONTCARE,OpcUa_False)!=0)
+		return OpcUa_False;
+	for(i=0;i<a_nNoOfProfileUris;i++)
+	{
+		if(OpcUa_String_StrnCmp(a_pKey->ProfileUris+i,a_pProfileUris+i,OPCUA_STRING_LENDONTCARE,OpcUa_False)!=0)
+			return OpcUa_False;
+	}
+	return OpcUa_True;
+}
+
+/*============================================================================
+ *  true if the response stored under the fingerprint fits the parameters.
+ *===========================================================================*/
+static OpcUa_Boolean my_FindGetEndpointsKey(OpcUa_UInt32 a_uFingerprint, OpcUa_String* a_pEndpointUrl, OpcUa_Int32 a_nNoOfProfileUris, OpcUa_String* a_pProfileUris)
+{
+	OpcUa_Boolean	bFound = OpcUa_False;
+	OpcUa_Int		i;
+
+	OpcUa_Mutex_Lock(my_g_GetEndpointsMutex);
+	for(i=0;i<MAX_GETENDPOINTS_RESPONSES;i++)
+	{
+		if(my_g_GetEndpointsKeys[i].bUsed!=OpcUa_False && my_g_GetEndpointsKeys[i].Fingerprint==a_uFingerprint)
+		{
+			bFound = my_GetEndpointsKeyEquals(&my_g_GetEndpointsKeys[i],a_pEndpointUrl,a_nNoOfProfileUris,a_pProfileUris);
+			break;
+		}
+	}
+	OpcUa_Mutex_Unlock(my_g_GetEndpointsMutex);
+	return bFound;
+}
+
+/*============================================================================
+ *  remembers the parameters of a response before it is stored.
+ *  false if the fingerprint belongs to other parameters or the table is full;
+ *  such responses are not stored, so a fingerprint never changes its meaning.
+ *===========================================================================*/
+static OpcUa_Boolean my_AddGetEndpointsKey(OpcUa_UInt32 a_uFingerprint, OpcUa_String* a_pEndpointUrl, OpcUa_Int32 a_nNoOfProfileUris, OpcUa_String* a_pProfileUris)
+{
+	_my_getendpoints_key_*	pFree	= OpcUa_Null;
+	OpcUa_Boolean			bAdd	= OpcUa_False;
+	OpcUa_StatusCode		uStatus	= OpcUa_Good;
+	OpcUa_Int				i;
+
+	OpcUa_Mutex_Lock(my_g_GetEndpointsMutex);
+	for(i=0;i<MAX_GETENDPOINTS_RESPONSES;i++)
+	{
+		if(my_g_GetEndpointsKeys[i].bUsed==OpcUa_False)
+		{
+			if(pFree==OpcUa_Null)
+				pFree=&my_g_GetEndpointsKeys[i];
+		}
+		else if(my_g_GetEndpointsKeys[i].Fingerprint==a_uFingerprint)
+		{
+			bAdd = my_GetEndpointsKeyEquals(&my_g_GetEndpointsKeys[i],a_pEndpointUrl,a_nNoOfProfileUris,a_pProfileUris);
+			OpcUa_Mutex_Unlock(my_g_GetEndpointsMutex);
+			return bAdd;
+		}
+	}
+
+	if(pFree!=OpcUa_Null)
+	{
+		uStatus = OpcUa_String_StrnCpy(&pFree->EndpointUrl,a_pEndpointUrl,OPCUA_STRING_LENDONTCARE);
+		if(OpcUa_IsGood(uStatus) && a_nNoOfProfileUris>0)
+		{
+			pFree->ProfileUris=(OpcUa_String*)OpcUa_Alloc(a_nNoOfProfileUris*sizeof(OpcUa_String));
+			if(pFree->ProfileUris==OpcUa_Null)
+			{
+				uStatus=OpcUa_BadOutOfMemory;
+			}
+			else
+			{
+				for(i=0;i<a_nNoOfProfileUris;i++)
+				{
+					OpcUa_String_Initialize(pFree->ProfileUris+i);
+				}
+				pFree->NoOfProfileUris=a_nNoOfProfileUris;
+				for(i=0;i<a_nNoOfProfileUris && OpcUa_IsGood(uStatus);i++)
+				{
+					uStatus = OpcUa_String_StrnCpy(pFree->ProfileUris+i,a_pProfileUris+i,OPCUA_STRING_LENDONTCARE);
+				}
+			}
+		}
+		if(OpcUa_IsGood(uStatus))
+		{
+			pFree->Fingerprint=a_uFingerprint;
+			pFree->bUsed=OpcUa_True;
+			bAdd=OpcUa_True;
+		}
+		else
+		{
+			my_ClearGetEndpointsKey(pFree);
+		}
+	}
+	OpcUa_Mutex_Unlock(my_g_GetEndpointsMutex);
+	return bAdd;
+}
+
+/*============================================================================
+ *  creates the table of stored response parameters.
+ *===========================================================================*/
+static OpcUa_StatusCode my_InitializeGetEndpointsKeys(OpcUa_Void)
+{
+	OpcUa_MemSet(my_g_GetEndpointsKeys,0,sizeof(my_g_GetEndpointsKeys));
+	return OpcUa_Mutex_Create(&my_g_GetEndpointsMutex);
+}
+
+/*============================================================================
+ *  frees the table of stored response parameters.
+ *===========================================================================*/
+static OpcUa_Void my_ClearGetEndpointsKeys(OpcUa_Void)
+{
+	OpcUa_Int i;
+
+	for(i=0;i<MAX_GETENDPOINTS_RESPONSES;i++)
+	{
+		my_ClearGetEndpointsKey(&my_g_GetEndpointsKeys[i]);
+	}
+	if(my_g_GetEndpointsMutex!=OpcUa_Null)
+	{
+		OpcUa_Mutex_Delete(&my_g_GetEndpointsMutex);
+	}
+}
+
+/*============================================================================
+ *  answers GetEndpoints from the encoded copy of an earlier response.
+ *===========================================================================*/
+static OpcUa_StatusCode my_BeginGetEndpoints(
+	OpcUa_Endpoint        a_hEndpoint,
+	OpcUa_Handle          a_hContext,
+	OpcUa_Void**          a_ppRequest,
+	OpcUa_EncodeableType* a_pRequestType)
+{
+	OpcUa_GetEndpointsRequest* pRequest     = OpcUa_Null;
+	OpcUa_StatusCode           uStatus      = OpcUa_Good;
+	OpcUa_UInt32               uFingerprint = 0;
+
+	if(a_ppRequest!=OpcUa_Null && *a_ppRequest!=OpcUa_Null && a_pRequestType!=OpcUa_Null && a_pRequestType->TypeId==OpcUaId_GetEndpointsRequest)
+	{
+		pRequest = (OpcUa_GetEndpointsRequest*)*a_ppRequest;
+		uFingerprint = my_GetEndpointsFingerprint(&pRequest->EndpointUrl, pRequest->NoOfProfileUris, pRequest->ProfileUris);
+
+		if(my_FindGetEndpointsKey(uFingerprint, &pRequest->EndpointUrl, pRequest->NoOfProfileUris, pRequest->ProfileUris)!=OpcUa_False)
+		{
+			uStatus = OpcUa_Endpoint_EndSendEncodedResponse(a_hEndpoint,
+															&a_hContext,
+															uFingerprint,
+															pRequest->RequestHeader.RequestHandle);
+			if(uStatus!=OpcUa_BadNotFound)
+				return uStatus;
+		}
+	}
+
+	/* not stored yet; myserverGetEndpointsService stores the response */
+	return OpcUa_Server_BeginGetEndpoints(a_hEndpoint, a_hContext, a_ppRequest, a_pRequestType);
+}
+#endif /* OPCUA_SUPPORT_PREENCODED_MESSAGES */
+
 /*============================================================================
  *  method which implements the GetEndpoints service.
  *===========================================================================*/
@@ -588,11 +1007,6 @@ OpcUa_StatusCode myserverGetEndpointsService(
 #ifndef NO_DEBUGING_
 	MY_TRACE("\n\n\nGETENDPOINTS SERVICE=================================\n"); 
 #endif /*_DEBUGING_*/
-  
-	session_flag=SESSION_NOT_ACTIVATED;
-	if(p_user_name!=OpcUa_Null)
-			username_free();
-	OpcUa_Timer_Delete(&Timer);
 
 	//need to pass CTT-test---------------------------------
 	for(i=0;i< a_nNoOfProfileUris;i++)
@@ -613,10 +1027,29 @@ OpcUa_StatusCode myserverGetEndpointsService(
 	{
        a_pResponseHeader->ServiceResult=OpcUa_BadInternalError;
 	}
+#ifdef OPCUA_SUPPORT_PREENCODED_MESSAGES
+	else
+	{
+		/* the endpoints never change; later requests get the encoded copy (shallow struct, not cleared) */
+		OpcUa_GetEndpointsResponse Response;
+		OpcUa_UInt32 uFingerprint = my_GetEndpointsFingerprint(a_pEndpointUrl, a_nNoOfProfileUris, a_pProfileUris);
+		if(my_AddGetEndpointsKey(uFingerprint, a_pEndpointUrl, a_nNoOfProfileUris, a_pProfileUris)!=OpcUa_False)
+		{
+			OpcUa_GetEndpointsResponse_Initialize(&Response);
+			Response.ResponseHeader = *a_pResponseHeader;
+			Response.NoOfEndpoints  = *a_pNoOfEndpoints;
+			Response.Endpoints      = *a_ppEndpoints;
+			OpcUa_Endpoint_SetEncodedResponse(	a_hEndpoint,
+												OpcUaId_GetEndpointsRequest,
+												uFingerprint,
+												&Response,
+												&OpcUa_GetEndpointsResponse_EncodeableType);
+		}
+	}
+#endif /* OPCUA_SUPPORT_PREENCODED_MESSAGES */
 #ifndef NO_DEBUGING_
 	MY_TRACE("\nSERVICE===ENDE========================================\n\n\n"); 
 #endif /*_DEBUGING_*/
-	RESET_SESSION_COUNTER
 
 	OpcUa_ReturnStatusCode;
     OpcUa_BeginErrorHandling;
@@ -630,7 +1063,6 @@ OpcUa_StatusCode myserverGetEndpointsService(
 #ifndef NO_DEBUGING_
 	MY_TRACE("\nSERVICEENDE (IM SERVICE SIND FEHLER AUFGETRETTEN)===========\n\n\n"); 
 #endif /*_DEBUGING_*/
-	RESET_SESSION_COUNTER
     OpcUa_FinishErrorHandling;
 	
 }
@@ -664,6 +1096,7 @@ OpcUa_StatusCode myserver_CreateSession(
     OpcUa_SignatureData*                a_pServerSignature,
     OpcUa_UInt32*                       a_pMaxRequestMessageSize)
  {
+	OpcUa_UInt32	uSecureChannelId;
 
 	 OpcUa_InitializeStatus(OpcUa_Module_Server, "OpcUa_ServerApi_CreateSession");
 
@@ -690,49 +1123,28 @@ OpcUa_StatusCode myserver_CreateSession(
     OpcUa_ReturnErrorIfArgumentNull(a_pServerSignature);
     OpcUa_ReturnErrorIfArgumentNull(a_pMaxRequestMessageSize);
 
-	
-	RESET_SESSION_COUNTER
 
 #ifndef NO_DEBUGING_
 	MY_TRACE("\n\n\nCREATESESSION SERVICE=================================\n"); 
 #endif /*_DEBUGING_*/
 
-	if(OpcUa_IsGood(session_flag))
-	{
-		//teile client mit , dass keine weiteren sessions angenommen werden
-		uStatus=OpcUa_BadTooManySessions;
-		OpcUa_GotoError;
-	}
-	
-
-	
 	//SessionTimeout bekanntgeben--------------------------------------------------------------------
 		if(a_nRequestedSessionTimeout>0 && a_nRequestedSessionTimeout<REVISED_SESSIONTIMEOUT)  
 		{
-			session_timeout=a_nRequestedSessionTimeout/30;
 			*a_pRevisedSessionTimeout=a_nRequestedSessionTimeout;
 		}
 		else
 		{
-			session_timeout=REVISED_SESSIONTIMEOUT/30;
 			*a_pRevisedSessionTimeout=REVISED_SESSIONTIMEOUT;
 		}
 	
 	//-----------------------------------------------------------------------------------------------
-		
-	//Timer setzen fuer SesionTimeout-----------------------------------
-	if(OpcUa_Timer_Create(  &Timer,1, &Timer_Callback, OpcUa_Null,OpcUa_Null)!= OpcUa_Good)
-	{
-		uStatus=OpcUa_BadInternalError;
-		OpcUa_GotoError;                                            
-	}
-	//------------------------------------------------------------------
 
 
-	//get securechannelId and store it------------------------------------------------------------- 
+	//get securechannelId------------------------------------------------------------------------- 
 		uStatus=OpcUa_Endpoint_GetMessageSecureChannelId(  a_hEndpoint,
 															a_hContext,
-															&securechannelId);
+															&uSecureChannelId);
 		if(OpcUa_IsBad(uStatus))
 		{
 			uStatus=OpcUa_BadInternalError;
@@ -742,11 +1154,8 @@ OpcUa_StatusCode myserver_CreateSession(
 
 
 	// sessionId und authenticationToken dem client bekannt machen.---------------------------------
-		a_pSessionId->Identifier.Numeric=12345;
-		a_pSessionId->IdentifierType=OpcUa_IdentifierType_Numeric;
-		a_pSessionId->NamespaceIndex=0;
-
-		*a_pAuthenticationToken=*a_pSessionId;
+		uStatus=create_session(uSecureChannelId,(OpcUa_UInt32)*a_pRevisedSessionTimeout,a_pSessionId,a_pAuthenticationToken);
+		OpcUa_GotoErrorIfBad(uStatus);
 	//----------------------------------------------------------------------------------------------
 
 
@@ -776,7 +1185,6 @@ OpcUa_StatusCode myserver_CreateSession(
 #ifndef NO_DEBUGING_
 	MY_TRACE("\nSERVICE===ENDE============================================\n\n\n"); 
 #endif /*_DEBUGING_*/
-	RESET_SESSION_COUNTER
 
 	OpcUa_ReturnStatusCode;
 	OpcUa_BeginErrorHandling;
@@ -790,7 +1198,6 @@ OpcUa_StatusCode myserver_CreateSession(
 #ifndef NO_DEBUGING_
 	MY_TRACE("\nSERVICEENDE (IM SERVICE SIND FEHLER AUFGETRETTEN)===========\n\n\n"); 
 #endif /*_DEBUGING_*/
-	RESET_SESSION_COUNTER
 	OpcUa_FinishErrorHandling;
  }
 
@@ -816,7 +1223,8 @@ OpcUa_StatusCode my_ActivateSession(
     OpcUa_Int32*                           a_pNoOfDiagnosticInfos,
     OpcUa_DiagnosticInfo**                 a_pDiagnosticInfos)
 {
-	
+	OpcUa_UInt32	uSecureChannelId;
+
     OpcUa_InitializeStatus(OpcUa_Module_Server, "OpcUa_ServerApi_ActivateSession");
 
     /* validate arguments. */
@@ -833,71 +1241,28 @@ OpcUa_StatusCode my_ActivateSession(
     OpcUa_ReturnErrorIfArrayArgumentNull(a_pNoOfResults, a_pResults);
     OpcUa_ReturnErrorIfArrayArgumentNull(a_pNoOfDiagnosticInfos, a_pDiagnosticInfos);
 
-	RESET_SESSION_COUNTER
-
 	
 
 #ifndef NO_DEBUGING_
 	MY_TRACE("\n\n\nACTIVATESESSION SERVICE===============================\n"); 
 #endif /*_DEBUGING_*/
 	
-	/*Pruefe Authentication Token******************************************************************/
-	uStatus=check_authentication_token(a_pRequestHeader);
+	uStatus=OpcUa_Endpoint_GetMessageSecureChannelId(  a_hEndpoint,
+														a_hContext,
+														&uSecureChannelId);
 	if(OpcUa_IsBad(uStatus))
 	{
-#ifndef NO_DEBUGING_
-		MY_TRACE("\nAuthentication Token ungltig.\n"); 
-#endif /*_DEBUGING_*/
-		uStatus = OpcUa_BadSecurityChecksFailed;
+		uStatus =OpcUa_BadInternalError;
 		OpcUa_GotoError;
 	}
-    /**********************************************************************************************/
-
 
-	/*Pruefe UserIdentityToken******************************************************************/
-	uStatus=check_useridentitytoken(a_pUserIdentityToken);
-	OpcUa_GotoErrorIfBad(uStatus)
-    /********************************************************************************************/
-	
-	
-	if(OpcUa_IsBad(session_flag))//session noch nicht aktiviert
+	/* checks the AuthenticationToken, the SecureChannel and the UserIdentityToken */
+	uStatus=activate_session(a_pRequestHeader,uSecureChannelId,a_pUserIdentityToken);
+	if(OpcUa_IsEqual(OpcUa_BadSessionIdInvalid))
 	{
-		uStatus=check_securechannelId(a_hEndpoint,a_hContext);
-		if(OpcUa_IsBad(uStatus))
-		{
-			uStatus=OpcUa_BadSecurityChecksFailed;
-			OpcUa_GotoError;
-		}
-
-	}
-	else//session bereits aktiviert. client moechte aktuelle session neuem securechannel zuweisen 
-	{
-		uStatus=OpcUa_Endpoint_GetMessageSecureChannelId(  a_hEndpoint,
-															a_hContext,
-															&securechannelId);
-		if(OpcUa_IsBad(uStatus))
-		{
-			uStatus =OpcUa_BadInternalError;
-
-			OpcUa_GotoError;                                            
-		}
-		#ifndef NO_DEBUGING_
-			MY_TRACE("\nNeuer Securechannel(%d) der aktuellen Session zugewiesen\n",securechannelId);
-		#endif /*_DEBUGING_*/
+		uStatus = OpcUa_BadSecurityChecksFailed;
 	}
-
-	session_flag=SESSION_ACTIVATED;
-
-#ifndef NO_DEBUGING_
-	if(p_user_name!=OpcUa_Null)
-		MY_TRACE("\nUser(%s) hat sich angemeldet\n",OpcUa_String_GetRawString(p_user_name)); 
-#endif /*_DEBUGING_*/
-
-
-#ifndef NO_DEBUGING_
-		MY_TRACE("\nSession aktiviert!!!\n"); 
-#endif /*_DEBUGING_*/
-	
+	OpcUa_GotoErrorIfBad(uStatus);
 
 // ----------------------------------------------------------
 	*a_pResults=OpcUa_Null;
@@ -919,7 +1284,6 @@ OpcUa_StatusCode my_ActivateSession(
 #ifndef NO_DEBUGING_
 	MY_TRACE("\nSERVICE===ENDE============================================\n\n\n"); 
 #endif /*_DEBUGING_*/
-	RESET_SESSION_COUNTER
 
 	OpcUa_ReturnStatusCode;
     OpcUa_BeginErrorHandling;
@@ -933,7 +1297,6 @@ OpcUa_StatusCode my_ActivateSession(
 #ifndef NO_DEBUGING_
 	MY_TRACE("\nSERVICEENDE (IM SERVICE SIND FEHLER AUFGETRETTEN)===========\n\n\n"); 
 #endif /*_DEBUGING_*/
-	RESET_SESSION_COUNTER
     OpcUa_FinishErrorHandling;
 }
 
@@ -955,58 +1318,19 @@ OpcUa_StatusCode my_CloseSession(
     OpcUa_ReturnErrorIfArgumentNull(a_pRequestHeader);
     OpcUa_ReferenceParameter(a_bDeleteSubscriptions);
     OpcUa_ReturnErrorIfArgumentNull(a_pResponseHeader);
-
-	RESET_SESSION_COUNTER
 	
 #ifndef NO_DEBUGING_
 	MY_TRACE("\n\n\nCLOSESESSION SERVICE========================================\n"); 
 #endif /*_DEBUGING_*/
 
-	if(OpcUa_IsBad(session_flag))
-	{
-		//teile client mit , dass Session geschlossen ist
-		if(p_user_name!=OpcUa_Null)
-			username_free();
-
-		OpcUa_Timer_Delete(&Timer);
-		
+	/* no transfer of subscriptions, so they end with the session */
+	uStatus=close_session(a_pRequestHeader);
 #ifndef NO_DEBUGING_
+	if(OpcUa_IsEqual(OpcUa_BadSessionIdInvalid))
 		MY_TRACE("\nSession bereits deaktiviert!!!\n"); 
 #endif /*_DEBUGING_*/
-		uStatus = OpcUa_BadSessionIdInvalid;
-		OpcUa_GotoError;
-	}
-
-	uStatus=check_authentication_token(a_pRequestHeader);
-	if(OpcUa_IsBad(uStatus))
-	{
-#ifndef NO_DEBUGING_
-		MY_TRACE("\nAuthentication Token ungltig.\n"); 
-#endif /*_DEBUGING_*/
-		uStatus =OpcUa_BadSecurityChecksFailed;
-		OpcUa_GotoError;
-	}
-    
-	
-	OpcUa_Timer_Delete(&Timer);
-	
-
-	session_flag=SESSION_NOT_ACTIVATED;
-
-#ifndef NO_DEBUGING_
-	if(p_user_name!=OpcUa_Null)
-		MY_TRACE("\nUser(%s) hat sich abgemeldet\n",OpcUa_String_GetRawString(p_user_name)); 
-#endif /*_DEBUGING_*/
-	if(p_user_name!=OpcUa_Null)
-		username_free();
-
-#ifndef NO_DEBUGING_
-	MY_TRACE("\nSession deaktiviert!!!\n"); 
-#endif /*_DEBUGING_*/
-
-
+	OpcUa_GotoErrorIfBad(uStatus);
 
-	
 	uStatus = response_header_ausfuellen(a_pResponseHeader,a_pRequestHeader,uStatus);
 	if(OpcUa_IsBad(uStatus))
 	{
@@ -1017,11 +1341,11 @@ OpcUa_StatusCode my_CloseSession(
 #endif /*_DEBUGING_*/
 	
 	//Test value of variable DATA_VALUE
+	write_value_begin(8);
 	*(all_ValueAttribute_of_VariableTypeNodes_VariableNodes[8].Value.Array.Value.DoubleArray+0)=3.14;
+	write_value_end(8,OpcUa_Null);
 	//---------------------------------
 
-	RESET_SESSION_COUNTER
-
     OpcUa_ReturnStatusCode;
     OpcUa_BeginErrorHandling;
 
@@ -1033,7 +1357,6 @@ OpcUa_StatusCode my_CloseSession(
 #ifndef NO_DEBUGING_
 	MY_TRACE("\nSERVICEENDE (IM SERVICE SIND FEHLER AUFGETRETTEN)===========\n\n\n"); 
 #endif /*_DEBUGING_*/
-	RESET_SESSION_COUNTER
     OpcUa_FinishErrorHandling;
 }
 
@@ -1061,6 +1384,26 @@ OpcUa_InitializeStatus(OpcUa_Module_Server, "Serve");
 
     MY_TRACE("********************** Starting Server! *************************\n");
 
+    uStatus = initialize_subscriptions();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = initialize_continuationpoints();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+#ifdef OPCUA_SUPPORT_PREENCODED_MESSAGES
+    uStatus = my_InitializeGetEndpointsKeys();
+    OpcUa_GotoErrorIfBad(uStatus);
+#endif /* OPCUA_SUPPORT_PREENCODED_MESSAGES */
+
+    uStatus = initialize_sessions();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    initialize_value_store();
+
+    /* one timer drives the session timeouts and CurrentTime */
+    uStatus = OpcUa_Timer_Create(&Timer, SESSION_TICK, Timer_Callback, OpcUa_Null, OpcUa_Null);
+    OpcUa_GotoErrorIfBad(uStatus);
+
     /* open endpoint */
 	/*#define OPCUA_SECURELISTENER_ALLOW_NOPKI OPCUA_CONFIG_YES von NO auf YES bei nopki.(opcua_securelistner.c)*/
 
@@ -1079,18 +1422,20 @@ OpcUa_InitializeStatus(OpcUa_Module_Server, "Serve");
     MY_TRACE("\n\n\n********************** Server started! **************************\n");
 
     /******************************************************************************/
-    /* Wait for user command to terminate the server thread.                      */
-    /* While looping here, server is active.                                      */
-    /******************************************************************************/
-    /**/ while(!UaTestServer_CheckForKeypress()) ;                               /**/
-    /**/                                                                       /**/
-    /**/                                                                       /**/
+    /* Wait for a signal or the user command to terminate the server thread.      */
+    /* While blocked here, server is active.                                      */
     /******************************************************************************/
+    UaTestServer_WaitForShutdown(UaTestServer_g_bDaemon);
 
     MY_TRACE("********************** Stopping Server! ************************\n");
     /* wait for other threads to stop */
     UaTestServer_SetAndWaitShutdown();
 
+    OpcUa_Timer_Delete(&Timer);
+
+    /* parked Publish requests need the open endpoint to be cancelled */
+    stop_subscriptions();
+
     /* close endpoint */
     uStatus = OpcUa_Endpoint_Close(hEndpoint);
     OpcUa_GotoErrorIfBad(uStatus);
@@ -1103,6 +1448,11 @@ OpcUa_InitializeStatus(OpcUa_Module_Server, "Serve");
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
     
+    if(Timer != OpcUa_Null)
+    {
+        OpcUa_Timer_Delete(&Timer);
+    }
+
     /* Clean up comm */
     OpcUa_Endpoint_Delete(&hEndpoint);
 
@@ -1112,22 +1462,23 @@ OpcUa_FinishErrorHandling;
 
 
 
-OpcUa_StatusCode speichere_username(const OpcUa_ExtensionObject* p_UserIdentityToken)
+OpcUa_StatusCode speichere_username(const OpcUa_ExtensionObject* p_UserIdentityToken, OpcUa_String** a_pp_user_name)
 {
 	OpcUa_StatusCode        uStatus     = OpcUa_Good;
 	OpcUa_ReturnErrorIfArgumentNull(p_UserIdentityToken)
-	p_user_name=OpcUa_Alloc(sizeof(OpcUa_String));
-	OpcUa_ReturnErrorIfAllocFailed(p_user_name)
-	uStatus=OpcUa_String_StrnCpy(p_user_name,&((OpcUa_UserNameIdentityToken*)p_UserIdentityToken->Body.EncodeableObject.Object)->UserName,OPCUA_STRING_LENDONTCARE);
+	*a_pp_user_name=OpcUa_Alloc(sizeof(OpcUa_String));
+	OpcUa_ReturnErrorIfAllocFailed(*a_pp_user_name)
+	OpcUa_String_Initialize(*a_pp_user_name);
+	uStatus=OpcUa_String_StrnCpy(*a_pp_user_name,&((OpcUa_UserNameIdentityToken*)p_UserIdentityToken->Body.EncodeableObject.Object)->UserName,OPCUA_STRING_LENDONTCARE);
 	return uStatus;
 }
 
-OpcUa_Void username_free(OpcUa_Void)
+OpcUa_Void username_free(OpcUa_String** a_pp_user_name)
 {
-	OpcUa_String_Delete(&p_user_name);
+	OpcUa_String_Delete(a_pp_user_name);
 }
 
-OpcUa_StatusCode vergleiche_username(const OpcUa_ExtensionObject* p_UserIdentityToken)
+OpcUa_StatusCode vergleiche_username(const OpcUa_ExtensionObject* p_UserIdentityToken, OpcUa_String* p_user_name)
 {
 	OpcUa_StatusCode        uStatus     = OpcUa_Good;
 	OpcUa_ReturnErrorIfArgumentNull(p_UserIdentityToken)
@@ -1184,7 +1535,7 @@ OpcUa_StatusCode check_password(const OpcUa_ExtensionObject* p_UserIdentityToken
 	return uStatus;
 }
 
-OpcUa_StatusCode check_useridentitytoken(const OpcUa_ExtensionObject* p_UserIdentityToken)
+OpcUa_StatusCode check_useridentitytoken(const OpcUa_ExtensionObject* p_UserIdentityToken, OpcUa_String** a_pp_user_name)
 {
 	OpcUa_InitializeStatus(OpcUa_Module_Server, "check_useridentitytoken");
 
@@ -1207,9 +1558,9 @@ OpcUa_StatusCode check_useridentitytoken(const OpcUa_ExtensionObject* p_UserIden
 	
 	if((OpcUa_UInt32)(p_UserIdentityToken->TypeId.NodeId.Identifier.Numeric)== OpcUaId_UserNameIdentityToken_Encoding_DefaultBinary)
 	{
-			if(p_user_name!=OpcUa_Null)
+			if(*a_pp_user_name!=OpcUa_Null)
 			{
-				uStatus=vergleiche_username(p_UserIdentityToken);
+				uStatus=vergleiche_username(p_UserIdentityToken,*a_pp_user_name);
 				if(OpcUa_IsGood(uStatus))
 				{
 					uStatus=check_password(p_UserIdentityToken);
@@ -1237,7 +1588,7 @@ OpcUa_StatusCode check_useridentitytoken(const OpcUa_ExtensionObject* p_UserIden
 			}
 			else
 			{
-				uStatus=speichere_username(p_UserIdentityToken);
+				uStatus=speichere_username(p_UserIdentityToken,a_pp_user_name);
 				OpcUa_ReturnErrorIfBad(uStatus)
 				uStatus=check_password(p_UserIdentityToken);
 				if(OpcUa_IsBad(uStatus))
@@ -1265,85 +1616,17 @@ OpcUa_StatusCode check_useridentitytoken(const OpcUa_ExtensionObject* p_UserIden
 	OpcUa_FinishErrorHandling;
 }
 
-OpcUa_StatusCode check_securechannelId( OpcUa_Endpoint a_hEndpoint,  OpcUa_Handle a_hContext)
-{
-	OpcUa_UInt32* p_securechannelId;
-
-	OpcUa_InitializeStatus(OpcUa_Module_Server, "check_securechannelId");
-
-	if(a_hEndpoint==OpcUa_Null || a_hContext==OpcUa_Null)
-	{
-		uStatus=OpcUa_Bad;
-		OpcUa_GotoError
-	}
-	p_securechannelId=OpcUa_Alloc(sizeof(OpcUa_UInt32));
-	OpcUa_GotoErrorIfAllocFailed(p_securechannelId);
-	uStatus=OpcUa_Endpoint_GetMessageSecureChannelId(  a_hEndpoint,a_hContext,p_securechannelId);
-	if(OpcUa_IsBad(uStatus))
-	{
-		OpcUa_Free(p_securechannelId);
-		uStatus=OpcUa_Good;
-		OpcUa_GotoError 
-	}
-	if(*p_securechannelId==securechannelId)
-	{
-		OpcUa_Free(p_securechannelId);
-		uStatus=OpcUa_Good;
-	}
-	else
-	{
-		OpcUa_Free(p_securechannelId);
-		uStatus=OpcUa_Bad;
-	}
-	return uStatus;
-	OpcUa_BeginErrorHandling;
-    
-    
-	OpcUa_FinishErrorHandling;
-}
-
-OpcUa_StatusCode check_authentication_token (const OpcUa_RequestHeader* a_pRequestHeader)
-{
-	OpcUa_InitializeStatus(OpcUa_Module_Server, "check_authentication_token");
-
-	if(a_pRequestHeader==OpcUa_Null)
-	{
-		uStatus=OpcUa_BadSessionIdInvalid;
-		OpcUa_GotoError
-	}
-	if((a_pRequestHeader->AuthenticationToken.IdentifierType==OpcUa_IdentifierType_Numeric && a_pRequestHeader->AuthenticationToken.NamespaceIndex==0) && (a_pRequestHeader->AuthenticationToken.Identifier.Numeric==12345))
-	{
-		uStatus=OpcUa_Good;
-	}
-	else
-	{
-		uStatus=OpcUa_BadSessionIdInvalid;
-	}
-	return uStatus;
-	OpcUa_BeginErrorHandling;
-    
-    
-	OpcUa_FinishErrorHandling;
-
-}
-
 OpcUa_StatusCode OPCUA_DLLCALL Timer_Callback(  OpcUa_Void*             pvCallbackData, 
                                                 OpcUa_Timer             hTimer,
                                                 OpcUa_UInt32            msecElapsed)
 {
-	msec_counter++;
-	if(msec_counter>session_timeout)
-	{
-		session_flag=SESSION_NOT_ACTIVATED;
-		OpcUa_Timer_Delete(&Timer);
-		if(p_user_name!=OpcUa_Null)
-			username_free();
-		#ifndef NO_DEBUGING_
-		MY_TRACE("\nSession  abgelaufen!!! \n"); 
-		#endif /*_DEBUGING_*/
+	OpcUa_ReferenceParameter(pvCallbackData);
+	OpcUa_ReferenceParameter(hTimer);
 
-	}
+	expire_sessions(msecElapsed);
+	write_value_begin(11);
 	all_ValueAttribute_of_VariableTypeNodes_VariableNodes[11].Value.DateTime=OpcUa_DateTime_UtcNow();
+	write_value_end(11,&all_ValueAttribute_of_VariableTypeNodes_VariableNodes[11].Value.DateTime);
    return OpcUa_Good;
 }
 
@@ -1365,7 +1648,8 @@ OpcUa_StatusCode response_header_ausfuellen(OpcUa_ResponseHeader*  a_pResponseHe
 	if(OpcUa_IsGood(uStatus))
 	{
 		
-		if((OpcUa_UInt32)session_timeout<diff )
+		/* TimeoutHint 0 means no timeout */
+		if(a_pRequestHeader->TimeoutHint!=0 && a_pRequestHeader->TimeoutHint<diff )
 		{
 			#ifndef NO_DEBUGING_
 			MY_TRACE("\nServicelaufzeit:%u msec (TimeOut)\n",diff); 
@@ -1375,7 +1659,7 @@ OpcUa_StatusCode response_header_ausfuellen(OpcUa_ResponseHeader*  a_pResponseHe
 		else
 		{
 			#ifndef NO_DEBUGING_
-			MY_TRACE("\nServicelaufzeit:%u msec ServiceTimeOut: %.0f msec \n", diff , session_timeout ); 
+			MY_TRACE("\nServicelaufzeit:%u msec ServiceTimeOut: %u msec \n", diff , a_pRequestHeader->TimeoutHint ); 
 			#endif /*_DEBUGING_*/
 			a_pResponseHeader->ServiceResult=Status;
 		}
@@ -1395,7 +1679,9 @@ OpcUa_StatusCode response_header_ausfuellen(OpcUa_ResponseHeader*  a_pResponseHe
 	a_pResponseHeader->StringTable=OpcUa_Null;
 	
 	//Test value of variable DATA_VALUE
+	write_value_begin(8);
 	(*(all_ValueAttribute_of_VariableTypeNodes_VariableNodes[8].Value.Array.Value.DoubleArray+0))++;
+	write_value_end(8,OpcUa_Null);
 	//---------------------------------
 	return OpcUa_Good;
 }
@@ -1545,10 +1831,34 @@ OpcUa_StatusCode fill_server_variable(OpcUa_ApplicationDescription* p_Server)
 
 /*===========================================================================================*/
 /** @brief Main entry function.                                                              */
+/*  -compile <file>  writes the compiled-in address space as image to <file> and exits.      */
+/*  -image <file>    serves the address space image <file> instead of the compiled-in one.   */
+/*  -daemon          runs without console interaction until SIGTERM/SIGINT (CTRL-C).         */
 /*===========================================================================================*/
-int main(void)
+int main(int argc, char* argv[])
   {
 	OpcUa_StatusCode    uStatus					= OpcUa_Good;
+	OpcUa_StringA		sCompileFile			= OpcUa_Null;
+	OpcUa_StringA		sImageFile				= OpcUa_Null;
+	_AddressSpaceTables_ AddressSpace;
+	int					i;
+
+	for(i=1;i<argc;i++)
+	{
+		if(OpcUa_StrCmpA(argv[i],"-daemon")==0)
+			UaTestServer_g_bDaemon=OpcUa_True;
+		else if(i+1<argc && OpcUa_StrCmpA(argv[i],"-compile")==0)
+			sCompileFile=argv[++i];
+		else if(i+1<argc && OpcUa_StrCmpA(argv[i],"-image")==0)
+			sImageFile=argv[++i];
+		else
+			break;
+	}
+	if(i<argc || (sCompileFile!=OpcUa_Null && (sImageFile!=OpcUa_Null || UaTestServer_g_bDaemon)))
+	{
+		printf("Usage: %s [-compile <image file> | [-daemon] [-image <image file>]]\n",argv[0]);
+		return 1;
+	}
 
 	my_Read_ServiceType.ResponseType			= &OpcUa_ReadResponse_EncodeableType;
 	my_Browse_ServiceType.ResponseType			= &OpcUa_BrowseResponse_EncodeableType;
@@ -1558,12 +1868,29 @@ int main(void)
 	CloseSession.ResponseType					= &OpcUa_CloseSessionResponse_EncodeableType;
   	my_BrowseNext_ServiceType.ResponseType		= &OpcUa_BrowseNextResponse_EncodeableType;
 	my_FindServers_ServiceType.ResponseType		= &OpcUa_FindServersResponse_EncodeableType;
-	dummy_CreatSubscription.ResponseType            = &OpcUa_CreateSubscriptionResponse_EncodeableType;
+	my_CreateSubscription_ServiceType.ResponseType		= &OpcUa_CreateSubscriptionResponse_EncodeableType;
+	my_DeleteSubscriptions_ServiceType.ResponseType		= &OpcUa_DeleteSubscriptionsResponse_EncodeableType;
+	my_CreateMonitoredItems_ServiceType.ResponseType	= &OpcUa_CreateMonitoredItemsResponse_EncodeableType;
+	my_DeleteMonitoredItems_ServiceType.ResponseType	= &OpcUa_DeleteMonitoredItemsResponse_EncodeableType;
+	my_Publish_ServiceType.ResponseType					= &OpcUa_PublishResponse_EncodeableType;
 
-    printf("Warning: The sample server is intended to show how to use the ANSI C stack and is has not gone through any sort of quality assurance process. Therefore, it cannot be used in any production system.\n");
-    printf("Press enter to proceed or CTRL-C to exit now!\n");
-    getchar();
+	if(sCompileFile==OpcUa_Null && !UaTestServer_g_bDaemon)
+	{
+		printf("Warning: The sample server is intended to show how to use the ANSI C stack and is has not gone through any sort of quality assurance process. Therefore, it cannot be used in any production system.\n");
+		printf("Press enter to proceed or CTRL-C to exit now!\n");
+		getchar();
+	}
 	
+	if(sCompileFile==OpcUa_Null)
+	{
+		/* before the stack starts any thread */
+		uStatus = UaTestServer_InitializeShutdownSignals();
+		if(OpcUa_IsBad(uStatus))
+		{
+			printf("Could not install the signal handling!\n");
+			OpcUa_GotoError;
+		}
+	}
 	
     /* Initialize Stack */
     uStatus = UaTestServer_Initialize();
@@ -1572,11 +1899,40 @@ int main(void)
         printf("Could not initialize application!\n");
         OpcUa_GotoError;
     }
+
+	if(sCompileFile!=OpcUa_Null)
+	{
+		get_builtin_addressspace(&AddressSpace);
+		uStatus=compile_addressspace_image(&AddressSpace,sCompileFile);
+		if(OpcUa_IsBad(uStatus))
+			printf("Could not write address space image %s (0x%08X)!\n",sCompileFile,uStatus);
+		else
+			printf("Address space image written to %s.\n",sCompileFile);
+		UaTestServer_Clear();
+		return (int)uStatus;
+	}
 	
 	uStatus =initialize_value_attribute_of_variablenodes_variabletypenodes();
 	OpcUa_GotoErrorIfBad(uStatus)
 
-	OpcUa_Trace_Initialize();
+	if(sImageFile!=OpcUa_Null)
+	{
+		uStatus=map_addressspace_image(sImageFile,&AddressSpace);
+		if(OpcUa_IsBad(uStatus))
+		{
+			printf("Could not map address space image %s (0x%08X)!\n",sImageFile,uStatus);
+			OpcUa_GotoError;
+		}
+	}
+	else
+	{
+		get_builtin_addressspace(&AddressSpace);
+	}
+
+	uStatus =build_node_index(&AddressSpace);
+	OpcUa_GotoErrorIfBad(uStatus)
+
+	/* the tracer was initialized with the stack */
 	OpcUa_Trace_ChangeTraceLevel(OPCUA_TRACE_OUTPUT_LEVEL_SYSTEM);      //setting  tracelevel.  
 
 
@@ -1587,8 +1943,12 @@ int main(void)
     UaTestServer_Clear();
     
 
-    printf("Shutdown complete!\nPress enter to exit!\n");
-    getchar();
+    printf("Shutdown complete!\n");
+    if(!UaTestServer_g_bDaemon)
+    {
+        printf("Press enter to exit!\n");
+        getchar();
+    }
 
 
     return (int)uStatus;
@@ -1596,8 +1956,12 @@ int main(void)
 Error:
 
 
-    printf("Couldn't start server!\nPress enter to exit!\n");
-    getchar();
+    printf("Couldn't start server!\n");
+    if(!UaTestServer_g_bDaemon)
+    {
+        printf("Press enter to exit!\n");
+        getchar();
+    }
 
 
     /* Clean up Base */
@@ -31,16 +31,178 @@
 #include <opcua_serverstub.h>
 #include <opcua_string.h>
 #include <opcua_memory.h>
+#include <opcua_core.h>
+#include <opcua_mutex.h>
 #include <opcua_trace.h>
 #include "addressspace.h"
 #include "browseservice.h"
 #include "mytrace.h"
+#include "sessiontable.h"
 #include "general_header.h"
 
 
+#define MAX_CONTINUATIONPOINTS		(MAX_SESSIONS*MAX_BROWSE_CONTINUATIONPOINTS)
 
+static OpcUa_Mutex					continuationpoint_mutex		= OpcUa_Null;
+static _my_continuationpoint_		continuationpoints[MAX_CONTINUATIONPOINTS];
+static OpcUa_UInt32					continuationpoint_clock;
+static OpcUa_UInt32					last_continuationpoint_id;
 
 
+/*============================================================================
+ * remembers where Browse stopped for a node and hands out an opaque Id as
+ * ContinuationPoint. A session holding MAX_BROWSE_CONTINUATIONPOINTS already
+ * loses its least recently used one.
+ *===========================================================================*/
+OpcUa_StatusCode store_continuationpoint(OpcUa_UInt32 a_uSessionId, OpcUa_BrowseDescription* a_pNodeToBrowse, _BaseAttribute_* a_pNode, OpcUa_Int a_iPosition, OpcUa_UInt32 a_nMaxReferences, OpcUa_ByteString* a_pContinuationPoint)
+{
+	_my_continuationpoint_*		pPoint;
+	_BaseAttribute_*			pRefType	= OpcUa_Null;
+	OpcUa_Int					i;
+	OpcUa_Int					iFree		= -1;
+	OpcUa_Int					iOldest		= -1;
+	OpcUa_UInt32				uCount		= 0;
+	OpcUa_InitializeStatus(OpcUa_Module_Server, "store_continuationpoint");
+
+	/* the entry must not reference the request, so the ReferenceType is taken from the address space */
+	if(a_pNodeToBrowse->ReferenceTypeId.IdentifierType!=OpcUa_IdentifierType_Numeric)
+	{
+		pRefType=(_BaseAttribute_*)search_for_node(a_pNodeToBrowse->ReferenceTypeId);
+		if(pRefType==OpcUa_Null)
+		{
+			uStatus=OpcUa_BadReferenceTypeIdInvalid;
+			OpcUa_GotoError
+		}
+	}
+
+	a_pContinuationPoint->Data=(OpcUa_Byte*)OpcUa_Memory_Alloc(sizeof(OpcUa_UInt32));
+	OpcUa_GotoErrorIfAllocFailed((a_pContinuationPoint->Data))
+	a_pContinuationPoint->Length=sizeof(OpcUa_UInt32);
+
+	OpcUa_Mutex_Lock(continuationpoint_mutex);
+	for(i=0;i<MAX_CONTINUATIONPOINTS;i++)
+	{
+		if(continuationpoints[i].Id==0)
+		{
+			if(iFree<0)
+				iFree=i;
+			continue;
+		}
+		if(continuationpoints[i].SessionId!=a_uSessionId)
+			continue;
+		uCount++;
+		if(iOldest<0 || continuationpoints[i].LastUsed<continuationpoints[iOldest].LastUsed)
+			iOldest=i;
+	}
+	if(uCount>=MAX_BROWSE_CONTINUATIONPOINTS || iFree<0)
+	{
+		if(iOldest<0)
+		{
+			OpcUa_Mutex_Unlock(continuationpoint_mutex);
+			uStatus=OpcUa_BadNoContinuationPoints;
+			OpcUa_GotoError
+		}
+		#ifndef NO_DEBUGING_
+			MY_TRACE("\nContinuationPoint (Identifier:%u) verdraengt.\n",continuationpoints[iOldest].Id);
+		#endif /*_DEBUGING_*/
+		iFree=iOldest;
+	}
+
+	pPoint=&continuationpoints[iFree];
+	if(++last_continuationpoint_id==0)
+		last_continuationpoint_id=1;
+	pPoint->Id									=last_continuationpoint_id;
+	pPoint->SessionId							=a_uSessionId;
+	pPoint->LastUsed							=++continuationpoint_clock;
+	pPoint->Position							=a_iPosition;
+	pPoint->MaxReferences						=a_nMaxReferences;
+	pPoint->NodeToBrowse						=*a_pNodeToBrowse; //Strukturzuweisung ok.
+	pPoint->NodeToBrowse.NodeId					=a_pNode->NodeId;
+	if(pRefType!=OpcUa_Null)
+		pPoint->NodeToBrowse.ReferenceTypeId	=pRefType->NodeId;
+	OpcUa_MemCpy(a_pContinuationPoint->Data,sizeof(OpcUa_UInt32),&pPoint->Id,sizeof(OpcUa_UInt32));
+	OpcUa_Mutex_Unlock(continuationpoint_mutex);
+
+	#ifndef NO_DEBUGING_
+		MY_TRACE("\nContinuationPoint (Identifier:%u) fuer diesen Start Knoten gesetzt.\n",pPoint->Id);
+	#endif /*_DEBUGING_*/
+
+	OpcUa_ReturnStatusCode;
+	OpcUa_BeginErrorHandling;
+
+	OpcUa_ByteString_Clear(a_pContinuationPoint);
+
+	OpcUa_FinishErrorHandling;
+}
+
+/* removes the ContinuationPoint of the session from the table, a copy lands in a_pPoint */
+static OpcUa_StatusCode take_continuationpoint(OpcUa_UInt32 a_uSessionId, const OpcUa_ByteString* a_pContinuationPoint, _my_continuationpoint_* a_pPoint)
+{
+	OpcUa_UInt32	uId;
+	OpcUa_Int		i;
+
+	if(a_pContinuationPoint->Data==OpcUa_Null || a_pContinuationPoint->Length!=sizeof(OpcUa_UInt32))
+		return OpcUa_BadContinuationPointInvalid;
+	OpcUa_MemCpy(&uId,sizeof(OpcUa_UInt32),a_pContinuationPoint->Data,sizeof(OpcUa_UInt32));
+	if(uId==0)
+		return OpcUa_BadContinuationPointInvalid;
+
+	OpcUa_Mutex_Lock(continuationpoint_mutex);
+	for(i=0;i<MAX_CONTINUATIONPOINTS;i++)
+	{
+		if(continuationpoints[i].Id==uId && continuationpoints[i].SessionId==a_uSessionId)
+		{
+			*a_pPoint=continuationpoints[i];
+			continuationpoints[i].Id=0;
+			OpcUa_Mutex_Unlock(continuationpoint_mutex);
+			return OpcUa_Good;
+		}
+	}
+	OpcUa_Mutex_Unlock(continuationpoint_mutex);
+	return OpcUa_BadContinuationPointInvalid;
+}
+
+OpcUa_StatusCode initialize_continuationpoints(OpcUa_Void)
+{
+	OpcUa_InitializeStatus(OpcUa_Module_Server, "initialize_continuationpoints");
+
+	OpcUa_MemSet(continuationpoints,0,sizeof(continuationpoints));
+	continuationpoint_clock=0;
+	last_continuationpoint_id=0;
+
+	if(continuationpoint_mutex==OpcUa_Null)
+	{
+		uStatus=OpcUa_Mutex_Create(&continuationpoint_mutex);
+		OpcUa_GotoErrorIfBad(uStatus)
+	}
+
+	OpcUa_ReturnStatusCode;
+	OpcUa_BeginErrorHandling;
+	OpcUa_FinishErrorHandling;
+}
+
+/* frees the ContinuationPoints of a session that ends */
+OpcUa_Void delete_session_continuationpoints(OpcUa_UInt32 a_uSessionId)
+{
+	OpcUa_Int i;
+
+	if(continuationpoint_mutex==OpcUa_Null)
+		return;
+
+	OpcUa_Mutex_Lock(continuationpoint_mutex);
+	for(i=0;i<MAX_CONTINUATIONPOINTS;i++)
+	{
+		if(continuationpoints[i].SessionId==a_uSessionId)
+			continuationpoints[i].Id=0;
+	}
+	OpcUa_Mutex_Unlock(continuationpoint_mutex);
+}
+
+OpcUa_Void clear_continuationpoints(OpcUa_Void)
+{
+	if(continuationpoint_mutex!=OpcUa_Null)
+		OpcUa_Mutex_Delete(&continuationpoint_mutex);
+}
 
 
 /*============================================================================
@@ -59,17 +221,13 @@ OpcUa_StatusCode my_BrowseNext(
     OpcUa_Int32*               a_pNoOfDiagnosticInfos,
     OpcUa_DiagnosticInfo**     a_pDiagnosticInfos)
 {
-	extern OpcUa_Int			Continuation_Point_Identifier;
-	OpcUa_Int m;
-	extern OpcUa_UInt32		securechannelId;
-	extern OpcUa_UInt32		session_flag;
-	extern OpcUa_Double		msec_counter;
-	extern OpcUa_String*	p_user_name;
-	extern enum
-	{
-		free_to_use=0,
-		occupied=1
-	}continuation_point;
+	_my_continuationpoint_		Point;
+	_BaseAttribute_*			pointer_to_node;
+	OpcUa_Int					m;
+	OpcUa_Int					iNext;
+	OpcUa_StatusCode			uResult;
+	OpcUa_UInt32				uSessionId				= 0;
+	OpcUa_UInt32				uNoOfContinuationPoints	= 0;
 
     OpcUa_InitializeStatus(OpcUa_Module_Server, "OpcUa_ServerApi_BrowseNext");
 
@@ -87,84 +245,71 @@ OpcUa_StatusCode my_BrowseNext(
     OpcUa_ReturnErrorIfArgumentNull(a_pNoOfDiagnosticInfos);
     OpcUa_ReturnErrorIfArgumentNull(a_pDiagnosticInfos);
 
+	*a_pNoOfResults=0;
+	*a_pResults=OpcUa_Null;
 	*a_pNoOfDiagnosticInfos=0;
 	*a_pDiagnosticInfos=OpcUa_Null;
 
-	RESET_SESSION_COUNTER
-
 #ifndef NO_DEBUGING_
 	MY_TRACE("\n\n\nBROWSENEXTSERVICE=========================================\n");
-	if(p_user_name!=OpcUa_Null)
-		MY_TRACE("\nUser:%s\n",OpcUa_String_GetRawString(p_user_name)); 
 #endif /*_DEBUGING_*/
 
 
-	if(OpcUa_IsBad(session_flag))
-	{
-		//teile client mit , dass Session geschlossen ist
-#ifndef NO_DEBUGING_
-		MY_TRACE("\nSession nicht aktiv\n"); 
-#endif /*_DEBUGING_*/
-		uStatus=OpcUa_BadSessionNotActivated;
-		OpcUa_GotoError;
-	}
+	uStatus=check_session(a_pRequestHeader,&uSessionId);
+	OpcUa_GotoErrorIfBad(uStatus);
 
-	uStatus=check_authentication_token(a_pRequestHeader);
-	if(OpcUa_IsBad(uStatus))
+	if(a_nNoOfContinuationPoints==0)
 	{
-#ifndef NO_DEBUGING_
-		MY_TRACE("\nAuthentication Token ungltig.\n"); 
-#endif /*_DEBUGING_*/
-		OpcUa_GotoError;
+		uStatus=OpcUa_BadNothingToDo;
+		OpcUa_GotoError
 	}
 
-	if(a_bReleaseContinuationPoints==OpcUa_False)
-	{
-		*a_pResults=OpcUa_Memory_Alloc(a_nNoOfContinuationPoints*sizeof(OpcUa_BrowseResult));
-		OpcUa_GotoErrorIfAllocFailed((*a_pResults))
+	*a_pResults=OpcUa_Memory_Alloc(a_nNoOfContinuationPoints*sizeof(OpcUa_BrowseResult));
+	OpcUa_GotoErrorIfAllocFailed((*a_pResults))
 
-		*a_pNoOfResults=a_nNoOfContinuationPoints;
+	*a_pNoOfResults=a_nNoOfContinuationPoints;
 
-		continuation_point=free_to_use;
+	for(m=0;m<a_nNoOfContinuationPoints;m++)
+	{
+		OpcUa_BrowseResult_Initialize((*a_pResults+m));
+		(*a_pResults+m)->StatusCode=take_continuationpoint(uSessionId,(a_pContinuationPoints+m),&Point);
+		if(OpcUa_IsBad((*a_pResults+m)->StatusCode))
+		{
+			#ifndef NO_DEBUGING_
+				MY_TRACE("\n%d. ContinuationPoint ungueltig!!!\n",m); 
+			#endif /*_DEBUGING_*/
+			continue;
+		}
+		if(a_bReleaseContinuationPoints!=OpcUa_False)
+		{
+			#ifndef NO_DEBUGING_
+				MY_TRACE("\nContinuationPoint (Identifier:%u) geloescht.\n",Point.Id);
+			#endif /*_DEBUGING_*/
+			continue;
+		}
 
-		for(m=0;m<a_nNoOfContinuationPoints;m++)
+		#ifndef NO_DEBUGING_
+			MY_TRACE("\nContinuationPoint (Identifier:%u) wurde uebergeben.\n",Point.Id); 
+		#endif /*_DEBUGING_*/
+		/* the cursor resumes right at the next reference, the page costs no more than its own references */
+		pointer_to_node=(_BaseAttribute_*)search_for_node(Point.NodeToBrowse.NodeId);
+		(*a_pResults+m)->StatusCode=browse(&Point.NodeToBrowse,(*a_pResults+m),Point.Position,Point.MaxReferences,&iNext);
+		if(OpcUa_IsGood((*a_pResults+m)->StatusCode) && iNext>=0)
 		{
-			OpcUa_BrowseResult_Initialize((*a_pResults+m));
-			if((a_pContinuationPoints+m)->Data!=OpcUa_Null)
+			uResult=OpcUa_BadNoContinuationPoints;
+			if(uNoOfContinuationPoints<MAX_BROWSE_CONTINUATIONPOINTS)
 			{
-				if((((_my_continuationpoint_*)(a_pContinuationPoints+m)->Data)->Cont_Point_Identiefer)==Continuation_Point_Identifier)
-				{
-					#ifndef NO_DEBUGING_
-						MY_TRACE("\nContinuationPoint (Identifier:%d) wurde uebergeben.\n",(((_my_continuationpoint_*)(a_pContinuationPoints+m)->Data)->Cont_Point_Identiefer)); 
-					#endif /*_DEBUGING_*/
-					(*a_pResults+m)->StatusCode=browse(&(((_my_continuationpoint_*)(a_pContinuationPoints+m)->Data)->NodeToBrowse),(*a_pResults+m),((_my_continuationpoint_*)(a_pContinuationPoints+m)->Data)->Aktuelle_Ref);
-				}
-				else
-				{
-					(*a_pResults+m)->StatusCode=OpcUa_BadContinuationPointInvalid;
-					#ifndef NO_DEBUGING_
-						MY_TRACE("\n%d. ContinuationPoint Identifier ungueltig!!!\n",m); 
-					#endif /*_DEBUGING_*/
-				}
-
+				uResult=store_continuationpoint(uSessionId,&Point.NodeToBrowse,pointer_to_node,iNext,Point.MaxReferences,&(*a_pResults+m)->ContinuationPoint);
+				uNoOfContinuationPoints++;
 			}
-			else
+			if(OpcUa_IsBad(uResult))
 			{
-				(*a_pResults+m)->StatusCode=OpcUa_BadContinuationPointInvalid;
-				#ifndef NO_DEBUGING_
-					MY_TRACE("\n%d. ContinuationPoint ungueltig!!!\n",m); 
-				#endif /*_DEBUGING_*/
+				OpcUa_BrowseResult_Clear((*a_pResults+m));
+				(*a_pResults+m)->StatusCode=uResult;
 			}
 		}
 	}
-	else
-	{
-		Continuation_Point_Identifier=0;
-		#ifndef NO_DEBUGING_
-			MY_TRACE("\nBrowseNext aufgerufen, Cont.Point zu loeschen");
-			MY_TRACE("\n..................ContinuationPoint geloescht.\n");
-		#endif /*_DEBUGING_*/
-	}
+
 	uStatus = response_header_ausfuellen(a_pResponseHeader,a_pRequestHeader,uStatus);
 	if(OpcUa_IsBad(uStatus))
 	{
@@ -174,12 +319,10 @@ OpcUa_StatusCode my_BrowseNext(
 	MY_TRACE("\nSERVICE===ENDE============================================\n\n\n"); 
 #endif /*_DEBUGING_*/
 
-	RESET_SESSION_COUNTER
-
     OpcUa_ReturnStatusCode;
     OpcUa_BeginErrorHandling;
 
-    
+    *a_pNoOfResults=0;
 	uStatus = response_header_ausfuellen(a_pResponseHeader,a_pRequestHeader,uStatus);
 	if(OpcUa_IsBad(uStatus))
 	{
@@ -189,6 +332,5 @@ OpcUa_StatusCode my_BrowseNext(
 	MY_TRACE("\nSERVICEENDE (IM SERVICE SIND FEHLER AUFGETRETTEN)===========\n\n\n"); 
 #endif /*_DEBUGING_*/
 	
-	RESET_SESSION_COUNTER
     OpcUa_FinishErrorHandling;
 }
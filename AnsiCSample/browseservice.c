@@ -30,12 +30,14 @@
 /* serverstub (basic includes for implementing a server based on the stack) */
 #include <opcua_serverstub.h>
 #include <opcua_string.h>
+#include <opcua_guid.h>
 #include <opcua_memory.h>
 #include <opcua_trace.h>
 #include "addressspace.h"
 #include "browseservice.h"
 #include "addressspace_init.h"
 #include "mytrace.h"
+#include "sessiontable.h"
 #include "general_header.h"
 
 
@@ -45,13 +47,6 @@
 /*compare_nodes: liefert (1) bei Gleichheit */
 
 
-extern enum
-{
-	free_to_use=0,
-	occupied=1
-}continuation_point;
-
-
 /*============================================================================
  * method which implements the Browse service.
  *===========================================================================*/
@@ -71,16 +66,11 @@ OpcUa_StatusCode my_Browse(
 {
 	_BaseAttribute_*		pointer_to_node;
 	OpcUa_Int				m;
-	extern OpcUa_UInt32		securechannelId;
-	extern OpcUa_UInt32		session_flag;
-	extern OpcUa_Double		msec_counter;
-	extern OpcUa_String*	p_user_name;
-	extern OpcUa_UInt32		max_ref_per_node;
-
-#ifndef NO_DEBUGING_
-	extern OpcUa_Int			Continuation_Point_Identifier;
-#endif /*_DEBUGING_*/
-	
+	OpcUa_Int				iNext;
+	OpcUa_StatusCode		uResult;
+	OpcUa_UInt32			uSessionId				= 0;
+	OpcUa_UInt32			uMaxReferences;
+	OpcUa_UInt32			uNoOfContinuationPoints	= 0;
 
     OpcUa_InitializeStatus(OpcUa_Module_Server, "OpcUa_ServerApi_Browse");
 
@@ -97,35 +87,14 @@ OpcUa_StatusCode my_Browse(
 
 	*a_pNoOfDiagnosticInfos=0;
 	*a_pDiagnosticInfos=OpcUa_Null;
-		 
-	RESET_SESSION_COUNTER
 
 #ifndef NO_DEBUGING_
 	MY_TRACE("\n\n\nBROWSESERVICE=============================================\n");
-	if(p_user_name!=OpcUa_Null)
-		MY_TRACE("\nUser:%s\n",OpcUa_String_GetRawString(p_user_name));  
 #endif /*_DEBUGING_*/
 
 
-	if(OpcUa_IsBad(session_flag))
-	{
-		//teile client mit , dass Session geschlossen ist
-#ifndef NO_DEBUGING_
-		MY_TRACE("\nSession nicht aktiv\n"); 
-#endif /*_DEBUGING_*/
-		uStatus=OpcUa_BadSessionNotActivated;
-		OpcUa_GotoError;
-	}
-
-	
-	uStatus=check_authentication_token(a_pRequestHeader);
-	if(OpcUa_IsBad(uStatus))
-	{
-#ifndef NO_DEBUGING_
-		MY_TRACE("\nAuthentication Token ungltig.\n"); 
-#endif /*_DEBUGING_*/
-		OpcUa_GotoError;
-	}
+	uStatus=check_session(a_pRequestHeader,&uSessionId);
+	OpcUa_GotoErrorIfBad(uStatus);
 
 	if(a_nNoOfNodesToBrowse==0)
 	{
@@ -133,12 +102,10 @@ OpcUa_StatusCode my_Browse(
 		OpcUa_GotoError
 	}
 
-	continuation_point=free_to_use;
-	
 	if(a_nRequestedMaxReferencesPerNode>0 && a_nRequestedMaxReferencesPerNode<MAX_NO_OF_RETURNED_REFERENCES)
-		max_ref_per_node=a_nRequestedMaxReferencesPerNode;
+		uMaxReferences=a_nRequestedMaxReferencesPerNode;
 	else
-		max_ref_per_node=MAX_NO_OF_RETURNED_REFERENCES;
+		uMaxReferences=MAX_NO_OF_RETURNED_REFERENCES;
 
 	*a_pResults=OpcUa_Memory_Alloc(a_nNoOfNodesToBrowse*sizeof(OpcUa_BrowseResult));
 	OpcUa_GotoErrorIfAllocFailed((*a_pResults))
@@ -154,8 +121,22 @@ OpcUa_StatusCode my_Browse(
 			#endif /*_DEBUGING_*/
 			if(pointer_to_node!=OpcUa_Null)/*untersuche nur existierende Knoten*/
 			{
-				(*a_pResults+m)->StatusCode=browse((a_pNodesToBrowse+m),(*a_pResults+m),0);
-				
+				(*a_pResults+m)->StatusCode=browse((a_pNodesToBrowse+m),(*a_pResults+m),0,uMaxReferences,&iNext);
+				if(OpcUa_IsGood((*a_pResults+m)->StatusCode) && iNext>=0)
+				{
+					/* a request never evicts the points it handed out itself */
+					uResult=OpcUa_BadNoContinuationPoints;
+					if(uNoOfContinuationPoints<MAX_BROWSE_CONTINUATIONPOINTS)
+					{
+						uResult=store_continuationpoint(uSessionId,(a_pNodesToBrowse+m),pointer_to_node,iNext,uMaxReferences,&(*a_pResults+m)->ContinuationPoint);
+						uNoOfContinuationPoints++;
+					}
+					if(OpcUa_IsBad(uResult))
+					{
+						OpcUa_BrowseResult_Clear((*a_pResults+m));
+						(*a_pResults+m)->StatusCode=uResult;
+					}
+				}
 			}/*Ende:(untersuche nur existierende Knoten)*/
 			else
 			{
@@ -174,8 +155,6 @@ OpcUa_StatusCode my_Browse(
 	MY_TRACE("\nSERVICE===ENDE============================================\n\n\n"); 
 #endif /*_DEBUGING_*/
 
-	RESET_SESSION_COUNTER
-
     OpcUa_ReturnStatusCode;
     OpcUa_BeginErrorHandling;
 
@@ -188,28 +167,28 @@ OpcUa_StatusCode my_Browse(
 #ifndef NO_DEBUGING_
 	MY_TRACE("\nSERVICEENDE (IM SERVICE SIND FEHLER AUFGETRETTEN)===========\n\n\n"); 
 #endif /*_DEBUGING_*/
-	RESET_SESSION_COUNTER
     OpcUa_FinishErrorHandling;
 }
 
-OpcUa_StatusCode browse(OpcUa_BrowseDescription* a_pNodesToBrowse,OpcUa_BrowseResult* a_pResults,OpcUa_Int x)
+/*============================================================================
+ * fills a_pResults with at most a_nMaxReferences references of the node,
+ * starting at position x of its adjacency. *a_pNext receives the position of
+ * the next matching reference for a continuation point, -1 if there is none.
+ *===========================================================================*/
+OpcUa_StatusCode browse(OpcUa_BrowseDescription* a_pNodesToBrowse,OpcUa_BrowseResult* a_pResults,OpcUa_Int x,OpcUa_UInt32 a_nMaxReferences,OpcUa_Int* a_pNext)
 {
-	extern OpcUa_Int			Continuation_Point_Identifier;
-	extern OpcUa_Int			Cont_Point_Counter;
 	OpcUa_Int					i,n;
 	OpcUa_UInt32				NoofRef;
+	OpcUa_UInt32				uCapacity;
 	_BaseAttribute_*			pointer_to_node;
 	_BaseAttribute_*			pointer_to_targetnode;
-	extern OpcUa_UInt32			max_ref_per_node;
+	_ReferenceNode_*			p_ref;
+	const OpcUa_NodeId*			p_typedefinition;
 	OpcUa_InitializeStatus(OpcUa_Module_Server, "browse");
 
-	if(continuation_point==occupied)
-	{
-		return OpcUa_BadNoContinuationPoints;
-	}
-
 	NoofRef						=0;
-	Cont_Point_Counter			=Cont_Point_Counter+4;
+	uCapacity					=0;
+	*a_pNext					=-1;
 	pointer_to_node= (_BaseAttribute_*)search_for_node(a_pNodesToBrowse->NodeId);
 #ifndef NO_DEBUGING_
 	MY_TRACE("\nStart Knoten:%s\n",((_BaseAttribute_*)search_for_node(a_pNodesToBrowse->NodeId))->DisplayName);
@@ -225,33 +204,34 @@ OpcUa_StatusCode browse(OpcUa_BrowseDescription* a_pNodesToBrowse,OpcUa_BrowseRe
 #endif /*_DEBUGING_*/
 	if((pointer_to_node)->NoOfReferences)/*hat der Startknoten Referenzen ?  Ja->weiter mit for-Schleife ,Nein->nachster Startknoten*/
 	{
-		for(i=x;i<((pointer_to_node)->NoOfReferences);i++)/*durchsuche alle Referenzen des Startknotens*******/
+		/*next_reference prueft ReferenceTypeId, NodeClassMask und BrowseDirection*/
+		for(i=x;(p_ref=next_reference(a_pNodesToBrowse,pointer_to_node,&i,&pointer_to_targetnode))!=OpcUa_Null;i++)/*durchsuche alle Referenzen des Startknotens*******/
 		{
-			pointer_to_targetnode=(_BaseAttribute_*) search_for_node(((pointer_to_node)->References+i)->Target_NodeId);
-			if(pointer_to_targetnode!=OpcUa_Null)
-			{
-			if(/*pruefe filtermasken: ReferencesTypeId, NodeClassMask*/ ist_unterknoten(a_pNodesToBrowse->ReferenceTypeId,(pointer_to_node->References+i)->ReferenceTypeId,a_pNodesToBrowse->IncludeSubtypes)==OpcUa_True && check_Mask(a_pNodesToBrowse->NodeClassMask, pointer_to_targetnode->NodeClass)==OpcUa_True)
-			{	
-				if(/*pruefe filtermaske browsedir.*/check_dir(a_pNodesToBrowse->BrowseDirection,(pointer_to_node->References+i))==OpcUa_True)
-				{
 								#ifndef NO_DEBUGING_
 									MY_TRACE("TargetNode wird zurueckgeliefert:%s",pointer_to_targetnode->DisplayName);
 								#endif /*_DEBUGING_*/
-								a_pResults->References=OpcUa_Memory_ReAlloc(a_pResults->References,(NoofRef+1)*sizeof(OpcUa_ReferenceDescription));
-								OpcUa_GotoErrorIfAllocFailed((a_pResults->References))
+								if(NoofRef==0)
+								{
+									/* a page never holds more than the references left behind the first match */
+									uCapacity=(OpcUa_UInt32)(pointer_to_node->NoOfReferences-i);
+									if(uCapacity>a_nMaxReferences)
+										uCapacity=a_nMaxReferences;
+									a_pResults->References=OpcUa_Memory_Alloc(uCapacity*sizeof(OpcUa_ReferenceDescription));
+									OpcUa_GotoErrorIfAllocFailed((a_pResults->References))
+								}
 								OpcUa_ReferenceDescription_Initialize((a_pResults ->References+NoofRef));
 
 								/*NodeId of ReferenceType*/
 								if(check_Mask(a_pNodesToBrowse->ResultMask,OpcUa_BrowseResultMask_ReferenceTypeId)== OpcUa_True)/*wenn False wird ausmaskiert*/
 								{
-									(a_pResults ->References+NoofRef)->ReferenceTypeId=(pointer_to_node->References+i)->ReferenceTypeId;
+									(a_pResults ->References+NoofRef)->ReferenceTypeId=p_ref->ReferenceTypeId;
 								}
 								/*************************/
 								
 								/*IsForward criteria*/
 								if(check_Mask(a_pNodesToBrowse->ResultMask,OpcUa_BrowseResultMask_IsForward)== OpcUa_True)/*wenn False wird ausmaskiert*/
 								{
-									if(((pointer_to_node)->References+i)->IsInverse==OpcUa_True)
+									if(p_ref->IsInverse==OpcUa_True)
 									{
 										(a_pResults ->References+NoofRef)->IsForward=OpcUa_False;
 									}
@@ -299,42 +279,29 @@ OpcUa_StatusCode browse(OpcUa_BrowseDescription* a_pNodesToBrowse,OpcUa_BrowseRe
 								{
 									if((pointer_to_targetnode->NodeClass)==OpcUa_NodeClass_Object ||(pointer_to_targetnode->NodeClass)==OpcUa_NodeClass_Variable )
 									{
-										for(n=0;n<(pointer_to_targetnode->NoOfReferences);n++)
+										p_typedefinition=type_definition(pointer_to_targetnode);
+										if(p_typedefinition!=OpcUa_Null)
 										{
-											if(((pointer_to_targetnode->References+n)->ReferenceTypeId.Identifier.Numeric)==OpcUaId_HasTypeDefinition)
-											{
-												//OpcUa_String_AttachCopy(&(a_pResults ->References+NoofRef)->TypeDefinition.NamespaceUri,(pointer_to_targetnode->References+n)->Target_NamespaceUri);
-												(a_pResults ->References+NoofRef)->TypeDefinition.NodeId=(pointer_to_targetnode->References+n)->Target_NodeId;
-												(a_pResults ->References+NoofRef)->TypeDefinition.ServerIndex=0;
-											}
+											(a_pResults ->References+NoofRef)->TypeDefinition.NodeId=*p_typedefinition;
+											(a_pResults ->References+NoofRef)->TypeDefinition.ServerIndex=0;
 										}
 									}
 								}
 								NoofRef++;
 								/*******************************/
-								if(NoofRef >= max_ref_per_node)
+								if(NoofRef >= uCapacity)
 								{
-									if(need_continuationpoint(a_pNodesToBrowse,(i+1))==OpcUa_True )
+									n=i+1;
+									if(next_reference(a_pNodesToBrowse,pointer_to_node,&n,&pointer_to_targetnode)!=OpcUa_Null)
 									{
-										a_pResults ->ContinuationPoint.Data=(OpcUa_Byte*)OpcUa_Memory_Alloc(sizeof(_my_continuationpoint_));
-										OpcUa_GotoErrorIfAllocFailed((a_pResults ->ContinuationPoint.Data))
-										a_pResults ->ContinuationPoint.Length=sizeof(_my_continuationpoint_);
-										((_my_continuationpoint_*)a_pResults->ContinuationPoint.Data)->NodeToBrowse=*a_pNodesToBrowse; //Strukturzuweisung ok.
-										((_my_continuationpoint_*)a_pResults->ContinuationPoint.Data)->Aktuelle_Ref=(i+1);
-										((_my_continuationpoint_*)a_pResults->ContinuationPoint.Data)->Cont_Point_Identiefer=Cont_Point_Counter;
-										Continuation_Point_Identifier=Cont_Point_Counter;
+										*a_pNext=n;
 										#ifndef NO_DEBUGING_
-											MY_TRACE("\nContinuationPoint (Identifier:%d) fuer diesen Start Knoten gesetzt.\n",Continuation_Point_Identifier);
-											MY_TRACE("und zeigt auf naechsten TargetNode:%s\n",((_BaseAttribute_*) search_for_node(((pointer_to_node)->References+(i+1))->Target_NodeId))->DisplayName);
+											MY_TRACE("\nContinuationPoint fuer diesen Start Knoten noetig,\n");
+											MY_TRACE("zeigt auf naechsten TargetNode:%s\n",pointer_to_targetnode->DisplayName);
 										#endif /*_DEBUGING_*/
-										continuation_point=occupied;
-										break;
 									}
+									break;
 								}
-				}/*Ende: filtermaske browsedir.*/	
-			}/*Ende: filtermasken ReferencesTypeId, NodeClassMask*/
-			}
-			
 		}/*Ende:  (durchsuche alle Referenzen des Startknotens)  *********************************************************/
 		a_pResults ->NoOfReferences=NoofRef;
 	}
@@ -360,11 +327,529 @@ OpcUa_StatusCode browse(OpcUa_BrowseDescription* a_pNodesToBrowse,OpcUa_BrowseRe
 	OpcUa_FinishErrorHandling;
 }
 
+/*============================================================================
+ * hash index over the NodeIds of all nodes, built once at startup.
+ *===========================================================================*/
+
+/* references of one node with the same direction and ReferenceType */
+typedef struct
+{
+	OpcUa_Boolean		IsInverse;
+	OpcUa_Int			RefType;			/* index in node_tables.ReferenceTypes, -1 if unknown */
+	OpcUa_NodeId		ReferenceTypeId;
+	OpcUa_Int			First;
+	OpcUa_Int			Count;
+}_RefGroup_;
+
+/* the references of a node regrouped by direction (forward first) and ReferenceType;
+   browse() and the continuation points count positions in this order */
+typedef struct
+{
+	OpcUa_Int			NoOfGroups;
+	_RefGroup_*			Groups;
+	OpcUa_Int*			RefOrder;			/* index in References for every position */
+	_BaseAttribute_**	Targets;			/* resolved target node for every position */
+	OpcUa_NodeId*		pTypeDefinition;
+}_NodeAdjacency_;
+
+typedef struct
+{
+	OpcUa_UInt32		Hash;
+	_BaseAttribute_*	pNode;
+	_NodeAdjacency_*	pAdjacency;
+}_NodeIndexEntry_;
+
+static _NodeIndexEntry_*	node_index		= OpcUa_Null;
+static OpcUa_UInt32			node_index_mask	= 0;
+static _AddressSpaceTables_	node_tables;
+
+static _NodeAdjacency_*		node_adjacency	= OpcUa_Null;
+static _RefGroup_*			ref_groups		= OpcUa_Null;
+static OpcUa_Int*			ref_order		= OpcUa_Null;
+static _BaseAttribute_**	ref_targets		= OpcUa_Null;
+
+/* ref_type_closure[a*ref_type_words+b/32] has bit b%32 set if ReferenceType b is a or a subtype of a */
+static OpcUa_UInt32*		ref_type_closure= OpcUa_Null;
+static OpcUa_Int			ref_type_words	= 0;
+
+#define REF_TYPE_IS_SUBTYPE(a,b)	((ref_type_closure[(a)*ref_type_words+(b)/32]>>((b)%32))&1)
+
+static OpcUa_StatusCode build_reference_tables(OpcUa_Void);
+
+static OpcUa_UInt32 hash_bytes(OpcUa_UInt32 uHash, const OpcUa_Byte* pData, OpcUa_UInt32 uLength)
+{
+	OpcUa_UInt32 i;
+
+	for(i=0;i<uLength;i++)
+	{
+		uHash = (uHash ^ pData[i]) * 16777619u;		/* FNV-1a */
+	}
+	return uHash;
+}
+
+static OpcUa_UInt32 hash_nodeid(const OpcUa_NodeId* pNodeId)
+{
+	OpcUa_UInt32 uHash = 2166136261u;
+
+	uHash = hash_bytes(uHash,(const OpcUa_Byte*)&pNodeId->IdentifierType,sizeof(pNodeId->IdentifierType));
+	uHash = hash_bytes(uHash,(const OpcUa_Byte*)&pNodeId->NamespaceIndex,sizeof(pNodeId->NamespaceIndex));
+
+	switch(pNodeId->IdentifierType)
+	{
+	case OpcUa_IdentifierType_Numeric:
+		uHash = hash_bytes(uHash,(const OpcUa_Byte*)&pNodeId->Identifier.Numeric,sizeof(OpcUa_UInt32));
+		break;
+	case OpcUa_IdentifierType_String:
+		uHash = hash_bytes(uHash,(const OpcUa_Byte*)OpcUa_String_GetRawString((OpcUa_String*)&pNodeId->Identifier.String),OpcUa_String_StrLen(&pNodeId->Identifier.String));
+		break;
+	case OpcUa_IdentifierType_Guid:
+		if(pNodeId->Identifier.Guid!=OpcUa_Null)
+			uHash = hash_bytes(uHash,(const OpcUa_Byte*)pNodeId->Identifier.Guid,sizeof(OpcUa_Guid));
+		break;
+	case OpcUa_IdentifierType_Opaque:
+		if(pNodeId->Identifier.ByteString.Length>0)
+			uHash = hash_bytes(uHash,pNodeId->Identifier.ByteString.Data,(OpcUa_UInt32)pNodeId->Identifier.ByteString.Length);
+		break;
+	default:
+		break;
+	}
+	return uHash;
+}
+
+static OpcUa_Boolean is_same_nodeid(const OpcUa_NodeId* pNodeId_1, const OpcUa_NodeId* pNodeId_2)
+{
+	if(pNodeId_1->IdentifierType!=pNodeId_2->IdentifierType || pNodeId_1->NamespaceIndex!=pNodeId_2->NamespaceIndex)
+		return OpcUa_False;
+
+	switch(pNodeId_1->IdentifierType)
+	{
+	case OpcUa_IdentifierType_Numeric:
+		return (OpcUa_Boolean)(pNodeId_1->Identifier.Numeric==pNodeId_2->Identifier.Numeric);
+	case OpcUa_IdentifierType_String:
+		return (OpcUa_Boolean)(OpcUa_String_StrLen(&pNodeId_1->Identifier.String)==OpcUa_String_StrLen(&pNodeId_2->Identifier.String)
+			&& OpcUa_MemCmp(OpcUa_String_GetRawString((OpcUa_String*)&pNodeId_1->Identifier.String),
+							OpcUa_String_GetRawString((OpcUa_String*)&pNodeId_2->Identifier.String),
+							OpcUa_String_StrLen(&pNodeId_1->Identifier.String))==0);
+	case OpcUa_IdentifierType_Guid:
+		if(pNodeId_1->Identifier.Guid==OpcUa_Null || pNodeId_2->Identifier.Guid==OpcUa_Null)
+			return (OpcUa_Boolean)(pNodeId_1->Identifier.Guid==pNodeId_2->Identifier.Guid);
+		return OpcUa_Guid_IsEqual(pNodeId_1->Identifier.Guid,pNodeId_2->Identifier.Guid);
+	case OpcUa_IdentifierType_Opaque:
+		return (OpcUa_Boolean)(pNodeId_1->Identifier.ByteString.Length==pNodeId_2->Identifier.ByteString.Length
+			&& (pNodeId_1->Identifier.ByteString.Length<=0
+				|| OpcUa_MemCmp(pNodeId_1->Identifier.ByteString.Data,pNodeId_2->Identifier.ByteString.Data,pNodeId_1->Identifier.ByteString.Length)==0));
+	default:
+		return OpcUa_False;
+	}
+}
+
+/* the first node with a NodeId stays in the index */
+static OpcUa_Void insert_node_index(_BaseAttribute_* pNode)
+{
+	OpcUa_UInt32 uHash = hash_nodeid(&pNode->NodeId);
+	OpcUa_UInt32 uSlot = uHash & node_index_mask;
+
+	while(node_index[uSlot].pNode!=OpcUa_Null)
+	{
+		if(node_index[uSlot].Hash==uHash && is_same_nodeid(&node_index[uSlot].pNode->NodeId,&pNode->NodeId))
+			return;
+		uSlot=(uSlot+1)&node_index_mask;
+	}
+	node_index[uSlot].Hash=uHash;
+	node_index[uSlot].pNode=pNode;
+}
+
+/* the node arrays compiled into the server (addressspace_init.h) */
+OpcUa_Void get_builtin_addressspace(_AddressSpaceTables_* pTables)
+{
+	pTables->ObjectTypes		=alle_ObjectTypeKnoten;
+	pTables->NoOfObjectTypes	=ARRAY_SIZE_(alle_ObjectTypeKnoten);
+	pTables->Objects			=alle_ObjectKnoten;
+	pTables->NoOfObjects		=ARRAY_SIZE_(alle_ObjectKnoten);
+	pTables->ReferenceTypes		=alle_ReferencesTypeKnoten;
+	pTables->NoOfReferenceTypes	=ARRAY_SIZE_(alle_ReferencesTypeKnoten);
+	pTables->Variables			=all_VariableNodes;
+	pTables->NoOfVariables		=ARRAY_SIZE_(all_VariableNodes);
+	pTables->VariableTypes		=all_VariableTypeNodes;
+	pTables->NoOfVariableTypes	=ARRAY_SIZE_(all_VariableTypeNodes);
+	pTables->DataTypes			=alle_DataTypeKnoten;
+	pTables->NoOfDataTypes		=ARRAY_SIZE_(alle_DataTypeKnoten);
+}
+
+/* pTables==OpcUa_Null indexes the address space compiled into the server */
+OpcUa_StatusCode build_node_index(const _AddressSpaceTables_* pTables)
+{
+	OpcUa_UInt32 uCount;
+	OpcUa_UInt32 uSize;
+	OpcUa_Int i;
+
+	OpcUa_InitializeStatus(OpcUa_Module_Server, "build_node_index");
+
+	clear_node_index();
+
+	if(pTables!=OpcUa_Null)
+		node_tables=*pTables;
+	else
+		get_builtin_addressspace(&node_tables);
+
+	uCount= node_tables.NoOfObjectTypes
+		   +node_tables.NoOfObjects
+		   +node_tables.NoOfReferenceTypes
+		   +node_tables.NoOfVariables
+		   +node_tables.NoOfVariableTypes
+		   +node_tables.NoOfDataTypes;
+
+	/* power of two with at most 50% load */
+	for(uSize=16;uSize<2*uCount;uSize<<=1);
+
+	node_index=(_NodeIndexEntry_*)OpcUa_Alloc(uSize*sizeof(_NodeIndexEntry_));
+	OpcUa_GotoErrorIfAllocFailed(node_index);
+	OpcUa_MemSet(node_index,0,uSize*sizeof(_NodeIndexEntry_));
+	node_index_mask=uSize-1;
+
+	/* the linear search takes the first match of the last table that has one,
+	   so the tables go in backwards and the first node of a NodeId stays */
+	for(i=0;i<node_tables.NoOfDataTypes;i++)
+		insert_node_index(&node_tables.DataTypes[i].BaseAttribute);
+	for(i=0;i<node_tables.NoOfVariableTypes;i++)
+		insert_node_index(&node_tables.VariableTypes[i].BaseAttribute);
+	for(i=0;i<node_tables.NoOfVariables;i++)
+		insert_node_index(&node_tables.Variables[i].BaseAttribute);
+	for(i=0;i<node_tables.NoOfReferenceTypes;i++)
+		insert_node_index(&node_tables.ReferenceTypes[i].BaseAttribute);
+	for(i=0;i<node_tables.NoOfObjects;i++)
+		insert_node_index(&node_tables.Objects[i].BaseAttribute);
+	for(i=0;i<node_tables.NoOfObjectTypes;i++)
+		insert_node_index(&node_tables.ObjectTypes[i].BaseAttribute);
+
+	uStatus=build_reference_tables();
+	OpcUa_GotoErrorIfBad(uStatus);
+
+	OpcUa_ReturnStatusCode;
+	OpcUa_BeginErrorHandling;
+
+	clear_node_index();
+
+	OpcUa_FinishErrorHandling;
+}
+
+OpcUa_Void clear_node_index(OpcUa_Void)
+{
+	if(node_index!=OpcUa_Null)
+	{
+		OpcUa_Free(node_index);
+		node_index=OpcUa_Null;
+		node_index_mask=0;
+	}
+	if(node_adjacency!=OpcUa_Null)
+	{
+		OpcUa_Free(node_adjacency);
+		node_adjacency=OpcUa_Null;
+	}
+	if(ref_groups!=OpcUa_Null)
+	{
+		OpcUa_Free(ref_groups);
+		ref_groups=OpcUa_Null;
+	}
+	if(ref_order!=OpcUa_Null)
+	{
+		OpcUa_Free(ref_order);
+		ref_order=OpcUa_Null;
+	}
+	if(ref_targets!=OpcUa_Null)
+	{
+		OpcUa_Free(ref_targets);
+		ref_targets=OpcUa_Null;
+	}
+	if(ref_type_closure!=OpcUa_Null)
+	{
+		OpcUa_Free(ref_type_closure);
+		ref_type_closure=OpcUa_Null;
+		ref_type_words=0;
+	}
+}
+
+static _NodeIndexEntry_* find_node_index_entry(const OpcUa_NodeId* pNodeId)
+{
+	OpcUa_UInt32 uHash = hash_nodeid(pNodeId);
+	OpcUa_UInt32 uSlot = uHash & node_index_mask;
+
+	while(node_index[uSlot].pNode!=OpcUa_Null)
+	{
+		if(node_index[uSlot].Hash==uHash && is_same_nodeid(&node_index[uSlot].pNode->NodeId,pNodeId))
+			return &node_index[uSlot];
+		uSlot=(uSlot+1)&node_index_mask;
+	}
+	return OpcUa_Null;
+}
+
+/* index of a ReferenceType node in node_tables.ReferenceTypes, -1 if the NodeId is no ReferenceType */
+static OpcUa_Int ref_type_of(const OpcUa_NodeId* pNodeId)
+{
+	_NodeIndexEntry_* pEntry = find_node_index_entry(pNodeId);
+	OpcUa_Int i;
+
+	if(pEntry!=OpcUa_Null && pEntry->pNode->NodeClass==OpcUa_NodeClass_ReferenceType)
+	{
+		for(i=0;i<node_tables.NoOfReferenceTypes;i++)
+		{
+			if(pEntry->pNode==&node_tables.ReferenceTypes[i].BaseAttribute)
+				return i;
+		}
+	}
+	return -1;
+}
+
+static _RefGroup_* find_ref_group(_NodeAdjacency_* pAdjacency, _ReferenceNode_* pRef)
+{
+	OpcUa_Int g;
+
+	for(g=0;g<pAdjacency->NoOfGroups;g++)
+	{
+		if(pAdjacency->Groups[g].IsInverse==(pRef->IsInverse!=OpcUa_False) && compare_nodes(pAdjacency->Groups[g].ReferenceTypeId,pRef->ReferenceTypeId))
+			return &pAdjacency->Groups[g];
+	}
+	return OpcUa_Null;
+}
+
+/* fills the subtype closure of the ReferenceTypes and the adjacency of every indexed node */
+static OpcUa_StatusCode build_reference_tables(OpcUa_Void)
+{
+	OpcUa_Int			uNoOfTypes = node_tables.NoOfReferenceTypes;
+	OpcUa_Int			uNoOfNodes = 0;
+	OpcUa_Int			uNoOfRefs  = 0;
+	OpcUa_Int			uPos       = 0;
+	OpcUa_Int			a,b,k,w,j,dir;
+	OpcUa_UInt32		uSlot;
+	_BaseAttribute_*	pNode;
+	_NodeAdjacency_*	pAdjacency;
+	_RefGroup_*			pGroup;
+	_ReferenceNode_*	pRef;
+
+	OpcUa_InitializeStatus(OpcUa_Module_Server, "build_reference_tables");
+
+	/* subtype closure: direct HasSubtype references, then transitive (Warshall) */
+	ref_type_words=(uNoOfTypes+31)/32;
+	ref_type_closure=(OpcUa_UInt32*)OpcUa_Alloc((uNoOfTypes*ref_type_words+1)*sizeof(OpcUa_UInt32));
+	OpcUa_GotoErrorIfAllocFailed(ref_type_closure);
+	OpcUa_MemSet(ref_type_closure,0,uNoOfTypes*ref_type_words*sizeof(OpcUa_UInt32));
+
+	for(a=0;a<uNoOfTypes;a++)
+	{
+		ref_type_closure[a*ref_type_words+a/32]|=1u<<(a%32);
+		pNode=&node_tables.ReferenceTypes[a].BaseAttribute;
+		for(j=0;j<pNode->NoOfReferences;j++)
+		{
+			pRef=pNode->References+j;
+			if(pRef->IsInverse==OpcUa_False
+			   && pRef->ReferenceTypeId.IdentifierType==OpcUa_IdentifierType_Numeric
+			   && pRef->ReferenceTypeId.NamespaceIndex==0
+			   && pRef->ReferenceTypeId.Identifier.Numeric==OpcUaId_HasSubtype)
+			{
+				b=ref_type_of(&pRef->Target_NodeId);
+				if(b>=0)
+					ref_type_closure[a*ref_type_words+b/32]|=1u<<(b%32);
+			}
+		}
+	}
+	for(k=0;k<uNoOfTypes;k++)
+	{
+		for(a=0;a<uNoOfTypes;a++)
+		{
+			if(REF_TYPE_IS_SUBTYPE(a,k))
+			{
+				for(w=0;w<ref_type_words;w++)
+					ref_type_closure[a*ref_type_words+w]|=ref_type_closure[k*ref_type_words+w];
+			}
+		}
+	}
+
+	/* adjacency of every node in the index */
+	for(uSlot=0;uSlot<=node_index_mask;uSlot++)
+	{
+		if(node_index[uSlot].pNode!=OpcUa_Null)
+		{
+			uNoOfNodes++;
+			uNoOfRefs+=node_index[uSlot].pNode->NoOfReferences;
+		}
+	}
+
+	node_adjacency=(_NodeAdjacency_*)OpcUa_Alloc((uNoOfNodes+1)*sizeof(_NodeAdjacency_));
+	OpcUa_GotoErrorIfAllocFailed(node_adjacency);
+	ref_groups=(_RefGroup_*)OpcUa_Alloc((uNoOfRefs+1)*sizeof(_RefGroup_));
+	OpcUa_GotoErrorIfAllocFailed(ref_groups);
+	ref_order=(OpcUa_Int*)OpcUa_Alloc((uNoOfRefs+1)*sizeof(OpcUa_Int));
+	OpcUa_GotoErrorIfAllocFailed(ref_order);
+	ref_targets=(_BaseAttribute_**)OpcUa_Alloc((uNoOfRefs+1)*sizeof(_BaseAttribute_*));
+	OpcUa_GotoErrorIfAllocFailed(ref_targets);
+
+	pAdjacency=node_adjacency;
+	for(uSlot=0;uSlot<=node_index_mask;uSlot++)
+	{
+		pNode=node_index[uSlot].pNode;
+		if(pNode==OpcUa_Null)
+			continue;
+
+		node_index[uSlot].pAdjacency=pAdjacency;
+		pAdjacency->NoOfGroups=0;
+		pAdjacency->Groups=ref_groups+uPos;
+		pAdjacency->RefOrder=ref_order+uPos;
+		pAdjacency->Targets=ref_targets+uPos;
+		pAdjacency->pTypeDefinition=OpcUa_Null;
+
+		/* groups in order of appearance, forward references first */
+		for(dir=0;dir<2;dir++)
+		{
+			for(j=0;j<pNode->NoOfReferences;j++)
+			{
+				pRef=pNode->References+j;
+				if((pRef->IsInverse!=OpcUa_False)!=dir)
+					continue;
+				pGroup=find_ref_group(pAdjacency,pRef);
+				if(pGroup==OpcUa_Null)
+				{
+					pGroup=&pAdjacency->Groups[pAdjacency->NoOfGroups++];
+					pGroup->IsInverse=(OpcUa_Boolean)dir;
+					pGroup->RefType=ref_type_of(&pRef->ReferenceTypeId);
+					pGroup->ReferenceTypeId=pRef->ReferenceTypeId;
+					pGroup->Count=0;
+				}
+				pGroup->Count++;
+			}
+		}
+		for(k=0,j=0;k<pAdjacency->NoOfGroups;k++)
+		{
+			pAdjacency->Groups[k].First=j;
+			j+=pAdjacency->Groups[k].Count;
+			pAdjacency->Groups[k].Count=0;
+		}
+		for(j=0;j<pNode->NoOfReferences;j++)
+		{
+			pRef=pNode->References+j;
+			pGroup=find_ref_group(pAdjacency,pRef);
+			k=pGroup->First+pGroup->Count++;
+			pAdjacency->RefOrder[k]=j;
+			pAdjacency->Targets[k]=(_BaseAttribute_*)search_for_node(pRef->Target_NodeId);
+			if(pRef->ReferenceTypeId.Identifier.Numeric==OpcUaId_HasTypeDefinition)
+				pAdjacency->pTypeDefinition=&pRef->Target_NodeId;
+		}
+
+		uPos+=pNode->NoOfReferences;
+		pAdjacency++;
+	}
+
+	OpcUa_ReturnStatusCode;
+	OpcUa_BeginErrorHandling;
+	OpcUa_FinishErrorHandling;
+}
+
+static OpcUa_Boolean ref_group_matches(OpcUa_BrowseDescription* NodeToBrowse, OpcUa_Int iFilterType, _RefGroup_* pGroup)
+{
+	if(NodeToBrowse->BrowseDirection==OpcUa_BrowseDirection_Forward && pGroup->IsInverse!=OpcUa_False)
+		return OpcUa_False;
+	if(NodeToBrowse->BrowseDirection==OpcUa_BrowseDirection_Inverse && pGroup->IsInverse==OpcUa_False)
+		return OpcUa_False;
+	if(NodeToBrowse->ReferenceTypeId.Identifier.Numeric==0 && NodeToBrowse->ReferenceTypeId.IdentifierType==OpcUa_IdentifierType_Numeric)
+		return OpcUa_True;
+
+	if(iFilterType>=0 && pGroup->RefType>=0)
+	{
+		if(NodeToBrowse->IncludeSubtypes==OpcUa_False)
+			return (OpcUa_Boolean)(iFilterType==pGroup->RefType);
+		return (OpcUa_Boolean)REF_TYPE_IS_SUBTYPE(iFilterType,pGroup->RefType);
+	}
+	return ist_unterknoten(NodeToBrowse->ReferenceTypeId,pGroup->ReferenceTypeId,NodeToBrowse->IncludeSubtypes);
+}
+
+/*============================================================================
+ * next reference of pNode at or after position *pPos which passes the
+ * ReferenceTypeId, NodeClassMask and BrowseDirection filters of NodeToBrowse.
+ *===========================================================================*/
+_ReferenceNode_* next_reference(OpcUa_BrowseDescription* NodeToBrowse,_BaseAttribute_* pNode,OpcUa_Int* pPos,_BaseAttribute_** ppTargetNode)
+{
+	_NodeIndexEntry_*	pEntry = OpcUa_Null;
+	_NodeAdjacency_*	pAdjacency;
+	_RefGroup_*			pGroup;
+	_BaseAttribute_*	pTargetNode;
+	OpcUa_Int			iFilterType = -1;
+	OpcUa_Int			g,i;
+
+	if(node_adjacency!=OpcUa_Null)
+		pEntry=find_node_index_entry(&pNode->NodeId);
+
+	if(pEntry!=OpcUa_Null && pEntry->pNode==pNode)
+	{
+		pAdjacency=pEntry->pAdjacency;
+		if(NodeToBrowse->ReferenceTypeId.Identifier.Numeric!=0 || NodeToBrowse->ReferenceTypeId.IdentifierType!=OpcUa_IdentifierType_Numeric)
+			iFilterType=ref_type_of(&NodeToBrowse->ReferenceTypeId);
+
+		for(g=0;g<pAdjacency->NoOfGroups;g++)
+		{
+			pGroup=&pAdjacency->Groups[g];
+			if(*pPos>=pGroup->First+pGroup->Count || ref_group_matches(NodeToBrowse,iFilterType,pGroup)==OpcUa_False)
+				continue;
+			for(i=(*pPos>pGroup->First)?*pPos:pGroup->First;i<pGroup->First+pGroup->Count;i++)
+			{
+				pTargetNode=pAdjacency->Targets[i];
+				if(pTargetNode!=OpcUa_Null && check_Mask(NodeToBrowse->NodeClassMask,pTargetNode->NodeClass)==OpcUa_True)
+				{
+					*pPos=i;
+					*ppTargetNode=pTargetNode;
+					return pNode->References+pAdjacency->RefOrder[i];
+				}
+			}
+		}
+		return OpcUa_Null;
+	}
+
+	/* no tables: scan the References array */
+	for(i=*pPos;i<pNode->NoOfReferences;i++)
+	{
+		pTargetNode=(_BaseAttribute_*)search_for_node((pNode->References+i)->Target_NodeId);
+		if(pTargetNode!=OpcUa_Null
+		   && ist_unterknoten(NodeToBrowse->ReferenceTypeId,(pNode->References+i)->ReferenceTypeId,NodeToBrowse->IncludeSubtypes)==OpcUa_True
+		   && check_Mask(NodeToBrowse->NodeClassMask,pTargetNode->NodeClass)==OpcUa_True
+		   && check_dir(NodeToBrowse->BrowseDirection,pNode->References+i)==OpcUa_True)
+		{
+			*pPos=i;
+			*ppTargetNode=pTargetNode;
+			return pNode->References+i;
+		}
+	}
+	return OpcUa_Null;
+}
+
+/* NodeId of the TypeDefinition of pNode, OpcUa_Null if it has none */
+const OpcUa_NodeId* type_definition(_BaseAttribute_* pNode)
+{
+	_NodeIndexEntry_*	pEntry = OpcUa_Null;
+	const OpcUa_NodeId*	pTypeDefinition = OpcUa_Null;
+	OpcUa_Int			n;
+
+	if(node_adjacency!=OpcUa_Null)
+		pEntry=find_node_index_entry(&pNode->NodeId);
+	if(pEntry!=OpcUa_Null && pEntry->pNode==pNode)
+		return pEntry->pAdjacency->pTypeDefinition;
+
+	for(n=0;n<(pNode->NoOfReferences);n++)
+	{
+		if(((pNode->References+n)->ReferenceTypeId.Identifier.Numeric)==OpcUaId_HasTypeDefinition)
+			pTypeDefinition=&(pNode->References+n)->Target_NodeId;
+	}
+	return pTypeDefinition;
+}
+
 OpcUa_Void* search_for_node(OpcUa_NodeId NodeId)
 {
 	OpcUa_Void* p_Node=OpcUa_Null;
 	OpcUa_Int i;
 
+	if(node_index!=OpcUa_Null)
+	{
+		_NodeIndexEntry_* pEntry = find_node_index_entry(&NodeId);
+		return (pEntry!=OpcUa_Null)?pEntry->pNode:OpcUa_Null;
+	}
+
 
 		//durchsuche alle ObjectTypeNodes--------------------------------------------------------
 		
@@ -520,31 +1005,3 @@ OpcUa_Boolean check_dir(OpcUa_BrowseDirection browsedir,_ReferenceNode_* p_ref)
 }
 
 
-
-OpcUa_Boolean need_continuationpoint(OpcUa_BrowseDescription* NodeToBrowse,OpcUa_Int x)
-{
-	OpcUa_Int i,counter;
-	_BaseAttribute_*		pointer_to_node;
-	_BaseAttribute_*		pointer_to_targetnode;
-
-	counter=0;
-
-	pointer_to_node= (_BaseAttribute_*)search_for_node(NodeToBrowse->NodeId);
-
-	for(i=x;i<((pointer_to_node)->NoOfReferences);i++)/*iterate over all references of startnode*******/
-	{
-		pointer_to_targetnode=(_BaseAttribute_*) search_for_node(((pointer_to_node)->References+i)->Target_NodeId);
-		if( ist_unterknoten(NodeToBrowse->ReferenceTypeId,(pointer_to_node->References+i)->ReferenceTypeId,NodeToBrowse->IncludeSubtypes)==OpcUa_True && check_Mask(NodeToBrowse->NodeClassMask, pointer_to_targetnode->NodeClass))
-		{	
-			if(check_dir(NodeToBrowse->BrowseDirection,(pointer_to_node->References+i))==OpcUa_True)
-			{
-				counter++;				
-			}
-		}
-	}
-	if(counter>0)
-		return OpcUa_True;   //continuationpoint is needed
-	else 
-		return OpcUa_False;  //do not need continuationpoint
-}
-
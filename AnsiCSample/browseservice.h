@@ -30,18 +30,22 @@
 #ifndef _browseservice_
 #define _browseservice_
 
-#define RESET_SESSION_COUNTER	msec_counter=0;
 
 #define Is_my_node(startNodeId,meinNode) (startNodeId.NamespaceIndex==meinNode.BaseAttribute.NodeId.NamespaceIndex) && (startNodeId.Identifier.Numeric==meinNode.BaseAttribute.NodeId.Identifier.Numeric) && (startNodeId.IdentifierType==meinNode.BaseAttribute.NodeId.IdentifierType)
 
 
 
+#define MAX_BROWSE_CONTINUATIONPOINTS			4		/* per session, the least recently used one is replaced */
+
+/* a ContinuationPoint only carries Id, the cursor stays in the server */
 typedef struct
 {
-	OpcUa_Int					Cont_Point_Identiefer;
-	OpcUa_Int					Aktuelle_Ref;
-	OpcUa_BrowseDescription		NodeToBrowse;
-
+	OpcUa_UInt32				Id;						/* 0: entry is free */
+	OpcUa_UInt32				SessionId;
+	OpcUa_UInt32				LastUsed;
+	OpcUa_Int					Position;				/* next reference in the adjacency of the node */
+	OpcUa_UInt32				MaxReferences;
+	OpcUa_BrowseDescription		NodeToBrowse;			/* NodeIds point into the address space */
 }_my_continuationpoint_;
 
 
@@ -81,19 +85,34 @@ OpcUa_StatusCode my_BrowseNext(
 							OpcUa_DiagnosticInfo**     a_pDiagnosticInfos);
 
 
-OpcUa_StatusCode		browse						(OpcUa_BrowseDescription* ,OpcUa_BrowseResult*,OpcUa_Int );  //  besseren namen ausdenken!!!
+OpcUa_StatusCode		browse						(OpcUa_BrowseDescription* ,OpcUa_BrowseResult*,OpcUa_Int ,OpcUa_UInt32 ,OpcUa_Int* );  //  besseren namen ausdenken!!!
+
+OpcUa_StatusCode		initialize_continuationpoints	(OpcUa_Void);
+
+OpcUa_Void				clear_continuationpoints		(OpcUa_Void);
+
+OpcUa_StatusCode		store_continuationpoint			(OpcUa_UInt32 ,OpcUa_BrowseDescription* ,_BaseAttribute_* ,OpcUa_Int ,OpcUa_UInt32 ,OpcUa_ByteString* );
+
+OpcUa_Void				delete_session_continuationpoints	(OpcUa_UInt32 );
 
 OpcUa_Void*				search_for_node				(OpcUa_NodeId );
 
+OpcUa_Void				get_builtin_addressspace	(_AddressSpaceTables_* );
+
+OpcUa_StatusCode		build_node_index			(const _AddressSpaceTables_* );
+
+OpcUa_Void				clear_node_index			(OpcUa_Void);
+
 OpcUa_Boolean			ist_unterknoten				( OpcUa_NodeId , OpcUa_NodeId  ,OpcUa_Boolean   );
 
 OpcUa_Boolean			check_Mask					(OpcUa_UInt32 ,OpcUa_UInt32 );
 
 OpcUa_Boolean			check_dir					(OpcUa_BrowseDirection ,_ReferenceNode_* );
 
-OpcUa_Boolean			need_continuationpoint		(OpcUa_BrowseDescription* ,OpcUa_Int);
+_ReferenceNode_*		next_reference				(OpcUa_BrowseDescription* ,_BaseAttribute_* ,OpcUa_Int* ,_BaseAttribute_** );
+
+const OpcUa_NodeId*		type_definition				(_BaseAttribute_* );
 
-OpcUa_StatusCode		check_authentication_token	(const OpcUa_RequestHeader* );
 
 OpcUa_StatusCode		response_header_ausfuellen	(OpcUa_ResponseHeader*  ,const OpcUa_RequestHeader*, OpcUa_StatusCode);
 
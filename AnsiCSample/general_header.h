@@ -34,7 +34,6 @@
 #define SESSION_NOT_ACTIVATED	0x80270000
 #define	SESSION_ACTIVATED		0x00000000
 
-#define RESET_SESSION_COUNTER	msec_counter=0;
 
 #define REVISED_SESSIONTIMEOUT  30000    
 
@@ -43,12 +42,10 @@
 /***********************                 Prototypes of services       ************************/
 /*********************************************************************************************/
 
-OpcUa_StatusCode		check_authentication_token										(const OpcUa_RequestHeader* );
-OpcUa_StatusCode		check_securechannelId											( OpcUa_Endpoint ,  OpcUa_Handle );
-OpcUa_StatusCode		check_useridentitytoken											(const OpcUa_ExtensionObject* );
-OpcUa_StatusCode		speichere_username												(const OpcUa_ExtensionObject* );
-OpcUa_Void				username_free													(OpcUa_Void);
-OpcUa_StatusCode		vergleiche_username												(const OpcUa_ExtensionObject*);
+OpcUa_StatusCode		check_useridentitytoken											(const OpcUa_ExtensionObject* , OpcUa_String** );
+OpcUa_StatusCode		speichere_username												(const OpcUa_ExtensionObject* , OpcUa_String** );
+OpcUa_Void				username_free													(OpcUa_String** );
+OpcUa_StatusCode		vergleiche_username												(const OpcUa_ExtensionObject* , OpcUa_String* );
 OpcUa_StatusCode		check_password													(const OpcUa_ExtensionObject* );
 OpcUa_StatusCode		response_header_ausfuellen										(OpcUa_ResponseHeader*  ,const OpcUa_RequestHeader*, OpcUa_StatusCode);
 OpcUa_StatusCode		my_GetDateTimeDiffInSeconds32								( OpcUa_DateTime  ,OpcUa_DateTime  , OpcUa_UInt32*  );
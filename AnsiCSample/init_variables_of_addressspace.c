@@ -37,27 +37,14 @@
 #include <opcua_core.h>
 
 #include "addressspace.h"
+#include "browseservice.h"
 #include "general_header.h"
 
 OpcUa_StatusCode initialize_value_attribute_of_variablenodes_variabletypenodes(OpcUa_Void)
 {
-	extern OpcUa_Int			Continuation_Point_Identifier;
-	extern OpcUa_Int			Cont_Point_Counter;
-	extern OpcUa_UInt32			session_flag;
-	extern OpcUa_String*		p_user_name;
-	extern OpcUa_Double			session_timeout;
 	extern my_Variant			all_ValueAttribute_of_VariableTypeNodes_VariableNodes[];
 	OpcUa_InitializeStatus(OpcUa_Module_Server, "initialize_value_attribute_of_variablenodes_variabletypenodes");
 
-/*initializing session relevant variables*/
-	Continuation_Point_Identifier=0;
-	Cont_Point_Counter=0;
-	session_flag=SESSION_NOT_ACTIVATED;
-	p_user_name=OpcUa_Null;
-	session_timeout=REVISED_SESSIONTIMEOUT;
-/********************************/
-
-
 //Variable: State	
 	all_ValueAttribute_of_VariableTypeNodes_VariableNodes[0].ArrayType						=OpcUa_VariantArrayType_Scalar;
 	all_ValueAttribute_of_VariableTypeNodes_VariableNodes[0].Datatype						=OpcUaId_UInt32;
@@ -126,7 +113,7 @@ OpcUa_StatusCode initialize_value_attribute_of_variablenodes_variabletypenodes(O
 //Variable: MaxBrowseContinuationPoints
 	all_ValueAttribute_of_VariableTypeNodes_VariableNodes[7].ArrayType						=OpcUa_VariantArrayType_Scalar;
 	all_ValueAttribute_of_VariableTypeNodes_VariableNodes[7].Datatype						=OpcUaId_UInt32 ;
-	all_ValueAttribute_of_VariableTypeNodes_VariableNodes[7].Value.UInt32					=1;
+	all_ValueAttribute_of_VariableTypeNodes_VariableNodes[7].Value.UInt32					=MAX_BROWSE_CONTINUATIONPOINTS;
 //--------------------------
 
 //Variable: DATA_VALUE
@@ -37,79 +37,76 @@
 #include "browseservice.h"
 #include "mytrace.h"
 #include "readservice.h"
+#include "sessiontable.h"
+#include "valuestore.h"
 #include "general_header.h"
 
 
 
 
 /*============================================================================
- * method which implements the Read service.
+ * a string of a result; borrowed read-only, or a copy the result owns.
  *===========================================================================*/
-OpcUa_StatusCode my_Read(
-							OpcUa_Endpoint             a_hEndpoint,
-							OpcUa_Handle               a_hContext,
-							const OpcUa_RequestHeader* a_pRequestHeader,
-							OpcUa_Double               a_nMaxAge,
-							OpcUa_TimestampsToReturn   a_eTimestampsToReturn,
-							OpcUa_Int32                a_nNoOfNodesToRead,
-							const OpcUa_ReadValueId*   a_pNodesToRead,
-							OpcUa_ResponseHeader*      a_pResponseHeader,
-							OpcUa_Int32*               a_pNoOfResults,
-							OpcUa_DataValue**          a_pResults,
-							OpcUa_Int32*               a_pNoOfDiagnosticInfos,
-							OpcUa_DiagnosticInfo**     a_pDiagnosticInfos)
+static OpcUa_StatusCode attach_string(OpcUa_String* a_pDst, const OpcUa_StringA a_sSrc, OpcUa_Boolean a_bBorrow)
 {
-	OpcUa_Int i,n;
-	OpcUa_Void* p_Node;
-	extern OpcUa_UInt32		securechannelId;
-	extern OpcUa_UInt32		session_flag;
-	extern OpcUa_Double		msec_counter;
-	extern OpcUa_String*	p_user_name;
-
-    OpcUa_InitializeStatus(OpcUa_Module_Server, "OpcUa_ServerApi_Read");
-
-    /* validate arguments. */
-    OpcUa_ReturnErrorIfArgumentNull(a_hEndpoint);
-    OpcUa_ReturnErrorIfArgumentNull(a_hContext);
-    OpcUa_ReturnErrorIfArgumentNull(a_pRequestHeader);
-    OpcUa_ReferenceParameter(a_nMaxAge);
-    OpcUa_ReferenceParameter(a_eTimestampsToReturn);
-    OpcUa_ReturnErrorIfArrayArgumentNull(a_nNoOfNodesToRead, a_pNodesToRead);
-    OpcUa_ReturnErrorIfArgumentNull(a_pResponseHeader);
-    OpcUa_ReturnErrorIfArrayArgumentNull(a_pNoOfResults, a_pResults);
-    OpcUa_ReturnErrorIfArrayArgumentNull(a_pNoOfDiagnosticInfos, a_pDiagnosticInfos);
-
-	*a_pNoOfDiagnosticInfos=0;
-	*a_pDiagnosticInfos=OpcUa_Null;
-
-	RESET_SESSION_COUNTER
-
- #ifndef NO_DEBUGING_
-	MY_TRACE("\n\n\nRREADSERVICE==============================================\n");
-	if(p_user_name!=OpcUa_Null)
-		MY_TRACE("\nUser:%s\n",OpcUa_String_GetRawString(p_user_name)); 
-#endif /*_DEBUGING_*/
-  
+	if(a_bBorrow)
+		return OpcUa_String_AttachReadOnly(a_pDst,a_sSrc);
+	return OpcUa_String_AttachCopy(a_pDst,a_sSrc);
+}
 
-	if(OpcUa_IsBad(session_flag))
+/*============================================================================
+ * a NodeId result; borrowed from the node, or a copy the result owns.
+ *===========================================================================*/
+static OpcUa_StatusCode fill_NodeId_value(OpcUa_DataValue* p_Results, OpcUa_NodeId* p_NodeId, OpcUa_Boolean a_bBorrow)
+{
+	if(a_bBorrow)
 	{
-		//teile client mit , dass Session geschlossen ist
-#ifndef NO_DEBUGING_
-		MY_TRACE("\nSession nicht aktiv\n"); 
-#endif /*_DEBUGING_*/
-		uStatus=OpcUa_BadSessionNotActivated;
-		OpcUa_GotoError;
+		p_Results->Value.Value.NodeId=p_NodeId;
+	}
+	else
+	{
+		p_Results->Value.Value.NodeId=OpcUa_Memory_Alloc(sizeof(OpcUa_NodeId));
+		if(p_Results->Value.Value.NodeId==OpcUa_Null)
+			return OpcUa_BadOutOfMemory;
+		*p_Results->Value.Value.NodeId=*p_NodeId;
 	}
+	fill_datatype_arraytype_in_my_Variant(p_Results,OpcUaId_NodeId, OpcUa_VariantArrayType_Scalar,0);
+	return OpcUa_Good;
+}
 
-	
-	uStatus=check_authentication_token(a_pRequestHeader);
-	if(OpcUa_IsBad(uStatus))
+/*============================================================================
+ * detaches the NodeIds read_nodes borrowed, so that deleting the response
+ * frees only what belongs to it. Strings were attached read-only and stay.
+ *===========================================================================*/
+static OpcUa_Void return_borrowed_values(OpcUa_Int32 a_nNoOfResults, OpcUa_DataValue* a_pResults)
+{
+	OpcUa_Int32		n;
+	OpcUa_Variant*	pValue;
+
+	for(n=0;n<a_nNoOfResults && a_pResults!=OpcUa_Null;n++)
 	{
-#ifndef NO_DEBUGING_
-		MY_TRACE("\nAuthentication Token ungltig.\n"); 
-#endif /*_DEBUGING_*/
-		OpcUa_GotoError;
+		pValue=&a_pResults[n].Value;
+		if(pValue->ArrayType==OpcUa_VariantArrayType_Scalar && pValue->Datatype==OpcUaId_NodeId)
+			OpcUa_Variant_Initialize(pValue);
 	}
+}
+
+/*============================================================================
+ * reads the attributes of a Read request. With a_bBorrow the NodeIds and
+ * strings of the results point into the address space; the caller hands
+ * them back with return_borrowed_values once they are encoded.
+ *===========================================================================*/
+static OpcUa_StatusCode read_nodes(	OpcUa_TimestampsToReturn   a_eTimestampsToReturn,
+									OpcUa_Int32                a_nNoOfNodesToRead,
+									const OpcUa_ReadValueId*   a_pNodesToRead,
+									OpcUa_Int32*               a_pNoOfResults,
+									OpcUa_DataValue**          a_pResults,
+									OpcUa_Boolean              a_bBorrow)
+{
+	OpcUa_Int i,n;
+	OpcUa_Void* p_Node;
+
+	OpcUa_InitializeStatus(OpcUa_Module_Server, "read_nodes");
 
 	*a_pResults=OpcUa_Alloc(a_nNoOfNodesToRead*sizeof(OpcUa_DataValue));
 	OpcUa_GotoErrorIfAllocFailed((*a_pResults))
@@ -126,18 +123,7 @@ OpcUa_StatusCode my_Read(
 			{
 				if((a_pNodesToRead+n)->AttributeId==OpcUa_Attributes_NodeId)
 				{
-					((*a_pResults)+n)->Value.Value.NodeId=OpcUa_Memory_Alloc(sizeof(OpcUa_NodeId));
-					if(((*a_pResults)+n)->Value.Value.NodeId !=OpcUa_Null)
-					{
-						OpcUa_NodeId_Initialize(((*a_pResults)+n)->Value.Value.NodeId);
-						*(((*a_pResults)+n)->Value.Value.NodeId)=((_ObjectKnoten_*)p_Node)->BaseAttribute.NodeId; 
-						fill_datatype_arraytype_in_my_Variant(((*a_pResults)+n),OpcUaId_NodeId, OpcUa_VariantArrayType_Scalar,0);
-						((*a_pResults)+n)->StatusCode=OpcUa_Good;
-					}
-					else
-					{
-						((*a_pResults)+n)->StatusCode=OpcUa_BadOutOfMemory;
-					}
+					((*a_pResults)+n)->StatusCode=fill_NodeId_value(((*a_pResults)+n),&((_ObjectKnoten_*)p_Node)->BaseAttribute.NodeId,a_bBorrow);
 				}
 				if((a_pNodesToRead+n)->AttributeId==OpcUa_Attributes_NodeClass)
 				{
@@ -151,7 +137,7 @@ OpcUa_StatusCode my_Read(
 					if(((*a_pResults)+n)->Value.Value.QualifiedName!=OpcUa_Null)
 					{
 						OpcUa_QualifiedName_Initialize(((*a_pResults)+n)->Value.Value.QualifiedName);
-						OpcUa_String_AttachCopy(&((*a_pResults)+n)->Value.Value.QualifiedName->Name,((_ObjectKnoten_*)p_Node)->BaseAttribute.BrowseName);
+						attach_string(&((*a_pResults)+n)->Value.Value.QualifiedName->Name,((_ObjectKnoten_*)p_Node)->BaseAttribute.BrowseName,a_bBorrow);
 						((*a_pResults)+n)->Value.Value.QualifiedName->NamespaceIndex=((_ObjectKnoten_*)p_Node)->BaseAttribute.NodeId.NamespaceIndex;     
 						fill_datatype_arraytype_in_my_Variant(((*a_pResults)+n),OpcUaId_QualifiedName, OpcUa_VariantArrayType_Scalar,0);
 						((*a_pResults)+n)->StatusCode=OpcUa_Good;
@@ -167,8 +153,8 @@ OpcUa_StatusCode my_Read(
 					if(((*a_pResults)+n)->Value.Value.LocalizedText!=OpcUa_Null)
 					{
 						OpcUa_LocalizedText_Initialize(((*a_pResults)+n)->Value.Value.LocalizedText);
-						OpcUa_String_AttachCopy(&((*a_pResults)+n)->Value.Value.LocalizedText->Text,((_ObjectKnoten_*)p_Node)->BaseAttribute.DisplayName);
-						OpcUa_String_AttachCopy(&((*a_pResults)+n)->Value.Value.LocalizedText->Locale,"en");
+						attach_string(&((*a_pResults)+n)->Value.Value.LocalizedText->Text,((_ObjectKnoten_*)p_Node)->BaseAttribute.DisplayName,a_bBorrow);
+						attach_string(&((*a_pResults)+n)->Value.Value.LocalizedText->Locale,"en",a_bBorrow);
 						fill_datatype_arraytype_in_my_Variant(((*a_pResults)+n),OpcUaId_LocalizedText, OpcUa_VariantArrayType_Scalar,0);
 						((*a_pResults)+n)->StatusCode=OpcUa_Good;
 					}
@@ -193,31 +179,17 @@ OpcUa_StatusCode my_Read(
 						{
 							if((a_pNodesToRead+n)->AttributeId==OpcUa_Attributes_Value)
 							{
-								 ((*a_pResults)+n)->StatusCode=fill_Variant_for_value_attribute((_VariableKnoten_*)p_Node, OpcUa_Null,((*a_pResults)+n));
-								if(a_eTimestampsToReturn!=OpcUa_TimestampsToReturn_Neither)
+								 ((*a_pResults)+n)->StatusCode=fill_Variant_for_value_attribute((_VariableKnoten_*)p_Node, a_bBorrow,((*a_pResults)+n));
+								uStatus=assigne_Timestamp(((*a_pResults)+n),a_eTimestampsToReturn);
+								if(OpcUa_IsBad(uStatus))
 								{
-									uStatus=assigne_Timestamp(((*a_pResults)+n),a_eTimestampsToReturn);
-									if(OpcUa_IsBad(uStatus))
-									{
-										((*a_pResults)+n)->StatusCode=OpcUa_BadInternalError;
-										uStatus=OpcUa_Good;
-									}
+									((*a_pResults)+n)->StatusCode=OpcUa_BadInternalError;
+									uStatus=OpcUa_Good;
 								}
 							}
 							if((a_pNodesToRead+n)->AttributeId==OpcUa_Attributes_DataType)
 							{
-								((*a_pResults)+n)->Value.Value.NodeId=OpcUa_Memory_Alloc(sizeof(OpcUa_NodeId));
-								if(((*a_pResults)+n)->Value.Value.NodeId!=OpcUa_Null)
-								{
-									OpcUa_NodeId_Initialize(((*a_pResults)+n)->Value.Value.NodeId);
-									*(((*a_pResults+n)->Value.Value.NodeId))=((_VariableKnoten_*)p_Node)->DataType;
-									fill_datatype_arraytype_in_my_Variant(((*a_pResults)+n),OpcUaId_NodeId, OpcUa_VariantArrayType_Scalar,0);
-									((*a_pResults)+n)->StatusCode=OpcUa_Good;
-								}
-								else
-								{
-									((*a_pResults)+n)->StatusCode=OpcUa_BadOutOfMemory;
-								}
+								((*a_pResults)+n)->StatusCode=fill_NodeId_value(((*a_pResults)+n),&((_VariableKnoten_*)p_Node)->DataType,a_bBorrow);
 							}
 							if((a_pNodesToRead+n)->AttributeId==OpcUa_Attributes_ValueRank)
 							{
@@ -266,31 +238,17 @@ OpcUa_StatusCode my_Read(
 						{
 							if((a_pNodesToRead+n)->AttributeId==OpcUa_Attributes_Value)
 							{
-								 ((*a_pResults)+n)->StatusCode=fill_Variant_for_value_attribute((_VariableKnoten_*)p_Node, OpcUa_Null,((*a_pResults)+n));
-								if(a_eTimestampsToReturn!=OpcUa_TimestampsToReturn_Neither)
+								 ((*a_pResults)+n)->StatusCode=fill_Variant_for_value_attribute((_VariableKnoten_*)p_Node, a_bBorrow,((*a_pResults)+n));
+								uStatus=assigne_Timestamp(((*a_pResults)+n),a_eTimestampsToReturn);
+								if(OpcUa_IsBad(uStatus))
 								{
-									uStatus=assigne_Timestamp(((*a_pResults)+n),a_eTimestampsToReturn);
-									if(OpcUa_IsBad(uStatus))
-									{
-										((*a_pResults)+n)->StatusCode=OpcUa_BadInternalError;
-										uStatus=OpcUa_Good;
-									}
+									((*a_pResults)+n)->StatusCode=OpcUa_BadInternalError;
+									uStatus=OpcUa_Good;
 								}
 							}
 							if((a_pNodesToRead+n)->AttributeId==OpcUa_Attributes_DataType)
 							{
-								((*a_pResults)+n)->Value.Value.NodeId=OpcUa_Memory_Alloc(sizeof(OpcUa_NodeId));
-								if(((*a_pResults)+n)->Value.Value.NodeId!=OpcUa_Null)
-								{
-									OpcUa_NodeId_Initialize(((*a_pResults)+n)->Value.Value.NodeId);
-									*((*a_pResults)+n)->Value.Value.NodeId=((_VariableTypeKnoten_*)p_Node)->DataType;
-									fill_datatype_arraytype_in_my_Variant(((*a_pResults)+n),OpcUaId_NodeId, OpcUa_VariantArrayType_Scalar,0);
-									((*a_pResults)+n)->StatusCode=OpcUa_Good;
-								}
-								else
-								{
-									((*a_pResults)+n)->StatusCode=OpcUa_BadOutOfMemory;
-								}
+								((*a_pResults)+n)->StatusCode=fill_NodeId_value(((*a_pResults)+n),&((_VariableTypeKnoten_*)p_Node)->DataType,a_bBorrow);
 							}
 							if((a_pNodesToRead+n)->AttributeId==OpcUa_Attributes_ArrayDimensions)
 							{
@@ -364,8 +322,8 @@ OpcUa_StatusCode my_Read(
 								if(((*a_pResults)+n)->Value.Value.NodeId!=OpcUa_Null)
 								{
 									OpcUa_LocalizedText_Initialize(((*a_pResults)+n)->Value.Value.LocalizedText);
-									OpcUa_String_AttachCopy(&((*a_pResults)+n)->Value.Value.LocalizedText->Text, ((_ReferenceTypeKnoten_*)p_Node)->InverseName_text);
-									OpcUa_String_AttachCopy(&((*a_pResults)+n)->Value.Value.LocalizedText->Locale, ((_ReferenceTypeKnoten_*)p_Node)->InverseName_locale);
+									attach_string(&((*a_pResults)+n)->Value.Value.LocalizedText->Text, ((_ReferenceTypeKnoten_*)p_Node)->InverseName_text,a_bBorrow);
+									attach_string(&((*a_pResults)+n)->Value.Value.LocalizedText->Locale, ((_ReferenceTypeKnoten_*)p_Node)->InverseName_locale,a_bBorrow);
 									fill_datatype_arraytype_in_my_Variant(((*a_pResults)+n),OpcUaId_LocalizedText, OpcUa_VariantArrayType_Scalar,0);
 									((*a_pResults)+n)->StatusCode=OpcUa_Good;
 								}
@@ -406,6 +364,55 @@ OpcUa_StatusCode my_Read(
 	}
 #endif /*_DEBUGING_*/
 
+	OpcUa_ReturnStatusCode;
+	OpcUa_BeginErrorHandling;
+	OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * method which implements the Read service.
+ *===========================================================================*/
+OpcUa_StatusCode my_Read(
+							OpcUa_Endpoint             a_hEndpoint,
+							OpcUa_Handle               a_hContext,
+							const OpcUa_RequestHeader* a_pRequestHeader,
+							OpcUa_Double               a_nMaxAge,
+							OpcUa_TimestampsToReturn   a_eTimestampsToReturn,
+							OpcUa_Int32                a_nNoOfNodesToRead,
+							const OpcUa_ReadValueId*   a_pNodesToRead,
+							OpcUa_ResponseHeader*      a_pResponseHeader,
+							OpcUa_Int32*               a_pNoOfResults,
+							OpcUa_DataValue**          a_pResults,
+							OpcUa_Int32*               a_pNoOfDiagnosticInfos,
+							OpcUa_DiagnosticInfo**     a_pDiagnosticInfos)
+{
+    OpcUa_InitializeStatus(OpcUa_Module_Server, "OpcUa_ServerApi_Read");
+
+    /* validate arguments. */
+    OpcUa_ReturnErrorIfArgumentNull(a_hEndpoint);
+    OpcUa_ReturnErrorIfArgumentNull(a_hContext);
+    OpcUa_ReturnErrorIfArgumentNull(a_pRequestHeader);
+    OpcUa_ReferenceParameter(a_nMaxAge);
+    OpcUa_ReferenceParameter(a_eTimestampsToReturn);
+    OpcUa_ReturnErrorIfArrayArgumentNull(a_nNoOfNodesToRead, a_pNodesToRead);
+    OpcUa_ReturnErrorIfArgumentNull(a_pResponseHeader);
+    OpcUa_ReturnErrorIfArrayArgumentNull(a_pNoOfResults, a_pResults);
+    OpcUa_ReturnErrorIfArrayArgumentNull(a_pNoOfDiagnosticInfos, a_pDiagnosticInfos);
+
+	*a_pNoOfDiagnosticInfos=0;
+	*a_pDiagnosticInfos=OpcUa_Null;
+
+ #ifndef NO_DEBUGING_
+	MY_TRACE("\n\n\nRREADSERVICE==============================================\n");
+#endif /*_DEBUGING_*/
+  
+
+	uStatus=check_session(a_pRequestHeader,OpcUa_Null);
+	OpcUa_GotoErrorIfBad(uStatus);
+
+	uStatus=read_nodes(a_eTimestampsToReturn,a_nNoOfNodesToRead,a_pNodesToRead,a_pNoOfResults,a_pResults,OpcUa_False);
+	OpcUa_GotoErrorIfBad(uStatus);
+
 
 	
 	uStatus = response_header_ausfuellen(a_pResponseHeader,a_pRequestHeader,uStatus);
@@ -417,8 +424,6 @@ OpcUa_StatusCode my_Read(
 	MY_TRACE("\nSERVICE===ENDE============================================\n\n\n"); 
 #endif /*_DEBUGING_*/
 
-	RESET_SESSION_COUNTER
-
     OpcUa_ReturnStatusCode;
     OpcUa_BeginErrorHandling;
 
@@ -431,58 +436,148 @@ OpcUa_StatusCode my_Read(
 #ifndef NO_DEBUGING_
 	MY_TRACE("\nSERVICEENDE (IM SERVICE SIND FEHLER AUFGETRETTEN)===========\n\n\n"); 
 #endif /*_DEBUGING_*/
-	RESET_SESSION_COUNTER
     OpcUa_FinishErrorHandling;
 }
 
 
+#ifdef READ_ZERO_COPY
+/*============================================================================
+ * Read without copying: the results borrow NodeIds and strings from the
+ * address space until the response is encoded. Values are versioned copies.
+ *===========================================================================*/
+OpcUa_StatusCode my_BeginRead(
+							OpcUa_Endpoint        a_hEndpoint,
+							OpcUa_Handle          a_hContext,
+							OpcUa_Void**          a_ppRequest,
+							OpcUa_EncodeableType* a_pRequestType)
+{
+	OpcUa_ReadRequest*		pRequest		= OpcUa_Null;
+	OpcUa_ReadResponse*		pResponse		= OpcUa_Null;
+	OpcUa_EncodeableType*	pResponseType	= OpcUa_Null;
 
-OpcUa_StatusCode  fill_Variant_for_value_attribute(_VariableKnoten_*  p_Node, OpcUa_String* p_Index, OpcUa_DataValue* p_Results)
+	OpcUa_InitializeStatus(OpcUa_Module_Server, "my_BeginRead");
+
+	OpcUa_ReturnErrorIfArgumentNull(a_hEndpoint);
+	OpcUa_ReturnErrorIfArgumentNull(a_hContext);
+	OpcUa_ReturnErrorIfArgumentNull(a_ppRequest);
+	OpcUa_ReturnErrorIfArgumentNull(*a_ppRequest);
+	OpcUa_ReturnErrorIfArgumentNull(a_pRequestType);
+
+	OpcUa_ReturnErrorIfTrue(a_pRequestType->TypeId != OpcUaId_ReadRequest, OpcUa_BadInvalidArgument);
+
+	pRequest = (OpcUa_ReadRequest*)*a_ppRequest;
+
+	uStatus = OpcUa_Endpoint_BeginSendResponse(a_hEndpoint, a_hContext, (OpcUa_Void**)&pResponse, &pResponseType);
+	OpcUa_GotoErrorIfBad(uStatus);
+
+#ifndef NO_DEBUGING_
+	MY_TRACE("\n\n\nREADSERVICE (ZERO COPY)====================================\n");
+#endif /*_DEBUGING_*/
+
+	uStatus=check_session(&pRequest->RequestHeader,OpcUa_Null);
+	if(OpcUa_IsGood(uStatus))
+		uStatus=response_header_ausfuellen(&pResponse->ResponseHeader,&pRequest->RequestHeader,uStatus);
+	if(OpcUa_IsGood(uStatus))
+		uStatus=read_nodes(pRequest->TimestampsToReturn,pRequest->NoOfNodesToRead,pRequest->NodesToRead,&pResponse->NoOfResults,&pResponse->Results,OpcUa_True);
+
+	if(OpcUa_IsBad(uStatus))
+	{
+		OpcUa_Void*				pFault		= OpcUa_Null;
+		OpcUa_EncodeableType*	pFaultType	= OpcUa_Null;
+
+		uStatus = OpcUa_ServerApi_CreateFault(	&pRequest->RequestHeader,
+												uStatus,
+												&pResponse->ResponseHeader.ServiceDiagnostics,
+												&pResponse->ResponseHeader.NoOfStringTable,
+												&pResponse->ResponseHeader.StringTable,
+												&pFault,
+												&pFaultType);
+		OpcUa_GotoErrorIfBad(uStatus);
+
+		return_borrowed_values(pResponse->NoOfResults,pResponse->Results);
+		OpcUa_EncodeableObject_Delete(pResponseType, (OpcUa_Void**)&pResponse);
+
+		pResponse = (OpcUa_ReadResponse*)pFault;
+		pResponseType = pFaultType;
+	}
+
+	uStatus = OpcUa_Endpoint_EndSendResponse(a_hEndpoint, &a_hContext, OpcUa_Good, pResponse, pResponseType);
+	OpcUa_GotoErrorIfBad(uStatus);
+
+	if(pResponseType==&OpcUa_ReadResponse_EncodeableType)
+		return_borrowed_values(pResponse->NoOfResults,pResponse->Results);
+	OpcUa_EncodeableObject_Delete(pResponseType, (OpcUa_Void**)&pResponse);
+
+#ifndef NO_DEBUGING_
+	MY_TRACE("\nSERVICE===ENDE============================================\n\n\n");
+#endif /*_DEBUGING_*/
+
+	OpcUa_ReturnStatusCode;
+	OpcUa_BeginErrorHandling;
+
+	OpcUa_Endpoint_EndSendResponse(a_hEndpoint, &a_hContext, uStatus, OpcUa_Null, OpcUa_Null);
+	if(pResponse!=OpcUa_Null && pResponseType==&OpcUa_ReadResponse_EncodeableType)
+		return_borrowed_values(pResponse->NoOfResults,pResponse->Results);
+	OpcUa_EncodeableObject_Delete(pResponseType, (OpcUa_Void**)&pResponse);
+
+	OpcUa_FinishErrorHandling;
+}
+#endif /* READ_ZERO_COPY */
+
+
+OpcUa_StatusCode  fill_Variant_for_value_attribute(_VariableKnoten_*  p_Node, OpcUa_Boolean a_bBorrow, OpcUa_DataValue* p_Results)
 {
 	OpcUa_Int					i;
-	extern my_Variant			all_ValueAttribute_of_VariableTypeNodes_VariableNodes[];
+	my_Variant					Value;
+	_ValueVersion_				Version;
 	OpcUa_InitializeStatus(OpcUa_Module_Server, "fill_Variant_for_value_attribute");
 
 	OpcUa_ReturnErrorIfArgumentNull(p_Node);
-	/*OpcUa_ReturnErrorIfArgumentNull(p_Index);*/
 	OpcUa_ReturnErrorIfArgumentNull(p_Results);
+	OpcUa_MemSet(&Value,0,sizeof(my_Variant));
 	if(p_Node->ValueIndex == (-1))
 	{
 		OpcUa_GotoErrorWithStatus(OpcUa_BadNotReadable)
 	}
+
+	/* a consistent copy; the elements of an array are copied for the result */
+	uStatus=read_value(p_Node->ValueIndex,&Value,&Version);
+	OpcUa_GotoErrorIfBad(uStatus)
+	p_Results->SourceTimestamp=Version.SourceTimestamp;
+	p_Results->ServerTimestamp=Version.ServerTimestamp;
 	
-	if(all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].ArrayType==OpcUa_VariantArrayType_Scalar)
+	if(Value.ArrayType==OpcUa_VariantArrayType_Scalar)
 	{
-		switch(all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Datatype)
+		switch(Value.Datatype)
 		{
 		case OpcUaId_Double:
 			{
-				p_Results->Value.Value.Double=all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.Double;
+				p_Results->Value.Value.Double=Value.Value.Double;
 				fill_datatype_arraytype_in_my_Variant(p_Results,OpcUaId_Double, OpcUa_VariantArrayType_Scalar,0);
 				break;
 			}
 		case OpcUaId_DateTime:
 			{
-				p_Results->Value.Value.DateTime=all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.DateTime;
+				p_Results->Value.Value.DateTime=Value.Value.DateTime;
 				fill_datatype_arraytype_in_my_Variant(p_Results,OpcUaId_DateTime, OpcUa_VariantArrayType_Scalar,0);
 				break;
 			}
 		case OpcUaId_String:
 			{
-				uStatus= OpcUa_String_AttachCopy(&(p_Results->Value.Value.String),all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.String);
+				uStatus= attach_string(&(p_Results->Value.Value.String),Value.Value.String,a_bBorrow);
 				OpcUa_GotoErrorIfBad(uStatus)
 				fill_datatype_arraytype_in_my_Variant(p_Results,OpcUaId_String, OpcUa_VariantArrayType_Scalar,0);
 				break;
 			}
 		case OpcUaId_UInt32:
 			{
-				p_Results->Value.Value.UInt32=all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.UInt32;
+				p_Results->Value.Value.UInt32=Value.Value.UInt32;
 				fill_datatype_arraytype_in_my_Variant(p_Results,OpcUaId_UInt32, OpcUa_VariantArrayType_Scalar,0);
 				break;
 			}
 		case OpcUaId_Boolean:
 			{
-				p_Results->Value.Value.Boolean=all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.Boolean;
+				p_Results->Value.Value.Boolean=Value.Value.Boolean;
 				fill_datatype_arraytype_in_my_Variant(p_Results,OpcUaId_Boolean, OpcUa_VariantArrayType_Scalar,0);
 				break;
 			}
@@ -490,57 +585,43 @@ OpcUa_StatusCode  fill_Variant_for_value_attribute(_VariableKnoten_*  p_Node, Op
 	
 	}
 
-	if(all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].ArrayType==OpcUa_VariantArrayType_Array)
+	if(Value.ArrayType==OpcUa_VariantArrayType_Array)
 	{
-		switch(all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Datatype)
+		switch(Value.Datatype)
 		{
 		case OpcUaId_Double:
+		case OpcUaId_UInt32:
+		case OpcUaId_Boolean:
 			{
-				p_Results->Value.Value.Array.Value.DoubleArray=OpcUa_Memory_Alloc((all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.Array.Length)*sizeof(OpcUa_Double));
-				OpcUa_GotoErrorIfAllocFailed((p_Results->Value.Value.Array.Value.DoubleArray))
-				
-				OpcUa_MemCpy((p_Results->Value.Value.Array.Value.DoubleArray),(all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.Array.Length)*sizeof(OpcUa_Double),(all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.Array.Value.DoubleArray),(all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.Array.Length)*sizeof(OpcUa_Double));
-				fill_datatype_arraytype_in_my_Variant(p_Results,OpcUaId_Double, OpcUa_VariantArrayType_Array,all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.Array.Length);
+				/* the copy of the elements becomes the result */
+				p_Results->Value.Value.Array.Value.Array=Value.Value.Array.Value.Array;
+				Value.Value.Array.Value.Array=OpcUa_Null;
+				fill_datatype_arraytype_in_my_Variant(p_Results,Value.Datatype, OpcUa_VariantArrayType_Array,Value.Value.Array.Length);
 				break;
 			}
 		case OpcUaId_String:
 			{
-				p_Results->Value.Value.Array.Value.StringArray=OpcUa_Memory_Alloc((all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.Array.Length)*sizeof(OpcUa_String));
-				OpcUa_GotoErrorIfAllocFailed((p_Results->Value.Value.Array.Value.DoubleArray))
+				p_Results->Value.Value.Array.Value.StringArray=OpcUa_Memory_Alloc(Value.Value.Array.Length*sizeof(OpcUa_String));
+				OpcUa_GotoErrorIfAllocFailed((p_Results->Value.Value.Array.Value.StringArray))
+				OpcUa_MemSet(p_Results->Value.Value.Array.Value.StringArray,0,Value.Value.Array.Length*sizeof(OpcUa_String));
+				fill_datatype_arraytype_in_my_Variant(p_Results,OpcUaId_String, OpcUa_VariantArrayType_Array,Value.Value.Array.Length);
 
-				for(i=0;i<(all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.Array.Length);i++)
+				for(i=0;i<Value.Value.Array.Length;i++)
 				{
-					uStatus= OpcUa_String_AttachCopy((p_Results->Value.Value.Array.Value.StringArray)+i,*(all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.Array.Value.StringArray+i));
+					uStatus= attach_string((p_Results->Value.Value.Array.Value.StringArray)+i,Value.Value.Array.Value.StringArray[i],a_bBorrow);
 					if(OpcUa_IsBad(uStatus))
 						OpcUa_GotoError
 				}
-				fill_datatype_arraytype_in_my_Variant(p_Results,OpcUaId_String, OpcUa_VariantArrayType_Array,all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.Array.Length);
-				break;
-			}
-		case OpcUaId_UInt32:
-			{
-				p_Results->Value.Value.Array.Value.UInt32Array=OpcUa_Memory_Alloc((all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.Array.Length)*sizeof(OpcUa_UInt32));
-				OpcUa_GotoErrorIfAllocFailed((p_Results->Value.Value.Array.Value.UInt32Array))
-
-				OpcUa_MemCpy((p_Results->Value.Value.Array.Value.UInt32Array),(all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.Array.Length)*sizeof(OpcUa_UInt32),(all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.Array.Value.UInt32Array),(all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.Array.Length)*sizeof(OpcUa_UInt32));
-				fill_datatype_arraytype_in_my_Variant(p_Results,OpcUaId_UInt32, OpcUa_VariantArrayType_Array,all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.Array.Length);
-				break;
-			}
-		case OpcUaId_Boolean:
-			{
-				p_Results->Value.Value.Array.Value.BooleanArray=OpcUa_Memory_Alloc((all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.Array.Length)*sizeof(OpcUa_Boolean));
-				OpcUa_GotoErrorIfAllocFailed((p_Results->Value.Value.Array.Value.BooleanArray))
-
-				OpcUa_MemCpy((p_Results->Value.Value.Array.Value.BooleanArray),(all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.Array.Length)*sizeof(OpcUa_Boolean),(all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.Array.Value.BooleanArray),(all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.Array.Length)*sizeof(OpcUa_Boolean));
-				fill_datatype_arraytype_in_my_Variant(p_Results,OpcUaId_UInt32, OpcUa_VariantArrayType_Array,all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex].Value.Array.Length);
 				break;
 			}
 		}
 	}
+	clear_value(&Value);
 	
 	OpcUa_ReturnStatusCode;
     OpcUa_BeginErrorHandling;
 	
+	clear_value(&Value);
 	p_Results->StatusCode=uStatus;
 	OpcUa_FinishErrorHandling;
 }
@@ -557,6 +638,9 @@ OpcUa_StatusCode fill_datatype_arraytype_in_my_Variant(OpcUa_DataValue* p_Result
 	return OpcUa_Good;
 }
 
+/*============================================================================
+ * keeps the timestamps of the value which were asked for.
+ *===========================================================================*/
 OpcUa_StatusCode assigne_Timestamp(OpcUa_DataValue* p_Results,OpcUa_TimestampsToReturn a_eTimestampsToReturn)
 {
 	OpcUa_StatusCode			uStatus     = OpcUa_Bad;
@@ -564,18 +648,22 @@ OpcUa_StatusCode assigne_Timestamp(OpcUa_DataValue* p_Results,OpcUa_TimestampsTo
 
 	if(a_eTimestampsToReturn == OpcUa_TimestampsToReturn_Source)
 	{
-		p_Results->SourceTimestamp=OpcUa_DateTime_UtcNow();
+		OpcUa_DateTime_Initialize(&p_Results->ServerTimestamp);
 		uStatus     = OpcUa_Good;
 	}
 	if(a_eTimestampsToReturn == OpcUa_TimestampsToReturn_Server)
 	{
-		p_Results->ServerTimestamp=OpcUa_DateTime_UtcNow();
+		OpcUa_DateTime_Initialize(&p_Results->SourceTimestamp);
 		uStatus     = OpcUa_Good;
 	}
 	if(a_eTimestampsToReturn == OpcUa_TimestampsToReturn_Both)
 	{
-		p_Results->ServerTimestamp=OpcUa_DateTime_UtcNow();
-		p_Results->SourceTimestamp=OpcUa_DateTime_UtcNow();
+		uStatus     = OpcUa_Good;
+	}
+	if(a_eTimestampsToReturn == OpcUa_TimestampsToReturn_Neither)
+	{
+		OpcUa_DateTime_Initialize(&p_Results->ServerTimestamp);
+		OpcUa_DateTime_Initialize(&p_Results->SourceTimestamp);
 		uStatus     = OpcUa_Good;
 	}
 	return uStatus;
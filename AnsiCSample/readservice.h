@@ -30,8 +30,9 @@
 #ifndef _readservice_
 #define _readservice_
 
+/* Read borrows NodeIds and strings from the address space instead of copying them */
+#define READ_ZERO_COPY
 
-#define RESET_SESSION_COUNTER	msec_counter=0; 
 
 
 OpcUa_StatusCode my_Read(
@@ -47,7 +48,14 @@ OpcUa_StatusCode my_Read(
 							OpcUa_DataValue**          a_pResults,
 							OpcUa_Int32*               a_pNoOfDiagnosticInfos,
 							OpcUa_DiagnosticInfo**     a_pDiagnosticInfos);
-OpcUa_StatusCode  fill_Variant_for_value_attribute(_VariableKnoten_*  , OpcUa_String* , OpcUa_DataValue* );
+#ifdef READ_ZERO_COPY
+OpcUa_StatusCode my_BeginRead(
+							OpcUa_Endpoint        a_hEndpoint,
+							OpcUa_Handle          a_hContext,
+							OpcUa_Void**          a_ppRequest,
+							OpcUa_EncodeableType* a_pRequestType);
+#endif /* READ_ZERO_COPY */
+OpcUa_StatusCode  fill_Variant_for_value_attribute(_VariableKnoten_*  , OpcUa_Boolean , OpcUa_DataValue* );
 
 OpcUa_StatusCode fill_datatype_arraytype_in_my_Variant(OpcUa_DataValue* ,OpcUa_Byte, OpcUa_Byte,OpcUa_Int);
 
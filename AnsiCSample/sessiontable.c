@@ -0,0 +1,484 @@
+/* ========================================================================
+ * Copyright (c) 2005-2016 The OPC Foundation, Inc. All rights reserved.
+ *
+ * OPC Foundation MIT License 1.00
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * The complete license agreement can be found here:
+ * http://opcfoundation.org/License/MIT/1.00/
+ * ======================================================================*/
+ 
+/* serverstub (basic includes for implementing a server based on the stack) */
+#include <opcua_serverstub.h>
+#include <opcua_string.h>
+#include <opcua_memory.h>
+#include <opcua_core.h>
+#include <opcua_mutex.h>
+#include <opcua_guid.h>
+
+#include "addressspace.h"
+#include "mytrace.h"
+#include "sessiontable.h"
+#include "subscriptionservice.h"
+#include "browseservice.h"
+#include "general_header.h"
+
+
+static OpcUa_Mutex				session_table_mutex			= OpcUa_Null;	/* free slots and the wheel */
+static OpcUa_Mutex				session_stripes[SESSION_LOCK_STRIPES];		/* buckets and the sessions in them */
+static _Session_				sessions[MAX_SESSIONS];
+static OpcUa_Int				session_buckets[SESSION_HASH_SIZE];
+static OpcUa_Int				session_wheel[SESSION_WHEEL_SLOTS];
+static volatile OpcUa_UInt32	session_ticks;
+static OpcUa_UInt32				session_msec;
+static OpcUa_UInt32				last_session_id;
+
+
+/*============================================================================
+ * hash of an AuthenticationToken.
+ *===========================================================================*/
+static OpcUa_Int guid_bucket(const OpcUa_Guid* a_pGuid)
+{
+	const OpcUa_Byte*	p		= (const OpcUa_Byte*)a_pGuid;
+	OpcUa_UInt32		uHash	= 2166136261u;
+	OpcUa_UInt32		i;
+
+	for(i=0;i<sizeof(OpcUa_Guid);i++)
+		uHash=(uHash^p[i])*16777619u;
+	return (OpcUa_Int)(uHash&(SESSION_HASH_SIZE-1));
+}
+
+#define STRIPE_OF(xBucket)		session_stripes[(xBucket)&(SESSION_LOCK_STRIPES-1)]
+
+/*============================================================================
+ * the bucket of the token in a request header, -1 if it is no Guid.
+ *===========================================================================*/
+static OpcUa_Int token_bucket(const OpcUa_RequestHeader* a_pRequestHeader)
+{
+	if(a_pRequestHeader==OpcUa_Null
+		|| a_pRequestHeader->AuthenticationToken.IdentifierType!=OpcUa_IdentifierType_Guid
+		|| a_pRequestHeader->AuthenticationToken.Identifier.Guid==OpcUa_Null)
+		return -1;
+	return guid_bucket(a_pRequestHeader->AuthenticationToken.Identifier.Guid);
+}
+
+/* the stripe of a_Bucket must be locked */
+static OpcUa_Int find_session(OpcUa_Int a_Bucket, const OpcUa_RequestHeader* a_pRequestHeader)
+{
+	OpcUa_Int i;
+
+	for(i=session_buckets[a_Bucket];i>=0;i=sessions[i].NextInBucket)
+	{
+		if(OpcUa_Guid_IsEqual(&sessions[i].AuthenticationToken,a_pRequestHeader->AuthenticationToken.Identifier.Guid))
+			return i;
+	}
+	return -1;
+}
+
+/* the stripe of the session must be locked */
+static OpcUa_Void bucket_unlink(OpcUa_Int a_Session)
+{
+	OpcUa_Int* pLink=&session_buckets[sessions[a_Session].Bucket];
+
+	while(*pLink!=a_Session)
+		pLink=&sessions[*pLink].NextInBucket;
+	*pLink=sessions[a_Session].NextInBucket;
+}
+
+/* session_table_mutex must be locked */
+static OpcUa_Void wheel_insert(OpcUa_Int a_Session, OpcUa_UInt32 a_uExpires)
+{
+	OpcUa_Int Slot=(OpcUa_Int)(a_uExpires&(SESSION_WHEEL_SLOTS-1));
+
+	sessions[a_Session].Expires=a_uExpires;
+	sessions[a_Session].PrevInSlot=-1;
+	sessions[a_Session].NextInSlot=session_wheel[Slot];
+	if(session_wheel[Slot]>=0)
+		sessions[session_wheel[Slot]].PrevInSlot=a_Session;
+	session_wheel[Slot]=a_Session;
+}
+
+/* session_table_mutex must be locked */
+static OpcUa_Void wheel_remove(OpcUa_Int a_Session)
+{
+	_Session_* pSession=&sessions[a_Session];
+
+	if(pSession->PrevInSlot>=0)
+		sessions[pSession->PrevInSlot].NextInSlot=pSession->NextInSlot;
+	else
+		session_wheel[pSession->Expires&(SESSION_WHEEL_SLOTS-1)]=pSession->NextInSlot;
+	if(pSession->NextInSlot>=0)
+		sessions[pSession->NextInSlot].PrevInSlot=pSession->PrevInSlot;
+}
+
+/*============================================================================
+ * takes a session out of the table; both locks must be held. The caller
+ * ends its subscriptions once the locks are released.
+ *===========================================================================*/
+static OpcUa_UInt32 remove_session(OpcUa_Int a_Session)
+{
+	OpcUa_UInt32 uSessionId=sessions[a_Session].SessionId;
+
+	bucket_unlink(a_Session);
+	wheel_remove(a_Session);
+	if(sessions[a_Session].pUserName!=OpcUa_Null)
+		username_free(&sessions[a_Session].pUserName);
+	OpcUa_MemSet(&sessions[a_Session],0,sizeof(_Session_));
+	return uSessionId;
+}
+
+/*============================================================================
+ * creates the locks of the session table.
+ *===========================================================================*/
+OpcUa_StatusCode initialize_sessions(OpcUa_Void)
+{
+	OpcUa_Int i;
+
+	OpcUa_InitializeStatus(OpcUa_Module_Server, "initialize_sessions");
+
+	OpcUa_MemSet(sessions,0,sizeof(sessions));
+	for(i=0;i<SESSION_HASH_SIZE;i++)
+		session_buckets[i]=-1;
+	for(i=0;i<SESSION_WHEEL_SLOTS;i++)
+		session_wheel[i]=-1;
+	session_ticks=0;
+	session_msec=0;
+
+	uStatus=OpcUa_Mutex_Create(&session_table_mutex);
+	OpcUa_GotoErrorIfBad(uStatus);
+	for(i=0;i<SESSION_LOCK_STRIPES;i++)
+	{
+		uStatus=OpcUa_Mutex_Create(&session_stripes[i]);
+		OpcUa_GotoErrorIfBad(uStatus);
+	}
+
+	OpcUa_ReturnStatusCode;
+	OpcUa_BeginErrorHandling;
+
+	clear_sessions();
+
+	OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * frees what is left of the session table.
+ *===========================================================================*/
+OpcUa_Void clear_sessions(OpcUa_Void)
+{
+	OpcUa_Int i;
+
+	for(i=0;i<MAX_SESSIONS;i++)
+	{
+		if(sessions[i].pUserName!=OpcUa_Null)
+			username_free(&sessions[i].pUserName);
+	}
+	OpcUa_MemSet(sessions,0,sizeof(sessions));
+
+	for(i=0;i<SESSION_LOCK_STRIPES;i++)
+	{
+		if(session_stripes[i]!=OpcUa_Null)
+			OpcUa_Mutex_Delete(&session_stripes[i]);
+	}
+	if(session_table_mutex!=OpcUa_Null)
+		OpcUa_Mutex_Delete(&session_table_mutex);
+}
+
+/*============================================================================
+ * adds a session that still has to be activated.
+ *===========================================================================*/
+OpcUa_StatusCode create_session(OpcUa_UInt32	a_uSecureChannelId,
+								OpcUa_UInt32	a_uTimeout,
+								OpcUa_NodeId*	a_pSessionId,
+								OpcUa_NodeId*	a_pAuthenticationToken)
+{
+	_Session_*	pSession	= OpcUa_Null;
+	OpcUa_Int	i;
+
+	OpcUa_InitializeStatus(OpcUa_Module_Server, "create_session");
+
+	OpcUa_ReturnErrorIfArgumentNull(a_pSessionId);
+	OpcUa_ReturnErrorIfArgumentNull(a_pAuthenticationToken);
+
+	/* the response takes the Guid along */
+	a_pAuthenticationToken->Identifier.Guid=OpcUa_Alloc(sizeof(OpcUa_Guid));
+	OpcUa_ReturnErrorIfAllocFailed(a_pAuthenticationToken->Identifier.Guid);
+	a_pAuthenticationToken->IdentifierType=OpcUa_IdentifierType_Guid;
+	a_pAuthenticationToken->NamespaceIndex=0;
+
+	OpcUa_Mutex_Lock(session_table_mutex);
+
+	for(i=0;i<MAX_SESSIONS;i++)
+	{
+		if(sessions[i].SessionId==0)
+		{
+			pSession=&sessions[i];
+			break;
+		}
+	}
+	if(pSession==OpcUa_Null)
+	{
+		OpcUa_Mutex_Unlock(session_table_mutex);
+		OpcUa_GotoErrorWithStatus(OpcUa_BadTooManySessions);
+	}
+	if(OpcUa_Guid_Create(&pSession->AuthenticationToken)==OpcUa_Null)
+	{
+		OpcUa_Mutex_Unlock(session_table_mutex);
+		OpcUa_GotoErrorWithStatus(OpcUa_BadInternalError);
+	}
+
+	if(++last_session_id==0)
+		last_session_id=1;
+	pSession->SessionId=last_session_id;
+	pSession->SecureChannelId=a_uSecureChannelId;
+	pSession->Flag=SESSION_NOT_ACTIVATED;
+	pSession->pUserName=OpcUa_Null;
+	pSession->Timeout=(a_uTimeout+SESSION_TICK-1)/SESSION_TICK;
+	if(pSession->Timeout==0)
+		pSession->Timeout=1;
+	pSession->LastActivity=session_ticks;
+	pSession->Bucket=guid_bucket(&pSession->AuthenticationToken);
+
+	OpcUa_Mutex_Lock(STRIPE_OF(pSession->Bucket));
+	pSession->NextInBucket=session_buckets[pSession->Bucket];
+	session_buckets[pSession->Bucket]=i;
+	OpcUa_Mutex_Unlock(STRIPE_OF(pSession->Bucket));
+
+	wheel_insert(i,session_ticks+pSession->Timeout);
+
+	a_pSessionId->IdentifierType=OpcUa_IdentifierType_Numeric;
+	a_pSessionId->NamespaceIndex=1;
+	a_pSessionId->Identifier.Numeric=pSession->SessionId;
+	*a_pAuthenticationToken->Identifier.Guid=pSession->AuthenticationToken;
+
+	OpcUa_Mutex_Unlock(session_table_mutex);
+
+#ifndef NO_DEBUGING_
+	MY_TRACE("\nSession %u angelegt\n",a_pSessionId->Identifier.Numeric); 
+#endif /*_DEBUGING_*/
+
+	OpcUa_ReturnStatusCode;
+	OpcUa_BeginErrorHandling;
+
+	OpcUa_NodeId_Clear(a_pAuthenticationToken);
+
+	OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * activates a session, or moves an active one to a new SecureChannel.
+ *===========================================================================*/
+OpcUa_StatusCode activate_session(	const OpcUa_RequestHeader*		a_pRequestHeader,
+									OpcUa_UInt32					a_uSecureChannelId,
+									const OpcUa_ExtensionObject*	a_pUserIdentityToken)
+{
+	_Session_*	pSession;
+	OpcUa_Int	Bucket	= token_bucket(a_pRequestHeader);
+	OpcUa_Int	i;
+
+	OpcUa_InitializeStatus(OpcUa_Module_Server, "activate_session");
+
+	OpcUa_ReturnErrorIfTrue(Bucket<0,OpcUa_BadSessionIdInvalid);
+
+	OpcUa_Mutex_Lock(STRIPE_OF(Bucket));
+
+	i=find_session(Bucket,a_pRequestHeader);
+	if(i<0)
+	{
+		OpcUa_GotoErrorWithStatus(OpcUa_BadSessionIdInvalid);
+	}
+	pSession=&sessions[i];
+
+	if(OpcUa_IsBad(pSession->Flag))
+	{
+		/* the first activation must come through the channel that created the session */
+		if(a_uSecureChannelId!=pSession->SecureChannelId)
+		{
+			OpcUa_GotoErrorWithStatus(OpcUa_BadSecurityChecksFailed);
+		}
+	}
+	else if(a_uSecureChannelId!=pSession->SecureChannelId)
+	{
+		pSession->SecureChannelId=a_uSecureChannelId;
+#ifndef NO_DEBUGING_
+		MY_TRACE("\nNeuer Securechannel(%d) der Session %u zugewiesen\n",a_uSecureChannelId,pSession->SessionId);
+#endif /*_DEBUGING_*/
+	}
+
+	uStatus=check_useridentitytoken(a_pUserIdentityToken,&pSession->pUserName);
+	OpcUa_GotoErrorIfBad(uStatus);
+
+	pSession->Flag=SESSION_ACTIVATED;
+	pSession->LastActivity=session_ticks;
+
+#ifndef NO_DEBUGING_
+	if(pSession->pUserName!=OpcUa_Null)
+		MY_TRACE("\nUser(%s) hat sich angemeldet\n",OpcUa_String_GetRawString(pSession->pUserName)); 
+	MY_TRACE("\nSession %u aktiviert!!!\n",pSession->SessionId); 
+#endif /*_DEBUGING_*/
+
+	OpcUa_Mutex_Unlock(STRIPE_OF(Bucket));
+
+	OpcUa_ReturnStatusCode;
+	OpcUa_BeginErrorHandling;
+
+	OpcUa_Mutex_Unlock(STRIPE_OF(Bucket));
+
+	OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * ends a session; its subscriptions are not transferred and end with it.
+ *===========================================================================*/
+OpcUa_StatusCode close_session(const OpcUa_RequestHeader* a_pRequestHeader)
+{
+	OpcUa_Int		Bucket		= token_bucket(a_pRequestHeader);
+	OpcUa_Int		i;
+	OpcUa_UInt32	uSessionId	= 0;
+
+	if(Bucket<0)
+		return OpcUa_BadSessionIdInvalid;
+
+	OpcUa_Mutex_Lock(session_table_mutex);
+	OpcUa_Mutex_Lock(STRIPE_OF(Bucket));
+
+	i=find_session(Bucket,a_pRequestHeader);
+	if(i>=0)
+	{
+#ifndef NO_DEBUGING_
+		if(sessions[i].pUserName!=OpcUa_Null)
+			MY_TRACE("\nUser(%s) hat sich abgemeldet\n",OpcUa_String_GetRawString(sessions[i].pUserName)); 
+#endif /*_DEBUGING_*/
+		uSessionId=remove_session(i);
+	}
+
+	OpcUa_Mutex_Unlock(STRIPE_OF(Bucket));
+	OpcUa_Mutex_Unlock(session_table_mutex);
+
+	if(uSessionId==0)
+		return OpcUa_BadSessionIdInvalid;
+
+	delete_session_subscriptions(uSessionId,OpcUa_BadSessionClosed);
+	delete_session_continuationpoints(uSessionId);
+
+#ifndef NO_DEBUGING_
+	MY_TRACE("\nSession %u deaktiviert!!!\n",uSessionId); 
+#endif /*_DEBUGING_*/
+	return OpcUa_Good;
+}
+
+/*============================================================================
+ * the session check every service after ActivateSession starts with.
+ * Keeps the session alive and returns its id.
+ *===========================================================================*/
+OpcUa_StatusCode check_session(const OpcUa_RequestHeader* a_pRequestHeader, OpcUa_UInt32* a_pSessionId)
+{
+	OpcUa_Int			Bucket		= token_bucket(a_pRequestHeader);
+	OpcUa_Int			i;
+	OpcUa_StatusCode	uStatus		= OpcUa_Good;
+
+	if(Bucket<0)
+		return OpcUa_BadSessionIdInvalid;
+
+	OpcUa_Mutex_Lock(STRIPE_OF(Bucket));
+
+	i=find_session(Bucket,a_pRequestHeader);
+	if(i<0)
+	{
+#ifndef NO_DEBUGING_
+		MY_TRACE("\nAuthentication Token ungueltig.\n"); 
+#endif /*_DEBUGING_*/
+		uStatus=OpcUa_BadSessionIdInvalid;
+	}
+	else if(OpcUa_IsBad(sessions[i].Flag))
+	{
+#ifndef NO_DEBUGING_
+		MY_TRACE("\nSession nicht aktiv\n"); 
+#endif /*_DEBUGING_*/
+		uStatus=OpcUa_BadSessionNotActivated;
+	}
+	else
+	{
+		sessions[i].LastActivity=session_ticks;
+		if(a_pSessionId!=OpcUa_Null)
+			*a_pSessionId=sessions[i].SessionId;
+#ifndef NO_DEBUGING_
+		if(sessions[i].pUserName!=OpcUa_Null)
+			MY_TRACE("\nSession %u, User:%s\n",sessions[i].SessionId,OpcUa_String_GetRawString(sessions[i].pUserName)); 
+#endif /*_DEBUGING_*/
+	}
+
+	OpcUa_Mutex_Unlock(STRIPE_OF(Bucket));
+	return uStatus;
+}
+
+/*============================================================================
+ * advances the wheel; called from the server timer.
+ *===========================================================================*/
+OpcUa_Void expire_sessions(OpcUa_UInt32 a_msecElapsed)
+{
+	OpcUa_UInt32	Expired[MAX_SESSIONS];
+	OpcUa_Int		NoOfExpired		= 0;
+	OpcUa_UInt32	uDeadline;
+	OpcUa_Int		i,Next,Bucket;
+
+	OpcUa_Mutex_Lock(session_table_mutex);
+
+	session_msec+=a_msecElapsed;
+	while(session_msec>=SESSION_TICK)
+	{
+		session_msec-=SESSION_TICK;
+		session_ticks++;
+
+		for(i=session_wheel[session_ticks&(SESSION_WHEEL_SLOTS-1)];i>=0;i=Next)
+		{
+			Next=sessions[i].NextInSlot;
+			if(sessions[i].Expires!=session_ticks)
+				continue;	/* a later round */
+
+			Bucket=sessions[i].Bucket;
+			OpcUa_Mutex_Lock(STRIPE_OF(Bucket));
+			uDeadline=sessions[i].LastActivity+sessions[i].Timeout;
+			if((OpcUa_Int32)(uDeadline-session_ticks)>0)
+			{
+				/* there was activity since it was put here */
+				wheel_remove(i);
+				wheel_insert(i,uDeadline);
+			}
+			else
+			{
+				Expired[NoOfExpired++]=remove_session(i);
+			}
+			OpcUa_Mutex_Unlock(STRIPE_OF(Bucket));
+		}
+	}
+
+	OpcUa_Mutex_Unlock(session_table_mutex);
+
+	for(i=0;i<NoOfExpired;i++)
+	{
+#ifndef NO_DEBUGING_
+		MY_TRACE("\nSession %u abgelaufen!!! \n",Expired[i]); 
+#endif /*_DEBUGING_*/
+		delete_session_subscriptions(Expired[i],OpcUa_BadSessionClosed);
+		delete_session_continuationpoints(Expired[i]);
+	}
+}
@@ -0,0 +1,80 @@
+/* ========================================================================
+ * Copyright (c) 2005-2016 The OPC Foundation, Inc. All rights reserved.
+ *
+ * OPC Foundation MIT License 1.00
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * The complete license agreement can be found here:
+ * http://opcfoundation.org/License/MIT/1.00/
+ * ======================================================================*/
+ 
+#ifndef _sessiontable_
+#define _sessiontable_
+
+/*============================================================================
+ * session table.
+ * Sessions are found by their AuthenticationToken, a random Guid, through
+ * a hash table. The hash buckets are spread over SESSION_LOCK_STRIPES
+ * mutexes, so a service call only locks the stripe of its own session and
+ * calls of different sessions rarely wait for each other.
+ * Timeouts are kept on a timer wheel that the server timer advances. A
+ * request only records the tick of its activity; whether a session has
+ * really expired is decided when its slot of the wheel comes round.
+ *===========================================================================*/
+#define MAX_SESSIONS					16
+#define SESSION_HASH_SIZE				64		/* power of two */
+#define SESSION_LOCK_STRIPES			8		/* power of two, not above SESSION_HASH_SIZE */
+#define SESSION_WHEEL_SLOTS				256		/* power of two */
+#define SESSION_TICK					10		/* msec per slot of the wheel */
+#define MAX_SESSIONTIMEOUT				3600000	/* msec */
+
+typedef struct{
+	OpcUa_UInt32		SessionId;							/* 0: slot is free */
+	OpcUa_Guid			AuthenticationToken;
+	OpcUa_UInt32		SecureChannelId;
+	OpcUa_StatusCode	Flag;								/* SESSION_ACTIVATED or SESSION_NOT_ACTIVATED */
+	OpcUa_String*		pUserName;
+	OpcUa_UInt32		Timeout;							/* ticks */
+	OpcUa_UInt32		LastActivity;						/* tick of the last request */
+	OpcUa_UInt32		Expires;							/* tick the wheel looks at the session again */
+	OpcUa_Int			Bucket;
+	OpcUa_Int			NextInBucket;						/* -1: end of the chain */
+	OpcUa_Int			NextInSlot;							/* chain of the wheel slot */
+	OpcUa_Int			PrevInSlot;
+}_Session_;
+
+
+OpcUa_StatusCode		initialize_sessions			(OpcUa_Void);
+
+OpcUa_Void				clear_sessions				(OpcUa_Void);
+
+OpcUa_StatusCode		create_session				(OpcUa_UInt32 , OpcUa_UInt32 , OpcUa_NodeId* , OpcUa_NodeId* );
+
+OpcUa_StatusCode		activate_session			(const OpcUa_RequestHeader* , OpcUa_UInt32 , const OpcUa_ExtensionObject* );
+
+OpcUa_StatusCode		close_session				(const OpcUa_RequestHeader* );
+
+OpcUa_StatusCode		check_session				(const OpcUa_RequestHeader* , OpcUa_UInt32* );
+
+OpcUa_Void				expire_sessions				(OpcUa_UInt32 );
+
+#endif /*_sessiontable_*/
@@ -0,0 +1,1501 @@
+/* ========================================================================
+ * Copyright (c) 2005-2016 The OPC Foundation, Inc. All rights reserved.
+ *
+ * OPC Foundation MIT License 1.00
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * The complete license agreement can be found here:
+ * http://opcfoundation.org/License/MIT/1.00/
+ * ======================================================================*/
+ 
+/* serverstub (basic includes for implementing a server based on the stack) */
+#include <opcua_serverstub.h>
+#include <opcua_string.h>
+#include <opcua_memory.h>
+#include <opcua_core.h>
+#include <opcua_mutex.h>
+#include <opcua_timer.h>
+#include <opcua_datetime.h>
+#include <opcua_encoder.h>
+
+#include "addressspace.h"
+#include "browseservice.h"
+#include "mytrace.h"
+#include "readservice.h"
+#include "sessiontable.h"
+#include "subscriptionservice.h"
+#include "valuestore.h"
+#include "general_header.h"
+
+
+static OpcUa_Mutex				subscription_mutex			= OpcUa_Null;
+static OpcUa_Timer				subscription_timer			= OpcUa_Null;
+static _Subscription_			subscriptions[MAX_SUBSCRIPTIONS];
+static _MonitoredItem_			monitoreditems[MAX_MONITOREDITEMS];
+static _SamplingBucket_			sampling_buckets[MAX_SAMPLINGBUCKETS];
+static _PublishRequest_			publish_requests[MAX_PUBLISHREQUESTS];	/* oldest first */
+static OpcUa_Int				no_of_publish_requests;
+static OpcUa_UInt32				last_subscription_id;
+static OpcUa_UInt32				last_monitoreditem_id;
+
+#define DATAVALUE_VALUE					0x01
+#define DATAVALUE_SOURCETIMESTAMP		0x04
+#define DATAVALUE_SERVERTIMESTAMP		0x08
+#define VARIANT_ARRAY					0x80
+
+
+/*============================================================================
+ * a subscription of a session; other sessions do not see it.
+ *===========================================================================*/
+static OpcUa_Int find_subscription(OpcUa_UInt32 a_uSessionId, OpcUa_UInt32 a_nSubscriptionId)
+{
+	OpcUa_Int i;
+
+	for(i=0;i<MAX_SUBSCRIPTIONS;i++)
+	{
+		if(a_nSubscriptionId!=0 && subscriptions[i].SubscriptionId==a_nSubscriptionId && subscriptions[i].SessionId==a_uSessionId)
+			return i;
+	}
+	return -1;
+}
+
+static OpcUa_Int no_of_subscriptions(OpcUa_UInt32 a_uSessionId)
+{
+	OpcUa_Int i,n=0;
+
+	for(i=0;i<MAX_SUBSCRIPTIONS;i++)
+	{
+		if(subscriptions[i].SubscriptionId!=0 && subscriptions[i].SessionId==a_uSessionId)
+			n++;
+	}
+	return n;
+}
+
+/*============================================================================
+ * change detection of a sampled value against the last reported one.
+ *===========================================================================*/
+static OpcUa_Boolean value_changed(const my_Variant* a_pOld, const my_Variant* a_pNew, OpcUa_Double a_dDeadband)
+{
+	OpcUa_Double dDiff;
+
+	if(a_pOld->Datatype!=a_pNew->Datatype || a_pOld->ArrayType!=a_pNew->ArrayType)
+		return OpcUa_True;
+
+	/* an array was written, since its version moved */
+	if(a_pNew->ArrayType!=OpcUa_VariantArrayType_Scalar)
+		return OpcUa_True;
+
+	switch(a_pNew->Datatype)
+	{
+	case OpcUaId_Double:
+		dDiff=a_pNew->Value.Double-a_pOld->Value.Double;
+		break;
+	case OpcUaId_UInt32:
+		dDiff=(OpcUa_Double)a_pNew->Value.UInt32-(OpcUa_Double)a_pOld->Value.UInt32;
+		break;
+	case OpcUaId_Boolean:
+		return (OpcUa_Boolean)(a_pNew->Value.Boolean!=a_pOld->Value.Boolean);
+	case OpcUaId_DateTime:
+		return (OpcUa_Boolean)(a_pNew->Value.DateTime.dwLowDateTime!=a_pOld->Value.DateTime.dwLowDateTime || a_pNew->Value.DateTime.dwHighDateTime!=a_pOld->Value.DateTime.dwHighDateTime);
+	case OpcUaId_String:
+		return (OpcUa_Boolean)(a_pNew->Value.String!=a_pOld->Value.String);
+	default:
+		return OpcUa_False;
+	}
+
+	if(dDiff<0)
+		dDiff=-dDiff;
+	if(a_dDeadband>0)
+		return (OpcUa_Boolean)(dDiff>a_dDeadband);
+	return (OpcUa_Boolean)(dDiff!=0);
+}
+
+static OpcUa_Void report_monitoreditem(OpcUa_Int a_Item)
+{
+	_MonitoredItem_* pItem=&monitoreditems[a_Item];
+
+	if(pItem->MonitoringMode==OpcUa_MonitoringMode_Reporting && pItem->Pending==OpcUa_False)
+	{
+		pItem->Pending=OpcUa_True;
+		subscriptions[pItem->Subscription].NoOfPending++;
+	}
+}
+
+/*============================================================================
+ * one sampling pass over all items of a bucket.
+ *===========================================================================*/
+static OpcUa_Void sample_bucket(_SamplingBucket_* a_pBucket)
+{
+	my_Variant			Value;
+	_ValueVersion_		Version;
+	OpcUa_Boolean		bChanged;
+	OpcUa_Int			i;
+
+	for(i=0;i<a_pBucket->NoOfItems;i++)
+	{
+		/* nothing was written since the last pass */
+		if(value_version(a_pBucket->ValueIndex[i])==a_pBucket->LastVersion[i])
+			continue;
+		if(OpcUa_IsBad(read_value(a_pBucket->ValueIndex[i],&Value,&Version)))
+			continue;
+
+		a_pBucket->LastVersion[i]=Version.Sequence;
+		bChanged=value_changed(&a_pBucket->LastValue[i],&Value,a_pBucket->Deadband[i]);
+		clear_value(&Value);
+		if(bChanged)
+		{
+			a_pBucket->LastValue[i]=Value;
+			report_monitoreditem(a_pBucket->Item[i]);
+		}
+	}
+}
+
+/*============================================================================
+ * sampling intervals are multiples of the tick; if every bucket is taken by
+ * another interval, the item joins the bucket with the closest interval.
+ *===========================================================================*/
+static OpcUa_Int find_sampling_bucket(OpcUa_UInt32 a_uSamplingInterval)
+{
+	OpcUa_Int		i;
+	OpcUa_Int		iFree		= -1;
+	OpcUa_Int		iClosest	= -1;
+	OpcUa_UInt32	uDiff;
+	OpcUa_UInt32	uClosest	= OpcUa_UInt32_Max;
+
+	for(i=0;i<MAX_SAMPLINGBUCKETS;i++)
+	{
+		if(sampling_buckets[i].SamplingInterval==a_uSamplingInterval)
+			return i;
+		if(sampling_buckets[i].SamplingInterval==0)
+		{
+			if(iFree<0)
+				iFree=i;
+			continue;
+		}
+		uDiff=(sampling_buckets[i].SamplingInterval>a_uSamplingInterval)?(sampling_buckets[i].SamplingInterval-a_uSamplingInterval):(a_uSamplingInterval-sampling_buckets[i].SamplingInterval);
+		if(uDiff<uClosest)
+		{
+			uClosest=uDiff;
+			iClosest=i;
+		}
+	}
+	if(iFree>=0)
+	{
+		sampling_buckets[iFree].SamplingInterval=a_uSamplingInterval;
+		sampling_buckets[iFree].Elapsed=0;
+		sampling_buckets[iFree].NoOfItems=0;
+		return iFree;
+	}
+	return iClosest;
+}
+
+static OpcUa_Void bucket_add(OpcUa_Int a_Bucket, OpcUa_Int a_Item, OpcUa_Double a_dDeadband)
+{
+	_ValueVersion_		Version;
+	_SamplingBucket_*	pBucket	= &sampling_buckets[a_Bucket];
+	_MonitoredItem_*	pItem	= &monitoreditems[a_Item];
+	OpcUa_Int			n		= pBucket->NoOfItems++;
+
+	pBucket->Item[n]=a_Item;
+	pBucket->ValueIndex[n]=pItem->pNode->ValueIndex;
+	pBucket->Deadband[n]=a_dDeadband;
+	/* an odd version is never stable, so a failed read is sampled again */
+	pBucket->LastVersion[n]=1;
+	if(OpcUa_IsGood(read_value(pItem->pNode->ValueIndex,&pBucket->LastValue[n],&Version)))
+		pBucket->LastVersion[n]=Version.Sequence;
+	clear_value(&pBucket->LastValue[n]);
+	pItem->Bucket=a_Bucket;
+	pItem->Slot=n;
+}
+
+static OpcUa_Void bucket_remove(OpcUa_Int a_Item)
+{
+	_MonitoredItem_*	pItem	= &monitoreditems[a_Item];
+	_SamplingBucket_*	pBucket	= &sampling_buckets[pItem->Bucket];
+	OpcUa_Int			n		= --pBucket->NoOfItems;
+
+	/* the last item takes the free slot */
+	if(pItem->Slot!=n)
+	{
+		pBucket->Item[pItem->Slot]=pBucket->Item[n];
+		pBucket->ValueIndex[pItem->Slot]=pBucket->ValueIndex[n];
+		pBucket->Deadband[pItem->Slot]=pBucket->Deadband[n];
+		pBucket->LastValue[pItem->Slot]=pBucket->LastValue[n];
+		pBucket->LastVersion[pItem->Slot]=pBucket->LastVersion[n];
+		monitoreditems[pBucket->Item[n]].Slot=pItem->Slot;
+	}
+	if(n==0)
+		pBucket->SamplingInterval=0;
+	pItem->Bucket=-1;
+}
+
+static OpcUa_Void remove_monitoreditem(OpcUa_Int a_Item)
+{
+	_MonitoredItem_* pItem=&monitoreditems[a_Item];
+
+	if(pItem->Bucket>=0)
+		bucket_remove(a_Item);
+	if(pItem->Pending!=OpcUa_False)
+		subscriptions[pItem->Subscription].NoOfPending--;
+	OpcUa_MemSet(pItem,0,sizeof(_MonitoredItem_));
+}
+
+static OpcUa_Void remove_subscription(OpcUa_Int a_Subscription)
+{
+	OpcUa_Int i;
+
+	for(i=0;i<MAX_MONITOREDITEMS;i++)
+	{
+		if(monitoreditems[i].MonitoredItemId!=0 && monitoreditems[i].Subscription==a_Subscription)
+			remove_monitoreditem(i);
+	}
+	OpcUa_MemSet(&subscriptions[a_Subscription],0,sizeof(_Subscription_));
+}
+
+/*============================================================================
+ * the oldest parked Publish request of a session, -1 if there is none.
+ *===========================================================================*/
+static OpcUa_Int find_publish_request(OpcUa_UInt32 a_uSessionId)
+{
+	OpcUa_Int i;
+
+	for(i=0;i<no_of_publish_requests;i++)
+	{
+		if(publish_requests[i].SessionId==a_uSessionId)
+			return i;
+	}
+	return -1;
+}
+
+/*============================================================================
+ * takes a parked Publish request; the younger ones move up.
+ *===========================================================================*/
+static _PublishRequest_ take_publish_request(OpcUa_Int a_Request)
+{
+	_PublishRequest_	Request=publish_requests[a_Request];
+	OpcUa_Int			i;
+
+	no_of_publish_requests--;
+	for(i=a_Request;i<no_of_publish_requests;i++)
+		publish_requests[i]=publish_requests[i+1];
+	OpcUa_MemSet(&publish_requests[no_of_publish_requests],0,sizeof(_PublishRequest_));
+	return Request;
+}
+
+/*============================================================================
+ * answers a Publish request with a ServiceFault.
+ *===========================================================================*/
+static OpcUa_Void send_publish_fault(_PublishRequest_* a_pRequest, OpcUa_StatusCode a_uStatus)
+{
+	OpcUa_RequestHeader		RequestHeader;
+	OpcUa_Void*				pFault		= OpcUa_Null;
+	OpcUa_EncodeableType*	pFaultType	= OpcUa_Null;
+	OpcUa_StatusCode		uStatus;
+
+	OpcUa_RequestHeader_Initialize(&RequestHeader);
+	RequestHeader.RequestHandle=a_pRequest->pResponse->ResponseHeader.RequestHandle;
+
+	uStatus=OpcUa_ServerApi_CreateFault(&RequestHeader,
+										a_uStatus,
+										&a_pRequest->pResponse->ResponseHeader.ServiceDiagnostics,
+										&a_pRequest->pResponse->ResponseHeader.NoOfStringTable,
+										&a_pRequest->pResponse->ResponseHeader.StringTable,
+										&pFault,
+										&pFaultType);
+	if(OpcUa_IsGood(uStatus))
+	{
+		OpcUa_Endpoint_EndSendResponse(a_pRequest->hEndpoint,&a_pRequest->hContext,OpcUa_Good,pFault,pFaultType);
+		OpcUa_EncodeableObject_Delete(pFaultType,&pFault);
+	}
+	else
+	{
+		OpcUa_Endpoint_EndSendResponse(a_pRequest->hEndpoint,&a_pRequest->hContext,uStatus,OpcUa_Null,OpcUa_Null);
+	}
+	OpcUa_EncodeableObject_Delete(a_pRequest->pResponseType,(OpcUa_Void**)&a_pRequest->pResponse);
+}
+
+/*============================================================================
+ * takes a parked Publish request for an answer that is sent once
+ * subscription_mutex was released.
+ *===========================================================================*/
+static _PublishAnswer_* add_publish_answer(_PublishAnswers_* a_pAnswers, OpcUa_Int a_Request)
+{
+	_PublishAnswer_* pAnswer=&a_pAnswers->Answer[a_pAnswers->NoOfAnswers++];
+
+	OpcUa_MemSet(pAnswer,0,sizeof(_PublishAnswer_));
+	pAnswer->Request=take_publish_request(a_Request);
+	return pAnswer;
+}
+
+/*============================================================================
+ * answers all parked Publish requests of a session with a ServiceFault.
+ *===========================================================================*/
+static OpcUa_Void fail_publish_requests(OpcUa_UInt32 a_uSessionId, OpcUa_StatusCode a_uStatus, _PublishAnswers_* a_pAnswers)
+{
+	OpcUa_Int r;
+
+	while((r=find_publish_request(a_uSessionId))>=0)
+		add_publish_answer(a_pAnswers,r)->Fault=a_uStatus;
+}
+
+/*============================================================================
+ * binary encoding of the values a subscription supports.
+ *===========================================================================*/
+static OpcUa_Int32 string_size(OpcUa_StringA a_sValue)
+{
+	return (OpcUa_Int32)sizeof(OpcUa_Int32)+((a_sValue!=OpcUa_Null)?(OpcUa_Int32)OpcUa_StrLenA(a_sValue):0);
+}
+
+static OpcUa_Int32 variant_size(const my_Variant* a_pValue)
+{
+	OpcUa_Int32 iSize=1;
+	OpcUa_Int32 i;
+
+	if(a_pValue->ArrayType==OpcUa_VariantArrayType_Array)
+	{
+		iSize+=sizeof(OpcUa_Int32);
+		switch(a_pValue->Datatype)
+		{
+		case OpcUaId_Double:	return iSize+a_pValue->Value.Array.Length*8;
+		case OpcUaId_UInt32:	return iSize+a_pValue->Value.Array.Length*4;
+		case OpcUaId_Boolean:	return iSize+a_pValue->Value.Array.Length;
+		case OpcUaId_String:
+			{
+				for(i=0;i<a_pValue->Value.Array.Length;i++)
+					iSize+=string_size(a_pValue->Value.Array.Value.StringArray[i]);
+				return iSize;
+			}
+		}
+		return 1;
+	}
+	switch(a_pValue->Datatype)
+	{
+	case OpcUaId_Double:
+	case OpcUaId_DateTime:	return iSize+8;
+	case OpcUaId_UInt32:	return iSize+4;
+	case OpcUaId_Boolean:	return iSize+1;
+	case OpcUaId_String:	return iSize+string_size(a_pValue->Value.String);
+	}
+	return 1;
+}
+
+static OpcUa_Byte datavalue_mask(OpcUa_TimestampsToReturn a_eTimestampsToReturn)
+{
+	switch(a_eTimestampsToReturn)
+	{
+	case OpcUa_TimestampsToReturn_Source:	return DATAVALUE_VALUE|DATAVALUE_SOURCETIMESTAMP;
+	case OpcUa_TimestampsToReturn_Server:	return DATAVALUE_VALUE|DATAVALUE_SERVERTIMESTAMP;
+	case OpcUa_TimestampsToReturn_Both:		return DATAVALUE_VALUE|DATAVALUE_SOURCETIMESTAMP|DATAVALUE_SERVERTIMESTAMP;
+	default:								return DATAVALUE_VALUE;
+	}
+}
+
+static OpcUa_StatusCode write_string(struct _OpcUa_Encoder* a_pEncoder, OpcUa_StringA a_sValue)
+{
+	OpcUa_String	String;
+	OpcUa_Int32		iNull	= -1;
+
+	if(a_sValue==OpcUa_Null)
+		return a_pEncoder->WriteInt32(a_pEncoder,OpcUa_Null,&iNull,OpcUa_Null);
+	OpcUa_String_AttachReadOnly(&String,a_sValue);
+	return a_pEncoder->WriteString(a_pEncoder,OpcUa_Null,&String,OpcUa_Null);
+}
+
+/*============================================================================
+ * writes a my_Variant in the layout of an OpcUa_Variant, without copying it.
+ *===========================================================================*/
+static OpcUa_StatusCode write_variant(struct _OpcUa_Encoder* a_pEncoder, my_Variant* a_pValue)
+{
+	OpcUa_Byte		uEncodingByte	= 0;
+	OpcUa_Int32		i;
+
+	OpcUa_InitializeStatus(OpcUa_Module_Server, "write_variant");
+
+	if(variant_size(a_pValue)>1)
+		uEncodingByte=a_pValue->Datatype;
+	if(uEncodingByte!=0 && a_pValue->ArrayType==OpcUa_VariantArrayType_Array)
+		uEncodingByte|=VARIANT_ARRAY;
+
+	uStatus=a_pEncoder->WriteByte(a_pEncoder,OpcUa_Null,&uEncodingByte,OpcUa_Null);
+	OpcUa_GotoErrorIfBad(uStatus);
+
+	switch(uEncodingByte)
+	{
+	case OpcUaId_Double:	uStatus=a_pEncoder->WriteDouble(a_pEncoder,OpcUa_Null,&a_pValue->Value.Double,OpcUa_Null); break;
+	case OpcUaId_DateTime:	uStatus=a_pEncoder->WriteDateTime(a_pEncoder,OpcUa_Null,&a_pValue->Value.DateTime,OpcUa_Null); break;
+	case OpcUaId_UInt32:	uStatus=a_pEncoder->WriteUInt32(a_pEncoder,OpcUa_Null,&a_pValue->Value.UInt32,OpcUa_Null); break;
+	case OpcUaId_Boolean:	uStatus=a_pEncoder->WriteBoolean(a_pEncoder,OpcUa_Null,&a_pValue->Value.Boolean,OpcUa_Null); break;
+	case OpcUaId_String:	uStatus=write_string(a_pEncoder,a_pValue->Value.String); break;
+	case OpcUaId_Double|VARIANT_ARRAY:
+		uStatus=a_pEncoder->WriteDoubleArray(a_pEncoder,OpcUa_Null,a_pValue->Value.Array.Value.DoubleArray,a_pValue->Value.Array.Length,OpcUa_Null);
+		break;
+	case OpcUaId_UInt32|VARIANT_ARRAY:
+		uStatus=a_pEncoder->WriteUInt32Array(a_pEncoder,OpcUa_Null,a_pValue->Value.Array.Value.UInt32Array,a_pValue->Value.Array.Length,OpcUa_Null);
+		break;
+	case OpcUaId_Boolean|VARIANT_ARRAY:
+		uStatus=a_pEncoder->WriteBooleanArray(a_pEncoder,OpcUa_Null,a_pValue->Value.Array.Value.BooleanArray,a_pValue->Value.Array.Length,OpcUa_Null);
+		break;
+	case OpcUaId_String|VARIANT_ARRAY:
+		{
+			uStatus=a_pEncoder->WriteInt32(a_pEncoder,OpcUa_Null,&a_pValue->Value.Array.Length,OpcUa_Null);
+			for(i=0;i<a_pValue->Value.Array.Length && OpcUa_IsGood(uStatus);i++)
+				uStatus=write_string(a_pEncoder,a_pValue->Value.Array.Value.StringArray[i]);
+			break;
+		}
+	}
+	OpcUa_GotoErrorIfBad(uStatus);
+
+	OpcUa_ReturnStatusCode;
+	OpcUa_BeginErrorHandling;
+	OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * encodes a batch with the fields of a DataChangeNotification.
+ *===========================================================================*/
+static OpcUa_StatusCode encode_data_change_batch(OpcUa_Void* a_pValue, struct _OpcUa_Encoder* a_pEncoder)
+{
+	_DataChangeBatch_*	pBatch	= (_DataChangeBatch_*)a_pValue;
+	OpcUa_Int32			iNull	= -1;
+	OpcUa_Byte			uMask;
+	OpcUa_Int32			i;
+
+	OpcUa_InitializeStatus(OpcUa_Module_Server, "encode_data_change_batch");
+
+	uStatus=a_pEncoder->WriteInt32(a_pEncoder,OpcUa_Null,&pBatch->NoOfItems,OpcUa_Null);
+	OpcUa_GotoErrorIfBad(uStatus);
+
+	for(i=0;i<pBatch->NoOfItems;i++)
+	{
+		uStatus=a_pEncoder->WriteUInt32(a_pEncoder,OpcUa_Null,&pBatch->ClientHandle[i],OpcUa_Null);
+		OpcUa_GotoErrorIfBad(uStatus);
+
+		uMask=datavalue_mask(pBatch->TimestampsToReturn[i]);
+		uStatus=a_pEncoder->WriteByte(a_pEncoder,OpcUa_Null,&uMask,OpcUa_Null);
+		OpcUa_GotoErrorIfBad(uStatus);
+		uStatus=write_variant(a_pEncoder,&pBatch->Value[i]);
+		OpcUa_GotoErrorIfBad(uStatus);
+		if(uMask&DATAVALUE_SOURCETIMESTAMP)
+		{
+			uStatus=a_pEncoder->WriteDateTime(a_pEncoder,OpcUa_Null,&pBatch->SourceTimestamp[i],OpcUa_Null);
+			OpcUa_GotoErrorIfBad(uStatus);
+		}
+		if(uMask&DATAVALUE_SERVERTIMESTAMP)
+		{
+			uStatus=a_pEncoder->WriteDateTime(a_pEncoder,OpcUa_Null,&pBatch->ServerTimestamp[i],OpcUa_Null);
+			OpcUa_GotoErrorIfBad(uStatus);
+		}
+	}
+
+	/* no DiagnosticInfos */
+	uStatus=a_pEncoder->WriteInt32(a_pEncoder,OpcUa_Null,&iNull,OpcUa_Null);
+	OpcUa_GotoErrorIfBad(uStatus);
+
+	OpcUa_ReturnStatusCode;
+	OpcUa_BeginErrorHandling;
+	OpcUa_FinishErrorHandling;
+}
+
+static OpcUa_StatusCode data_change_batch_size(OpcUa_Void* a_pValue, struct _OpcUa_Encoder* a_pEncoder, OpcUa_Int32* a_pSize)
+{
+	OpcUa_ReferenceParameter(a_pEncoder);
+	*a_pSize=((_DataChangeBatch_*)a_pValue)->BodySize;
+	return OpcUa_Good;
+}
+
+/* sent as a DataChangeNotification, never decoded or allocated by the stack */
+static struct _OpcUa_EncodeableType data_change_batch_type =
+{
+	"DataChangeNotification",
+	OpcUaId_DataChangeNotification,
+	OpcUaId_DataChangeNotification_Encoding_DefaultBinary,
+	OpcUaId_DataChangeNotification_Encoding_DefaultXml,
+	OpcUa_Null,
+	sizeof(_DataChangeBatch_),
+	OpcUa_Null,
+	OpcUa_Null,
+	data_change_batch_size,
+	encode_data_change_batch,
+	OpcUa_Null
+};
+
+/*============================================================================
+ * moves the pending values of a subscription into a data change batch.
+ * The body size is added up here, so the encoder needs no sizing pass.
+ *===========================================================================*/
+static OpcUa_Void collect_data_changes(_Subscription_* a_pSubscription, OpcUa_Int a_Subscription, OpcUa_DateTime a_Timestamp, _DataChangeBatch_* a_pBatch)
+{
+	_DataChangeBatch_*	pBatch	= a_pBatch;
+	_MonitoredItem_*	pItem;
+	_ValueVersion_		Version;
+	OpcUa_Int			i,n,k=0;
+	OpcUa_Byte			uMask;
+
+	n=a_pSubscription->NoOfPending;
+	if(a_pSubscription->MaxNotificationsPerPublish!=0 && (OpcUa_UInt32)n>a_pSubscription->MaxNotificationsPerPublish)
+		n=(OpcUa_Int)a_pSubscription->MaxNotificationsPerPublish;
+
+	pBatch->BodySize=0;
+
+	for(i=0;i<MAX_MONITOREDITEMS && k<n;i++)
+	{
+		pItem=&monitoreditems[i];
+		if(pItem->MonitoredItemId==0 || pItem->Subscription!=a_Subscription || pItem->Pending==OpcUa_False)
+			continue;
+
+		/* an item queues only its latest value */
+		if(OpcUa_IsBad(read_value(pItem->pNode->ValueIndex,&pBatch->Value[k],&Version)))
+			Version.SourceTimestamp=Version.ServerTimestamp=a_Timestamp;
+		pBatch->SourceTimestamp[k]=Version.SourceTimestamp;
+		pBatch->ServerTimestamp[k]=Version.ServerTimestamp;
+		pBatch->ClientHandle[k]=pItem->ClientHandle;
+		pBatch->TimestampsToReturn[k]=pItem->TimestampsToReturn;
+
+		uMask=datavalue_mask(pItem->TimestampsToReturn);
+		pBatch->BodySize+=variant_size(&pBatch->Value[k]);
+		if(uMask&DATAVALUE_SOURCETIMESTAMP)
+			pBatch->BodySize+=sizeof(OpcUa_DateTime);
+		if(uMask&DATAVALUE_SERVERTIMESTAMP)
+			pBatch->BodySize+=sizeof(OpcUa_DateTime);
+		k++;
+
+		pItem->Pending=OpcUa_False;
+		a_pSubscription->NoOfPending--;
+	}
+	pBatch->NoOfItems=k;
+
+	/* item count, client handles, encoding masks and the empty DiagnosticInfos of the items collected */
+	pBatch->BodySize+=2*sizeof(OpcUa_Int32)+k*(sizeof(OpcUa_UInt32)+1);
+}
+
+/*============================================================================
+ * answers a parked Publish request of the session with a message of a
+ * subscription. The message gets a batch of its own, so it can be encoded
+ * after subscription_mutex was released.
+ *===========================================================================*/
+static OpcUa_Void prepare_notification_message(OpcUa_Int a_Subscription, OpcUa_Int a_Request, OpcUa_Boolean a_bKeepAlive, _PublishAnswers_* a_pAnswers)
+{
+	_Subscription_*			pSubscription	= &subscriptions[a_Subscription];
+	_DataChangeBatch_*		pBatch			= OpcUa_Null;
+	_PublishAnswer_*		pAnswer;
+	OpcUa_PublishResponse*	pResponse;
+
+	if(a_bKeepAlive==OpcUa_False)
+	{
+		pBatch=(_DataChangeBatch_*)OpcUa_Alloc(sizeof(_DataChangeBatch_));
+		if(pBatch==OpcUa_Null)
+		{
+			/* the values stay pending for the next Publish request */
+			add_publish_answer(a_pAnswers,a_Request)->Fault=OpcUa_BadOutOfMemory;
+			return;
+		}
+	}
+
+	pAnswer=add_publish_answer(a_pAnswers,a_Request);
+	pAnswer->pBatch=pBatch;
+	pResponse=pAnswer->Request.pResponse;
+
+	pResponse->SubscriptionId=pSubscription->SubscriptionId;
+	pResponse->NotificationMessage.PublishTime=OpcUa_DateTime_UtcNow();
+	pResponse->ResponseHeader.Timestamp=pResponse->NotificationMessage.PublishTime;
+
+	if(a_bKeepAlive)
+	{
+		/* a keep-alive carries the next sequence number without using it */
+		pResponse->NotificationMessage.SequenceNumber=(pSubscription->SequenceNumber==OpcUa_UInt32_Max)?1:pSubscription->SequenceNumber+1;
+	}
+	else
+	{
+		collect_data_changes(pSubscription,a_Subscription,pResponse->NotificationMessage.PublishTime,pBatch);
+		OpcUa_ExtensionObject_Initialize(&pAnswer->NotificationData);
+		pAnswer->NotificationData.Encoding=OpcUa_ExtensionObjectEncoding_EncodeableObject;
+		pAnswer->NotificationData.Body.EncodeableObject.Type=&data_change_batch_type;
+		pAnswer->NotificationData.Body.EncodeableObject.Object=pBatch;
+		pAnswer->NotificationData.BodySize=pBatch->BodySize;
+		pResponse->NotificationMessage.NotificationData=&pAnswer->NotificationData;
+		pResponse->NotificationMessage.NoOfNotificationData=1;
+		pResponse->MoreNotifications=(OpcUa_Boolean)(pSubscription->NoOfPending>0);
+		pSubscription->SequenceNumber=(pSubscription->SequenceNumber==OpcUa_UInt32_Max)?1:pSubscription->SequenceNumber+1;
+		pResponse->NotificationMessage.SequenceNumber=pSubscription->SequenceNumber;
+	}
+
+	pSubscription->KeepAliveCounter=0;
+	pSubscription->LifetimeCounter=0;
+	pSubscription->Late=pResponse->MoreNotifications;
+
+#ifndef NO_DEBUGING_
+	MY_TRACE("\nPublish: Subscription %u, SequenceNumber %u%s\n",pSubscription->SubscriptionId,pResponse->NotificationMessage.SequenceNumber,a_bKeepAlive?" (KeepAlive)":""); 
+#endif /*_DEBUGING_*/
+}
+
+/*============================================================================
+ * sends the prepared Publish answers; subscription_mutex must not be held.
+ *===========================================================================*/
+static OpcUa_Void send_publish_answers(_PublishAnswers_* a_pAnswers)
+{
+	_PublishAnswer_*	pAnswer;
+	OpcUa_Int			i,k;
+
+	for(i=0;i<a_pAnswers->NoOfAnswers;i++)
+	{
+		pAnswer=&a_pAnswers->Answer[i];
+		if(OpcUa_IsBad(pAnswer->Fault))
+		{
+			send_publish_fault(&pAnswer->Request,pAnswer->Fault);
+			continue;
+		}
+
+		OpcUa_Endpoint_EndSendResponse(pAnswer->Request.hEndpoint,&pAnswer->Request.hContext,OpcUa_Good,pAnswer->Request.pResponse,pAnswer->Request.pResponseType);
+
+		/* the notification data lives in the answer and its batch */
+		if(pAnswer->pBatch!=OpcUa_Null)
+		{
+			for(k=0;k<pAnswer->pBatch->NoOfItems;k++)
+				clear_value(&pAnswer->pBatch->Value[k]);
+			OpcUa_Free(pAnswer->pBatch);
+		}
+		pAnswer->Request.pResponse->NotificationMessage.NotificationData=OpcUa_Null;
+		pAnswer->Request.pResponse->NotificationMessage.NoOfNotificationData=0;
+		OpcUa_EncodeableObject_Delete(pAnswer->Request.pResponseType,(OpcUa_Void**)&pAnswer->Request.pResponse);
+	}
+	a_pAnswers->NoOfAnswers=0;
+}
+
+/*============================================================================
+ * publishing cycle of a subscription.
+ *===========================================================================*/
+static OpcUa_Void publishing_cycle(OpcUa_Int a_Subscription, _PublishAnswers_* a_pAnswers)
+{
+	_Subscription_*	pSubscription	= &subscriptions[a_Subscription];
+	OpcUa_Int		Request			= find_publish_request(pSubscription->SessionId);
+
+	if(pSubscription->PublishingEnabled && pSubscription->NoOfPending>0)
+	{
+		if(Request>=0)
+		{
+			prepare_notification_message(a_Subscription,Request,OpcUa_False,a_pAnswers);
+			return;
+		}
+		pSubscription->Late=OpcUa_True;
+	}
+	else if(++pSubscription->KeepAliveCounter>=pSubscription->MaxKeepAliveCount)
+	{
+		if(Request>=0)
+		{
+			prepare_notification_message(a_Subscription,Request,OpcUa_True,a_pAnswers);
+			return;
+		}
+		pSubscription->Late=OpcUa_True;
+	}
+
+	if(Request<0 && ++pSubscription->LifetimeCounter>=pSubscription->LifetimeCount)
+	{
+#ifndef NO_DEBUGING_
+		MY_TRACE("\nSubscription %u abgelaufen!!!\n",pSubscription->SubscriptionId); 
+#endif /*_DEBUGING_*/
+		remove_subscription(a_Subscription);
+	}
+}
+
+/*============================================================================
+ * answers parked Publish requests of a session for its subscriptions that
+ * are late.
+ *===========================================================================*/
+static OpcUa_Void serve_late_subscriptions(OpcUa_UInt32 a_uSessionId, _PublishAnswers_* a_pAnswers)
+{
+	OpcUa_Int i,Request;
+
+	for(i=0;i<MAX_SUBSCRIPTIONS;i++)
+	{
+		if(subscriptions[i].SubscriptionId==0 || subscriptions[i].SessionId!=a_uSessionId || !subscriptions[i].Late)
+			continue;
+		Request=find_publish_request(a_uSessionId);
+		if(Request<0)
+			break;
+		prepare_notification_message(i,Request,(OpcUa_Boolean)!(subscriptions[i].PublishingEnabled && subscriptions[i].NoOfPending>0),a_pAnswers);
+	}
+}
+
+static OpcUa_StatusCode OPCUA_DLLCALL subscription_timer_callback(	OpcUa_Void*		a_pvCallbackData,
+																	OpcUa_Timer		a_hTimer,
+																	OpcUa_UInt32	a_msecElapsed)
+{
+	_PublishAnswers_	Answers;
+	OpcUa_Int			i;
+
+	OpcUa_ReferenceParameter(a_pvCallbackData);
+	OpcUa_ReferenceParameter(a_hTimer);
+
+	Answers.NoOfAnswers=0;
+
+	OpcUa_Mutex_Lock(subscription_mutex);
+
+	for(i=0;i<MAX_SAMPLINGBUCKETS;i++)
+	{
+		if(sampling_buckets[i].SamplingInterval==0)
+			continue;
+		sampling_buckets[i].Elapsed+=a_msecElapsed;
+		if(sampling_buckets[i].Elapsed>=sampling_buckets[i].SamplingInterval)
+		{
+			sampling_buckets[i].Elapsed%=sampling_buckets[i].SamplingInterval;
+			sample_bucket(&sampling_buckets[i]);
+		}
+	}
+
+	for(i=0;i<MAX_SUBSCRIPTIONS;i++)
+	{
+		if(subscriptions[i].SubscriptionId==0)
+			continue;
+		subscriptions[i].Elapsed+=a_msecElapsed;
+		if(subscriptions[i].Elapsed>=subscriptions[i].PublishingInterval)
+		{
+			subscriptions[i].Elapsed%=subscriptions[i].PublishingInterval;
+			publishing_cycle(i,&Answers);
+		}
+	}
+
+	OpcUa_Mutex_Unlock(subscription_mutex);
+
+	send_publish_answers(&Answers);
+	return OpcUa_Good;
+}
+
+static OpcUa_UInt32 revise_interval(OpcUa_Double a_dInterval)
+{
+	if(!(a_dInterval>SUBSCRIPTION_TICK))
+		return SUBSCRIPTION_TICK;
+	if(a_dInterval>MAX_PUBLISHINGINTERVAL)
+		return MAX_PUBLISHINGINTERVAL;
+	return (((OpcUa_UInt32)a_dInterval+SUBSCRIPTION_TICK-1)/SUBSCRIPTION_TICK)*SUBSCRIPTION_TICK;
+}
+
+
+/*============================================================================
+ * method which implements the CreateSubscription service.
+ *===========================================================================*/
+OpcUa_StatusCode my_CreateSubscription(
+							OpcUa_Endpoint             a_hEndpoint,
+							OpcUa_Handle               a_hContext,
+							const OpcUa_RequestHeader* a_pRequestHeader,
+							OpcUa_Double               a_nRequestedPublishingInterval,
+							OpcUa_UInt32               a_nRequestedLifetimeCount,
+							OpcUa_UInt32               a_nRequestedMaxKeepAliveCount,
+							OpcUa_UInt32               a_nMaxNotificationsPerPublish,
+							OpcUa_Boolean              a_bPublishingEnabled,
+							OpcUa_Byte                 a_nPriority,
+							OpcUa_ResponseHeader*      a_pResponseHeader,
+							OpcUa_UInt32*              a_pSubscriptionId,
+							OpcUa_Double*              a_pRevisedPublishingInterval,
+							OpcUa_UInt32*              a_pRevisedLifetimeCount,
+							OpcUa_UInt32*              a_pRevisedMaxKeepAliveCount)
+{
+	OpcUa_Int			i;
+	_Subscription_*		pSubscription;
+	OpcUa_UInt32		uSessionId;
+
+	OpcUa_InitializeStatus(OpcUa_Module_Server, "OpcUa_ServerApi_CreateSubscription");
+
+	/* validate arguments. */
+	OpcUa_ReturnErrorIfArgumentNull(a_hEndpoint);
+	OpcUa_ReturnErrorIfArgumentNull(a_hContext);
+	OpcUa_ReturnErrorIfArgumentNull(a_pRequestHeader);
+	OpcUa_ReferenceParameter(a_nPriority);
+	OpcUa_ReturnErrorIfArgumentNull(a_pResponseHeader);
+	OpcUa_ReturnErrorIfArgumentNull(a_pSubscriptionId);
+	OpcUa_ReturnErrorIfArgumentNull(a_pRevisedPublishingInterval);
+	OpcUa_ReturnErrorIfArgumentNull(a_pRevisedLifetimeCount);
+	OpcUa_ReturnErrorIfArgumentNull(a_pRevisedMaxKeepAliveCount);
+
+#ifndef NO_DEBUGING_
+	MY_TRACE("\n\n\nCREATESUBSCRIPTION SERVICE================================\n"); 
+#endif /*_DEBUGING_*/
+
+	uStatus=check_session(a_pRequestHeader,&uSessionId);
+	OpcUa_GotoErrorIfBad(uStatus)
+
+	OpcUa_Mutex_Lock(subscription_mutex);
+	for(i=0;i<MAX_SUBSCRIPTIONS;i++)
+	{
+		if(subscriptions[i].SubscriptionId==0)
+			break;
+	}
+	if(i==MAX_SUBSCRIPTIONS)
+	{
+		OpcUa_Mutex_Unlock(subscription_mutex);
+		OpcUa_GotoErrorWithStatus(OpcUa_BadTooManySubscriptions)
+	}
+
+	pSubscription=&subscriptions[i];
+	OpcUa_MemSet(pSubscription,0,sizeof(_Subscription_));
+	if(++last_subscription_id==0)
+		last_subscription_id=1;
+	pSubscription->SubscriptionId=last_subscription_id;
+	pSubscription->SessionId=uSessionId;
+	pSubscription->PublishingInterval=revise_interval(a_nRequestedPublishingInterval);
+	pSubscription->MaxKeepAliveCount=(a_nRequestedMaxKeepAliveCount!=0)?a_nRequestedMaxKeepAliveCount:DEFAULT_MAXKEEPALIVECOUNT;
+	if(pSubscription->MaxKeepAliveCount>OpcUa_UInt32_Max/3)
+		pSubscription->MaxKeepAliveCount=OpcUa_UInt32_Max/3;
+	pSubscription->LifetimeCount=a_nRequestedLifetimeCount;
+	if(pSubscription->LifetimeCount<3*pSubscription->MaxKeepAliveCount)
+		pSubscription->LifetimeCount=3*pSubscription->MaxKeepAliveCount;
+	pSubscription->MaxNotificationsPerPublish=a_nMaxNotificationsPerPublish;
+	pSubscription->PublishingEnabled=a_bPublishingEnabled;
+	/* the first keep-alive goes out after the first publishing interval */
+	pSubscription->KeepAliveCounter=pSubscription->MaxKeepAliveCount-1;
+
+	*a_pSubscriptionId=pSubscription->SubscriptionId;
+	*a_pRevisedPublishingInterval=pSubscription->PublishingInterval;
+	*a_pRevisedLifetimeCount=pSubscription->LifetimeCount;
+	*a_pRevisedMaxKeepAliveCount=pSubscription->MaxKeepAliveCount;
+	OpcUa_Mutex_Unlock(subscription_mutex);
+
+#ifndef NO_DEBUGING_
+	MY_TRACE("\nSubscription %u: %u msec, KeepAlive %u, Lifetime %u\n",*a_pSubscriptionId,pSubscription->PublishingInterval,*a_pRevisedMaxKeepAliveCount,*a_pRevisedLifetimeCount); 
+#endif /*_DEBUGING_*/
+
+	uStatus = response_header_ausfuellen(a_pResponseHeader,a_pRequestHeader,uStatus);
+	if(OpcUa_IsBad(uStatus))
+	{
+		a_pResponseHeader->ServiceResult=OpcUa_BadInternalError;
+	}
+#ifndef NO_DEBUGING_
+	MY_TRACE("\nSERVICE===ENDE============================================\n\n\n"); 
+#endif /*_DEBUGING_*/
+
+	OpcUa_ReturnStatusCode;
+	OpcUa_BeginErrorHandling;
+
+	uStatus = response_header_ausfuellen(a_pResponseHeader,a_pRequestHeader,uStatus);
+	if(OpcUa_IsBad(uStatus))
+	{
+		a_pResponseHeader->ServiceResult=OpcUa_BadInternalError;
+	}
+#ifndef NO_DEBUGING_
+	MY_TRACE("\nSERVICEENDE (IM SERVICE SIND FEHLER AUFGETRETTEN)===========\n\n\n"); 
+#endif /*_DEBUGING_*/
+	OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * method which implements the DeleteSubscriptions service.
+ *===========================================================================*/
+OpcUa_StatusCode my_DeleteSubscriptions(
+							OpcUa_Endpoint             a_hEndpoint,
+							OpcUa_Handle               a_hContext,
+							const OpcUa_RequestHeader* a_pRequestHeader,
+							OpcUa_Int32                a_nNoOfSubscriptionIds,
+							const OpcUa_UInt32*        a_pSubscriptionIds,
+							OpcUa_ResponseHeader*      a_pResponseHeader,
+							OpcUa_Int32*               a_pNoOfResults,
+							OpcUa_StatusCode**         a_pResults,
+							OpcUa_Int32*               a_pNoOfDiagnosticInfos,
+							OpcUa_DiagnosticInfo**     a_pDiagnosticInfos)
+{
+	_PublishAnswers_	Answers;
+	OpcUa_Int			i,n;
+	OpcUa_UInt32		uSessionId;
+
+	OpcUa_InitializeStatus(OpcUa_Module_Server, "OpcUa_ServerApi_DeleteSubscriptions");
+
+	/* validate arguments. */
+	OpcUa_ReturnErrorIfArgumentNull(a_hEndpoint);
+	OpcUa_ReturnErrorIfArgumentNull(a_hContext);
+	OpcUa_ReturnErrorIfArgumentNull(a_pRequestHeader);
+	OpcUa_ReturnErrorIfArrayArgumentNull(a_nNoOfSubscriptionIds, a_pSubscriptionIds);
+	OpcUa_ReturnErrorIfArgumentNull(a_pResponseHeader);
+	OpcUa_ReturnErrorIfArrayArgumentNull(a_pNoOfResults, a_pResults);
+	OpcUa_ReturnErrorIfArrayArgumentNull(a_pNoOfDiagnosticInfos, a_pDiagnosticInfos);
+
+	*a_pNoOfDiagnosticInfos=0;
+	*a_pDiagnosticInfos=OpcUa_Null;
+
+#ifndef NO_DEBUGING_
+	MY_TRACE("\n\n\nDELETESUBSCRIPTIONS SERVICE===============================\n"); 
+#endif /*_DEBUGING_*/
+
+	uStatus=check_session(a_pRequestHeader,&uSessionId);
+	OpcUa_GotoErrorIfBad(uStatus)
+
+	if(a_nNoOfSubscriptionIds<=0)
+	{
+		OpcUa_GotoErrorWithStatus(OpcUa_BadNothingToDo)
+	}
+
+	*a_pResults=OpcUa_Alloc(a_nNoOfSubscriptionIds*sizeof(OpcUa_StatusCode));
+	OpcUa_GotoErrorIfAllocFailed((*a_pResults))
+	*a_pNoOfResults=a_nNoOfSubscriptionIds;
+
+	Answers.NoOfAnswers=0;
+	OpcUa_Mutex_Lock(subscription_mutex);
+	for(n=0;n<a_nNoOfSubscriptionIds;n++)
+	{
+		i=find_subscription(uSessionId,a_pSubscriptionIds[n]);
+		if(i<0)
+		{
+			(*a_pResults)[n]=OpcUa_BadSubscriptionIdInvalid;
+			continue;
+		}
+		remove_subscription(i);
+		(*a_pResults)[n]=OpcUa_Good;
+	}
+	/* parked Publish requests have nothing left to wait for */
+	if(no_of_subscriptions(uSessionId)==0)
+		fail_publish_requests(uSessionId,OpcUa_BadNoSubscription,&Answers);
+	OpcUa_Mutex_Unlock(subscription_mutex);
+
+	send_publish_answers(&Answers);
+
+	uStatus = response_header_ausfuellen(a_pResponseHeader,a_pRequestHeader,uStatus);
+	if(OpcUa_IsBad(uStatus))
+	{
+		a_pResponseHeader->ServiceResult=OpcUa_BadInternalError;
+	}
+#ifndef NO_DEBUGING_
+	MY_TRACE("\nSERVICE===ENDE============================================\n\n\n"); 
+#endif /*_DEBUGING_*/
+
+	OpcUa_ReturnStatusCode;
+	OpcUa_BeginErrorHandling;
+
+	uStatus = response_header_ausfuellen(a_pResponseHeader,a_pRequestHeader,uStatus);
+	if(OpcUa_IsBad(uStatus))
+	{
+		a_pResponseHeader->ServiceResult=OpcUa_BadInternalError;
+	}
+#ifndef NO_DEBUGING_
+	MY_TRACE("\nSERVICEENDE (IM SERVICE SIND FEHLER AUFGETRETTEN)===========\n\n\n"); 
+#endif /*_DEBUGING_*/
+	OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * checks the filter of a monitored item and returns its absolute deadband.
+ *===========================================================================*/
+static OpcUa_StatusCode check_data_change_filter(const OpcUa_ExtensionObject* a_pFilter, const my_Variant* a_pValue, OpcUa_Double* a_pdDeadband)
+{
+	OpcUa_DataChangeFilter* pFilter;
+
+	*a_pdDeadband=0;
+	if(a_pFilter->Encoding==OpcUa_ExtensionObjectEncoding_None)
+		return OpcUa_Good;
+	if(a_pFilter->Encoding!=OpcUa_ExtensionObjectEncoding_EncodeableObject || a_pFilter->Body.EncodeableObject.Type!=&OpcUa_DataChangeFilter_EncodeableType)
+		return OpcUa_BadMonitoredItemFilterUnsupported;
+
+	pFilter=(OpcUa_DataChangeFilter*)a_pFilter->Body.EncodeableObject.Object;
+	if(pFilter==OpcUa_Null)
+		return OpcUa_BadMonitoredItemFilterInvalid;
+
+	switch(pFilter->DeadbandType)
+	{
+	case OpcUa_DeadbandType_None:
+		return OpcUa_Good;
+	case OpcUa_DeadbandType_Absolute:
+		if(a_pValue->ArrayType!=OpcUa_VariantArrayType_Scalar || (a_pValue->Datatype!=OpcUaId_Double && a_pValue->Datatype!=OpcUaId_UInt32))
+			return OpcUa_BadFilterNotAllowed;
+		if(pFilter->DeadbandValue<0)
+			return OpcUa_BadDeadbandFilterInvalid;
+		*a_pdDeadband=pFilter->DeadbandValue;
+		return OpcUa_Good;
+	case OpcUa_DeadbandType_Percent:
+		/* no EURange in the address space */
+		return OpcUa_BadMonitoredItemFilterUnsupported;
+	default:
+		return OpcUa_BadDeadbandFilterInvalid;
+	}
+}
+
+/*============================================================================
+ * method which implements the CreateMonitoredItems service.
+ *===========================================================================*/
+OpcUa_StatusCode my_CreateMonitoredItems(
+							OpcUa_Endpoint                          a_hEndpoint,
+							OpcUa_Handle                            a_hContext,
+							const OpcUa_RequestHeader*              a_pRequestHeader,
+							OpcUa_UInt32                            a_nSubscriptionId,
+							OpcUa_TimestampsToReturn                a_eTimestampsToReturn,
+							OpcUa_Int32                             a_nNoOfItemsToCreate,
+							const OpcUa_MonitoredItemCreateRequest* a_pItemsToCreate,
+							OpcUa_ResponseHeader*                   a_pResponseHeader,
+							OpcUa_Int32*                            a_pNoOfResults,
+							OpcUa_MonitoredItemCreateResult**       a_pResults,
+							OpcUa_Int32*                            a_pNoOfDiagnosticInfos,
+							OpcUa_DiagnosticInfo**                  a_pDiagnosticInfos)
+{
+	OpcUa_Int							i,n,s,b;
+	_VariableKnoten_*					p_Node;
+	_MonitoredItem_*					pItem;
+	const OpcUa_MonitoredItemCreateRequest*	pRequest;
+	OpcUa_MonitoredItemCreateResult*	pResult;
+	OpcUa_Double						dDeadband;
+	OpcUa_UInt32						uSamplingInterval;
+	OpcUa_UInt32						uSessionId;
+	extern my_Variant					all_ValueAttribute_of_VariableTypeNodes_VariableNodes[];
+
+	OpcUa_InitializeStatus(OpcUa_Module_Server, "OpcUa_ServerApi_CreateMonitoredItems");
+
+	/* validate arguments. */
+	OpcUa_ReturnErrorIfArgumentNull(a_hEndpoint);
+	OpcUa_ReturnErrorIfArgumentNull(a_hContext);
+	OpcUa_ReturnErrorIfArgumentNull(a_pRequestHeader);
+	OpcUa_ReturnErrorIfArrayArgumentNull(a_nNoOfItemsToCreate, a_pItemsToCreate);
+	OpcUa_ReturnErrorIfArgumentNull(a_pResponseHeader);
+	OpcUa_ReturnErrorIfArrayArgumentNull(a_pNoOfResults, a_pResults);
+	OpcUa_ReturnErrorIfArrayArgumentNull(a_pNoOfDiagnosticInfos, a_pDiagnosticInfos);
+
+	*a_pNoOfDiagnosticInfos=0;
+	*a_pDiagnosticInfos=OpcUa_Null;
+
+#ifndef NO_DEBUGING_
+	MY_TRACE("\n\n\nCREATEMONITOREDITEMS SERVICE==============================\n"); 
+#endif /*_DEBUGING_*/
+
+	uStatus=check_session(a_pRequestHeader,&uSessionId);
+	OpcUa_GotoErrorIfBad(uStatus)
+
+	if(a_nNoOfItemsToCreate<=0)
+	{
+		OpcUa_GotoErrorWithStatus(OpcUa_BadNothingToDo)
+	}
+	if(a_eTimestampsToReturn<OpcUa_TimestampsToReturn_Source || a_eTimestampsToReturn>OpcUa_TimestampsToReturn_Neither)
+	{
+		OpcUa_GotoErrorWithStatus(OpcUa_BadTimestampsToReturnInvalid)
+	}
+
+	*a_pResults=OpcUa_Alloc(a_nNoOfItemsToCreate*sizeof(OpcUa_MonitoredItemCreateResult));
+	OpcUa_GotoErrorIfAllocFailed((*a_pResults))
+	for(n=0;n<a_nNoOfItemsToCreate;n++)
+		OpcUa_MonitoredItemCreateResult_Initialize((*a_pResults)+n);
+	*a_pNoOfResults=a_nNoOfItemsToCreate;
+
+	OpcUa_Mutex_Lock(subscription_mutex);
+	s=find_subscription(uSessionId,a_nSubscriptionId);
+	if(s<0)
+	{
+		OpcUa_Mutex_Unlock(subscription_mutex);
+		OpcUa_GotoErrorWithStatus(OpcUa_BadSubscriptionIdInvalid)
+	}
+
+	for(n=0;n<a_nNoOfItemsToCreate;n++)
+	{
+		pRequest=a_pItemsToCreate+n;
+		pResult=(*a_pResults)+n;
+
+		p_Node=(_VariableKnoten_*)search_for_node(pRequest->ItemToMonitor.NodeId);
+		if(p_Node==OpcUa_Null)
+		{
+			pResult->StatusCode=OpcUa_BadNodeIdUnknown;
+			continue;
+		}
+		if(pRequest->ItemToMonitor.AttributeId!=OpcUa_Attributes_Value)
+		{
+			pResult->StatusCode=(pRequest->ItemToMonitor.AttributeId>=OpcUa_Attributes_NodeId && pRequest->ItemToMonitor.AttributeId<=OpcUa_Attributes_UserExecutable)?OpcUa_BadNotSupported:OpcUa_BadAttributeIdInvalid;
+			continue;
+		}
+		if(p_Node->BaseAttribute.NodeClass!=OpcUa_NodeClass_Variable)
+		{
+			pResult->StatusCode=OpcUa_BadAttributeIdInvalid;
+			continue;
+		}
+		if(p_Node->ValueIndex==(-1))
+		{
+			pResult->StatusCode=OpcUa_BadNotReadable;
+			continue;
+		}
+		if(pRequest->MonitoringMode<OpcUa_MonitoringMode_Disabled || pRequest->MonitoringMode>OpcUa_MonitoringMode_Reporting)
+		{
+			pResult->StatusCode=OpcUa_BadMonitoringModeInvalid;
+			continue;
+		}
+		pResult->StatusCode=check_data_change_filter(&pRequest->RequestedParameters.Filter,&all_ValueAttribute_of_VariableTypeNodes_VariableNodes[p_Node->ValueIndex],&dDeadband);
+		if(OpcUa_IsBad(pResult->StatusCode))
+			continue;
+
+		for(i=0;i<MAX_MONITOREDITEMS;i++)
+		{
+			if(monitoreditems[i].MonitoredItemId==0)
+				break;
+		}
+		if(i==MAX_MONITOREDITEMS)
+		{
+			pResult->StatusCode=OpcUa_BadTooManyMonitoredItems;
+			continue;
+		}
+
+		/* a negative sampling interval means the publishing interval */
+		if(pRequest->RequestedParameters.SamplingInterval<0)
+			uSamplingInterval=subscriptions[s].PublishingInterval;
+		else
+			uSamplingInterval=revise_interval(pRequest->RequestedParameters.SamplingInterval);
+
+		pItem=&monitoreditems[i];
+		if(++last_monitoreditem_id==0)
+			last_monitoreditem_id=1;
+		pItem->MonitoredItemId=last_monitoreditem_id;
+		pItem->ClientHandle=pRequest->RequestedParameters.ClientHandle;
+		pItem->Subscription=s;
+		pItem->pNode=p_Node;
+		pItem->MonitoringMode=pRequest->MonitoringMode;
+		pItem->TimestampsToReturn=a_eTimestampsToReturn;
+		pItem->Bucket=-1;
+		pItem->Pending=OpcUa_False;
+
+		if(pItem->MonitoringMode!=OpcUa_MonitoringMode_Disabled)
+		{
+			b=find_sampling_bucket(uSamplingInterval);
+			uSamplingInterval=sampling_buckets[b].SamplingInterval;
+			bucket_add(b,i,dDeadband);
+			/* the first sample is always reported */
+			report_monitoreditem(i);
+		}
+
+		pResult->StatusCode=OpcUa_Good;
+		pResult->MonitoredItemId=pItem->MonitoredItemId;
+		pResult->RevisedSamplingInterval=uSamplingInterval;
+		pResult->RevisedQueueSize=1;
+	}
+	OpcUa_Mutex_Unlock(subscription_mutex);
+
+	uStatus = response_header_ausfuellen(a_pResponseHeader,a_pRequestHeader,uStatus);
+	if(OpcUa_IsBad(uStatus))
+	{
+		a_pResponseHeader->ServiceResult=OpcUa_BadInternalError;
+	}
+#ifndef NO_DEBUGING_
+	MY_TRACE("\nSERVICE===ENDE============================================\n\n\n"); 
+#endif /*_DEBUGING_*/
+
+	OpcUa_ReturnStatusCode;
+	OpcUa_BeginErrorHandling;
+
+	uStatus = response_header_ausfuellen(a_pResponseHeader,a_pRequestHeader,uStatus);
+	if(OpcUa_IsBad(uStatus))
+	{
+		a_pResponseHeader->ServiceResult=OpcUa_BadInternalError;
+	}
+#ifndef NO_DEBUGING_
+	MY_TRACE("\nSERVICEENDE (IM SERVICE SIND FEHLER AUFGETRETTEN)===========\n\n\n"); 
+#endif /*_DEBUGING_*/
+	OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * method which implements the DeleteMonitoredItems service.
+ *===========================================================================*/
+OpcUa_StatusCode my_DeleteMonitoredItems(
+							OpcUa_Endpoint             a_hEndpoint,
+							OpcUa_Handle               a_hContext,
+							const OpcUa_RequestHeader* a_pRequestHeader,
+							OpcUa_UInt32               a_nSubscriptionId,
+							OpcUa_Int32                a_nNoOfMonitoredItemIds,
+							const OpcUa_UInt32*        a_pMonitoredItemIds,
+							OpcUa_ResponseHeader*      a_pResponseHeader,
+							OpcUa_Int32*               a_pNoOfResults,
+							OpcUa_StatusCode**         a_pResults,
+							OpcUa_Int32*               a_pNoOfDiagnosticInfos,
+							OpcUa_DiagnosticInfo**     a_pDiagnosticInfos)
+{
+	OpcUa_Int			i,n,s;
+	OpcUa_UInt32		uSessionId;
+
+	OpcUa_InitializeStatus(OpcUa_Module_Server, "OpcUa_ServerApi_DeleteMonitoredItems");
+
+	/* validate arguments. */
+	OpcUa_ReturnErrorIfArgumentNull(a_hEndpoint);
+	OpcUa_ReturnErrorIfArgumentNull(a_hContext);
+	OpcUa_ReturnErrorIfArgumentNull(a_pRequestHeader);
+	OpcUa_ReturnErrorIfArrayArgumentNull(a_nNoOfMonitoredItemIds, a_pMonitoredItemIds);
+	OpcUa_ReturnErrorIfArgumentNull(a_pResponseHeader);
+	OpcUa_ReturnErrorIfArrayArgumentNull(a_pNoOfResults, a_pResults);
+	OpcUa_ReturnErrorIfArrayArgumentNull(a_pNoOfDiagnosticInfos, a_pDiagnosticInfos);
+
+	*a_pNoOfDiagnosticInfos=0;
+	*a_pDiagnosticInfos=OpcUa_Null;
+
+#ifndef NO_DEBUGING_
+	MY_TRACE("\n\n\nDELETEMONITOREDITEMS SERVICE==============================\n"); 
+#endif /*_DEBUGING_*/
+
+	uStatus=check_session(a_pRequestHeader,&uSessionId);
+	OpcUa_GotoErrorIfBad(uStatus)
+
+	if(a_nNoOfMonitoredItemIds<=0)
+	{
+		OpcUa_GotoErrorWithStatus(OpcUa_BadNothingToDo)
+	}
+
+	*a_pResults=OpcUa_Alloc(a_nNoOfMonitoredItemIds*sizeof(OpcUa_StatusCode));
+	OpcUa_GotoErrorIfAllocFailed((*a_pResults))
+	*a_pNoOfResults=a_nNoOfMonitoredItemIds;
+
+	OpcUa_Mutex_Lock(subscription_mutex);
+	s=find_subscription(uSessionId,a_nSubscriptionId);
+	if(s<0)
+	{
+		OpcUa_Mutex_Unlock(subscription_mutex);
+		OpcUa_GotoErrorWithStatus(OpcUa_BadSubscriptionIdInvalid)
+	}
+
+	for(n=0;n<a_nNoOfMonitoredItemIds;n++)
+	{
+		(*a_pResults)[n]=OpcUa_BadMonitoredItemIdInvalid;
+		for(i=0;i<MAX_MONITOREDITEMS;i++)
+		{
+			if(a_pMonitoredItemIds[n]!=0 && monitoreditems[i].MonitoredItemId==a_pMonitoredItemIds[n] && monitoreditems[i].Subscription==s)
+			{
+				remove_monitoreditem(i);
+				(*a_pResults)[n]=OpcUa_Good;
+				break;
+			}
+		}
+	}
+	OpcUa_Mutex_Unlock(subscription_mutex);
+
+	uStatus = response_header_ausfuellen(a_pResponseHeader,a_pRequestHeader,uStatus);
+	if(OpcUa_IsBad(uStatus))
+	{
+		a_pResponseHeader->ServiceResult=OpcUa_BadInternalError;
+	}
+#ifndef NO_DEBUGING_
+	MY_TRACE("\nSERVICE===ENDE============================================\n\n\n"); 
+#endif /*_DEBUGING_*/
+
+	OpcUa_ReturnStatusCode;
+	OpcUa_BeginErrorHandling;
+
+	uStatus = response_header_ausfuellen(a_pResponseHeader,a_pRequestHeader,uStatus);
+	if(OpcUa_IsBad(uStatus))
+	{
+		a_pResponseHeader->ServiceResult=OpcUa_BadInternalError;
+	}
+#ifndef NO_DEBUGING_
+	MY_TRACE("\nSERVICEENDE (IM SERVICE SIND FEHLER AUFGETRETTEN)===========\n\n\n"); 
+#endif /*_DEBUGING_*/
+	OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * begins processing of a Publish request.
+ * The acknowledgements are answered right away; the response itself is
+ * parked and sent from the subscription timer once a subscription has
+ * notifications or a keep-alive to deliver.
+ *===========================================================================*/
+OpcUa_StatusCode my_BeginPublish(
+							OpcUa_Endpoint        a_hEndpoint,
+							OpcUa_Handle          a_hContext,
+							OpcUa_Void**          a_ppRequest,
+							OpcUa_EncodeableType* a_pRequestType)
+{
+	OpcUa_PublishRequest*		pRequest		= OpcUa_Null;
+	_PublishRequest_			Request;
+	_PublishAnswers_			Answers;
+	const OpcUa_SubscriptionAcknowledgement* pAck;
+	OpcUa_Int					i,n,s;
+
+	OpcUa_InitializeStatus(OpcUa_Module_Server, "OpcUa_Server_BeginPublish");
+
+	OpcUa_ReturnErrorIfArgumentNull(a_hEndpoint);
+	OpcUa_ReturnErrorIfArgumentNull(a_hContext);
+	OpcUa_ReturnErrorIfArgumentNull(a_ppRequest);
+	OpcUa_ReturnErrorIfArgumentNull(*a_ppRequest);
+	OpcUa_ReturnErrorIfArgumentNull(a_pRequestType);
+
+	OpcUa_ReturnErrorIfTrue(a_pRequestType->TypeId != OpcUaId_PublishRequest, OpcUa_BadInvalidArgument);
+
+	pRequest=(OpcUa_PublishRequest*)*a_ppRequest;
+
+	OpcUa_MemSet(&Request,0,sizeof(_PublishRequest_));
+	Request.hEndpoint=a_hEndpoint;
+	Request.hContext=a_hContext;
+
+	/* create a context to use for sending a response */
+	uStatus=OpcUa_Endpoint_BeginSendResponse(a_hEndpoint,a_hContext,(OpcUa_Void**)&Request.pResponse,&Request.pResponseType);
+	OpcUa_GotoErrorIfBad(uStatus);
+
+	uStatus=response_header_ausfuellen(&Request.pResponse->ResponseHeader,&pRequest->RequestHeader,OpcUa_Good);
+	if(OpcUa_IsGood(uStatus))
+		uStatus=Request.pResponse->ResponseHeader.ServiceResult;
+	if(OpcUa_IsGood(uStatus))
+		uStatus=check_session(&pRequest->RequestHeader,&Request.SessionId);
+	if(OpcUa_IsBad(uStatus))
+	{
+		/* the response went out as a fault */
+		send_publish_fault(&Request,uStatus);
+		return OpcUa_Good;
+	}
+
+	OpcUa_Mutex_Lock(subscription_mutex);
+
+	n=pRequest->NoOfSubscriptionAcknowledgements;
+	if(n>0)
+	{
+		Request.pResponse->Results=OpcUa_Alloc(n*sizeof(OpcUa_StatusCode));
+		if(Request.pResponse->Results==OpcUa_Null)
+		{
+			OpcUa_Mutex_Unlock(subscription_mutex);
+			send_publish_fault(&Request,OpcUa_BadOutOfMemory);
+			return OpcUa_Good;
+		}
+		Request.pResponse->NoOfResults=n;
+		for(i=0;i<n;i++)
+		{
+			/* sent messages are not kept for Republish, so every message up to the last one counts as acknowledged */
+			pAck=pRequest->SubscriptionAcknowledgements+i;
+			s=find_subscription(Request.SessionId,pAck->SubscriptionId);
+			if(s<0)
+				Request.pResponse->Results[i]=OpcUa_BadSubscriptionIdInvalid;
+			else if(pAck->SequenceNumber==0 || pAck->SequenceNumber>subscriptions[s].SequenceNumber)
+				Request.pResponse->Results[i]=OpcUa_BadSequenceNumberUnknown;
+			else
+				Request.pResponse->Results[i]=OpcUa_Good;
+		}
+	}
+
+	if(subscription_timer==OpcUa_Null)
+		uStatus=OpcUa_BadShutdown;
+	else if(no_of_subscriptions(Request.SessionId)==0)
+		uStatus=OpcUa_BadNoSubscription;
+	else if(no_of_publish_requests==MAX_PUBLISHREQUESTS)
+		uStatus=OpcUa_BadTooManyPublishRequests;
+
+	if(OpcUa_IsBad(uStatus))
+	{
+		OpcUa_Mutex_Unlock(subscription_mutex);
+		send_publish_fault(&Request,uStatus);
+		return OpcUa_Good;
+	}
+
+	publish_requests[no_of_publish_requests++]=Request;
+
+	for(i=0;i<MAX_SUBSCRIPTIONS;i++)
+	{
+		if(subscriptions[i].SessionId==Request.SessionId)
+			subscriptions[i].LifetimeCounter=0;
+	}
+
+	Answers.NoOfAnswers=0;
+	serve_late_subscriptions(Request.SessionId,&Answers);
+
+	OpcUa_Mutex_Unlock(subscription_mutex);
+
+	send_publish_answers(&Answers);
+
+	OpcUa_ReturnStatusCode;
+	OpcUa_BeginErrorHandling;
+
+	/* send an error response */
+	OpcUa_Endpoint_EndSendResponse(a_hEndpoint,&a_hContext,uStatus,OpcUa_Null,OpcUa_Null);
+
+	OpcUa_EncodeableObject_Delete(Request.pResponseType,(OpcUa_Void**)&Request.pResponse);
+
+	OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * creates the subscription timer.
+ *===========================================================================*/
+OpcUa_StatusCode initialize_subscriptions(OpcUa_Void)
+{
+	OpcUa_InitializeStatus(OpcUa_Module_Server, "initialize_subscriptions");
+
+	OpcUa_MemSet(subscriptions,0,sizeof(subscriptions));
+	OpcUa_MemSet(monitoreditems,0,sizeof(monitoreditems));
+	OpcUa_MemSet(sampling_buckets,0,sizeof(sampling_buckets));
+	OpcUa_MemSet(publish_requests,0,sizeof(publish_requests));
+	no_of_publish_requests=0;
+
+	if(subscription_mutex==OpcUa_Null)
+	{
+		uStatus=OpcUa_Mutex_Create(&subscription_mutex);
+		OpcUa_GotoErrorIfBad(uStatus)
+	}
+
+	uStatus=OpcUa_Timer_Create(&subscription_timer,SUBSCRIPTION_TICK,subscription_timer_callback,OpcUa_Null,OpcUa_Null);
+	OpcUa_GotoErrorIfBad(uStatus)
+
+	OpcUa_ReturnStatusCode;
+	OpcUa_BeginErrorHandling;
+	OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * removes the subscriptions of a session that ends; its parked Publish
+ * requests get a_uStatus.
+ *===========================================================================*/
+OpcUa_Void delete_session_subscriptions(OpcUa_UInt32 a_uSessionId, OpcUa_StatusCode a_uStatus)
+{
+	_PublishAnswers_	Answers;
+	OpcUa_Int			i;
+
+	if(subscription_mutex==OpcUa_Null)
+		return;
+
+	Answers.NoOfAnswers=0;
+	OpcUa_Mutex_Lock(subscription_mutex);
+	for(i=0;i<MAX_SUBSCRIPTIONS;i++)
+	{
+		if(subscriptions[i].SubscriptionId!=0 && subscriptions[i].SessionId==a_uSessionId)
+			remove_subscription(i);
+	}
+	fail_publish_requests(a_uSessionId,a_uStatus,&Answers);
+	OpcUa_Mutex_Unlock(subscription_mutex);
+
+	send_publish_answers(&Answers);
+}
+
+/*============================================================================
+ * stops the engine while the endpoint is still open: the timer is deleted
+ * and parked Publish requests are cancelled.
+ * Must not be called with subscription_mutex held, the timer callback takes it.
+ *===========================================================================*/
+OpcUa_Void stop_subscriptions(OpcUa_Void)
+{
+	OpcUa_Int i;
+
+	if(subscription_timer!=OpcUa_Null)
+		OpcUa_Timer_Delete(&subscription_timer);
+
+	if(subscription_mutex==OpcUa_Null)
+		return;
+
+	OpcUa_Mutex_Lock(subscription_mutex);
+	subscription_timer=OpcUa_Null;
+	for(i=0;i<MAX_SUBSCRIPTIONS;i++)
+	{
+		if(subscriptions[i].SubscriptionId!=0)
+			remove_subscription(i);
+	}
+	while(no_of_publish_requests>0)
+	{
+		_PublishRequest_ Request=take_publish_request(0);
+		OpcUa_Endpoint_CancelSendResponse(Request.hEndpoint,OpcUa_BadShutdown,OpcUa_Null,&Request.hContext);
+		OpcUa_EncodeableObject_Delete(Request.pResponseType,(OpcUa_Void**)&Request.pResponse);
+	}
+	OpcUa_Mutex_Unlock(subscription_mutex);
+}
+
+OpcUa_Void clear_subscriptions(OpcUa_Void)
+{
+	if(subscription_timer!=OpcUa_Null)
+		OpcUa_Timer_Delete(&subscription_timer);
+	if(subscription_mutex!=OpcUa_Null)
+		OpcUa_Mutex_Delete(&subscription_mutex);
+}
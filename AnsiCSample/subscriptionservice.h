@@ -0,0 +1,202 @@
+/* ========================================================================
+ * Copyright (c) 2005-2016 The OPC Foundation, Inc. All rights reserved.
+ *
+ * OPC Foundation MIT License 1.00
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * The complete license agreement can be found here:
+ * http://opcfoundation.org/License/MIT/1.00/
+ * ======================================================================*/
+ 
+#ifndef _subscriptionservice_
+#define _subscriptionservice_
+
+#include "addressspace.h"
+
+/*============================================================================
+ * subscription engine.
+ * One timer drives sampling and publishing with a resolution of
+ * SUBSCRIPTION_TICK msec. Monitored items with the same revised sampling
+ * interval share a bucket; a bucket keeps the values it compares against in
+ * contiguous arrays, so a sampling pass over scalars is a plain loop without
+ * allocations.
+ * A value is only compared again once its version in the value store moved.
+ * Each item queues only its latest value (queue size 1).
+ * Subscriptions belong to the session that created them. Publish requests
+ * are parked until a subscription of their session has something to send
+ * or its keep-alive is due, and are answered from the timer.
+ * The pending values of a subscription go out in as few NotificationMessages
+ * as MaxNotificationsPerPublish allows. They are collected into a batch
+ * whose encoded size is known up front and which the stack encodes straight
+ * into the response stream as a DataChangeNotification.
+ * Publish responses are prepared under the subscription lock and sent after
+ * it was released, each with a batch of its own.
+ * Only the Value attribute of variables can be monitored.
+ *===========================================================================*/
+#define MAX_SUBSCRIPTIONS				16		/* of all sessions */
+#define MAX_MONITOREDITEMS				256		/* of all subscriptions */
+#define MAX_PUBLISHREQUESTS				32		/* parked Publish requests of all sessions */
+#define MAX_SAMPLINGBUCKETS				8		/* distinct sampling intervals */
+#define SUBSCRIPTION_TICK				50		/* msec */
+#define MAX_PUBLISHINGINTERVAL			3600000	/* msec */
+#define DEFAULT_MAXKEEPALIVECOUNT		10
+
+typedef struct{
+	OpcUa_UInt32		SubscriptionId;							/* 0: slot is free */
+	OpcUa_UInt32		SessionId;
+	OpcUa_UInt32		PublishingInterval;						/* msec, multiple of SUBSCRIPTION_TICK */
+	OpcUa_UInt32		LifetimeCount;
+	OpcUa_UInt32		MaxKeepAliveCount;
+	OpcUa_UInt32		MaxNotificationsPerPublish;				/* 0: no limit */
+	OpcUa_Boolean		PublishingEnabled;
+	OpcUa_Boolean		Late;									/* a message is due but no Publish request was parked */
+	OpcUa_UInt32		Elapsed;								/* msec since the last publishing cycle */
+	OpcUa_UInt32		KeepAliveCounter;
+	OpcUa_UInt32		LifetimeCounter;
+	OpcUa_UInt32		SequenceNumber;							/* of the last NotificationMessage sent */
+	OpcUa_Int			NoOfPending;							/* reporting items with a value to send */
+}_Subscription_;
+
+typedef struct{
+	OpcUa_UInt32				MonitoredItemId;				/* 0: slot is free */
+	OpcUa_UInt32				ClientHandle;
+	OpcUa_Int					Subscription;					/* index in the subscription table */
+	_VariableKnoten_*			pNode;
+	OpcUa_MonitoringMode		MonitoringMode;
+	OpcUa_TimestampsToReturn	TimestampsToReturn;
+	OpcUa_Int					Bucket;							/* -1 while disabled */
+	OpcUa_Int					Slot;							/* position in the bucket */
+	OpcUa_Boolean				Pending;
+}_MonitoredItem_;
+
+typedef struct{
+	OpcUa_UInt32		SamplingInterval;						/* msec, 0: bucket is free */
+	OpcUa_UInt32		Elapsed;
+	OpcUa_Int			NoOfItems;
+	OpcUa_Int			Item[MAX_MONITOREDITEMS];				/* index in the monitored item table */
+	OpcUa_Int			ValueIndex[MAX_MONITOREDITEMS];
+	OpcUa_Double		Deadband[MAX_MONITOREDITEMS];			/* absolute deadband, 0: every change */
+	my_Variant			LastValue[MAX_MONITOREDITEMS];			/* last reported value, only the type of arrays */
+	OpcUa_UInt32		LastVersion[MAX_MONITOREDITEMS];		/* of the value at the last sampling pass */
+}_SamplingBucket_;
+
+typedef struct{
+	OpcUa_Int32					NoOfItems;
+	OpcUa_Int32					BodySize;						/* encoded size of the DataChangeNotification */
+	OpcUa_UInt32				ClientHandle[MAX_MONITOREDITEMS];
+	OpcUa_TimestampsToReturn	TimestampsToReturn[MAX_MONITOREDITEMS];
+	my_Variant					Value[MAX_MONITOREDITEMS];		/* copies from the value store, strings stay in the address space */
+	OpcUa_DateTime				SourceTimestamp[MAX_MONITOREDITEMS];
+	OpcUa_DateTime				ServerTimestamp[MAX_MONITOREDITEMS];
+}_DataChangeBatch_;
+
+typedef struct{
+	OpcUa_Endpoint			hEndpoint;
+	OpcUa_Handle			hContext;
+	OpcUa_PublishResponse*	pResponse;
+	OpcUa_EncodeableType*	pResponseType;
+	OpcUa_UInt32			SessionId;
+}_PublishRequest_;
+
+typedef struct{
+	_PublishRequest_		Request;
+	OpcUa_StatusCode		Fault;									/* bad: answered with a ServiceFault */
+	_DataChangeBatch_*		pBatch;									/* OpcUa_Null for a keep-alive */
+	OpcUa_ExtensionObject	NotificationData;						/* refers to pBatch */
+}_PublishAnswer_;
+
+typedef struct{
+	OpcUa_Int				NoOfAnswers;
+	_PublishAnswer_			Answer[MAX_PUBLISHREQUESTS];			/* each takes a parked Publish request */
+}_PublishAnswers_;
+
+
+OpcUa_StatusCode my_CreateSubscription(
+							OpcUa_Endpoint             a_hEndpoint,
+							OpcUa_Handle               a_hContext,
+							const OpcUa_RequestHeader* a_pRequestHeader,
+							OpcUa_Double               a_nRequestedPublishingInterval,
+							OpcUa_UInt32               a_nRequestedLifetimeCount,
+							OpcUa_UInt32               a_nRequestedMaxKeepAliveCount,
+							OpcUa_UInt32               a_nMaxNotificationsPerPublish,
+							OpcUa_Boolean              a_bPublishingEnabled,
+							OpcUa_Byte                 a_nPriority,
+							OpcUa_ResponseHeader*      a_pResponseHeader,
+							OpcUa_UInt32*              a_pSubscriptionId,
+							OpcUa_Double*              a_pRevisedPublishingInterval,
+							OpcUa_UInt32*              a_pRevisedLifetimeCount,
+							OpcUa_UInt32*              a_pRevisedMaxKeepAliveCount);
+
+OpcUa_StatusCode my_DeleteSubscriptions(
+							OpcUa_Endpoint             a_hEndpoint,
+							OpcUa_Handle               a_hContext,
+							const OpcUa_RequestHeader* a_pRequestHeader,
+							OpcUa_Int32                a_nNoOfSubscriptionIds,
+							const OpcUa_UInt32*        a_pSubscriptionIds,
+							OpcUa_ResponseHeader*      a_pResponseHeader,
+							OpcUa_Int32*               a_pNoOfResults,
+							OpcUa_StatusCode**         a_pResults,
+							OpcUa_Int32*               a_pNoOfDiagnosticInfos,
+							OpcUa_DiagnosticInfo**     a_pDiagnosticInfos);
+
+OpcUa_StatusCode my_CreateMonitoredItems(
+							OpcUa_Endpoint                          a_hEndpoint,
+							OpcUa_Handle                            a_hContext,
+							const OpcUa_RequestHeader*              a_pRequestHeader,
+							OpcUa_UInt32                            a_nSubscriptionId,
+							OpcUa_TimestampsToReturn                a_eTimestampsToReturn,
+							OpcUa_Int32                             a_nNoOfItemsToCreate,
+							const OpcUa_MonitoredItemCreateRequest* a_pItemsToCreate,
+							OpcUa_ResponseHeader*                   a_pResponseHeader,
+							OpcUa_Int32*                            a_pNoOfResults,
+							OpcUa_MonitoredItemCreateResult**       a_pResults,
+							OpcUa_Int32*                            a_pNoOfDiagnosticInfos,
+							OpcUa_DiagnosticInfo**                  a_pDiagnosticInfos);
+
+OpcUa_StatusCode my_DeleteMonitoredItems(
+							OpcUa_Endpoint             a_hEndpoint,
+							OpcUa_Handle               a_hContext,
+							const OpcUa_RequestHeader* a_pRequestHeader,
+							OpcUa_UInt32               a_nSubscriptionId,
+							OpcUa_Int32                a_nNoOfMonitoredItemIds,
+							const OpcUa_UInt32*        a_pMonitoredItemIds,
+							OpcUa_ResponseHeader*      a_pResponseHeader,
+							OpcUa_Int32*               a_pNoOfResults,
+							OpcUa_StatusCode**         a_pResults,
+							OpcUa_Int32*               a_pNoOfDiagnosticInfos,
+							OpcUa_DiagnosticInfo**     a_pDiagnosticInfos);
+
+OpcUa_StatusCode my_BeginPublish(
+							OpcUa_Endpoint        a_hEndpoint,
+							OpcUa_Handle          a_hContext,
+							OpcUa_Void**          a_ppRequest,
+							OpcUa_EncodeableType* a_pRequestType);
+
+OpcUa_StatusCode		initialize_subscriptions		(OpcUa_Void);
+
+OpcUa_Void				stop_subscriptions				(OpcUa_Void);
+
+OpcUa_Void				clear_subscriptions				(OpcUa_Void);
+
+OpcUa_Void				delete_session_subscriptions	(OpcUa_UInt32 ,OpcUa_StatusCode );
+
+#endif /*_subscriptionservice_*/
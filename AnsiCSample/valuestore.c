@@ -0,0 +1,218 @@
+/* ========================================================================
+ * Copyright (c) 2005-2016 The OPC Foundation, Inc. All rights reserved.
+ *
+ * OPC Foundation MIT License 1.00
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * The complete license agreement can be found here:
+ * http://opcfoundation.org/License/MIT/1.00/
+ * ======================================================================*/
+ 
+/* serverstub (basic includes for implementing a server based on the stack) */
+#include <opcua_serverstub.h>
+#include <opcua_memory.h>
+#include <opcua_core.h>
+#include <opcua_thread.h>
+#include <opcua_datetime.h>
+
+#include "addressspace.h"
+#include "valuestore.h"
+
+
+/* attempts before a waiting thread gives up the CPU */
+#define VALUE_STORE_SPINS				64
+
+static _ValueVersion_			value_versions[ARRAYSIZE_OF_VALUEATTRIBUTE];
+
+
+/*============================================================================
+ * a writer is done after a few stores, so a short spin is enough; after
+ * that it may have been preempted and gets the CPU.
+ *===========================================================================*/
+static OpcUa_Void wait_for_writer(OpcUa_UInt32* a_pSpins)
+{
+	if(++(*a_pSpins)<VALUE_STORE_SPINS)
+		return;
+	*a_pSpins=0;
+	OpcUa_Thread_Sleep(0);
+}
+
+/*============================================================================
+ * bytes of the elements of an array value.
+ *===========================================================================*/
+static OpcUa_UInt32 array_size(const my_Variant* a_pValue)
+{
+	OpcUa_UInt32 uElement;
+
+	switch(a_pValue->Datatype)
+	{
+	case OpcUaId_Double:	uElement=sizeof(OpcUa_Double); break;
+	case OpcUaId_UInt32:	uElement=sizeof(OpcUa_UInt32); break;
+	case OpcUaId_Boolean:	uElement=sizeof(OpcUa_Boolean); break;
+	case OpcUaId_String:	uElement=sizeof(OpcUa_StringA); break;
+	default:				return 0;
+	}
+	if(a_pValue->Value.Array.Length<=0)
+		return 0;
+	return uElement*(OpcUa_UInt32)a_pValue->Value.Array.Length;
+}
+
+/*============================================================================
+ * a reader waits only while a writer is inside; it never blocks one.
+ *===========================================================================*/
+static OpcUa_UInt32 read_begin(_ValueVersion_* a_pVersion)
+{
+	OpcUa_UInt32 uSequence;
+	OpcUa_UInt32 uSpins		= 0;
+
+	while(((uSequence=OpcUa_Atomic_Load32(&a_pVersion->Sequence))&1)!=0)
+		wait_for_writer(&uSpins);
+	return uSequence;
+}
+
+static OpcUa_Boolean read_retry(_ValueVersion_* a_pVersion, OpcUa_UInt32 a_uSequence)
+{
+	OpcUa_Atomic_MemoryBarrier();
+	return (OpcUa_Boolean)(OpcUa_Atomic_Load32(&a_pVersion->Sequence)!=a_uSequence);
+}
+
+OpcUa_Void initialize_value_store(OpcUa_Void)
+{
+	OpcUa_DateTime	Now	= OpcUa_DateTime_UtcNow();
+	OpcUa_Int		i;
+
+	for(i=0;i<ARRAYSIZE_OF_VALUEATTRIBUTE;i++)
+	{
+		value_versions[i].Sequence=0;
+		value_versions[i].SourceTimestamp=Now;
+		value_versions[i].ServerTimestamp=Now;
+	}
+}
+
+/*============================================================================
+ * a writer of a value waits only for another writer of the same value.
+ *===========================================================================*/
+OpcUa_Void write_value_begin(OpcUa_Int a_Index)
+{
+	_ValueVersion_*	pVersion	= &value_versions[a_Index];
+	OpcUa_UInt32	uSequence;
+	OpcUa_UInt32	uSpins		= 0;
+
+	for(;;)
+	{
+		uSequence=OpcUa_Atomic_Load32(&pVersion->Sequence);
+		if((uSequence&1)==0 && OpcUa_Atomic_CompareExchange32(&pVersion->Sequence,uSequence,uSequence+1))
+			break;
+		wait_for_writer(&uSpins);
+	}
+}
+
+/*============================================================================
+ * stamps the new value; without a source timestamp it is the server time.
+ *===========================================================================*/
+OpcUa_Void write_value_end(OpcUa_Int a_Index, const OpcUa_DateTime* a_pSourceTimestamp)
+{
+	_ValueVersion_*	pVersion	= &value_versions[a_Index];
+
+	pVersion->ServerTimestamp=OpcUa_DateTime_UtcNow();
+	pVersion->SourceTimestamp=(a_pSourceTimestamp!=OpcUa_Null)?*a_pSourceTimestamp:pVersion->ServerTimestamp;
+	OpcUa_Atomic_Store32(&pVersion->Sequence,pVersion->Sequence+1);
+}
+
+/*============================================================================
+ * changes whenever the value is written; cheap test for samplers.
+ *===========================================================================*/
+OpcUa_UInt32 value_version(OpcUa_Int a_Index)
+{
+	return OpcUa_Atomic_Load32(&value_versions[a_Index].Sequence);
+}
+
+/*============================================================================
+ * a consistent copy of a value and its timestamps. The elements of an array
+ * are copied into storage of the caller's own, freed with clear_value.
+ *===========================================================================*/
+OpcUa_StatusCode read_value(OpcUa_Int a_Index, my_Variant* a_pValue, _ValueVersion_* a_pVersion)
+{
+	extern my_Variant	all_ValueAttribute_of_VariableTypeNodes_VariableNodes[];
+	my_Variant*			pSource		= &all_ValueAttribute_of_VariableTypeNodes_VariableNodes[a_Index];
+	_ValueVersion_*		pVersion	= &value_versions[a_Index];
+	OpcUa_Void*			pArray		= OpcUa_Null;
+	OpcUa_UInt32		uAllocated	= 0;
+	OpcUa_UInt32		uSize		= 0;
+	OpcUa_UInt32		uSequence;
+
+	OpcUa_InitializeStatus(OpcUa_Module_Server, "read_value");
+
+	OpcUa_ReturnErrorIfArgumentNull(a_pValue);
+
+	for(;;)
+	{
+		uSequence=read_begin(pVersion);
+		*a_pValue=*pSource;
+		if(a_pVersion!=OpcUa_Null)
+		{
+			a_pVersion->SourceTimestamp=pVersion->SourceTimestamp;
+			a_pVersion->ServerTimestamp=pVersion->ServerTimestamp;
+		}
+		if(a_pValue->ArrayType==OpcUa_VariantArrayType_Array)
+		{
+			uSize=array_size(a_pValue);
+			if(uSize>uAllocated)
+			{
+				/* the length is only trusted if no writer came in between */
+				if(read_retry(pVersion,uSequence))
+					continue;
+				if(pArray!=OpcUa_Null)
+					OpcUa_Memory_Free(pArray);
+				pArray=OpcUa_Memory_Alloc(uSize);
+				OpcUa_GotoErrorIfAllocFailed(pArray);
+				uAllocated=uSize;
+				continue;
+			}
+			if(uSize>0)
+				OpcUa_MemCpy(pArray,uAllocated,a_pValue->Value.Array.Value.Array,uSize);
+			a_pValue->Value.Array.Value.Array=pArray;
+		}
+		if(read_retry(pVersion,uSequence)==OpcUa_False)
+			break;
+	}
+	if(a_pValue->ArrayType!=OpcUa_VariantArrayType_Array && pArray!=OpcUa_Null)
+		OpcUa_Memory_Free(pArray);
+	if(a_pVersion!=OpcUa_Null)
+		a_pVersion->Sequence=uSequence;
+
+	OpcUa_ReturnStatusCode;
+	OpcUa_BeginErrorHandling;
+
+	OpcUa_MemSet(a_pValue,0,sizeof(my_Variant));
+
+	OpcUa_FinishErrorHandling;
+}
+
+OpcUa_Void clear_value(my_Variant* a_pValue)
+{
+	if(a_pValue->ArrayType!=OpcUa_VariantArrayType_Array)
+		return;
+	if(a_pValue->Value.Array.Value.Array!=OpcUa_Null)
+		OpcUa_Memory_Free(a_pValue->Value.Array.Value.Array);
+	a_pValue->Value.Array.Value.Array=OpcUa_Null;
+}
@@ -0,0 +1,66 @@
+/* ========================================================================
+ * Copyright (c) 2005-2016 The OPC Foundation, Inc. All rights reserved.
+ *
+ * OPC Foundation MIT License 1.00
+ * 
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * The complete license agreement can be found here:
+ * http://opcfoundation.org/License/MIT/1.00/
+ * ======================================================================*/
+ 
+#ifndef _valuestore_
+#define _valuestore_
+
+#include "addressspace.h"
+
+/*============================================================================
+ * versioned values of the variables.
+ * Each entry of all_ValueAttribute_of_VariableTypeNodes_VariableNodes has a
+ * sequence counter and the timestamps of its last change next to it. A
+ * writer makes the counter odd, changes the value in place and makes it even
+ * again; a reader copies the value and starts over if the counter moved
+ * meanwhile. So readers never block writers, and writers of different values
+ * do not wait for each other.
+ * Strings are constants: a writer replaces the pointer, never the contents.
+ * Arrays are changed in place; their storage stays valid while the server
+ * runs.
+ *===========================================================================*/
+typedef struct{
+	OpcUa_UInt32		Sequence;							/* odd while a writer changes the value */
+	OpcUa_DateTime		SourceTimestamp;
+	OpcUa_DateTime		ServerTimestamp;
+}_ValueVersion_;
+
+
+OpcUa_Void				initialize_value_store		(OpcUa_Void);
+
+OpcUa_Void				write_value_begin			(OpcUa_Int );
+
+OpcUa_Void				write_value_end				(OpcUa_Int , const OpcUa_DateTime* );
+
+OpcUa_UInt32			value_version				(OpcUa_Int );
+
+OpcUa_StatusCode		read_value					(OpcUa_Int , my_Variant* , _ValueVersion_* );
+
+OpcUa_Void				clear_value					(my_Variant* );
+
+#endif /*_valuestore_*/
@@ -43,11 +43,15 @@ LIBS = $(ROOT)\lib\$(ODIR)\uastack.lib $(OPENSSLDIR)\lib\ssleay32.lib $(OPENSSLD
        rpcrt4.lib ws2_32.lib gdi32.lib advapi32.lib crypt32.lib user32.lib
 
 OBJECTS = \
+	$(ODIR)\addressspace_image.obj \
 	$(ODIR)\ansicservermain.obj \
 	$(ODIR)\browsenext.obj \
 	$(ODIR)\browseservice.obj \
 	$(ODIR)\init_variables_of_addressspace.obj \
 	$(ODIR)\readservice.obj \
+	$(ODIR)\sessiontable.obj \
+	$(ODIR)\subscriptionservice.obj \
+	$(ODIR)\valuestore.obj \
 
 all: $(TARGET)
 
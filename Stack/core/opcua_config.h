@@ -50,6 +50,8 @@
 /*#define OPCUA_HAVE_SOAPHTTP                         1*/
 /** @brief define or undefine to enable or disable the https support. */
 #define OPCUA_HAVE_HTTPS                            1
+/** @brief define or undefine to enable or disable the latency histograms of the request pipeline. */
+#define OPCUA_HAVE_LATENCYSTATISTICS                1
 
 
 /* * @brief AUTOMATIC; activate additional modules required by soap/http */
@@ -163,6 +165,12 @@
 /** @brief Enable output to trace device. */
 #define OPCUA_TRACE_MAXLENGTH                       200
 
+/** @brief Trace levels compiled into the binary. Trace calls for other levels are removed
+ *         by the preprocessor and cost nothing at runtime (see opcua_trace.h for the levels). */
+#ifndef OPCUA_TRACE_COMPILE_LEVEL
+#define OPCUA_TRACE_COMPILE_LEVEL                   OPCUA_TRACE_OUTPUT_LEVEL_ALL
+#endif
+
 /** @brief output the messages in errorhandling macros; requires OPCUA_ERRORHANDLING_OMIT_METHODNAME set to OPCUA_CONFIG_NO */
 #define OPCUA_TRACE_ERROR_MACROS                    OPCUA_CONFIG_NO
 
@@ -172,6 +180,42 @@
 /** @brief Add __LINE__ and __FILE__ information to the trace line. */
 #define OPCUA_TRACE_FILE_LINE_INFO                  OPCUA_CONFIG_NO
 
+/** @brief Record trace calls into per thread buffers and write them from a background thread.
+ *         Avoids the global trace lock and the synchronous write in the calling thread. */
+#ifndef OPCUA_TRACE_ASYNC
+#define OPCUA_TRACE_ASYNC                           OPCUA_CONFIG_YES
+#endif
+
+/** @brief Number of records in each per thread trace buffer. Must be a power of two. */
+#define OPCUA_TRACE_ASYNC_RECORDS                   256
+
+/** @brief Maximum number of threads with own trace buffer at the same time. Further threads trace
+ *         synchronously; the buffers of ended threads are taken over by new ones. */
+#define OPCUA_TRACE_ASYNC_MAXTHREADS                64
+
+/** @brief Maximum number of arguments per record. Calls with more arguments get formatted in place. */
+#define OPCUA_TRACE_ASYNC_MAXARGUMENTS              8
+
+/** @brief Bytes reserved per record for copies of string arguments and for calls formatted in place.
+ *         Must not be smaller than OPCUA_TRACE_MAXLENGTH, else the asynchronous trace cuts lines
+ *         the synchronous trace prints. */
+#define OPCUA_TRACE_ASYNC_STRINGDATA                OPCUA_TRACE_MAXLENGTH
+
+/** @brief Interval in milliseconds in which the background thread writes the buffered records. */
+#define OPCUA_TRACE_ASYNC_FLUSHINTERVAL             100
+
+/*============================================================================
+ * latency statistics
+ *===========================================================================*/
+/** @brief Initial state of the latency recording; can be changed at runtime with OpcUa_Latency_Enable. */
+#define OPCUA_LATENCY_ENABLED                       OPCUA_CONFIG_NO
+
+/** @brief Maximum number of threads with own latency recorder. Samples from further threads are dropped. */
+#define OPCUA_LATENCY_MAXTHREADS                    64
+
+/** @brief Maximum number of service types with own histograms. Further services only count in the stage totals. */
+#define OPCUA_LATENCY_MAXSERVICES                   32
+
 /*============================================================================
  * security
  *===========================================================================*/
@@ -196,9 +240,18 @@
 /** @brief Shall the FindServersOnNetwork request be allowed in discovery only mode. */
 #define OPCUA_SECURELISTENER_DISCOVERY_ALLOW_FSON   OPCUA_CONFIG_NO
 
+/** @brief Number of worker threads processing OpenSecureChannel requests, 0 processes them in the receiving thread. */
+#define OPCUA_SECURELISTENER_CRYPTOPOOL_THREADS     0
+
+/** @brief How many OpenSecureChannel requests may wait for a crypto worker before new ones are rejected. */
+#define OPCUA_SECURELISTENER_CRYPTOPOOL_MAXJOBS     64
+
 /** @brief Shall the secureconnection validate the server certificate given by the client application? */
 #define OPCUA_SECURECONNECTION_VALIDATE_SERVERCERT  OPCUA_CONFIG_NO
 
+/** @brief Up to this percentage of the token lifetime, a secureconnection renews its token earlier to spread renewals. */
+#define OPCUA_SECURECONNECTION_RENEW_JITTER         10
+
 /*============================================================================
  * networking
  *===========================================================================*/
@@ -245,6 +298,9 @@
 /** @brief Maximum number of pending messages before the server starts to block. */
 #define OPCUA_SECURECONNECTION_MAXPENDINGMESSAGES   10
 
+/** @brief How many deleted output streams a secure channel keeps for reuse, 0 disables the cache. */
+#define OPCUA_SECURECHANNEL_STREAMCACHE_SIZE        2
+
 /*============================================================================
  * HTTPS protocol
  *===========================================================================*/
@@ -298,6 +354,11 @@
 # define OPCUA_HTTPSLISTENER_MAXCONNECTIONS         50
 #endif /* OPCUA_HTTPSLISTENER_MAXCONNECTIONS */
 
+/** @brief Default number of requests in flight on one https connection (HTTP/1.1 pipelining). 1 disables pipelining. */
+#ifndef OPCUA_HTTPS_MAX_PIPELINED_REQUESTS
+# define OPCUA_HTTPS_MAX_PIPELINED_REQUESTS         8
+#endif /* OPCUA_HTTPS_MAX_PIPELINED_REQUESTS */
+
 /** @brief The standard port for the https protocol. */
 #define OPCUA_HTTPS_DEFAULT_PORT                    443
 
@@ -21,6 +21,7 @@
 
 #include <opcua_datetime.h>
 #include <opcua_guid.h>
+#include <opcua_latency.h>
 #include <opcua_memory.h>
 #include <opcua_thread.h>
 #include <opcua_string.h>
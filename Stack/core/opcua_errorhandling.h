@@ -84,6 +84,7 @@ typedef struct _OpcUa_StatusCodeString
 #define OpcUa_Module_ThreadPool         0x0000020DL
 #define OpcUa_Module_XmlReader          0x0000020EL
 #define OpcUa_Module_XmlWriter          0x0000020FL
+#define OpcUa_Module_Latency            0x00000210L
 
 /* proxy stub modules */
 #define OpcUa_Module_Session            0x00000301L
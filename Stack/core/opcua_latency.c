@@ -0,0 +1,597 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+/* base */
+#include <opcua.h>
+
+#ifdef OPCUA_HAVE_LATENCYSTATISTICS
+
+/* core */
+#include <opcua_mutex.h>
+#include <opcua_thread.h>
+
+/* self */
+#include <opcua_latency.h>
+
+#define OpcUa_P_GetMicroTickCount       OpcUa_ProxyStub_g_PlatformLayerCalltable->UtilGetMicroTickCount
+
+/*============================================================================
+ * Histogram Layout
+ *===========================================================================*/
+/**
+ * Log-linear buckets over microseconds: values below 8 have own buckets, every
+ * further power of two is split into 8 linear sub buckets. 240 buckets cover
+ * the full 32 bit range with a relative error below 12.5%.
+ */
+#define OPCUA_LATENCY_SUBBUCKET_BITS    3
+#define OPCUA_LATENCY_SUBBUCKETS        (1 << OPCUA_LATENCY_SUBBUCKET_BITS)
+#define OPCUA_LATENCY_BUCKETS           ((32 - OPCUA_LATENCY_SUBBUCKET_BITS + 1) * OPCUA_LATENCY_SUBBUCKETS)
+
+/*============================================================================
+ * Types
+ *===========================================================================*/
+/**
+ * Latency histogram of one stage. Only written by the owning thread.
+ */
+typedef struct _OpcUa_LatencyHistogram
+{
+    /** @brief Number of samples per bucket. */
+    OpcUa_UInt32            Buckets[OPCUA_LATENCY_BUCKETS];
+    /** @brief Sum of all samples in microseconds. */
+    OpcUa_UInt64            Sum;
+} OpcUa_LatencyHistogram;
+
+/**
+ * Histograms of all stages for either the stage totals or one service type.
+ */
+typedef struct _OpcUa_LatencyStages
+{
+    OpcUa_LatencyHistogram  Stages[OpcUa_LatencyStage_Count];
+} OpcUa_LatencyStages;
+
+/**
+ * Per thread recorder. Threads record without locking; the histograms
+ * of all recorders are merged when the statistics are queried.
+ */
+typedef struct _OpcUa_LatencyRecorder
+{
+    /** @brief Reset epoch the histograms belong to. */
+    OpcUa_UInt32            Epoch;
+    /** @brief Histograms over all requests. */
+    OpcUa_LatencyStages     Total;
+    /** @brief Histograms per service slot; allocated on first use by the owning thread. */
+    OpcUa_LatencyStages*    Services[OPCUA_LATENCY_MAXSERVICES];
+} OpcUa_LatencyRecorder;
+
+/*============================================================================
+ * Globals
+ *===========================================================================*/
+/** @brief Checked inline by OpcUa_Latency_Begin. */
+OpcUa_UInt32 OpcUa_Latency_g_bEnabled = OPCUA_LATENCY_ENABLED;
+
+#if OPCUA_USE_SYNCHRONISATION
+/** @brief Protects the registration of new recorders. */
+static OpcUa_Mutex                      OpcUa_Latency_s_hLock                   = OpcUa_Null;
+#endif /* OPCUA_USE_SYNCHRONISATION */
+/** @brief Recorders of all threads which recorded in the current generation. */
+static OpcUa_LatencyRecorder*           OpcUa_Latency_s_apRecorders[OPCUA_LATENCY_MAXTHREADS];
+/** @brief Number of valid entries in OpcUa_Latency_s_apRecorders. */
+static OpcUa_UInt32                     OpcUa_Latency_s_uNoOfRecorders          = 0;
+/** @brief Request type ids of the service slots; 0 marks a free slot. */
+static OpcUa_UInt32                     OpcUa_Latency_s_auServiceTypeIds[OPCUA_LATENCY_MAXSERVICES];
+/** @brief Incremented by Clear; invalidates the thread local recorder pointers. */
+static OpcUa_UInt32                     OpcUa_Latency_s_uGeneration             = 1;
+/** @brief Incremented by Reset; recorders of older epochs are cleared on their next sample. */
+static OpcUa_UInt32                     OpcUa_Latency_s_uEpoch                  = 0;
+/** @brief Set between Initialize and Clear. */
+static OpcUa_UInt32                     OpcUa_Latency_s_bActive                 = 0;
+/** @brief Number of threads inside OpcUa_Latency_Record. */
+static OpcUa_UInt32                     OpcUa_Latency_s_uCallers                = 0;
+/** @brief Recorder of the calling thread. */
+static OPCUA_P_THREAD_LOCAL OpcUa_LatencyRecorder*  OpcUa_Latency_s_pThreadRecorder     = OpcUa_Null;
+/** @brief Generation OpcUa_Latency_s_pThreadRecorder belongs to. */
+static OPCUA_P_THREAD_LOCAL OpcUa_UInt32            OpcUa_Latency_s_uThreadGeneration   = 0;
+
+/*============================================================================
+ * OpcUa_Latency_BucketIndex
+ *===========================================================================*/
+static OpcUa_UInt32 OpcUa_Latency_BucketIndex(OpcUa_UInt32 a_uValue)
+{
+    OpcUa_UInt32 uMagnitude = 0;
+    OpcUa_UInt32 uValue     = a_uValue;
+
+    if(a_uValue < OPCUA_LATENCY_SUBBUCKETS)
+    {
+        return a_uValue;
+    }
+
+    /* position of the highest bit set */
+    if(uValue & 0xFFFF0000) { uMagnitude += 16; uValue >>= 16; }
+    if(uValue & 0x0000FF00) { uMagnitude +=  8; uValue >>=  8; }
+    if(uValue & 0x000000F0) { uMagnitude +=  4; uValue >>=  4; }
+    if(uValue & 0x0000000C) { uMagnitude +=  2; uValue >>=  2; }
+    if(uValue & 0x00000002) { uMagnitude +=  1; }
+
+    return ((uMagnitude - OPCUA_LATENCY_SUBBUCKET_BITS + 1) << OPCUA_LATENCY_SUBBUCKET_BITS)
+         + ((a_uValue >> (uMagnitude - OPCUA_LATENCY_SUBBUCKET_BITS)) & (OPCUA_LATENCY_SUBBUCKETS - 1));
+}
+
+/*============================================================================
+ * OpcUa_Latency_BucketValue
+ *===========================================================================*/
+/* returns the largest value which falls into the given bucket */
+static OpcUa_UInt32 OpcUa_Latency_BucketValue(OpcUa_UInt32 a_uIndex)
+{
+    OpcUa_UInt32 uShift = 0;
+
+    if(a_uIndex < OPCUA_LATENCY_SUBBUCKETS)
+    {
+        return a_uIndex;
+    }
+
+    uShift = (a_uIndex >> OPCUA_LATENCY_SUBBUCKET_BITS) - 1;
+
+    return ((OpcUa_UInt32)(OPCUA_LATENCY_SUBBUCKETS + (a_uIndex & (OPCUA_LATENCY_SUBBUCKETS - 1))) << uShift)
+         + (((OpcUa_UInt32)1 << uShift) - 1);
+}
+
+/*============================================================================
+ * OpcUa_Latency_GetServiceSlot
+ *===========================================================================*/
+/* finds or claims the slot of a service type; returns OPCUA_LATENCY_MAXSERVICES if none is left */
+static OpcUa_UInt32 OpcUa_Latency_GetServiceSlot(   OpcUa_UInt32    a_uServiceTypeId,
+                                                    OpcUa_Boolean   a_bClaim)
+{
+    OpcUa_UInt32 uCount = 0;
+    OpcUa_UInt32 uSlot  = a_uServiceTypeId % OPCUA_LATENCY_MAXSERVICES;
+
+    for(uCount = 0; uCount < OPCUA_LATENCY_MAXSERVICES; uCount++)
+    {
+        OpcUa_UInt32 uTypeId = OpcUa_Atomic_Load32(&OpcUa_Latency_s_auServiceTypeIds[uSlot]);
+
+        if(uTypeId == a_uServiceTypeId)
+        {
+            return uSlot;
+        }
+
+        if(uTypeId == 0)
+        {
+            if(a_bClaim == OpcUa_False)
+            {
+                break;
+            }
+
+            if(OpcUa_Atomic_CompareExchange32(&OpcUa_Latency_s_auServiceTypeIds[uSlot], 0, a_uServiceTypeId))
+            {
+                return uSlot;
+            }
+
+            /* lost the race; the slot may have been claimed for the same type */
+            if(OpcUa_Atomic_Load32(&OpcUa_Latency_s_auServiceTypeIds[uSlot]) == a_uServiceTypeId)
+            {
+                return uSlot;
+            }
+        }
+
+        uSlot = (uSlot + 1) % OPCUA_LATENCY_MAXSERVICES;
+    }
+
+    return OPCUA_LATENCY_MAXSERVICES;
+}
+
+/*============================================================================
+ * OpcUa_Latency_GetThreadRecorder
+ *===========================================================================*/
+static OpcUa_LatencyRecorder* OpcUa_Latency_GetThreadRecorder(OpcUa_Void)
+{
+    OpcUa_UInt32            uGeneration = OpcUa_Atomic_Load32(&OpcUa_Latency_s_uGeneration);
+    OpcUa_LatencyRecorder*  pRecorder   = OpcUa_Null;
+    OpcUa_UInt32            uIndex      = 0;
+
+    if(OpcUa_Likely(OpcUa_Latency_s_uThreadGeneration == uGeneration))
+    {
+        return OpcUa_Latency_s_pThreadRecorder;
+    }
+
+    /* first sample of this thread in the current generation; done once per thread */
+#if OPCUA_USE_SYNCHRONISATION
+    OPCUA_P_MUTEX_LOCK(OpcUa_Latency_s_hLock);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+    uIndex = OpcUa_Latency_s_uNoOfRecorders;
+
+    if(uIndex < OPCUA_LATENCY_MAXTHREADS)
+    {
+        pRecorder = (OpcUa_LatencyRecorder*)OpcUa_Alloc(sizeof(OpcUa_LatencyRecorder));
+
+        if(pRecorder != OpcUa_Null)
+        {
+            OpcUa_MemSet(pRecorder, 0, sizeof(OpcUa_LatencyRecorder));
+            pRecorder->Epoch = OpcUa_Atomic_Load32(&OpcUa_Latency_s_uEpoch);
+            OpcUa_Latency_s_apRecorders[uIndex] = pRecorder;
+            OpcUa_Atomic_Store32(&OpcUa_Latency_s_uNoOfRecorders, uIndex + 1);
+        }
+    }
+
+#if OPCUA_USE_SYNCHRONISATION
+    OPCUA_P_MUTEX_UNLOCK(OpcUa_Latency_s_hLock);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+    /* threads without recorder drop their samples for the rest of this generation */
+    OpcUa_Latency_s_pThreadRecorder     = pRecorder;
+    OpcUa_Latency_s_uThreadGeneration   = uGeneration;
+
+    return pRecorder;
+}
+
+/*============================================================================
+ * OpcUa_Latency_AddSample
+ *===========================================================================*/
+static OpcUa_Void OpcUa_Latency_AddSample(  OpcUa_LatencyHistogram* a_pHistogram,
+                                            OpcUa_UInt32            a_uElapsed)
+{
+    /* only the owning thread writes; readers accept a snapshot torn between buckets */
+    a_pHistogram->Buckets[OpcUa_Latency_BucketIndex(a_uElapsed)]++;
+    a_pHistogram->Sum += a_uElapsed;
+}
+
+/*============================================================================
+ * OpcUa_Latency_Now
+ *===========================================================================*/
+OpcUa_UInt64 OpcUa_Latency_Now(OpcUa_Void)
+{
+    return OpcUa_P_GetMicroTickCount();
+}
+
+/*============================================================================
+ * OpcUa_Latency_RecordSample
+ *===========================================================================*/
+static OpcUa_Void OpcUa_Latency_RecordSample(   OpcUa_LatencyRecorder*  a_pRecorder,
+                                                OpcUa_LatencyStage      a_eStage,
+                                                OpcUa_UInt32            a_uServiceTypeId,
+                                                OpcUa_UInt32            a_uElapsed)
+{
+    OpcUa_UInt32 uEpoch = OpcUa_Atomic_Load32(&OpcUa_Latency_s_uEpoch);
+    OpcUa_UInt32 uSlot  = 0;
+
+    /* drop the samples of the previous epoch after a reset; only the owner writes */
+    if(OpcUa_Unlikely(a_pRecorder->Epoch != uEpoch))
+    {
+        OpcUa_MemSet(&a_pRecorder->Total, 0, sizeof(OpcUa_LatencyStages));
+
+        for(uSlot = 0; uSlot < OPCUA_LATENCY_MAXSERVICES; uSlot++)
+        {
+            if(a_pRecorder->Services[uSlot] != OpcUa_Null)
+            {
+                OpcUa_MemSet(a_pRecorder->Services[uSlot], 0, sizeof(OpcUa_LatencyStages));
+            }
+        }
+
+        OpcUa_Atomic_Store32(&a_pRecorder->Epoch, uEpoch);
+    }
+
+    OpcUa_Latency_AddSample(&a_pRecorder->Total.Stages[a_eStage], a_uElapsed);
+
+    if(a_uServiceTypeId == 0)
+    {
+        return;
+    }
+
+    uSlot = OpcUa_Latency_GetServiceSlot(a_uServiceTypeId, OpcUa_True);
+
+    if(uSlot == OPCUA_LATENCY_MAXSERVICES)
+    {
+        return;
+    }
+
+    if(OpcUa_Unlikely(a_pRecorder->Services[uSlot] == OpcUa_Null))
+    {
+        OpcUa_LatencyStages* pStages = (OpcUa_LatencyStages*)OpcUa_Alloc(sizeof(OpcUa_LatencyStages));
+
+        if(pStages == OpcUa_Null)
+        {
+            return;
+        }
+
+        OpcUa_MemSet(pStages, 0, sizeof(OpcUa_LatencyStages));
+        OpcUa_Atomic_StorePtr(&a_pRecorder->Services[uSlot], pStages);
+    }
+
+    OpcUa_Latency_AddSample(&a_pRecorder->Services[uSlot]->Stages[a_eStage], a_uElapsed);
+}
+
+/*============================================================================
+ * OpcUa_Latency_Record
+ *===========================================================================*/
+OpcUa_Void OpcUa_Latency_Record(OpcUa_LatencyStage  a_eStage,
+                                OpcUa_UInt32        a_uServiceTypeId,
+                                OpcUa_UInt64        a_uStartTime)
+{
+    OpcUa_LatencyRecorder*  pRecorder   = OpcUa_Null;
+    OpcUa_UInt64            uNow        = OpcUa_Latency_Now();
+    OpcUa_UInt32            uElapsed    = 0;
+
+    if((OpcUa_UInt32)a_eStage >= OpcUa_LatencyStage_Count)
+    {
+        return;
+    }
+
+    /* start times not taken by OpcUa_Latency_Now count as zero */
+    if(uNow > a_uStartTime)
+    {
+        uElapsed = (uNow - a_uStartTime > (OpcUa_UInt64)OpcUa_UInt32_Max)?OpcUa_UInt32_Max:(OpcUa_UInt32)(uNow - a_uStartTime);
+    }
+
+    /* OpcUa_Latency_Clear waits until no caller is left in here before it frees the recorders */
+    OpcUa_Atomic_Add32(&OpcUa_Latency_s_uCallers, 1);
+
+    if(OpcUa_Atomic_Load32(&OpcUa_Latency_s_bActive) != 0)
+    {
+        pRecorder = OpcUa_Latency_GetThreadRecorder();
+
+        if(pRecorder != OpcUa_Null)
+        {
+            OpcUa_Latency_RecordSample(pRecorder, a_eStage, a_uServiceTypeId, uElapsed);
+        }
+    }
+
+    OpcUa_Atomic_Add32(&OpcUa_Latency_s_uCallers, (OpcUa_UInt32)-1);
+}
+
+/*============================================================================
+ * OpcUa_Latency_Enable
+ *===========================================================================*/
+OpcUa_Void OPCUA_DLLCALL OpcUa_Latency_Enable(OpcUa_Boolean a_bEnable)
+{
+    OpcUa_Atomic_Store32(&OpcUa_Latency_g_bEnabled, (a_bEnable != OpcUa_False)?1:0);
+}
+
+/*============================================================================
+ * OpcUa_Latency_Reset
+ *===========================================================================*/
+OpcUa_Void OPCUA_DLLCALL OpcUa_Latency_Reset(OpcUa_Void)
+{
+    OpcUa_Atomic_Add32(&OpcUa_Latency_s_uEpoch, 1);
+}
+
+/*============================================================================
+ * OpcUa_Latency_GetSummary
+ *===========================================================================*/
+OpcUa_StatusCode OPCUA_DLLCALL OpcUa_Latency_GetSummary(OpcUa_LatencyStage      a_eStage,
+                                                        OpcUa_UInt32            a_uServiceTypeId,
+                                                        OpcUa_LatencySummary*   a_pSummary)
+{
+    OpcUa_UInt64    auCounts[OPCUA_LATENCY_BUCKETS];
+    OpcUa_UInt64    auRanks[3];
+    OpcUa_UInt32*   apuPercentiles[3];
+    OpcUa_UInt64    uCumulated      = 0;
+    OpcUa_UInt32    uSlot           = OPCUA_LATENCY_MAXSERVICES;
+    OpcUa_UInt32    uNoOfRecorders  = 0;
+    OpcUa_UInt32    uEpoch          = 0;
+    OpcUa_UInt32    uIndex          = 0;
+    OpcUa_UInt32    uBucket         = 0;
+    OpcUa_UInt32    uNext           = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_Latency, "GetSummary");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_pSummary);
+    OpcUa_ReturnErrorIfTrue((OpcUa_UInt32)a_eStage >= OpcUa_LatencyStage_Count, OpcUa_BadInvalidArgument);
+
+    OpcUa_MemSet(a_pSummary, 0, sizeof(OpcUa_LatencySummary));
+    OpcUa_MemSet(auCounts, 0, sizeof(auCounts));
+
+    if(a_uServiceTypeId != 0)
+    {
+        uSlot = OpcUa_Latency_GetServiceSlot(a_uServiceTypeId, OpcUa_False);
+        OpcUa_ReturnErrorIfTrue(uSlot == OPCUA_LATENCY_MAXSERVICES, OpcUa_BadNotFound);
+    }
+
+    /* merge the histograms of all threads */
+    uEpoch          = OpcUa_Atomic_Load32(&OpcUa_Latency_s_uEpoch);
+    uNoOfRecorders  = OpcUa_Atomic_Load32(&OpcUa_Latency_s_uNoOfRecorders);
+
+    for(uIndex = 0; uIndex < uNoOfRecorders; uIndex++)
+    {
+        OpcUa_LatencyRecorder*  pRecorder   = OpcUa_Latency_s_apRecorders[uIndex];
+        OpcUa_LatencyHistogram* pHistogram  = OpcUa_Null;
+
+        if(pRecorder == OpcUa_Null || OpcUa_Atomic_Load32(&pRecorder->Epoch) != uEpoch)
+        {
+            continue;
+        }
+
+        if(uSlot == OPCUA_LATENCY_MAXSERVICES)
+        {
+            pHistogram = &pRecorder->Total.Stages[a_eStage];
+        }
+        else
+        {
+            OpcUa_LatencyStages* pStages = (OpcUa_LatencyStages*)OpcUa_Atomic_LoadPtr(&pRecorder->Services[uSlot]);
+
+            if(pStages == OpcUa_Null)
+            {
+                continue;
+            }
+
+            pHistogram = &pStages->Stages[a_eStage];
+        }
+
+        for(uBucket = 0; uBucket < OPCUA_LATENCY_BUCKETS; uBucket++)
+        {
+            auCounts[uBucket] += OpcUa_Atomic_Load32(&pHistogram->Buckets[uBucket]);
+        }
+
+        a_pSummary->Sum += OpcUa_Atomic_Load64(&pHistogram->Sum);
+    }
+
+    for(uBucket = 0; uBucket < OPCUA_LATENCY_BUCKETS; uBucket++)
+    {
+        a_pSummary->Count += auCounts[uBucket];
+    }
+
+    if(a_pSummary->Count == 0)
+    {
+        OpcUa_ReturnStatusCode;
+    }
+
+    /* smallest ranks which cover 50%, 99% and 99.9% of the samples */
+    auRanks[0] = (a_pSummary->Count * 500 + 999) / 1000;
+    auRanks[1] = (a_pSummary->Count * 990 + 999) / 1000;
+    auRanks[2] = (a_pSummary->Count * 999 + 999) / 1000;
+    apuPercentiles[0] = &a_pSummary->P50;
+    apuPercentiles[1] = &a_pSummary->P99;
+    apuPercentiles[2] = &a_pSummary->P999;
+
+    for(uBucket = 0; uBucket < OPCUA_LATENCY_BUCKETS; uBucket++)
+    {
+        if(auCounts[uBucket] == 0)
+        {
+            continue;
+        }
+
+        uCumulated += auCounts[uBucket];
+
+        while(uNext < 3 && uCumulated >= auRanks[uNext])
+        {
+            *apuPercentiles[uNext++] = OpcUa_Latency_BucketValue(uBucket);
+        }
+
+        a_pSummary->Max = OpcUa_Latency_BucketValue(uBucket);
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * OpcUa_Latency_GetServiceTypeIds
+ *===========================================================================*/
+OpcUa_StatusCode OPCUA_DLLCALL OpcUa_Latency_GetServiceTypeIds( OpcUa_UInt32    a_uMaxServiceTypeIds,
+                                                                OpcUa_UInt32*   a_pServiceTypeIds,
+                                                                OpcUa_UInt32*   a_pNoOfServiceTypeIds)
+{
+    OpcUa_UInt32 uSlot = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_Latency, "GetServiceTypeIds");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_pNoOfServiceTypeIds);
+    *a_pNoOfServiceTypeIds = 0;
+
+    if(a_uMaxServiceTypeIds > 0)
+    {
+        OpcUa_ReturnErrorIfArgumentNull(a_pServiceTypeIds);
+    }
+
+    for(uSlot = 0; uSlot < OPCUA_LATENCY_MAXSERVICES; uSlot++)
+    {
+        OpcUa_UInt32 uTypeId = OpcUa_Atomic_Load32(&OpcUa_Latency_s_auServiceTypeIds[uSlot]);
+
+        if(uTypeId == 0)
+        {
+            continue;
+        }
+
+        OpcUa_ReturnErrorIfTrue(*a_pNoOfServiceTypeIds == a_uMaxServiceTypeIds, OpcUa_BadEncodingLimitsExceeded);
+
+        a_pServiceTypeIds[(*a_pNoOfServiceTypeIds)++] = uTypeId;
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * OpcUa_Latency_Initialize
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_Latency_Initialize(OpcUa_Void)
+{
+OpcUa_InitializeStatus(OpcUa_Module_Latency, "Initialize");
+
+#if OPCUA_USE_SYNCHRONISATION
+    if(OpcUa_Latency_s_hLock == OpcUa_Null)
+    {
+        uStatus = OPCUA_P_MUTEX_CREATE(&OpcUa_Latency_s_hLock);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+    OpcUa_Atomic_Store32(&OpcUa_Latency_s_bActive, 1);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * OpcUa_Latency_Clear
+ *===========================================================================*/
+OpcUa_Void OpcUa_Latency_Clear(OpcUa_Void)
+{
+    OpcUa_UInt32 uIndex = 0;
+    OpcUa_UInt32 uSlot  = 0;
+
+    /* turn away new samples and wait for the threads still recording */
+    OpcUa_Atomic_Store32(&OpcUa_Latency_s_bActive, 0);
+    OpcUa_Atomic_MemoryBarrier();
+
+#if OPCUA_MULTITHREADED
+    while(OpcUa_Atomic_Load32(&OpcUa_Latency_s_uCallers) != 0)
+    {
+        OpcUa_Thread_Sleep(0);
+    }
+#endif /* OPCUA_MULTITHREADED */
+
+#if OPCUA_USE_SYNCHRONISATION
+    if(OpcUa_Latency_s_hLock != OpcUa_Null)
+    {
+        OPCUA_P_MUTEX_LOCK(OpcUa_Latency_s_hLock);
+    }
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+    /* threads pick up a new recorder on their next sample */
+    OpcUa_Atomic_Add32(&OpcUa_Latency_s_uGeneration, 1);
+
+    for(uIndex = 0; uIndex < OpcUa_Latency_s_uNoOfRecorders; uIndex++)
+    {
+        OpcUa_LatencyRecorder* pRecorder = OpcUa_Latency_s_apRecorders[uIndex];
+
+        for(uSlot = 0; uSlot < OPCUA_LATENCY_MAXSERVICES; uSlot++)
+        {
+            if(pRecorder->Services[uSlot] != OpcUa_Null)
+            {
+                OpcUa_Free(pRecorder->Services[uSlot]);
+            }
+        }
+
+        OpcUa_Free(pRecorder);
+        OpcUa_Latency_s_apRecorders[uIndex] = OpcUa_Null;
+    }
+
+    OpcUa_Latency_s_uNoOfRecorders = 0;
+    OpcUa_MemSet(OpcUa_Latency_s_auServiceTypeIds, 0, sizeof(OpcUa_Latency_s_auServiceTypeIds));
+
+#if OPCUA_USE_SYNCHRONISATION
+    if(OpcUa_Latency_s_hLock != OpcUa_Null)
+    {
+        OPCUA_P_MUTEX_UNLOCK(OpcUa_Latency_s_hLock);
+        OPCUA_P_MUTEX_DELETE(&OpcUa_Latency_s_hLock);
+    }
+#endif /* OPCUA_USE_SYNCHRONISATION */
+}
+
+#endif /* OPCUA_HAVE_LATENCYSTATISTICS */
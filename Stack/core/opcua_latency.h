@@ -0,0 +1,149 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#ifndef _OpcUa_Latency_H_
+#define _OpcUa_Latency_H_ 1
+
+#ifdef OPCUA_HAVE_LATENCYSTATISTICS
+
+OPCUA_BEGIN_EXTERN_C
+
+/**
+ * @brief The stages of the request pipeline with own latency histograms.
+ */
+typedef enum _OpcUa_LatencyStage
+{
+    /** @brief Processing of a socket read event by the tcp stream (OpcUa_TcpStream_DataReady). */
+    OpcUa_LatencyStage_TransportReceive = 0,
+    /** @brief Signature verification and decryption of a received chunk. */
+    OpcUa_LatencyStage_SecureReceive    = 1,
+    /** @brief Decoding of the request message. */
+    OpcUa_LatencyStage_Decode           = 2,
+    /** @brief Service handler from BeginProcessRequest until EndSendResponse. */
+    OpcUa_LatencyStage_Service          = 3,
+    /** @brief Encoding of the response message. */
+    OpcUa_LatencyStage_Encode           = 4,
+    /** @brief Signing, encryption and sending of the response. */
+    OpcUa_LatencyStage_SecureSend       = 5,
+    /** @brief Number of stages; not a valid stage. */
+    OpcUa_LatencyStage_Count            = 6
+} OpcUa_LatencyStage;
+
+/**
+ * @brief Summary of a latency histogram. All times are in microseconds.
+ *
+ * Percentiles and the maximum are taken from the histogram buckets and
+ * are exact to 1/8 of the value (or 1 microsecond below 8 microseconds).
+ */
+typedef struct _OpcUa_LatencySummary
+{
+    /** @brief Number of samples. */
+    OpcUa_UInt64    Count;
+    /** @brief Sum of all samples. */
+    OpcUa_UInt64    Sum;
+    /** @brief Median. */
+    OpcUa_UInt32    P50;
+    /** @brief 99th percentile. */
+    OpcUa_UInt32    P99;
+    /** @brief 99.9th percentile. */
+    OpcUa_UInt32    P999;
+    /** @brief Largest sample. */
+    OpcUa_UInt32    Max;
+} OpcUa_LatencySummary;
+
+/**
+ * @brief Enables or disables the recording. Disabled recording costs one predicted branch per stage.
+ */
+OPCUA_EXPORT OpcUa_Void         OPCUA_DLLCALL OpcUa_Latency_Enable(             OpcUa_Boolean           bEnable);
+
+/**
+ * @brief Discards all samples recorded so far.
+ */
+OPCUA_EXPORT OpcUa_Void         OPCUA_DLLCALL OpcUa_Latency_Reset(              OpcUa_Void);
+
+/**
+ * @brief Merges the histograms of all threads and returns the summary of a stage.
+ *
+ * @param eStage            [in]  The stage of the request pipeline.
+ * @param uServiceTypeId    [in]  The request type id of the service or 0 for all requests.
+ *                                The receive stages precede decoding and are only available for 0.
+ * @param pSummary          [out] The merged summary.
+ */
+OPCUA_EXPORT OpcUa_StatusCode   OPCUA_DLLCALL OpcUa_Latency_GetSummary(         OpcUa_LatencyStage      eStage,
+                                                                                OpcUa_UInt32            uServiceTypeId,
+                                                                                OpcUa_LatencySummary*   pSummary);
+
+/**
+ * @brief Returns the request type ids of the services with own histograms.
+ *
+ * @param uMaxServiceTypeIds    [in]  Capacity of pServiceTypeIds.
+ * @param pServiceTypeIds       [out] Receives the request type ids.
+ * @param pNoOfServiceTypeIds   [out] Number of ids written.
+ */
+OPCUA_EXPORT OpcUa_StatusCode   OPCUA_DLLCALL OpcUa_Latency_GetServiceTypeIds(  OpcUa_UInt32            uMaxServiceTypeIds,
+                                                                                OpcUa_UInt32*           pServiceTypeIds,
+                                                                                OpcUa_UInt32*           pNoOfServiceTypeIds);
+
+/*============================================================================
+ * Internal interface used by the stack.
+ *===========================================================================*/
+/** @brief Set by OpcUa_Latency_Enable; checked inline before taking timestamps. */
+OPCUA_IMEXPORT extern OpcUa_UInt32 OpcUa_Latency_g_bEnabled;
+
+/**
+ * @brief Initializes the latency statistics. Called by the proxystub.
+ */
+OpcUa_StatusCode    OpcUa_Latency_Initialize(   OpcUa_Void);
+
+/**
+ * @brief Frees all recorders. Called by the proxystub.
+ */
+OpcUa_Void          OpcUa_Latency_Clear(        OpcUa_Void);
+
+/**
+ * @brief Returns a monotonic timestamp in microseconds; unaffected by changes of the system time.
+ */
+OpcUa_UInt64        OpcUa_Latency_Now(          OpcUa_Void);
+
+/**
+ * @brief Adds the time elapsed since uStartTime to the histograms of the calling thread.
+ */
+OpcUa_Void          OpcUa_Latency_Record(       OpcUa_LatencyStage      eStage,
+                                                OpcUa_UInt32            uServiceTypeId,
+                                                OpcUa_UInt64            uStartTime);
+
+/**
+ * @brief Takes the start timestamp of a stage; 0 if recording is disabled.
+ */
+#define OpcUa_Latency_Begin() \
+    (OpcUa_Unlikely(OpcUa_Latency_g_bEnabled != 0)?OpcUa_Latency_Now():(OpcUa_UInt64)0)
+
+/**
+ * @brief Records a stage started with OpcUa_Latency_Begin.
+ */
+#define OpcUa_Latency_End(xStage, xServiceTypeId, xStartTime) \
+    do { if(OpcUa_Unlikely((xStartTime) != 0)) { OpcUa_Latency_Record((xStage), (xServiceTypeId), (xStartTime)); } } while(0)
+
+OPCUA_END_EXTERN_C
+
+#else /* OPCUA_HAVE_LATENCYSTATISTICS */
+
+#define OpcUa_Latency_Begin()                                   ((OpcUa_UInt64)0)
+#define OpcUa_Latency_End(xStage, xServiceTypeId, xStartTime)   OpcUa_ReferenceParameter(xStartTime)
+
+#endif /* OPCUA_HAVE_LATENCYSTATISTICS */
+
+#endif /* _OpcUa_Latency_H_ */
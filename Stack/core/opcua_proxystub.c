@@ -16,6 +16,7 @@
 
 #include <opcua_platformdefs.h>
 #include <opcua_trace.h>
+#include <opcua_latency.h>
 #include <opcua_socket.h>
 #include <opcua_timer.h>
 #include <opcua_memory.h>
@@ -31,7 +32,7 @@
 # define OPCUA_PROXYSTUB_STATICCONFIGSTRING "default"
 #endif /* OPCUA_PROXYSTUB_STATICCONFIGSTRING */
 
-#define OPCUA_CONFIG_STRING_SIZE    800
+#define OPCUA_CONFIG_STRING_SIZE    1024
 
 OpcUa_Port_CallTable*               OpcUa_ProxyStub_g_PlatformLayerCalltable;
 OpcUa_ProxyStubConfiguration        OpcUa_ProxyStub_g_Configuration;
@@ -109,6 +110,10 @@ OpcUa_InitializeStatus(OpcUa_Module_ProxyStub, "UpdateConfigString");
     if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
     iRes = OpcUa_SnPrintfA(&OpcUa_ProxyStub_g_pConfigString[iPos], OPCUA_CONFIG_STRING_SIZE - iPos, OPCUA_CONFIG_STRING_SIZE - iPos, "%s:%u\\", "uSecureListener_ThreadPool_Timeout", OpcUa_ProxyStub_g_Configuration.uSecureListener_ThreadPool_Timeout);
     if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
+    iRes = OpcUa_SnPrintfA(&OpcUa_ProxyStub_g_pConfigString[iPos], OPCUA_CONFIG_STRING_SIZE - iPos, OPCUA_CONFIG_STRING_SIZE - iPos, "%s:%i\\", "iSecureListener_CryptoPool_Threads", OpcUa_ProxyStub_g_Configuration.iSecureListener_CryptoPool_Threads);
+    if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
+    iRes = OpcUa_SnPrintfA(&OpcUa_ProxyStub_g_pConfigString[iPos], OPCUA_CONFIG_STRING_SIZE - iPos, OPCUA_CONFIG_STRING_SIZE - iPos, "%s:%i\\", "iSecureListener_CryptoPool_MaxJobs", OpcUa_ProxyStub_g_Configuration.iSecureListener_CryptoPool_MaxJobs);
+    if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
     iRes = OpcUa_SnPrintfA(&OpcUa_ProxyStub_g_pConfigString[iPos], OPCUA_CONFIG_STRING_SIZE - iPos, OPCUA_CONFIG_STRING_SIZE - iPos, "%s:%u\\", "bTcpListener_ClientThreadsEnabled", (OpcUa_ProxyStub_g_Configuration.bTcpListener_ClientThreadsEnabled != 0)?1:0);
     if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
     iRes = OpcUa_SnPrintfA(&OpcUa_ProxyStub_g_pConfigString[iPos], OPCUA_CONFIG_STRING_SIZE - iPos, OPCUA_CONFIG_STRING_SIZE - iPos, "%s:%i\\", "iTcpListener_DefaultChunkSize", OpcUa_ProxyStub_g_Configuration.iTcpListener_DefaultChunkSize);
@@ -121,6 +126,8 @@ OpcUa_InitializeStatus(OpcUa_Module_ProxyStub, "UpdateConfigString");
     if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
     iRes = OpcUa_SnPrintfA(&OpcUa_ProxyStub_g_pConfigString[iPos], OPCUA_CONFIG_STRING_SIZE - iPos, OPCUA_CONFIG_STRING_SIZE - iPos, "%s:%u\\", "bTcpStream_ExpectWriteToBlock", (OpcUa_ProxyStub_g_Configuration.bTcpStream_ExpectWriteToBlock != 0)?1:0);
     if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
+    iRes = OpcUa_SnPrintfA(&OpcUa_ProxyStub_g_pConfigString[iPos], OPCUA_CONFIG_STRING_SIZE - iPos, OPCUA_CONFIG_STRING_SIZE - iPos, "%s:%i\\", "iHttpsTransport_MaxPipelinedRequests", OpcUa_ProxyStub_g_Configuration.iHttpsTransport_MaxPipelinedRequests);
+    if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
 
 #else /* OPCUA_USE_SAFE_FUNCTIONS */
 
@@ -152,6 +159,10 @@ OpcUa_InitializeStatus(OpcUa_Module_ProxyStub, "UpdateConfigString");
     if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
     iRes = OpcUa_SnPrintfA(&OpcUa_ProxyStub_g_pConfigString[iPos], OPCUA_CONFIG_STRING_SIZE - iPos, "%s:%u\\", "uSecureListener_ThreadPool_Timeout", OpcUa_ProxyStub_g_Configuration.uSecureListener_ThreadPool_Timeout);
     if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
+    iRes = OpcUa_SnPrintfA(&OpcUa_ProxyStub_g_pConfigString[iPos], OPCUA_CONFIG_STRING_SIZE - iPos, "%s:%i\\", "iSecureListener_CryptoPool_Threads", OpcUa_ProxyStub_g_Configuration.iSecureListener_CryptoPool_Threads);
+    if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
+    iRes = OpcUa_SnPrintfA(&OpcUa_ProxyStub_g_pConfigString[iPos], OPCUA_CONFIG_STRING_SIZE - iPos, "%s:%i\\", "iSecureListener_CryptoPool_MaxJobs", OpcUa_ProxyStub_g_Configuration.iSecureListener_CryptoPool_MaxJobs);
+    if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
     iRes = OpcUa_SnPrintfA(&OpcUa_ProxyStub_g_pConfigString[iPos], OPCUA_CONFIG_STRING_SIZE - iPos, "%s:%u\\", "bTcpListener_ClientThreadsEnabled", (OpcUa_ProxyStub_g_Configuration.bTcpListener_ClientThreadsEnabled != 0)?1:0);
     if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
     iRes = OpcUa_SnPrintfA(&OpcUa_ProxyStub_g_pConfigString[iPos], OPCUA_CONFIG_STRING_SIZE - iPos, "%s:%i\\", "iTcpListener_DefaultChunkSize", OpcUa_ProxyStub_g_Configuration.iTcpListener_DefaultChunkSize);
@@ -164,6 +175,8 @@ OpcUa_InitializeStatus(OpcUa_Module_ProxyStub, "UpdateConfigString");
     if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
     iRes = OpcUa_SnPrintfA(&OpcUa_ProxyStub_g_pConfigString[iPos], OPCUA_CONFIG_STRING_SIZE - iPos, "%s:%u\\", "bTcpStream_ExpectWriteToBlock", (OpcUa_ProxyStub_g_Configuration.bTcpStream_ExpectWriteToBlock != 0)?1:0);
     if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
+    iRes = OpcUa_SnPrintfA(&OpcUa_ProxyStub_g_pConfigString[iPos], OPCUA_CONFIG_STRING_SIZE - iPos, "%s:%i\\", "iHttpsTransport_MaxPipelinedRequests", OpcUa_ProxyStub_g_Configuration.iHttpsTransport_MaxPipelinedRequests);
+    if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
 
 #endif /* OPCUA_USE_SAFE_FUNCTIONS */
 
@@ -243,6 +256,24 @@ OpcUa_InitializeStatus(OpcUa_Module_ProxyStub, "ReInitialize");
     {
         OpcUa_ProxyStub_g_Configuration.iTcpTransport_MaxMessageLength           = OPCUA_ENCODER_MAXMESSAGELENGTH;
     }
+    if(OpcUa_ProxyStub_g_Configuration.iHttpsTransport_MaxPipelinedRequests == -1)
+    {
+        OpcUa_ProxyStub_g_Configuration.iHttpsTransport_MaxPipelinedRequests     = OPCUA_HTTPS_MAX_PIPELINED_REQUESTS;
+    }
+
+    if(OpcUa_ProxyStub_g_Configuration.iSecureListener_CryptoPool_Threads == -1)
+    {
+        OpcUa_ProxyStub_g_Configuration.iSecureListener_CryptoPool_Threads       = OPCUA_SECURELISTENER_CRYPTOPOOL_THREADS;
+    }
+
+    if(OpcUa_ProxyStub_g_Configuration.iSecureListener_CryptoPool_MaxJobs == -1)
+    {
+        OpcUa_ProxyStub_g_Configuration.iSecureListener_CryptoPool_MaxJobs       = OPCUA_SECURELISTENER_CRYPTOPOOL_MAXJOBS;
+    }
+
+#if OPCUA_TRACE_ENABLE
+    OpcUa_Trace_UpdateActiveLevels();
+#endif /* OPCUA_TRACE_ENABLE */
 
 #if OPCUA_USE_SYNCHRONISATION
     OPCUA_P_MUTEX_UNLOCK(OpcUa_ProxyStub_g_hGlobalsMutex);
@@ -310,6 +341,11 @@ OpcUa_InitializeStatus(OpcUa_Module_ProxyStub, "Initialize");
         OpcUa_Trace(OPCUA_TRACE_LEVEL_INFO, "OpcUa_ProxyStub_Initialize: Tracer has been initialized!\n");
 #endif /* OPCUA_TRACE_ENABLE */
 
+#ifdef OPCUA_HAVE_LATENCYSTATISTICS
+        uStatus = OpcUa_Latency_Initialize();
+        OpcUa_GotoErrorIfBad(uStatus);
+#endif /* OPCUA_HAVE_LATENCYSTATISTICS */
+
         /* initialize networking. */
         OpcUa_Trace(OPCUA_TRACE_LEVEL_INFO, "OpcUa_ProxyStub_Initialize: Network Module...\n");
         uStatus = OPCUA_P_INITIALIZENETWORK();
@@ -381,6 +417,10 @@ OpcUa_Void OPCUA_DLLCALL OpcUa_ProxyStub_Clear(OpcUa_Void)
 #endif /* OPCUA_USE_SYNCHRONISATION */
             OpcUa_Trace(OPCUA_TRACE_LEVEL_INFO, "OpcUa_ProxyStub_Clear: Network Module done!\n");
 
+#ifdef OPCUA_HAVE_LATENCYSTATISTICS
+            OpcUa_Latency_Clear();
+#endif /* OPCUA_HAVE_LATENCYSTATISTICS */
+
 #if OPCUA_TRACE_ENABLE
             /* internal resource */
             OpcUa_Trace_Clear();
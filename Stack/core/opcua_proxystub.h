@@ -77,6 +77,11 @@ typedef struct _OpcUa_ProxyStubConfiguration
     /** If the add operation blocks on a full job queue, this value sets the max waiting time. */
     OpcUa_UInt32    uSecureListener_ThreadPool_Timeout;
 
+    /** The number of threads doing the asymmetric OpenSecureChannel work. 0 keeps it in the receiving thread. */
+    OpcUa_Int32     iSecureListener_CryptoPool_Threads;
+    /** The number of OpenSecureChannel requests waiting for a crypto thread. Further requests close their connection. */
+    OpcUa_Int32     iSecureListener_CryptoPool_MaxJobs;
+
     /** If true, the TcpListener request a thread per client from the underlying socketmanager. Must not work with all platform layers. */
     OpcUa_Boolean   bTcpListener_ClientThreadsEnabled;
     /** The default and maximum size for message chunks in the server. Affects network performance and memory usage. */
@@ -92,6 +97,9 @@ typedef struct _OpcUa_ProxyStubConfiguration
 
     /** The network stream should block if not all could be send in one go. Be careful and use this only with client threads. Must not work with all platform layers. */
     OpcUa_Boolean   bTcpStream_ExpectWriteToBlock;
+
+    /** The maximum number of requests in flight on one https connection. Responses are matched in request order. 1 disables pipelining. */
+    OpcUa_Int32     iHttpsTransport_MaxPipelinedRequests;
 } OpcUa_ProxyStubConfiguration;
 
 /*============================================================================
@@ -67,6 +67,9 @@ OpcUa_Void InternalThreadMain(OpcUa_Void* a_Thread)
     /* call the user function */
     Thread->ThreadMain(Thread->ThreadData);
 
+    /* the trace buffer of this thread can serve the next one */
+    OpcUa_Trace_ReleaseThread();
+
     OPCUA_P_MUTEX_LOCK(Thread->Mutex);
     Thread->IsRunning = OpcUa_False;
     OPCUA_P_SEMAPHORE_POST(Thread->ShutdownEvent, 1);
@@ -17,13 +17,17 @@
 #include <opcua.h>
 
 #include <opcua_mutex.h>
+#include <opcua_semaphore.h>
 #include <opcua_thread.h>
+#include <opcua_datetime.h>
 
 #include <opcua_trace.h>
 
 #define OPCUA_P_TRACE               OpcUa_ProxyStub_g_PlatformLayerCalltable->Trace
 #define OPCUA_P_TRACE_INITIALIZE    OpcUa_ProxyStub_g_PlatformLayerCalltable->TraceInitialize
 #define OPCUA_P_TRACE_CLEAR         OpcUa_ProxyStub_g_PlatformLayerCalltable->TraceClear
+#define OPCUA_P_TRACE_RECORD        OpcUa_ProxyStub_g_PlatformLayerCalltable->TraceRecord
+#define OPCUA_P_THREAD_GETCURRENTID OpcUa_ProxyStub_g_PlatformLayerCalltable->ThreadGetCurrentId
 
 #define OPCUA_P_STRINGA_VSNPRINTF   OpcUa_ProxyStub_g_PlatformLayerCalltable->StrVsnPrintf
 
@@ -35,6 +39,14 @@
 */
 OpcUa_CharA OpcUa_Trace_g_aTraceBuffer[OPCUA_TRACE_MAXLENGTH];
 
+/*============================================================================
+ * Active Trace Levels
+ *===========================================================================*/
+/**
+* Trace levels checked at the trace call site.
+*/
+OpcUa_UInt32 OpcUa_Trace_g_uActiveLevels = OPCUA_TRACE_OUTPUT_LEVEL_NONE;
+
 /*============================================================================
  * Trace Lock
  *===========================================================================*/
@@ -45,6 +57,823 @@ OpcUa_CharA OpcUa_Trace_g_aTraceBuffer[OPCUA_TRACE_MAXLENGTH];
 OpcUa_Mutex OpcUa_Trace_s_pLock = OpcUa_Null;
 #endif /* OPCUA_USE_SYNCHRONISATION */
 
+#if OPCUA_TRACE_ENABLE
+/** @brief Set between OpcUa_Trace_Initialize and OpcUa_Trace_Clear. */
+static OpcUa_UInt32 OpcUa_Trace_s_bInitialized  = 0;
+/** @brief Number of threads inside OpcUa_Trace_Imp. */
+static OpcUa_UInt32 OpcUa_Trace_s_uCallers      = 0;
+#endif /* OPCUA_TRACE_ENABLE */
+
+
+/*============================================================================
+ * Asynchronous Trace
+ *===========================================================================*/
+#if OPCUA_TRACE_ENABLE && OPCUA_TRACE_ASYNC && OPCUA_MULTITHREADED
+#define OPCUA_TRACE_USE_ASYNC 1
+
+#if (OPCUA_TRACE_ASYNC_RECORDS & (OPCUA_TRACE_ASYNC_RECORDS - 1)) != 0
+#error OPCUA_TRACE_ASYNC_RECORDS must be a power of two!
+#endif
+
+#if OPCUA_TRACE_ASYNC_STRINGDATA < OPCUA_TRACE_MAXLENGTH
+#error OPCUA_TRACE_ASYNC_STRINGDATA must not be smaller than OPCUA_TRACE_MAXLENGTH!
+#endif
+
+/**
+* Captured value of a single format argument. The type is taken from the
+* conversion specification when the record gets formatted.
+*/
+typedef union _OpcUa_TraceArgument
+{
+    OpcUa_Int64     Int64;
+    OpcUa_Double    Double;
+    OpcUa_Void*     Pointer;
+    OpcUa_UInt32    StringOffset;
+} OpcUa_TraceArgument;
+
+/**
+* A single binary trace record. Only the format pointer and the arguments get
+* stored by the tracing thread; string arguments are copied into StringData.
+* If the format cannot be captured, the message is formatted into StringData
+* and Format is OpcUa_Null.
+*/
+typedef struct _OpcUa_TraceRecord
+{
+    OpcUa_CharA*        Format;
+#if OPCUA_TRACE_FILE_LINE_INFO
+    OpcUa_CharA*        File;
+    OpcUa_UInt32        Line;
+#endif /* OPCUA_TRACE_FILE_LINE_INFO */
+    OpcUa_UInt32        TraceLevel;
+    OpcUa_DateTime      Timestamp;
+    OpcUa_UInt32        NoOfArguments;
+    OpcUa_TraceArgument Arguments[OPCUA_TRACE_ASYNC_MAXARGUMENTS];
+    OpcUa_CharA         StringData[OPCUA_TRACE_ASYNC_STRINGDATA];
+} OpcUa_TraceRecord;
+
+/**
+* Single producer, single consumer ring of trace records owned by one thread.
+* Head is only written by the owning thread, Tail only by the trace writer.
+* When the owner ends, the ring is handed to the next thread which traces
+* for the first time once the writer has emptied it.
+*/
+typedef struct _OpcUa_TraceRing
+{
+    OpcUa_UInt32        Head;
+    OpcUa_UInt32        Tail;
+    OpcUa_UInt32        Dropped;
+    OpcUa_UInt32        InUse;
+    OpcUa_UInt64        ThreadId;
+    OpcUa_TraceRecord   Records[OPCUA_TRACE_ASYNC_RECORDS];
+} OpcUa_TraceRing;
+
+/** @brief The trace buffers of all threads which traced so far; never freed before OpcUa_Trace_Clear. */
+static OpcUa_TraceRing*             OpcUa_Trace_s_apRings[OPCUA_TRACE_ASYNC_MAXTHREADS];
+/** @brief Number of valid entries in OpcUa_Trace_s_apRings. */
+static OpcUa_UInt32                 OpcUa_Trace_s_uNoOfRings    = 0;
+/** @brief Incremented with every initialization; invalidates thread local ring references. */
+static OpcUa_UInt32                 OpcUa_Trace_s_uGeneration   = 0;
+/** @brief Set while the trace writer accepts records. */
+static OpcUa_UInt32                 OpcUa_Trace_s_bAsyncActive  = 0;
+/** @brief Set to stop the trace writer thread. */
+static OpcUa_UInt32                 OpcUa_Trace_s_bWriterStop   = 0;
+/** @brief The trace writer thread. */
+static OpcUa_Thread                 OpcUa_Trace_s_hWriterThread = OpcUa_Null;
+/** @brief Wakes up the trace writer before the flush interval elapsed. */
+static OpcUa_Semaphore              OpcUa_Trace_s_hWriterEvent  = OpcUa_Null;
+/** @brief Format buffer of the trace writer thread. */
+static OpcUa_CharA                  OpcUa_Trace_s_aWriterBuffer[OPCUA_TRACE_MAXLENGTH];
+
+/** @brief The trace buffer of the calling thread. */
+static OPCUA_P_THREAD_LOCAL OpcUa_TraceRing*    OpcUa_Trace_s_pThreadRing       = OpcUa_Null;
+/** @brief The generation OpcUa_Trace_s_pThreadRing belongs to. */
+static OPCUA_P_THREAD_LOCAL OpcUa_UInt32        OpcUa_Trace_s_uThreadGeneration = 0;
+
+/* length modifiers of a conversion specification */
+#define OPCUA_TRACE_LENGTH_NONE     0
+#define OPCUA_TRACE_LENGTH_CHAR     1
+#define OPCUA_TRACE_LENGTH_SHORT    2
+#define OPCUA_TRACE_LENGTH_LONG     3
+#define OPCUA_TRACE_LENGTH_LONGLONG 4
+#define OPCUA_TRACE_LENGTH_SIZE     5
+
+/**
+* Parsed conversion specification of a format string.
+*/
+typedef struct _OpcUa_TraceConversion
+{
+    const OpcUa_CharA*  Flags;
+    OpcUa_UInt32        NoOfFlags;
+    OpcUa_Boolean       WidthArgument;
+    OpcUa_Int32         Width;
+    OpcUa_Boolean       HasPrecision;
+    OpcUa_Boolean       PrecisionArgument;
+    OpcUa_Int32         Precision;
+    OpcUa_UInt32        Length;
+    OpcUa_CharA         Conversion;
+} OpcUa_TraceConversion;
+
+/*============================================================================
+ * OpcUa_Trace_ParseConversion
+ *===========================================================================*/
+/**
+* Parses the conversion specification following a '%' character.
+* Returns the position behind the specification.
+*/
+static const OpcUa_CharA* OpcUa_Trace_ParseConversion(  const OpcUa_CharA*     a_pFormat,
+                                                        OpcUa_TraceConversion* a_pConversion)
+{
+    OpcUa_MemSet(a_pConversion, 0, sizeof(OpcUa_TraceConversion));
+
+    a_pConversion->Flags = a_pFormat;
+    while(     *a_pFormat == '-' || *a_pFormat == '+' || *a_pFormat == ' '
+            || *a_pFormat == '#' || *a_pFormat == '0')
+    {
+        a_pFormat++;
+        a_pConversion->NoOfFlags++;
+    }
+
+    if(*a_pFormat == '*')
+    {
+        a_pConversion->WidthArgument = OpcUa_True;
+        a_pFormat++;
+    }
+    else
+    {
+        while(*a_pFormat >= '0' && *a_pFormat <= '9')
+        {
+            a_pConversion->Width = a_pConversion->Width * 10 + (*a_pFormat - '0');
+            a_pFormat++;
+        }
+    }
+
+    if(*a_pFormat == '.')
+    {
+        a_pConversion->HasPrecision = OpcUa_True;
+        a_pFormat++;
+
+        if(*a_pFormat == '*')
+        {
+            a_pConversion->PrecisionArgument = OpcUa_True;
+            a_pFormat++;
+        }
+        else
+        {
+            while(*a_pFormat >= '0' && *a_pFormat <= '9')
+            {
+                a_pConversion->Precision = a_pConversion->Precision * 10 + (*a_pFormat - '0');
+                a_pFormat++;
+            }
+        }
+    }
+
+    switch(*a_pFormat)
+    {
+    case 'h':
+        a_pFormat++;
+        a_pConversion->Length = OPCUA_TRACE_LENGTH_SHORT;
+        if(*a_pFormat == 'h')
+        {
+            a_pFormat++;
+            a_pConversion->Length = OPCUA_TRACE_LENGTH_CHAR;
+        }
+        break;
+    case 'l':
+        a_pFormat++;
+        a_pConversion->Length = OPCUA_TRACE_LENGTH_LONG;
+        if(*a_pFormat == 'l')
+        {
+            a_pFormat++;
+            a_pConversion->Length = OPCUA_TRACE_LENGTH_LONGLONG;
+        }
+        break;
+    case 'L':
+        a_pFormat++;
+        a_pConversion->Length = OPCUA_TRACE_LENGTH_LONGLONG;
+        break;
+    case 'z':
+    case 't':
+    case 'j':
+        a_pFormat++;
+        a_pConversion->Length = OPCUA_TRACE_LENGTH_SIZE;
+        break;
+    case 'I':
+        if(a_pFormat[1] == '6' && a_pFormat[2] == '4')
+        {
+            a_pFormat += 3;
+            a_pConversion->Length = OPCUA_TRACE_LENGTH_LONGLONG;
+        }
+        else if(a_pFormat[1] == '3' && a_pFormat[2] == '2')
+        {
+            a_pFormat += 3;
+        }
+        else
+        {
+            a_pFormat++;
+            a_pConversion->Length = OPCUA_TRACE_LENGTH_SIZE;
+        }
+        break;
+    default:
+        break;
+    }
+
+    a_pConversion->Conversion = *a_pFormat;
+
+    if(*a_pFormat != '\0')
+    {
+        a_pFormat++;
+    }
+
+    return a_pFormat;
+}
+
+/*============================================================================
+ * OpcUa_Trace_CaptureArguments
+ *===========================================================================*/
+/**
+* Stores the arguments of the given format into the record without formatting.
+* Returns OpcUa_False if the format contains unsupported conversions or too
+* many arguments; the record must be formatted in place in this case.
+*/
+static OpcUa_Boolean OpcUa_Trace_CaptureArguments(  OpcUa_TraceRecord*  a_pRecord,
+                                                    const OpcUa_CharA*  a_pFormat,
+                                                    varg_list           a_Arguments)
+{
+    OpcUa_TraceConversion   Conversion;
+    OpcUa_TraceArgument*    pArgument       = OpcUa_Null;
+    OpcUa_UInt32            uStringOffset   = 0;
+
+    a_pRecord->NoOfArguments = 0;
+
+    while(*a_pFormat != '\0')
+    {
+        if(*a_pFormat++ != '%')
+        {
+            continue;
+        }
+
+        if(*a_pFormat == '%')
+        {
+            a_pFormat++;
+            continue;
+        }
+
+        a_pFormat = OpcUa_Trace_ParseConversion(a_pFormat, &Conversion);
+
+        if(   a_pRecord->NoOfArguments
+            + (Conversion.WidthArgument?1:0)
+            + (Conversion.PrecisionArgument?1:0)
+            + 1 > OPCUA_TRACE_ASYNC_MAXARGUMENTS)
+        {
+            return OpcUa_False;
+        }
+
+        if(Conversion.WidthArgument != OpcUa_False)
+        {
+            a_pRecord->Arguments[a_pRecord->NoOfArguments++].Int64 = va_arg(a_Arguments, int);
+        }
+
+        if(Conversion.PrecisionArgument != OpcUa_False)
+        {
+            Conversion.Precision = va_arg(a_Arguments, int);
+            a_pRecord->Arguments[a_pRecord->NoOfArguments++].Int64 = Conversion.Precision;
+        }
+
+        pArgument = &a_pRecord->Arguments[a_pRecord->NoOfArguments++];
+
+        switch(Conversion.Conversion)
+        {
+        case 'd':
+        case 'i':
+            switch(Conversion.Length)
+            {
+            case OPCUA_TRACE_LENGTH_CHAR:       pArgument->Int64 = (signed char)va_arg(a_Arguments, int);   break;
+            case OPCUA_TRACE_LENGTH_SHORT:      pArgument->Int64 = (short)va_arg(a_Arguments, int);         break;
+            case OPCUA_TRACE_LENGTH_LONG:       pArgument->Int64 = va_arg(a_Arguments, long);               break;
+            case OPCUA_TRACE_LENGTH_LONGLONG:   pArgument->Int64 = va_arg(a_Arguments, OpcUa_Int64);        break;
+            case OPCUA_TRACE_LENGTH_SIZE:       pArgument->Int64 = (OpcUa_Int64)va_arg(a_Arguments, size_t);break;
+            default:                            pArgument->Int64 = va_arg(a_Arguments, int);                break;
+            }
+            break;
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            switch(Conversion.Length)
+            {
+            case OPCUA_TRACE_LENGTH_CHAR:       pArgument->Int64 = (unsigned char)va_arg(a_Arguments, int);     break;
+            case OPCUA_TRACE_LENGTH_SHORT:      pArgument->Int64 = (unsigned short)va_arg(a_Arguments, int);    break;
+            case OPCUA_TRACE_LENGTH_LONG:       pArgument->Int64 = (OpcUa_Int64)va_arg(a_Arguments, unsigned long); break;
+            case OPCUA_TRACE_LENGTH_LONGLONG:   pArgument->Int64 = (OpcUa_Int64)va_arg(a_Arguments, OpcUa_UInt64); break;
+            case OPCUA_TRACE_LENGTH_SIZE:       pArgument->Int64 = (OpcUa_Int64)va_arg(a_Arguments, size_t);    break;
+            default:                            pArgument->Int64 = va_arg(a_Arguments, unsigned int);           break;
+            }
+            break;
+        case 'c':
+            pArgument->Int64 = va_arg(a_Arguments, int);
+            break;
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            if(Conversion.Length == OPCUA_TRACE_LENGTH_LONGLONG)
+            {
+                pArgument->Double = (OpcUa_Double)va_arg(a_Arguments, long double);
+            }
+            else
+            {
+                pArgument->Double = va_arg(a_Arguments, double);
+            }
+            break;
+        case 'p':
+            pArgument->Pointer = va_arg(a_Arguments, OpcUa_Void*);
+            break;
+        case 's':
+        {
+            const OpcUa_CharA*  sString     = OpcUa_Null;
+            OpcUa_UInt32        uSpace      = OPCUA_TRACE_ASYNC_STRINGDATA - uStringOffset - 1;
+            OpcUa_UInt32        uMax        = uSpace;
+            OpcUa_UInt32        uLength     = 0;
+            OpcUa_Boolean       bPrecision  = OpcUa_False;
+
+            if(Conversion.Length != OPCUA_TRACE_LENGTH_NONE)
+            {
+                /* wide strings are not supported */
+                return OpcUa_False;
+            }
+
+            sString = va_arg(a_Arguments, const OpcUa_CharA*);
+
+            if(sString == OpcUa_Null)
+            {
+                sString = "(null)";
+            }
+
+            /* the precision limits the number of characters read (string may not be terminated) */
+            if(Conversion.HasPrecision != OpcUa_False && Conversion.Precision >= 0 && (OpcUa_UInt32)Conversion.Precision < uMax)
+            {
+                uMax        = (OpcUa_UInt32)Conversion.Precision;
+                bPrecision  = OpcUa_True;
+            }
+
+            while(uLength < uMax && sString[uLength] != '\0')
+            {
+                a_pRecord->StringData[uStringOffset + uLength] = sString[uLength];
+                uLength++;
+            }
+
+            if(bPrecision == OpcUa_False && uLength == uSpace && sString[uLength] != '\0')
+            {
+                /* string does not fit; format in place to cut the line where the synchronous trace does */
+                return OpcUa_False;
+            }
+
+            a_pRecord->StringData[uStringOffset + uLength] = '\0';
+            pArgument->StringOffset = uStringOffset;
+
+            if(uStringOffset + uLength + 1 < OPCUA_TRACE_ASYNC_STRINGDATA)
+            {
+                uStringOffset += uLength + 1;
+            }
+            break;
+        }
+        default:
+            /* '%n', wide characters and unknown conversions */
+            return OpcUa_False;
+        }
+    }
+
+    return OpcUa_True;
+}
+
+/*============================================================================
+ * OpcUa_Trace_FormatValue
+ *===========================================================================*/
+/**
+* Formats a single value into the given buffer.
+*/
+static OpcUa_Int32 OpcUa_Trace_FormatValue( OpcUa_CharA*    a_sBuffer,
+                                            OpcUa_UInt32    a_uLength,
+                                            OpcUa_CharA*    a_sFormat,
+                                            ...)
+{
+    OpcUa_Int32 iResult = 0;
+    varg_list   argumentList;
+
+    VA_START(argumentList, a_sFormat);
+    iResult = OPCUA_P_STRINGA_VSNPRINTF(a_sBuffer, a_uLength, a_sFormat, argumentList);
+    VA_END(argumentList);
+
+    return iResult;
+}
+
+/*============================================================================
+ * OpcUa_Trace_FormatRecord
+ *===========================================================================*/
+/**
+* Formats a captured record into the given buffer.
+*/
+static OpcUa_Void OpcUa_Trace_FormatRecord( OpcUa_TraceRecord*  a_pRecord,
+                                            OpcUa_CharA*        a_sBuffer,
+                                            OpcUa_UInt32        a_uLength)
+{
+    const OpcUa_CharA*      pFormat     = a_pRecord->Format;
+    OpcUa_UInt32            uPos        = 0;
+    OpcUa_UInt32            uArgument   = 0;
+    OpcUa_TraceConversion   Conversion;
+    OpcUa_CharA             sSpecification[48];
+    OpcUa_UInt32            uSpecLength = 0;
+    OpcUa_Int32             iWritten    = 0;
+    OpcUa_TraceArgument*    pArgument   = OpcUa_Null;
+
+    if(pFormat == OpcUa_Null)
+    {
+        /* formatted in place */
+        OpcUa_Trace_FormatValue(a_sBuffer, a_uLength, (OpcUa_CharA*)"%s", a_pRecord->StringData);
+        return;
+    }
+
+    while(*pFormat != '\0' && uPos + 1 < a_uLength)
+    {
+        if(*pFormat != '%')
+        {
+            a_sBuffer[uPos++] = *pFormat++;
+            continue;
+        }
+
+        pFormat++;
+
+        if(*pFormat == '%')
+        {
+            a_sBuffer[uPos++] = *pFormat++;
+            continue;
+        }
+
+        pFormat = OpcUa_Trace_ParseConversion(pFormat, &Conversion);
+
+        if(Conversion.WidthArgument != OpcUa_False)
+        {
+            Conversion.Width = (OpcUa_Int32)a_pRecord->Arguments[uArgument++].Int64;
+        }
+
+        if(Conversion.PrecisionArgument != OpcUa_False)
+        {
+            Conversion.Precision = (OpcUa_Int32)a_pRecord->Arguments[uArgument++].Int64;
+        }
+
+        pArgument = &a_pRecord->Arguments[uArgument++];
+
+        /* rebuild the specification with resolved width and precision and a normalized length */
+        uSpecLength = 0;
+        sSpecification[uSpecLength++] = '%';
+
+        if(Conversion.NoOfFlags < 8)
+        {
+            OpcUa_MemCpy(&sSpecification[uSpecLength], 8, (OpcUa_Void*)Conversion.Flags, Conversion.NoOfFlags);
+            uSpecLength += Conversion.NoOfFlags;
+        }
+
+        if(Conversion.Width < 0)
+        {
+            sSpecification[uSpecLength++] = '-';
+            Conversion.Width = -Conversion.Width;
+        }
+
+        if(Conversion.Width > 0)
+        {
+            uSpecLength += OpcUa_Trace_FormatValue(&sSpecification[uSpecLength], 12, (OpcUa_CharA*)"%d", Conversion.Width);
+        }
+
+        if(Conversion.HasPrecision != OpcUa_False && Conversion.Precision >= 0)
+        {
+            uSpecLength += OpcUa_Trace_FormatValue(&sSpecification[uSpecLength], 13, (OpcUa_CharA*)".%d", Conversion.Precision);
+        }
+
+        switch(Conversion.Conversion)
+        {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            sSpecification[uSpecLength++] = 'l';
+            sSpecification[uSpecLength++] = 'l';
+            sSpecification[uSpecLength++] = Conversion.Conversion;
+            sSpecification[uSpecLength]   = '\0';
+            iWritten = OpcUa_Trace_FormatValue(&a_sBuffer[uPos], a_uLength - uPos, sSpecification, pArgument->Int64);
+            break;
+        case 'c':
+            sSpecification[uSpecLength++] = Conversion.Conversion;
+            sSpecification[uSpecLength]   = '\0';
+            iWritten = OpcUa_Trace_FormatValue(&a_sBuffer[uPos], a_uLength - uPos, sSpecification, (int)pArgument->Int64);
+            break;
+        case 'p':
+            sSpecification[uSpecLength++] = Conversion.Conversion;
+            sSpecification[uSpecLength]   = '\0';
+            iWritten = OpcUa_Trace_FormatValue(&a_sBuffer[uPos], a_uLength - uPos, sSpecification, pArgument->Pointer);
+            break;
+        case 's':
+            sSpecification[uSpecLength++] = Conversion.Conversion;
+            sSpecification[uSpecLength]   = '\0';
+            iWritten = OpcUa_Trace_FormatValue(&a_sBuffer[uPos], a_uLength - uPos, sSpecification, &a_pRecord->StringData[pArgument->StringOffset]);
+            break;
+        default:
+            /* floating point */
+            sSpecification[uSpecLength++] = Conversion.Conversion;
+            sSpecification[uSpecLength]   = '\0';
+            iWritten = OpcUa_Trace_FormatValue(&a_sBuffer[uPos], a_uLength - uPos, sSpecification, pArgument->Double);
+            break;
+        }
+
+        if(iWritten < 0 || (OpcUa_UInt32)iWritten >= a_uLength - uPos)
+        {
+            /* truncated */
+            uPos = a_uLength - 1;
+            break;
+        }
+
+        uPos += (OpcUa_UInt32)iWritten;
+    }
+
+    a_sBuffer[uPos] = '\0';
+}
+
+/*============================================================================
+ * OpcUa_Trace_GetThreadRing
+ *===========================================================================*/
+/**
+* Returns the trace buffer of the calling thread. On the first call of a thread
+* an empty buffer of an ended thread is taken over or a new one is created;
+* returns OpcUa_Null if no buffer is available.
+*/
+static OpcUa_TraceRing* OpcUa_Trace_GetThreadRing(OpcUa_Void)
+{
+    OpcUa_UInt32        uGeneration = OpcUa_Atomic_Load32(&OpcUa_Trace_s_uGeneration);
+    OpcUa_TraceRing*    pRing       = OpcUa_Null;
+    OpcUa_UInt32        uIndex      = 0;
+
+    if(OpcUa_Trace_s_uThreadGeneration == uGeneration)
+    {
+        return OpcUa_Trace_s_pThreadRing;
+    }
+
+    /* first trace of this thread in the current generation; done once per thread */
+    OPCUA_P_MUTEX_LOCK(OpcUa_Trace_s_pLock);
+
+    for(uIndex = 0; uIndex < OpcUa_Trace_s_uNoOfRings; uIndex++)
+    {
+        pRing = OpcUa_Trace_s_apRings[uIndex];
+
+        /* the writer may still report records or drops of the previous owner under its id */
+        if(     OpcUa_Atomic_Load32(&pRing->InUse) == 0
+            &&  OpcUa_Atomic_Load32(&pRing->Tail) == pRing->Head
+            &&  OpcUa_Atomic_Load32(&pRing->Dropped) == 0)
+        {
+            break;
+        }
+
+        pRing = OpcUa_Null;
+    }
+
+    if(pRing == OpcUa_Null && uIndex < OPCUA_TRACE_ASYNC_MAXTHREADS)
+    {
+        pRing = (OpcUa_TraceRing*)OpcUa_Alloc(sizeof(OpcUa_TraceRing));
+
+        if(pRing != OpcUa_Null)
+        {
+            OpcUa_MemSet(pRing, 0, sizeof(OpcUa_TraceRing));
+            OpcUa_Trace_s_apRings[uIndex] = pRing;
+            OpcUa_Atomic_Store32(&OpcUa_Trace_s_uNoOfRings, uIndex + 1);
+        }
+    }
+
+    if(pRing != OpcUa_Null)
+    {
+        /* published to the writer by the first store of Head */
+        pRing->ThreadId = (OpcUa_UInt64)OPCUA_P_THREAD_GETCURRENTID();
+        OpcUa_Atomic_Store32(&pRing->InUse, 1);
+    }
+
+    OPCUA_P_MUTEX_UNLOCK(OpcUa_Trace_s_pLock);
+
+    /* threads without ring trace synchronously for the rest of this generation */
+    OpcUa_Trace_s_pThreadRing       = pRing;
+    OpcUa_Trace_s_uThreadGeneration = uGeneration;
+
+    return pRing;
+}
+
+/*============================================================================
+ * OpcUa_Trace_WriteRecord
+ *===========================================================================*/
+/**
+* Formats the record and hands it to the platform trace device.
+*/
+static OpcUa_Void OpcUa_Trace_WriteRecord(  OpcUa_TraceRing*    a_pRing,
+                                            OpcUa_TraceRecord*  a_pRecord)
+{
+    OpcUa_Trace_FormatRecord(a_pRecord, OpcUa_Trace_s_aWriterBuffer, OPCUA_TRACE_MAXLENGTH);
+
+#if OPCUA_TRACE_FILE_LINE_INFO
+    OPCUA_P_TRACE_RECORD(a_pRing->ThreadId, a_pRecord->Timestamp, a_pRecord->TraceLevel, a_pRecord->File, a_pRecord->Line, OpcUa_Trace_s_aWriterBuffer);
+#else
+    OPCUA_P_TRACE_RECORD(a_pRing->ThreadId, a_pRecord->Timestamp, OpcUa_Trace_s_aWriterBuffer);
+#endif
+}
+
+/*============================================================================
+ * OpcUa_Trace_Drain
+ *===========================================================================*/
+/**
+* Writes all buffered records, merging the threads in timestamp order.
+* Must only be called by one thread at a time.
+*/
+static OpcUa_Void OpcUa_Trace_Drain(OpcUa_Void)
+{
+    OpcUa_UInt32        uNoOfRings  = OpcUa_Atomic_Load32(&OpcUa_Trace_s_uNoOfRings);
+    OpcUa_UInt32        uIndex      = 0;
+    OpcUa_UInt32        uDropped    = 0;
+    OpcUa_TraceRing*    pRing       = OpcUa_Null;
+    OpcUa_TraceRing*    pOldest     = OpcUa_Null;
+    OpcUa_TraceRecord*  pRecord     = OpcUa_Null;
+    OpcUa_TraceRecord*  pOldestRecord = OpcUa_Null;
+
+    for(;;)
+    {
+        pOldest       = OpcUa_Null;
+        pOldestRecord = OpcUa_Null;
+
+        for(uIndex = 0; uIndex < uNoOfRings; uIndex++)
+        {
+            pRing = OpcUa_Trace_s_apRings[uIndex];
+
+            if(pRing->Tail == OpcUa_Atomic_Load32(&pRing->Head))
+            {
+                continue;
+            }
+
+            pRecord = &pRing->Records[pRing->Tail & (OPCUA_TRACE_ASYNC_RECORDS - 1)];
+
+            if(     pOldestRecord == OpcUa_Null
+                ||  pRecord->Timestamp.dwHighDateTime < pOldestRecord->Timestamp.dwHighDateTime
+                || (    pRecord->Timestamp.dwHighDateTime == pOldestRecord->Timestamp.dwHighDateTime
+                    &&  pRecord->Timestamp.dwLowDateTime  <  pOldestRecord->Timestamp.dwLowDateTime))
+            {
+                pOldest       = pRing;
+                pOldestRecord = pRecord;
+            }
+        }
+
+        if(pOldest == OpcUa_Null)
+        {
+            break;
+        }
+
+        OpcUa_Trace_WriteRecord(pOldest, pOldestRecord);
+        OpcUa_Atomic_Store32(&pOldest->Tail, pOldest->Tail + 1);
+    }
+
+    for(uIndex = 0; uIndex < uNoOfRings; uIndex++)
+    {
+        pRing = OpcUa_Trace_s_apRings[uIndex];
+
+        uDropped = OpcUa_Atomic_Load32(&pRing->Dropped);
+
+        if(uDropped != 0)
+        {
+            OpcUa_Atomic_Add32(&pRing->Dropped, (OpcUa_UInt32)(0 - uDropped));
+
+            OpcUa_Trace_FormatValue(OpcUa_Trace_s_aWriterBuffer,
+                                    OPCUA_TRACE_MAXLENGTH,
+                                    (OpcUa_CharA*)"OpcUa_Trace: %u trace records dropped; trace buffer full!\n",
+                                    uDropped);
+#if OPCUA_TRACE_FILE_LINE_INFO
+            OPCUA_P_TRACE_RECORD(pRing->ThreadId, OPCUA_P_DATETIME_UTCNOW(), OPCUA_TRACE_LEVEL_WARNING, (OpcUa_CharA*)__FILE__, __LINE__, OpcUa_Trace_s_aWriterBuffer);
+#else
+            OPCUA_P_TRACE_RECORD(pRing->ThreadId, OPCUA_P_DATETIME_UTCNOW(), OpcUa_Trace_s_aWriterBuffer);
+#endif
+        }
+    }
+}
+
+/*============================================================================
+ * OpcUa_Trace_WriterMain
+ *===========================================================================*/
+/**
+* Main function of the background thread writing the buffered records.
+*/
+static OpcUa_Void OpcUa_Trace_WriterMain(OpcUa_Void* a_pArgument)
+{
+    OpcUa_ReferenceParameter(a_pArgument);
+
+    while(OpcUa_Atomic_Load32(&OpcUa_Trace_s_bWriterStop) == 0)
+    {
+        OPCUA_P_SEMAPHORE_TIMEDWAIT(OpcUa_Trace_s_hWriterEvent, OPCUA_TRACE_ASYNC_FLUSHINTERVAL);
+        OpcUa_Trace_Drain();
+    }
+}
+
+/*============================================================================
+ * OpcUa_Trace_Record
+ *===========================================================================*/
+/**
+* Stores a trace call into the buffer of the calling thread.
+* Returns OpcUa_False if the call has to be traced synchronously.
+*/
+static OpcUa_Boolean OpcUa_Trace_Record(OpcUa_UInt32    a_uTraceLevel,
+#if OPCUA_TRACE_FILE_LINE_INFO
+                                        OpcUa_CharA*    a_sFile,
+                                        OpcUa_UInt32    a_uLine,
+#endif /* OPCUA_TRACE_FILE_LINE_INFO */
+                                        OpcUa_CharA*    a_sFormat,
+                                        varg_list       a_Arguments,
+                                        OpcUa_Boolean*  a_pbCaptured)
+{
+    OpcUa_TraceRing*    pRing   = OpcUa_Null;
+    OpcUa_TraceRecord*  pRecord = OpcUa_Null;
+    OpcUa_UInt32        uHead   = 0;
+
+    *a_pbCaptured = OpcUa_False;
+
+    if(OpcUa_Atomic_Load32(&OpcUa_Trace_s_bAsyncActive) == 0)
+    {
+        return OpcUa_False;
+    }
+
+    pRing = OpcUa_Trace_GetThreadRing();
+
+    if(pRing == OpcUa_Null)
+    {
+        return OpcUa_False;
+    }
+
+    uHead = pRing->Head;
+
+    if(uHead - OpcUa_Atomic_Load32(&pRing->Tail) >= OPCUA_TRACE_ASYNC_RECORDS)
+    {
+        /* never block the caller; the writer reports the loss */
+        OpcUa_Atomic_Add32(&pRing->Dropped, 1);
+        *a_pbCaptured = OpcUa_True;
+        return OpcUa_True;
+    }
+
+    pRecord = &pRing->Records[uHead & (OPCUA_TRACE_ASYNC_RECORDS - 1)];
+
+    pRecord->TraceLevel = a_uTraceLevel;
+    pRecord->Timestamp  = OPCUA_P_DATETIME_UTCNOW();
+#if OPCUA_TRACE_FILE_LINE_INFO
+    pRecord->File       = a_sFile;
+    pRecord->Line       = a_uLine;
+#endif /* OPCUA_TRACE_FILE_LINE_INFO */
+
+    if(OpcUa_Trace_CaptureArguments(pRecord, a_sFormat, a_Arguments) == OpcUa_False)
+    {
+        /* caller formats into StringData with a fresh argument list */
+        pRecord->Format = OpcUa_Null;
+        return OpcUa_True;
+    }
+
+    pRecord->Format = a_sFormat;
+
+    OpcUa_Atomic_Store32(&pRing->Head, uHead + 1);
+
+    if(uHead - OpcUa_Atomic_Load32(&pRing->Tail) == OPCUA_TRACE_ASYNC_RECORDS / 2)
+    {
+        /* wake up the writer early if the buffer fills up */
+        OPCUA_P_SEMAPHORE_POST(OpcUa_Trace_s_hWriterEvent, 1);
+    }
+
+    *a_pbCaptured = OpcUa_True;
+    return OpcUa_True;
+}
+
+/*============================================================================
+ * OpcUa_Trace_CommitFormatted
+ *===========================================================================*/
+/**
+* Formats the trace call into the current record of the calling thread if the
+* arguments could not be captured and publishes the record.
+*/
+static OpcUa_Void OpcUa_Trace_CommitFormatted(  OpcUa_CharA*    a_sFormat,
+                                                varg_list       a_Arguments)
+{
+    OpcUa_TraceRing*    pRing   = OpcUa_Trace_s_pThreadRing;
+    OpcUa_TraceRecord*  pRecord = &pRing->Records[pRing->Head & (OPCUA_TRACE_ASYNC_RECORDS - 1)];
+
+    OPCUA_P_STRINGA_VSNPRINTF(pRecord->StringData, OPCUA_TRACE_ASYNC_STRINGDATA, a_sFormat, a_Arguments);
+    pRecord->StringData[OPCUA_TRACE_ASYNC_STRINGDATA - 1] = '\0';
+
+    OpcUa_Atomic_Store32(&pRing->Head, pRing->Head + 1);
+}
+
+#else /* OPCUA_TRACE_ENABLE && OPCUA_TRACE_ASYNC && OPCUA_MULTITHREADED */
+#define OPCUA_TRACE_USE_ASYNC 0
+#endif /* OPCUA_TRACE_ENABLE && OPCUA_TRACE_ASYNC && OPCUA_MULTITHREADED */
 
 /*============================================================================
  * Trace Initialize
@@ -62,6 +891,38 @@ OpcUa_StatusCode OPCUA_DLLCALL OpcUa_Trace_Initialize(OpcUa_Void)
 #endif /* OPCUA_USE_SYNCHRONISATION */
 
     uStatus = OPCUA_P_TRACE_INITIALIZE();
+    OpcUa_ReturnErrorIfBad(uStatus);
+
+#if OPCUA_TRACE_USE_ASYNC
+    if(OpcUa_Trace_s_hWriterThread == OpcUa_Null)
+    {
+        OpcUa_Trace_s_uNoOfRings  = 0;
+        OpcUa_Trace_s_bWriterStop = 0;
+        OpcUa_Atomic_Add32(&OpcUa_Trace_s_uGeneration, 1);
+
+        uStatus = OPCUA_P_SEMAPHORE_CREATE(&OpcUa_Trace_s_hWriterEvent, 0, 0x100);
+        OpcUa_ReturnErrorIfBad(uStatus);
+
+        uStatus = OpcUa_Thread_Create(&OpcUa_Trace_s_hWriterThread, OpcUa_Trace_WriterMain, OpcUa_Null);
+        OpcUa_ReturnErrorIfBad(uStatus);
+
+        uStatus = OpcUa_Thread_Start(OpcUa_Trace_s_hWriterThread);
+        if(OpcUa_IsBad(uStatus))
+        {
+            /* fall back to synchronous tracing */
+            OpcUa_Thread_Delete(&OpcUa_Trace_s_hWriterThread);
+            uStatus = OpcUa_Good;
+        }
+        else
+        {
+            OpcUa_Atomic_Store32(&OpcUa_Trace_s_bAsyncActive, 1);
+        }
+    }
+#endif /* OPCUA_TRACE_USE_ASYNC */
+
+#if OPCUA_TRACE_ENABLE
+    OpcUa_Atomic_Store32(&OpcUa_Trace_s_bInitialized, 1);
+#endif /* OPCUA_TRACE_ENABLE */
 
     return uStatus;
 }
@@ -74,6 +935,50 @@ OpcUa_StatusCode OPCUA_DLLCALL OpcUa_Trace_Initialize(OpcUa_Void)
 */
 OpcUa_Void OPCUA_DLLCALL OpcUa_Trace_Clear(OpcUa_Void)
 {
+#if OPCUA_TRACE_USE_ASYNC
+    OpcUa_UInt32 uIndex = 0;
+#endif /* OPCUA_TRACE_USE_ASYNC */
+
+#if OPCUA_TRACE_ENABLE
+    /* turn away new trace calls and wait for the threads still tracing */
+    OpcUa_Atomic_Store32(&OpcUa_Trace_s_bInitialized, 0);
+    OpcUa_Atomic_MemoryBarrier();
+
+#if OPCUA_MULTITHREADED
+    while(OpcUa_Atomic_Load32(&OpcUa_Trace_s_uCallers) != 0)
+    {
+        OpcUa_Thread_Sleep(0);
+    }
+#endif /* OPCUA_MULTITHREADED */
+#endif /* OPCUA_TRACE_ENABLE */
+
+#if OPCUA_TRACE_USE_ASYNC
+    /* stop the writer and write the remaining records */
+    OpcUa_Atomic_Store32(&OpcUa_Trace_s_bAsyncActive, 0);
+
+    if(OpcUa_Trace_s_hWriterThread != OpcUa_Null)
+    {
+        OpcUa_Atomic_Store32(&OpcUa_Trace_s_bWriterStop, 1);
+        OPCUA_P_SEMAPHORE_POST(OpcUa_Trace_s_hWriterEvent, 1);
+        OpcUa_Thread_WaitForShutdown(OpcUa_Trace_s_hWriterThread, OPCUA_INFINITE);
+        OpcUa_Thread_Delete(&OpcUa_Trace_s_hWriterThread);
+    }
+
+    OpcUa_Trace_Drain();
+
+    for(uIndex = 0; uIndex < OpcUa_Trace_s_uNoOfRings; uIndex++)
+    {
+        OpcUa_Free(OpcUa_Trace_s_apRings[uIndex]);
+        OpcUa_Trace_s_apRings[uIndex] = OpcUa_Null;
+    }
+    OpcUa_Trace_s_uNoOfRings = 0;
+
+    if(OpcUa_Trace_s_hWriterEvent != OpcUa_Null)
+    {
+        OPCUA_P_SEMAPHORE_DELETE(&OpcUa_Trace_s_hWriterEvent);
+    }
+#endif /* OPCUA_TRACE_USE_ASYNC */
+
 #if OPCUA_USE_SYNCHRONISATION
     OPCUA_P_MUTEX_DELETE(&OpcUa_Trace_s_pLock);
 #endif /* OPCUA_USE_SYNCHRONISATION */
@@ -99,6 +1004,7 @@ OpcUa_Void OPCUA_DLLCALL OpcUa_Trace_Toggle(OpcUa_Boolean a_bActive)
 
     /* check if app wants trace output */
     OpcUa_ProxyStub_g_Configuration.bProxyStub_Trace_Enabled = a_bActive;
+    OpcUa_Trace_UpdateActiveLevels();
 
 #if OPCUA_USE_SYNCHRONISATION
     OPCUA_P_MUTEX_UNLOCK(OpcUa_Trace_s_pLock);
@@ -125,6 +1031,7 @@ OpcUa_Void OPCUA_DLLCALL OpcUa_Trace_ChangeTraceLevel(OpcUa_UInt32 a_uNewTraceLe
 #endif /* OPCUA_USE_SYNCHRONISATION */
 
     OpcUa_ProxyStub_g_Configuration.uProxyStub_Trace_Level = a_uNewTraceLevel;
+    OpcUa_Trace_UpdateActiveLevels();
 
 #if OPCUA_USE_SYNCHRONISATION
     OPCUA_P_MUTEX_UNLOCK(OpcUa_Trace_s_pLock);
@@ -133,6 +1040,51 @@ OpcUa_Void OPCUA_DLLCALL OpcUa_Trace_ChangeTraceLevel(OpcUa_UInt32 a_uNewTraceLe
     return;
 }
 
+/*============================================================================
+ * Update Active Trace Levels
+ *===========================================================================*/
+/**
+ * Recalculates the trace levels checked at the trace call site.
+ */
+OpcUa_Void OPCUA_DLLCALL OpcUa_Trace_UpdateActiveLevels(OpcUa_Void)
+{
+    OpcUa_UInt32 uActiveLevels = OPCUA_TRACE_OUTPUT_LEVEL_NONE;
+
+    if(OpcUa_ProxyStub_g_Configuration.bProxyStub_Trace_Enabled != OpcUa_False)
+    {
+        uActiveLevels = OpcUa_ProxyStub_g_Configuration.uProxyStub_Trace_Level & (OPCUA_TRACE_COMPILE_LEVEL);
+    }
+
+    OpcUa_Atomic_Store32(&OpcUa_Trace_g_uActiveLevels, uActiveLevels);
+}
+
+/*============================================================================
+ * Release Thread
+ *===========================================================================*/
+/**
+ * Hands the trace buffer of the calling thread to threads which start later.
+ */
+OpcUa_Void OPCUA_DLLCALL OpcUa_Trace_ReleaseThread(OpcUa_Void)
+{
+#if OPCUA_TRACE_USE_ASYNC
+    /* OpcUa_Trace_Clear must not free the ring while it is handed back */
+    OpcUa_Atomic_Add32(&OpcUa_Trace_s_uCallers, 1);
+
+    if(     OpcUa_Atomic_Load32(&OpcUa_Trace_s_bInitialized) != 0
+        &&  OpcUa_Trace_s_pThreadRing != OpcUa_Null
+        &&  OpcUa_Trace_s_uThreadGeneration == OpcUa_Atomic_Load32(&OpcUa_Trace_s_uGeneration))
+    {
+        OpcUa_Atomic_Store32(&OpcUa_Trace_s_pThreadRing->InUse, 0);
+    }
+
+    /* a later trace call of this thread takes a ring again */
+    OpcUa_Trace_s_pThreadRing       = OpcUa_Null;
+    OpcUa_Trace_s_uThreadGeneration = 0;
+
+    OpcUa_Atomic_Add32(&OpcUa_Trace_s_uCallers, (OpcUa_UInt32)-1);
+#endif /* OPCUA_TRACE_USE_ASYNC */
+}
+
 OpcUa_Boolean OPCUA_DLLCALL OpcUa_Trace_Nop(OpcUa_UInt32     a_uTraceLevel,
 #if OPCUA_TRACE_FILE_LINE_INFO
                                             OpcUa_CharA*     a_sFile,
@@ -168,48 +1120,91 @@ OpcUa_Boolean OPCUA_DLLCALL OpcUa_Trace_Imp(OpcUa_UInt32    a_uTraceLevel,
 {
 #if OPCUA_TRACE_ENABLE
     OpcUa_Boolean bTraced = OpcUa_False;
+    OpcUa_Boolean bDone   = OpcUa_False;
 
-#if OPCUA_USE_SYNCHRONISATION
-    if(OpcUa_Trace_s_pLock == OpcUa_Null)
+    /* OpcUa_Trace_Clear waits until no caller is left in here before it frees the trace resources */
+    OpcUa_Atomic_Add32(&OpcUa_Trace_s_uCallers, 1);
+
+    if(OpcUa_Atomic_Load32(&OpcUa_Trace_s_bInitialized) == 0)
     {
-        return OpcUa_False;
+        bDone = OpcUa_True;
     }
 
-    OPCUA_P_MUTEX_LOCK(OpcUa_Trace_s_pLock);
-#endif /* OPCUA_USE_SYNCHRONISATION */
+#if OPCUA_TRACE_USE_ASYNC
+    /* lock free path: record into the buffer of the calling thread */
+    if(bDone != OpcUa_False)
+    {
+        /* trace is not initialized */
+    }
+    else if(    OpcUa_ProxyStub_g_Configuration.bProxyStub_Trace_Enabled == OpcUa_False
+            || (a_uTraceLevel & OpcUa_ProxyStub_g_Configuration.uProxyStub_Trace_Level) == 0)
+    {
+        bDone = OpcUa_True;
+    }
+    else
+    {
+        OpcUa_Boolean   bCaptured = OpcUa_False;
+        varg_list       argumentList;
 
-    /* check if app wants trace output */
-    if(OpcUa_ProxyStub_g_Configuration.bProxyStub_Trace_Enabled == OpcUa_False)
+        VA_START(argumentList, a_sFormat);
+        bTraced = OpcUa_Trace_Record(a_uTraceLevel,
+#if OPCUA_TRACE_FILE_LINE_INFO
+                                     a_sFile,
+                                     a_sLine,
+#endif /* OPCUA_TRACE_FILE_LINE_INFO */
+                                     a_sFormat,
+                                     argumentList,
+                                     &bCaptured);
+        VA_END(argumentList);
+
+        if(bTraced != OpcUa_False)
+        {
+            if(bCaptured == OpcUa_False)
+            {
+                VA_START(argumentList, a_sFormat);
+                OpcUa_Trace_CommitFormatted(a_sFormat, argumentList);
+                VA_END(argumentList);
+            }
+
+            bDone = OpcUa_True;
+        }
+    }
+#endif /* OPCUA_TRACE_USE_ASYNC */
+
+    if(bDone == OpcUa_False)
     {
 #if OPCUA_USE_SYNCHRONISATION
-        OPCUA_P_MUTEX_UNLOCK(OpcUa_Trace_s_pLock);
+        OPCUA_P_MUTEX_LOCK(OpcUa_Trace_s_pLock);
 #endif /* OPCUA_USE_SYNCHRONISATION */
-        return OpcUa_False;
-    }
 
-    if(a_uTraceLevel & OpcUa_ProxyStub_g_Configuration.uProxyStub_Trace_Level)
-    {
-        varg_list argumentList;
-        VA_START(argumentList, a_sFormat);
+        /* check if app wants trace output */
+        if(     OpcUa_ProxyStub_g_Configuration.bProxyStub_Trace_Enabled != OpcUa_False
+            &&  (a_uTraceLevel & OpcUa_ProxyStub_g_Configuration.uProxyStub_Trace_Level))
+        {
+            varg_list argumentList;
+            VA_START(argumentList, a_sFormat);
 
-        OPCUA_P_STRINGA_VSNPRINTF(OpcUa_Trace_g_aTraceBuffer,
-                                  OPCUA_TRACE_MAXLENGTH,
-                                  a_sFormat,
-                                  argumentList);
+            OPCUA_P_STRINGA_VSNPRINTF(OpcUa_Trace_g_aTraceBuffer,
+                                      OPCUA_TRACE_MAXLENGTH,
+                                      a_sFormat,
+                                      argumentList);
 
-        /* send trace buffer to platform trace device */
+            /* send trace buffer to platform trace device */
 #if OPCUA_TRACE_FILE_LINE_INFO
-        OPCUA_P_TRACE(a_uTraceLevel, a_sFile, a_sLine, OpcUa_Trace_g_aTraceBuffer);
+            OPCUA_P_TRACE(a_uTraceLevel, a_sFile, a_sLine, OpcUa_Trace_g_aTraceBuffer);
 #else
-        OPCUA_P_TRACE(OpcUa_Trace_g_aTraceBuffer);
+            OPCUA_P_TRACE(OpcUa_Trace_g_aTraceBuffer);
 #endif
-        bTraced = OpcUa_True;
-        VA_END(argumentList);
-    }
+            bTraced = OpcUa_True;
+            VA_END(argumentList);
+        }
 
 #if OPCUA_USE_SYNCHRONISATION
-    OPCUA_P_MUTEX_UNLOCK(OpcUa_Trace_s_pLock);
+        OPCUA_P_MUTEX_UNLOCK(OpcUa_Trace_s_pLock);
 #endif /* OPCUA_USE_SYNCHRONISATION */
+    }
+
+    OpcUa_Atomic_Add32(&OpcUa_Trace_s_uCallers, (OpcUa_UInt32)-1);
 
     return bTraced;
 
@@ -43,6 +43,32 @@ OPCUA_BEGIN_EXTERN_C
 #define OPCUA_TRACE_OUTPUT_LEVEL_CONTENT (OPCUA_TRACE_LEVEL_ERROR | OPCUA_TRACE_LEVEL_WARNING | OPCUA_TRACE_LEVEL_SYSTEM | OPCUA_TRACE_LEVEL_INFO | OPCUA_TRACE_LEVEL_DEBUG | OPCUA_TRACE_LEVEL_CONTENT)
 #define OPCUA_TRACE_OUTPUT_LEVEL_ALL     (0xFFFFFFFF)
 #define OPCUA_TRACE_OUTPUT_LEVEL_NONE    (0x00000000)
+
+/*============================================================================
+ * Active Trace Levels
+ *===========================================================================*/
+/**
+* The trace levels currently written to the trace device; zero if tracing is
+* toggled off. Checked by OpcUa_Trace before the arguments get evaluated.
+*/
+OPCUA_IMEXPORT extern OpcUa_UInt32 OpcUa_Trace_g_uActiveLevels;
+
+/**
+* @brief Evaluates to true if a trace call with the given level would produce output.
+*
+* Levels not contained in OPCUA_TRACE_COMPILE_LEVEL are constant false, so the
+* compiler removes the trace call including its arguments.
+*/
+#define OpcUa_Trace_IsActive(xLevel) \
+    ((((xLevel) & (OPCUA_TRACE_COMPILE_LEVEL)) != 0) && OpcUa_Unlikely(((xLevel) & OpcUa_Trace_g_uActiveLevels) != 0))
+
+/*============================================================================
+ * Update Active Trace Levels
+ *===========================================================================*/
+/**
+ * Recalculates OpcUa_Trace_g_uActiveLevels from the proxy stub configuration.
+ */
+OPCUA_EXPORT OpcUa_Void OPCUA_DLLCALL OpcUa_Trace_UpdateActiveLevels(OpcUa_Void);
 /*============================================================================
  * Trace Initialize
  *===========================================================================*/
@@ -75,6 +101,17 @@ OPCUA_EXPORT OpcUa_Void OPCUA_DLLCALL OpcUa_Trace_ChangeTraceLevel(OpcUa_UInt32
  */
 OPCUA_EXPORT OpcUa_Void OPCUA_DLLCALL OpcUa_Trace_Toggle(OpcUa_Boolean a_bActive);
 
+/*============================================================================
+ * Release Thread
+ *===========================================================================*/
+/**
+ * Hands the trace buffer of the calling thread to threads which start later.
+ * Threads started through OpcUa_Thread_Start do this when their main function
+ * returns; other threads which traced through the stack call it before they end,
+ * else their buffer stays taken until OpcUa_Trace_Clear.
+ */
+OPCUA_EXPORT OpcUa_Void OPCUA_DLLCALL OpcUa_Trace_ReleaseThread(OpcUa_Void);
+
 /*============================================================================
  * Tracefunction
  *===========================================================================*/
@@ -82,15 +119,22 @@ OPCUA_EXPORT OpcUa_Void OPCUA_DLLCALL OpcUa_Trace_Toggle(OpcUa_Boolean a_bActive
 * @brief Writes the given string and the parameters to the trace device, if the given
 * trace level is activated in the header file.
 *
+* The level is checked before the arguments are evaluated; calls for levels
+* outside of OPCUA_TRACE_COMPILE_LEVEL are removed at compile time.
+*
+* With OPCUA_TRACE_ASYNC the call only stores the format pointer and the arguments
+* into a buffer of the calling thread; a background thread formats and writes the
+* records. The format must therefore be a string constant.
+*
 * @see OpcUa_P_Trace
 *
 * @return The number of bytes written to the trace device.
 */
 #if OPCUA_TRACE_ENABLE
  #if OPCUA_TRACE_FILE_LINE_INFO
-  #define OpcUa_Trace(xLevel, ...) OpcUa_Trace_Imp(xLevel, __FILE__, __LINE__, __VA_ARGS__)
+  #define OpcUa_Trace(xLevel, ...) (OpcUa_Trace_IsActive(xLevel)?OpcUa_Trace_Imp(xLevel, __FILE__, __LINE__, __VA_ARGS__):OpcUa_False)
  #else /* OPCUA_TRACE_FILE_LINE_INFO */
-  #define OpcUa_Trace OpcUa_Trace_Imp
+  #define OpcUa_Trace(xLevel, ...) (OpcUa_Trace_IsActive(xLevel)?OpcUa_Trace_Imp(xLevel, __VA_ARGS__):OpcUa_False)
  #endif /* OPCUA_TRACE_FILE_LINE_INFO */
 #else /* OPCUA_TRACE_ENABLE */
 #ifdef _MSC_VER
@@ -102,8 +102,29 @@ typedef OpcUa_Void (OPCUA_DLLCALL *OpcUa_P_TraceHook)(OpcUa_CharA* sMessage);
 /** @brief How SSL verifies certificates. */
 #define OPCUA_P_SOCKETMANAGER_SSL_VERIFY_OPTION     (SSL_VERIFY_PEER|SSL_VERIFY_FAIL_IF_NO_PEER_CERT)
 
-/** @brief How SSL negotiates the tls protocol. */
-#define OPCUA_P_SOCKETMANAGER_SSL_PROTOCOL_OPTION   (SSL_OP_NO_SSLv2|SSL_OP_NO_SSLv3|SSL_OP_NO_TICKET)
+/** @brief How SSL negotiates the tls protocol. Session tickets are allowed for resumption. */
+#define OPCUA_P_SOCKETMANAGER_SSL_PROTOCOL_OPTION   (SSL_OP_NO_SSLv2|SSL_OP_NO_SSLv3)
+
+/** @brief Maximum number of sessions cached by a SSL listen socket. */
+#define OPCUA_P_SOCKETMANAGER_SSL_SESSION_CACHE_SIZE    1024
+
+/** @brief Lifetime of a cached SSL session or ticket in seconds. */
+#define OPCUA_P_SOCKETMANAGER_SSL_SESSION_TIMEOUT       300
+
+/** @brief Number of client contexts (certificate and remote address) kept for reuse and resumption. */
+#define OPCUA_P_SOCKETMANAGER_SSL_CLIENT_PROFILES       8
+
+/** @brief Number of certificate validation results cached by the OpenSSL PKI provider. 0 disables the cache. */
+#define OPCUA_P_PKI_VALIDATION_CACHE_SIZE               256
+
+/** @brief Maximum time in seconds a cached certificate validation result is reused. */
+#define OPCUA_P_PKI_VALIDATION_CACHE_TTL                300
+
+/** @brief Number of certificate stores kept loaded in memory by the OpenSSL PKI provider. 0 loads the store on every open. */
+#define OPCUA_P_PKI_SHARED_STORES                       4
+
+/** @brief Minimum time in seconds between checks of the store locations for changes. */
+#define OPCUA_P_PKI_STORE_CHECK_INTERVAL                10
 
 /*============================================================================
  * The Socket Event Callback
@@ -681,6 +702,25 @@ struct S_OpcUa_Port_CallTable
     OpcUa_Void          (OPCUA_DLLCALL* DestroySecretData)        ( OpcUa_Void*                 data,
                                                                     OpcUa_UInt32                bytes);
 
+    /** @brief Get a monotonic microsecond tick count which is not affected by changes of the system time.
+     *  @ingroup opcua_platformlayer_interface
+     */
+    OpcUa_UInt64        (OPCUA_DLLCALL* UtilGetMicroTickCount)    ();
+
+    /** @brief Output a trace line recorded earlier by the thread uThreadId at the given time.
+     *         Used by the stack to drain buffered trace records from a background thread.
+     *         uThreadId is the value ThreadGetCurrentId returned in the recording thread.
+     *  @ingroup opcua_platformlayer_interface
+     */
+    OpcUa_Void          (OPCUA_DLLCALL* TraceRecord)              ( OpcUa_UInt64                uThreadId,
+                                                                    OpcUa_DateTime              Timestamp,
+#if OPCUA_TRACE_FILE_LINE_INFO
+                                                                    OpcUa_UInt32                level,
+                                                                    OpcUa_CharA*                sFile,
+                                                                    OpcUa_UInt32                line,
+#endif
+                                                                    OpcUa_CharA*                sMessage);
+
 }; /* struct S_OpcUa_Port_CallTable */
 
 
@@ -32,6 +32,16 @@
 
 OPCUA_BEGIN_EXTERN_C
 
+/**
+  @brief Sets up the certificate validation cache and shared stores. Called by OpcUa_P_OpenSSL_Initialize.
+*/
+OpcUa_StatusCode OpcUa_P_OpenSSL_PKI_Initialize(OpcUa_Void);
+
+/**
+  @brief Releases the certificate validation cache and shared stores. Called by OpcUa_P_OpenSSL_Cleanup.
+*/
+OpcUa_Void OpcUa_P_OpenSSL_PKI_Cleanup(OpcUa_Void);
+
 /**
   @brief Creates a certificate store object.
 
@@ -43,6 +53,16 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_PKI_OpenCertificateStore(
     OpcUa_PKIProvider*          pProvider,
     OpcUa_Void**                ppCertificateStore);
 
+/**
+  @brief Rebuilds the in-memory certificate store of a provider from its configured locations.
+
+  Stores handed out before keep their content until they are closed.
+
+  @param pProvider             [in]  The crypto provider handle.
+*/
+OpcUa_StatusCode OpcUa_P_OpenSSL_PKI_ReloadCertificateStore(
+    OpcUa_PKIProvider*       pProvider);
+
 /**
   @brief frees a certificate store object.
 
@@ -36,6 +36,7 @@
 
 /* platform layer includes */
 #include <opcua_p_mutex.h>
+#include <opcua_p_string.h>
 #include <opcua_p_pkifactory.h>
 
 /* own headers */
@@ -44,6 +45,7 @@
 #include <opcua_p_socket_internal.h>
 #include <opcua_p_socket_interface.h>
 #include <opcua_p_socket_ssl.h>
+#include <opcua_p_socket_ssl_profile.h>
 
 #if OPCUA_P_SOCKETMANAGER_SUPPORT_SSL
 
@@ -70,7 +72,7 @@ struct _OpcUa_InternalSslSocket
     OpcUa_ByteString*                pServerCertificate;
     OpcUa_Key*                       pServerPrivateKey;
     OpcUa_Void*                      pPKIConfig;
-    SSL_CTX*                         pSslContext;
+    SSL_CTX*                         pSslContext;        /* shared; owned by listen socket/profile */
     SSL*                             pSslConnection;
     BIO*                             pRawBio;
     OpcUa_Socket                     pRawSocket;         /* underlying system socket */
@@ -80,13 +82,14 @@ struct _OpcUa_InternalSslSocket
     OpcUa_UInt                       bReadBlocked:1;     /* does the application refuse to read */
     OpcUa_UInt                       bSslProgress:1;     /* did the ssl protocol make progress  */
     OpcUa_UInt                       bSslError:1;        /* a fatal ssl protocol error occurred */
-#ifndef OPENSSL_NO_DH
-    DH*                              pDHparams;          /* optional DH param on listen socket  */
-#endif /* OPENSSL_NO_DH */
+    OpcUa_UInt                       bPeerChecked:1;     /* was a resumed session re-validated  */
 };
 
 typedef struct _OpcUa_InternalSslSocket OpcUa_InternalSslSocket;
 
+/** @brief Session id context of server contexts; required for resumption with client certificates. */
+static const unsigned char    OpcUa_SslSocket_g_SessionIdContext[]  = "OpcUaHttps";
+
 /*============================================================================
  * Process the SSL Protocol
  *===========================================================================*/
@@ -151,6 +154,12 @@ OpcUa_InitializeStatus(OpcUa_Module_Socket, "SslSocket_DoStateMachine");
         {
             ssl_result = SSL_write(pInternalSocket->pSslConnection, pWriteData, *pWriteSize);
             ssl_error = SSL_get_error(pInternalSocket->pSslConnection, ssl_result);
+            if(pInternalSocket->bSslError)
+            {
+                /* the peer of a resumed session was rejected during the handshake */
+                ssl_result = 0;
+                ssl_error = SSL_ERROR_SSL;
+            }
             if(ssl_result > 0)
             {
                 pInternalSocket->bSslProgress = OpcUa_True;
@@ -277,6 +286,12 @@ OpcUa_InitializeStatus(OpcUa_Module_Socket, "SslRead");
     ssl_result = SSL_read(pInternalSocket->pSslConnection,
                           a_pBuffer, a_nBufferSize);
     ssl_error = SSL_get_error(pInternalSocket->pSslConnection, ssl_result);
+    if(pInternalSocket->bSslError)
+    {
+        /* the peer of a resumed session was rejected during the handshake */
+        ssl_result = 0;
+        ssl_error = SSL_ERROR_SSL;
+    }
 
     if(ssl_result > 0)
     {
@@ -486,16 +501,14 @@ OpcUa_InitializeStatus(OpcUa_Module_Socket, "SslSocket_InternalClose");
 
     if(!pInternalSocket->bListenSocket)
     {
+        /* the connection holds its own reference on the shared context */
         BIO_free(pInternalSocket->pRawBio);
         SSL_free(pInternalSocket->pSslConnection);
-        SSL_CTX_free(pInternalSocket->pSslContext);
     }
-#ifndef OPENSSL_NO_DH
-    else if(pInternalSocket->pDHparams != OpcUa_Null)
+    else
     {
-        DH_free(pInternalSocket->pDHparams);
+        SSL_CTX_free(pInternalSocket->pSslContext);
     }
-#endif /* OPENSSL_NO_DH */
 
 #if OPCUA_USE_SYNCHRONISATION
     OpcUa_P_Mutex_Delete(&pInternalSocket->pMutex);
@@ -509,43 +522,16 @@ OpcUa_FinishErrorHandling;
 }
 
 /*============================================================================
- * Verify SSL Client Certificate
+ * Validate the Certificate of the Peer
  *===========================================================================*/
-static int OpcUa_SslSocket_VerifyCertificate( X509_STORE_CTX *ctx, void *arg)
+static OpcUa_Int OpcUa_SslSocket_ValidatePeer( OpcUa_InternalSslSocket* pInternalSocket,
+                                               OpcUa_ByteString*        pPeerCert)
 {
-    OpcUa_InternalSslSocket* pInternalSocket   = (OpcUa_InternalSslSocket*)arg;
-#if OPENSSL_VERSION_NUMBER >= 0x1010000fL
-    STACK_OF(X509)*          pChain            = X509_STORE_CTX_get0_untrusted(ctx);
-#else
-    STACK_OF(X509)*          pChain            = ctx->untrusted;
-#endif
-    int                      n;
-    unsigned char*           p;
     OpcUa_StatusCode         uStatus;
-    OpcUa_ByteString         ClientCert;
     OpcUa_PKIProvider        PKIProvider;
     OpcUa_Handle             hCertificateStore = OpcUa_Null;
     OpcUa_Int                validationCode    = X509_V_ERR_APPLICATION_VERIFICATION;
 
-    ClientCert.Length = 0;
-    for(n=0; n<sk_X509_num(pChain); n++)
-    {
-        ClientCert.Length += i2d_X509(sk_X509_value(pChain, n), OpcUa_Null);
-    }
-
-    ClientCert.Data = (OpcUa_Byte*)OpcUa_P_Memory_Alloc(ClientCert.Length);
-    if(ClientCert.Data == OpcUa_Null)
-    {
-        X509_STORE_CTX_set_error(ctx, X509_V_ERR_OUT_OF_MEM);
-        return -1;
-    }
-
-    p = ClientCert.Data;
-    for(n=0; n<sk_X509_num(pChain); n++)
-    {
-        i2d_X509(sk_X509_value(pChain, n), &p);
-    }
-
     OpcUa_MemSet(&PKIProvider, 0, sizeof(PKIProvider));
     uStatus = OpcUa_P_PKIFactory_CreatePKIProvider(pInternalSocket->pPKIConfig, &PKIProvider);
     if(OpcUa_IsGood(uStatus))
@@ -553,7 +539,7 @@ static int OpcUa_SslSocket_VerifyCertificate( X509_STORE_CTX *ctx, void *arg)
         uStatus = PKIProvider.OpenCertificateStore(&PKIProvider, &hCertificateStore);
         if(OpcUa_IsGood(uStatus))
         {
-            uStatus = PKIProvider.ValidateCertificate(&PKIProvider, &ClientCert, hCertificateStore,
+            uStatus = PKIProvider.ValidateCertificate(&PKIProvider, pPeerCert, hCertificateStore,
                                                       &validationCode);
             PKIProvider.CloseCertificateStore(&PKIProvider, &hCertificateStore);
         }
@@ -569,7 +555,7 @@ static int OpcUa_SslSocket_VerifyCertificate( X509_STORE_CTX *ctx, void *arg)
         if(pInternalSocket->pfnCertificateValidation != OpcUa_Null)
         {
             uStatus = pInternalSocket->pfnCertificateValidation(pInternalSocket, pInternalSocket->pvUserData,
-                                                                &ClientCert, uStatus);
+                                                                pPeerCert, uStatus);
             if(OpcUa_IsEqual(OpcUa_BadContinue))
             {
                 validationCode = X509_V_OK;
@@ -582,7 +568,7 @@ static int OpcUa_SslSocket_VerifyCertificate( X509_STORE_CTX *ctx, void *arg)
         if(pInternalSocket->pfnCertificateValidation != OpcUa_Null)
         {
             uStatus = pInternalSocket->pfnCertificateValidation(pInternalSocket, pInternalSocket->pvUserData,
-                                                                &ClientCert, uStatus);
+                                                                pPeerCert, uStatus);
             if(OpcUa_IsBad(uStatus) && OpcUa_IsNotEqual(OpcUa_BadContinue))
             {
                 validationCode = X509_V_ERR_APPLICATION_VERIFICATION;
@@ -591,15 +577,130 @@ static int OpcUa_SslSocket_VerifyCertificate( X509_STORE_CTX *ctx, void *arg)
     }
 
     ERR_clear_error();
+    return validationCode;
+}
+
+/*============================================================================
+ * Verify SSL Client Certificate
+ *===========================================================================*/
+static int OpcUa_SslSocket_VerifyCertificate( X509_STORE_CTX *ctx, void *arg)
+{
+    SSL*                     pSsl              = (SSL*)X509_STORE_CTX_get_ex_data(ctx, SSL_get_ex_data_X509_STORE_CTX_idx());
+    OpcUa_InternalSslSocket* pInternalSocket   = (OpcUa_InternalSslSocket*)SSL_get_app_data(pSsl);
+#if OPENSSL_VERSION_NUMBER >= 0x1010000fL
+    STACK_OF(X509)*          pChain            = X509_STORE_CTX_get0_untrusted(ctx);
+#else
+    STACK_OF(X509)*          pChain            = ctx->untrusted;
+#endif
+    int                      n;
+    unsigned char*           p;
+    OpcUa_ByteString         ClientCert;
+    OpcUa_Int                validationCode;
+
+    OpcUa_ReferenceParameter(arg);
+
+    ClientCert.Length = 0;
+    for(n=0; n<sk_X509_num(pChain); n++)
+    {
+        ClientCert.Length += i2d_X509(sk_X509_value(pChain, n), OpcUa_Null);
+    }
+
+    ClientCert.Data = (OpcUa_Byte*)OpcUa_P_Memory_Alloc(ClientCert.Length);
+    if(ClientCert.Data == OpcUa_Null)
+    {
+        X509_STORE_CTX_set_error(ctx, X509_V_ERR_OUT_OF_MEM);
+        return -1;
+    }
+
+    p = ClientCert.Data;
+    for(n=0; n<sk_X509_num(pChain); n++)
+    {
+        i2d_X509(sk_X509_value(pChain, n), &p);
+    }
+
+    validationCode = OpcUa_SslSocket_ValidatePeer(pInternalSocket, &ClientCert);
+
     OpcUa_P_Memory_Free(ClientCert.Data);
     X509_STORE_CTX_set_error(ctx, validationCode);
     return validationCode == X509_V_OK ? 1 : 0;
 }
 
 /*============================================================================
- * Verify SSL Client Certificate
+ * Verify the Peer of a Resumed Session
+ *===========================================================================*/
+/* A resumed handshake skips the certificate verify callback. The peer is
+   validated again, so trust list changes apply and the application sees
+   the certificate just like after a full handshake. */
+static OpcUa_Void OpcUa_SslSocket_InfoCallback(const SSL* pSsl, int where, int ret)
+{
+    OpcUa_InternalSslSocket* pInternalSocket = (OpcUa_InternalSslSocket*)SSL_get_app_data(pSsl);
+    X509*                    pPeer;
+    STACK_OF(X509)*          pChain;
+    int                      n;
+    unsigned char*           p;
+    OpcUa_ByteString         PeerCert;
+    OpcUa_Int                validationCode  = X509_V_ERR_APPLICATION_VERIFICATION;
+
+    OpcUa_ReferenceParameter(ret);
+
+    if((where & SSL_CB_HANDSHAKE_DONE) == 0
+       || pInternalSocket == OpcUa_Null
+       || pInternalSocket->bPeerChecked
+       || !SSL_session_reused((SSL*)pSsl))
+    {
+        return;
+    }
+
+    pInternalSocket->bPeerChecked = OpcUa_True;
+
+    pPeer = SSL_get_peer_certificate(pSsl);
+    if(pPeer != OpcUa_Null)
+    {
+        /* the leaf first, followed by the rest of the chain the peer sent */
+        pChain = SSL_get_peer_cert_chain(pSsl);
+        PeerCert.Length = i2d_X509(pPeer, OpcUa_Null);
+        for(n=0; n<sk_X509_num(pChain); n++)
+        {
+            if(X509_cmp(sk_X509_value(pChain, n), pPeer) != 0)
+            {
+                PeerCert.Length += i2d_X509(sk_X509_value(pChain, n), OpcUa_Null);
+            }
+        }
+
+        PeerCert.Data = (OpcUa_Byte*)OpcUa_P_Memory_Alloc(PeerCert.Length);
+        if(PeerCert.Data != OpcUa_Null)
+        {
+            p = PeerCert.Data;
+            i2d_X509(pPeer, &p);
+            for(n=0; n<sk_X509_num(pChain); n++)
+            {
+                if(X509_cmp(sk_X509_value(pChain, n), pPeer) != 0)
+                {
+                    i2d_X509(sk_X509_value(pChain, n), &p);
+                }
+            }
+
+            validationCode = OpcUa_SslSocket_ValidatePeer(pInternalSocket, &PeerCert);
+            OpcUa_P_Memory_Free(PeerCert.Data);
+        }
+
+        X509_free(pPeer);
+    }
+
+    if(validationCode != X509_V_OK)
+    {
+        OpcUa_Trace(OPCUA_TRACE_LEVEL_WARNING, "OpcUa_SslSocket_InfoCallback: peer of resumed session rejected.\n");
+        OpcUa_P_SslClientProfile_ForgetSession((SSL*)pSsl);
+        pInternalSocket->bSslError = OpcUa_True;
+    }
+}
+
+/*============================================================================
+ * Initialize a SSL Context
  *===========================================================================*/
-static OpcUa_StatusCode OpcUa_SslSocket_InitializeSslContext( OpcUa_InternalSslSocket* pInternalSocket)
+static OpcUa_StatusCode OpcUa_SslSocket_InitializeSslContext( SSL_CTX*          pSslContext,
+                                                              OpcUa_ByteString* pCertificate,
+                                                              OpcUa_Key*        pPrivateKey)
 {
     EVP_PKEY*            pKey;
     X509*                pCert;
@@ -608,42 +709,42 @@ static OpcUa_StatusCode OpcUa_SslSocket_InitializeSslContext( OpcUa_InternalSslS
 
 OpcUa_InitializeStatus(OpcUa_Module_Socket, "InitializeSslContext");
 
-    p = pInternalSocket->pServerPrivateKey->Key.Data;
+    p = pPrivateKey->Key.Data;
     pKey = d2i_PrivateKey(EVP_PKEY_RSA, OpcUa_Null, &p,
-                          pInternalSocket->pServerPrivateKey->Key.Length);
+                          pPrivateKey->Key.Length);
     if(pKey == OpcUa_Null)
     {
         OpcUa_GotoErrorWithStatus(OpcUa_BadInternalError);
     }
-    result = SSL_CTX_use_PrivateKey(pInternalSocket->pSslContext, pKey);
+    result = SSL_CTX_use_PrivateKey(pSslContext, pKey);
     EVP_PKEY_free(pKey);
     if(result <= 0)
     {
         OpcUa_GotoErrorWithStatus(OpcUa_BadInternalError);
     }
 
-    p = pInternalSocket->pServerCertificate->Data;
-    pCert = d2i_X509(OpcUa_Null, &p, pInternalSocket->pServerCertificate->Length);
+    p = pCertificate->Data;
+    pCert = d2i_X509(OpcUa_Null, &p, pCertificate->Length);
     if(pCert == OpcUa_Null)
     {
         OpcUa_GotoErrorWithStatus(OpcUa_BadInternalError);
     }
-    result = SSL_CTX_use_certificate(pInternalSocket->pSslContext, pCert);
+    result = SSL_CTX_use_certificate(pSslContext, pCert);
     X509_free(pCert);
     if(result <= 0)
     {
         OpcUa_GotoErrorWithStatus(OpcUa_BadInternalError);
     }
 
-    while(p < pInternalSocket->pServerCertificate->Data + pInternalSocket->pServerCertificate->Length)
+    while(p < pCertificate->Data + pCertificate->Length)
     {
-        pCert = d2i_X509(OpcUa_Null, &p, pInternalSocket->pServerCertificate->Data
-                         + pInternalSocket->pServerCertificate->Length - p);
+        pCert = d2i_X509(OpcUa_Null, &p, pCertificate->Data
+                         + pCertificate->Length - p);
         if(pCert == OpcUa_Null)
         {
             OpcUa_GotoErrorWithStatus(OpcUa_BadInternalError);
         }
-        result = SSL_CTX_add_extra_chain_cert(pInternalSocket->pSslContext, pCert);
+        result = SSL_CTX_add_extra_chain_cert(pSslContext, pCert);
         if(result <= 0)
         {
             X509_free(pCert);
@@ -651,20 +752,139 @@ OpcUa_InitializeStatus(OpcUa_Module_Socket, "InitializeSslContext");
         }
     }
 
-    SSL_CTX_set_cert_verify_callback( pInternalSocket->pSslContext,
+    /* the verify and info callbacks find the socket through SSL_get_app_data */
+    SSL_CTX_set_cert_verify_callback( pSslContext,
                                       OpcUa_SslSocket_VerifyCertificate,
-                                      pInternalSocket);
-    SSL_CTX_set_verify( pInternalSocket->pSslContext,
+                                      OpcUa_Null);
+    SSL_CTX_set_verify( pSslContext,
                         OPCUA_P_SOCKETMANAGER_SSL_VERIFY_OPTION,
                         OpcUa_Null);
-    SSL_CTX_set_options( pInternalSocket->pSslContext,
+    SSL_CTX_set_info_callback( pSslContext,
+                               OpcUa_SslSocket_InfoCallback);
+    SSL_CTX_set_options( pSslContext,
                          OPCUA_P_SOCKETMANAGER_SSL_PROTOCOL_OPTION);
+    SSL_CTX_set_timeout( pSslContext,
+                         OPCUA_P_SOCKETMANAGER_SSL_SESSION_TIMEOUT);
 
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
 OpcUa_FinishErrorHandling;
 }
 
+/*============================================================================
+ * Create the shared SSL Context of a listen socket
+ *===========================================================================*/
+static OpcUa_StatusCode OpcUa_SslSocket_CreateServerContext( OpcUa_InternalSslSocket* pInternalSocket)
+{
+    SSL_CTX*                 pSslContext = OpcUa_Null;
+#ifndef OPENSSL_NO_ECDH
+    EC_KEY*                  ecdh;
+#endif
+#ifndef OPENSSL_NO_DH
+    OpcUa_StringA            pFileName;
+    BIO*                     bio;
+    DH*                      pDHparams;
+#endif /* OPENSSL_NO_DH */
+
+OpcUa_InitializeStatus(OpcUa_Module_Socket, "CreateServerContext");
+
+    pSslContext = SSL_CTX_new(SSLv23_server_method());
+    OpcUa_GotoErrorIfAllocFailed(pSslContext);
+
+    uStatus = OpcUa_SslSocket_InitializeSslContext(pSslContext,
+                                                   pInternalSocket->pServerCertificate,
+                                                   pInternalSocket->pServerPrivateKey);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+#ifndef OPENSSL_NO_ECDH
+    /* Enable Perfect Forward Secrecy, using EECDH. */
+    ecdh = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
+    if(ecdh != OpcUa_Null)
+    {
+        SSL_CTX_set_tmp_ecdh(pSslContext, ecdh);
+        EC_KEY_free(ecdh);
+    }
+#endif /* OPENSSL_NO_ECDH */
+#ifndef OPENSSL_NO_DH
+    pFileName = OpcUa_P_PKIFactory_GetDHParamFileName(pInternalSocket->pPKIConfig);
+    if(pFileName != OpcUa_Null)
+    {
+        bio = BIO_new_file(pFileName, "r");
+        if(bio != OpcUa_Null)
+        {
+            pDHparams = PEM_read_bio_DHparams(bio, NULL, NULL, "");
+            BIO_free(bio);
+            if(pDHparams != OpcUa_Null)
+            {
+                SSL_CTX_set_tmp_dh(pSslContext, pDHparams);
+                SSL_CTX_set_options(pSslContext, SSL_OP_SINGLE_DH_USE);
+                DH_free(pDHparams);
+            }
+        }
+    }
+#endif /* OPENSSL_NO_DH */
+
+    /* sessions and tickets survive the connection, so reconnects skip the full handshake */
+    SSL_CTX_set_session_cache_mode(pSslContext, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_sess_set_cache_size(pSslContext, OPCUA_P_SOCKETMANAGER_SSL_SESSION_CACHE_SIZE);
+    SSL_CTX_set_session_id_context(pSslContext, OpcUa_SslSocket_g_SessionIdContext,
+                                   sizeof(OpcUa_SslSocket_g_SessionIdContext) - 1);
+
+    pInternalSocket->pSslContext = pSslContext;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    if(pSslContext != OpcUa_Null)
+    {
+        SSL_CTX_free(pSslContext);
+    }
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * Create the SSL Connection of a Client Socket
+ *===========================================================================*/
+/* The context is shared with all clients of the same credentials, PKI
+   configuration and remote address; see opcua_p_socket_ssl_profile.h. */
+static OpcUa_StatusCode OpcUa_SslSocket_CreateClientConnection( OpcUa_InternalSslSocket* pInternalSocket,
+                                                                OpcUa_StringA            sRemoteAddress)
+{
+OpcUa_InitializeStatus(OpcUa_Module_Socket, "CreateClientConnection");
+
+    uStatus = OpcUa_P_SslClientProfile_CreateConnection(pInternalSocket->pServerCertificate,
+                                                        pInternalSocket->pServerPrivateKey,
+                                                        pInternalSocket->pPKIConfig,
+                                                        sRemoteAddress,
+                                                        OpcUa_SslSocket_InitializeSslContext,
+                                                        &pInternalSocket->pSslConnection);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    pInternalSocket->pSslContext = SSL_get_SSL_CTX(pInternalSocket->pSslConnection);
+    SSL_set_app_data(pInternalSocket->pSslConnection, pInternalSocket);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * Initialize the SSL Socket Module
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_P_SslSocket_Initialize(OpcUa_Void)
+{
+    return OpcUa_P_SslClientProfile_Initialize();
+}
+
+/*============================================================================
+ * Clean up the SSL Socket Module
+ *===========================================================================*/
+OpcUa_Void OpcUa_P_SslSocket_Cleanup(OpcUa_Void)
+{
+    OpcUa_P_SslClientProfile_Cleanup();
+}
+
 /*============================================================================
  * Accept a SSL server socket
  *===========================================================================*/
@@ -674,9 +894,6 @@ static OpcUa_StatusCode OpcUa_SslSocket_InternalAccept( OpcUa_InternalSslSocket*
     OpcUa_InternalSslSocket* pInternalSocket = OpcUa_Null;
     BIO*                     pSslBio         = OpcUa_Null;
     int                      result;
-#ifndef OPENSSL_NO_ECDH
-    EC_KEY*                  ecdh;
-#endif
 
 OpcUa_InitializeStatus(OpcUa_Module_Socket, "InternalAccept");
 
@@ -708,34 +925,11 @@ OpcUa_InitializeStatus(OpcUa_Module_Socket, "InternalAccept");
     pInternalSocket->bReadBlocked             = OpcUa_False;
     pInternalSocket->bSslProgress             = OpcUa_False;
     pInternalSocket->bSslError                = OpcUa_False;
-
-    pInternalSocket->pSslContext              = SSL_CTX_new(SSLv23_server_method());
-    OpcUa_GotoErrorIfAllocFailed(pInternalSocket->pSslContext);
-
-    uStatus = OpcUa_SslSocket_InitializeSslContext(pInternalSocket);
-    OpcUa_GotoErrorIfBad(uStatus);
-
-#ifndef OPENSSL_NO_ECDH
-    /* Enable Perfect Forward Secrecy, using EECDH. */
-    ecdh = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
-    if(ecdh != OpcUa_Null)
-    {
-        SSL_CTX_set_tmp_ecdh(pInternalSocket->pSslContext, ecdh);
-        EC_KEY_free(ecdh);
-    }
-#endif /* OPENSSL_NO_ECDH */
-#ifndef OPENSSL_NO_DH
-    if(a_pInternalSocket->pDHparams != OpcUa_Null)
-    {
-        SSL_CTX_set_tmp_dh(pInternalSocket->pSslContext,
-                           a_pInternalSocket->pDHparams);
-        SSL_CTX_set_options(pInternalSocket->pSslContext,
-                            SSL_OP_SINGLE_DH_USE);
-    }
-#endif /* OPENSSL_NO_DH */
+    pInternalSocket->pSslContext              = a_pInternalSocket->pSslContext;
 
     pInternalSocket->pSslConnection           = SSL_new(pInternalSocket->pSslContext);
     OpcUa_GotoErrorIfAllocFailed(pInternalSocket->pSslConnection);
+    SSL_set_app_data(pInternalSocket->pSslConnection, pInternalSocket);
 
     pInternalSocket->pRawBio                  = BIO_new(BIO_s_bio());
     OpcUa_GotoErrorIfAllocFailed(pInternalSocket->pRawBio);
@@ -779,11 +973,6 @@ OpcUa_BeginErrorHandling;
             SSL_free(pInternalSocket->pSslConnection);
         }
 
-        if(pInternalSocket->pSslContext != OpcUa_Null)
-        {
-            SSL_CTX_free(pInternalSocket->pSslContext);
-        }
-
 #if OPCUA_USE_SYNCHRONISATION
         if(pInternalSocket->pMutex != OpcUa_Null)
         {
@@ -936,10 +1125,6 @@ OpcUa_StatusCode OPCUA_DLLCALL OpcUa_P_SocketManager_CreateSslServer(  OpcUa_Soc
                                                                        OpcUa_Socket*                    a_pSocket)
 {
     OpcUa_InternalSslSocket* pInternalSocket = OpcUa_Null;
-#ifndef OPENSSL_NO_DH
-    OpcUa_StringA            pFileName;
-    BIO*                     bio;
-#endif /* OPENSSL_NO_DH */
 
 OpcUa_InitializeStatus(OpcUa_Module_Socket, "CreateSslServer");
 
@@ -975,19 +1160,9 @@ OpcUa_InitializeStatus(OpcUa_Module_Socket, "CreateSslServer");
     pInternalSocket->pPKIConfig               = a_pPKIConfig;
     pInternalSocket->bListenSocket            = OpcUa_True;
 
-#ifndef OPENSSL_NO_DH
-    pInternalSocket->pDHparams                = OpcUa_Null;
-    pFileName = OpcUa_P_PKIFactory_GetDHParamFileName(a_pPKIConfig);
-    if(pFileName != OpcUa_Null)
-    {
-        bio = BIO_new_file(pFileName, "r");
-        if(bio != OpcUa_Null)
-        {
-            pInternalSocket->pDHparams = PEM_read_bio_DHparams(bio, NULL, NULL, "");
-            BIO_free(bio);
-        }
-    }
-#endif /* OPENSSL_NO_DH */
+    /* built once; every accepted connection shares the context and its session cache */
+    uStatus = OpcUa_SslSocket_CreateServerContext(pInternalSocket);
+    OpcUa_GotoErrorIfBad(uStatus);
 
     *a_pSocket = pInternalSocket;
 
@@ -1016,12 +1191,10 @@ OpcUa_BeginErrorHandling;
         }
 #endif /* OPCUA_USE_SYNCHRONISATION */
 
-#ifndef OPENSSL_NO_DH
-        if(pInternalSocket->pDHparams != OpcUa_Null)
+        if(pInternalSocket->pSslContext != OpcUa_Null)
         {
-            DH_free(pInternalSocket->pDHparams);
+            SSL_CTX_free(pInternalSocket->pSslContext);
         }
-#endif /* OPENSSL_NO_DH */
 
         OpcUa_P_Memory_Free(pInternalSocket);
     }
@@ -1086,15 +1259,9 @@ OpcUa_InitializeStatus(OpcUa_Module_Socket, "CreateSslClient");
     pInternalSocket->bSslProgress             = OpcUa_False;
     pInternalSocket->bSslError                = OpcUa_False;
 
-    pInternalSocket->pSslContext              = SSL_CTX_new(SSLv23_client_method());
-    OpcUa_GotoErrorIfAllocFailed(pInternalSocket->pSslContext);
-
-    uStatus = OpcUa_SslSocket_InitializeSslContext(pInternalSocket);
+    uStatus = OpcUa_SslSocket_CreateClientConnection(pInternalSocket, a_sRemoteAddress);
     OpcUa_GotoErrorIfBad(uStatus);
 
-    pInternalSocket->pSslConnection           = SSL_new(pInternalSocket->pSslContext);
-    OpcUa_GotoErrorIfAllocFailed(pInternalSocket->pSslConnection);
-
     pInternalSocket->pRawBio                  = BIO_new(BIO_s_bio());
     OpcUa_GotoErrorIfAllocFailed(pInternalSocket->pRawBio);
 
@@ -1143,11 +1310,6 @@ OpcUa_BeginErrorHandling;
             SSL_free(pInternalSocket->pSslConnection);
         }
 
-        if(pInternalSocket->pSslContext != OpcUa_Null)
-        {
-            SSL_CTX_free(pInternalSocket->pSslContext);
-        }
-
 #if OPCUA_USE_SYNCHRONISATION
         if(pInternalSocket->pMutex != OpcUa_Null)
         {
@@ -65,6 +65,31 @@ OpcUa_Void OPCUA_DLLCALL OpcUa_P_Trace_Clear(OpcUa_Void)
     return;
 }
 
+/*============================================================================
+ * Trace Output
+ *===========================================================================*/
+/**
+ * Sends the given message to the trace hook or the console.
+ */
+static OpcUa_Void OpcUa_P_Trace_Write(  unsigned long   a_uThreadId,
+                                        OpcUa_DateTime  a_Timestamp,
+                                        OpcUa_CharA*    a_sMessage)
+{
+    /* send to tracehook if registered */
+    if(g_OpcUa_P_TraceHook != OpcUa_Null)
+    {
+        g_OpcUa_P_TraceHook(a_sMessage);
+    }
+    else /* send to console */
+    {
+        char dtbuffer[25];
+
+        OpcUa_P_DateTime_GetStringFromDateTime(a_Timestamp, dtbuffer, 25);
+
+        printf("|%ld| %s %s", a_uThreadId, &dtbuffer[11], a_sMessage);
+    }
+}
+
 /*============================================================================
  * Tracefunction
  *===========================================================================*/
@@ -87,19 +112,33 @@ OpcUa_Void OPCUA_DLLCALL OpcUa_P_Trace(
     OpcUa_ReferenceParameter(line);
 #endif
 
-    /* send to tracehook if registered */
-    if(g_OpcUa_P_TraceHook != OpcUa_Null)
-    {
-        g_OpcUa_P_TraceHook(a_sMessage);
-    }
-    else /* send to console */
-    {
-        char dtbuffer[25];
-        OpcUa_DateTime timestamp;
+    OpcUa_P_Trace_Write(OpcUa_P_Thread_GetCurrentThreadId(),
+                        OpcUa_P_DateTime_UtcNow(),
+                        a_sMessage);
+}
 
-        timestamp = OpcUa_P_DateTime_UtcNow();
-        OpcUa_P_DateTime_GetStringFromDateTime(timestamp, dtbuffer, 25);
+/*============================================================================
+ * Trace Record
+ *===========================================================================*/
+/**
+ * Writes a trace line recorded earlier by the given thread at the given time.
+ */
+OpcUa_Void OPCUA_DLLCALL OpcUa_P_Trace_Record(
+                                        OpcUa_UInt64   a_uThreadId,
+                                        OpcUa_DateTime a_Timestamp,
+#if OPCUA_TRACE_FILE_LINE_INFO
+                                        OpcUa_UInt32   level,
+                                        OpcUa_CharA*   sFile,
+                                        OpcUa_UInt32   line,
+#endif
+                                        OpcUa_CharA*   a_sMessage)
+{
+#if OPCUA_TRACE_FILE_LINE_INFO
+    OpcUa_ReferenceParameter(level);
+    OpcUa_ReferenceParameter(sFile);
+    OpcUa_ReferenceParameter(line);
+#endif
 
-        printf("|%ld| %s %s", OpcUa_P_Thread_GetCurrentThreadId(), &dtbuffer[11], a_sMessage);
-    }
+    /* the id came from OpcUa_P_Thread_GetCurrentThreadId */
+    OpcUa_P_Trace_Write((unsigned long)a_uThreadId, a_Timestamp, a_sMessage);
 }
@@ -57,3 +57,20 @@ OpcUa_Void OPCUA_DLLCALL OpcUa_P_Trace(
                                         OpcUa_UInt32 line,
 #endif
                                         OpcUa_CharA* a_sMessage);
+
+/*============================================================================
+ * Trace Record
+ *===========================================================================*/
+/**
+ * Writes a trace line recorded earlier by the given thread at the given time.
+ * Used by the stack to drain buffered trace records from a background thread.
+ */
+OpcUa_Void OPCUA_DLLCALL OpcUa_P_Trace_Record(
+                                        OpcUa_UInt64   a_uThreadId,
+                                        OpcUa_DateTime a_Timestamp,
+#if OPCUA_TRACE_FILE_LINE_INFO
+                                        OpcUa_UInt32   level,
+                                        OpcUa_CharA*   sFile,
+                                        OpcUa_UInt32   line,
+#endif
+                                        OpcUa_CharA*   a_sMessage);
@@ -31,6 +31,7 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <sys/time.h>
+#include <time.h>
 #include <netdb.h>
 #include <arpa/inet.h>
 
@@ -96,6 +97,24 @@ OpcUa_UInt32 OPCUA_DLLCALL OpcUa_P_GetTickCount()
     return ticks;
 }
 
+/*============================================================================
+ * OpcUa_GetMicroTickCount
+ *===========================================================================*/
+OpcUa_UInt64 OPCUA_DLLCALL OpcUa_P_GetMicroTickCount()
+{
+    struct timespec now;
+    OpcUa_UInt64 ticks = 0;
+
+    if(clock_gettime(CLOCK_MONOTONIC, &now) == 0)
+    {
+        ticks = (OpcUa_UInt64)now.tv_sec;
+        ticks *= 1000000;
+        ticks += now.tv_nsec / 1000;
+    }
+
+    return ticks;
+}
+
 /*============================================================================
  * OpcUa_CharAToInt
  *===========================================================================*/
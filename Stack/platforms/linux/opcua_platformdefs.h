@@ -143,6 +143,9 @@ OPCUA_BEGIN_EXTERN_C
 /*OpcUa_Int memcmp(const OpcUa_Void* Buf1, const OpcUa_Void* Buf2, OpcUa_UInt Size);*/
 #define OpcUa_MemCmp(xBuf1, xBuf2, xBufSize)        memcmp(xBuf1, xBuf2, xBufSize)
 
+/*OpcUa_Void* memchr(const OpcUa_Void* Buf, OpcUa_Int Val, OpcUa_UInt Size);*/
+#define OpcUa_MemChr(xBuf, xValue, xBufSize)        memchr(xBuf, xValue, xBufSize)
+
 /*OpcUa_Int memcpy(OpcUa_Void* Buf1, const OpcUa_Void* Buf2, OpcUa_UInt Size);*/
 #define OpcUa_MemCpy(xDst, xDstSize, xSrc, xCount)  OpcUa_Memory_MemCpy(xDst, xDstSize, xSrc, xCount)
 
@@ -196,6 +199,35 @@ OpcUa_Int32 OpcUa_P_String_snprintf(OpcUa_StringA sTarget, OpcUa_UInt32 nCount,
 #define OpcUa_StrCat(xDst, xSrc)                      OpcUa_String_StrCat(xDst, xSrc, OPCUA_STRING_LENDONTCARE)
 #define OpcUa_StrnCat(xDst, xDstLength, xSrc, xCount) OpcUa_String_StrnCat(xDst, xDstLength, xSrc, xCount)
 
+/*============================================================================
+ * Branch prediction hints.
+ *===========================================================================*/
+#define OpcUa_Likely(xCondition)                                    __builtin_expect(!!(xCondition), 1)
+#define OpcUa_Unlikely(xCondition)                                  __builtin_expect(!!(xCondition), 0)
+
+/*============================================================================
+ * Atomic operations and thread local storage.
+ *
+ * Used by modules which must not serialize on a mutex in the hot path
+ * (ie. the trace buffers). Loads have acquire, stores have release semantic.
+ *===========================================================================*/
+#define OPCUA_P_THREAD_LOCAL                                        __thread
+
+#define OpcUa_Atomic_Load32(xPtr)                                   __atomic_load_n((xPtr), __ATOMIC_ACQUIRE)
+#define OpcUa_Atomic_Store32(xPtr, xValue)                          __atomic_store_n((xPtr), (xValue), __ATOMIC_RELEASE)
+#define OpcUa_Atomic_Add32(xPtr, xValue)                            __atomic_add_fetch((xPtr), (xValue), __ATOMIC_SEQ_CST)
+#define OpcUa_Atomic_CompareExchange32(xPtr, xExpected, xDesired)   __sync_bool_compare_and_swap((xPtr), (xExpected), (xDesired))
+
+#define OpcUa_Atomic_Load64(xPtr)                                   __atomic_load_n((xPtr), __ATOMIC_ACQUIRE)
+#define OpcUa_Atomic_Store64(xPtr, xValue)                          __atomic_store_n((xPtr), (xValue), __ATOMIC_RELEASE)
+#define OpcUa_Atomic_Add64(xPtr, xValue)                            __atomic_add_fetch((xPtr), (xValue), __ATOMIC_SEQ_CST)
+
+#define OpcUa_Atomic_LoadPtr(xPtr)                                  __atomic_load_n((xPtr), __ATOMIC_ACQUIRE)
+#define OpcUa_Atomic_StorePtr(xPtr, xValue)                         __atomic_store_n((xPtr), (xValue), __ATOMIC_RELEASE)
+#define OpcUa_Atomic_ExchangePtr(xPtr, xValue)                      __atomic_exchange_n((xPtr), (xValue), __ATOMIC_SEQ_CST)
+
+#define OpcUa_Atomic_MemoryBarrier()                                __sync_synchronize()
+
 OPCUA_END_EXTERN_C
 
 #endif /* _OpcUa_PlatformDefs_H_ */
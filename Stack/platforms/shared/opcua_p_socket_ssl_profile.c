@@ -0,0 +1,350 @@
+/* ========================================================================
+ * Copyright (c) 2005-2018 The OPC Foundation, Inc. All rights reserved.
+ *
+ * OPC Foundation MIT License 1.00
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * The complete license agreement can be found here:
+ * http://opcfoundation.org/License/MIT/1.00/
+ * ======================================================================*/
+
+/* UA platform definitions */
+#include <opcua_p_internal.h>
+
+/* platform layer includes */
+#include <opcua_p_mutex.h>
+#include <opcua_p_memory.h>
+#include <opcua_p_string.h>
+
+/* own headers */
+#include <opcua_p_socket_ssl_profile.h>
+
+#if OPCUA_P_SOCKETMANAGER_SUPPORT_SSL
+
+#include <openssl/sha.h>
+
+/*============================================================================
+ * The Ssl Client Profile Type
+ *===========================================================================*/
+
+/** @brief Digests hashed into a profile key: certificate, private key, three store locations and remote address. */
+#define OPCUA_P_SSLCLIENTPROFILE_DIGESTS 6
+
+/**
+* A client SSL context is built once per client credentials, PKI configuration and
+* remote address and keeps the last session negotiated with that server for resumption.
+*/
+struct _OpcUa_P_SslClientProfile
+{
+    SSL_CTX*                         pSslContext;                    /* NULL if the slot is unused          */
+    SSL_SESSION*                     pSession;                       /* last session for resumption or NULL */
+    unsigned char                    ProfileKey[SHA_DIGEST_LENGTH];  /* see OpcUa_P_SslClientProfile_GetKey */
+    OpcUa_UInt32                     uLastUse;                       /* for least recently used eviction    */
+};
+
+typedef struct _OpcUa_P_SslClientProfile OpcUa_P_SslClientProfile;
+
+static OpcUa_P_SslClientProfile OpcUa_P_SslClientProfile_g_Profiles[OPCUA_P_SOCKETMANAGER_SSL_CLIENT_PROFILES];
+static OpcUa_UInt32             OpcUa_P_SslClientProfile_g_uClock = 0;
+#if OPCUA_USE_SYNCHRONISATION
+static OpcUa_Mutex              OpcUa_P_SslClientProfile_g_Mutex  = OpcUa_Null;
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+/*============================================================================
+ * Build the Key of a Client Profile
+ *===========================================================================*/
+/* The key covers everything a context or its sessions depend on. The private
+   key only enters as digest, so the profiles keep no copy of it. */
+static OpcUa_Void OpcUa_P_SslClientProfile_GetKey(  OpcUa_ByteString* a_pCertificate,
+                                                    OpcUa_Key*        a_pPrivateKey,
+                                                    OpcUa_Void*       a_pPKIConfig,
+                                                    OpcUa_StringA     a_sRemoteAddress,
+                                                    unsigned char*    a_pProfileKey)
+{
+    OpcUa_P_OpenSSL_CertificateStore_Config* pPKIConfig = (OpcUa_P_OpenSSL_CertificateStore_Config*)a_pPKIConfig;
+    OpcUa_StringA   pLocations[3]   = {OpcUa_Null, OpcUa_Null, OpcUa_Null};
+    OpcUa_UInt32    Settings[3]     = {0, 0, 0};
+    OpcUa_Void*     pOverride       = OpcUa_Null;
+    unsigned char   Digests[OPCUA_P_SSLCLIENTPROFILE_DIGESTS * SHA_DIGEST_LENGTH + sizeof(Settings) + sizeof(OpcUa_Void*)];
+    unsigned char*  pDigest         = Digests;
+    int             i;
+
+    Settings[0] = (OpcUa_UInt32)a_pPrivateKey->Type;
+
+    /* a missing configuration is keyed like an empty one */
+    if(pPKIConfig != OpcUa_Null)
+    {
+        pLocations[0] = pPKIConfig->CertificateTrustListLocation;
+        pLocations[1] = pPKIConfig->CertificateUntrustedListLocation;
+        pLocations[2] = pPKIConfig->CertificateRevocationListLocation;
+        Settings[1]   = (OpcUa_UInt32)pPKIConfig->PkiType;
+        Settings[2]   = pPKIConfig->Flags;
+        pOverride     = pPKIConfig->Override;
+    }
+
+    SHA1(a_pCertificate->Data, (size_t)a_pCertificate->Length, pDigest);
+    pDigest += SHA_DIGEST_LENGTH;
+
+    SHA1(a_pPrivateKey->Key.Data, (size_t)a_pPrivateKey->Key.Length, pDigest);
+    pDigest += SHA_DIGEST_LENGTH;
+
+    for(i = 0; i < 3; i++)
+    {
+        SHA1(   (const unsigned char*)((pLocations[i] != OpcUa_Null)?pLocations[i]:""),
+                (pLocations[i] != OpcUa_Null)?OpcUa_P_String_strlen(pLocations[i]):0,
+                pDigest);
+        pDigest += SHA_DIGEST_LENGTH;
+    }
+
+    SHA1((const unsigned char*)a_sRemoteAddress, OpcUa_P_String_strlen(a_sRemoteAddress), pDigest);
+    pDigest += SHA_DIGEST_LENGTH;
+
+    /* an override provider validates on its own, so it is told apart by its address */
+    OpcUa_P_Memory_MemCpy(pDigest, sizeof(Settings), Settings, sizeof(Settings));
+    pDigest += sizeof(Settings);
+    OpcUa_P_Memory_MemCpy(pDigest, sizeof(OpcUa_Void*), &pOverride, sizeof(OpcUa_Void*));
+
+    SHA1(Digests, sizeof(Digests), a_pProfileKey);
+}
+
+/*============================================================================
+ * Remember a new Client Session for Resumption
+ *===========================================================================*/
+static int OpcUa_P_SslClientProfile_NewSession(SSL* a_pSsl, SSL_SESSION* a_pSession)
+{
+    OpcUa_P_SslClientProfile* pProfile;
+    int                       result   = 0;
+
+#if OPCUA_USE_SYNCHRONISATION
+    OpcUa_P_Mutex_Lock(OpcUa_P_SslClientProfile_g_Mutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+    /* the profile is detached from the context when it gets evicted */
+    pProfile = (OpcUa_P_SslClientProfile*)SSL_CTX_get_app_data(SSL_get_SSL_CTX(a_pSsl));
+    if(pProfile != OpcUa_Null)
+    {
+        if(pProfile->pSession != OpcUa_Null)
+        {
+            SSL_SESSION_free(pProfile->pSession);
+        }
+        pProfile->pSession = a_pSession;
+        result = 1;
+    }
+
+#if OPCUA_USE_SYNCHRONISATION
+    OpcUa_P_Mutex_Unlock(OpcUa_P_SslClientProfile_g_Mutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+    return result;
+}
+
+/*============================================================================
+ * Release a Client Profile
+ *===========================================================================*/
+static OpcUa_Void OpcUa_P_SslClientProfile_Clear(OpcUa_P_SslClientProfile* a_pProfile)
+{
+    if(a_pProfile->pSslContext != OpcUa_Null)
+    {
+        /* live connections keep their own reference on the context */
+        SSL_CTX_set_app_data(a_pProfile->pSslContext, OpcUa_Null);
+        SSL_CTX_free(a_pProfile->pSslContext);
+    }
+
+    if(a_pProfile->pSession != OpcUa_Null)
+    {
+        SSL_SESSION_free(a_pProfile->pSession);
+    }
+
+    OpcUa_MemSet(a_pProfile, 0, sizeof(OpcUa_P_SslClientProfile));
+}
+
+/*============================================================================
+ * Create the SSL Connection of a Client
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_P_SslClientProfile_CreateConnection( OpcUa_ByteString*                               a_pCertificate,
+                                                            OpcUa_Key*                                      a_pPrivateKey,
+                                                            OpcUa_Void*                                     a_pPKIConfig,
+                                                            OpcUa_StringA                                   a_sRemoteAddress,
+                                                            OpcUa_P_SslClientProfile_PfnInitializeContext   a_pfnInitializeContext,
+                                                            SSL**                                           a_ppSslConnection)
+{
+    OpcUa_P_SslClientProfile*   pProfile    = OpcUa_Null;
+    OpcUa_P_SslClientProfile*   pCandidate;
+    SSL*                        pSsl;
+    unsigned char               ProfileKey[SHA_DIGEST_LENGTH];
+    OpcUa_UInt32                i;
+
+OpcUa_InitializeStatus(OpcUa_Module_Socket, "SslClientProfile_CreateConnection");
+
+    OpcUa_GotoErrorIfArgumentNull(a_pCertificate);
+    OpcUa_GotoErrorIfArgumentNull(a_pPrivateKey);
+    OpcUa_GotoErrorIfArgumentNull(a_sRemoteAddress);
+    OpcUa_GotoErrorIfArgumentNull(a_pfnInitializeContext);
+    OpcUa_GotoErrorIfArgumentNull(a_ppSslConnection);
+
+    *a_ppSslConnection = OpcUa_Null;
+
+    OpcUa_P_SslClientProfile_GetKey(a_pCertificate, a_pPrivateKey, a_pPKIConfig, a_sRemoteAddress, ProfileKey);
+
+#if OPCUA_USE_SYNCHRONISATION
+    OpcUa_P_Mutex_Lock(OpcUa_P_SslClientProfile_g_Mutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+    for(i = 0; i < OPCUA_P_SOCKETMANAGER_SSL_CLIENT_PROFILES; i++)
+    {
+        pCandidate = &OpcUa_P_SslClientProfile_g_Profiles[i];
+
+        if(   pCandidate->pSslContext != OpcUa_Null
+           && OpcUa_MemCmp(pCandidate->ProfileKey, ProfileKey, SHA_DIGEST_LENGTH) == 0)
+        {
+            pProfile = pCandidate;
+            break;
+        }
+
+        if(pProfile == OpcUa_Null || pCandidate->uLastUse < pProfile->uLastUse)
+        {
+            /* remember the least recently used slot for replacement */
+            pProfile = pCandidate;
+        }
+    }
+
+    if(i == OPCUA_P_SOCKETMANAGER_SSL_CLIENT_PROFILES)
+    {
+        OpcUa_P_SslClientProfile_Clear(pProfile);
+
+        OpcUa_P_Memory_MemCpy(pProfile->ProfileKey, SHA_DIGEST_LENGTH, ProfileKey, SHA_DIGEST_LENGTH);
+
+        pProfile->pSslContext = SSL_CTX_new(SSLv23_client_method());
+        OpcUa_GotoErrorIfAllocFailed(pProfile->pSslContext);
+
+        uStatus = a_pfnInitializeContext(pProfile->pSslContext, a_pCertificate, a_pPrivateKey);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        SSL_CTX_set_session_cache_mode(pProfile->pSslContext,
+                                       SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(pProfile->pSslContext, OpcUa_P_SslClientProfile_NewSession);
+        SSL_CTX_set_app_data(pProfile->pSslContext, pProfile);
+    }
+
+    pProfile->uLastUse = ++OpcUa_P_SslClientProfile_g_uClock;
+
+    pSsl = SSL_new(pProfile->pSslContext);
+    OpcUa_GotoErrorIfAllocFailed(pSsl);
+
+    if(pProfile->pSession != OpcUa_Null)
+    {
+        SSL_set_session(pSsl, pProfile->pSession);
+    }
+
+#if OPCUA_USE_SYNCHRONISATION
+    OpcUa_P_Mutex_Unlock(OpcUa_P_SslClientProfile_g_Mutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+    *a_ppSslConnection = pSsl;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    if(pProfile != OpcUa_Null)
+    {
+        if(pProfile->pSslContext == OpcUa_Null || SSL_CTX_get_app_data(pProfile->pSslContext) == OpcUa_Null)
+        {
+            /* a partially built profile is not reused */
+            OpcUa_P_SslClientProfile_Clear(pProfile);
+        }
+
+#if OPCUA_USE_SYNCHRONISATION
+        OpcUa_P_Mutex_Unlock(OpcUa_P_SslClientProfile_g_Mutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+    }
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * Drop a Session from the Caches
+ *===========================================================================*/
+OpcUa_Void OpcUa_P_SslClientProfile_ForgetSession(SSL* a_pSsl)
+{
+    SSL_SESSION*                pSession = SSL_get_session(a_pSsl);
+    SSL_CTX*                    pContext = SSL_get_SSL_CTX(a_pSsl);
+    OpcUa_P_SslClientProfile*   pProfile;
+
+    SSL_CTX_remove_session(pContext, pSession);
+
+#if OPCUA_USE_SYNCHRONISATION
+    OpcUa_P_Mutex_Lock(OpcUa_P_SslClientProfile_g_Mutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+    pProfile = (OpcUa_P_SslClientProfile*)SSL_CTX_get_app_data(pContext);
+    if(pProfile != OpcUa_Null && pProfile->pSession == pSession)
+    {
+        SSL_SESSION_free(pProfile->pSession);
+        pProfile->pSession = OpcUa_Null;
+    }
+
+#if OPCUA_USE_SYNCHRONISATION
+    OpcUa_P_Mutex_Unlock(OpcUa_P_SslClientProfile_g_Mutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+}
+
+/*============================================================================
+ * Initialize the Client Profiles
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_P_SslClientProfile_Initialize(OpcUa_Void)
+{
+OpcUa_InitializeStatus(OpcUa_Module_Socket, "SslClientProfile_Initialize");
+
+    OpcUa_MemSet(OpcUa_P_SslClientProfile_g_Profiles, 0, sizeof(OpcUa_P_SslClientProfile_g_Profiles));
+    OpcUa_P_SslClientProfile_g_uClock = 0;
+
+#if OPCUA_USE_SYNCHRONISATION
+    uStatus = OpcUa_P_Mutex_Create(&OpcUa_P_SslClientProfile_g_Mutex);
+    OpcUa_GotoErrorIfBad(uStatus);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * Clean up the Client Profiles
+ *===========================================================================*/
+OpcUa_Void OpcUa_P_SslClientProfile_Cleanup(OpcUa_Void)
+{
+    OpcUa_UInt32 i;
+
+    for(i = 0; i < OPCUA_P_SOCKETMANAGER_SSL_CLIENT_PROFILES; i++)
+    {
+        OpcUa_P_SslClientProfile_Clear(&OpcUa_P_SslClientProfile_g_Profiles[i]);
+    }
+
+#if OPCUA_USE_SYNCHRONISATION
+    if(OpcUa_P_SslClientProfile_g_Mutex != OpcUa_Null)
+    {
+        OpcUa_P_Mutex_Delete(&OpcUa_P_SslClientProfile_g_Mutex);
+    }
+#endif /* OPCUA_USE_SYNCHRONISATION */
+}
+
+#endif /* OPCUA_P_SOCKETMANAGER_SUPPORT_SSL */
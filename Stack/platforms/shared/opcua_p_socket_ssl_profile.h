@@ -0,0 +1,90 @@
+/* ========================================================================
+ * Copyright (c) 2005-2018 The OPC Foundation, Inc. All rights reserved.
+ *
+ * OPC Foundation MIT License 1.00
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * The complete license agreement can be found here:
+ * http://opcfoundation.org/License/MIT/1.00/
+ * ======================================================================*/
+
+#ifndef _OpcUa_P_Socket_Ssl_Profile_H_
+#define _OpcUa_P_Socket_Ssl_Profile_H_ 1
+
+#if OPCUA_P_SOCKETMANAGER_SUPPORT_SSL
+#include <openssl/ssl.h>
+#endif /* OPCUA_P_SOCKETMANAGER_SUPPORT_SSL */
+
+OPCUA_BEGIN_EXTERN_C
+
+#if OPCUA_P_SOCKETMANAGER_SUPPORT_SSL
+
+/**
+* @brief Loads the certificate and private key of a client into a new context.
+*/
+typedef OpcUa_StatusCode (*OpcUa_P_SslClientProfile_PfnInitializeContext)(  SSL_CTX*          pSslContext,
+                                                                             OpcUa_ByteString* pCertificate,
+                                                                             OpcUa_Key*        pPrivateKey);
+
+/*============================================================================
+ * Initialize and clean up the client profiles
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_P_SslClientProfile_Initialize(OpcUa_Void);
+
+OpcUa_Void OpcUa_P_SslClientProfile_Cleanup(OpcUa_Void);
+
+/*============================================================================
+ * Create the SSL connection of a client
+ *===========================================================================*/
+/**
+* @brief Creates a connection with the context shared by all clients with the same certificate,
+* private key, PKI configuration and remote address, and offers the last session negotiated
+* with that server for resumption.
+*
+* @param pCertificate           [in]  The client certificate, optionally followed by its chain.
+* @param pPrivateKey            [in]  The private key of the certificate.
+* @param pPKIConfig             [in]  The PKI configuration the server certificate is validated with.
+* @param sRemoteAddress         [in]  The url of the server.
+* @param pfnInitializeContext   [in]  Called once for each context that gets built.
+* @param ppSslConnection        [out] The new connection; the caller frees it with SSL_free.
+*/
+OpcUa_StatusCode OpcUa_P_SslClientProfile_CreateConnection( OpcUa_ByteString*                               pCertificate,
+                                                            OpcUa_Key*                                      pPrivateKey,
+                                                            OpcUa_Void*                                     pPKIConfig,
+                                                            OpcUa_StringA                                   sRemoteAddress,
+                                                            OpcUa_P_SslClientProfile_PfnInitializeContext   pfnInitializeContext,
+                                                            SSL**                                           ppSslConnection);
+
+/*============================================================================
+ * Drop a session from the caches
+ *===========================================================================*/
+/**
+* @brief Removes the session of a connection from its context and, for clients, from the profile,
+* so it is not offered for resumption again.
+*/
+OpcUa_Void OpcUa_P_SslClientProfile_ForgetSession(SSL* pSsl);
+
+#endif /* OPCUA_P_SOCKETMANAGER_SUPPORT_SSL */
+
+OPCUA_END_EXTERN_C
+
+#endif /* _OpcUa_P_Socket_Ssl_Profile_H_ */
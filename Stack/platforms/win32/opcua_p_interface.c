@@ -159,12 +159,18 @@ OpcUa_Port_CallTable g_OpcUa_Port_CallTable =
 #if OPCUA_REQUIRE_OPENSSL
     OpcUa_P_OpenSSL_Thread_Cleanup,
     OpcUa_P_OpenSSL_SeedPRNG,
-    OpcUa_P_OpenSSL_DestroySecretData
+    OpcUa_P_OpenSSL_DestroySecretData,
 #else
     OpcUa_Null,
     OpcUa_Null,
-    OpcUa_Null
+    OpcUa_Null,
 #endif
+
+    /* Utilities */
+    OpcUa_P_GetMicroTickCount,
+
+    /* Trace */
+    OpcUa_P_Trace_Record
 };
 
 /*============================================================================
@@ -187,9 +193,23 @@ OpcUa_StatusCode OPCUA_DLLCALL OpcUa_P_Initialize(OpcUa_Handle* a_pPlatformLayer
     OpcUa_ReturnErrorIfBad(uStatus);
 #endif /* OPCUA_REQUIRE_OPENSSL */
 
+#if OPCUA_P_SOCKETMANAGER_SUPPORT_SSL
+    uStatus = OpcUa_P_SslSocket_Initialize();
+    if(OpcUa_IsBad(uStatus))
+    {
+#if OPCUA_REQUIRE_OPENSSL
+        OpcUa_P_OpenSSL_Cleanup();
+#endif /* OPCUA_REQUIRE_OPENSSL */
+        return uStatus;
+    }
+#endif /* OPCUA_P_SOCKETMANAGER_SUPPORT_SSL */
+
     uStatus = OpcUa_P_InitializeTimers();
     if(OpcUa_IsBad(uStatus))
     {
+#if OPCUA_P_SOCKETMANAGER_SUPPORT_SSL
+        OpcUa_P_SslSocket_Cleanup();
+#endif /* OPCUA_P_SOCKETMANAGER_SUPPORT_SSL */
 #if OPCUA_REQUIRE_OPENSSL
         OpcUa_P_OpenSSL_Cleanup();
 #endif /* OPCUA_REQUIRE_OPENSSL */
@@ -226,6 +246,10 @@ OpcUa_StatusCode OPCUA_DLLCALL OpcUa_P_Clean(OpcUa_Handle* a_pPlatformLayerHandl
         return OpcUa_BadInvalidState;
     }
 
+#if OPCUA_P_SOCKETMANAGER_SUPPORT_SSL
+    OpcUa_P_SslSocket_Cleanup();
+#endif /* OPCUA_P_SOCKETMANAGER_SUPPORT_SSL */
+
 #if OPCUA_REQUIRE_OPENSSL
     OpcUa_P_OpenSSL_Cleanup();
 #endif /* OPCUA_REQUIRE_OPENSSL */
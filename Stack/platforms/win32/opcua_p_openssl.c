@@ -47,6 +47,7 @@
 
 /* own headers */
 #include <opcua_p_openssl.h>
+#include <opcua_p_openssl_pki.h>
 
 /*============================================================================
  * OpcUa_P_ByteString_Clear
@@ -102,12 +103,19 @@ static void OpcUa_P_OpenSSL_Lock(int mode, int type, const char *file, int line)
  *===========================================================================*/
 OpcUa_StatusCode OpcUa_P_OpenSSL_Initialize()
 {
+    OpcUa_StatusCode uStatus = OpcUa_Good;
 #if OPCUA_USE_SYNCHRONISATION
-    OpcUa_StatusCode uStatus = OpcUa_P_Mutex_Create(&OpenSSL_Mutex);
+    uStatus = OpcUa_P_Mutex_Create(&OpenSSL_Mutex);
     OpcUa_ReturnErrorIfBad(uStatus);
     CRYPTO_set_locking_callback(OpcUa_P_OpenSSL_Lock);
 #endif /* OPCUA_USE_SYNCHRONISATION */
     OpenSSL_add_all_algorithms();
+    uStatus = OpcUa_P_OpenSSL_PKI_Initialize();
+    if(OpcUa_IsBad(uStatus))
+    {
+        OpcUa_P_OpenSSL_Cleanup();
+        return uStatus;
+    }
 #if OPENSSL_VERSION_NUMBER < 0x1010000fL
     RAND_screen();
 #endif
@@ -128,6 +136,7 @@ void OpcUa_P_OpenSSL_Cleanup()
     SSL_COMP_free_compression_methods();
 #endif
 #endif /* OPCUA_P_SOCKETMANAGER_SUPPORT_SSL */
+    OpcUa_P_OpenSSL_PKI_Cleanup();
     EVP_cleanup();
     CRYPTO_cleanup_all_ex_data();
     ERR_remove_state(0);
@@ -30,6 +30,7 @@
 /* UA platform definitions */
 #include <opcua_p_internal.h>
 #include <opcua_p_memory.h>
+#include <opcua_p_mutex.h>
 
 #if OPCUA_REQUIRE_OPENSSL
 
@@ -43,6 +44,7 @@
 #include <openssl/x509_vfy.h>
 #include <openssl/x509v3.h>
 #include <openssl/pkcs12.h>
+#include <openssl/sha.h>
 
 
 
@@ -53,6 +55,9 @@
 #include <windows.h>
 #include <string.h>
 #include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <time.h>
 
 /*============================================================================
  * OpcUa_P_OpenSSL_BuildFullPath
@@ -147,6 +152,444 @@ HANDLE FindFirstFileCE( /*  in */ char*              DirSpec,
 #define WIN32_FIND_DATA WIN32_FIND_DATAA
 #endif
 
+#if OPCUA_P_PKI_VALIDATION_CACHE_SIZE || OPCUA_P_PKI_SHARED_STORES
+/** @brief Number of store locations of a configuration. */
+#define OPCUA_P_PKI_STORE_LOCATIONS 3
+
+/*============================================================================
+ * OpcUa_P_OpenSSL_PKI_UpdateStoreStamp
+ *===========================================================================*/
+/** @brief Chain the name and attributes of a store location or file into the stamp. */
+static OpcUa_Void OpcUa_P_OpenSSL_PKI_UpdateStoreStamp(
+    unsigned char*                              a_pStoreStamp,
+    char*                                       a_sName,
+    OpcUa_Int64*                                a_pAttributes)
+{
+    unsigned char   Record[SHA_DIGEST_LENGTH + 3 * sizeof(OpcUa_Int64) + MAX_PATH];
+    size_t          uNameLength = strlen(a_sName) + 1;
+
+    if(uNameLength > MAX_PATH)
+    {
+        uNameLength = MAX_PATH;
+    }
+
+    OpcUa_P_Memory_MemCpy(Record, SHA_DIGEST_LENGTH, a_pStoreStamp, SHA_DIGEST_LENGTH);
+    OpcUa_P_Memory_MemCpy(&Record[SHA_DIGEST_LENGTH], 3 * sizeof(OpcUa_Int64), a_pAttributes, 3 * sizeof(OpcUa_Int64));
+    OpcUa_P_Memory_MemCpy(&Record[SHA_DIGEST_LENGTH + 3 * sizeof(OpcUa_Int64)], MAX_PATH, a_sName, uNameLength);
+
+    SHA1(Record, SHA_DIGEST_LENGTH + 3 * sizeof(OpcUa_Int64) + uNameLength, a_pStoreStamp);
+}
+
+/*============================================================================
+ * OpcUa_P_OpenSSL_PKI_GetStoreStamp
+ *===========================================================================*/
+/** @brief Digest the name, modification time and size of the trust list, untrusted list and revocation list
+ *         locations and of every file in them; a directory time alone misses files replaced in place. */
+static OpcUa_Void OpcUa_P_OpenSSL_PKI_GetStoreStamp(
+    OpcUa_P_OpenSSL_CertificateStore_Config*    a_pCertificateStoreCfg,
+    unsigned char*                              a_pStoreStamp)
+{
+    char*           pLocations[OPCUA_P_PKI_STORE_LOCATIONS];
+    char            DirSpec[MAX_PATH];
+    char            EntryFile[MAX_PATH];
+    WIN32_FIND_DATA FindFileData;
+    HANDLE          hFind;
+    struct stat     Status;
+    OpcUa_Int64     Attributes[3];
+    int             i;
+
+    pLocations[0] = a_pCertificateStoreCfg->CertificateTrustListLocation;
+    pLocations[1] = a_pCertificateStoreCfg->CertificateUntrustedListLocation;
+    pLocations[2] = a_pCertificateStoreCfg->CertificateRevocationListLocation;
+
+    OpcUa_MemSet(a_pStoreStamp, 0, SHA_DIGEST_LENGTH);
+
+    for(i = 0; i < OPCUA_P_PKI_STORE_LOCATIONS; i++)
+    {
+        /* a missing location adds an empty record, so the stamp changes when it appears */
+        OpcUa_MemSet(Attributes, 0, sizeof(Attributes));
+
+        if(pLocations[i] == OpcUa_Null || pLocations[i][0] == '\0' || stat(pLocations[i], &Status) != 0)
+        {
+            OpcUa_P_OpenSSL_PKI_UpdateStoreStamp(a_pStoreStamp, "", Attributes);
+            continue;
+        }
+
+        Attributes[0] = (OpcUa_Int64)Status.st_mtime;
+        Attributes[2] = (OpcUa_Int64)Status.st_size;
+        OpcUa_P_OpenSSL_PKI_UpdateStoreStamp(a_pStoreStamp, pLocations[i], Attributes);
+
+        if(!(Status.st_mode & S_IFDIR))
+        {
+            continue;
+        }
+
+        if(OpcUa_IsBad(OpcUa_P_OpenSSL_BuildFullPath(pLocations[i], TEXT("*"), MAX_PATH, DirSpec)))
+        {
+            continue;
+        }
+
+        hFind = FindFirstFile(DirSpec, &FindFileData);
+        if(hFind == INVALID_HANDLE_VALUE)
+        {
+            continue;
+        }
+
+        do {
+            if(     (FindFileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+                ||  OpcUa_IsBad(OpcUa_P_OpenSSL_BuildFullPath(pLocations[i], FindFileData.cFileName, MAX_PATH, EntryFile)))
+            {
+                continue;
+            }
+
+            /* last write time in 100ns units */
+            Attributes[0] = ((OpcUa_Int64)FindFileData.ftLastWriteTime.dwHighDateTime << 32) | FindFileData.ftLastWriteTime.dwLowDateTime;
+            Attributes[1] = 0;
+            Attributes[2] = ((OpcUa_Int64)FindFileData.nFileSizeHigh << 32) | FindFileData.nFileSizeLow;
+
+            OpcUa_P_OpenSSL_PKI_UpdateStoreStamp(a_pStoreStamp, EntryFile, Attributes);
+        }
+        while(FindNextFile(hFind, &FindFileData) != 0);
+
+        FindClose(hFind);
+    }
+}
+
+/*============================================================================
+ * OpcUa_P_OpenSSL_PKI_GetStoreKey
+ *===========================================================================*/
+/** @brief Identify a configuration by its flags and store locations, so a freed or edited configuration never matches old entries. */
+static OpcUa_Void OpcUa_P_OpenSSL_PKI_GetStoreKey(
+    OpcUa_P_OpenSSL_CertificateStore_Config*    a_pCertificateStoreCfg,
+    unsigned char*                              a_pStoreKey)
+{
+    char*           pLocations[OPCUA_P_PKI_STORE_LOCATIONS];
+    unsigned char   Digests[sizeof(OpcUa_UInt32) + OPCUA_P_PKI_STORE_LOCATIONS * SHA_DIGEST_LENGTH];
+    int             i;
+
+    pLocations[0] = a_pCertificateStoreCfg->CertificateTrustListLocation;
+    pLocations[1] = a_pCertificateStoreCfg->CertificateUntrustedListLocation;
+    pLocations[2] = a_pCertificateStoreCfg->CertificateRevocationListLocation;
+
+    OpcUa_P_Memory_MemCpy(Digests, sizeof(OpcUa_UInt32), &a_pCertificateStoreCfg->Flags, sizeof(OpcUa_UInt32));
+
+    /* a missing location is loaded like an empty one */
+    for(i = 0; i < OPCUA_P_PKI_STORE_LOCATIONS; i++)
+    {
+        SHA1(   (const unsigned char*)((pLocations[i] != OpcUa_Null)?pLocations[i]:""),
+                (pLocations[i] != OpcUa_Null)?strlen(pLocations[i]):0,
+                &Digests[sizeof(OpcUa_UInt32) + i * SHA_DIGEST_LENGTH]);
+    }
+
+    SHA1(Digests, sizeof(Digests), a_pStoreKey);
+}
+#endif /* OPCUA_P_PKI_VALIDATION_CACHE_SIZE || OPCUA_P_PKI_SHARED_STORES */
+
+#if OPCUA_P_PKI_SHARED_STORES
+/*============================================================================
+ * Shared certificate stores
+ *===========================================================================*/
+/**
+* @brief An in-memory store built from a store configuration; replaced as a whole on reload.
+*/
+struct _OpcUa_P_OpenSSL_SharedStore
+{
+    OpcUa_Boolean       bInUse;                                 /* false if the slot is unused                     */
+    unsigned char       StoreKey[SHA_DIGEST_LENGTH];            /* key of the configuration the store was built of */
+    X509_STORE*         pStore;                                 /* current store; users hold own references        */
+    unsigned char       StoreStamp[SHA_DIGEST_LENGTH];          /* stamp of the store locations at load time       */
+    time_t              LastCheck;                              /* last check of the store locations               */
+    OpcUa_UInt32        uLastUse;                               /* for least recently used eviction                */
+};
+
+typedef struct _OpcUa_P_OpenSSL_SharedStore OpcUa_P_OpenSSL_SharedStore;
+
+static OpcUa_P_OpenSSL_SharedStore  OpcUa_P_OpenSSL_g_SharedStores[OPCUA_P_PKI_SHARED_STORES];
+static OpcUa_UInt32                 OpcUa_P_OpenSSL_g_uSharedStoreClock = 0;
+#if OPCUA_USE_SYNCHRONISATION
+static OpcUa_Mutex                  OpcUa_P_OpenSSL_g_SharedStoreMutex  = OpcUa_Null;
+#endif /* OPCUA_USE_SYNCHRONISATION */
+#endif /* OPCUA_P_PKI_SHARED_STORES */
+
+#if OPCUA_P_PKI_VALIDATION_CACHE_SIZE
+/*============================================================================
+ * Certificate validation cache
+ *===========================================================================*/
+/**
+* @brief A validation result for a certificate (chain) checked against a store configuration.
+*/
+struct _OpcUa_P_OpenSSL_ValidationCacheEntry
+{
+    OpcUa_Boolean       bInUse;                                 /* false if the slot is unused                     */
+    unsigned char       StoreKey[SHA_DIGEST_LENGTH];            /* key of the configuration validated against      */
+    unsigned char       Thumbprint[SHA_DIGEST_LENGTH];          /* SHA-1 over the whole certificate bytestring     */
+    unsigned char       StoreStamp[SHA_DIGEST_LENGTH];          /* stamp of the store locations validated against */
+    time_t              Expires;                                /* result must be revalidated from here on         */
+    OpcUa_StatusCode    uStatus;                                /* cached result                                   */
+    OpcUa_Int           iValidationCode;                        /* cached OpenSSL validation code                  */
+    OpcUa_UInt32        uLastUse;                               /* for least recently used eviction                */
+};
+
+typedef struct _OpcUa_P_OpenSSL_ValidationCacheEntry OpcUa_P_OpenSSL_ValidationCacheEntry;
+
+static OpcUa_P_OpenSSL_ValidationCacheEntry OpcUa_P_OpenSSL_g_ValidationCache[OPCUA_P_PKI_VALIDATION_CACHE_SIZE];
+static OpcUa_UInt32                         OpcUa_P_OpenSSL_g_uValidationCacheClock = 0;
+#if OPCUA_USE_SYNCHRONISATION
+static OpcUa_Mutex                          OpcUa_P_OpenSSL_g_ValidationCacheMutex  = OpcUa_Null;
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+/*============================================================================
+ * OpcUa_P_OpenSSL_PKI_GetValidationExpiry
+ *===========================================================================*/
+/** @brief Limit the lifetime of a validation result by the certificate validity and the next CRL update. */
+static time_t OpcUa_P_OpenSSL_PKI_GetValidationExpiry(
+    OpcUa_P_OpenSSL_CertificateStore_Config*    a_pCertificateStoreCfg,
+    X509_STORE*                                 a_pStore,
+    X509*                                       a_pCertificate,
+    time_t                                      a_Now)
+{
+    time_t  Expires = a_Now + OPCUA_P_PKI_VALIDATION_CACHE_TTL;
+    int     iDays   = 0;
+    int     iSecs   = 0;
+
+    /* a certificate which is not yet valid gets a different result at notBefore */
+    if(ASN1_TIME_diff(&iDays, &iSecs, OpcUa_Null, X509_get_notBefore(a_pCertificate)) == 1 && (iDays > 0 || iSecs > 0))
+    {
+        if(a_Now + (time_t)iDays * 86400 + iSecs < Expires)
+        {
+            Expires = a_Now + (time_t)iDays * 86400 + iSecs;
+        }
+    }
+
+    if(ASN1_TIME_diff(&iDays, &iSecs, OpcUa_Null, X509_get_notAfter(a_pCertificate)) == 1)
+    {
+        if(a_Now + (time_t)iDays * 86400 + iSecs < Expires)
+        {
+            Expires = a_Now + (time_t)iDays * 86400 + iSecs;
+        }
+    }
+
+    /* the revocation state may change with the next CRL */
+    if(a_pCertificateStoreCfg->Flags & OPCUA_P_PKI_OPENSSL_CHECK_REVOCATION_ALL)
+    {
+        STACK_OF(X509_OBJECT)*  pObjects;
+        X509_OBJECT*            pObject;
+        const ASN1_TIME*        pNextUpdate;
+        int                     i;
+
+#if OPENSSL_VERSION_NUMBER >= 0x1010000fL
+        pObjects = X509_STORE_get0_objects(a_pStore);
+#else
+        pObjects = a_pStore->objs;
+#endif
+
+        for(i = 0; i < sk_X509_OBJECT_num(pObjects); i++)
+        {
+            pObject = sk_X509_OBJECT_value(pObjects, i);
+
+#if OPENSSL_VERSION_NUMBER >= 0x1010000fL
+            if(X509_OBJECT_get_type(pObject) != X509_LU_CRL)
+            {
+                continue;
+            }
+            pNextUpdate = X509_CRL_get0_nextUpdate(X509_OBJECT_get0_X509_CRL(pObject));
+#else
+            if(pObject->type != X509_LU_CRL)
+            {
+                continue;
+            }
+            pNextUpdate = X509_CRL_get_nextUpdate(pObject->data.crl);
+#endif
+
+            if(pNextUpdate != OpcUa_Null && ASN1_TIME_diff(&iDays, &iSecs, OpcUa_Null, pNextUpdate) == 1)
+            {
+                if(a_Now + (time_t)iDays * 86400 + iSecs < Expires)
+                {
+                    Expires = a_Now + (time_t)iDays * 86400 + iSecs;
+                }
+            }
+        }
+    }
+
+    return Expires;
+}
+
+/*============================================================================
+ * OpcUa_P_OpenSSL_PKI_FindValidationResult
+ *===========================================================================*/
+/** @brief Look up a still valid result for the given thumbprint and store state. */
+static OpcUa_Boolean OpcUa_P_OpenSSL_PKI_FindValidationResult(
+    unsigned char*                              a_pStoreKey,
+    unsigned char*                              a_pThumbprint,
+    unsigned char*                              a_pStoreStamp,
+    time_t                                      a_Now,
+    OpcUa_StatusCode*                           a_pStatus,
+    OpcUa_Int*                                  a_pValidationCode)
+{
+    OpcUa_P_OpenSSL_ValidationCacheEntry*   pEntry;
+    OpcUa_Boolean                           bFound  = OpcUa_False;
+    OpcUa_UInt32                            i;
+
+#if OPCUA_USE_SYNCHRONISATION
+    OpcUa_P_Mutex_Lock(OpcUa_P_OpenSSL_g_ValidationCacheMutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+    for(i = 0; i < OPCUA_P_PKI_VALIDATION_CACHE_SIZE; i++)
+    {
+        pEntry = &OpcUa_P_OpenSSL_g_ValidationCache[i];
+
+        if(     pEntry->bInUse == OpcUa_False
+            ||  OpcUa_MemCmp(pEntry->StoreKey, a_pStoreKey, SHA_DIGEST_LENGTH) != 0
+            ||  OpcUa_MemCmp(pEntry->Thumbprint, a_pThumbprint, SHA_DIGEST_LENGTH) != 0)
+        {
+            continue;
+        }
+
+        /* drop the result if it is outdated or the store changed */
+        if(     pEntry->Expires <= a_Now
+            ||  OpcUa_MemCmp(pEntry->StoreStamp, a_pStoreStamp, sizeof(pEntry->StoreStamp)) != 0)
+        {
+            pEntry->bInUse = OpcUa_False;
+            break;
+        }
+
+        pEntry->uLastUse     = ++OpcUa_P_OpenSSL_g_uValidationCacheClock;
+        *a_pStatus           = pEntry->uStatus;
+        *a_pValidationCode   = pEntry->iValidationCode;
+        bFound               = OpcUa_True;
+        break;
+    }
+
+#if OPCUA_USE_SYNCHRONISATION
+    OpcUa_P_Mutex_Unlock(OpcUa_P_OpenSSL_g_ValidationCacheMutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+    return bFound;
+}
+
+/*============================================================================
+ * OpcUa_P_OpenSSL_PKI_AddValidationResult
+ *===========================================================================*/
+/** @brief Store a result in a free slot or in place of the least recently used one. */
+static OpcUa_Void OpcUa_P_OpenSSL_PKI_AddValidationResult(
+    unsigned char*                              a_pStoreKey,
+    unsigned char*                              a_pThumbprint,
+    unsigned char*                              a_pStoreStamp,
+    time_t                                      a_Expires,
+    OpcUa_StatusCode                            a_uStatus,
+    OpcUa_Int                                   a_iValidationCode)
+{
+    OpcUa_P_OpenSSL_ValidationCacheEntry*   pEntry  = &OpcUa_P_OpenSSL_g_ValidationCache[0];
+    OpcUa_UInt32                            i;
+
+#if OPCUA_USE_SYNCHRONISATION
+    OpcUa_P_Mutex_Lock(OpcUa_P_OpenSSL_g_ValidationCacheMutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+    for(i = 0; i < OPCUA_P_PKI_VALIDATION_CACHE_SIZE; i++)
+    {
+        if(OpcUa_P_OpenSSL_g_ValidationCache[i].bInUse == OpcUa_False)
+        {
+            pEntry = &OpcUa_P_OpenSSL_g_ValidationCache[i];
+            break;
+        }
+
+        if(OpcUa_P_OpenSSL_g_ValidationCache[i].uLastUse < pEntry->uLastUse)
+        {
+            pEntry = &OpcUa_P_OpenSSL_g_ValidationCache[i];
+        }
+    }
+
+    pEntry->bInUse          = OpcUa_True;
+    OpcUa_P_Memory_MemCpy(pEntry->StoreKey, SHA_DIGEST_LENGTH, a_pStoreKey, SHA_DIGEST_LENGTH);
+    OpcUa_P_Memory_MemCpy(pEntry->Thumbprint, SHA_DIGEST_LENGTH, a_pThumbprint, SHA_DIGEST_LENGTH);
+    OpcUa_P_Memory_MemCpy(pEntry->StoreStamp, sizeof(pEntry->StoreStamp), a_pStoreStamp, sizeof(pEntry->StoreStamp));
+    pEntry->Expires         = a_Expires;
+    pEntry->uStatus         = a_uStatus;
+    pEntry->iValidationCode = a_iValidationCode;
+    pEntry->uLastUse        = ++OpcUa_P_OpenSSL_g_uValidationCacheClock;
+
+#if OPCUA_USE_SYNCHRONISATION
+    OpcUa_P_Mutex_Unlock(OpcUa_P_OpenSSL_g_ValidationCacheMutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+}
+#endif /* OPCUA_P_PKI_VALIDATION_CACHE_SIZE */
+
+/*============================================================================
+ * OpcUa_P_OpenSSL_PKI_Initialize
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_P_OpenSSL_PKI_Initialize(OpcUa_Void)
+{
+OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_Initialize");
+
+#if OPCUA_P_PKI_VALIDATION_CACHE_SIZE
+    OpcUa_MemSet(OpcUa_P_OpenSSL_g_ValidationCache, 0, sizeof(OpcUa_P_OpenSSL_g_ValidationCache));
+    OpcUa_P_OpenSSL_g_uValidationCacheClock = 0;
+
+#if OPCUA_USE_SYNCHRONISATION
+    uStatus = OpcUa_P_Mutex_Create(&OpcUa_P_OpenSSL_g_ValidationCacheMutex);
+    OpcUa_GotoErrorIfBad(uStatus);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+#endif /* OPCUA_P_PKI_VALIDATION_CACHE_SIZE */
+
+#if OPCUA_P_PKI_SHARED_STORES
+    OpcUa_MemSet(OpcUa_P_OpenSSL_g_SharedStores, 0, sizeof(OpcUa_P_OpenSSL_g_SharedStores));
+    OpcUa_P_OpenSSL_g_uSharedStoreClock = 0;
+
+#if OPCUA_USE_SYNCHRONISATION
+    uStatus = OpcUa_P_Mutex_Create(&OpcUa_P_OpenSSL_g_SharedStoreMutex);
+    OpcUa_GotoErrorIfBad(uStatus);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+#endif /* OPCUA_P_PKI_SHARED_STORES */
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_P_OpenSSL_PKI_Cleanup();
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * OpcUa_P_OpenSSL_PKI_Cleanup
+ *===========================================================================*/
+OpcUa_Void OpcUa_P_OpenSSL_PKI_Cleanup(OpcUa_Void)
+{
+#if OPCUA_P_PKI_VALIDATION_CACHE_SIZE
+#if OPCUA_USE_SYNCHRONISATION
+    if(OpcUa_P_OpenSSL_g_ValidationCacheMutex != OpcUa_Null)
+    {
+        OpcUa_P_Mutex_Delete(&OpcUa_P_OpenSSL_g_ValidationCacheMutex);
+    }
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+    OpcUa_MemSet(OpcUa_P_OpenSSL_g_ValidationCache, 0, sizeof(OpcUa_P_OpenSSL_g_ValidationCache));
+#endif /* OPCUA_P_PKI_VALIDATION_CACHE_SIZE */
+
+#if OPCUA_P_PKI_SHARED_STORES
+    {
+        OpcUa_UInt32 i;
+
+#if OPCUA_USE_SYNCHRONISATION
+        if(OpcUa_P_OpenSSL_g_SharedStoreMutex != OpcUa_Null)
+        {
+            OpcUa_P_Mutex_Delete(&OpcUa_P_OpenSSL_g_SharedStoreMutex);
+        }
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+        for(i = 0; i < OPCUA_P_PKI_SHARED_STORES; i++)
+        {
+            if(OpcUa_P_OpenSSL_g_SharedStores[i].pStore != OpcUa_Null)
+            {
+                X509_STORE_free(OpcUa_P_OpenSSL_g_SharedStores[i].pStore);
+            }
+        }
+
+        OpcUa_MemSet(OpcUa_P_OpenSSL_g_SharedStores, 0, sizeof(OpcUa_P_OpenSSL_g_SharedStores));
+    }
+#endif /* OPCUA_P_PKI_SHARED_STORES */
+}
+
 /*============================================================================
  * verify_callback
  *===========================================================================*/
@@ -198,11 +641,12 @@ static OpcUa_Int OpcUa_P_OpenSSL_CertificateStore_Verify_Callback(int a_ok, X509
 }
 
 /*============================================================================
- * OpcUa_P_OpenSSL_CertificateStore_Open
+ * OpcUa_P_OpenSSL_PKI_LoadCertificateStore
  *===========================================================================*/
-OpcUa_StatusCode OpcUa_P_OpenSSL_PKI_OpenCertificateStore(
+/** @brief Build a new store from the configured locations. */
+static OpcUa_StatusCode OpcUa_P_OpenSSL_PKI_LoadCertificateStore(
     OpcUa_PKIProvider*          a_pProvider,
-    OpcUa_Void**                a_ppCertificateStore)           /* type depends on store implementation */
+    OpcUa_Void**                a_ppCertificateStore)
 {
     OpcUa_P_OpenSSL_CertificateStore_Config*    pCertificateStoreCfg;
     X509_STORE*         pStore;
@@ -213,7 +657,7 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_PKI_OpenCertificateStore(
     DWORD               dwError;
     WIN32_FIND_DATA     FindFileData;
 
-OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_OpenCertificateStore");
+OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_LoadCertificateStore");
 
     OpcUa_ReturnErrorIfArgumentNull(a_pProvider);
     OpcUa_ReturnErrorIfArgumentNull(a_pProvider->Handle);
@@ -291,6 +735,45 @@ OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_OpenCertificateStore");
 
         if(pCertificateStoreCfg->Flags & OPCUA_P_PKI_OPENSSL_UNTRUSTED_LIST_IS_INDEX)
         {
+#if OPCUA_P_PKI_SHARED_STORES
+            /* the store stays in memory, so load the whole index instead of searching it on each validation */
+            if(!(pLookup = X509_STORE_add_lookup(pStore, X509_LOOKUP_file())))
+            {
+                OpcUa_GotoErrorWithStatus(OpcUa_Bad);
+            }
+
+            uStatus = OpcUa_P_OpenSSL_BuildFullPath(pCertificateStoreCfg->CertificateUntrustedListLocation, TEXT("*"), MAX_PATH, DirSpec);
+            OpcUa_GotoErrorIfBad(uStatus);
+
+            hFind = FindFirstFile(DirSpec, &FindFileData);
+            if(hFind != INVALID_HANDLE_VALUE)
+            {
+                do {
+                    if(FindFileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+                    {
+                        continue;
+                    }
+
+                    uStatus = OpcUa_P_OpenSSL_BuildFullPath(pCertificateStoreCfg->CertificateUntrustedListLocation, FindFileData.cFileName, MAX_PATH, CertFile);
+                    OpcUa_GotoErrorIfBad(uStatus);
+
+                    if(X509_LOOKUP_load_file(pLookup, CertFile, X509_FILETYPE_ASN1) != 1) /* DER encoded */
+                    {
+                        OpcUa_Trace(OPCUA_TRACE_LEVEL_INFO, "error at X509_LOOKUP_load_file: skipping %s\n", CertFile);
+                    }
+                }
+                while(FindNextFile(hFind, &FindFileData) != 0);
+
+                dwError = GetLastError();
+                if(dwError != ERROR_NO_MORE_FILES)
+                {
+                    OpcUa_GotoErrorWithStatus(OpcUa_Bad);
+                }
+
+                FindClose(hFind);
+                hFind = INVALID_HANDLE_VALUE;
+            }
+#else /* OPCUA_P_PKI_SHARED_STORES */
             /* how to search for certificate */
             if(!(pLookup = X509_STORE_add_lookup(pStore, X509_LOOKUP_hash_dir())))
             {
@@ -303,6 +786,7 @@ OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_OpenCertificateStore");
                 OpcUa_Trace(OPCUA_TRACE_LEVEL_ERROR, "error at X509_LOOKUP_add_dir!\n");
                 OpcUa_GotoErrorWithStatus(OpcUa_Bad);
             }
+#endif /* OPCUA_P_PKI_SHARED_STORES */
         }
         else
         {
@@ -351,6 +835,45 @@ OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_OpenCertificateStore");
 
         if(pCertificateStoreCfg->Flags & OPCUA_P_PKI_OPENSSL_REVOCATION_LIST_IS_INDEX)
         {
+#if OPCUA_P_PKI_SHARED_STORES
+            /* the store stays in memory, so load the whole index instead of searching it on each validation */
+            if(!(pLookup = X509_STORE_add_lookup(pStore, X509_LOOKUP_file())))
+            {
+                OpcUa_GotoErrorWithStatus(OpcUa_Bad);
+            }
+
+            uStatus = OpcUa_P_OpenSSL_BuildFullPath(pCertificateStoreCfg->CertificateRevocationListLocation, TEXT("*"), MAX_PATH, DirSpec);
+            OpcUa_GotoErrorIfBad(uStatus);
+
+            hFind = FindFirstFile(DirSpec, &FindFileData);
+            if(hFind != INVALID_HANDLE_VALUE)
+            {
+                do {
+                    if(FindFileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+                    {
+                        continue;
+                    }
+
+                    uStatus = OpcUa_P_OpenSSL_BuildFullPath(pCertificateStoreCfg->CertificateRevocationListLocation, FindFileData.cFileName, MAX_PATH, CertFile);
+                    OpcUa_GotoErrorIfBad(uStatus);
+
+                    if(X509_load_crl_file(pLookup, CertFile, X509_FILETYPE_PEM) != 1) /* PEM encoded */
+                    {
+                        OpcUa_Trace(OPCUA_TRACE_LEVEL_INFO, "error at X509_load_crl_file: skipping %s\n", CertFile);
+                    }
+                }
+                while(FindNextFile(hFind, &FindFileData) != 0);
+
+                dwError = GetLastError();
+                if(dwError != ERROR_NO_MORE_FILES)
+                {
+                    OpcUa_GotoErrorWithStatus(OpcUa_Bad);
+                }
+
+                FindClose(hFind);
+                hFind = INVALID_HANDLE_VALUE;
+            }
+#else /* OPCUA_P_PKI_SHARED_STORES */
             /* how to search for certificate & CRLs */
             if(!(pLookup = X509_STORE_add_lookup(pStore, X509_LOOKUP_hash_dir())))
             {
@@ -363,6 +886,7 @@ OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_OpenCertificateStore");
                 OpcUa_Trace(OPCUA_TRACE_LEVEL_ERROR, "error at X509_LOOKUP_add_dir!\n");
                 OpcUa_GotoErrorWithStatus(OpcUa_Bad);
             }
+#endif /* OPCUA_P_PKI_SHARED_STORES */
         }
         else if(pCertificateStoreCfg->Flags & OPCUA_P_PKI_OPENSSL_REVOCATION_LIST_IS_CONCATENATED_PEM_FILE)
         {
@@ -471,6 +995,209 @@ OpcUa_BeginErrorHandling;
 OpcUa_FinishErrorHandling;
 }
 
+#if OPCUA_P_PKI_SHARED_STORES
+/*============================================================================
+ * OpcUa_P_OpenSSL_PKI_GetSharedStore
+ *===========================================================================*/
+/** @brief Get the in-memory store of a configuration; load it if missing, forced or if a store location changed. */
+static OpcUa_StatusCode OpcUa_P_OpenSSL_PKI_GetSharedStore(
+    OpcUa_PKIProvider*          a_pProvider,
+    OpcUa_Boolean               a_bReload,
+    X509_STORE**                a_ppStore)
+{
+    OpcUa_P_OpenSSL_CertificateStore_Config*    pCertificateStoreCfg    = (OpcUa_P_OpenSSL_CertificateStore_Config*)a_pProvider->Handle;
+    OpcUa_P_OpenSSL_SharedStore*                pSharedStore            = &OpcUa_P_OpenSSL_g_SharedStores[0];
+    X509_STORE*                                 pNewStore               = OpcUa_Null;
+    unsigned char                               StoreKey[SHA_DIGEST_LENGTH];
+    unsigned char                               StoreStamp[SHA_DIGEST_LENGTH];
+    time_t                                      Now                     = time(OpcUa_Null);
+    OpcUa_Boolean                               bLoad                   = a_bReload;
+    OpcUa_UInt32                                i;
+
+OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_GetSharedStore");
+
+    OpcUa_P_OpenSSL_PKI_GetStoreKey(pCertificateStoreCfg, StoreKey);
+
+#if OPCUA_USE_SYNCHRONISATION
+    OpcUa_P_Mutex_Lock(OpcUa_P_OpenSSL_g_SharedStoreMutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+    /* find the store of this configuration or take the least recently used slot */
+    for(i = 0; i < OPCUA_P_PKI_SHARED_STORES; i++)
+    {
+        if(     OpcUa_P_OpenSSL_g_SharedStores[i].bInUse != OpcUa_False
+            &&  OpcUa_MemCmp(OpcUa_P_OpenSSL_g_SharedStores[i].StoreKey, StoreKey, SHA_DIGEST_LENGTH) == 0)
+        {
+            pSharedStore = &OpcUa_P_OpenSSL_g_SharedStores[i];
+            break;
+        }
+
+        if(OpcUa_P_OpenSSL_g_SharedStores[i].uLastUse < pSharedStore->uLastUse)
+        {
+            pSharedStore = &OpcUa_P_OpenSSL_g_SharedStores[i];
+        }
+    }
+
+    if(i == OPCUA_P_PKI_SHARED_STORES)
+    {
+        if(pSharedStore->pStore != OpcUa_Null)
+        {
+            X509_STORE_free(pSharedStore->pStore);
+        }
+
+        OpcUa_MemSet(pSharedStore, 0, sizeof(OpcUa_P_OpenSSL_SharedStore));
+        pSharedStore->bInUse = OpcUa_True;
+        OpcUa_P_Memory_MemCpy(pSharedStore->StoreKey, SHA_DIGEST_LENGTH, StoreKey, SHA_DIGEST_LENGTH);
+    }
+
+    /* look for changes of the store locations at most once per check interval */
+    if(bLoad || pSharedStore->pStore == OpcUa_Null || Now - pSharedStore->LastCheck >= OPCUA_P_PKI_STORE_CHECK_INTERVAL)
+    {
+        OpcUa_P_OpenSSL_PKI_GetStoreStamp(pCertificateStoreCfg, StoreStamp);
+        pSharedStore->LastCheck = Now;
+
+        if(     pSharedStore->pStore == OpcUa_Null
+            ||  OpcUa_MemCmp(StoreStamp, pSharedStore->StoreStamp, sizeof(StoreStamp)) != 0)
+        {
+            bLoad = OpcUa_True;
+        }
+    }
+
+    if(bLoad)
+    {
+        uStatus = OpcUa_P_OpenSSL_PKI_LoadCertificateStore(a_pProvider, (OpcUa_Void**)&pNewStore);
+
+        if(OpcUa_IsBad(uStatus))
+        {
+            /* keep working with the old store and retry at the next check */
+            OpcUa_Trace(OPCUA_TRACE_LEVEL_WARNING, "OpcUa_P_OpenSSL_PKI_GetSharedStore: could not load certificate store (0x%08X)!\n", uStatus);
+            OpcUa_GotoErrorIfTrue((a_bReload || pSharedStore->pStore == OpcUa_Null), uStatus);
+            uStatus = OpcUa_Good;
+        }
+        else
+        {
+            /* swap in the new store; current users keep their reference to the old one */
+            if(pSharedStore->pStore != OpcUa_Null)
+            {
+                X509_STORE_free(pSharedStore->pStore);
+            }
+
+            pSharedStore->pStore = pNewStore;
+            OpcUa_P_Memory_MemCpy(pSharedStore->StoreStamp, sizeof(pSharedStore->StoreStamp), StoreStamp, sizeof(StoreStamp));
+        }
+    }
+
+    if(a_ppStore != OpcUa_Null)
+    {
+#if OPENSSL_VERSION_NUMBER >= 0x1010000fL
+        X509_STORE_up_ref(pSharedStore->pStore);
+#else
+        CRYPTO_add(&pSharedStore->pStore->references, 1, CRYPTO_LOCK_X509_STORE);
+#endif
+        *a_ppStore = pSharedStore->pStore;
+    }
+
+    pSharedStore->uLastUse = ++OpcUa_P_OpenSSL_g_uSharedStoreClock;
+
+#if OPCUA_USE_SYNCHRONISATION
+    OpcUa_P_Mutex_Unlock(OpcUa_P_OpenSSL_g_SharedStoreMutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+#if OPCUA_USE_SYNCHRONISATION
+    OpcUa_P_Mutex_Unlock(OpcUa_P_OpenSSL_g_SharedStoreMutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * OpcUa_P_OpenSSL_PKI_GetLoadedStoreStamp
+ *===========================================================================*/
+/** @brief Get the stamp of the locations a shared store was loaded from without touching the disk. */
+static OpcUa_Boolean OpcUa_P_OpenSSL_PKI_GetLoadedStoreStamp(
+    X509_STORE*                 a_pStore,
+    unsigned char*              a_pStoreStamp)
+{
+    OpcUa_Boolean   bFound  = OpcUa_False;
+    OpcUa_UInt32    i;
+
+#if OPCUA_USE_SYNCHRONISATION
+    OpcUa_P_Mutex_Lock(OpcUa_P_OpenSSL_g_SharedStoreMutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+    for(i = 0; i < OPCUA_P_PKI_SHARED_STORES; i++)
+    {
+        if(OpcUa_P_OpenSSL_g_SharedStores[i].pStore == a_pStore)
+        {
+            OpcUa_P_Memory_MemCpy(  a_pStoreStamp,
+                                    sizeof(OpcUa_P_OpenSSL_g_SharedStores[i].StoreStamp),
+                                    OpcUa_P_OpenSSL_g_SharedStores[i].StoreStamp,
+                                    sizeof(OpcUa_P_OpenSSL_g_SharedStores[i].StoreStamp));
+            bFound = OpcUa_True;
+            break;
+        }
+    }
+
+#if OPCUA_USE_SYNCHRONISATION
+    OpcUa_P_Mutex_Unlock(OpcUa_P_OpenSSL_g_SharedStoreMutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+    return bFound;
+}
+#endif /* OPCUA_P_PKI_SHARED_STORES */
+
+/*============================================================================
+ * OpcUa_P_OpenSSL_CertificateStore_Open
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_P_OpenSSL_PKI_OpenCertificateStore(
+    OpcUa_PKIProvider*          a_pProvider,
+    OpcUa_Void**                a_ppCertificateStore)           /* type depends on store implementation */
+{
+OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_OpenCertificateStore");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_pProvider);
+    OpcUa_ReturnErrorIfArgumentNull(a_pProvider->Handle);
+    OpcUa_ReturnErrorIfArgumentNull(a_ppCertificateStore);
+
+    *a_ppCertificateStore = OpcUa_Null;
+
+#if OPCUA_P_PKI_SHARED_STORES
+    /* hand out a reference to the in-memory store; released by CloseCertificateStore */
+    uStatus = OpcUa_P_OpenSSL_PKI_GetSharedStore(a_pProvider, OpcUa_False, (X509_STORE**)a_ppCertificateStore);
+#else /* OPCUA_P_PKI_SHARED_STORES */
+    uStatus = OpcUa_P_OpenSSL_PKI_LoadCertificateStore(a_pProvider, a_ppCertificateStore);
+#endif /* OPCUA_P_PKI_SHARED_STORES */
+    OpcUa_GotoErrorIfBad(uStatus);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * OpcUa_P_OpenSSL_PKI_ReloadCertificateStore
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_P_OpenSSL_PKI_ReloadCertificateStore(
+    OpcUa_PKIProvider*          a_pProvider)
+{
+OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_ReloadCertificateStore");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_pProvider);
+    OpcUa_ReturnErrorIfArgumentNull(a_pProvider->Handle);
+
+#if OPCUA_P_PKI_SHARED_STORES
+    uStatus = OpcUa_P_OpenSSL_PKI_GetSharedStore(a_pProvider, OpcUa_True, OpcUa_Null);
+    OpcUa_GotoErrorIfBad(uStatus);
+#endif /* OPCUA_P_PKI_SHARED_STORES */
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
 /*============================================================================
  * OpcUa_P_OpenSSL_CertificateStore_Close
  *===========================================================================*/
@@ -510,6 +1237,13 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_PKI_ValidateCertificate(
     X509*               pX509Certificate        = OpcUa_Null;
     STACK_OF(X509)*     pX509Chain              = OpcUa_Null;
     X509_STORE_CTX*     verify_ctx              = OpcUa_Null;    /* holds data used during verification process */
+#if OPCUA_P_PKI_VALIDATION_CACHE_SIZE
+    unsigned char       Thumbprint[SHA_DIGEST_LENGTH];
+    unsigned char       StoreKey[SHA_DIGEST_LENGTH];
+    unsigned char       StoreStamp[SHA_DIGEST_LENGTH];
+    time_t              Now                     = 0;
+    OpcUa_Boolean       bCacheResult            = OpcUa_False;
+#endif /* OPCUA_P_PKI_VALIDATION_CACHE_SIZE */
 
     HANDLE              hFind                   = INVALID_HANDLE_VALUE;
     char                DirSpec[MAX_PATH];
@@ -526,6 +1260,27 @@ OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_ValidateCertificate");
 
     pCertificateStoreCfg = (OpcUa_P_OpenSSL_CertificateStore_Config*)a_pProvider->Handle;
 
+#if OPCUA_P_PKI_VALIDATION_CACHE_SIZE
+    /* reuse the result of a recent validation of the same certificate against an unchanged store */
+    if(a_pCertificate->Length > 0)
+    {
+        Now = time(OpcUa_Null);
+        SHA1(a_pCertificate->Data, (size_t)a_pCertificate->Length, Thumbprint);
+        OpcUa_P_OpenSSL_PKI_GetStoreKey(pCertificateStoreCfg, StoreKey);
+#if OPCUA_P_PKI_SHARED_STORES
+        if(!OpcUa_P_OpenSSL_PKI_GetLoadedStoreStamp((X509_STORE*)a_pCertificateStore, StoreStamp))
+#endif /* OPCUA_P_PKI_SHARED_STORES */
+        {
+            OpcUa_P_OpenSSL_PKI_GetStoreStamp(pCertificateStoreCfg, StoreStamp);
+        }
+
+        if(OpcUa_P_OpenSSL_PKI_FindValidationResult(StoreKey, Thumbprint, StoreStamp, Now, &uStatus, a_pValidationCode))
+        {
+            return uStatus;
+        }
+    }
+#endif /* OPCUA_P_PKI_VALIDATION_CACHE_SIZE */
+
     /* convert DER encoded bytestring certificate to openssl X509 certificate */
     p = a_pCertificate->Data;
     if(!(pX509Certificate = d2i_X509((X509**)OpcUa_Null, &p, a_pCertificate->Length)))
@@ -584,6 +1339,9 @@ OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_ValidateCertificate");
     }
 
     /* verify the certificate */
+#if OPCUA_P_PKI_VALIDATION_CACHE_SIZE
+    bCacheResult = (a_pCertificate->Length > 0)?OpcUa_True:OpcUa_False;
+#endif /* OPCUA_P_PKI_VALIDATION_CACHE_SIZE */
     *a_pValidationCode = X509_V_OK;
     if(X509_verify_cert(verify_ctx) <= 0)
     {
@@ -624,6 +1382,13 @@ OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_ValidateCertificate");
                 uStatus = OpcUa_BadCertificateInvalid;
             }
         }
+#if OPCUA_P_PKI_VALIDATION_CACHE_SIZE
+        /* running out of memory during the verification says nothing about the certificate */
+        if(*a_pValidationCode == X509_V_ERR_OUT_OF_MEM)
+        {
+            bCacheResult = OpcUa_False;
+        }
+#endif /* OPCUA_P_PKI_VALIDATION_CACHE_SIZE */
         OpcUa_GotoErrorIfBad(uStatus);
     }
 
@@ -632,10 +1397,14 @@ OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_ValidateCertificate");
         BIO*             pCertificateFile;
         X509*            pTrustCert;
         STACK_OF(X509)*  chain;
-        int              trusted, n;
+        int              trusted, listed, n;
 
         chain = X509_STORE_CTX_get_chain(verify_ctx);
         trusted = 0;
+#if OPCUA_P_PKI_VALIDATION_CACHE_SIZE
+        /* only a completely scanned trust list gives a result worth caching */
+        bCacheResult = OpcUa_False;
+#endif /* OPCUA_P_PKI_VALIDATION_CACHE_SIZE */
         if(pCertificateStoreCfg->CertificateTrustListLocation == NULL || pCertificateStoreCfg->CertificateTrustListLocation[0] == '\0')
         {
             uStatus = OpcUa_Bad;
@@ -646,6 +1415,7 @@ OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_ValidateCertificate");
         OpcUa_GotoErrorIfBad(uStatus);
 
         hFind = FindFirstFile(DirSpec, &FindFileData);
+        listed = (hFind != INVALID_HANDLE_VALUE || GetLastError() == ERROR_FILE_NOT_FOUND);
         if(hFind != INVALID_HANDLE_VALUE)
         {
             do {
@@ -687,11 +1457,23 @@ OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_ValidateCertificate");
 
         if(!trusted)
         {
+#if OPCUA_P_PKI_VALIDATION_CACHE_SIZE
+            bCacheResult = listed?OpcUa_True:OpcUa_False;
+#endif /* OPCUA_P_PKI_VALIDATION_CACHE_SIZE */
             uStatus = OpcUa_BadCertificateUntrusted;
             OpcUa_GotoErrorIfBad(uStatus);
         }
     }
 
+#if OPCUA_P_PKI_VALIDATION_CACHE_SIZE
+    OpcUa_P_OpenSSL_PKI_AddValidationResult(StoreKey,
+                                            Thumbprint,
+                                            StoreStamp,
+                                            OpcUa_P_OpenSSL_PKI_GetValidationExpiry(pCertificateStoreCfg, (X509_STORE*)a_pCertificateStore, pX509Certificate, Now),
+                                            uStatus,
+                                            *a_pValidationCode);
+#endif /* OPCUA_P_PKI_VALIDATION_CACHE_SIZE */
+
     X509_STORE_CTX_free(verify_ctx);
     X509_free(pX509Certificate);
     if(pX509Chain != OpcUa_Null)
@@ -702,6 +1484,18 @@ OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_ValidateCertificate");
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
 
+#if OPCUA_P_PKI_VALIDATION_CACHE_SIZE
+    if(bCacheResult != OpcUa_False)
+    {
+        OpcUa_P_OpenSSL_PKI_AddValidationResult(StoreKey,
+                                                Thumbprint,
+                                                StoreStamp,
+                                                OpcUa_P_OpenSSL_PKI_GetValidationExpiry(pCertificateStoreCfg, (X509_STORE*)a_pCertificateStore, pX509Certificate, Now),
+                                                uStatus,
+                                                *a_pValidationCode);
+    }
+#endif /* OPCUA_P_PKI_VALIDATION_CACHE_SIZE */
+
     if(hFind != INVALID_HANDLE_VALUE)
     {
         FindClose(hFind);
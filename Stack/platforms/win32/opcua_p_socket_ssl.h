@@ -37,6 +37,13 @@ OPCUA_BEGIN_EXTERN_C
 
 #if OPCUA_P_SOCKETMANAGER_SUPPORT_SSL
 
+/*============================================================================
+ * Initialize and clean up the shared SSL client profiles
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_P_SslSocket_Initialize(OpcUa_Void);
+
+OpcUa_Void OpcUa_P_SslSocket_Cleanup(OpcUa_Void);
+
 /*============================================================================
  * Create a SSL server socket
  *===========================================================================*/
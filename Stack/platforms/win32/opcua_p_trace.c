@@ -82,6 +82,10 @@ int OpcUa_Unlink(const char* filename);
     unsigned int    OpcUa_P_Trace_g_hOutFileNoOfEntriesMax  = OPCUA_P_TRACE_G_MAX_FILE_ENTRIES;
 #endif /* OPCUA_P_TRACE_TO_FILE */
 
+#if !OPCUA_P_TRACE_ENABLE_TIME
+static const OpcUa_DateTime OpcUa_P_Trace_g_NoTime = OPCUA_DATETIME_STATICINITIALIZER;
+#endif /* OPCUA_P_TRACE_ENABLE_TIME */
+
 /*============================================================================
  * Trace Initialize
  *===========================================================================*/
@@ -115,25 +119,18 @@ OpcUa_Void OPCUA_DLLCALL OpcUa_P_Trace_Clear(OpcUa_Void)
 }
 
 /*============================================================================
- * Tracefunction
+ * Trace Output
  *===========================================================================*/
 /**
- * Writes the given string to the trace device, if the given trace level is
- * activated in the header file.
+ * Sends the given message to the trace hook, the debugger and the console.
  */
-OpcUa_Void OPCUA_DLLCALL OpcUa_P_Trace(
-#if OPCUA_TRACE_FILE_LINE_INFO
-                                        OpcUa_UInt32 level,
-                                        OpcUa_CharA* sFile,
-                                        OpcUa_UInt32 line,
-#endif
-                                        OpcUa_CharA* a_sMessage)
+static OpcUa_Void OpcUa_P_Trace_Write(  OpcUa_UInt32    a_uThreadId,
+                                        OpcUa_DateTime  a_Timestamp,
+                                        OpcUa_CharA*    a_sMessage)
 {
-#if OPCUA_TRACE_FILE_LINE_INFO
-    OpcUa_ReferenceParameter(level);
-    OpcUa_ReferenceParameter(sFile);
-    OpcUa_ReferenceParameter(line);
-#endif
+#if !OPCUA_P_TRACE_ENABLE_TIME
+    OpcUa_ReferenceParameter(a_Timestamp);
+#endif /* OPCUA_P_TRACE_ENABLE_TIME */
 
     /* send to tracehook if registered */
     if(g_OpcUa_P_TraceHook != OpcUa_Null)
@@ -152,12 +149,12 @@ OpcUa_Void OPCUA_DLLCALL OpcUa_P_Trace(
 #endif
 
 #if OPCUA_P_TRACE_ENABLE_TIME
-        OpcUa_P_DateTime_GetStringFromDateTime(OpcUa_P_DateTime_UtcNow(), dtbuffer, 25);
+        OpcUa_P_DateTime_GetStringFromDateTime(a_Timestamp, dtbuffer, 25);
 #endif /* OPCUA_P_TRACE_ENABLE_TIME */
 
 #ifdef OPCUA_P_ENABLE_VS_CONSOLE
         /* visual studio debug console output */
-        _snprintf(buffer, 20, "|%d| ", OpcUa_P_Thread_GetCurrentThreadId());
+        _snprintf(buffer, 20, "|%d| ", a_uThreadId);
 #if OPCUA_P_TRACE_ENABLE_TIME
         OutputDebugStringA(dtbuffer);
 #endif /* OPCUA_P_TRACE_ENABLE_TIME */
@@ -166,15 +163,15 @@ OpcUa_Void OPCUA_DLLCALL OpcUa_P_Trace(
 #endif /* OPCUA_P_ENABLE_VS_CONSOLE */
 
 #ifndef OPCUA_P_TRACE_ENABLE_TIME
-        printf("|%d| %s", OpcUa_P_Thread_GetCurrentThreadId(), a_sMessage);
+        printf("|%d| %s", a_uThreadId, a_sMessage);
 #else
-        printf("|%d| %s %s", OpcUa_P_Thread_GetCurrentThreadId(), &dtbuffer[11], a_sMessage);
+        printf("|%d| %s %s", a_uThreadId, &dtbuffer[11], a_sMessage);
 #endif /* OPCUA_P_TRACE_ENABLE_TIME */
 
 #if OPCUA_P_TRACE_TO_FILE
         if(OpcUa_P_Trace_g_hOutFile != NULL)
         {
-            fprintf(OpcUa_P_Trace_g_hOutFile, "|%d| %s %s", OpcUa_P_Thread_GetCurrentThreadId(), &dtbuffer[11], a_sMessage);
+            fprintf(OpcUa_P_Trace_g_hOutFile, "|%d| %s %s", a_uThreadId, &dtbuffer[11], a_sMessage);
 #if OPCUA_P_TRACE_FFLUSH_IMMEDIATELY
             fflush(OpcUa_P_Trace_g_hOutFile);
 #endif
@@ -195,6 +192,62 @@ OpcUa_Void OPCUA_DLLCALL OpcUa_P_Trace(
     }
 }
 
+/*============================================================================
+ * Tracefunction
+ *===========================================================================*/
+/**
+ * Writes the given string to the trace device, if the given trace level is
+ * activated in the header file.
+ */
+OpcUa_Void OPCUA_DLLCALL OpcUa_P_Trace(
+#if OPCUA_TRACE_FILE_LINE_INFO
+                                        OpcUa_UInt32 level,
+                                        OpcUa_CharA* sFile,
+                                        OpcUa_UInt32 line,
+#endif
+                                        OpcUa_CharA* a_sMessage)
+{
+#if OPCUA_TRACE_FILE_LINE_INFO
+    OpcUa_ReferenceParameter(level);
+    OpcUa_ReferenceParameter(sFile);
+    OpcUa_ReferenceParameter(line);
+#endif
+
+    OpcUa_P_Trace_Write(OpcUa_P_Thread_GetCurrentThreadId(),
+#if OPCUA_P_TRACE_ENABLE_TIME
+                        OpcUa_P_DateTime_UtcNow(),
+#else /* OPCUA_P_TRACE_ENABLE_TIME */
+                        OpcUa_P_Trace_g_NoTime,
+#endif /* OPCUA_P_TRACE_ENABLE_TIME */
+                        a_sMessage);
+}
+
+/*============================================================================
+ * Trace Record
+ *===========================================================================*/
+/**
+ * Writes a trace line recorded earlier by the given thread at the given time.
+ */
+OpcUa_Void OPCUA_DLLCALL OpcUa_P_Trace_Record(
+                                        OpcUa_UInt64   a_uThreadId,
+                                        OpcUa_DateTime a_Timestamp,
+#if OPCUA_TRACE_FILE_LINE_INFO
+                                        OpcUa_UInt32   level,
+                                        OpcUa_CharA*   sFile,
+                                        OpcUa_UInt32   line,
+#endif
+                                        OpcUa_CharA*   a_sMessage)
+{
+#if OPCUA_TRACE_FILE_LINE_INFO
+    OpcUa_ReferenceParameter(level);
+    OpcUa_ReferenceParameter(sFile);
+    OpcUa_ReferenceParameter(line);
+#endif
+
+    /* the id came from OpcUa_P_Thread_GetCurrentThreadId */
+    OpcUa_P_Trace_Write((OpcUa_UInt32)a_uThreadId, a_Timestamp, a_sMessage);
+}
+
 #ifdef _WIN32_WCE
 int OpcUa_Unlink(const char* filename)
 {
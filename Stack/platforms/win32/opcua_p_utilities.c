@@ -169,6 +169,24 @@ OpcUa_UInt32 OPCUA_DLLCALL OpcUa_P_GetTickCount()
     return GetTickCount();
 }
 
+/*============================================================================
+ * OpcUa_GetMicroTickCount
+ *===========================================================================*/
+OpcUa_UInt64 OPCUA_DLLCALL OpcUa_P_GetMicroTickCount()
+{
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+
+    if(!QueryPerformanceFrequency(&frequency) || !QueryPerformanceCounter(&counter))
+    {
+        return (OpcUa_UInt64)GetTickCount() * 1000;
+    }
+
+    /* split to avoid the overflow of counter * 1000000 */
+    return (OpcUa_UInt64)(counter.QuadPart / frequency.QuadPart) * 1000000
+         + (OpcUa_UInt64)(counter.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart;
+}
+
 /*============================================================================
  * OpcUa_CharAToInt
  *===========================================================================*/
@@ -61,6 +61,11 @@ OpcUa_UInt32 OPCUA_DLLCALL OpcUa_P_GetLastError(void);
  */
 OpcUa_UInt32 OPCUA_DLLCALL OpcUa_P_GetTickCount(void);
 
+/**
+ * @see OpcUa_P_GetMicroTickCount
+ */
+OpcUa_UInt64 OPCUA_DLLCALL OpcUa_P_GetMicroTickCount(void);
+
 /**
  * @see OpcUa_P_CharAToInt
  */
@@ -94,6 +94,7 @@ OPCUA_BEGIN_EXTERN_C
 * Additional basic headers
 *===========================================================================*/
 #include <string.h>
+#include <intrin.h>
 
 /* configuration switches */
 #include <opcua_config.h>
@@ -171,6 +172,9 @@ OPCUA_BEGIN_EXTERN_C
 /* import prototype for direct mapping on memcmp */
 #define OpcUa_MemCmp(xBuf1, xBuf2, xBufSize)            memcmp(xBuf1, xBuf2, xBufSize)
 
+/* import prototype for direct mapping on memchr */
+#define OpcUa_MemChr(xBuf, xValue, xBufSize)            memchr(xBuf, xValue, xBufSize)
+
 /*============================================================================
  * String handling functions.
  *===========================================================================*/
@@ -220,6 +224,35 @@ OPCUA_IMPORT OpcUa_Int sscanf(const OpcUa_CharA* buffer, const OpcUa_CharA* form
 /* shortcuts to OpcUa_String functions */
 #define OpcUa_StrLen(xStr)                              OpcUa_String_StrLen(xStr)
 
+/*============================================================================
+ * Branch prediction hints.
+ *===========================================================================*/
+#define OpcUa_Likely(xCondition)                                    (xCondition)
+#define OpcUa_Unlikely(xCondition)                                  (xCondition)
+
+/*============================================================================
+ * Atomic operations and thread local storage.
+ *
+ * Used by modules which must not serialize on a mutex in the hot path
+ * (ie. the trace buffers). Loads have acquire, stores have release semantic.
+ *===========================================================================*/
+#define OPCUA_P_THREAD_LOCAL                                        __declspec(thread)
+
+#define OpcUa_Atomic_Load32(xPtr)                                   ((OpcUa_UInt32)_InterlockedOr((volatile long*)(xPtr), 0))
+#define OpcUa_Atomic_Store32(xPtr, xValue)                          ((void)_InterlockedExchange((volatile long*)(xPtr), (long)(xValue)))
+#define OpcUa_Atomic_Add32(xPtr, xValue)                            ((OpcUa_UInt32)(_InterlockedExchangeAdd((volatile long*)(xPtr), (long)(xValue)) + (long)(xValue)))
+#define OpcUa_Atomic_CompareExchange32(xPtr, xExpected, xDesired)   (_InterlockedCompareExchange((volatile long*)(xPtr), (long)(xDesired), (long)(xExpected)) == (long)(xExpected))
+
+#define OpcUa_Atomic_Load64(xPtr)                                   ((OpcUa_UInt64)_InterlockedCompareExchange64((volatile __int64*)(xPtr), 0, 0))
+#define OpcUa_Atomic_Store64(xPtr, xValue)                          ((void)_InterlockedExchange64((volatile __int64*)(xPtr), (__int64)(xValue)))
+#define OpcUa_Atomic_Add64(xPtr, xValue)                            ((OpcUa_UInt64)(_InterlockedExchangeAdd64((volatile __int64*)(xPtr), (__int64)(xValue)) + (__int64)(xValue)))
+
+#define OpcUa_Atomic_LoadPtr(xPtr)                                  _InterlockedCompareExchangePointer((void* volatile*)(xPtr), OpcUa_Null, OpcUa_Null)
+#define OpcUa_Atomic_StorePtr(xPtr, xValue)                         ((void)_InterlockedExchangePointer((void* volatile*)(xPtr), (void*)(xValue)))
+#define OpcUa_Atomic_ExchangePtr(xPtr, xValue)                      _InterlockedExchangePointer((void* volatile*)(xPtr), (void*)(xValue))
+
+#define OpcUa_Atomic_MemoryBarrier()                                do { volatile long xBarrier = 0; _InterlockedOr(&xBarrier, 0); } while(0)
+
 OPCUA_END_EXTERN_C
 
 #endif /* _OpcUa_PlatformDefs_H_ */
@@ -21,6 +21,8 @@
 
 /* core */
 #include <opcua_mutex.h>
+#include <opcua_latency.h>
+#include <opcua_datetime.h>
 
 /* types */
 #include <opcua_types.h>
@@ -28,8 +30,14 @@
 /* serializing */
 #include <opcua_binaryencoder.h>
 
+#ifdef OPCUA_SUPPORT_PREENCODED_MESSAGES
+#include <opcua_memorystream.h>
+#endif /* OPCUA_SUPPORT_PREENCODED_MESSAGES */
+
 /* communication */
 #include <opcua_securelistener.h>
+#include <opcua_securechannel.h>
+#include <opcua_securestream.h>
 #include <opcua_tcplistener.h>
 
 #ifdef OPCUA_HAVE_HTTPS
@@ -96,6 +104,12 @@ struct _OpcUa_EndpointContext
 
     /** @brief The id of the corresponding securechannel. */
     OpcUa_UInt32            uSecureChannelId;
+
+    /** @brief Start of the service invocation for the latency statistics; 0 if not recorded. */
+    OpcUa_UInt64            uServiceStartTime;
+
+    /** @brief The call counters of the service in the table of supported services. */
+    OpcUa_ServiceCounters*  pServiceCounters;
 };
 
 typedef struct _OpcUa_EndpointContext OpcUa_EndpointContext;
@@ -241,6 +255,121 @@ OpcUa_StatusCode OpcUa_Endpoint_GetMessageSecureChannelSecurityPolicy(
     }
 }
 
+/*============================================================================
+ * OpcUa_Endpoint_GetSecureChannelCounters
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_Endpoint_GetSecureChannelCounters(
+    OpcUa_Endpoint                  a_hEndpoint,
+    OpcUa_UInt32                    a_uMaxCounters,
+    OpcUa_SecureChannelCounters*    a_pCounters,
+    OpcUa_UInt32*                   a_pNoOfCounters)
+{
+    OpcUa_EndpointInternal* pEndpointInt    = (OpcUa_EndpointInternal*)a_hEndpoint;
+
+    OpcUa_ReturnErrorIfArgumentNull(a_hEndpoint);
+    OpcUa_ReturnErrorIfArgumentNull(a_pNoOfCounters);
+
+    *a_pNoOfCounters = 0;
+
+    /* In case of HTTPS, the transport listener is not set. */
+    if(pEndpointInt->TransportListener == OpcUa_Null || pEndpointInt->SecureListener == OpcUa_Null)
+    {
+        return OpcUa_BadNotSupported;
+    }
+
+    return OpcUa_SecureListener_GetChannelCounters( pEndpointInt->SecureListener,
+                                                    a_uMaxCounters,
+                                                    a_pCounters,
+                                                    a_pNoOfCounters);
+}
+
+/*============================================================================
+ * OpcUa_Endpoint_GetConnectionCounters
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_Endpoint_GetConnectionCounters(
+    OpcUa_Endpoint                  a_hEndpoint,
+    OpcUa_UInt32                    a_uMaxCounters,
+    OpcUa_TcpConnectionCounters*    a_pCounters,
+    OpcUa_UInt32*                   a_pNoOfCounters)
+{
+    OpcUa_EndpointInternal* pEndpointInt    = (OpcUa_EndpointInternal*)a_hEndpoint;
+
+    OpcUa_ReturnErrorIfArgumentNull(a_hEndpoint);
+    OpcUa_ReturnErrorIfArgumentNull(a_pNoOfCounters);
+
+    *a_pNoOfCounters = 0;
+
+    /* In case of HTTPS, the transport listener is not set. */
+    if(pEndpointInt->TransportListener == OpcUa_Null || pEndpointInt->SecureListener == OpcUa_Null)
+    {
+        return OpcUa_BadNotSupported;
+    }
+
+    return OpcUa_TcpListener_GetConnectionCounters( pEndpointInt->TransportListener,
+                                                    a_uMaxCounters,
+                                                    a_pCounters,
+                                                    a_pNoOfCounters);
+}
+
+/*============================================================================
+ * OpcUa_Endpoint_GetServiceCounters
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_Endpoint_GetServiceCounters(
+    OpcUa_Endpoint                  a_hEndpoint,
+    OpcUa_UInt32                    a_uMaxCounters,
+    OpcUa_ServiceCounters*          a_pCounters,
+    OpcUa_UInt32*                   a_pNoOfCounters)
+{
+    OpcUa_ServiceTable*     pTable      = OpcUa_Null;
+    OpcUa_ServiceCounters*  pSource     = OpcUa_Null;
+    OpcUa_UInt32            ii          = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_Endpoint, "GetServiceCounters");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_hEndpoint);
+    OpcUa_ReturnErrorIfArgumentNull(a_pNoOfCounters);
+
+    *a_pNoOfCounters = 0;
+
+    pTable = &(((OpcUa_EndpointInternal*)a_hEndpoint)->SupportedServices);
+
+    OpcUa_ReturnErrorIfTrue(a_uMaxCounters < pTable->Count, OpcUa_BadEncodingLimitsExceeded);
+    OpcUa_ReturnErrorIfArgumentNull(a_pCounters);
+
+    /* the table is fixed after creation; the values are read while requests are processed */
+    for(ii = 0; ii < pTable->Count; ii++)
+    {
+        pSource = &pTable->Counters[ii];
+
+        a_pCounters[ii].RequestTypeId   = pSource->RequestTypeId;
+        a_pCounters[ii].Calls           = OpcUa_Atomic_Load64(&pSource->Calls);
+        a_pCounters[ii].Faults          = OpcUa_Atomic_Load64(&pSource->Faults);
+        a_pCounters[ii].BytesIn         = OpcUa_Atomic_Load64(&pSource->BytesIn);
+        a_pCounters[ii].BytesOut        = OpcUa_Atomic_Load64(&pSource->BytesOut);
+    }
+
+    *a_pNoOfCounters = pTable->Count;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+#ifdef OPCUA_SUPPORT_PREENCODED_MESSAGES
+/*============================================================================
+ * OpcUa_Endpoint_ReleaseEncodedResponse
+ *===========================================================================*/
+/* the entry may outlive the endpoint while a response is sent from it */
+static OpcUa_Void OpcUa_Endpoint_ReleaseEncodedResponse(OpcUa_EndpointEncodedResponse* a_pEntry)
+{
+    if(OpcUa_Atomic_Add32(&a_pEntry->uRefCount, (OpcUa_UInt32)-1) == 0)
+    {
+        OpcUa_ByteString_Clear(&a_pEntry->Message);
+        OpcUa_Free(a_pEntry);
+    }
+}
+#endif /* OPCUA_SUPPORT_PREENCODED_MESSAGES */
+
 /*============================================================================
  * OpcUa_Endpoint_Delete
  *===========================================================================*/
@@ -252,13 +381,23 @@ OpcUa_Void OpcUa_Endpoint_Delete(OpcUa_Endpoint* a_phEndpoint)
         *a_phEndpoint = OpcUa_Null;
 
         OPCUA_P_MUTEX_LOCK(pEndpointInt->Mutex);
-        OpcUa_Listener_Delete(&pEndpointInt->TransportListener);
+        /* the secure listener stops its crypto workers, which reference transport connections */
         OpcUa_Listener_Delete(&pEndpointInt->SecureListener);
+        OpcUa_Listener_Delete(&pEndpointInt->TransportListener);
         OpcUa_Encoder_Delete(&pEndpointInt->Encoder);
         OpcUa_Decoder_Delete(&pEndpointInt->Decoder);
         OpcUa_String_Clear(&pEndpointInt->Url);
         OpcUa_ServiceTable_Clear(&pEndpointInt->SupportedServices);
 
+#ifdef OPCUA_SUPPORT_PREENCODED_MESSAGES
+        while(pEndpointInt->pEncodedResponses != OpcUa_Null)
+        {
+            OpcUa_EndpointEncodedResponse* pEntry = pEndpointInt->pEncodedResponses;
+            pEndpointInt->pEncodedResponses = pEntry->pNext;
+            OpcUa_Endpoint_ReleaseEncodedResponse(pEntry);
+        }
+#endif /* OPCUA_SUPPORT_PREENCODED_MESSAGES */
+
         OPCUA_P_MUTEX_UNLOCK(pEndpointInt->Mutex);
 
         OPCUA_P_MUTEX_DELETE(&(pEndpointInt->Mutex));
@@ -668,12 +807,16 @@ static OpcUa_StatusCode OpcUa_Endpoint_WriteResponse(
     OpcUa_OutputStream**    a_ppOstrm,
     OpcUa_StatusCode        a_uStatus,
     OpcUa_Void*             a_pResponse,
-    OpcUa_EncodeableType*   a_pResponseType)
+    OpcUa_EncodeableType*   a_pResponseType,
+    OpcUa_UInt32            a_uRequestTypeId,
+    OpcUa_ServiceCounters*  a_pServiceCounters)
 {
     OpcUa_EndpointInternal* pEndpointInt        = OpcUa_Null;
     OpcUa_Encoder*          pEncoder            = OpcUa_Null;
     OpcUa_MessageContext    cContext;
     OpcUa_Handle            hEncodeContext      = OpcUa_Null;
+    OpcUa_UInt64            uLatencyStart       = 0;
+    OpcUa_UInt32            uResponseLength     = 0;
 
 OpcUa_InitializeStatus(OpcUa_Module_Endpoint, "WriteResponse");
 
@@ -697,6 +840,8 @@ OpcUa_InitializeStatus(OpcUa_Module_Endpoint, "WriteResponse");
         cContext.NamespaceUris      = &OpcUa_ProxyStub_g_NamespaceUris;
         cContext.AlwaysCheckLengths = OPCUA_SERIALIZER_CHECKLENGTHS;
 
+        uLatencyStart = OpcUa_Latency_Begin();
+
         /* create encoder */
         uStatus = pEncoder->Open(pEncoder, *a_ppOstrm, &cContext, &hEncodeContext);
         OpcUa_GotoErrorIfBad(uStatus);
@@ -709,6 +854,15 @@ OpcUa_InitializeStatus(OpcUa_Module_Endpoint, "WriteResponse");
         OpcUa_Encoder_Close(pEncoder, &hEncodeContext);
 
         OpcUa_MessageContext_Clear(&cContext);
+
+        OpcUa_Latency_End(OpcUa_LatencyStage_Encode, a_uRequestTypeId, uLatencyStart);
+
+        /* only secure streams count the bytes written; https responses are not measured */
+        if(     a_pServiceCounters != OpcUa_Null
+            &&  OpcUa_IsGood(OpcUa_SecureStream_GetBytesWritten(*a_ppOstrm, &uResponseLength)))
+        {
+            OpcUa_Atomic_Add64((OpcUa_Int64*)&a_pServiceCounters->BytesOut, (OpcUa_Int64)uResponseLength);
+        }
     }
     else
     {
@@ -716,9 +870,11 @@ OpcUa_InitializeStatus(OpcUa_Module_Endpoint, "WriteResponse");
     }
 
     /* send response */
+    uLatencyStart = OpcUa_Latency_Begin();
     uStatus = OpcUa_Listener_EndSendResponse(   pEndpointInt->SecureListener,
                                                 a_uStatus,
                                                 a_ppOstrm);
+    OpcUa_Latency_End(OpcUa_LatencyStage_SecureSend, a_uRequestTypeId, uLatencyStart);
 
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
@@ -787,6 +943,8 @@ static OpcUa_StatusCode OpcUa_Endpoint_BeginProcessRequest( OpcUa_Endpoint
     OpcUa_Void*             pRequest        = OpcUa_Null;
     OpcUa_EncodeableType*   pRequestType    = OpcUa_Null;
     OpcUa_EndpointContext*  pContext        = OpcUa_Null;
+    OpcUa_UInt64            uLatencyStart   = 0;
+    OpcUa_UInt32            uRequestLength  = 0;
 
 #if !OPCUA_ENDPOINT_PREALLOCATE_RESPONSESTREAM
     OpcUa_Buffer            Buffer;
@@ -809,6 +967,7 @@ OpcUa_InitializeStatus(OpcUa_Module_Endpoint, "BeginProcessRequest");
     OpcUa_MemSet(pContext, 0, sizeof(OpcUa_EndpointContext));
 
     /* decode the request */
+    uLatencyStart = OpcUa_Latency_Begin();
     uStatus = OpcUa_Endpoint_ReadRequest(   a_hEndpoint,
                                             *a_ppIstrm,
                                             &pRequest,
@@ -828,6 +987,11 @@ OpcUa_InitializeStatus(OpcUa_Module_Endpoint, "BeginProcessRequest");
         OpcUa_GotoError;
     }
 
+    OpcUa_Latency_End(OpcUa_LatencyStage_Decode, pRequestType->TypeId, uLatencyStart);
+
+    /* the stream position is the encoded size of the request */
+    OpcUa_Stream_GetPosition((OpcUa_Stream*)*a_ppIstrm, &uRequestLength);
+
     /* Next call is only valid if OPC UA Secure Conversation is used. */
     /* In case of HTTPS, the transport listener is not set. */
     if(pEndpointInt->TransportListener != OpcUa_Null)
@@ -864,6 +1028,13 @@ OpcUa_InitializeStatus(OpcUa_Module_Endpoint, "BeginProcessRequest");
         OpcUa_Trace(OPCUA_TRACE_LEVEL_INFO, "OpcUa_Endpoint_BeginProcessRequest: Service with RequestTypeId %u requested! (HINT: %s)\n", pRequestType->TypeId, pRequestType->TypeName);
     }
 
+    pContext->pServiceCounters = OpcUa_ServiceTable_GetCounters(&pEndpointInt->SupportedServices, pRequestType->TypeId);
+    if(pContext->pServiceCounters != OpcUa_Null)
+    {
+        OpcUa_Atomic_Add64((OpcUa_Int64*)&pContext->pServiceCounters->Calls, 1);
+        OpcUa_Atomic_Add64((OpcUa_Int64*)&pContext->pServiceCounters->BytesIn, (OpcUa_Int64)uRequestLength);
+    }
+
 #if OPCUA_ENDPOINT_PREALLOCATE_RESPONSESTREAM
 
     /* Initialize Response Stream */
@@ -891,6 +1062,9 @@ OpcUa_InitializeStatus(OpcUa_Module_Endpoint, "BeginProcessRequest");
 
     OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_Endpoint_BeginProcessRequest: Invoking service handler!\n");
 
+    /* completed in OpcUa_Endpoint_EndSendResponse */
+    pContext->uServiceStartTime = OpcUa_Latency_Begin();
+
     uStatus = pContext->ServiceType.BeginInvoke(    a_hEndpoint,
                                                     pContext,
                                                     &pRequest,
@@ -1035,6 +1209,19 @@ OpcUa_InitializeStatus(OpcUa_Module_Endpoint, "EndSendResponse");
 
     OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_Endpoint_EndSendResponse (0x%08X)!\n", a_uStatusCode);
 
+    /* get the context */
+    pContext = (OpcUa_EndpointContext*)*a_phContext;
+
+    OpcUa_Latency_End(OpcUa_LatencyStage_Service, pContext->ServiceType.RequestTypeId, pContext->uServiceStartTime);
+
+    /* a failed service is answered with a service fault; other response types are not inspected */
+    if(     pContext->pServiceCounters != OpcUa_Null
+        &&  (   OpcUa_IsBad(a_uStatusCode)
+             || a_pResponseType == &OpcUa_ServiceFault_EncodeableType))
+    {
+        OpcUa_Atomic_Add64((OpcUa_Int64*)&pContext->pServiceCounters->Faults, 1);
+    }
+
     if(OpcUa_IsBad(a_uStatusCode))
     {
         OpcUa_Endpoint_CancelSendResponse(  a_hEndpoint,
@@ -1044,15 +1231,14 @@ OpcUa_InitializeStatus(OpcUa_Module_Endpoint, "EndSendResponse");
     }
     else
     {
-        /* get the context */
-        pContext = (OpcUa_EndpointContext*)*a_phContext;
-
         /* send the response */
         uStatus = OpcUa_Endpoint_WriteResponse( a_hEndpoint,
                                                 &(pContext->pOstrm),
                                                 a_uStatusCode,
                                                 a_pResponse,
-                                                a_pResponseType);
+                                                a_pResponseType,
+                                                pContext->ServiceType.RequestTypeId,
+                                                pContext->pServiceCounters);
         OpcUa_GotoErrorIfBad(uStatus);
 
         OpcUa_Endpoint_DeleteContext(a_hEndpoint, a_phContext);
@@ -1071,6 +1257,264 @@ OpcUa_BeginErrorHandling;
 OpcUa_FinishErrorHandling;
 }
 
+#ifdef OPCUA_SUPPORT_PREENCODED_MESSAGES
+/** @brief Size of Timestamp and RequestHandle at the start of the response header. */
+#define OPCUA_ENDPOINT_PATCHED_HEADER_LEN (sizeof(OpcUa_Int64) + sizeof(OpcUa_UInt32))
+
+/*============================================================================
+ * OpcUa_Endpoint_SetEncodedResponse
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_Endpoint_SetEncodedResponse(
+    OpcUa_Endpoint        a_hEndpoint,
+    OpcUa_UInt32          a_uRequestTypeId,
+    OpcUa_UInt32          a_uFingerprint,
+    OpcUa_Void*           a_pResponse,
+    OpcUa_EncodeableType* a_pResponseType)
+{
+    OpcUa_EndpointInternal*         pEndpointInt    = OpcUa_Null;
+    OpcUa_EndpointEncodedResponse*  pEntry          = OpcUa_Null;
+    OpcUa_EndpointEncodedResponse*  pReplaced       = OpcUa_Null;
+    OpcUa_EndpointEncodedResponse** ppLink          = OpcUa_Null;
+    OpcUa_Encoder*                  pEncoder        = OpcUa_Null;
+    OpcUa_Handle                    hEncodeContext  = OpcUa_Null;
+    OpcUa_OutputStream*             pOstrm          = OpcUa_Null;
+    OpcUa_MessageContext            cContext;
+    OpcUa_NodeId                    cTypeId;
+    OpcUa_Byte*                     pData           = OpcUa_Null;
+    OpcUa_UInt32                    uLength         = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_Endpoint, "SetEncodedResponse");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_hEndpoint);
+
+    pEndpointInt = (OpcUa_EndpointInternal*)a_hEndpoint;
+
+    OpcUa_MessageContext_Initialize(&cContext);
+
+    if(a_pResponse != OpcUa_Null)
+    {
+        OpcUa_GotoErrorIfArgumentNull(a_pResponseType);
+        OpcUa_GotoErrorIfTrue(a_pResponseType->NamespaceUri != OpcUa_Null, OpcUa_BadNotSupported);
+
+        cContext.KnownTypes         = &OpcUa_ProxyStub_g_EncodeableTypes;
+        cContext.NamespaceUris      = &OpcUa_ProxyStub_g_NamespaceUris;
+        cContext.AlwaysCheckLengths = OPCUA_SERIALIZER_CHECKLENGTHS;
+
+        pEntry = (OpcUa_EndpointEncodedResponse*)OpcUa_Alloc(sizeof(OpcUa_EndpointEncodedResponse));
+        OpcUa_GotoErrorIfAllocFailed(pEntry);
+        OpcUa_MemSet(pEntry, 0, sizeof(OpcUa_EndpointEncodedResponse));
+        OpcUa_ByteString_Initialize(&pEntry->Message);
+
+        pEntry->uRequestTypeId  = a_uRequestTypeId;
+        pEntry->uFingerprint    = a_uFingerprint;
+        pEntry->uRefCount       = 1;
+
+        uStatus = OpcUa_MemoryStream_CreateWriteable(1024, 0, &pOstrm);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        uStatus = OpcUa_BinaryEncoder_Create(&pEncoder);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        uStatus = pEncoder->Open(pEncoder, pOstrm, &cContext, &hEncodeContext);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        /* same layout as WriteMessage; the header offset is needed for patching */
+        cTypeId.IdentifierType     = OpcUa_IdentifierType_Numeric;
+        cTypeId.Identifier.Numeric = a_pResponseType->BinaryEncodingTypeId;
+        cTypeId.NamespaceIndex     = 0;
+
+        uStatus = pEncoder->WriteNodeId((struct _OpcUa_Encoder*)hEncodeContext, OpcUa_Null, &cTypeId, OpcUa_Null);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        uStatus = OpcUa_Stream_GetPosition((OpcUa_Stream*)pOstrm, &pEntry->uHeaderOffset);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        uStatus = pEncoder->WriteEncodeable((struct _OpcUa_Encoder*)hEncodeContext, OpcUa_Null, a_pResponse, a_pResponseType, OpcUa_Null);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        OpcUa_Encoder_Close(pEncoder, &hEncodeContext);
+
+        uStatus = pOstrm->Close((OpcUa_Stream*)pOstrm);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        uStatus = OpcUa_MemoryStream_GetBuffer(pOstrm, &pData, &uLength);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        OpcUa_GotoErrorIfTrue(uLength < pEntry->uHeaderOffset + OPCUA_ENDPOINT_PATCHED_HEADER_LEN, OpcUa_BadEncodingError);
+
+        pEntry->Message.Data = (OpcUa_Byte*)OpcUa_Alloc(uLength);
+        OpcUa_GotoErrorIfAllocFailed(pEntry->Message.Data);
+        OpcUa_MemCpy(pEntry->Message.Data, uLength, pData, uLength);
+        pEntry->Message.Length = (OpcUa_Int32)uLength;
+
+        OpcUa_Encoder_Delete(&pEncoder);
+        OpcUa_Stream_Delete((OpcUa_Stream**)&pOstrm);
+    }
+
+    /* replace the entry; responses being sent keep their reference */
+    OPCUA_P_MUTEX_LOCK(pEndpointInt->Mutex);
+
+    for(ppLink = &pEndpointInt->pEncodedResponses; *ppLink != OpcUa_Null; ppLink = &(*ppLink)->pNext)
+    {
+        if(     (*ppLink)->uRequestTypeId == a_uRequestTypeId
+            &&  (*ppLink)->uFingerprint   == a_uFingerprint)
+        {
+            pReplaced = *ppLink;
+            *ppLink   = pReplaced->pNext;
+            break;
+        }
+    }
+
+    if(pEntry != OpcUa_Null)
+    {
+        pEntry->pNext = pEndpointInt->pEncodedResponses;
+        pEndpointInt->pEncodedResponses = pEntry;
+    }
+
+    OPCUA_P_MUTEX_UNLOCK(pEndpointInt->Mutex);
+
+    if(pReplaced != OpcUa_Null)
+    {
+        OpcUa_Endpoint_ReleaseEncodedResponse(pReplaced);
+    }
+
+    OpcUa_MessageContext_Clear(&cContext);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    if(pEncoder != OpcUa_Null)
+    {
+        OpcUa_Encoder_Close(pEncoder, &hEncodeContext);
+        OpcUa_Encoder_Delete(&pEncoder);
+    }
+
+    if(pOstrm != OpcUa_Null)
+    {
+        OpcUa_Stream_Delete((OpcUa_Stream**)&pOstrm);
+    }
+
+    if(pEntry != OpcUa_Null)
+    {
+        OpcUa_ByteString_Clear(&pEntry->Message);
+        OpcUa_Free(pEntry);
+    }
+
+    OpcUa_MessageContext_Clear(&cContext);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * OpcUa_Endpoint_EndSendEncodedResponse
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_Endpoint_EndSendEncodedResponse(
+    OpcUa_Endpoint        a_hEndpoint,
+    OpcUa_Handle*         a_phContext,
+    OpcUa_UInt32          a_uFingerprint,
+    OpcUa_UInt32          a_uRequestHandle)
+{
+    OpcUa_EndpointInternal*         pEndpointInt    = OpcUa_Null;
+    OpcUa_EndpointContext*          pContext        = OpcUa_Null;
+    OpcUa_EndpointEncodedResponse*  pEntry          = OpcUa_Null;
+    OpcUa_DateTime                  Timestamp;
+    OpcUa_UInt32                    uBodyOffset     = 0;
+    OpcUa_UInt64                    uLatencyStart   = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_Endpoint, "EndSendEncodedResponse");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_hEndpoint);
+    OpcUa_ReturnErrorIfArgumentNull(a_phContext);
+    OpcUa_ReturnErrorIfArgumentNull(*a_phContext);
+
+    OPCUA_ENDPOINT_CHECKOPEN(a_hEndpoint);
+
+    pEndpointInt = (OpcUa_EndpointInternal*)a_hEndpoint;
+    pContext     = (OpcUa_EndpointContext*)*a_phContext;
+
+    OPCUA_P_MUTEX_LOCK(pEndpointInt->Mutex);
+    for(pEntry = pEndpointInt->pEncodedResponses; pEntry != OpcUa_Null; pEntry = pEntry->pNext)
+    {
+        if(     pEntry->uRequestTypeId == pContext->ServiceType.RequestTypeId
+            &&  pEntry->uFingerprint   == a_uFingerprint)
+        {
+            OpcUa_Atomic_Add32(&pEntry->uRefCount, 1);
+            break;
+        }
+    }
+    OPCUA_P_MUTEX_UNLOCK(pEndpointInt->Mutex);
+
+    /* nothing stored; the caller sends the response as usual */
+    OpcUa_ReturnErrorIfTrue(pEntry == OpcUa_Null, OpcUa_BadNotFound);
+
+    OpcUa_Latency_End(OpcUa_LatencyStage_Service, pContext->ServiceType.RequestTypeId, pContext->uServiceStartTime);
+
+#if !OPCUA_ENDPOINT_PREALLOCATE_RESPONSESTREAM
+    uStatus = OpcUa_Listener_BeginSendResponse( pEndpointInt->SecureListener,
+                                                pContext->hConnection,
+                                                &pContext->pIstrm,
+                                                &pContext->pOstrm);
+    OpcUa_GotoErrorIfBad(uStatus);
+#endif /* !OPCUA_ENDPOINT_PREALLOCATE_RESPONSESTREAM */
+
+    uLatencyStart = OpcUa_Latency_Begin();
+
+    /* type id, patched timestamp and request handle, then the stored rest */
+    uStatus = OpcUa_Stream_Write(pContext->pOstrm, pEntry->Message.Data, pEntry->uHeaderOffset);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    Timestamp = OPCUA_P_DATETIME_UTCNOW();
+    uStatus = OpcUa_DateTime_BinaryEncode(&Timestamp, pContext->pOstrm);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = OpcUa_UInt32_BinaryEncode(a_uRequestHandle, pContext->pOstrm);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uBodyOffset = pEntry->uHeaderOffset + OPCUA_ENDPOINT_PATCHED_HEADER_LEN;
+    uStatus = OpcUa_Stream_Write(   pContext->pOstrm,
+                                    pEntry->Message.Data + uBodyOffset,
+                                    (OpcUa_UInt32)pEntry->Message.Length - uBodyOffset);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    OpcUa_Latency_End(OpcUa_LatencyStage_Encode, pContext->ServiceType.RequestTypeId, uLatencyStart);
+
+    if(pContext->pServiceCounters != OpcUa_Null)
+    {
+        OpcUa_Atomic_Add64((OpcUa_Int64*)&pContext->pServiceCounters->BytesOut, (OpcUa_Int64)pEntry->Message.Length);
+    }
+
+    OpcUa_Endpoint_ReleaseEncodedResponse(pEntry);
+    pEntry = OpcUa_Null;
+
+    /* send response */
+    uLatencyStart = OpcUa_Latency_Begin();
+    uStatus = OpcUa_Listener_EndSendResponse(   pEndpointInt->SecureListener,
+                                                OpcUa_Good,
+                                                &pContext->pOstrm);
+    OpcUa_Latency_End(OpcUa_LatencyStage_SecureSend, pContext->ServiceType.RequestTypeId, uLatencyStart);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    OpcUa_Endpoint_DeleteContext(a_hEndpoint, a_phContext);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_Trace(OPCUA_TRACE_LEVEL_ERROR, "OpcUa_Endpoint_EndSendEncodedResponse: Error 0x%08X! Cancelling response!\n", uStatus);
+
+    if(pEntry != OpcUa_Null)
+    {
+        OpcUa_Endpoint_ReleaseEncodedResponse(pEntry);
+    }
+
+    OpcUa_Endpoint_CancelSendResponse(  a_hEndpoint,
+                                        uStatus,
+                                        OpcUa_Null,
+                                        a_phContext);
+
+OpcUa_FinishErrorHandling;
+}
+#endif /* OPCUA_SUPPORT_PREENCODED_MESSAGES */
+
 /*============================================================================
  * OpcUa_Endpoint_GetServiceFunction
  *===========================================================================*/
@@ -18,6 +18,9 @@
 #define _OpcUa_Endpoint_H_ 1
 #ifdef OPCUA_HAVE_SERVERAPI
 
+#include <opcua_securechannel.h>
+#include <opcua_tcplistener.h>
+
 struct _OpcUa_Stream;
 
 OPCUA_BEGIN_EXTERN_C
@@ -40,6 +43,25 @@ struct _OpcUa_Endpoint_SecurityPolicyConfiguration
 
 typedef struct _OpcUa_Endpoint_SecurityPolicyConfiguration OpcUa_Endpoint_SecurityPolicyConfiguration;
 
+/**
+ * @brief Call counters of a service supported by an endpoint.
+ *
+ * @see OpcUa_Endpoint_GetServiceCounters
+ */
+typedef struct _OpcUa_ServiceCounters
+{
+    /** @brief The request type id of the service. */
+    OpcUa_UInt32        RequestTypeId;
+    /** @brief Requests decoded and dispatched. */
+    OpcUa_UInt64        Calls;
+    /** @brief Requests answered with a service fault. */
+    OpcUa_UInt64        Faults;
+    /** @brief Encoded size of the requests. */
+    OpcUa_UInt64        BytesIn;
+    /** @brief Encoded size of the responses. */
+    OpcUa_UInt64        BytesOut;
+} OpcUa_ServiceCounters;
+
 /**
  * @brief Manages an endpoint for a server.
  */
@@ -218,6 +240,65 @@ OpcUa_StatusCode OpcUa_Endpoint_GetMessageSecureChannelSecurityPolicy(
     OpcUa_Handle                                hContext,
     OpcUa_Endpoint_SecurityPolicyConfiguration* pSecurityPolicy);
 
+/**
+ * @brief Copies the traffic counters of all open secure channels of the endpoint.
+ *
+ * The counters are read while the channels are in use; the values of one
+ * channel are not taken at exactly the same instant.
+ *
+ * @param hEndpoint      [in]  The endpoint.
+ * @param uMaxCounters   [in]  Capacity of pCounters.
+ * @param pCounters      [out] Receives the counters of one channel each.
+ * @param pNoOfCounters  [out] Number of channels written.
+ *
+ * @return OpcUa_BadEncodingLimitsExceeded if there are more than uMaxCounters channels;
+ *         OpcUa_BadNotSupported for HTTPS endpoints.
+ */
+OPCUA_EXPORT
+OpcUa_StatusCode OpcUa_Endpoint_GetSecureChannelCounters(
+    OpcUa_Endpoint                  hEndpoint,
+    OpcUa_UInt32                    uMaxCounters,
+    OpcUa_SecureChannelCounters*    pCounters,
+    OpcUa_UInt32*                   pNoOfCounters);
+
+/**
+ * @brief Copies the traffic counters of all UA TCP connections of the endpoint.
+ *
+ * The counters cover the socket level including transport headers and
+ * hello, acknowledge and error messages.
+ *
+ * @param hEndpoint      [in]  The endpoint.
+ * @param uMaxCounters   [in]  Capacity of pCounters.
+ * @param pCounters      [out] Receives the counters of one connection each.
+ * @param pNoOfCounters  [out] Number of connections written.
+ *
+ * @return OpcUa_BadEncodingLimitsExceeded if there are more than uMaxCounters connections;
+ *         OpcUa_BadNotSupported for HTTPS endpoints.
+ */
+OPCUA_EXPORT
+OpcUa_StatusCode OpcUa_Endpoint_GetConnectionCounters(
+    OpcUa_Endpoint                  hEndpoint,
+    OpcUa_UInt32                    uMaxCounters,
+    OpcUa_TcpConnectionCounters*    pCounters,
+    OpcUa_UInt32*                   pNoOfCounters);
+
+/**
+ * @brief Copies the call counters of all services supported by the endpoint.
+ *
+ * @param hEndpoint      [in]  The endpoint.
+ * @param uMaxCounters   [in]  Capacity of pCounters.
+ * @param pCounters      [out] Receives the counters of one service each, sorted by request type id.
+ * @param pNoOfCounters  [out] Number of services written.
+ *
+ * @return OpcUa_BadEncodingLimitsExceeded if the endpoint supports more than uMaxCounters services.
+ */
+OPCUA_EXPORT
+OpcUa_StatusCode OpcUa_Endpoint_GetServiceCounters(
+    OpcUa_Endpoint                  hEndpoint,
+    OpcUa_UInt32                    uMaxCounters,
+    OpcUa_ServiceCounters*          pCounters,
+    OpcUa_UInt32*                   pNoOfCounters);
+
 
 /**
  * @brief Starts accepting connections for the endpoint on the given URL.
@@ -326,6 +407,49 @@ OpcUa_Void OpcUa_Endpoint_SendErrorResponse(
     OpcUa_Handle      hContext,
     OpcUa_StatusCode  uStatus);
 
+#ifdef OPCUA_SUPPORT_PREENCODED_MESSAGES
+/**
+ * @brief Encodes a response once and stores it for OpcUa_Endpoint_EndSendEncodedResponse.
+ *
+ * The fingerprint is chosen by the application and identifies the request parameters
+ * the response depends on. An existing entry with the same request type and fingerprint
+ * is replaced; passing a null response removes it.
+ *
+ * @param hEndpoint      [in] The endpoint which sends the response.
+ * @param uRequestTypeId [in] The type id of the service request.
+ * @param uFingerprint   [in] The fingerprint of the request parameters.
+ * @param pResponse      [in] The response object to encode.
+ * @param pResponseType  [in] The type of the response object.
+ */
+OPCUA_EXPORT
+OpcUa_StatusCode OpcUa_Endpoint_SetEncodedResponse(
+    OpcUa_Endpoint        hEndpoint,
+    OpcUa_UInt32          uRequestTypeId,
+    OpcUa_UInt32          uFingerprint,
+    OpcUa_Void*           pResponse,
+    OpcUa_EncodeableType* pResponseType);
+
+/**
+ * @brief Sends a stored pre-encoded response for a request.
+ *
+ * Only the RequestHandle and the Timestamp of the response header are replaced.
+ * Returns OpcUa_BadNotFound and leaves the context untouched if no response is stored
+ * for the request type and fingerprint; the caller then sends the response as usual.
+ * Must be called instead of OpcUa_Endpoint_BeginSendResponse!
+ *
+ * @param hEndpoint      [in] The endpoint which received the request.
+ * @param hContext       [in] The context associated with the request.
+ * @param uFingerprint   [in] The fingerprint of the request parameters.
+ * @param uRequestHandle [in] The request handle from the request header.
+ */
+OPCUA_EXPORT
+OpcUa_StatusCode OpcUa_Endpoint_EndSendEncodedResponse(
+    OpcUa_Endpoint        hEndpoint,
+    OpcUa_Handle*         hContext,
+    OpcUa_UInt32          uFingerprint,
+    OpcUa_UInt32          uRequestHandle);
+#endif /* OPCUA_SUPPORT_PREENCODED_MESSAGES */
+
 
 /**
  * @brief Returns a pointer to the function that implements the service.
@@ -37,6 +37,35 @@ enum _OpcUa_Endpoint_State
 };
 typedef enum _OpcUa_Endpoint_State OpcUa_Endpoint_State;
 
+#ifdef OPCUA_SUPPORT_PREENCODED_MESSAGES
+/*============================================================================
+ * OpcUa_EndpointEncodedResponse
+ *===========================================================================*/
+/**
+ * @brief A response message stored in its encoded form.
+ */
+typedef struct _OpcUa_EndpointEncodedResponse
+{
+    /*! @brief The next entry in the list of the endpoint. */
+    struct _OpcUa_EndpointEncodedResponse* pNext;
+
+    /*! @brief The type id of the service request. */
+    OpcUa_UInt32 uRequestTypeId;
+
+    /*! @brief The application defined fingerprint of the request parameters. */
+    OpcUa_UInt32 uFingerprint;
+
+    /*! @brief References held by the list and by responses being sent; changed atomically, the last one frees the entry. */
+    OpcUa_UInt32 uRefCount;
+
+    /*! @brief Offset of the response header behind the encoded type id. */
+    OpcUa_UInt32 uHeaderOffset;
+
+    /*! @brief The encoded message including the type id. */
+    OpcUa_ByteString Message;
+} OpcUa_EndpointEncodedResponse;
+#endif /* OPCUA_SUPPORT_PREENCODED_MESSAGES */
+
 /*============================================================================
  * OpcUa_EndpointInternal
  *===========================================================================*/
@@ -83,6 +112,11 @@ typedef struct _OpcUa_EndpointInternal
 
     /*! @brief The current status of the endpoint. */
     OpcUa_StatusCode Status;
+
+#ifdef OPCUA_SUPPORT_PREENCODED_MESSAGES
+    /*! @brief Responses registered with OpcUa_Endpoint_SetEncodedResponse. */
+    OpcUa_EndpointEncodedResponse* pEncodedResponses;
+#endif /* OPCUA_SUPPORT_PREENCODED_MESSAGES */
 } OpcUa_EndpointInternal;
 
 OPCUA_END_EXTERN_C
@@ -70,9 +70,11 @@ static int OpcUa_ServiceType_Compare(const OpcUa_Void* a_pElement1, const OpcUa_
 OpcUa_StatusCode OpcUa_ServiceTable_AddTypes(   OpcUa_ServiceTable* a_pTable,
                                                 OpcUa_ServiceType** a_pTypes)
 {
-    OpcUa_Int32         ii          = 0;
-    OpcUa_UInt32        uCount      = 0;
-    OpcUa_ServiceType*  pEntries    = OpcUa_Null;
+    OpcUa_Int32             ii          = 0;
+    OpcUa_UInt32            jj          = 0;
+    OpcUa_UInt32            uCount      = 0;
+    OpcUa_ServiceType*      pEntries    = OpcUa_Null;
+    OpcUa_ServiceCounters*  pCounters   = OpcUa_Null;
     OpcUa_DeclareErrorTraceModule(OpcUa_Module_ServiceTable);
 
     /* check for nulls */
@@ -89,9 +91,17 @@ OpcUa_StatusCode OpcUa_ServiceTable_AddTypes(   OpcUa_ServiceTable* a_pTable,
 
     uCount = a_pTable->Count + ii;
 
+    pCounters = (OpcUa_ServiceCounters*)OpcUa_Alloc(uCount*sizeof(OpcUa_ServiceCounters));
+    OpcUa_ReturnErrorIfAllocFailed(pCounters);
+    OpcUa_MemSet(pCounters, 0, uCount*sizeof(OpcUa_ServiceCounters));
+
     /* reallocate the table */
     pEntries = (OpcUa_ServiceType *)OpcUa_ReAlloc(a_pTable->Entries, uCount*sizeof(OpcUa_ServiceType));
-    OpcUa_ReturnErrorIfAllocFailed(pEntries);
+    if(pEntries == OpcUa_Null)
+    {
+        OpcUa_Free(pCounters);
+        return OpcUa_BadOutOfMemory;
+    }
 
     /* copy new definitions */
     for (ii = a_pTable->Count; ii < (OpcUa_Int32)uCount; ii++)
@@ -107,9 +117,27 @@ OpcUa_StatusCode OpcUa_ServiceTable_AddTypes(   OpcUa_ServiceTable* a_pTable,
                     OpcUa_ServiceType_Compare,
                     OpcUa_Null);
 
+    /* counters follow the sorted entries; keep the values of existing services */
+    for (ii = 0; ii < (OpcUa_Int32)uCount; ii++)
+    {
+        pCounters[ii].RequestTypeId = pEntries[ii].RequestTypeId;
+
+        for (jj = 0; jj < a_pTable->Count; jj++)
+        {
+            if (a_pTable->Counters[jj].RequestTypeId == pEntries[ii].RequestTypeId)
+            {
+                pCounters[ii] = a_pTable->Counters[jj];
+                break;
+            }
+        }
+    }
+
+    OpcUa_Free(a_pTable->Counters);
+
     /* save the new table */
-    a_pTable->Entries = pEntries;
-    a_pTable->Count   = uCount;
+    a_pTable->Entries  = pEntries;
+    a_pTable->Counters = pCounters;
+    a_pTable->Count    = uCount;
 
     return OpcUa_Good;
 }
@@ -122,8 +150,10 @@ OpcUa_Void OpcUa_ServiceTable_Clear(OpcUa_ServiceTable* a_pTable)
     if (a_pTable != OpcUa_Null)
     {
         OpcUa_Free(a_pTable->Entries);
-        a_pTable->Entries = OpcUa_Null;
-        a_pTable->Count   = 0;
+        OpcUa_Free(a_pTable->Counters);
+        a_pTable->Entries  = OpcUa_Null;
+        a_pTable->Counters = OpcUa_Null;
+        a_pTable->Count    = 0;
     }
 }
 
@@ -172,6 +202,38 @@ OpcUa_StatusCode OpcUa_ServiceTable_FindService(
     return OpcUa_Good;
 }
 
+/*============================================================================
+ * OpcUa_ServiceTable_GetCounters
+ *===========================================================================*/
+OpcUa_ServiceCounters* OpcUa_ServiceTable_GetCounters(
+    OpcUa_ServiceTable* a_pTable,
+    OpcUa_UInt32        a_uTypeId)
+{
+    OpcUa_ServiceType   cKey;
+    OpcUa_ServiceType*  pType   = OpcUa_Null;
+
+    if (a_pTable == OpcUa_Null || a_pTable->Entries == OpcUa_Null || a_pTable->Counters == OpcUa_Null)
+    {
+        return OpcUa_Null;
+    }
+
+    cKey.RequestTypeId = a_uTypeId;
+
+    pType = (OpcUa_ServiceType *)OpcUa_BSearch(  &cKey,
+                            a_pTable->Entries,
+                            a_pTable->Count,
+                            sizeof(OpcUa_ServiceType),
+                            OpcUa_ServiceType_Compare,
+                            OpcUa_Null);
+
+    if (pType == OpcUa_Null)
+    {
+        return OpcUa_Null;
+    }
+
+    return &a_pTable->Counters[pType - a_pTable->Entries];
+}
+
 /*============================================================================
  * OpcUa_ServerApi_CreateFault
  *===========================================================================*/
@@ -40,6 +40,9 @@ typedef struct _OpcUa_ServiceTable
 
     /*! @brief An array of all supported services. */
     OpcUa_ServiceType* Entries;
+
+    /*! @brief The call counters of the services; parallel to Entries. */
+    OpcUa_ServiceCounters* Counters;
 }
 OpcUa_ServiceTable;
 
@@ -77,6 +80,20 @@ OpcUa_StatusCode OpcUa_ServiceTable_FindService(
     OpcUa_UInt32        nTypeId,
     OpcUa_ServiceType*  pType);
 
+/**
+  @brief Returns the call counters of a service in a table.
+
+  The counters stay valid until the table is cleared and are updated with atomic operations.
+
+  @param pTable  [in] The table to search.
+  @param nTypeId [in] The identifier for the service.
+
+  @return The counters or null if the service is not in the table.
+*/
+OpcUa_ServiceCounters* OpcUa_ServiceTable_GetCounters(
+    OpcUa_ServiceTable* pTable,
+    OpcUa_UInt32        nTypeId);
+
 /**
   @brief Creates a fault response for a service.
 
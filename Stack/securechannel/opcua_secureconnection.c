@@ -293,6 +293,8 @@ typedef struct _OpcUa_SecureConnection
     OpcUa_ByteString*               ClientCertificate;
     /*! @brief The certificate of the server to which this connection will be connected. */
     OpcUa_ByteString*               ServerCertificate;
+    /*! @brief The thumbprint of the server certificate; computed once per connect and reused for renewals. */
+    OpcUa_ByteString                ServerCertificateThumbprint;
     /*! @brief The private key of this client. */
     OpcUa_Key*                      ClientPrivateKey;
     /*! @brief The PKI provider interface used for security functionality based on the used profile. */
@@ -551,6 +553,29 @@ OpcUa_StatusCode OPCUA_DLLCALL OpcUa_SecureConnection_RenewTimerKillCallback(
     return OpcUa_Good;
 }
 
+/*============================================================================
+ * OpcUa_SecureConnection_GetRenewInterval
+ *===========================================================================*/
+/* renew at 75% of the token lifetime; each channel starts a little earlier so that channels opened together don't renew together */
+OpcUa_UInt32 OpcUa_SecureConnection_GetRenewInterval(OpcUa_UInt32 a_uSecureChannelId,
+                                                     OpcUa_UInt32 a_uRevisedLifetime)
+{
+    OpcUa_UInt32 uInterval  = (OpcUa_UInt32)(a_uRevisedLifetime * 0.75);
+#if OPCUA_SECURECONNECTION_RENEW_JITTER
+    OpcUa_UInt32 uJitter    = (a_uRevisedLifetime / 100) * OPCUA_SECURECONNECTION_RENEW_JITTER;
+    OpcUa_UInt32 uSeed      = (OpcUa_GetTickCount() ^ a_uSecureChannelId) * 2654435761u;
+
+    if(uJitter > 0 && uJitter < uInterval)
+    {
+        uInterval -= (uSeed >> 8) % uJitter;
+    }
+#else /* OPCUA_SECURECONNECTION_RENEW_JITTER */
+    OpcUa_ReferenceParameter(a_uSecureChannelId);
+#endif /* OPCUA_SECURECONNECTION_RENEW_JITTER */
+
+    return uInterval;
+}
+
 /*============================================================================
  * OpcUa_SecureConnection_RenewTimerCallback
  *===========================================================================*/
@@ -920,7 +945,8 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureConnection, "BeginOpenSecureChannel");
         }
     }/* switch a_tokenRequestType */
 
-    if(pSecureConnection->MessageSecurityMode != OpcUa_MessageSecurityMode_None)
+    if(     pSecureConnection->MessageSecurityMode != OpcUa_MessageSecurityMode_None
+        &&  pSecureConnection->ServerCertificateThumbprint.Length <= 0)
     {
         /*** generate ReceiverCertificateThumbprint for writing it into the OpenSecureChannelRequest header ***/
         uStatus = pSecureConnection->pSecureChannel->pCurrentCryptoProvider->GetCertificateThumbprint(
@@ -944,6 +970,10 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureConnection, "BeginOpenSecureChannel");
             pSecureConnection->ServerCertificate, /* get the real data */
             &serverCertificateThumbprint);
         OpcUa_GotoErrorIfBad(uStatus);
+
+        /* keep it for the renewals of this connection */
+        pSecureConnection->ServerCertificateThumbprint = serverCertificateThumbprint;
+        OpcUa_ByteString_Initialize(&serverCertificateThumbprint);
     }
 
     /* must always sign and encrypt OpenSecureChannel messages when security is used. */
@@ -961,7 +991,7 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureConnection, "BeginOpenSecureChannel");
         eMessageSecurityMode,
         pSecureConnection->pSecureChannel->pCurrentCryptoProvider,
         pSecureConnection->ClientCertificate,
-        &serverCertificateThumbprint,
+        &pSecureConnection->ServerCertificateThumbprint,
         &pOstrm);
     OpcUa_GotoErrorIfBad(uStatus);
 
@@ -1156,6 +1186,7 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureConnection, "Connect");
 
     pSecureConnection->ClientCertificate            = pClientCredentials->pClientCertificate;
     pSecureConnection->ServerCertificate            = pClientCredentials->pServerCertificate;
+    OpcUa_ByteString_Clear(&pSecureConnection->ServerCertificateThumbprint);
     pSecureConnection->MessageSecurityMode          = pClientCredentials->messageSecurityMode;
     pSecureConnection->nLifetime                    = pClientCredentials->nRequestedLifetime;
 
@@ -2594,6 +2625,7 @@ OpcUa_Void OpcUa_SecureConnection_Delete(OpcUa_Connection** a_ppConnection)
         OpcUa_Free(pSecureConnection->ClientPrivateKey);
         pSecureConnection->ClientPrivateKey = OpcUa_Null;
         OpcUa_String_Clear(&pSecureConnection->sUrl);
+        OpcUa_ByteString_Clear(&pSecureConnection->ServerCertificateThumbprint);
 
         /* DELETE PKI Provider */
         OPCUA_P_PKIFACTORY_DELETEPKIPROVIDER(pSecureConnection->ClientPKIProvider);
@@ -2680,6 +2712,7 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureConnection, "Create");
     pSecureConnection->NamespaceUris        = a_pNamespaceUris;
     pSecureConnection->KnownTypes           = a_pKnownTypes;
     pSecureConnection->uRequestId           = 1; /* we start with 1 since zero is error prone */
+    OpcUa_ByteString_Initialize(&pSecureConnection->ServerCertificateThumbprint);
 
     /* initialize connection object */
     pConnection->Handle           = pSecureConnection;
@@ -3218,7 +3251,7 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureConnection, "ProcessOpenSecureChannelR
             if(pSecureConnection->hRenewTimer == OpcUa_Null)
             {
                 uStatus = OpcUa_Timer_Create(   &pSecureConnection->hRenewTimer,
-                                                (OpcUa_UInt32)(pResponse->SecurityToken.RevisedLifetime * 0.75),
+                                                OpcUa_SecureConnection_GetRenewInterval(uSecureChannelId, pResponse->SecurityToken.RevisedLifetime),
                                                 OpcUa_SecureConnection_RenewTimerCallback,
                                                 OpcUa_SecureConnection_RenewTimerKillCallback,
                                                 (OpcUa_Void*)a_pConnection);
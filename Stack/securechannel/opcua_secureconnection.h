@@ -57,6 +57,13 @@ OPCUA_EXPORT OpcUa_StatusCode OpcUa_SecureConnection_GetCurrentTokenId(
     OpcUa_Connection*       pConnection,
     OpcUa_UInt32*           pCurrentTokenId);
 
+/**
+  @brief returns the milliseconds after which a connection renews a token of the given lifetime.
+*/
+OpcUa_UInt32 OpcUa_SecureConnection_GetRenewInterval(
+    OpcUa_UInt32            uSecureChannelId,
+    OpcUa_UInt32            uRevisedLifetime);
+
 
 /**
   @brief returns the securechannelid of an existing connection.
@@ -26,6 +26,7 @@
 #include <opcua_list.h>
 #include <opcua_thread.h>
 #include <opcua_threadpool.h>
+#include <opcua_latency.h>
 
 /* stackcore */
 #include <opcua_identifiers.h>
@@ -180,9 +181,32 @@ typedef struct _OpcUa_SecureListener
     OpcUa_ByteString*                               pServerCertificate;
     OpcUa_Key                                       ServerPrivateKey;
     OpcUa_UInt32                                    uNextSecureChannelId;
+#ifdef OPCUA_HAVE_THREADPOOL
+    /** @brief Workers for OpenSecureChannel requests; null if they are processed in the receiving thread. */
+    OpcUa_ThreadPool                                hCryptoPool;
+    /** @brief Requests handed to hCryptoPool which are not yet picked up by a worker. */
+    OpcUa_List*                                     pCryptoJobs;
+#endif /* OPCUA_HAVE_THREADPOOL */
 }
 OpcUa_SecureListener;
 
+#ifdef OPCUA_HAVE_THREADPOOL
+/*============================================================================
+ * OpcUa_SecureListener_CryptoJob
+ *===========================================================================*/
+/** @brief An OpenSecureChannel request waiting for or running in the crypto pool. */
+typedef struct _OpcUa_SecureListener_CryptoJob
+{
+    OpcUa_Listener*         pListener;
+    /** @brief Referenced until the job is done; transport calls fail once it is disconnected. */
+    OpcUa_Handle            hTransportConnection;
+    OpcUa_InputStream*      pTransportIstrm;
+    /** @brief Referenced until the job is done; its bOpenRequestPending flag is set. */
+    OpcUa_SecureChannel*    pSecureChannel;
+}
+OpcUa_SecureListener_CryptoJob;
+#endif /* OPCUA_HAVE_THREADPOOL */
+
 /*============================================================================
  * OpcUa_SecureListener_Open
  *===========================================================================*/
@@ -238,6 +262,204 @@ OpcUa_BeginErrorHandling;
 OpcUa_FinishErrorHandling;
 }
 
+/*============================================================================
+ * OpcUa_SecureListener_CloseChannelOnError
+ *===========================================================================*/
+/** @brief Close the channel and the transport connection after a request failed. */
+static OpcUa_Void OpcUa_SecureListener_CloseChannelOnError(
+    OpcUa_SecureListener*   a_pSecureListener,
+    OpcUa_Handle            a_hTransportConnection,
+    OpcUa_SecureMessageType a_eRequestType,
+    OpcUa_StatusCode        a_uStatus)
+{
+    OpcUa_SecureChannel* pSecureChannel = OpcUa_Null;
+
+    OpcUa_SecureListener_ChannelManager_GetChannelByTransportConnection(
+        a_pSecureListener->ChannelManager,
+        a_hTransportConnection,
+        &pSecureChannel);
+
+    if(pSecureChannel != OpcUa_Null)
+    {
+        if((OpcUa_SecureMessageType_SC != a_eRequestType) &&
+           (OpcUa_SecureMessageType_UN != a_eRequestType))
+        {
+            OpcUa_Trace(OPCUA_TRACE_LEVEL_ERROR, "OpcUa_SecureListener_ProcessRequest: Closing channel due error 0x%08X!\n", a_uStatus);
+            pSecureChannel->Close(pSecureChannel);
+        }
+
+        pSecureChannel->LockWriteMutex(pSecureChannel);
+        if(pSecureChannel->bAsyncWriteInProgress)
+        {
+            OpcUa_Listener_AddToSendQueue(
+                a_pSecureListener->TransportListener,
+                pSecureChannel->TransportConnection,
+                pSecureChannel->pPendingSendBuffers,
+                0);
+            pSecureChannel->bAsyncWriteInProgress = OpcUa_False;
+            pSecureChannel->pPendingSendBuffers = OpcUa_Null;
+            pSecureChannel->uPendingMessageCount = 0;
+        }
+        OpcUa_SecureListener_ChannelManager_SetTransportConnection(
+                a_pSecureListener->ChannelManager,
+                pSecureChannel,
+                OpcUa_Null);
+        a_pSecureListener->TransportListener->CloseConnection(
+                a_pSecureListener->TransportListener,
+                a_hTransportConnection,
+                a_uStatus);
+        pSecureChannel->UnlockWriteMutex(pSecureChannel);
+    }
+
+    OpcUa_SecureListener_ChannelManager_ReleaseChannel(
+        a_pSecureListener->ChannelManager,
+        &pSecureChannel);
+}
+
+#ifdef OPCUA_HAVE_THREADPOOL
+/*============================================================================
+ * OpcUa_SecureListener_CryptoJobMain
+ *===========================================================================*/
+/** @brief Crypto pool worker; processes one queued OpenSecureChannel request. */
+static OpcUa_Void OpcUa_SecureListener_CryptoJobMain(OpcUa_Void* a_pArgument)
+{
+    OpcUa_SecureListener_CryptoJob* pJob            = (OpcUa_SecureListener_CryptoJob*)a_pArgument;
+    OpcUa_SecureListener*           pSecureListener = (OpcUa_SecureListener*)pJob->pListener->Handle;
+    OpcUa_StatusCode                uStatus         = OpcUa_BadShutdown;
+
+    OpcUa_List_Enter(pSecureListener->pCryptoJobs);
+    OpcUa_List_DeleteElement(pSecureListener->pCryptoJobs, pJob);
+    OpcUa_List_Leave(pSecureListener->pCryptoJobs);
+
+    OPCUA_P_MUTEX_LOCK(pSecureListener->Mutex);
+    if(pSecureListener->State == OpcUa_SecureListenerState_Open)
+    {
+        uStatus = OpcUa_Good;
+    }
+    OPCUA_P_MUTEX_UNLOCK(pSecureListener->Mutex);
+
+    /* the asymmetric work runs without the listener lock */
+    if(OpcUa_IsGood(uStatus))
+    {
+        uStatus = OpcUa_SecureListener_ProcessOpenSecureChannelRequest( pJob->pListener,
+                                                                        pJob->hTransportConnection,
+                                                                        &pJob->pTransportIstrm,
+                                                                        OpcUa_True);
+    }
+
+    if(pJob->pTransportIstrm != OpcUa_Null)
+    {
+        OpcUa_Stream_Close((OpcUa_Stream*)pJob->pTransportIstrm);
+        OpcUa_Stream_Delete((OpcUa_Stream**)&pJob->pTransportIstrm);
+    }
+
+    OPCUA_P_MUTEX_LOCK(pSecureListener->Mutex);
+
+    if(OpcUa_IsBad(uStatus))
+    {
+        OpcUa_SecureListener_CloseChannelOnError(   pSecureListener,
+                                                    pJob->hTransportConnection,
+                                                    OpcUa_SecureMessageType_SO,
+                                                    uStatus);
+    }
+
+    pJob->pSecureChannel->bOpenRequestPending = OpcUa_False;
+
+    OPCUA_P_MUTEX_UNLOCK(pSecureListener->Mutex);
+
+    OpcUa_SecureListener_ChannelManager_ReleaseChannel(
+        pSecureListener->ChannelManager,
+        &pJob->pSecureChannel);
+
+    OpcUa_Listener_ReleaseConnectionReference(  pSecureListener->TransportListener,
+                                                pJob->hTransportConnection);
+
+    OpcUa_Free(pJob);
+}
+
+/*============================================================================
+ * OpcUa_SecureListener_QueueOpenSecureChannelRequest
+ *===========================================================================*/
+/** @brief Hand a complete OpenSecureChannel request to the crypto pool. Called with the listener lock held. */
+static OpcUa_StatusCode OpcUa_SecureListener_QueueOpenSecureChannelRequest(
+    OpcUa_Listener*         a_pSecureListenerInterface,
+    OpcUa_Handle            a_hTransportConnection,
+    OpcUa_InputStream**     a_ppTransportIstrm)
+{
+    OpcUa_SecureListener*           pSecureListener = (OpcUa_SecureListener*)a_pSecureListenerInterface->Handle;
+    OpcUa_SecureChannel*            pSecureChannel  = OpcUa_Null;
+    OpcUa_SecureListener_CryptoJob* pJob            = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_SecureListener, "QueueOpenSecureChannelRequest");
+
+    uStatus = OpcUa_SecureListener_ChannelManager_GetChannelByTransportConnection(  pSecureListener->ChannelManager,
+                                                                                    a_hTransportConnection,
+                                                                                    &pSecureChannel);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* the client has to wait for the response before it sends another request */
+    if(pSecureChannel->bOpenRequestPending != OpcUa_False)
+    {
+        OpcUa_Trace(OPCUA_TRACE_LEVEL_WARNING, "OpcUa_SecureListener_QueueOpenSecureChannelRequest: OpenSecureChannel request already in progress!\n");
+        OpcUa_GotoErrorWithStatus(OpcUa_BadInvalidState);
+    }
+
+    pJob = (OpcUa_SecureListener_CryptoJob*)OpcUa_Alloc(sizeof(OpcUa_SecureListener_CryptoJob));
+    OpcUa_GotoErrorIfAllocFailed(pJob);
+
+    pJob->pListener             = a_pSecureListenerInterface;
+    pJob->hTransportConnection  = a_hTransportConnection;
+    pJob->pTransportIstrm       = *a_ppTransportIstrm;
+    pJob->pSecureChannel        = pSecureChannel;
+
+    OpcUa_List_Enter(pSecureListener->pCryptoJobs);
+    uStatus = OpcUa_List_AddElementToEnd(pSecureListener->pCryptoJobs, pJob);
+    OpcUa_List_Leave(pSecureListener->pCryptoJobs);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* the transport deletes a disconnected connection with its last reference */
+    OpcUa_Listener_AddConnectionReference(  pSecureListener->TransportListener,
+                                            a_hTransportConnection);
+
+    pSecureChannel->bOpenRequestPending = OpcUa_True;
+
+    /* a full queue rejects the request instead of stalling the receiving thread */
+    uStatus = OpcUa_ThreadPool_AddJob(  pSecureListener->hCryptoPool,
+                                        OpcUa_SecureListener_CryptoJobMain,
+                                        pJob);
+    if(OpcUa_IsBad(uStatus))
+    {
+        OpcUa_Trace(OPCUA_TRACE_LEVEL_WARNING, "OpcUa_SecureListener_QueueOpenSecureChannelRequest: Crypto pool is busy (0x%08X)!\n", uStatus);
+
+        OpcUa_List_Enter(pSecureListener->pCryptoJobs);
+        OpcUa_List_DeleteElement(pSecureListener->pCryptoJobs, pJob);
+        OpcUa_List_Leave(pSecureListener->pCryptoJobs);
+
+        pSecureChannel->bOpenRequestPending = OpcUa_False;
+        OpcUa_Listener_ReleaseConnectionReference(  pSecureListener->TransportListener,
+                                                    a_hTransportConnection);
+        OpcUa_GotoErrorWithStatus(OpcUa_BadTcpServerTooBusy);
+    }
+
+    /* the job owns the stream and the channel reference now */
+    *a_ppTransportIstrm = OpcUa_Null;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    if(pJob != OpcUa_Null)
+    {
+        OpcUa_Free(pJob);
+    }
+
+    OpcUa_SecureListener_ChannelManager_ReleaseChannel(
+        pSecureListener->ChannelManager,
+        &pSecureChannel);
+
+OpcUa_FinishErrorHandling;
+}
+#endif /* OPCUA_HAVE_THREADPOOL */
+
 /*============================================================================
  * OpcUa_SecureListener_ProcessRequest
  *===========================================================================*/
@@ -280,6 +502,19 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureListener, "ProcessRequest");
     /* OpenSecureChannel */
     case OpcUa_SecureMessageType_SO:
         {
+#ifdef OPCUA_HAVE_THREADPOOL
+            /* workers need a transport that keeps the connection alive for them */
+            if(pSecureListener->hCryptoPool != OpcUa_Null &&
+               pSecureListener->TransportListener->AddConnectionReference != OpcUa_Null &&
+               a_bRequestComplete != OpcUa_False)
+            {
+                uStatus = OpcUa_SecureListener_QueueOpenSecureChannelRequest(   a_pSecureListenerInterface,
+                                                                                a_hTransportConnection,
+                                                                                a_ppTransportIstrm);
+                break;
+            }
+#endif /* OPCUA_HAVE_THREADPOOL */
+
             uStatus = OpcUa_SecureListener_ProcessOpenSecureChannelRequest(     a_pSecureListenerInterface,
                                                                                 a_hTransportConnection,
                                                                                 a_ppTransportIstrm,
@@ -332,48 +567,10 @@ OpcUa_BeginErrorHandling;
 
     if(OpcUa_IsBad(uStatus))
     {
-        OpcUa_SecureChannel* pSecureChannel = OpcUa_Null;
-
-        OpcUa_SecureListener_ChannelManager_GetChannelByTransportConnection(
-            pSecureListener->ChannelManager,
-            a_hTransportConnection,
-            &pSecureChannel);
-
-        if(pSecureChannel != OpcUa_Null)
-        {
-            if((OpcUa_SecureMessageType_SC != requestType) &&
-               (OpcUa_SecureMessageType_UN != requestType))
-            {
-                OpcUa_Trace(OPCUA_TRACE_LEVEL_ERROR, "OpcUa_SecureListener_ProcessRequest: Closing channel due error 0x%08X!\n", uStatus);
-                pSecureChannel->Close(pSecureChannel);
-            }
-
-            pSecureChannel->LockWriteMutex(pSecureChannel);
-            if(pSecureChannel->bAsyncWriteInProgress)
-            {
-                OpcUa_Listener_AddToSendQueue(
-                    pSecureListener->TransportListener,
-                    pSecureChannel->TransportConnection,
-                    pSecureChannel->pPendingSendBuffers,
-                    0);
-                pSecureChannel->bAsyncWriteInProgress = OpcUa_False;
-                pSecureChannel->pPendingSendBuffers = OpcUa_Null;
-                pSecureChannel->uPendingMessageCount = 0;
-            }
-            OpcUa_SecureListener_ChannelManager_SetTransportConnection(
-                    pSecureListener->ChannelManager,
-                    pSecureChannel,
-                    OpcUa_Null);
-            pSecureListener->TransportListener->CloseConnection(
-                    pSecureListener->TransportListener,
-                    a_hTransportConnection,
-                    uStatus);
-            pSecureChannel->UnlockWriteMutex(pSecureChannel);
-        }
-
-        OpcUa_SecureListener_ChannelManager_ReleaseChannel(
-            pSecureListener->ChannelManager,
-            &pSecureChannel);
+        OpcUa_SecureListener_CloseChannelOnError(   pSecureListener,
+                                                    a_hTransportConnection,
+                                                    requestType,
+                                                    uStatus);
     }
     else
     {
@@ -1295,6 +1492,33 @@ OpcUa_Void OpcUa_SecureListener_Delete(OpcUa_Listener** a_ppListener)
 
     pSecureListener = (OpcUa_SecureListener*)(*a_ppListener)->Handle;
 
+#ifdef OPCUA_HAVE_THREADPOOL
+    /* workers take the listener lock, so stop them first */
+    if(pSecureListener->hCryptoPool != OpcUa_Null)
+    {
+        OpcUa_ThreadPool_Delete(&pSecureListener->hCryptoPool);
+    }
+
+    if(pSecureListener->pCryptoJobs != OpcUa_Null)
+    {
+        OpcUa_SecureListener_CryptoJob* pJob = OpcUa_Null;
+
+        /* requests that never got a worker */
+        pJob = (OpcUa_SecureListener_CryptoJob*)OpcUa_List_RemoveFirstElement(pSecureListener->pCryptoJobs);
+        while(pJob != OpcUa_Null)
+        {
+            OpcUa_Stream_Close((OpcUa_Stream*)pJob->pTransportIstrm);
+            OpcUa_Stream_Delete((OpcUa_Stream**)&pJob->pTransportIstrm);
+            OpcUa_SecureListener_ChannelManager_ReleaseChannel(pSecureListener->ChannelManager, &pJob->pSecureChannel);
+            OpcUa_Listener_ReleaseConnectionReference(pSecureListener->TransportListener, pJob->hTransportConnection);
+            OpcUa_Free(pJob);
+            pJob = (OpcUa_SecureListener_CryptoJob*)OpcUa_List_RemoveFirstElement(pSecureListener->pCryptoJobs);
+        }
+
+        OpcUa_List_Delete(&pSecureListener->pCryptoJobs);
+    }
+#endif /* OPCUA_HAVE_THREADPOOL */
+
     OPCUA_P_MUTEX_LOCK(pSecureListener->Mutex);
 
     if(pSecureListener->ChannelManager != OpcUa_Null)
@@ -1466,6 +1690,31 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureListener, "Create");
     uStatus = OPCUA_P_MUTEX_CREATE(&(pSecureListener->Mutex));
     OpcUa_GotoErrorIfBad(uStatus);
 
+#ifdef OPCUA_HAVE_THREADPOOL
+    /* create the workers for the asymmetric OpenSecureChannel processing */
+    if(OpcUa_ProxyStub_g_Configuration.iSecureListener_CryptoPool_Threads > 0)
+    {
+        OpcUa_UInt32 uThreads = (OpcUa_UInt32)OpcUa_ProxyStub_g_Configuration.iSecureListener_CryptoPool_Threads;
+        OpcUa_UInt32 uMaxJobs = uThreads;
+
+        if(OpcUa_ProxyStub_g_Configuration.iSecureListener_CryptoPool_MaxJobs > 0)
+        {
+            uMaxJobs += (OpcUa_UInt32)OpcUa_ProxyStub_g_Configuration.iSecureListener_CryptoPool_MaxJobs;
+        }
+
+        uStatus = OpcUa_List_Create(&pSecureListener->pCryptoJobs);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        uStatus = OpcUa_ThreadPool_Create(  &pSecureListener->hCryptoPool,
+                                            uThreads,
+                                            uThreads,
+                                            uMaxJobs,
+                                            OpcUa_False,
+                                            0);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+#endif /* OPCUA_HAVE_THREADPOOL */
+
     /* initialize listener object */
     (*a_ppListener)->Handle              = pSecureListener;
     (*a_ppListener)->Open                = OpcUa_SecureListener_Open;
@@ -1476,12 +1725,20 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureListener, "Create");
     (*a_ppListener)->CloseConnection     = OpcUa_Null; /*OpcUa_SecureListener_CloseConnection;*/
     (*a_ppListener)->Delete              = OpcUa_SecureListener_Delete;
     (*a_ppListener)->GetPeerInfo         = OpcUa_Null; /*OpcUa_SecureListener_GetPeerInfo;*/
+    (*a_ppListener)->AddConnectionReference     = OpcUa_Null;
+    (*a_ppListener)->ReleaseConnectionReference = OpcUa_Null;
 
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
 
     if(pSecureListener != OpcUa_Null)
     {
+#ifdef OPCUA_HAVE_THREADPOOL
+        if(pSecureListener->pCryptoJobs != OpcUa_Null)
+        {
+            OpcUa_List_Delete(&pSecureListener->pCryptoJobs);
+        }
+#endif /* OPCUA_HAVE_THREADPOOL */
         OPCUA_P_MUTEX_DELETE(&(pSecureListener->Mutex));
         if(pSecureListener->ServerPKIProvider != OpcUa_Null)
         {
@@ -2255,7 +2512,9 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureListener, "ProcessOpenSecureChannelReq
 
             pSecureChannel->MessageSecurityMode = pRequest->SecurityMode;
 
-            /*** new securechannel ***/
+            /*** new securechannel; the crypto pool calls without the listener lock ***/
+            OPCUA_P_MUTEX_LOCK(pSecureListener->Mutex);
+
             OpcUa_SecureListener_ChannelManager_SetSecureChannelID(pSecureListener->ChannelManager,
                                                                    pSecureChannel,
                                                                    pSecureListener->uNextSecureChannelId++);
@@ -2268,6 +2527,8 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureListener, "ProcessOpenSecureChannelReq
                 pSecureListener->uNextSecureChannelId++;
             }
 
+            OPCUA_P_MUTEX_UNLOCK(pSecureListener->Mutex);
+
             /* generate SecurityToken */
             uStatus = pSecureChannel->GenerateSecurityToken(pSecureChannel,
                                                             pRequest->RequestedLifetime,
@@ -2286,6 +2547,16 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureListener, "ProcessOpenSecureChannelReq
                                                     &pSendingKeyset);  /* Server key is used for sending on this side.*/
         OpcUa_GotoErrorIfBad(uStatus);
 
+        /* the connection may have been closed while a crypto worker processed the request; */
+        /* the channel lock keeps it from being detached between the check and the key install. */
+        OPCUA_SECURECHANNEL_LOCK(pSecureChannel);
+
+        if(pSecureChannel->TransportConnection != a_hTransportConnection)
+        {
+            OPCUA_SECURECHANNEL_UNLOCK(pSecureChannel);
+            OpcUa_GotoErrorWithStatus(OpcUa_BadConnectionClosed);
+        }
+
         /* check whether new or existing securechannel */
         if(bRenewChannel)
         {
@@ -2299,7 +2570,6 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureListener, "ProcessOpenSecureChannelReq
                                             pReceivingKeyset, /* Client key set is used for receiving on this side. */
                                             pSendingKeyset,   /* Server key set is used for receiving on this side. */
                                             pCryptoProvider);
-            OpcUa_GotoErrorIfBad(uStatus);
 
             eSecureChannelEvent = eOpcUa_SecureListener_SecureChannelRenew;
         }
@@ -2315,11 +2585,13 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureListener, "ProcessOpenSecureChannelReq
                                             pReceivingKeyset, /* Client key set is used for receiving on this side. */
                                             pSendingKeyset,   /* Server key set is used for receiving on this side. */
                                             pCryptoProvider);
-            OpcUa_GotoErrorIfBad(uStatus);
 
             eSecureChannelEvent = eOpcUa_SecureListener_SecureChannelOpen;
         }
 
+        OPCUA_SECURECHANNEL_UNLOCK(pSecureChannel);
+        OpcUa_GotoErrorIfBad(uStatus);
+
         if(pSecureListener->SecureChannelCallback != OpcUa_Null)
         {
             OpcUa_String sTempUri;
@@ -2783,6 +3055,7 @@ OpcUa_StatusCode OpcUa_SecureListener_ProcessSessionCallRequest(
     OpcUa_UInt32            uTokenId                = 0;
     OpcUa_UInt32            uSecureChannelId        = OPCUA_SECURECHANNEL_ID_INVALID;
     OpcUa_SecurityKeyset*   pReceivingKeyset        = OpcUa_Null;
+    OpcUa_UInt64            uLatencyStart           = 0;
 
 OpcUa_InitializeStatus(OpcUa_Module_SecureListener, "ProcessSessionCallRequest");
 
@@ -2859,6 +3132,7 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureListener, "ProcessSessionCallRequest")
     if(a_bRequestComplete == OpcUa_False)
     {
         /* this is not the final chunk */
+        uLatencyStart = OpcUa_Latency_Begin();
         uStatus = OpcUa_SecureStream_AppendInput(   *a_ppTransportIstrm,
                                                     pSecureIStrm,
                                                     &pReceivingKeyset->SigningKey,
@@ -2866,6 +3140,7 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureListener, "ProcessSessionCallRequest")
                                                     &pReceivingKeyset->InitializationVector,
                                                     pCryptoProvider,
                                                     pSecureChannel);
+        OpcUa_Latency_End(OpcUa_LatencyStage_SecureReceive, 0, uLatencyStart);
         /* release reference to security set */
         pSecureChannel->ReleaseSecuritySet(   pSecureChannel,
                                               uTokenId);
@@ -2889,6 +3164,7 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureListener, "ProcessSessionCallRequest")
         pSecureStream->SecureChannelId = pSecureChannel->SecureChannelId;
 
         /* this is the final chunk */
+        uLatencyStart = OpcUa_Latency_Begin();
         uStatus = OpcUa_SecureStream_AppendInput(   *a_ppTransportIstrm,
                                                     pSecureIStrm,
                                                     &pReceivingKeyset->SigningKey,
@@ -2896,6 +3172,7 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureListener, "ProcessSessionCallRequest")
                                                     &pReceivingKeyset->InitializationVector,
                                                     pCryptoProvider,
                                                     pSecureChannel);
+        OpcUa_Latency_End(OpcUa_LatencyStage_SecureReceive, 0, uLatencyStart);
         /* release reference to security set */
         pSecureChannel->ReleaseSecuritySet( pSecureChannel,
                                             uTokenId);
@@ -3095,5 +3372,34 @@ OpcUa_BeginErrorHandling;
 OpcUa_FinishErrorHandling;
 }
 
+/*============================================================================
+ * OpcUa_SecureListener_GetChannelCounters
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_SecureListener_GetChannelCounters(
+    OpcUa_Listener*                                     a_pListener,
+    OpcUa_UInt32                                        a_uMaxCounters,
+    OpcUa_SecureChannelCounters*                        a_pCounters,
+    OpcUa_UInt32*                                       a_pNoOfCounters)
+{
+    OpcUa_SecureListener*       pSecureListener     = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_SecureListener, "GetChannelCounters");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_pListener);
+    OpcUa_ReturnErrorIfArgumentNull(a_pListener->Handle);
+
+    pSecureListener = (OpcUa_SecureListener*)a_pListener->Handle;
+
+    uStatus = OpcUa_SecureListener_ChannelManager_GetChannelCounters(
+        pSecureListener->ChannelManager,
+        a_uMaxCounters,
+        a_pCounters,
+        a_pNoOfCounters);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
 #endif /* OPCUA_HAVE_SERVERAPI */
 
@@ -24,6 +24,8 @@
 #include <opcua_decoder.h>
 #include <opcua_securechannel_types.h>
 
+struct _OpcUa_SecureChannelCounters;
+
 OPCUA_BEGIN_EXTERN_C
 
 /**
@@ -114,6 +116,20 @@ OpcUa_StatusCode OpcUa_SecureListener_GetPeerInfo(
     OpcUa_UInt32                                        a_uChannelId,
     OpcUa_String*                                       a_pPeerInfo);
 
+/**
+  @brief Copies the traffic counters of all open secure channels of the listener.
+
+  @param pListener      [in]  The secure listener.
+  @param uMaxCounters   [in]  Capacity of pCounters.
+  @param pCounters      [out] Receives the counters.
+  @param pNoOfCounters  [out] Number of counters written.
+*/
+OpcUa_StatusCode OpcUa_SecureListener_GetChannelCounters(
+    OpcUa_Listener*                                     pListener,
+    OpcUa_UInt32                                        uMaxCounters,
+    struct _OpcUa_SecureChannelCounters*                pCounters,
+    OpcUa_UInt32*                                       pNoOfCounters);
+
 OPCUA_END_EXTERN_C
 
 #endif /* OPCUA_HAVE_SERVERAPI */
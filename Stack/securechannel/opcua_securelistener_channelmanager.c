@@ -491,7 +491,10 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureListener, "SetTransportConnection");
 
     OpcUa_List_Enter(a_pChannelManager->SecureChannels);
 
+    /* the crypto workers check the connection under the channel lock */
+    OPCUA_SECURECHANNEL_LOCK(a_pSecureChannel);
     a_pSecureChannel->TransportConnection = a_hTransportConnection;
+    OPCUA_SECURECHANNEL_UNLOCK(a_pSecureChannel);
 
     OpcUa_List_Leave(a_pChannelManager->SecureChannels);
 
@@ -605,4 +608,68 @@ OpcUa_BeginErrorHandling;
 OpcUa_FinishErrorHandling;
 }
 
+/*==============================================================================*/
+/* OpcUa_SecureListener_ChannelManager_GetChannelCounters                       */
+/*==============================================================================*/
+OpcUa_StatusCode OpcUa_SecureListener_ChannelManager_GetChannelCounters(
+    OpcUa_SecureListener_ChannelManager* a_pChannelManager,
+    OpcUa_UInt32                         a_uMaxCounters,
+    OpcUa_SecureChannelCounters*         a_pCounters,
+    OpcUa_UInt32*                        a_pNoOfCounters)
+{
+    OpcUa_SecureChannel*            pTmpSecureChannel   = OpcUa_Null;
+    OpcUa_SecureChannelCounters*    pTarget             = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_SecureListener, "GetChannelCounters");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_pChannelManager);
+    OpcUa_ReturnErrorIfArgumentNull(a_pNoOfCounters);
+    OpcUa_ReturnErrorIfTrue(a_uMaxCounters > 0 && a_pCounters == OpcUa_Null, OpcUa_BadInvalidArgument);
+
+    *a_pNoOfCounters = 0;
+
+    /* the list lock only keeps the channels alive; the counters are read without stopping traffic */
+    OpcUa_List_Enter(a_pChannelManager->SecureChannels);
+
+    uStatus = OpcUa_List_ResetCurrent(a_pChannelManager->SecureChannels);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    pTmpSecureChannel = (OpcUa_SecureChannel*)OpcUa_List_GetCurrentElement(a_pChannelManager->SecureChannels);
+
+    while(pTmpSecureChannel != OpcUa_Null)
+    {
+        if(pTmpSecureChannel->SecureChannelId != OPCUA_SECURECHANNEL_ID_INVALID)
+        {
+            if(*a_pNoOfCounters == a_uMaxCounters)
+            {
+                OpcUa_GotoErrorWithStatus(OpcUa_BadEncodingLimitsExceeded);
+            }
+
+            pTarget = &a_pCounters[(*a_pNoOfCounters)++];
+
+            pTarget->SecureChannelId    = pTmpSecureChannel->SecureChannelId;
+            pTarget->BytesIn            = OpcUa_Atomic_Load64(&pTmpSecureChannel->Counters.BytesIn);
+            pTarget->BytesOut           = OpcUa_Atomic_Load64(&pTmpSecureChannel->Counters.BytesOut);
+            pTarget->ChunksIn           = OpcUa_Atomic_Load64(&pTmpSecureChannel->Counters.ChunksIn);
+            pTarget->ChunksOut          = OpcUa_Atomic_Load64(&pTmpSecureChannel->Counters.ChunksOut);
+            pTarget->MessagesIn         = OpcUa_Atomic_Load64(&pTmpSecureChannel->Counters.MessagesIn);
+            pTarget->MessagesOut        = OpcUa_Atomic_Load64(&pTmpSecureChannel->Counters.MessagesOut);
+            pTarget->Errors             = OpcUa_Atomic_Load64(&pTmpSecureChannel->Counters.Errors);
+            pTarget->TokenRenewals      = OpcUa_Atomic_Load64(&pTmpSecureChannel->Counters.TokenRenewals);
+            pTarget->CryptoTime         = OpcUa_Atomic_Load64(&pTmpSecureChannel->Counters.CryptoTime);
+        }
+
+        pTmpSecureChannel = (OpcUa_SecureChannel *)OpcUa_List_GetNextElement(a_pChannelManager->SecureChannels);
+    }
+
+    OpcUa_List_Leave(a_pChannelManager->SecureChannels);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_List_Leave(a_pChannelManager->SecureChannels);
+
+OpcUa_FinishErrorHandling;
+}
+
 #endif /* OPCUA_HAVE_SERVERAPI */
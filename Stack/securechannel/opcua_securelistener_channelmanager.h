@@ -86,6 +86,13 @@ OpcUa_StatusCode OpcUa_SecureListener_ChannelManager_GetChannelByTransportConnec
     OpcUa_Handle                         hTransportConnection,
     OpcUa_SecureChannel**                ppSecureChannel);
 
+/* @brief Copies the traffic counters of all managed channels. */
+OpcUa_StatusCode OpcUa_SecureListener_ChannelManager_GetChannelCounters(
+    OpcUa_SecureListener_ChannelManager* pChannelManager,
+    OpcUa_UInt32                         uMaxCounters,
+    OpcUa_SecureChannelCounters*         pCounters,
+    OpcUa_UInt32*                        pNoOfCounters);
+
 OPCUA_END_EXTERN_C
 
 #endif /* OPCUA_HAVE_SERVERAPI */
@@ -18,6 +18,7 @@
 #include <opcua.h>
 #include <opcua_mutex.h>
 #include <opcua_string.h>
+#include <opcua_datetime.h>
 
 /* stackcore */
 #include <opcua_stream.h>
@@ -54,6 +55,21 @@
  * INTERNAL FUNCTIONS
  *===========================================================================*/
 
+/**
+ * @brief INTERNAL FUNCTION: Returns the time of day in microseconds for the crypto time counter.
+ */
+static OpcUa_UInt64 OpcUa_SecureStream_GetMicroseconds(OpcUa_Void)
+{
+    OpcUa_TimeVal tv;
+
+    if(OpcUa_IsBad(OpcUa_DateTime_GetTimeOfDay(&tv)))
+    {
+        return 0;
+    }
+
+    return (OpcUa_UInt64)tv.uintSeconds * 1000000 + tv.uintMicroSeconds;
+}
+
 /**
  * @brief INTERNAL FUNCTION: Prepares the stream for sending it to the socket.
  *
@@ -934,6 +950,8 @@ static OpcUa_StatusCode OpcUa_SecureStream_Flush(   OpcUa_OutputStream* a_pOstrm
     OpcUa_Key*              pInitializationVector   = OpcUa_Null;
     OpcUa_UInt32            uTokenId                = 0;
     OpcUa_SecureChannel*    pSecureChannel          = OpcUa_Null;
+    OpcUa_UInt64            uCryptoStart            = 0;
+    OpcUa_UInt32            uChunkLength            = 0;
 
 OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "Flush");
 
@@ -1000,6 +1018,11 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "Flush");
             uTokenId                = 0;
         }
 
+        if(pSecureStream->eMessageSecurityMode != OpcUa_MessageSecurityMode_None)
+        {
+            uCryptoStart = OpcUa_SecureStream_GetMicroseconds();
+        }
+
         /** sign and encrypt **/
         uStatus = OpcUa_SecureStream_PrepareForSending( a_pOstrm,
                                                         pCryptoProvider,
@@ -1008,6 +1031,11 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "Flush");
                                                         pInitializationVector,
                                                         uTokenId);
 
+        if(uCryptoStart != 0)
+        {
+            OpcUa_SecureChannel_AddCounter(pSecureChannel, CryptoTime, OpcUa_SecureStream_GetMicroseconds() - uCryptoStart);
+        }
+
         if(pSecureStream->eMessageType != eOpcUa_SecureStream_Types_OpenSecureChannel)
         {
             /* release reference to security set - failsafe, no errorchecking required */
@@ -1017,6 +1045,9 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "Flush");
 
         OpcUa_GotoErrorIfBad(uStatus);
 
+        /* the buffer is handed over to the transport below */
+        uChunkLength = pSecureStream->Buffers[0].EndOfData;
+
         if(pSecureChannel->bAsyncWriteInProgress)
         {
             OpcUa_BufferList* pBufferEntry = OpcUa_Alloc(sizeof(OpcUa_BufferList));
@@ -1099,6 +1130,13 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "Flush");
 
             /* increment flush counter */
             pSecureStream->uNoOfFlushes++;
+
+            OpcUa_SecureChannel_AddCounter(pSecureChannel, ChunksOut, 1);
+            OpcUa_SecureChannel_AddCounter(pSecureChannel, BytesOut, uChunkLength);
+            if(a_bLastCall != OpcUa_False)
+            {
+                OpcUa_SecureChannel_AddCounter(pSecureChannel, MessagesOut, 1);
+            }
         }
         else
         {
@@ -1157,6 +1195,11 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "Flush");
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
 
+    if(pSecureChannel != OpcUa_Null)
+    {
+        OpcUa_SecureChannel_AddCounter(pSecureChannel, Errors, 1);
+    }
+
     if(pSecureStream->IsLocked == OpcUa_True && a_bLastCall == OpcUa_True)
     {
         pSecureChannel->UnlockWriteMutex(pSecureChannel);
@@ -1178,6 +1221,7 @@ static OpcUa_StatusCode OpcUa_SecureStream_Write(   OpcUa_OutputStream* a_pOstrm
     OpcUa_UInt32        uDataLeft       = 0;
     OpcUa_UInt32        uDataWritten    = 0;
     OpcUa_Byte*         pWriteStart     = OpcUa_Null;
+    OpcUa_Boolean       bMessageBody    = OpcUa_False;
 
 OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "Write");
 
@@ -1196,6 +1240,9 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "Write");
         OpcUa_GotoErrorIfBad(uStatus);
     }
 
+    /* the headers are encoded through this function too but lie in front of the body */
+    bMessageBody = (OpcUa_Boolean)(pSecureStream->Buffers[0].Position >= pSecureStream->uBeginOfRequestBody);
+
     /* do the writing */
     uMaxCount   = pSecureStream->uFlushTrigger - pSecureStream->Buffers[0].Position;
     uDataLeft   = a_uCount;
@@ -1238,6 +1285,11 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "Write");
     uStatus = OpcUa_Buffer_Write(&pSecureStream->Buffers[0], pWriteStart, uDataLeft);
     OpcUa_ReturnErrorIfBad(uStatus);
 
+    if(bMessageBody != OpcUa_False)
+    {
+        pSecureStream->uBytesWritten += a_uCount;
+    }
+
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
 OpcUa_FinishErrorHandling;
@@ -1345,6 +1397,9 @@ static OpcUa_Void OpcUa_SecureStream_Delete(OpcUa_Stream** a_ppStrm)
     {
         OpcUa_SecureStream* pStream = OpcUa_Null;
         OpcUa_UInt32 uIndex = 0;
+#if OPCUA_SECURECHANNEL_STREAMCACHE_SIZE
+        OpcUa_SecureChannel* pSecureChannel = OpcUa_Null;
+#endif /* OPCUA_SECURECHANNEL_STREAMCACHE_SIZE */
 
         pStream = (OpcUa_SecureStream*)(*a_ppStrm)->Handle;
 
@@ -1354,6 +1409,37 @@ static OpcUa_Void OpcUa_SecureStream_Delete(OpcUa_Stream** a_ppStrm)
             pStream->IsLocked = OpcUa_False;
         }
 
+#if OPCUA_SECURECHANNEL_STREAMCACHE_SIZE
+        /* keep symmetric output streams at the channel for the next message */
+        pSecureChannel = pStream->pSecureChannel;
+        if(    (*a_ppStrm)->Type            == OpcUa_StreamType_Output
+            && pSecureChannel               != OpcUa_Null
+            && pStream->eMessageType        != eOpcUa_SecureStream_Types_OpenSecureChannel
+            && pStream->pSenderPublicKey    == OpcUa_Null
+            && pStream->pReceiverPublicKey  == OpcUa_Null)
+        {
+            OPCUA_SECURECHANNEL_LOCK(pSecureChannel);
+            if(pSecureChannel->uNoOfCachedStreams < OPCUA_SECURECHANNEL_STREAMCACHE_SIZE)
+            {
+                pSecureChannel->apCachedStreams[pSecureChannel->uNoOfCachedStreams++] = (OpcUa_OutputStream*)*a_ppStrm;
+                pStream->pSecureChannel = OpcUa_Null;
+                pStream->InnerStrm      = OpcUa_Null;
+                *a_ppStrm               = OpcUa_Null;
+            }
+            OPCUA_SECURECHANNEL_UNLOCK(pSecureChannel);
+
+            if(*a_ppStrm == OpcUa_Null)
+            {
+                if(pSecureChannel->ReleaseMethod != OpcUa_Null)
+                {
+                    pSecureChannel->ReleaseMethod(pSecureChannel->ReleaseParam,
+                                                  &pSecureChannel);
+                }
+                return;
+            }
+        }
+#endif /* OPCUA_SECURECHANNEL_STREAMCACHE_SIZE */
+
         if (pStream->pSecureChannel != OpcUa_Null && pStream->pSecureChannel->ReleaseMethod != OpcUa_Null)
         {
             pStream->pSecureChannel->ReleaseMethod(
@@ -1412,6 +1498,27 @@ OpcUa_BeginErrorHandling;
 OpcUa_FinishErrorHandling;
 }
 
+/*============================================================================
+ * OpcUa_SecureStream_GetBytesWritten
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_SecureStream_GetBytesWritten(  OpcUa_OutputStream* a_pOstrm,
+                                                      OpcUa_UInt32*       a_pBytesWritten)
+{
+OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "GetBytesWritten");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_pOstrm);
+    OpcUa_ReturnErrorIfArgumentNull(a_pOstrm->Handle);
+    OpcUa_ReturnErrorIfArgumentNull(a_pBytesWritten);
+
+    OpcUa_ReturnErrorIfInvalidObject(OpcUa_SecureStream, a_pOstrm, Write);
+
+    *a_pBytesWritten = ((OpcUa_SecureStream*)a_pOstrm->Handle)->uBytesWritten;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
 /*============================================================================
  * OpcUa_Stream_SetPosition
  *===========================================================================*/
@@ -1622,6 +1729,7 @@ OpcUa_StatusCode OpcUa_SecureStream_AppendInput(OpcUa_InputStream*      a_pTrans
     OpcUa_UInt32        uSequenceNumber = 0;
     OpcUa_UInt32        uRequestId      = 0;
     OpcUa_SecureStream* pSecureStream   = OpcUa_Null;
+    OpcUa_UInt64        uCryptoStart    = 0;
 
 OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "AppendInput");
 
@@ -1640,6 +1748,16 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "AppendInput");
         OpcUa_ReturnStatusCode;
     }
 
+    if(a_pSecureChannel != OpcUa_Null)
+    {
+        OpcUa_SecureChannel_AddCounter(a_pSecureChannel, ChunksIn, 1);
+        OpcUa_SecureChannel_AddCounter(a_pSecureChannel, BytesIn, readBuffer.EndOfData);
+        if(readBuffer.EndOfData > 3 && readBuffer.Data[3] == 'F')
+        {
+            OpcUa_SecureChannel_AddCounter(a_pSecureChannel, MessagesIn, 1);
+        }
+    }
+
     if(pSecureStream->nBuffers >= pSecureStream->nMaxBuffers)
     {
         OpcUa_Trace(OPCUA_TRACE_LEVEL_WARNING, "OpcUa_SecureStream_AppendInput: %u max chunks per message exceeded! Close connection!\n", pSecureStream->nMaxBuffers);
@@ -1650,6 +1768,11 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "AppendInput");
         OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_SecureStream_AppendInput: Appending buffer %u!\n", pSecureStream->nBuffers);
     }
 
+    if(a_pSecureChannel != OpcUa_Null && pSecureStream->eMessageSecurityMode != OpcUa_MessageSecurityMode_None)
+    {
+        uCryptoStart = OpcUa_SecureStream_GetMicroseconds();
+    }
+
     switch(pSecureStream->eMessageSecurityMode)
     {
     case OpcUa_MessageSecurityMode_None:
@@ -1765,6 +1888,12 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "AppendInput");
         }
     }
 
+    if(uCryptoStart != 0)
+    {
+        OpcUa_SecureChannel_AddCounter(a_pSecureChannel, CryptoTime, OpcUa_SecureStream_GetMicroseconds() - uCryptoStart);
+        uCryptoStart = 0;
+    }
+
     /* ToDo: check against MAXCHUNKPERMESSAGE */
 
     /* increment and copy buffer to secure stream */
@@ -1819,6 +1948,15 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "AppendInput");
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
 
+    if(a_pSecureChannel != OpcUa_Null)
+    {
+        if(uCryptoStart != 0)
+        {
+            OpcUa_SecureChannel_AddCounter(a_pSecureChannel, CryptoTime, OpcUa_SecureStream_GetMicroseconds() - uCryptoStart);
+        }
+        OpcUa_SecureChannel_AddCounter(a_pSecureChannel, Errors, 1);
+    }
+
     OpcUa_Buffer_Clear(&readBuffer);
 
 OpcUa_FinishErrorHandling;
@@ -1957,6 +2095,64 @@ OpcUa_BeginErrorHandling;
 OpcUa_FinishErrorHandling;
 }
 
+/*============================================================================
+ * OpcUa_SecureStream_GetSymmetricChunkLayout
+ *===========================================================================*/
+/* The caller must hold the security set of the channel. */
+static OpcUa_StatusCode OpcUa_SecureStream_GetSymmetricChunkLayout(  OpcUa_SecureChannel*            a_pSecureChannel,
+                                                                    OpcUa_CryptoProvider*           a_pCryptoProvider,
+                                                                    OpcUa_UInt32                    a_uTokenId,
+                                                                    OpcUa_UInt32                    a_uChunkLength,
+                                                                    OpcUa_SecureChannelChunkLayout* a_pChunkLayout)
+{
+    OpcUa_SecureChannelChunkLayout* pLayout = &a_pSecureChannel->SymmetricChunkLayout;
+    OpcUa_SecureStream              TemplateStream;
+
+OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "GetSymmetricChunkLayout");
+
+    if(     pLayout->bValid               == OpcUa_False
+        ||  pLayout->pCryptoProvider      != a_pCryptoProvider
+        ||  pLayout->uTokenId             != a_uTokenId
+        ||  pLayout->eMessageSecurityMode != a_pSecureChannel->MessageSecurityMode
+        ||  pLayout->uChunkLength         != a_uChunkLength)
+    {
+        pLayout->bValid = OpcUa_False;
+
+        /* calculate the flush trigger for a stream with the symmetric header already encoded */
+        OpcUa_MemSet(&TemplateStream, 0, sizeof(OpcUa_SecureStream));
+        TemplateStream.eMessageSecurityMode = a_pSecureChannel->MessageSecurityMode;
+        TemplateStream.uBeginOfRequestBody  = OPCUA_SECURESTREAM_SYMMETRIC_HEADER_LEN;
+
+        uStatus = OpcUa_SecureStream_GetSymmetricEncryptionBlockSizes(  a_pCryptoProvider,
+                                                                        &TemplateStream.uPlainTextBlockSize,
+                                                                        &TemplateStream.uCipherTextBlockSize);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        uStatus = OpcUa_SecureStream_GetSymmetricSignatureSize( a_pCryptoProvider,
+                                                                &TemplateStream.uSignatureSize);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        uStatus = OpcUa_SecureStream_CalculateFlushTrigger(&TemplateStream, a_uChunkLength);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        pLayout->pCryptoProvider        = a_pCryptoProvider;
+        pLayout->uTokenId               = a_uTokenId;
+        pLayout->eMessageSecurityMode   = a_pSecureChannel->MessageSecurityMode;
+        pLayout->uChunkLength           = a_uChunkLength;
+        pLayout->uPlainTextBlockSize    = TemplateStream.uPlainTextBlockSize;
+        pLayout->uCipherTextBlockSize   = TemplateStream.uCipherTextBlockSize;
+        pLayout->uSignatureSize         = TemplateStream.uSignatureSize;
+        pLayout->uFlushTrigger          = TemplateStream.uFlushTrigger;
+        pLayout->bValid                 = OpcUa_True;
+    }
+
+    *a_pChunkLayout = *pLayout;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
 /*============================================================================
  * OpcUa_SecureStream_CreateInput
  *===========================================================================*/
@@ -2017,6 +2213,7 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "CreateInput");
     pSecureStream->pReceiverCertificateThumbprint = OpcUa_Null;
 
     pSecureStream->nAbsolutePosition    = 0;
+    pSecureStream->uBytesWritten        = 0;
     pSecureStream->SecureChannelId      = 0;
     pSecureStream->pSecureChannel       = OpcUa_Null;
 
@@ -2117,6 +2314,7 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "CreateOpenSecureChannelInput"
     pSecureStream->uCipherTextBlockSize             = 1;
     pSecureStream->uSignatureSize                   = 0;
     pSecureStream->nAbsolutePosition                = 0;
+    pSecureStream->uBytesWritten                    = 0;
     pSecureStream->SecureChannelId                  = 0;
     pSecureStream->pSecureChannel                   = OpcUa_Null;
 
@@ -2360,6 +2558,9 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "CreateOpenSecureChannelOutput
     /* store postion of stream */
     uStatus = OpcUa_Buffer_GetPosition(&pSecureStream->Buffers[0], &pSecureStream->uBeginOfRequestBody);
 
+    /* the body starts here */
+    pSecureStream->uBytesWritten = 0;
+
     /* Flush trigger must be recalculated after encoding the header */
     uStatus = OpcUa_SecureStream_CalculateFlushTrigger(pSecureStream, uChunkLength);
     OpcUa_GotoErrorIfBad(uStatus);
@@ -2408,6 +2609,7 @@ OpcUa_StatusCode OpcUa_SecureStream_CreateOutput(   OpcUa_OutputStream*
     OpcUa_CryptoProvider*   pCryptoProvider     = OpcUa_Null;   /* TODO: Get from secure channel */
     OpcUa_UInt32            uSecureChannelId    = 0;            /* TODO: Get from secure channel */
     OpcUa_UInt32            uTokenId            = 0;            /* TODO: Get from secure channel */
+    OpcUa_SecureChannelChunkLayout ChunkLayout;
 
 OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "CreateOutput");
 
@@ -2419,30 +2621,66 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "CreateOutput");
 
     uSecureChannelId = a_pSecureChannel->SecureChannelId;
 
-    /*** create SecureStream ***/
-    pSecureStream = (OpcUa_SecureStream*)OpcUa_Alloc(sizeof(OpcUa_SecureStream));
-    OpcUa_GotoErrorIfAllocFailed(pSecureStream);
-    OpcUa_MemSetD(pSecureStream, 0, sizeof(OpcUa_SecureStream));
-
-    pSecureStream->uBeginOfRequestBody = 0;
-
     /* internal buffer management */
     uStatus = a_pInnerOstrm->GetChunkLength((OpcUa_Stream*)a_pInnerOstrm, &uChunkLength);
     OpcUa_GotoErrorIfBad(uStatus);
 
-    pSecureStream->nBuffers             = 1; /* only one buffer for outstreams! */
-    pSecureStream->nCurrentReadBuffer   = 0;
+#if OPCUA_SECURECHANNEL_STREAMCACHE_SIZE
+    /* reuse a stream deleted earlier on this channel */
+    OPCUA_SECURECHANNEL_LOCK(a_pSecureChannel);
+    if(a_pSecureChannel->uNoOfCachedStreams > 0)
+    {
+        a_pSecureChannel->uNoOfCachedStreams--;
+        *a_ppOstrm = a_pSecureChannel->apCachedStreams[a_pSecureChannel->uNoOfCachedStreams];
+        a_pSecureChannel->apCachedStreams[a_pSecureChannel->uNoOfCachedStreams] = OpcUa_Null;
+    }
+    OPCUA_SECURECHANNEL_UNLOCK(a_pSecureChannel);
 
-    pSecureStream->Buffers = (OpcUa_Buffer*)OpcUa_Alloc(sizeof(OpcUa_Buffer)); /* only one buffer per outstream */
-    OpcUa_GotoErrorIfAllocFailed(pSecureStream->Buffers);
+    if(*a_ppOstrm != OpcUa_Null)
+    {
+        OpcUa_Buffer* pBuffers = OpcUa_Null;
 
-    uStatus = OpcUa_Buffer_Initialize(  &pSecureStream->Buffers[0], /* the buffer */
-                                        OpcUa_Null,                 /* initialize data */
-                                        0,                          /* size of initialize data */
-                                        uChunkLength,               /* block size */
-                                        uChunkLength,               /* max size = initial size */
-                                        OpcUa_True);                /* free memory on delete */
-    OpcUa_GotoErrorIfBad(uStatus);
+        pSecureStream = (OpcUa_SecureStream*)(*a_ppOstrm)->Handle;
+        pBuffers      = pSecureStream->Buffers;
+
+        OpcUa_MemSetD(pSecureStream, 0, sizeof(OpcUa_SecureStream));
+        pSecureStream->Buffers = pBuffers;
+
+        /* keep the chunk memory unless it was handed to the transport */
+        if(pBuffers[0].Data != OpcUa_Null && pBuffers[0].MaxSize == uChunkLength)
+        {
+            OpcUa_Buffer_SetEmpty(&pBuffers[0]);
+        }
+        else
+        {
+            OpcUa_Buffer_Clear(&pBuffers[0]);
+            uStatus = OpcUa_Buffer_Initialize(&pBuffers[0], OpcUa_Null, 0, uChunkLength, uChunkLength, OpcUa_True);
+            OpcUa_GotoErrorIfBad(uStatus);
+        }
+    }
+    else
+#endif /* OPCUA_SECURECHANNEL_STREAMCACHE_SIZE */
+    {
+        /*** create SecureStream ***/
+        pSecureStream = (OpcUa_SecureStream*)OpcUa_Alloc(sizeof(OpcUa_SecureStream));
+        OpcUa_GotoErrorIfAllocFailed(pSecureStream);
+        OpcUa_MemSetD(pSecureStream, 0, sizeof(OpcUa_SecureStream));
+
+        pSecureStream->Buffers = (OpcUa_Buffer*)OpcUa_Alloc(sizeof(OpcUa_Buffer)); /* only one buffer per outstream */
+        OpcUa_GotoErrorIfAllocFailed(pSecureStream->Buffers);
+
+        uStatus = OpcUa_Buffer_Initialize(  &pSecureStream->Buffers[0], /* the buffer */
+                                            OpcUa_Null,                 /* initialize data */
+                                            0,                          /* size of initialize data */
+                                            uChunkLength,               /* block size */
+                                            uChunkLength,               /* max size = initial size */
+                                            OpcUa_True);                /* free memory on delete */
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+    pSecureStream->uBeginOfRequestBody  = 0;
+    pSecureStream->nBuffers             = 1; /* only one buffer for outstreams! */
+    pSecureStream->nCurrentReadBuffer   = 0;
 
     /* general stream settings */
     pSecureStream->SanityCheck          = OpcUa_SecureStream_SanityCheck;
@@ -2477,17 +2715,12 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "CreateOutput");
                                                         &pCryptoProvider);
     OpcUa_GotoErrorIfBad(uStatus);
 
-    /* get the encryption block sizes */
-    uStatus = OpcUa_SecureStream_GetSymmetricEncryptionBlockSizes(  pCryptoProvider,
-                                                                    &pSecureStream->uPlainTextBlockSize,
-                                                                    &pSecureStream->uCipherTextBlockSize);
-
-    if(OpcUa_IsGood(uStatus))
-    {
-        /* get the signature size */
-        uStatus = OpcUa_SecureStream_GetSymmetricSignatureSize( pCryptoProvider,
-                                                                &pSecureStream->uSignatureSize);
-    }
+    /* sizes and flush trigger are calculated once per token and chunk length */
+    uStatus = OpcUa_SecureStream_GetSymmetricChunkLayout(   a_pSecureChannel,
+                                                            pCryptoProvider,
+                                                            uTokenId,
+                                                            uChunkLength,
+                                                            &ChunkLayout);
 
     /* release reference to security set */
     a_pSecureChannel->ReleaseSecuritySet(   a_pSecureChannel,
@@ -2495,14 +2728,17 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "CreateOutput");
 
     OpcUa_GotoErrorIfBad(uStatus);
 
-    /* Calculate flush trigger */
-    uStatus = OpcUa_SecureStream_CalculateFlushTrigger( pSecureStream,
-                                                        uChunkLength);
-    OpcUa_GotoErrorIfBad(uStatus);
+    pSecureStream->uPlainTextBlockSize  = ChunkLayout.uPlainTextBlockSize;
+    pSecureStream->uCipherTextBlockSize = ChunkLayout.uCipherTextBlockSize;
+    pSecureStream->uSignatureSize       = ChunkLayout.uSignatureSize;
+    pSecureStream->uFlushTrigger        = ChunkLayout.uFlushTrigger;
 
     /*** create OutputStream ***/
-    *a_ppOstrm = (OpcUa_OutputStream*)OpcUa_Alloc(sizeof(OpcUa_OutputStream));
-    OpcUa_GotoErrorIfAllocFailed(*a_ppOstrm);
+    if(*a_ppOstrm == OpcUa_Null)
+    {
+        *a_ppOstrm = (OpcUa_OutputStream*)OpcUa_Alloc(sizeof(OpcUa_OutputStream));
+        OpcUa_GotoErrorIfAllocFailed(*a_ppOstrm);
+    }
     OpcUa_MemSet(*a_ppOstrm, 0, sizeof(OpcUa_OutputStream));
 
     (*a_ppOstrm)->Type                  = OpcUa_StreamType_Output;
@@ -2532,16 +2768,26 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "CreateOutput");
     uStatus = OpcUa_Buffer_GetPosition(&pSecureStream->Buffers[0], &pSecureStream->uBeginOfRequestBody);
     OpcUa_GotoErrorIfBad(uStatus);
 
-    /* Flush trigger must be recalculated after encoding the header */
-    uStatus = OpcUa_SecureStream_CalculateFlushTrigger(pSecureStream, uChunkLength);
-    OpcUa_GotoErrorIfBad(uStatus);
+    /* the body starts here */
+    pSecureStream->uBytesWritten = 0;
+
+    /* the precalculated flush trigger assumes the standard header length */
+    if(pSecureStream->uBeginOfRequestBody != OPCUA_SECURESTREAM_SYMMETRIC_HEADER_LEN)
+    {
+        uStatus = OpcUa_SecureStream_CalculateFlushTrigger(pSecureStream, uChunkLength);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
 
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
 
     if(pSecureStream != OpcUa_Null)
     {
-        OpcUa_Free(pSecureStream->Buffers);
+        if(pSecureStream->Buffers != OpcUa_Null)
+        {
+            OpcUa_Buffer_Clear(&pSecureStream->Buffers[0]);
+            OpcUa_Free(pSecureStream->Buffers);
+        }
         OpcUa_Free(pSecureStream);
     }
 
@@ -52,6 +52,9 @@ OpcUa_SecureStream_Type;
 /** @brief Lentgh of the message types. */
 #define OPCUA_SECURESTREAM_MESSAGETYPE_LEN 8
 
+/** @brief Length of message type, channel id, token id, sequence number and request id of a symmetric chunk. */
+#define OPCUA_SECURESTREAM_SYMMETRIC_HEADER_LEN (OPCUA_SECURESTREAM_MESSAGETYPE_LEN + sizeof(OpcUa_UInt32)*4)
+
 /** @brief Stores state information for a secure stream. */
 typedef struct _OpcUa_SecureStream
 {
@@ -76,6 +79,8 @@ typedef struct _OpcUa_SecureStream
     OpcUa_UInt32                nCurrentReadBuffer;
     /** @brief The absolute position spanning all included buffers. Returned in GetPosition. */
     OpcUa_UInt32                nAbsolutePosition;
+    /** @brief The number of message bytes written to an output stream, without secure channel headers. */
+    OpcUa_UInt32                uBytesWritten;
 
     /** @brief The Request Id the stream belongs to. */
     OpcUa_UInt32                RequestId;
@@ -284,6 +289,19 @@ OPCUA_EXPORT OpcUa_StatusCode OpcUa_SecureStream_CreateOpenSecureChannelOutput(
                                                                                 OpcUa_ByteString*           pReceiverCertificateThumbprint,
                                                                                 OpcUa_OutputStream**        ppOstrm);
 
+/**
+  @brief Returns the number of message bytes written to a secure output stream.
+
+  The count excludes the secure channel headers, padding and signatures of the chunks.
+
+  @param pOstrm        [in]  The secure output stream.
+  @param pBytesWritten [out] The number of bytes passed to Write since the stream was created.
+
+  @return OpcUa_BadInvalidArgument if pOstrm is not a secure output stream.
+*/
+OpcUa_StatusCode OpcUa_SecureStream_GetBytesWritten(  OpcUa_OutputStream*     pOstrm,
+                                                      OpcUa_UInt32*           pBytesWritten);
+
 /**
   @brief Encrypts a given outputstream.
 
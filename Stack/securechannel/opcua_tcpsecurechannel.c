@@ -613,6 +613,8 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureChannel, "Renew");
     a_pSecureChannel->pCurrentReceivingKeyset                       = a_pNewReceivingKeyset;
     a_pSecureChannel->pCurrentSendingKeyset                         = a_pNewSendingKeyset;
 
+    OpcUa_SecureChannel_AddCounter(a_pSecureChannel, TokenRenewals, 1);
+
     OPCUA_SECURECHANNEL_UNLOCK(a_pSecureChannel);
 
 OpcUa_ReturnStatusCode;
@@ -802,6 +804,15 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureChannel, "Clear");
         OpcUa_Free(pCurrentBuffer);
     }
 
+#if OPCUA_SECURECHANNEL_STREAMCACHE_SIZE
+    /* cached streams no longer reference the channel and are really deleted */
+    while(a_pSecureChannel->uNoOfCachedStreams > 0)
+    {
+        a_pSecureChannel->uNoOfCachedStreams--;
+        OpcUa_Stream_Delete((OpcUa_Stream**)&a_pSecureChannel->apCachedStreams[a_pSecureChannel->uNoOfCachedStreams]);
+    }
+#endif /* OPCUA_SECURECHANNEL_STREAMCACHE_SIZE */
+
     if(a_pSecureChannel->hSyncAccess != OpcUa_Null)
     {
         OPCUA_P_MUTEX_DELETE(&(a_pSecureChannel->hSyncAccess));
@@ -51,6 +51,18 @@ OpcUa_BinaryEncoder;
  *===========================================================================*/
 #define OpcUa_BinaryEncoder_SanityCheck 0x323278DA
 
+/*============================================================================
+ * OpcUa_BinaryEncodeContext
+ *
+ * Encoder copy and state of one open call, allocated as a single block.
+ *===========================================================================*/
+typedef struct _OpcUa_BinaryEncodeContext
+{
+    struct _OpcUa_Encoder Encoder;
+    OpcUa_BinaryEncoder   State;
+}
+OpcUa_BinaryEncodeContext;
+
 /*============================================================================
  * OpcUa_BinaryEncoder_VerifyState
  *===========================================================================*/
@@ -201,7 +213,7 @@ OpcUa_StatusCode OpcUa_BinaryEncoder_Open(
     OpcUa_MessageContext*  a_pContext,
     OpcUa_Handle*          a_phEncodeContext)
 {
-    struct _OpcUa_Encoder* pEncodeContext = OpcUa_Null;
+    OpcUa_BinaryEncodeContext* pEncodeContext = OpcUa_Null;
 
 OpcUa_InitializeStatus(OpcUa_Module_Serializer, "OpcUa_BinaryEncoder_Open");
 
@@ -218,29 +230,21 @@ OpcUa_InitializeStatus(OpcUa_Module_Serializer, "OpcUa_BinaryEncoder_Open");
 
     OpcUa_GotoErrorIfTrue(!((OpcUa_BinaryEncoder*)a_pEncoder->Handle)->Closed, OpcUa_BadInvalidState);
 
-    /* create handle */
-    pEncodeContext = (struct _OpcUa_Encoder*)OpcUa_Alloc(sizeof(struct _OpcUa_Encoder));
+    /* create handle; encoder copy and state share one allocation */
+    pEncodeContext = (OpcUa_BinaryEncodeContext*)OpcUa_Alloc(sizeof(OpcUa_BinaryEncodeContext));
     OpcUa_GotoErrorIfAllocFailed(pEncodeContext);
-    OpcUa_MemCpy(pEncodeContext, sizeof(struct _OpcUa_Encoder), a_pEncoder, sizeof(struct _OpcUa_Encoder));
+    OpcUa_MemCpy(&pEncodeContext->Encoder, sizeof(struct _OpcUa_Encoder), a_pEncoder, sizeof(struct _OpcUa_Encoder));
 
-    pEncodeContext->Handle = OpcUa_Alloc(sizeof(OpcUa_BinaryEncoder));
-    OpcUa_GotoErrorIfAllocFailed(pEncodeContext->Handle);
+    pEncodeContext->Encoder.Handle      = &pEncodeContext->State;
+    pEncodeContext->State.SanityCheck   = ((OpcUa_BinaryEncoder*)a_pEncoder->Handle)->SanityCheck;
+    pEncodeContext->State.Ostrm         = a_pOstrm;
+    pEncodeContext->State.Context       = a_pContext;
+    pEncodeContext->State.Closed        = OpcUa_False;
 
-    ((OpcUa_BinaryEncoder*)pEncodeContext->Handle)->SanityCheck = ((OpcUa_BinaryEncoder*)a_pEncoder->Handle)->SanityCheck;
-    ((OpcUa_BinaryEncoder*)pEncodeContext->Handle)->Ostrm       = a_pOstrm;
-    ((OpcUa_BinaryEncoder*)pEncodeContext->Handle)->Context     = a_pContext;
-    ((OpcUa_BinaryEncoder*)pEncodeContext->Handle)->Closed      = OpcUa_False;
-
-    *a_phEncodeContext = pEncodeContext;
+    *a_phEncodeContext = &pEncodeContext->Encoder;
 
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
-
-    if(pEncodeContext != OpcUa_Null)
-    {
-        OpcUa_Free(pEncodeContext);
-    }
-
 OpcUa_FinishErrorHandling;
 }
 
@@ -262,7 +266,7 @@ OpcUa_InitializeStatus(OpcUa_Module_Serializer, "OpcUa_BinaryEncoder_Close");
 
     pEncoderContext = (struct _OpcUa_Encoder*)*a_phEncodeContext;
 
-    OpcUa_Free(pEncoderContext->Handle);
+    /* the state is part of the context allocation */
     OpcUa_Free(pEncoderContext);
 
     *a_phEncodeContext = OpcUa_Null;
@@ -165,3 +165,31 @@ OPCUA_EXPORT OpcUa_StatusCode OpcUa_Listener_CheckProtocolVersion(
 
     return a_pListener->CheckProtocolVersion(a_pListener, a_hConnection, a_uProtocolVersion);
 }
+
+/*============================================================================
+ * OpcUa_Listener_AddConnectionReference
+ *===========================================================================*/
+OPCUA_EXPORT OpcUa_StatusCode OpcUa_Listener_AddConnectionReference(
+    OpcUa_Listener*         a_pListener,
+    OpcUa_Handle            a_hConnection)
+{
+    OpcUa_DeclareErrorTraceModule(OpcUa_Module_Listener);
+    OpcUa_ReturnErrorIfArgumentNull(a_pListener);
+    OpcUa_ReturnErrorIfArgumentNull(a_pListener->AddConnectionReference);
+
+    return a_pListener->AddConnectionReference(a_pListener, a_hConnection);
+}
+
+/*============================================================================
+ * OpcUa_Listener_ReleaseConnectionReference
+ *===========================================================================*/
+OPCUA_EXPORT OpcUa_StatusCode OpcUa_Listener_ReleaseConnectionReference(
+    OpcUa_Listener*         a_pListener,
+    OpcUa_Handle            a_hConnection)
+{
+    OpcUa_DeclareErrorTraceModule(OpcUa_Module_Listener);
+    OpcUa_ReturnErrorIfArgumentNull(a_pListener);
+    OpcUa_ReturnErrorIfArgumentNull(a_pListener->ReleaseConnectionReference);
+
+    return a_pListener->ReleaseConnectionReference(a_pListener, a_hConnection);
+}
@@ -277,6 +277,37 @@ typedef OpcUa_StatusCode (OpcUa_Listener_PfnCheckProtocolVersion)(
     OpcUa_Handle            hConnection,
     OpcUa_UInt32            uProtocolVersion);
 
+/**
+  @brief Keep a particular connection object alive beyond its disconnect.
+
+  The handle stays valid until the reference is released, but transport calls
+  on it fail with OpcUa_BadConnectionClosed once the peer is gone.
+
+  @param pListener   [in] The listener.
+  @param hConnection [in] The connection to reference.
+*/
+OPCUA_EXPORT OpcUa_StatusCode OpcUa_Listener_AddConnectionReference(
+    struct _OpcUa_Listener* pListener,
+    OpcUa_Handle            hConnection);
+
+typedef OpcUa_StatusCode (OpcUa_Listener_PfnAddConnectionReference)(
+    struct _OpcUa_Listener* pListener,
+    OpcUa_Handle            hConnection);
+
+/**
+  @brief Release a reference taken with OpcUa_Listener_AddConnectionReference.
+
+  @param pListener   [in] The listener.
+  @param hConnection [in] The connection; the handle may be invalid after return.
+*/
+OPCUA_EXPORT OpcUa_StatusCode OpcUa_Listener_ReleaseConnectionReference(
+    struct _OpcUa_Listener* pListener,
+    OpcUa_Handle            hConnection);
+
+typedef OpcUa_StatusCode (OpcUa_Listener_PfnReleaseConnectionReference)(
+    struct _OpcUa_Listener* pListener,
+    OpcUa_Handle            hConnection);
+
 /**
   @brief A generic listener for an endpoint.
 */
@@ -317,6 +348,12 @@ typedef struct _OpcUa_Listener
 
     /*! @brief Check the client protocol version of a particular connection. */
     OpcUa_Listener_PfnCheckProtocolVersion* CheckProtocolVersion;
+
+    /*! @brief Keep a particular connection object alive; may be null. */
+    OpcUa_Listener_PfnAddConnectionReference* AddConnectionReference;
+
+    /*! @brief Release a connection reference; may be null. */
+    OpcUa_Listener_PfnReleaseConnectionReference* ReleaseConnectionReference;
 }
 OpcUa_Listener;
 
@@ -22,6 +22,7 @@ OPCUA_BEGIN_EXTERN_C
 #include <opcua_types.h>
 #include <opcua_crypto.h>
 #include <opcua_pki.h>
+#include <opcua_stream.h>
 
 #define OPCUA_SECURECHANNEL_THREADSAFE      OPCUA_CONFIG_YES
 #define OPCUA_SECURECHANNEL_DEBUG_MUTEX     OPCUA_CONFIG_NO
@@ -368,6 +369,71 @@ typedef enum _OpcUa_SecureChannelState
     OpcUa_SecureChannelState_Closed
 } OpcUa_SecureChannelState;
 
+/**
+ * @brief Traffic counters of a securechannel. Updated with atomic operations
+ *        and readable while the channel is in use.
+ *
+ * @see OpcUa_Endpoint_GetSecureChannelCounters
+ */
+struct _OpcUa_SecureChannelCounters
+{
+    /** @brief The id of the secure channel. */
+    OpcUa_UInt32        SecureChannelId;
+    /** @brief Bytes received in message chunks including headers. */
+    OpcUa_UInt64        BytesIn;
+    /** @brief Bytes sent in message chunks including headers. */
+    OpcUa_UInt64        BytesOut;
+    /** @brief Message chunks received. */
+    OpcUa_UInt64        ChunksIn;
+    /** @brief Message chunks sent. */
+    OpcUa_UInt64        ChunksOut;
+    /** @brief Complete messages received. */
+    OpcUa_UInt64        MessagesIn;
+    /** @brief Complete messages sent. */
+    OpcUa_UInt64        MessagesOut;
+    /** @brief Chunks that could not be processed or sent. */
+    OpcUa_UInt64        Errors;
+    /** @brief Security token renewals. */
+    OpcUa_UInt64        TokenRenewals;
+    /** @brief Microseconds spent signing, verifying, encrypting and decrypting chunks. */
+    OpcUa_UInt64        CryptoTime;
+};
+
+typedef struct _OpcUa_SecureChannelCounters OpcUa_SecureChannelCounters;
+
+/**
+ * @brief Adds a value to a securechannel counter.
+ */
+#define OpcUa_SecureChannel_AddCounter(xSecureChannel, xCounter, xValue) \
+    OpcUa_Atomic_Add64((OpcUa_Int64*)&(xSecureChannel)->Counters.xCounter, (OpcUa_Int64)(xValue))
+
+/**
+ * @brief Sizes of symmetric chunks sent through a securechannel. Constant for a token, security mode and chunk length.
+ */
+struct _OpcUa_SecureChannelChunkLayout
+{
+    /** @brief Set if the layout was calculated. */
+    OpcUa_Boolean               bValid;
+    /** @brief The crypto provider the layout was calculated with. */
+    OpcUa_CryptoProvider*       pCryptoProvider;
+    /** @brief The token the layout was calculated for. */
+    OpcUa_UInt32                uTokenId;
+    /** @brief The security mode the layout was calculated for. */
+    OpcUa_MessageSecurityMode   eMessageSecurityMode;
+    /** @brief The chunk length the layout was calculated for. */
+    OpcUa_UInt32                uChunkLength;
+    /** @brief Plain text block size of the symmetric encryption. */
+    OpcUa_UInt32                uPlainTextBlockSize;
+    /** @brief Cipher text block size of the symmetric encryption. */
+    OpcUa_UInt32                uCipherTextBlockSize;
+    /** @brief Size of the symmetric signature. */
+    OpcUa_UInt32                uSignatureSize;
+    /** @brief Body position at which a chunk is full. */
+    OpcUa_UInt32                uFlushTrigger;
+};
+
+typedef struct _OpcUa_SecureChannelChunkLayout OpcUa_SecureChannelChunkLayout;
+
 /**
  * @brief The securechannel structure.
  */
@@ -477,8 +543,19 @@ struct _OpcUa_SecureChannel
     struct _OpcUa_BufferList*                       pPendingSendBuffers;
     /** @brief Server emulates the blocking behaviour if a response is sent from the read handler. */
     OpcUa_UInt32                                    uPendingMessageCount;
+    /** @brief Set while an OpenSecureChannel request of this channel waits for or runs in the listener's crypto pool. */
+    OpcUa_Boolean                                   bOpenRequestPending;
+    /** @brief Layout of outgoing symmetric chunks; protected by the security set lock. */
+    OpcUa_SecureChannelChunkLayout                  SymmetricChunkLayout;
+#if OPCUA_SECURECHANNEL_STREAMCACHE_SIZE
+    /** @brief Output streams kept for reuse by the next message; protected by hSyncAccess. */
+    OpcUa_OutputStream*                             apCachedStreams[OPCUA_SECURECHANNEL_STREAMCACHE_SIZE];
+    OpcUa_UInt32                                    uNoOfCachedStreams;
+#endif /* OPCUA_SECURECHANNEL_STREAMCACHE_SIZE */
     /** @brief Stores the peer information. */
     OpcUa_String                                    sPeerInfo;
+    /** @brief Traffic counters; see OpcUa_SecureChannel_AddCounter. */
+    OpcUa_SecureChannelCounters                     Counters;
 };
 typedef struct _OpcUa_SecureChannel OpcUa_SecureChannel;
 
@@ -382,22 +382,24 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpStream, "OpcUa_HttpsRequestLine_Parse");
     OpcUa_GotoErrorIfBad(uStatus);
 
 
-    /* get HTTP Version */
+    /* get HTTP Version; the line is not zero terminated if headers are not copied */
     pInitialChar = pTerminalChar + 1;
     uPos++;
+    uCharCount   = uLineLength - uPos;
 
-    if(     OpcUa_StrnCmpA(pInitialChar, "HTTP/1.1", uLineLength - uPos) != 0
+    if(     uCharCount != 8
+        || (    OpcUa_StrnCmpA(pInitialChar, "HTTP/1.1", uCharCount) != 0
 #if OPCUA_HTTPS_ALLOW_HTTP10
-        &&  OpcUa_StrnCmpA(pInitialChar, "HTTP/1.0", uLineLength - uPos) != 0
+            &&  OpcUa_StrnCmpA(pInitialChar, "HTTP/1.0", uCharCount) != 0
 #endif /* OPCUA_HTTPS_ALLOW_HTTP10 */
-        )
+           ))
     {
         OpcUa_GotoErrorWithStatus(OpcUa_BadInvalidArgument);
     }
 
     uStatus = OpcUa_String_AttachToString(pInitialChar,
-                                          OPCUA_STRINGLENZEROTERMINATED,
-                                          0,
+                                          uCharCount,
+                                          uCharCount,
 #if OPCUA_HTTPS_COPYHEADERS
                                           OpcUa_True,
 #else
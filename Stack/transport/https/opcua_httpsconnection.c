@@ -52,6 +52,11 @@
 /* Set to yes, if requests should be protected by a mutex. */
 #define OPCUA_HTTPSCONNECTION_SYNCHRONIZE_REQUESTS      OPCUA_CONFIG_YES
 
+/* Set to yes, to pipeline requests on busy connections up to iHttpsTransport_MaxPipelinedRequests. */
+#ifndef OPCUA_HTTPSCONNECTION_PIPELINE_REQUESTS
+# define OPCUA_HTTPSCONNECTION_PIPELINE_REQUESTS        OPCUA_CONFIG_NO
+#endif /* OPCUA_HTTPSCONNECTION_PIPELINE_REQUESTS */
+
 /*============================================================================
  * auto config and helper macros
  *===========================================================================*/
@@ -94,6 +99,22 @@ typedef enum _OpcUa_HttpsConnectionState
     OpcUa_HttpsConnectionState_Error
 } OpcUa_HttpsConnectionState;
 
+/*============================================================================
+ * OpcUa_HttpsConnection_PipelinedRequest
+ *===========================================================================*/
+/** @brief A request sent behind the pending request of the same connection. */
+typedef struct _OpcUa_HttpsConnection_PipelinedRequest
+{
+    /** @brief The time when the request was sent to the server. */
+    OpcUa_UInt32                    RequestStartTime;
+    /** @brief The time when the request is no longer valid. */
+    OpcUa_UInt32                    RequestTimeout;
+    /*! The callback to use when the request completes. */
+    OpcUa_Connection_PfnOnResponse* RequestCallback;
+    /*! The data to pass with the callback. */
+    OpcUa_Void*                     RequestCallbackData;
+} OpcUa_HttpsConnection_PipelinedRequest;
+
 /*============================================================================
  * OpcUa_HttpsRequest
  *===========================================================================*/
@@ -126,6 +147,14 @@ typedef struct _OpcUa_HttpsConnection_Request
     OpcUa_Boolean                   bNotify;
     /** @brief The queued list of data blocks to be sent. */
     OpcUa_BufferList*               pSendQueue;
+    /** @brief Ring of requests waiting behind the pending one, in sending order. */
+    OpcUa_HttpsConnection_PipelinedRequest* pPipeline;
+    /** @brief Capacity of the pipeline ring. */
+    OpcUa_UInt32                    uPipelineSize;
+    /** @brief Index of the oldest entry in the pipeline ring. */
+    OpcUa_UInt32                    uPipelineHead;
+    /** @brief Number of entries in the pipeline ring. */
+    OpcUa_UInt32                    uPipelineCount;
 } OpcUa_HttpsConnection_Request;
 
 /*============================================================================
@@ -201,6 +230,113 @@ OpcUa_StatusCode OpcUa_HttpsConnection_Disconnect(
     OpcUa_Connection*   a_pConnection,
     OpcUa_Boolean       a_bNotifyOnComplete);
 
+/*============================================================================
+ * OpcUa_HttpsConnection_NextPipelinedRequest
+ *===========================================================================*/
+/**
+ * @brief Makes the oldest pipelined request the pending one, if any.
+ *
+ * Must be called with the request locked after the pending request was answered.
+ */
+static OpcUa_Boolean OpcUa_HttpsConnection_NextPipelinedRequest(
+    OpcUa_HttpsConnection_Request*  a_pRequest)
+{
+    OpcUa_HttpsConnection_PipelinedRequest* pEntry = OpcUa_Null;
+
+    if(a_pRequest->uPipelineCount == 0)
+    {
+        return OpcUa_False;
+    }
+
+    pEntry = &a_pRequest->pPipeline[a_pRequest->uPipelineHead];
+
+    a_pRequest->RequestStartTime    = pEntry->RequestStartTime;
+    a_pRequest->RequestTimeout      = pEntry->RequestTimeout;
+    a_pRequest->RequestCallback     = pEntry->RequestCallback;
+    a_pRequest->RequestCallbackData = pEntry->RequestCallbackData;
+
+    a_pRequest->uPipelineHead = (a_pRequest->uPipelineHead + 1) % a_pRequest->uPipelineSize;
+    a_pRequest->uPipelineCount--;
+
+    return OpcUa_True;
+}
+
+/*============================================================================
+ * OpcUa_HttpsConnection_CancelRequests
+ *===========================================================================*/
+/**
+ * @brief Completes the pending and all pipelined requests with the given status.
+ *
+ * Must be called with the request locked; the lock is released around each callback.
+ */
+static OpcUa_Void OpcUa_HttpsConnection_CancelRequests(
+    OpcUa_HttpsConnection_Request*  a_pRequest,
+    OpcUa_StatusCode                a_uStatus)
+{
+    do
+    {
+        if(a_pRequest->RequestCallback != OpcUa_Null)
+        {
+            OpcUa_Connection_PfnOnResponse* pfnRequestCallback      = a_pRequest->RequestCallback;
+            OpcUa_Void*                     pvRequestCallbackData   = a_pRequest->RequestCallbackData;
+
+            a_pRequest->RequestCallback     = OpcUa_Null;
+            a_pRequest->RequestCallbackData = OpcUa_Null;
+
+            OPCUA_HTTPSCONNECTION_REQUEST_UNLOCK(a_pRequest);
+
+            pfnRequestCallback( a_pRequest->pConnection,    /* source of the event      */
+                                pvRequestCallbackData,      /* the callback data        */
+                                a_uStatus,                  /* status of the request    */
+                                OpcUa_Null);                /* no stream for this event */
+
+            OPCUA_HTTPSCONNECTION_REQUEST_LOCK(a_pRequest);
+        }
+    } while(OpcUa_HttpsConnection_NextPipelinedRequest(a_pRequest) != OpcUa_False);
+}
+
+/*============================================================================
+ * OpcUa_HttpsConnection_TimeoutPipelinedRequests
+ *===========================================================================*/
+/**
+ * @brief Completes expired pipelined requests with OpcUa_BadTimeout.
+ *
+ * The entries stay in the ring since their responses are still expected.
+ * Must be called with the request locked; the lock is released around each callback.
+ */
+static OpcUa_Void OpcUa_HttpsConnection_TimeoutPipelinedRequests(
+    OpcUa_HttpsConnection_Request*  a_pRequest,
+    OpcUa_UInt32                    a_uCurrentTime)
+{
+    OpcUa_UInt32 uEntry = 0;
+
+    for(uEntry = 0; uEntry < a_pRequest->uPipelineCount; uEntry++)
+    {
+        OpcUa_HttpsConnection_PipelinedRequest* pEntry = &a_pRequest->pPipeline[(a_pRequest->uPipelineHead + uEntry) % a_pRequest->uPipelineSize];
+
+        if(     pEntry->RequestCallback != OpcUa_Null
+            &&  pEntry->RequestTimeout != OPCUA_INFINITE
+            &&  pEntry->RequestTimeout != 0
+            &&  (OpcUa_Int32)(a_uCurrentTime - pEntry->RequestStartTime) >= (OpcUa_Int32)pEntry->RequestTimeout)
+        {
+            OpcUa_Connection_PfnOnResponse* pfnRequestCallback      = pEntry->RequestCallback;
+            OpcUa_Void*                     pvRequestCallbackData   = pEntry->RequestCallbackData;
+
+            pEntry->RequestCallback     = OpcUa_Null;
+            pEntry->RequestCallbackData = OpcUa_Null;
+
+            OPCUA_HTTPSCONNECTION_REQUEST_UNLOCK(a_pRequest);
+
+            pfnRequestCallback( a_pRequest->pConnection,
+                                pvRequestCallbackData,
+                                OpcUa_BadTimeout,
+                                OpcUa_Null);
+
+            OPCUA_HTTPSCONNECTION_REQUEST_LOCK(a_pRequest);
+        }
+    }
+}
+
 /*============================================================================
  * OpcUa_HttpsConnection_WatchdogTimerCallback
  *===========================================================================*/
@@ -231,6 +367,8 @@ OpcUa_StatusCode OPCUA_DLLCALL OpcUa_HttpsConnection_WatchdogTimerCallback( OpcU
 
         OPCUA_HTTPSCONNECTION_REQUEST_LOCK(pRequest);
 
+        OpcUa_HttpsConnection_TimeoutPipelinedRequests(pRequest, CurrentTime);
+
         /* pHttpsConnection->OperationTimeout: absolute count of milliseconds    */
         /* pHttpsConnection->StartTime:        start time in millisecond ticks   */
         /* uTime                               current time in millisecond ticks */
@@ -326,25 +464,9 @@ OpcUa_StatusCode OPCUA_DLLCALL OpcUa_HttpsConnection_WatchdogTimerKillCallback(
         OPCUA_HTTPSCONNECTION_REQUEST_LOCK(pRequest);
 
         /* tell all waiting callbacks of the cancellation */
-        if(pRequest->RequestCallback != OpcUa_Null)
-        {
-            OpcUa_Connection_PfnOnResponse* pfnRequestCallback      = pRequest->RequestCallback;
-            OpcUa_Void*                     pvRequestCallbackData   = pRequest->RequestCallbackData;
-
-            pRequest->RequestCallback       = OpcUa_Null;
-            pRequest->RequestCallbackData   = OpcUa_Null;
-
-            OPCUA_HTTPSCONNECTION_REQUEST_UNLOCK(pRequest);
+        OpcUa_HttpsConnection_CancelRequests(pRequest, OpcUa_BadDisconnect);
 
-            pfnRequestCallback( (OpcUa_Connection*)a_pvCallbackData,    /* source of the event      */
-                                pvRequestCallbackData,                  /* the callback data        */
-                                OpcUa_BadDisconnect,                    /* status of the request    */
-                                OpcUa_Null);                            /* the stream to read from  */
-        }
-        else
-        {
-            OPCUA_HTTPSCONNECTION_REQUEST_UNLOCK(pRequest);
-        }
+        OPCUA_HTTPSCONNECTION_REQUEST_UNLOCK(pRequest);
     }
 
     return OpcUa_Good;
@@ -435,6 +557,58 @@ OpcUa_BeginErrorHandling;
 OpcUa_FinishErrorHandling;
 }
 
+/*============================================================================
+ * OpcUa_HttpsConnection_GetPipelinableRequest
+ *===========================================================================*/
+/** @brief Finds the connection with a free pipeline entry and the fewest requests in flight. */
+static OpcUa_StatusCode OpcUa_HttpsConnection_GetPipelinableRequest(
+    OpcUa_HttpsConnection*            a_pHttpConnection,
+    OpcUa_HttpsConnection_Request**   a_ppRequest)
+{
+    OpcUa_HttpsConnection_Request*  pRequest    = OpcUa_Null;
+    OpcUa_UInt32                    uIndex      = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_HttpConnection, "GetPipelinableRequest");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_pHttpConnection);
+    OpcUa_ReturnErrorIfArgumentNull(a_ppRequest);
+
+    *a_ppRequest = OpcUa_Null;
+
+    for(uIndex = 0; uIndex < OPCUA_HTTPS_CONNECTION_MAXPENDINGREQUESTS; uIndex++)
+    {
+        pRequest = &a_pHttpConnection->arrHttpsRequests[uIndex];
+
+        OPCUA_HTTPSCONNECTION_REQUEST_LOCK(pRequest);
+
+        if(     pRequest->ConnectionState == OpcUa_HttpsConnectionState_WaitingForResponse
+            &&  pRequest->OutgoingStream == OpcUa_Null
+            &&  pRequest->uPipelineCount < pRequest->uPipelineSize
+            &&  (*a_ppRequest == OpcUa_Null || pRequest->uPipelineCount < (*a_ppRequest)->uPipelineCount))
+        {
+            if(*a_ppRequest != OpcUa_Null)
+            {
+                OPCUA_HTTPSCONNECTION_REQUEST_UNLOCK(*a_ppRequest);
+            }
+
+            *a_ppRequest = pRequest;
+        }
+        else
+        {
+            OPCUA_HTTPSCONNECTION_REQUEST_UNLOCK(pRequest);
+        }
+    }
+
+    if(*a_ppRequest == OpcUa_Null)
+    {
+        OpcUa_GotoErrorWithStatus(OpcUa_BadNotFound);
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
 /*============================================================================
  * Handling a disconnect from the server.
  *===========================================================================*/
@@ -484,31 +658,21 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpConnection, "HandleDisconnect");
     }
 
     /* notify upper layer about disconnect */
-    if(a_pRequest->RequestCallback != OpcUa_Null)
+    if(a_pRequest->RequestCallback != OpcUa_Null || a_pRequest->uPipelineCount != 0)
     {
-        OpcUa_Connection_PfnOnResponse* pfnRequestCallback      = a_pRequest->RequestCallback;
-        OpcUa_Void*                     pvRequestCallbackData   = a_pRequest->RequestCallbackData;
-
-        a_pRequest->RequestCallback        = OpcUa_Null;
-        a_pRequest->RequestCallbackData    = OpcUa_Null;
-
-        OPCUA_HTTPSCONNECTION_REQUEST_UNLOCK(a_pRequest);
-
         OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_HandleDisconnect: notify!\n");
 
-        pfnRequestCallback( pConnection,
-                            pvRequestCallbackData,
-                            a_uReason,
-                            OpcUa_Null); /* no stream for this event */
+        OpcUa_HttpsConnection_CancelRequests(a_pRequest, a_uReason);
 
         OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_HandleDisconnect: notify done!\n");
     }
     else
     {
         OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_HandleDisconnect: no notification possible!\n");
-        OPCUA_HTTPSCONNECTION_REQUEST_UNLOCK(a_pRequest);
     }
 
+    OPCUA_HTTPSCONNECTION_REQUEST_UNLOCK(a_pRequest);
+
     /* if the first connection fails, shutdown completely */
     if(a_pRequest->bNotify != OpcUa_False)
     {
@@ -597,7 +761,9 @@ static OpcUa_StatusCode OpcUa_HttpsConnection_ProcessResponse(
     OpcUa_HttpsConnection_Request*  a_pRequest,
     OpcUa_InputStream*              a_pInputStream)
 {
-    OpcUa_String sHeaderValue = OPCUA_STRING_STATICINITIALIZER;
+    OpcUa_String                    sHeaderValue            = OPCUA_STRING_STATICINITIALIZER;
+    OpcUa_Connection_PfnOnResponse* pfnRequestCallback      = OpcUa_Null;
+    OpcUa_Void*                     pvRequestCallbackData   = OpcUa_Null;
 
 OpcUa_InitializeStatus(OpcUa_Module_HttpConnection, "ProcessResponse");
 
@@ -609,6 +775,12 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpConnection, "ProcessResponse");
 
     OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_ProcessResponse: Response for request %p\n", a_pRequest);
 
+    /* responses arrive in the order the requests were sent */
+    pfnRequestCallback              = a_pRequest->RequestCallback;
+    pvRequestCallbackData           = a_pRequest->RequestCallbackData;
+    a_pRequest->RequestCallback     = OpcUa_Null;
+    a_pRequest->RequestCallbackData = OpcUa_Null;
+
     uStatus = OpcUa_HttpsStream_GetHeader(  (OpcUa_Stream*)a_pInputStream,
                                             OpcUa_String_FromCString("Connection"),
                                             OpcUa_False,
@@ -657,14 +829,22 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpConnection, "ProcessResponse");
         }
     }
 
-    if(a_pRequest->RequestCallback != OpcUa_Null)
+    if(a_pRequest->ConnectionState == OpcUa_HttpsConnectionState_Connected)
     {
-        OpcUa_Connection_PfnOnResponse* pfnRequestCallback      = a_pRequest->RequestCallback;
-        OpcUa_Void*                     pvRequestCallbackData   = a_pRequest->RequestCallbackData;
-        OpcUa_UInt32                    uMessageStatus          = 0;
+        if(OpcUa_HttpsConnection_NextPipelinedRequest(a_pRequest) != OpcUa_False)
+        {
+            a_pRequest->ConnectionState = OpcUa_HttpsConnectionState_WaitingForResponse;
+        }
+        else if(a_pRequest->OutgoingStream != OpcUa_Null)
+        {
+            /* a pipelined request is still being prepared */
+            a_pRequest->ConnectionState = OpcUa_HttpsConnectionState_PreparingForRequest;
+        }
+    }
 
-        a_pRequest->RequestCallback     = OpcUa_Null;
-        a_pRequest->RequestCallbackData = OpcUa_Null;
+    if(pfnRequestCallback != OpcUa_Null)
+    {
+        OpcUa_UInt32                    uMessageStatus          = 0;
 
         OpcUa_HttpsConnection_ConvertHttpStatusCode(    (OpcUa_Stream*)a_pInputStream,
                                                         &uMessageStatus);
@@ -716,6 +896,12 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpConnection, "ProcessResponse");
         OPCUA_HTTPSCONNECTION_REQUEST_LOCK(a_pRequest);
     }
 
+    if(a_pRequest->ConnectionState == OpcUa_HttpsConnectionState_Disconnected)
+    {
+        /* requests sent behind this one will not be answered anymore */
+        OpcUa_HttpsConnection_CancelRequests(a_pRequest, OpcUa_BadConnectionClosed);
+    }
+
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
 OpcUa_FinishErrorHandling;
@@ -735,8 +921,6 @@ OpcUa_StatusCode OpcUa_HttpsConnection_ExceptEventHandler(
     OpcUa_Socket                    a_hSocket)
 {
     OpcUa_HttpsConnection*          pHttpConnection         = OpcUa_Null;
-    OpcUa_Connection_PfnOnResponse* pfnRequestCallback      = OpcUa_Null;
-    OpcUa_Void*                     pvRequestCallbackData   = OpcUa_Null;
     OpcUa_Connection*               pConnection             = OpcUa_Null;
     OpcUa_Boolean                   bIsConnecting           = OpcUa_False;
 
@@ -790,22 +974,10 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpConnection, "ExceptEventHandler");
         OpcUa_Free(pCurrentBuffer);
     }
 
-    pfnRequestCallback      = a_pRequest->RequestCallback;
-    pvRequestCallbackData   = a_pRequest->RequestCallbackData;
-
-    a_pRequest->RequestCallback        = OpcUa_Null;
-    a_pRequest->RequestCallbackData    = OpcUa_Null;
+    OpcUa_HttpsConnection_CancelRequests(a_pRequest, OpcUa_BadCommunicationError);
 
     OPCUA_HTTPSCONNECTION_REQUEST_UNLOCK(a_pRequest);
 
-    if(pfnRequestCallback != OpcUa_Null)
-    {
-        pfnRequestCallback( pConnection,
-                            pvRequestCallbackData,
-                            OpcUa_BadCommunicationError,
-                            OpcUa_Null); /* no stream for this event */
-    }
-
     if(a_pRequest->bNotify != OpcUa_False)
     {
         if(bIsConnecting != OpcUa_False)
@@ -1187,6 +1359,8 @@ OpcUa_StatusCode OpcUa_HttpsConnection_ReadEventHandler(
     OpcUa_HttpsConnection_Request*  a_pRequest,
     OpcUa_Socket                    a_hSocket)
 {
+    OpcUa_InputStream* pNextInputStream = OpcUa_Null;
+
 OpcUa_InitializeStatus(OpcUa_Module_HttpConnection, "ReadEventHandler");
 
     OpcUa_ReturnErrorIfArgumentNull(a_pRequest);
@@ -1196,94 +1370,111 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpConnection, "ReadEventHandler");
 
     OPCUA_HTTPSCONNECTION_REQUEST_LOCK(a_pRequest);
 
-    /******************************************************************************************/
-
-    /* check if a new stream needs to be created */
-    if(a_pRequest->IncomingStream == OpcUa_Null)
+    /* one read may carry several pipelined responses */
+    do
     {
-        /* create a new input stream */
-        uStatus = OpcUa_HttpsStream_CreateInput(a_hSocket,
-                                               OpcUa_HttpsStream_MessageType_Response,
-                                               &(a_pRequest->IncomingStream));
-        OpcUa_GotoErrorIfBad(uStatus);
-    }
+        /******************************************************************************************/
 
-    /******************************************************************************************/
+        /* check if a new stream needs to be created */
+        if(a_pRequest->IncomingStream == OpcUa_Null)
+        {
+            /* create a new input stream */
+            uStatus = OpcUa_HttpsStream_CreateInput(a_hSocket,
+                                                   OpcUa_HttpsStream_MessageType_Response,
+                                                   &(a_pRequest->IncomingStream));
+            OpcUa_GotoErrorIfBad(uStatus);
+        }
 
-    /* notify target stream about newly available data */
-    uStatus = OpcUa_HttpsStream_DataReady(a_pRequest->IncomingStream);
+        /******************************************************************************************/
 
-    /******************************************************************************************/
+        /* notify target stream about newly available data */
+        uStatus = OpcUa_HttpsStream_DataReady(a_pRequest->IncomingStream);
 
-    if(OpcUa_IsEqual(OpcUa_GoodCallAgain))
-    {
-        OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_ReadEventHandler: CallAgain result for stream %p on socket %p!\n", a_pRequest->IncomingStream, a_hSocket);
-    }
-    else
-    {
-        if(OpcUa_IsBad(uStatus))
+        /******************************************************************************************/
+
+        if(OpcUa_IsEqual(OpcUa_GoodCallAgain))
+        {
+            OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_ReadEventHandler: CallAgain result for stream %p on socket %p!\n", a_pRequest->IncomingStream, a_hSocket);
+        }
+        else
         {
-            /* Error happened... */
-            switch(uStatus)
+            if(OpcUa_IsBad(uStatus))
             {
-                case OpcUa_BadDecodingError:
+                /* Error happened... */
+                switch(uStatus)
                 {
-                    OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_ReadEventHandler: OpcUa_BadDecodingError for stream %p on socket %p!\n", a_pRequest->IncomingStream, a_hSocket);
-                    break;
-                }
-                case OpcUa_BadDisconnect:
-                {
-                    OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_ReadEventHandler: OpcUa_BadDisconnect for stream %p on socket %p!\n", a_pRequest->IncomingStream, a_hSocket);
-                    break;
-                }
-                case OpcUa_BadCommunicationError:
-                {
-                    OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_ReadEventHandler: OpcUa_BadCommunicationError for stream %p on socket %p!\n", a_pRequest->IncomingStream, a_hSocket);
-                    break;
-                }
-                case OpcUa_BadConnectionClosed:
-                {
-                    OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_ReadEventHandler: OpcUa_BadConnectionClosed for stream %p on socket %p!\n", a_pRequest->IncomingStream, a_hSocket);
-                    break;
-                }
-                default:
-                {
-                    OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_ReadEventHandler: Bad (%x) status for stream %p on socket %p!\n", uStatus, a_pRequest->IncomingStream, a_hSocket);
+                    case OpcUa_BadDecodingError:
+                    {
+                        OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_ReadEventHandler: OpcUa_BadDecodingError for stream %p on socket %p!\n", a_pRequest->IncomingStream, a_hSocket);
+                        break;
+                    }
+                    case OpcUa_BadDisconnect:
+                    {
+                        OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_ReadEventHandler: OpcUa_BadDisconnect for stream %p on socket %p!\n", a_pRequest->IncomingStream, a_hSocket);
+                        break;
+                    }
+                    case OpcUa_BadCommunicationError:
+                    {
+                        OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_ReadEventHandler: OpcUa_BadCommunicationError for stream %p on socket %p!\n", a_pRequest->IncomingStream, a_hSocket);
+                        break;
+                    }
+                    case OpcUa_BadConnectionClosed:
+                    {
+                        OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_ReadEventHandler: OpcUa_BadConnectionClosed for stream %p on socket %p!\n", a_pRequest->IncomingStream, a_hSocket);
+                        break;
+                    }
+                    default:
+                    {
+                        OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_ReadEventHandler: Bad (%x) status for stream %p on socket %p!\n", uStatus, a_pRequest->IncomingStream, a_hSocket);
+                    }
                 }
+
+                a_pRequest->IncomingStream->Close((OpcUa_Stream*)a_pRequest->IncomingStream);
+                a_pRequest->IncomingStream->Delete((OpcUa_Stream**)&(a_pRequest->IncomingStream));
+
+                OpcUa_GotoError;
             }
+            else /* Message can be processed. */
+            {
+                OpcUa_HttpsStream_MessageType    eMessageType    = OpcUa_HttpsStream_MessageType_Unknown;
+                OpcUa_HttpsStream_GetMessageType((OpcUa_Stream*)a_pRequest->IncomingStream, &eMessageType);
 
-            a_pRequest->IncomingStream->Close((OpcUa_Stream*)a_pRequest->IncomingStream);
-            a_pRequest->IncomingStream->Delete((OpcUa_Stream**)&(a_pRequest->IncomingStream));
+                if(eMessageType == OpcUa_HttpsStream_MessageType_Response)
+                {
+                    OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_ReadEventHandler: MessageType RESPONSE\n");
 
-            OpcUa_GotoError;
-        }
-        else /* Message can be processed. */
-        {
-            OpcUa_HttpsStream_MessageType    eMessageType    = OpcUa_HttpsStream_MessageType_Unknown;
-            OpcUa_HttpsStream_GetMessageType((OpcUa_Stream*)a_pRequest->IncomingStream, &eMessageType);
+                    /* keep data received behind this response for the next one */
+                    uStatus = OpcUa_HttpsStream_CreatePipelinedInput(a_pRequest->IncomingStream, &pNextInputStream);
+                    OpcUa_GotoErrorIfBad(uStatus);
 
-            if(eMessageType == OpcUa_HttpsStream_MessageType_Response)
-            {
-                OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_ReadEventHandler: MessageType RESPONSE\n");
+                    uStatus = OpcUa_HttpsConnection_ProcessResponse(a_pRequest, a_pRequest->IncomingStream);
 
-                uStatus = OpcUa_HttpsConnection_ProcessResponse(a_pRequest, a_pRequest->IncomingStream);
+                    if(a_pRequest->IncomingStream != OpcUa_Null)
+                    {
+                        a_pRequest->IncomingStream->Close((OpcUa_Stream*)a_pRequest->IncomingStream);
+                        a_pRequest->IncomingStream->Delete((OpcUa_Stream**)&a_pRequest->IncomingStream);
+                        a_pRequest->IncomingStream = OpcUa_Null;
+                    }
 
-                if(a_pRequest->IncomingStream != OpcUa_Null)
+                    if(a_pRequest->Socket != a_hSocket)
+                    {
+                        /* connection got closed while processing the response */
+                        OpcUa_HttpsStream_Delete((OpcUa_Stream**)&pNextInputStream);
+                    }
+
+                    a_pRequest->IncomingStream = pNextInputStream;
+                    pNextInputStream = OpcUa_Null;
+                }
+                else
                 {
+                    OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_ReadEventHandler: Invalid MessageType (%d)\n", eMessageType);
+
                     a_pRequest->IncomingStream->Close((OpcUa_Stream*)a_pRequest->IncomingStream);
                     a_pRequest->IncomingStream->Delete((OpcUa_Stream**)&a_pRequest->IncomingStream);
-                    a_pRequest->IncomingStream = OpcUa_Null;
                 }
             }
-            else
-            {
-                OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_ReadEventHandler: Invalid MessageType (%d)\n", eMessageType);
-
-                a_pRequest->IncomingStream->Close((OpcUa_Stream*)a_pRequest->IncomingStream);
-                a_pRequest->IncomingStream->Delete((OpcUa_Stream**)&a_pRequest->IncomingStream);
-            }
         }
-    }
+    } while(uStatus != OpcUa_GoodCallAgain && a_pRequest->IncomingStream != OpcUa_Null);
 
     OPCUA_HTTPSCONNECTION_REQUEST_UNLOCK(a_pRequest);
 
@@ -1825,6 +2016,12 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpConnection, "BeginSendRequest");
                                                         OpcUa_HttpsConnectionState_Connected,
                                                         &pRequest);
 
+    if(OpcUa_IsBad(uStatus))
+    {
+        /* send behind the requests in flight on an established connection. */
+        uStatus = OpcUa_HttpsConnection_GetPipelinableRequest(pHttpConnection, &pRequest);
+    }
+
     if(OpcUa_IsBad(uStatus))
     {
         /* if no object is available in the above state, try to connect another request object first. */
@@ -1888,6 +2085,10 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpConnection, "BeginSendRequest");
 
         OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_BeginSendRequest: New transport connection required for request %p!\n", pRequest);
     }
+    else if(pRequest->ConnectionState == OpcUa_HttpsConnectionState_WaitingForResponse)
+    {
+        OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_BeginSendRequest: Pipelining request behind %u on connection %p for request %p!\n", pRequest->uPipelineCount + 1, pHttpConnection, pRequest);
+    }
     else
     {
         pRequest->ConnectionState   = OpcUa_HttpsConnectionState_PreparingForRequest;
@@ -1949,22 +2150,92 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpConnection, "EndSendRequest");
         OpcUa_GotoError;
     }
 
-    /* check for consistency */
-    if(pRequest->RequestCallback != OpcUa_Null)
+    if(pRequest->ConnectionState != OpcUa_HttpsConnectionState_WaitingForResponse)
     {
-        OpcUa_Trace(OPCUA_TRACE_LEVEL_ERROR, "OpcUa_HttpsConnection_EndSendRequest: Request in wrong state\n");
-        OpcUa_GotoErrorWithStatus(OpcUa_BadInvalidState);
-    }
+        /* check for consistency */
+        if(pRequest->RequestCallback != OpcUa_Null)
+        {
+            OpcUa_Trace(OPCUA_TRACE_LEVEL_ERROR, "OpcUa_HttpsConnection_EndSendRequest: Request in wrong state\n");
+            OpcUa_GotoErrorWithStatus(OpcUa_BadInvalidState);
+        }
 
-    /* set request data */
-    pRequest->RequestTimeout        = a_uTimeout;
-    pRequest->RequestStartTime      = OpcUa_GetTickCount();
-    pRequest->RequestCallback       = a_pfnCallback;
-    pRequest->RequestCallbackData   = a_pCallbackData;
+        /* set request data */
+        pRequest->RequestTimeout        = a_uTimeout;
+        pRequest->RequestStartTime      = OpcUa_GetTickCount();
+        pRequest->RequestCallback       = a_pfnCallback;
+        pRequest->RequestCallbackData   = a_pCallbackData;
+    }
 
     /* check for valid connection state */
     switch(pRequest->ConnectionState)
     {
+    case OpcUa_HttpsConnectionState_WaitingForResponse:     /* pipelined behind pending requests */
+        {
+            OpcUa_HttpsConnection_PipelinedRequest* pEntry = OpcUa_Null;
+
+            pRequest->OutgoingStream = OpcUa_Null;
+
+            OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_EndSendRequest: pipelining request %p on connection %p.\n", pRequest, pHttpConnection);
+
+            /* older requests may still wait in the send queue */
+            if(pRequest->pSendQueue != OpcUa_Null)
+            {
+                uStatus = OpcUa_HttpsStream_Finish(*a_ppOutputStream);
+                if(OpcUa_IsGood(uStatus))
+                {
+                    uStatus = OpcUa_HttpsConnection_AddStreamToSendQueue(pRequest, *a_ppOutputStream);
+                }
+            }
+            else
+            {
+                uStatus = (*a_ppOutputStream)->Close((OpcUa_Stream*)(*a_ppOutputStream));
+                if(OpcUa_IsEqual(OpcUa_BadWouldBlock))
+                {
+                    uStatus = OpcUa_HttpsConnection_AddStreamToSendQueue(pRequest, *a_ppOutputStream);
+                }
+            }
+
+            /* clean up stream resources */
+            (*a_ppOutputStream)->Delete((OpcUa_Stream**)a_ppOutputStream);
+
+            if(OpcUa_IsBad(uStatus))
+            {
+                /* the request may be partially written; the following requests and responses would be out of sync */
+                OpcUa_Trace(OPCUA_TRACE_LEVEL_ERROR, "OpcUa_HttpsConnection_EndSendRequest: pipelined send failed; closing connection %p!\n", pHttpConnection);
+
+                OPCUA_P_SOCKET_CLOSE(pRequest->Socket);
+                pRequest->Socket            = OpcUa_Null;
+                pRequest->ConnectionState   = OpcUa_HttpsConnectionState_Disconnected;
+
+                if(pRequest->IncomingStream != OpcUa_Null)
+                {
+                    pRequest->IncomingStream->Close((OpcUa_Stream*)pRequest->IncomingStream);
+                    pRequest->IncomingStream->Delete((OpcUa_Stream**)&pRequest->IncomingStream);
+                    pRequest->IncomingStream = OpcUa_Null;
+                }
+
+                while(pRequest->pSendQueue != OpcUa_Null)
+                {
+                    OpcUa_BufferList* pCurrentBuffer = pRequest->pSendQueue;
+                    pRequest->pSendQueue = pCurrentBuffer->pNext;
+                    OpcUa_Buffer_Clear(&pCurrentBuffer->Buffer);
+                    OpcUa_Free(pCurrentBuffer);
+                }
+
+                OpcUa_HttpsConnection_CancelRequests(pRequest, OpcUa_BadConnectionClosed);
+
+                OpcUa_GotoError;
+            }
+
+            pEntry = &pRequest->pPipeline[(pRequest->uPipelineHead + pRequest->uPipelineCount) % pRequest->uPipelineSize];
+            pEntry->RequestTimeout      = a_uTimeout;
+            pEntry->RequestStartTime    = OpcUa_GetTickCount();
+            pEntry->RequestCallback     = a_pfnCallback;
+            pEntry->RequestCallbackData = a_pCallbackData;
+            pRequest->uPipelineCount++;
+
+            break;
+        }
     case OpcUa_HttpsConnectionState_Connecting:
         {
             OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsConnection_EndSendRequest: create new connection for request %p.\n", pRequest);
@@ -2189,6 +2460,13 @@ OpcUa_Void OpcUa_HttpsConnection_Delete(OpcUa_Connection** a_ppConnection)
         pRequest->RequestCallback        = OpcUa_Null;
         pRequest->RequestCallbackData    = OpcUa_Null;
 
+        if(pRequest->pPipeline != OpcUa_Null)
+        {
+            OpcUa_Free(pRequest->pPipeline);
+            pRequest->pPipeline      = OpcUa_Null;
+            pRequest->uPipelineCount = 0;
+        }
+
         if(pRequest->ConnectionState == OpcUa_HttpsConnectionState_RequestPrepared)
         {
             pRequest->OutgoingStream->Delete((OpcUa_Stream**)&pRequest->OutgoingStream);
@@ -2244,6 +2522,11 @@ OpcUa_StatusCode OpcUa_HttpsConnection_Create(OpcUa_Connection** a_ppConnection)
     OpcUa_HttpsConnection*          pHttpConnection = OpcUa_Null;
     OpcUa_HttpsConnection_Request*  pRequest        = OpcUa_Null;
     OpcUa_UInt32                    uIndex          = 0;
+#if OPCUA_HTTPSCONNECTION_PIPELINE_REQUESTS
+    OpcUa_Int32                     iPipelineDepth  = OpcUa_ProxyStub_g_Configuration.iHttpsTransport_MaxPipelinedRequests;
+#else /* OPCUA_HTTPSCONNECTION_PIPELINE_REQUESTS */
+    OpcUa_Int32                     iPipelineDepth  = 1;
+#endif /* OPCUA_HTTPSCONNECTION_PIPELINE_REQUESTS */
 
 OpcUa_InitializeStatus(OpcUa_Module_HttpConnection, "Create");
 
@@ -2287,6 +2570,14 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpConnection, "Create");
         uStatus = OPCUA_P_MUTEX_CREATE(&pRequest->Mutex);
         OpcUa_GotoErrorIfBad(uStatus);
 #endif /* OPCUA_HTTPSCONNECTION_SYNCHRONIZE_REQUESTS */
+
+        /* the pending request itself is not part of the pipeline ring */
+        if(iPipelineDepth > 1)
+        {
+            pRequest->uPipelineSize = (OpcUa_UInt32)(iPipelineDepth - 1);
+            pRequest->pPipeline     = (OpcUa_HttpsConnection_PipelinedRequest*)OpcUa_Alloc(pRequest->uPipelineSize * sizeof(OpcUa_HttpsConnection_PipelinedRequest));
+            OpcUa_GotoErrorIfAllocFailed(pRequest->pPipeline);
+        }
     }
 
 #if OPCUA_MULTITHREADED
@@ -2337,6 +2628,11 @@ OpcUa_BeginErrorHandling;
                 OPCUA_P_MUTEX_DELETE(&pRequest->Mutex);
             }
 #endif /* OPCUA_HTTPSCONNECTION_SYNCHRONIZE_REQUESTS */
+
+            if(pRequest->pPipeline != OpcUa_Null)
+            {
+                OpcUa_Free(pRequest->pPipeline);
+            }
         }
 
         if(pHttpConnection->Mutex != OpcUa_Null)
@@ -92,6 +92,15 @@ OpcUa_StatusCode OpcUa_HttpsListener_ReadEventHandler(
     OpcUa_Listener* a_pListener,
     OpcUa_Socket    a_hSocket);
 
+static OpcUa_StatusCode OpcUa_HttpsListener_ProcessInput(
+    OpcUa_Listener*                  a_pListener,
+    OpcUa_HttpsListener_Connection*  a_pListenerConnection);
+
+static OpcUa_StatusCode OpcUa_HttpsListener_HoldResponse(
+    OpcUa_HttpsListener_Connection* a_pListenerConnection,
+    OpcUa_UInt32                    a_uSequenceNumber,
+    OpcUa_OutputStream*             a_pOutputStream);
+
 /*============================================================================
  * OpcUa_HttpsListener_SanityCheck
  *===========================================================================*/
@@ -225,6 +234,8 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "Create");
     (*a_ppListener)->Delete                         = OpcUa_HttpsListener_Delete;
     (*a_ppListener)->AddToSendQueue                 = OpcUa_Null;
     (*a_ppListener)->CheckProtocolVersion           = OpcUa_Null;
+    (*a_ppListener)->AddConnectionReference         = OpcUa_Null;
+    (*a_ppListener)->ReleaseConnectionReference     = OpcUa_Null;
 
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
@@ -247,9 +258,7 @@ OPCUA_EXPORT OpcUa_StatusCode OpcUa_HttpsListener_GetSecurityPolicyConfiguration
     OpcUa_OutputStream*                               a_pOstrm,
     OpcUa_SecureListener_SecurityPolicyConfiguration* a_pSecurityPolicyConfiguration)
 {
-    OpcUa_HttpsListener*            pHttpsListener      = OpcUa_Null;
-    OpcUa_Socket                    pSocket             = OpcUa_Null;
-    OpcUa_HttpsListener_Connection* pHttpsConnection    = OpcUa_Null;
+    OpcUa_String*                   pSecurityPolicy     = OpcUa_Null;
 
 OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "GetSecurityPolicyConfiguration");
 
@@ -258,19 +267,12 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "GetSecurityPolicyConfiguratio
     OpcUa_ReturnErrorIfArgumentNull(a_pOstrm);
     OpcUa_ReturnErrorIfArgumentNull(a_pSecurityPolicyConfiguration);
 
-    pHttpsListener  = (OpcUa_HttpsListener*)a_pListener->Handle;
-
-    /* get connection object */
-    OpcUa_HttpsStream_GetSocket((OpcUa_Stream*)a_pOstrm,
-                                &pSocket);
-
-    OpcUa_HttpsListener_ConnectionManager_GetConnectionBySocket(    pHttpsListener->pConnectionManager,
-                                                                    pSocket,
-                                                                    &pHttpsConnection);
-    OpcUa_GotoErrorIfNull(pHttpsConnection, OpcUa_BadInvalidArgument);
+    /* pipelined requests may ask for different policies; the response stream keeps the one of its request */
+    uStatus = OpcUa_HttpsStream_GetSecurityPolicy(a_pOstrm, &pSecurityPolicy);
+    OpcUa_GotoErrorIfBad(uStatus);
 
     /* header is optional, check if it was set and default to policy none if not */
-    if(OpcUa_String_IsNull(&pHttpsConnection->sSecurityPolicy))
+    if(OpcUa_String_IsNull(pSecurityPolicy))
     {
         uStatus = OpcUa_String_AttachToString(  OpcUa_SecurityPolicy_None,
                                                 OPCUA_STRING_LENDONTCARE,
@@ -282,8 +284,9 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "GetSecurityPolicyConfiguratio
     }
     else
     {
-        uStatus = OpcUa_String_AttachToString(  OpcUa_String_GetRawString(&pHttpsConnection->sSecurityPolicy),
-                                                OpcUa_String_StrLen(&pHttpsConnection->sSecurityPolicy),
+        /* valid as long as the response stream */
+        uStatus = OpcUa_String_AttachToString(  OpcUa_String_GetRawString(pSecurityPolicy),
+                                                OpcUa_String_StrLen(pSecurityPolicy),
                                                 0,
                                                 OpcUa_False,
                                                 OpcUa_False,
@@ -294,18 +297,8 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "GetSecurityPolicyConfiguratio
     a_pSecurityPolicyConfiguration->uMessageSecurityModes = OPCUA_SECURECHANNEL_MESSAGESECURITYMODE_SIGNANDENCRYPT;
     a_pSecurityPolicyConfiguration->pbsClientCertificate  = OpcUa_Null;
 
-    OpcUa_HttpsListener_ConnectionManager_ReleaseConnection(    pHttpsListener->pConnectionManager,
-                                                                &pHttpsConnection);
-
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
-
-    if(pHttpsConnection != OpcUa_Null)
-    {
-        OpcUa_HttpsListener_ConnectionManager_ReleaseConnection(    pHttpsListener->pConnectionManager,
-                                                                    &pHttpsConnection);
-    }
-
 OpcUa_FinishErrorHandling;
 }
 
@@ -366,6 +359,9 @@ OpcUa_StatusCode OpcUa_HttpsListener_BeginSendResponse(
 {
     OpcUa_HttpsListener_Connection* pListenerConnection = OpcUa_Null;
     OpcUa_HttpsStream_Method        eMethod             = OpcUa_HttpsStream_Method_Invalid;
+    OpcUa_UInt32                    uSequenceNumber     = 0;
+    OpcUa_String                    HeaderValue         = OPCUA_STRING_STATICINITIALIZER;
+    OpcUa_Boolean                   bKeepAlive          = OpcUa_False;
 
 OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "BeginSendResponse");
 
@@ -415,22 +411,57 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "BeginSendResponse");
     }
     OpcUa_GotoErrorIfBad(uStatus);
 
+    /* the response takes the place of its request in the pipeline */
+    OpcUa_HttpsStream_GetSequenceNumber((OpcUa_Stream*)(*a_ppInputStream), &uSequenceNumber);
+    OpcUa_HttpsStream_SetSequenceNumber((OpcUa_Stream*)(*a_ppOutputStream), uSequenceNumber);
+
+    /* the request headers apply to this response only; pipelined requests may differ */
+    if(OpcUa_IsGood(OpcUa_HttpsStream_GetHeader(   (OpcUa_Stream*)(*a_ppInputStream),
+                                                    OpcUa_String_FromCString(OPCUA_HTTPS_SECURITYPOLICYHEADER),
+                                                    OpcUa_False,
+                                                    &HeaderValue)))
+    {
+        uStatus = OpcUa_HttpsStream_SetSecurityPolicy(*a_ppOutputStream, &HeaderValue);
+        OpcUa_String_Clear(&HeaderValue);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+    if(OpcUa_IsGood(OpcUa_HttpsStream_GetHeader(   (OpcUa_Stream*)(*a_ppInputStream),
+                                                    OpcUa_String_FromCString("Connection"),
+                                                    OpcUa_False,
+                                                    &HeaderValue)))
+    {
+        if(!OpcUa_String_StrnCmp(&HeaderValue, OpcUa_String_FromCString("keep-alive"), OPCUA_STRING_LENDONTCARE, OpcUa_True))
+        {
+            bKeepAlive = OpcUa_True;
+        }
+        OpcUa_String_Clear(&HeaderValue);
+    }
+
     /* close and delete the incoming stream - double close is ignored (uncritical) */
     OpcUa_Stream_Close((OpcUa_Stream*)(*a_ppInputStream));
     OpcUa_Stream_Delete((OpcUa_Stream**)a_ppInputStream);
 
 #if !OPCUA_HTTPSLISTENER_CLOSE_SOCKET_AFTER_RESPONSE
     /* set keep-alive header if requested */
-    if(pListenerConnection->bKeepAlive != OpcUa_False)
+    if(bKeepAlive != OpcUa_False)
     {
         OpcUa_HttpsStream_SetHeader(  (OpcUa_Stream*)(*a_ppOutputStream),
                                       OpcUa_String_FromCString("Connection"),
                                       OpcUa_String_FromCString("keep-alive"));
     }
+#else
+    OpcUa_ReferenceParameter(bKeepAlive);
 #endif
 
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
+
+    if(*a_ppOutputStream != OpcUa_Null)
+    {
+        OpcUa_Stream_Delete((OpcUa_Stream**)a_ppOutputStream);
+    }
+
 OpcUa_FinishErrorHandling;
 }
 
@@ -448,6 +479,7 @@ OpcUa_StatusCode OpcUa_HttpsListener_SendImmediateResponse(
 {
     OpcUa_HttpsListener_Connection*  pListenerConnection    = OpcUa_Null;
     OpcUa_OutputStream*              pOutputStream          = OpcUa_Null;
+    OpcUa_UInt32                     uSequenceNumber        = 0;
 
 OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "SendImmediateResponse");
 
@@ -463,6 +495,11 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "SendImmediateResponse");
     OpcUa_ReturnErrorIfTrue(pListenerConnection->bConnected == OpcUa_False,
                             OpcUa_BadInvalidState);
 
+    OPCUA_P_MUTEX_LOCK(pListenerConnection->Mutex);
+
+    /* the response answers the newest request and takes its place in the pipeline */
+    uSequenceNumber = pListenerConnection->uRequestSequence++;
+
     OpcUa_Trace(OPCUA_TRACE_LEVEL_SYSTEM,
                 "OpcUa_HttpsListener_SendImmediateResponse: to %s (socket %p) with StatusCode %d!\n",
                 pListenerConnection->achPeerInfo,
@@ -485,6 +522,19 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "SendImmediateResponse");
         OpcUa_GotoErrorIfBad(uStatus);
     }
 
+    if(uSequenceNumber != pListenerConnection->uResponseSequence)
+    {
+        /* earlier requests are still being processed; the connection is closed after their responses */
+        uStatus = OpcUa_HttpsListener_HoldResponse(pListenerConnection, uSequenceNumber, pOutputStream);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        pListenerConnection->bCloseWhenAnswered = OpcUa_True;
+        OPCUA_P_MUTEX_UNLOCK(pListenerConnection->Mutex);
+
+        pOutputStream->Delete((OpcUa_Stream**)&pOutputStream);
+        OpcUa_ReturnStatusCode;
+    }
+
     /* send stream if possible or queue for delayed sending */
     if(pListenerConnection->pSendQueue == OpcUa_Null)
     {
@@ -492,7 +542,12 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "SendImmediateResponse");
     }
     else
     {
-        uStatus = OpcUa_BadWouldBlock;
+        /* queued data has to leave first; complete the message without sending */
+        uStatus = OpcUa_HttpsStream_Finish(pOutputStream);
+        if(OpcUa_IsGood(uStatus))
+        {
+            uStatus = OpcUa_BadWouldBlock;
+        }
     }
 
     if(OpcUa_IsEqual(OpcUa_BadWouldBlock))
@@ -503,16 +558,53 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "SendImmediateResponse");
 
     OpcUa_GotoErrorIfBad(uStatus);
 
+    pListenerConnection->uResponseSequence++;
+    OPCUA_P_MUTEX_UNLOCK(pListenerConnection->Mutex);
+
     pOutputStream->Delete((OpcUa_Stream**)&pOutputStream);
 
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
 
+    OPCUA_P_MUTEX_UNLOCK(pListenerConnection->Mutex);
+
     OpcUa_Stream_Delete((OpcUa_Stream**)&pOutputStream);
 
 OpcUa_FinishErrorHandling;
 }
 
+/*============================================================================
+ * OpcUa_HttpsListener_CloseAfterResponse
+ *===========================================================================*/
+/**
+ * @brief Closes the connection after an immediate response to a rejected request.
+ *
+ * A response held behind earlier responses closes the connection when it
+ * leaves; until then only the reference of the caller is released.
+ */
+static OpcUa_Void OpcUa_HttpsListener_CloseAfterResponse(
+    OpcUa_Listener*                  a_pListener,
+    OpcUa_HttpsListener_Connection** a_ppListenerConnection)
+{
+    OpcUa_HttpsListener*    pHttpsListener  = (OpcUa_HttpsListener*)a_pListener->Handle;
+    OpcUa_Boolean           bHeld           = OpcUa_False;
+
+    OPCUA_P_MUTEX_LOCK((*a_ppListenerConnection)->Mutex);
+    bHeld = (OpcUa_Boolean)(    (*a_ppListenerConnection)->bCloseWhenAnswered != OpcUa_False
+                            &&  (*a_ppListenerConnection)->uResponseSequence  != (*a_ppListenerConnection)->uRequestSequence);
+    OPCUA_P_MUTEX_UNLOCK((*a_ppListenerConnection)->Mutex);
+
+    if(bHeld != OpcUa_False)
+    {
+        OpcUa_HttpsListener_ConnectionManager_ReleaseConnection(pHttpsListener->pConnectionManager,
+                                                                a_ppListenerConnection);
+    }
+    else
+    {
+        OpcUa_HttpsListener_ProcessDisconnect(a_pListener, a_ppListenerConnection);
+    }
+}
+
 /*============================================================================
  * OpcUa_HttpsListener_AddToSendQueue
  *===========================================================================*/
@@ -550,6 +642,71 @@ OpcUa_BeginErrorHandling;
 OpcUa_FinishErrorHandling;
 }
 
+/*============================================================================
+ * OpcUa_HttpsListener_FreeBufferList
+ *===========================================================================*/
+static OpcUa_Void OpcUa_HttpsListener_FreeBufferList(OpcUa_BufferList** a_ppBufferList)
+{
+    while(*a_ppBufferList != OpcUa_Null)
+    {
+        OpcUa_BufferList* pCurrentBuffer = *a_ppBufferList;
+
+        *a_ppBufferList = pCurrentBuffer->pNext;
+
+        OpcUa_Buffer_Clear(&pCurrentBuffer->Buffer);
+        OpcUa_Free(pCurrentBuffer);
+    }
+}
+
+/*============================================================================
+ * OpcUa_HttpsListener_DetachStreamBuffers
+ *===========================================================================*/
+/** @brief Moves all unsent buffers of a stream into a new buffer list. */
+static OpcUa_StatusCode OpcUa_HttpsListener_DetachStreamBuffers(
+    OpcUa_OutputStream*             a_pOutputStream,
+    OpcUa_BufferList**              a_ppBufferList)
+{
+    OpcUa_BufferList*   pEntry      = OpcUa_Null;
+    OpcUa_BufferList**  ppLastNext  = a_ppBufferList;
+
+OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "DetachStreamBuffers");
+
+    *a_ppBufferList = OpcUa_Null;
+
+    for(;;)
+    {
+        pEntry = (OpcUa_BufferList*)OpcUa_Alloc(sizeof(OpcUa_BufferList));
+        OpcUa_GotoErrorIfAllocFailed(pEntry);
+
+        pEntry->pNext = OpcUa_Null;
+        uStatus = a_pOutputStream->DetachBuffer((OpcUa_Stream*)a_pOutputStream, &pEntry->Buffer);
+
+        if(OpcUa_IsBad(uStatus))
+        {
+            OpcUa_Free(pEntry);
+
+            if(OpcUa_IsEqual(OpcUa_BadNoData))
+            {
+                /* mask error - everything went fine, all buffers detached */
+                uStatus = OpcUa_Good;
+                break;
+            }
+
+            OpcUa_GotoError;
+        }
+
+        *ppLastNext = pEntry;
+        ppLastNext  = &pEntry->pNext;
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_HttpsListener_FreeBufferList(a_ppBufferList);
+
+OpcUa_FinishErrorHandling;
+}
+
 /*============================================================================
  * OpcUa_HttpsListener_AddStreamToSendQueue
  *===========================================================================*/
@@ -558,63 +715,190 @@ OpcUa_StatusCode OpcUa_HttpsListener_AddStreamToSendQueue(
     OpcUa_HttpsListener_Connection* a_pListenerConnection,
     OpcUa_OutputStream*             a_pOutputStream)
 {
-    OpcUa_BufferList*        pEntry = OpcUa_Null;
+    OpcUa_BufferList*        pBufferList = OpcUa_Null;
 
 OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "OpcUa_HttpsListener_AddStreamToSendQueue");
 
-    pEntry = OpcUa_Alloc(sizeof(OpcUa_BufferList));
-    OpcUa_GotoErrorIfAllocFailed(pEntry);
+    uStatus = OpcUa_HttpsListener_DetachStreamBuffers(a_pOutputStream, &pBufferList);
+    OpcUa_GotoErrorIfBad(uStatus);
 
-    do
+    if(pBufferList != OpcUa_Null)
     {
-        if(pEntry != OpcUa_Null)
-        {
-            pEntry->pNext = OpcUa_Null;
-            uStatus = a_pOutputStream->DetachBuffer((OpcUa_Stream*)a_pOutputStream, &pEntry->Buffer);
+        uStatus = OpcUa_HttpsListener_AddToSendQueue(   a_pListener,
+                                                        a_pListenerConnection,
+                                                        pBufferList);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
 
-            if(OpcUa_IsGood(uStatus))
-            {
-                uStatus = OpcUa_HttpsListener_AddToSendQueue(   a_pListener,
-                                                                a_pListenerConnection,
-                                                                pEntry);
-                if(OpcUa_IsBad(uStatus))
-                {
-                    /* free Entry */
-                    OpcUa_Buffer_Clear(&pEntry->Buffer);
-                    OpcUa_Free(pEntry);
-                    break;
-                }
-                else
-                {
-                    /* continue with next entry */
-                    pEntry = OpcUa_Alloc(sizeof(OpcUa_BufferList));
-                }
-            }
-            else
-            {
-                /* free entry */
-                OpcUa_Free(pEntry);
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
 
-                if(OpcUa_IsEqual(OpcUa_BadNoData))
-                {
-                    /* mask error - everything went fine, all buffers detached */
-                    uStatus = OpcUa_Good;
-                }
-                break;
-            }
+    OpcUa_HttpsListener_FreeBufferList(&pBufferList);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * OpcUa_HttpsListener_WriteSendQueue
+ *===========================================================================*/
+/**
+ * @brief Writes queued data until the queue is empty or the socket would block.
+ *
+ * Must be called with the connection mutex held. Returns OpcUa_GoodCallAgain
+ * if data is left in the queue for the next write event.
+ */
+static OpcUa_StatusCode OpcUa_HttpsListener_WriteSendQueue(
+    OpcUa_HttpsListener_Connection* a_pListenerConnection)
+{
+OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "WriteSendQueue");
+
+    while(a_pListenerConnection->pSendQueue != OpcUa_Null)
+    {
+        OpcUa_BufferList*        pCurrentBuffer = a_pListenerConnection->pSendQueue;
+        OpcUa_Int32              iDataLength    = pCurrentBuffer->Buffer.EndOfData - pCurrentBuffer->Buffer.Position;
+        OpcUa_Int32              iDataWritten   = OPCUA_P_SOCKET_WRITE(
+                                                        a_pListenerConnection->Socket,
+                                                        &pCurrentBuffer->Buffer.Data[pCurrentBuffer->Buffer.Position],
+                                                        iDataLength,
+                                                        OpcUa_False);
+
+        if(iDataWritten < 0)
+        {
+            OpcUa_GotoErrorWithStatus(OpcUa_BadCommunicationError);
+        }
+        else if(iDataWritten == 0)
+        {
+            OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsListener_WriteSendQueue: no data sent\n");
+            uStatus = OpcUa_GoodCallAgain;
+            break;
+        }
+        else if(iDataWritten < iDataLength)
+        {
+            pCurrentBuffer->Buffer.Position += iDataWritten;
+
+            OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsListener_WriteSendQueue: data partially sent (%i bytes)!\n", iDataWritten);
+            uStatus = OpcUa_GoodCallAgain;
+            break;
         }
         else
         {
-            uStatus = OpcUa_BadOutOfMemory;
+            OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsListener_WriteSendQueue: data sent!\n");
+            a_pListenerConnection->pSendQueue = pCurrentBuffer->pNext;
+            OpcUa_Buffer_Clear(&pCurrentBuffer->Buffer);
+            OpcUa_Free(pCurrentBuffer);
         }
+    } /* end while */
 
-    } while(OpcUa_IsGood(uStatus));
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * OpcUa_HttpsListener_PipelineFull
+ *===========================================================================*/
+/** @brief True, if the configured number of requests is in flight on the connection. */
+static OpcUa_Boolean OpcUa_HttpsListener_PipelineFull(
+    OpcUa_HttpsListener_Connection* a_pListenerConnection)
+{
+    OpcUa_Int32 iMaxPipelinedRequests = OpcUa_ProxyStub_g_Configuration.iHttpsTransport_MaxPipelinedRequests;
+
+    if(iMaxPipelinedRequests < 1)
+    {
+        iMaxPipelinedRequests = 1;
+    }
+
+    return ((a_pListenerConnection->uRequestSequence - a_pListenerConnection->uResponseSequence) >= (OpcUa_UInt32)iMaxPipelinedRequests)?OpcUa_True:OpcUa_False;
+}
+
+/*============================================================================
+ * OpcUa_HttpsListener_HoldResponse
+ *===========================================================================*/
+/**
+ * @brief Keeps a response finished ahead of an earlier request until its turn.
+ *
+ * Must be called with the connection mutex held.
+ */
+static OpcUa_StatusCode OpcUa_HttpsListener_HoldResponse(
+    OpcUa_HttpsListener_Connection* a_pListenerConnection,
+    OpcUa_UInt32                    a_uSequenceNumber,
+    OpcUa_OutputStream*             a_pOutputStream)
+{
+    OpcUa_HttpsListener_HeldResponse*   pHeldResponse   = OpcUa_Null;
+    OpcUa_HttpsListener_HeldResponse**  ppInsertAt      = &a_pListenerConnection->pHeldResponses;
+
+OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "HoldResponse");
+
+    pHeldResponse = (OpcUa_HttpsListener_HeldResponse*)OpcUa_Alloc(sizeof(OpcUa_HttpsListener_HeldResponse));
+    OpcUa_GotoErrorIfAllocFailed(pHeldResponse);
+
+    pHeldResponse->uSequenceNumber  = a_uSequenceNumber;
+    pHeldResponse->pBuffers         = OpcUa_Null;
+
+    uStatus = OpcUa_HttpsStream_Finish(a_pOutputStream);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = OpcUa_HttpsListener_DetachStreamBuffers(a_pOutputStream, &pHeldResponse->pBuffers);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsListener_HoldResponse: response %u waits for response %u.\n", a_uSequenceNumber, a_pListenerConnection->uResponseSequence);
+
+    /* keep the list sorted by sequence number */
+    while(      *ppInsertAt != OpcUa_Null
+            &&  (OpcUa_Int32)((*ppInsertAt)->uSequenceNumber - a_uSequenceNumber) < 0)
+    {
+        ppInsertAt = &(*ppInsertAt)->pNext;
+    }
+
+    pHeldResponse->pNext = *ppInsertAt;
+    *ppInsertAt = pHeldResponse;
 
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
+
+    if(pHeldResponse != OpcUa_Null)
+    {
+        OpcUa_Free(pHeldResponse);
+    }
+
 OpcUa_FinishErrorHandling;
 }
 
+/*============================================================================
+ * OpcUa_HttpsListener_ReleaseHeldResponses
+ *===========================================================================*/
+/**
+ * @brief Moves held responses whose turn has come into the send queue.
+ *
+ * Must be called with the connection mutex held. Returns OpcUa_True if any
+ * response was queued.
+ */
+static OpcUa_Boolean OpcUa_HttpsListener_ReleaseHeldResponses(
+    OpcUa_Listener*                 a_pListener,
+    OpcUa_HttpsListener_Connection* a_pListenerConnection)
+{
+    OpcUa_Boolean bQueued = OpcUa_False;
+
+    while(      a_pListenerConnection->pHeldResponses != OpcUa_Null
+            &&  a_pListenerConnection->pHeldResponses->uSequenceNumber == a_pListenerConnection->uResponseSequence)
+    {
+        OpcUa_HttpsListener_HeldResponse* pHeldResponse = a_pListenerConnection->pHeldResponses;
+
+        a_pListenerConnection->pHeldResponses = pHeldResponse->pNext;
+
+        if(pHeldResponse->pBuffers != OpcUa_Null)
+        {
+            OpcUa_HttpsListener_AddToSendQueue(a_pListener, a_pListenerConnection, pHeldResponse->pBuffers);
+            bQueued = OpcUa_True;
+        }
+
+        OpcUa_Free(pHeldResponse);
+        a_pListenerConnection->uResponseSequence++;
+    }
+
+    return bQueued;
+}
+
 /*============================================================================
  * OpcUa_HttpsListener_EndSendResponse
  *===========================================================================*/
@@ -626,6 +910,9 @@ OpcUa_StatusCode OpcUa_HttpsListener_EndSendResponse(
 {
     OpcUa_HttpsListener*             pHttpsListener         = OpcUa_Null;
     OpcUa_HttpsListener_Connection*  pListenerConnection    = OpcUa_Null;
+    OpcUa_UInt32                     uSequenceNumber        = 0;
+    OpcUa_Boolean                    bResumeInput           = OpcUa_False;
+    OpcUa_Boolean                    bAnswered              = OpcUa_False;
 
 OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "OpcUa_HttpsListener_EndSendResponse");
 
@@ -638,6 +925,7 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "OpcUa_HttpsListener_EndSendRe
     pHttpsListener = (OpcUa_HttpsListener*)a_pListener->Handle;
 
     OpcUa_HttpsStream_GetConnection(*a_ppOutputStream, (OpcUa_Handle*)&pListenerConnection);
+    OpcUa_HttpsStream_GetSequenceNumber((OpcUa_Stream*)*a_ppOutputStream, &uSequenceNumber);
 
     OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsListener_EndSendResponse: Status 0x%08X\n", a_uStatus);
 
@@ -645,14 +933,20 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "OpcUa_HttpsListener_EndSendRe
     OPCUA_P_MUTEX_LOCK(pListenerConnection->Mutex);
     if(OpcUa_IsBad(a_uStatus))
     {
-        /* create and send response */
-        OpcUa_HttpsListener_SendImmediateResponse(  a_pListener,
-                                                    pListenerConnection,
-                                                    OPCUA_HTTP_STATUS_INTERNAL_SERVER_ERROR,
-                                                    OPCUA_HTTP_STATUS_INTERNAL_SERVER_ERROR_TEXT,
-                                                    "Server: OPC-ANSI-C-HTTPS-API/0.1\r\n",
-                                                    OpcUa_Null,
-                                                    0);
+        if(uSequenceNumber == pListenerConnection->uResponseSequence)
+        {
+            /* the connection gets closed, so later pipelined requests stay unanswered */
+            pListenerConnection->uRequestSequence = pListenerConnection->uResponseSequence;
+
+            /* create and send response */
+            OpcUa_HttpsListener_SendImmediateResponse(  a_pListener,
+                                                        pListenerConnection,
+                                                        OPCUA_HTTP_STATUS_INTERNAL_SERVER_ERROR,
+                                                        OPCUA_HTTP_STATUS_INTERNAL_SERVER_ERROR_TEXT,
+                                                        "Server: OPC-ANSI-C-HTTPS-API/0.1\r\n",
+                                                        OpcUa_Null,
+                                                        0);
+        }
         OPCUA_P_MUTEX_UNLOCK(pListenerConnection->Mutex);
 
         OpcUa_HttpsListener_ProcessDisconnect(a_pListener, &pListenerConnection);
@@ -662,23 +956,84 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "OpcUa_HttpsListener_EndSendRe
     }
     else if(pListenerConnection->bConnected == OpcUa_True)
     {
-        uStatus = (*a_ppOutputStream)->Close((OpcUa_Stream*)*a_ppOutputStream);
+        if(uSequenceNumber == pListenerConnection->uResponseSequence)
+        {
+            if(pListenerConnection->pSendQueue == OpcUa_Null)
+            {
+                uStatus = (*a_ppOutputStream)->Close((OpcUa_Stream*)*a_ppOutputStream);
+            }
+            else
+            {
+                /* queued data has to leave first; complete the message without sending */
+                uStatus = OpcUa_HttpsStream_Finish(*a_ppOutputStream);
+                if(OpcUa_IsGood(uStatus))
+                {
+                    uStatus = OpcUa_BadWouldBlock;
+                }
+            }
 
-        if(OpcUa_IsEqual(OpcUa_BadWouldBlock))
+            if(OpcUa_IsEqual(OpcUa_BadWouldBlock))
+            {
+                /* try to put stream content into buffer queue for delayed sending */
+                uStatus = OpcUa_HttpsListener_AddStreamToSendQueue(a_pListener, pListenerConnection, *a_ppOutputStream);
+            }
+
+            pListenerConnection->uResponseSequence++;
+
+            /* responses to later requests may have been finished before */
+            if(     OpcUa_IsGood(uStatus)
+                &&  OpcUa_HttpsListener_ReleaseHeldResponses(a_pListener, pListenerConnection) != OpcUa_False)
+            {
+                uStatus = OpcUa_HttpsListener_WriteSendQueue(pListenerConnection);
+            }
+        }
+        else
+        {
+            /* an earlier request is still being processed */
+            uStatus = OpcUa_HttpsListener_HoldResponse(pListenerConnection, uSequenceNumber, *a_ppOutputStream);
+        }
+
+        /* a rejected request closes the connection once everything before it is answered */
+        if(     pListenerConnection->bCloseWhenAnswered != OpcUa_False
+            &&  pListenerConnection->uResponseSequence  == pListenerConnection->uRequestSequence)
+        {
+            bAnswered = OpcUa_True;
+        }
+
+        /* continue reading if the pipeline was full */
+        if(     pListenerConnection->bInputPending      != OpcUa_False
+            &&  pListenerConnection->bInputBusy         == OpcUa_False
+            &&  pListenerConnection->bCloseWhenAnswered == OpcUa_False
+            &&  OpcUa_HttpsListener_PipelineFull(pListenerConnection) == OpcUa_False)
         {
-            /* try to put stream content into buffer queue for delayed sending */
-            uStatus = OpcUa_HttpsListener_AddStreamToSendQueue(a_pListener, pListenerConnection, *a_ppOutputStream);
+            bResumeInput = OpcUa_True;
         }
         OPCUA_P_MUTEX_UNLOCK(pListenerConnection->Mutex);
 
         OpcUa_HttpsStream_Delete((OpcUa_Stream**)a_ppOutputStream);
 
+        if(OpcUa_IsBad(uStatus) || bAnswered != OpcUa_False)
+        {
+            /* the response order cannot be kept or the last response has left */
+            OpcUa_HttpsListener_ProcessDisconnect(a_pListener, &pListenerConnection);
+        }
+        else
+        {
 #if OPCUA_HTTPSLISTENER_CLOSE_SOCKET_AFTER_RESPONSE
-        OpcUa_HttpsListener_ProcessDisconnect(a_pListener, &pListenerConnection);
+            OpcUa_HttpsListener_ProcessDisconnect(a_pListener, &pListenerConnection);
 #else
-        OpcUa_HttpsListener_ConnectionManager_ReleaseConnection( pHttpsListener->pConnectionManager,
-                                                                &pListenerConnection);
+            if(bResumeInput != OpcUa_False)
+            {
+                /* takes over the reference of the request */
+                OpcUa_HttpsListener_ProcessInput(a_pListener, pListenerConnection);
+            }
+            else
+            {
+                OpcUa_HttpsListener_ConnectionManager_ReleaseConnection( pHttpsListener->pConnectionManager,
+                                                                        &pListenerConnection);
+            }
 #endif
+        }
     }
     else
     {
@@ -704,6 +1059,9 @@ OpcUa_StatusCode OpcUa_HttpsListener_AbortSendResponse(
 {
     OpcUa_HttpsListener*             pHttpsListener         = OpcUa_Null;
     OpcUa_HttpsListener_Connection*  pListenerConnection    = OpcUa_Null;
+    OpcUa_UInt32                     uSequenceNumber        = 0;
+    OpcUa_Boolean                    bLastInFlight          = OpcUa_False;
+    OpcUa_Boolean                    bResumeInput           = OpcUa_False;
 
 OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "OpcUa_HttpsListener_AbortSendResponse");
 
@@ -716,9 +1074,39 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "OpcUa_HttpsListener_AbortSend
     {
         /* clean up */
         OpcUa_HttpsStream_GetConnection(*a_ppOutputStream, (OpcUa_Handle*)&pListenerConnection);
+        OpcUa_HttpsStream_GetSequenceNumber((OpcUa_Stream*)*a_ppOutputStream, &uSequenceNumber);
         OpcUa_HttpsStream_Delete((OpcUa_Stream**)a_ppOutputStream);
-        OpcUa_HttpsListener_ConnectionManager_ReleaseConnection( pHttpsListener->pConnectionManager,
-                                                                &pListenerConnection);
+
+        OPCUA_P_MUTEX_LOCK(pListenerConnection->Mutex);
+        if(     uSequenceNumber == pListenerConnection->uResponseSequence
+            &&  pListenerConnection->uRequestSequence - pListenerConnection->uResponseSequence == 1)
+        {
+            /* no other request in flight; the slot can be given up silently */
+            pListenerConnection->uResponseSequence++;
+            bLastInFlight = OpcUa_True;
+            if(     pListenerConnection->bInputPending != OpcUa_False
+                &&  pListenerConnection->bInputBusy    == OpcUa_False)
+            {
+                bResumeInput = OpcUa_True;
+            }
+        }
+        OPCUA_P_MUTEX_UNLOCK(pListenerConnection->Mutex);
+
+        if(bLastInFlight == OpcUa_False)
+        {
+            /* later responses would be taken as response to the aborted request */
+            OpcUa_HttpsListener_ProcessDisconnect(a_pListener, &pListenerConnection);
+        }
+        else if(bResumeInput != OpcUa_False)
+        {
+            /* takes over the reference of the request */
+            OpcUa_HttpsListener_ProcessInput(a_pListener, pListenerConnection);
+        }
+        else
+        {
+            OpcUa_HttpsListener_ConnectionManager_ReleaseConnection( pHttpsListener->pConnectionManager,
+                                                                    &pListenerConnection);
+        }
     }
     else
     {
@@ -793,7 +1181,7 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "ProcessRequest");
                 /* delete and close input stream */
                 OpcUa_HttpsStream_Close((OpcUa_Stream*)(*a_ppInputStream));
                 OpcUa_HttpsStream_Delete((OpcUa_Stream**)a_ppInputStream);
-                OpcUa_HttpsListener_ProcessDisconnect(a_pListener, &a_pListenerConnection);
+                OpcUa_HttpsListener_CloseAfterResponse(a_pListener, &a_pListenerConnection);
 
                 break;
             }
@@ -806,30 +1194,10 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "ProcessRequest");
             {
                 a_pListenerConnection->uNoOfRequestsTotal++;
 
-                /* store security policy */
-                OpcUa_HttpsStream_GetHeader(    (OpcUa_Stream*)*a_ppInputStream,
-                                                OpcUa_String_FromCString(OPCUA_HTTPS_SECURITYPOLICYHEADER),
-                                                OpcUa_True,
-                                                &a_pListenerConnection->sSecurityPolicy);
-
-                /* check for "connection" header field */
-                uStatus = OpcUa_HttpsStream_GetHeader(  (OpcUa_Stream*)*a_ppInputStream,
-                                                        OpcUa_String_FromCString("Connection"),
-                                                        OpcUa_False,
-                                                        &HeaderValue);
-                if(OpcUa_IsGood(uStatus))
-                {
-                    if(!OpcUa_String_StrnCmp(&HeaderValue, OpcUa_String_FromCString("keep-alive"), OPCUA_STRING_LENDONTCARE, OpcUa_True))
-                    {
-                        a_pListenerConnection->bKeepAlive = OpcUa_True;
-                    }
-                    else
-                    {
-                        a_pListenerConnection->bKeepAlive = OpcUa_False;
-                    }
-
-                    OpcUa_String_Clear(&HeaderValue);
-                }
+                /* responses have to be sent in request order */
+                OPCUA_P_MUTEX_LOCK(a_pListenerConnection->Mutex);
+                OpcUa_HttpsStream_SetSequenceNumber((OpcUa_Stream*)*a_ppInputStream, a_pListenerConnection->uRequestSequence++);
+                OPCUA_P_MUTEX_UNLOCK(a_pListenerConnection->Mutex);
 
                 uStatus = pHttpsListener->pfListenerCallback(   a_pListener,                                        /* the event source          */
                                                                 (OpcUa_Void*)pHttpsListener->pvListenerCallbackData,/* the callback data         */
@@ -855,7 +1223,7 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "ProcessRequest");
             /* delete and close input stream */
             OpcUa_HttpsStream_Close((OpcUa_Stream*)(*a_ppInputStream));
             OpcUa_HttpsStream_Delete((OpcUa_Stream**)a_ppInputStream);
-            OpcUa_HttpsListener_ProcessDisconnect(a_pListener, &a_pListenerConnection);
+            OpcUa_HttpsListener_CloseAfterResponse(a_pListener, &a_pListenerConnection);
 
             break;
         }
@@ -872,7 +1240,7 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "ProcessRequest");
             /* delete and close input stream */
             OpcUa_HttpsStream_Close((OpcUa_Stream*)(*a_ppInputStream));
             OpcUa_HttpsStream_Delete((OpcUa_Stream**)a_ppInputStream);
-            OpcUa_HttpsListener_ProcessDisconnect(a_pListener, &a_pListenerConnection);
+            OpcUa_HttpsListener_CloseAfterResponse(a_pListener, &a_pListenerConnection);
 
             break;
         }
@@ -884,11 +1252,10 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "ProcessRequest");
             {
                 a_pListenerConnection->uNoOfRequestsTotal++;
 
-                /* store security policy */
-                OpcUa_HttpsStream_GetHeader(    (OpcUa_Stream*)*a_ppInputStream,
-                                                OpcUa_String_FromCString(OPCUA_HTTPS_SECURITYPOLICYHEADER),
-                                                OpcUa_True,
-                                                &a_pListenerConnection->sSecurityPolicy);
+                /* responses have to be sent in request order */
+                OPCUA_P_MUTEX_LOCK(a_pListenerConnection->Mutex);
+                OpcUa_HttpsStream_SetSequenceNumber((OpcUa_Stream*)*a_ppInputStream, a_pListenerConnection->uRequestSequence++);
+                OPCUA_P_MUTEX_UNLOCK(a_pListenerConnection->Mutex);
 
                 uStatus = pHttpsListener->pfListenerCallback(   a_pListener,                                        /* the event source          */
                                                                 (OpcUa_Void*)pHttpsListener->pvListenerCallbackData,/* the callback data         */
@@ -911,7 +1278,7 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "ProcessRequest");
             /* delete and close input stream */
             OpcUa_HttpsStream_Close((OpcUa_Stream*)(*a_ppInputStream));
             OpcUa_HttpsStream_Delete((OpcUa_Stream**)a_ppInputStream);
-            OpcUa_HttpsListener_ProcessDisconnect(a_pListener, &a_pListenerConnection);
+            OpcUa_HttpsListener_CloseAfterResponse(a_pListener, &a_pListenerConnection);
 
 #endif /* OPCUA_HTTPS_ALLOW_GET */
             break;
@@ -930,7 +1297,7 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "ProcessRequest");
             /* delete and close input stream */
             OpcUa_HttpsStream_Close((OpcUa_Stream*)(*a_ppInputStream));
             OpcUa_HttpsStream_Delete((OpcUa_Stream**)a_ppInputStream);
-            OpcUa_HttpsListener_ProcessDisconnect(a_pListener, &a_pListenerConnection);
+            OpcUa_HttpsListener_CloseAfterResponse(a_pListener, &a_pListenerConnection);
 
             break;
         }
@@ -1150,48 +1517,8 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "WriteEventHandler");
     OPCUA_P_MUTEX_LOCK(pListenerConnection->Mutex);
 
     /* look for pending output stream */
-    while(pListenerConnection->pSendQueue != OpcUa_Null)
-    {
-        OpcUa_BufferList*        pCurrentBuffer = pListenerConnection->pSendQueue;
-        OpcUa_Int32              iDataLength    = pCurrentBuffer->Buffer.EndOfData - pCurrentBuffer->Buffer.Position;
-        OpcUa_Int32              iDataWritten   = OPCUA_P_SOCKET_WRITE(
-                                                        a_hSocket,
-                                                        &pCurrentBuffer->Buffer.Data[pCurrentBuffer->Buffer.Position],
-                                                        iDataLength,
-                                                        OpcUa_False);
-
-        if(iDataWritten < 0)
-        {
-            OpcUa_GotoErrorWithStatus(OpcUa_BadCommunicationError);
-        }
-        else if(iDataWritten == 0)
-        {
-            OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsListener_WriteEventHandler: no data sent\n");
-
-            OPCUA_P_MUTEX_UNLOCK(pListenerConnection->Mutex);
-            OpcUa_HttpsListener_ConnectionManager_ReleaseConnection(pHttpsListener->pConnectionManager, &pListenerConnection);
-            uStatus = OpcUa_GoodCallAgain;
-            OpcUa_ReturnStatusCode;
-        }
-        else if(iDataWritten < iDataLength)
-        {
-            pCurrentBuffer->Buffer.Position += iDataWritten;
-
-            OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsListener_WriteEventHandler: data partially sent (%i bytes)!\n", iDataWritten);
-
-            OPCUA_P_MUTEX_UNLOCK(pListenerConnection->Mutex);
-            OpcUa_HttpsListener_ConnectionManager_ReleaseConnection(pHttpsListener->pConnectionManager, &pListenerConnection);
-            uStatus = OpcUa_GoodCallAgain;
-            OpcUa_ReturnStatusCode;
-        }
-        else
-        {
-            OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsListener_WriteEventHandler: data sent!\n");
-            pListenerConnection->pSendQueue = pCurrentBuffer->pNext;
-            OpcUa_Buffer_Clear(&pCurrentBuffer->Buffer);
-            OpcUa_Free(pCurrentBuffer);
-        }
-    } /* end while */
+    uStatus = OpcUa_HttpsListener_WriteSendQueue(pListenerConnection);
+    OpcUa_GotoErrorIfBad(uStatus);
 
     OPCUA_P_MUTEX_UNLOCK(pListenerConnection->Mutex);
 
@@ -1215,95 +1542,121 @@ typedef OpcUa_StatusCode (*OpcUa_HttpsListener_EventHandler)(OpcUa_Listener*  a_
                                                              OpcUa_Socket     a_hSocket);
 
 /*============================================================================
- * OpcUa_HttpsListener_ReadEventHandler
+ * OpcUa_HttpsListener_ProcessInput
  *===========================================================================*/
 /**
- * @brief Gets called if data is available on the socket.
+ * @brief Reads requests from the connection and dispatches them.
+ *
+ * Pipelined requests are dispatched until the configured number of requests
+ * is in flight. Then reading stops, so TCP flow control throttles the client,
+ * and EndSendResponse resumes it. Takes over the reference of the caller.
  */
-OpcUa_StatusCode OpcUa_HttpsListener_ReadEventHandler(
-    OpcUa_Listener* a_pListener,
-    OpcUa_Socket    a_hSocket)
+static OpcUa_StatusCode OpcUa_HttpsListener_ProcessInput(
+    OpcUa_Listener*                  a_pListener,
+    OpcUa_HttpsListener_Connection*  a_pListenerConnection)
 {
     OpcUa_InputStream*                pInputStream           = OpcUa_Null;
-    OpcUa_HttpsListener*              pHttpsListener         = OpcUa_Null;
-    OpcUa_HttpsListener_Connection*   pListenerConnection    = OpcUa_Null;
-
-OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "ReadEventHandler");
+    OpcUa_InputStream*                pNextInputStream       = OpcUa_Null;
+    OpcUa_HttpsListener*              pHttpsListener         = (OpcUa_HttpsListener*)a_pListener->Handle;
+    OpcUa_HttpsListener_Connection*   pListenerConnection    = a_pListenerConnection;
+    OpcUa_HttpsListener_Connection*   pRequestConnection     = OpcUa_Null;
 
-    OpcUa_ReturnErrorIfArgumentNull(a_pListener);
-    OpcUa_ReturnErrorIfArgumentNull(a_hSocket);
-    OpcUa_ReturnErrorIfArgumentNull(a_pListener->Handle)
-
-    pHttpsListener = (OpcUa_HttpsListener *)a_pListener->Handle;
-
-    /******************************************************************************************************/
+OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "ProcessInput");
 
-    /* look if an active connection is available for the socket. */
-    uStatus = OpcUa_HttpsListener_ConnectionManager_GetConnectionBySocket(  pHttpsListener->pConnectionManager,
-                                                                            a_hSocket,
-                                                                            &pListenerConnection);
-    if(OpcUa_IsBad(uStatus))
+    OPCUA_P_MUTEX_LOCK(pListenerConnection->Mutex);
+    if(pListenerConnection->bInputBusy != OpcUa_False)
     {
-        OPCUA_P_SOCKET_CLOSE(a_hSocket);
+        /* the thread reading from the connection picks up the new data */
+        pListenerConnection->bInputPending = OpcUa_True;
+        OPCUA_P_MUTEX_UNLOCK(pListenerConnection->Mutex);
+        OpcUa_HttpsListener_ConnectionManager_ReleaseConnection(pHttpsListener->pConnectionManager,
+                                                                &pListenerConnection);
         OpcUa_ReturnStatusCode;
     }
+    pListenerConnection->bInputBusy = OpcUa_True;
 
-    /* get last access timestamp */
-    pListenerConnection->uLastReceiveTime =  OpcUa_GetTickCount();
+    for(;;)
+    {
+        if(     pListenerConnection->bConnected         == OpcUa_False
+            ||  pListenerConnection->bCloseWhenAnswered != OpcUa_False)
+        {
+            /* nothing after a rejected request is read */
+            break;
+        }
 
-    /******************************************************************************************************/
+        if(OpcUa_HttpsListener_PipelineFull(pListenerConnection) != OpcUa_False)
+        {
+            /* stop reading until a response leaves */
+            OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG,
+                        "OpcUa_HttpsListener_ProcessInput: "
+                        "%u requests in flight on socket %p; reading deferred!\n",
+                        pListenerConnection->uRequestSequence - pListenerConnection->uResponseSequence,
+                        pListenerConnection->Socket);
+            pListenerConnection->bInputPending = OpcUa_True;
+            break;
+        }
 
-    pInputStream = pListenerConnection->pInputStream;
+        pListenerConnection->bInputPending = OpcUa_False;
+        pInputStream = pListenerConnection->pInputStream;
+        pListenerConnection->pInputStream = OpcUa_Null;
+        OPCUA_P_MUTEX_UNLOCK(pListenerConnection->Mutex);
 
-    /* create stream if no one was found */
-    if(pInputStream == OpcUa_Null)
-    {
-        uStatus = OpcUa_HttpsStream_CreateInput(a_hSocket, OpcUa_HttpsStream_MessageType_Request, &pInputStream);
-        OpcUa_GotoErrorIfBad(uStatus);
-    }
-    /******************************************************************************************************/
+        /******************************************************************************************************/
 
-    /* now, we have a stream -> read the available data; further processing takes place in the callback */
-    uStatus = OpcUa_HttpsStream_DataReady(pInputStream);
+        /* create stream if no one was found */
+        if(pInputStream == OpcUa_Null)
+        {
+            uStatus = OpcUa_HttpsStream_CreateInput(pListenerConnection->Socket, OpcUa_HttpsStream_MessageType_Request, &pInputStream);
+            OpcUa_GotoErrorIfBad(uStatus);
+        }
 
-    /******************************************************************************************************/
+        /******************************************************************************************************/
 
-    if(pListenerConnection->bCallbackPending)
-    {
-        pHttpsListener->pfSecureChannelCallback(0,                                          /* channel id - this should be a reserved one */
-                                                eOpcUa_SecureListener_SecureChannelOpen,    /* event type */
-                                                pListenerConnection->hValidationResult,     /* event status */
-                                                &pListenerConnection->bsClientCertificate,  /* client certificate */
-                                                OpcUa_Null,                                 /* security policy */
-                                                0,                                          /* message security mode */
-                                                pHttpsListener->pvSecureChannelCallbackData);/* callback data */
-        OpcUa_ByteString_Clear(&pListenerConnection->bsClientCertificate);
-        pListenerConnection->bCallbackPending = OpcUa_False;
-    }
+        /* now, we have a stream -> read the available data; further processing takes place in the callback */
+        uStatus = OpcUa_HttpsStream_DataReady(pInputStream);
 
-    /******************************************************************************************************/
+        /******************************************************************************************************/
 
-    if(OpcUa_IsEqual(OpcUa_GoodCallAgain))
-    {
-        /* prepare to append further data later */
-        OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG,
-                    "OpcUa_HttpsListener_ReadEventHandler: "
-                    "CallAgain result for stream %p on socket %p!\n",
-                    pInputStream,
-                    a_hSocket);
-
-        /* bind stream to connection */
-        pListenerConnection->pInputStream       = pInputStream;
-        /* set data received timestamp */
-        pListenerConnection->uLastReceiveTime   = OpcUa_GetTickCount();
-        /* release reference from pending message list */
-        OpcUa_HttpsListener_ConnectionManager_ReleaseConnection(pHttpsListener->pConnectionManager,
-                                                                &pListenerConnection);
+        if(pListenerConnection->bCallbackPending)
+        {
+            pHttpsListener->pfSecureChannelCallback(0,                                          /* channel id - this should be a reserved one */
+                                                    eOpcUa_SecureListener_SecureChannelOpen,    /* event type */
+                                                    pListenerConnection->hValidationResult,     /* event status */
+                                                    &pListenerConnection->bsClientCertificate,  /* client certificate */
+                                                    OpcUa_Null,                                 /* security policy */
+                                                    0,                                          /* message security mode */
+                                                    pHttpsListener->pvSecureChannelCallbackData);/* callback data */
+            OpcUa_ByteString_Clear(&pListenerConnection->bsClientCertificate);
+            pListenerConnection->bCallbackPending = OpcUa_False;
+        }
+
+        /******************************************************************************************************/
+
+        if(OpcUa_IsEqual(OpcUa_GoodCallAgain))
+        {
+            /* prepare to append further data later */
+            OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG,
+                        "OpcUa_HttpsListener_ProcessInput: "
+                        "CallAgain result for stream %p on socket %p!\n",
+                        pInputStream,
+                        pListenerConnection->Socket);
+
+            OPCUA_P_MUTEX_LOCK(pListenerConnection->Mutex);
+            /* bind stream to connection */
+            pListenerConnection->pInputStream       = pInputStream;
+            /* set data received timestamp */
+            pListenerConnection->uLastReceiveTime   = OpcUa_GetTickCount();
+            pInputStream = OpcUa_Null;
+
+            if(pListenerConnection->bInputPending == OpcUa_False)
+            {
+                break;
+            }
+
+            /* more data arrived while this thread was reading */
+            continue;
+        }
 
-    }
-    else /* process message */
-    {
-        pListenerConnection->pInputStream       = OpcUa_Null;
         if(OpcUa_IsBad(uStatus))
         {
             OpcUa_StringA   sError          = OpcUa_Null;
@@ -1370,58 +1723,134 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "ReadEventHandler");
                                                             0);
             }
 
-            OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsListener_ReadEventHandler: socket %p; status 0x%08X (%s)\n", a_hSocket, uStatus, sError);
-            OpcUa_HttpsStream_Close((OpcUa_Stream*)pInputStream);
-            OpcUa_HttpsStream_Delete((OpcUa_Stream**)&pInputStream);
-
-            /* Notify about connection loss. */
-            OpcUa_HttpsListener_ProcessDisconnect(a_pListener, &pListenerConnection);
+            OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsListener_ProcessInput: socket %p; status 0x%08X (%s)\n", pListenerConnection->Socket, uStatus, sError);
+            OpcUa_GotoError;
         }
-        else /* Message can be processed. */
+
+        /******************************************************************************************************/
+
+        /* Message can be processed; data received behind it starts the next request. */
+        uStatus = OpcUa_HttpsStream_CreatePipelinedInput(pInputStream, &pNextInputStream);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        OPCUA_P_MUTEX_LOCK(pListenerConnection->Mutex);
+        pListenerConnection->pInputStream     = pNextInputStream;
+        pListenerConnection->uLastReceiveTime = OpcUa_GetTickCount();
+        pNextInputStream = OpcUa_Null;
+        OPCUA_P_MUTEX_UNLOCK(pListenerConnection->Mutex);
+
         {
             OpcUa_HttpsStream_MessageType eMessageType = OpcUa_HttpsStream_MessageType_Unknown;
             OpcUa_HttpsStream_GetMessageType((OpcUa_Stream*)pInputStream, &eMessageType);
 
-            /* set data received timestamp */
-            pListenerConnection->uLastReceiveTime   = OpcUa_GetTickCount();
-
-            /* process message */
-            if(eMessageType == OpcUa_HttpsStream_MessageType_Request)
+            if(eMessageType != OpcUa_HttpsStream_MessageType_Request)
             {
-                uStatus = OpcUa_HttpsListener_ProcessRequest(a_pListener, pListenerConnection, &pInputStream);
+                OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsListener_ProcessInput: Invalid MessageType (%d)\n", eMessageType);
+                OpcUa_GotoErrorWithStatus(OpcUa_BadDecodingError);
+            }
+        }
 
-                if(pInputStream != OpcUa_Null)
-                {
-                    OpcUa_Trace(OPCUA_TRACE_LEVEL_ERROR, "OpcUa_HttpsListener_ReadEventHandler: InputStream wasn't correctly released! Deleting it!\n");
-                    OpcUa_HttpsStream_Close((OpcUa_Stream*)pInputStream);
-                    OpcUa_HttpsStream_Delete((OpcUa_Stream**)&pInputStream);
+        /* the request holds its own reference until the response is sent */
+        OpcUa_HttpsListener_ConnectionManager_AddReference(pHttpsListener->pConnectionManager, pListenerConnection);
+        pRequestConnection = pListenerConnection;
 
-                    /* release reference between stream and connection */
-                    OpcUa_HttpsListener_ConnectionManager_ReleaseConnection(pHttpsListener->pConnectionManager,
-                                                                            &pListenerConnection);
-                }
+        uStatus = OpcUa_HttpsListener_ProcessRequest(a_pListener, pRequestConnection, &pInputStream);
 
-                if(OpcUa_IsBad(uStatus))
-                {
-                    OpcUa_Trace(OPCUA_TRACE_LEVEL_WARNING, "OpcUa_HttpsListener_ReadEventHandler: Process Request returned an error (0x%08X)!\n", uStatus);
-                }
-            }
-            else
-            {
-                OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsListener_ReadEventHandler: Invalid MessageType (%d)\n", eMessageType);
+        if(pInputStream != OpcUa_Null)
+        {
+            OpcUa_Trace(OPCUA_TRACE_LEVEL_ERROR, "OpcUa_HttpsListener_ProcessInput: InputStream wasn't correctly released! Deleting it!\n");
+            OpcUa_HttpsStream_Close((OpcUa_Stream*)pInputStream);
+            OpcUa_HttpsStream_Delete((OpcUa_Stream**)&pInputStream);
 
-                OpcUa_HttpsStream_Close((OpcUa_Stream*)pInputStream);
-                OpcUa_HttpsStream_Delete((OpcUa_Stream**)&pInputStream);
-                OpcUa_HttpsListener_ProcessDisconnect(a_pListener, &pListenerConnection);
-            }
+            /* the request will never be answered; later responses would be taken for its response */
+            OpcUa_HttpsListener_ProcessDisconnect(a_pListener, &pRequestConnection);
+        }
+
+        if(OpcUa_IsBad(uStatus))
+        {
+            OpcUa_Trace(OPCUA_TRACE_LEVEL_WARNING, "OpcUa_HttpsListener_ProcessInput: Process Request returned an error (0x%08X)!\n", uStatus);
+        }
+
+        OPCUA_P_MUTEX_LOCK(pListenerConnection->Mutex);
+
+        if(     pListenerConnection->pInputStream  == OpcUa_Null
+            &&  pListenerConnection->bInputPending == OpcUa_False)
+        {
+            /* no pipelined data left; wait for the next read event */
+            break;
         }
-    } /* if(OpcUa_IsEqual(OpcUa_GoodCallAgain)) */
+    }
+
+    pListenerConnection->bInputBusy = OpcUa_False;
+    OPCUA_P_MUTEX_UNLOCK(pListenerConnection->Mutex);
+
+    OpcUa_HttpsListener_ConnectionManager_ReleaseConnection(pHttpsListener->pConnectionManager,
+                                                            &pListenerConnection);
+
+    uStatus = OpcUa_Good;
 
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
 
-    OpcUa_HttpsListener_ProcessDisconnect(a_pListener, &pListenerConnection);
+    if(pInputStream != OpcUa_Null)
+    {
+        OpcUa_HttpsStream_Close((OpcUa_Stream*)pInputStream);
+        OpcUa_HttpsStream_Delete((OpcUa_Stream**)&pInputStream);
+    }
+
+    OPCUA_P_MUTEX_LOCK(pListenerConnection->Mutex);
+    pListenerConnection->bInputBusy = OpcUa_False;
+    OPCUA_P_MUTEX_UNLOCK(pListenerConnection->Mutex);
+
+    /* Notify about connection loss; a malformed request may wait for its answer. */
+    OpcUa_HttpsListener_CloseAfterResponse(a_pListener, &pListenerConnection);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * OpcUa_HttpsListener_ReadEventHandler
+ *===========================================================================*/
+/**
+ * @brief Gets called if data is available on the socket.
+ */
+OpcUa_StatusCode OpcUa_HttpsListener_ReadEventHandler(
+    OpcUa_Listener* a_pListener,
+    OpcUa_Socket    a_hSocket)
+{
+    OpcUa_HttpsListener*              pHttpsListener         = OpcUa_Null;
+    OpcUa_HttpsListener_Connection*   pListenerConnection    = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_HttpListener, "ReadEventHandler");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_pListener);
+    OpcUa_ReturnErrorIfArgumentNull(a_hSocket);
+    OpcUa_ReturnErrorIfArgumentNull(a_pListener->Handle)
+
+    pHttpsListener = (OpcUa_HttpsListener *)a_pListener->Handle;
+
+    /******************************************************************************************************/
+
+    /* look if an active connection is available for the socket. */
+    uStatus = OpcUa_HttpsListener_ConnectionManager_GetConnectionBySocket(  pHttpsListener->pConnectionManager,
+                                                                            a_hSocket,
+                                                                            &pListenerConnection);
+    if(OpcUa_IsBad(uStatus))
+    {
+        OPCUA_P_SOCKET_CLOSE(a_hSocket);
+        OpcUa_ReturnStatusCode;
+    }
 
+    /* get last access timestamp */
+    pListenerConnection->uLastReceiveTime =  OpcUa_GetTickCount();
+
+    /******************************************************************************************************/
+
+    /* read and dispatch the requests; the reference is passed on */
+    uStatus = OpcUa_HttpsListener_ProcessInput(a_pListener, pListenerConnection);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
 OpcUa_FinishErrorHandling;
 }
 
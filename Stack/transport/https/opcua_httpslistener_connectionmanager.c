@@ -192,6 +192,24 @@ OpcUa_StatusCode OpcUa_HttpsListener_ConnectionManager_GetConnectionBySocket(
     return uStatus;
 }
 
+/*==============================================================================*/
+/*                                                                              */
+/*==============================================================================*/
+/**
+* @brief Add a reference to a connection the caller already holds a reference to.
+*/
+OpcUa_Void OpcUa_HttpsListener_ConnectionManager_AddReference(
+    OpcUa_HttpsListener_ConnectionManager*    a_pConnectionManager,
+    OpcUa_HttpsListener_Connection*           a_pConnection)
+{
+    OpcUa_List_Enter(a_pConnectionManager->Connections);
+
+    a_pConnection->iReferenceCount++;
+    OPCUA_HLCM_TRACEREF(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsListener_ConnectionManager_AddReference: 0x%08X increasing RefCount %u\n", a_pConnection, a_pConnection->iReferenceCount);
+
+    OpcUa_List_Leave(a_pConnectionManager->Connections);
+}
+
 /*==============================================================================*/
 /*                                                                              */
 /*==============================================================================*/
@@ -327,12 +345,18 @@ OpcUa_StatusCode OpcUa_HttpsListener_Connection_Initialize(OpcUa_HttpsListener_C
 
     a_pConnection->pSendQueue               = OpcUa_Null;
 
+    a_pConnection->uRequestSequence         = 0;
+    a_pConnection->uResponseSequence        = 0;
+    a_pConnection->pHeldResponses           = OpcUa_Null;
+    a_pConnection->bInputBusy               = OpcUa_False;
+    a_pConnection->bInputPending            = OpcUa_False;
+    a_pConnection->bCloseWhenAnswered       = OpcUa_False;
+
     a_pConnection->bCallbackPending         = OpcUa_False;
     a_pConnection->hValidationResult        = OpcUa_BadNoData;
 
     OpcUa_ByteString_Initialize(&a_pConnection->bsClientCertificate);
 
-    OpcUa_String_Initialize(&a_pConnection->sSecurityPolicy);
 
     uStatus = OPCUA_P_MUTEX_CREATE(&(a_pConnection->Mutex));
     OpcUa_ReturnErrorIfBad(uStatus);
@@ -371,7 +395,6 @@ OpcUa_Void OpcUa_HttpsListener_Connection_Clear(OpcUa_HttpsListener_Connection*
 
     OpcUa_ByteString_Clear(&a_pConnection->bsClientCertificate);
 
-    OpcUa_String_Clear(&a_pConnection->sSecurityPolicy);
 
     while(a_pConnection->pSendQueue != OpcUa_Null)
     {
@@ -383,6 +406,25 @@ OpcUa_Void OpcUa_HttpsListener_Connection_Clear(OpcUa_HttpsListener_Connection*
         OpcUa_Free(pCurrentBuffer);
     }
 
+    while(a_pConnection->pHeldResponses != OpcUa_Null)
+    {
+        OpcUa_HttpsListener_HeldResponse* pHeldResponse = a_pConnection->pHeldResponses;
+
+        a_pConnection->pHeldResponses = pHeldResponse->pNext;
+
+        while(pHeldResponse->pBuffers != OpcUa_Null)
+        {
+            OpcUa_BufferList* pCurrentBuffer = pHeldResponse->pBuffers;
+
+            pHeldResponse->pBuffers = pCurrentBuffer->pNext;
+
+            OpcUa_Buffer_Clear(&pCurrentBuffer->Buffer);
+            OpcUa_Free(pCurrentBuffer);
+        }
+
+        OpcUa_Free(pHeldResponse);
+    }
+
     if(a_pConnection->Mutex)
     {
         OPCUA_P_MUTEX_DELETE(&(a_pConnection->Mutex));
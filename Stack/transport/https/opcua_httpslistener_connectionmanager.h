@@ -19,6 +19,24 @@
 
 OPCUA_BEGIN_EXTERN_C
 
+/*==============================================================================*/
+/* OpcUa_HttpsListener_HeldResponse                                                   */
+/*==============================================================================*/
+typedef struct _OpcUa_HttpsListener_HeldResponse OpcUa_HttpsListener_HeldResponse;
+
+/**
+* @brief A serialized response waiting for the responses of earlier pipelined requests.
+*/
+struct _OpcUa_HttpsListener_HeldResponse
+{
+    /** @brief The sequence number of the request this response belongs to. */
+    OpcUa_UInt32                        uSequenceNumber;
+    /** @brief The serialized response. */
+    OpcUa_BufferList*                   pBuffers;
+    /** @brief The response with the next higher sequence number. */
+    OpcUa_HttpsListener_HeldResponse*   pNext;
+};
+
 /*==============================================================================*/
 /* OpcUa_HttpsListener_Connection                                                     */
 /*==============================================================================*/
@@ -39,8 +57,6 @@ struct _OpcUa_HttpsListener_Connection
     OpcUa_UInt32                uLastReceiveTime;
     /** @brief True, as long as the connection is established. */
     OpcUa_Boolean               bConnected;
-    /** @brief True, if the client requested the connection to be kept alive. */
-    OpcUa_Boolean               bKeepAlive;
     /** @brief Backlink to the listener which hosts the connection. */
     OpcUa_Void*                 pListenerHandle;
     /** @brief Holds a reference to a not fully received stream message. */
@@ -51,8 +67,6 @@ struct _OpcUa_HttpsListener_Connection
     OpcUa_Mutex                 Mutex;
     /** @brief Number of request being issued over this connection. */
     OpcUa_UInt32                uNoOfRequestsTotal;
-    /** @brief Security Policy provided by the client. */
-    OpcUa_String                sSecurityPolicy;
     /** @brief ValidationCallback has been received. */
     OpcUa_Boolean               bCallbackPending;
     /** @brief hResult from ValidationCallback. */
@@ -63,6 +77,18 @@ struct _OpcUa_HttpsListener_Connection
     OpcUa_Int32                 iReferenceCount;
     /** @brief The queued list of data blocks to be sent. */
     OpcUa_BufferList*           pSendQueue;
+    /** @brief Sequence number given to the next request dispatched from this connection. */
+    OpcUa_UInt32                uRequestSequence;
+    /** @brief Sequence number of the next response to be written; responses leave in request order. */
+    OpcUa_UInt32                uResponseSequence;
+    /** @brief Responses completed ahead of an earlier request, sorted by sequence number. */
+    OpcUa_HttpsListener_HeldResponse* pHeldResponses;
+    /** @brief True, while a thread reads and dispatches requests from this connection. */
+    OpcUa_Boolean               bInputBusy;
+    /** @brief True, if reading was deferred and has to be resumed. */
+    OpcUa_Boolean               bInputPending;
+    /** @brief True, if a request was rejected; the connection closes once its response has left. */
+    OpcUa_Boolean               bCloseWhenAnswered;
 };
 
 typedef struct _OpcUa_HttpsListener_Connection OpcUa_HttpsListener_Connection;
@@ -118,6 +144,11 @@ OpcUa_StatusCode    OpcUa_HttpsListener_ConnectionManager_GetConnectionBySocket(
     OpcUa_Socket                            Socket,
     OpcUa_HttpsListener_Connection**        Connection);
 
+/* @brief Add a reference to a connection already referenced by the caller. */
+OpcUa_Void OpcUa_HttpsListener_ConnectionManager_AddReference(
+    OpcUa_HttpsListener_ConnectionManager*    a_pConnectionManager,
+    OpcUa_HttpsListener_Connection*           a_pConnection);
+
 /* @brief Release reference to given connection. Pointer gets nulled on return. */
 OpcUa_StatusCode OpcUa_HttpsListener_ConnectionManager_ReleaseConnection(
     OpcUa_HttpsListener_ConnectionManager*    a_pConnectionManager,
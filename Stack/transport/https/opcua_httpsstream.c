@@ -89,7 +89,14 @@ struct _OpcUa_HttpsInputStream
     OpcUa_UInt32                            nCurrentReadBuffer;
     /** @brief The internal message buffers. */
     OpcUa_Buffer                            Buffer[OPCUA_HTTPS_MAX_RECV_BUFFER_COUNT];
-
+    /** @brief Position of the message in the request order of its connection. */
+    OpcUa_UInt32                            uSequenceNumber;
+    /** @brief Data of pipelined messages received behind this message. */
+    OpcUa_Byte*                             pPipelinedData;
+    /** @brief Length of the pipelined data. */
+    OpcUa_UInt32                            uPipelinedLength;
+    /** @brief True, if the first buffer holds pipelined data which must be parsed before reading from the socket. */
+    OpcUa_Boolean                           bPreloaded;
 };
 typedef struct _OpcUa_HttpsInputStream OpcUa_HttpsInputStream;
 
@@ -133,6 +140,10 @@ struct _OpcUa_HttpsOutputStream
     OpcUa_UInt32                            nAbsolutePosition;
     /** @brief The internal message buffers. */
     OpcUa_Buffer                            Buffer[OPCUA_HTTPS_MAX_SEND_CHUNK_COUNT];
+    /** @brief Position of the message in the request order of its connection. */
+    OpcUa_UInt32                            uSequenceNumber;
+    /** @brief Security policy requested with the message being answered. */
+    OpcUa_String                            SecurityPolicy;
 };
 typedef struct _OpcUa_HttpsOutputStream OpcUa_HttpsOutputStream;
 
@@ -168,24 +179,86 @@ static OpcUa_StatusCode OpcUa_HttpsStream_ReadChunkLength(  OpcUa_InputStream*
                                                             OpcUa_Int32*        a_piChunkLength);
 
 /*============================================================================
- * OpcUa_Https_ReadCharFromBuffer
+ * OpcUa_Https_IsToken
  *===========================================================================*/
-/** @brief reads the next available character */
-static OpcUa_StatusCode OpcUa_Https_ReadCharFromBuffer(
-    OpcUa_Buffer*   a_pBuffer,
-    OpcUa_CharA*    a_pValue)
+/** @brief compares a string case-insensitively with a lower case token */
+static OpcUa_Boolean OpcUa_Https_IsToken(
+    OpcUa_String*       a_pString,
+    const OpcUa_CharA*  a_sToken,
+    OpcUa_UInt32        a_uTokenLength)
 {
-    OpcUa_ReturnErrorIfArgumentNull(a_pBuffer);
-    OpcUa_ReturnErrorIfArgumentNull(a_pValue);
+    const OpcUa_CharA*  pChar   = OpcUa_String_GetRawString(a_pString);
+    OpcUa_CharA         chValue = '\x00';
+    OpcUa_UInt32        uPos    = 0;
 
-    if(a_pBuffer->EndOfData - a_pBuffer->Position <= 0)
+    if(pChar == OpcUa_Null || OpcUa_String_StrSize(a_pString) != a_uTokenLength)
     {
-        return OpcUa_BadEndOfStream;
+        return OpcUa_False;
     }
 
-    *a_pValue = (OpcUa_CharA)(a_pBuffer->Data[a_pBuffer->Position++]);
+    for(uPos = 0; uPos < a_uTokenLength; uPos++)
+    {
+        chValue = pChar[uPos];
+
+        if(chValue >= 'A' && chValue <= 'Z')
+        {
+            chValue = (OpcUa_CharA)(chValue - 'A' + 'a');
+        }
 
-    return OpcUa_Good;
+        if(chValue != a_sToken[uPos])
+        {
+            return OpcUa_False;
+        }
+    }
+
+    return OpcUa_True;
+}
+
+/*============================================================================
+ * OpcUa_Https_ParseNumber
+ *===========================================================================*/
+/** @brief parses a decimal or hexadecimal number in place; returns the count of digits */
+static OpcUa_UInt32 OpcUa_Https_ParseNumber(
+    const OpcUa_CharA*  a_pChars,
+    OpcUa_UInt32        a_uLength,
+    OpcUa_UInt32        a_uBase,
+    OpcUa_UInt32        a_uMaxValue,
+    OpcUa_UInt32*       a_puValue)
+{
+    OpcUa_UInt32 uPos   = 0;
+    OpcUa_UInt32 uDigit = 0;
+
+    *a_puValue = 0;
+
+    for(uPos = 0; uPos < a_uLength; uPos++)
+    {
+        if(a_pChars[uPos] >= '0' && a_pChars[uPos] <= '9')
+        {
+            uDigit = (OpcUa_UInt32)(a_pChars[uPos] - '0');
+        }
+        else if(a_uBase == 16 && a_pChars[uPos] >= 'a' && a_pChars[uPos] <= 'f')
+        {
+            uDigit = (OpcUa_UInt32)(a_pChars[uPos] - 'a' + 10);
+        }
+        else if(a_uBase == 16 && a_pChars[uPos] >= 'A' && a_pChars[uPos] <= 'F')
+        {
+            uDigit = (OpcUa_UInt32)(a_pChars[uPos] - 'A' + 10);
+        }
+        else
+        {
+            break;
+        }
+
+        if(*a_puValue > (a_uMaxValue - uDigit) / a_uBase)
+        {
+            /* out of range; report as invalid */
+            return 0;
+        }
+
+        *a_puValue = *a_puValue * a_uBase + uDigit;
+    }
+
+    return uPos;
 }
 
 #if OPCUA_HTTPSSTREAM_OUTPUT_HAS_HEADERCOLLECTION
@@ -956,14 +1029,16 @@ OpcUa_FinishErrorHandling;
 }
 
 /*============================================================================
- * OpcUa_HttpsStream_Flush
+ * OpcUa_HttpsStream_Complete
  *===========================================================================*/
-OpcUa_StatusCode OpcUa_HttpsStream_Flush(   OpcUa_OutputStream* a_pOutputStream,
-                                            OpcUa_Boolean       a_bLastCall)
+/** @brief Serializes headers and chunk framing into the buffers and sends them if a_bSend is true. */
+static OpcUa_StatusCode OpcUa_HttpsStream_Complete( OpcUa_OutputStream* a_pOutputStream,
+                                                    OpcUa_Boolean       a_bLastCall,
+                                                    OpcUa_Boolean       a_bSend)
 {
     OpcUa_HttpsOutputStream*    pHttpOutputStream   = OpcUa_Null;
     OpcUa_UInt32                uCurrentBuffer      = 0;
-    OpcUa_Boolean               bWouldBlock         = OpcUa_False;
+    OpcUa_Boolean               bWouldBlock         = (a_bSend == OpcUa_False)?OpcUa_True:OpcUa_False;
 
 OpcUa_InitializeStatus(OpcUa_Module_HttpStream, "Flush");
 
@@ -1132,7 +1207,11 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpStream, "Flush");
         }
     } /* for each chunk */
 
-    if(bWouldBlock != OpcUa_False)
+    if(a_bSend == OpcUa_False)
+    {
+        OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsStream_Flush: All chunks prepared for delayed sending.\n");
+    }
+    else if(bWouldBlock != OpcUa_False)
     {
         OpcUa_GotoErrorWithStatus(OpcUa_BadWouldBlock);
     }
@@ -1156,6 +1235,42 @@ OpcUa_BeginErrorHandling;
 OpcUa_FinishErrorHandling;
 }
 
+/*============================================================================
+ * OpcUa_HttpsStream_Flush
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_HttpsStream_Flush(   OpcUa_OutputStream* a_pOutputStream,
+                                            OpcUa_Boolean       a_bLastCall)
+{
+    return OpcUa_HttpsStream_Complete(a_pOutputStream, a_bLastCall, OpcUa_True);
+}
+
+/*============================================================================
+ * OpcUa_HttpsStream_Finish
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_HttpsStream_Finish(OpcUa_OutputStream* a_pOutputStream)
+{
+OpcUa_InitializeStatus(OpcUa_Module_HttpStream, "Finish");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_pOutputStream);
+    OpcUa_ReturnErrorIfArgumentNull(a_pOutputStream->Handle);
+    OpcUa_ReturnErrorIfTrue(a_pOutputStream->Type != OpcUa_StreamType_Output,
+                            OpcUa_BadInvalidArgument);
+
+    if(((OpcUa_HttpsOutputStream*)(a_pOutputStream->Handle))->Closed)
+    {
+        return OpcUa_BadInvalidState;
+    }
+
+    uStatus = OpcUa_HttpsStream_Complete(a_pOutputStream, OpcUa_True, OpcUa_False);
+
+    ((OpcUa_HttpsOutputStream*)(a_pOutputStream->Handle))->Closed = OpcUa_True;
+    OpcUa_GotoErrorIfBad(uStatus);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
 /*============================================================================
  * OpcUa_HttpsStream_Close
  *===========================================================================*/
@@ -1252,6 +1367,8 @@ OpcUa_Void OpcUa_HttpsStream_Delete(OpcUa_Stream** a_ppStream)
 
 #endif /* OPCUA_HTTPSSTREAM_OUTPUT_HAS_HEADERCOLLECTION */
 
+        OpcUa_String_Clear(&pOutputStream->SecurityPolicy);
+
         OpcUa_Free(*a_ppStream);
         *a_ppStream = OpcUa_Null;
     }
@@ -1279,6 +1396,11 @@ OpcUa_Void OpcUa_HttpsStream_Delete(OpcUa_Stream** a_ppStream)
             OpcUa_Buffer_Clear(&(pInputStream->Buffer[uCurrentBuffer]));
         }
 
+        if(pInputStream->pPipelinedData != OpcUa_Null)
+        {
+            OpcUa_Free(pInputStream->pPipelinedData);
+        }
+
         OpcUa_String_Clear(&(pInputStream->MessageLine));
 
         OpcUa_Free(*a_ppStream);
@@ -1727,6 +1849,113 @@ OpcUa_BeginErrorHandling;
 OpcUa_FinishErrorHandling;
 }
 
+/*============================================================================
+ * OpcUa_HttpsStream_SetSequenceNumber
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_HttpsStream_SetSequenceNumber(
+    OpcUa_Stream*   a_pStream,
+    OpcUa_UInt32    a_uSequenceNumber)
+{
+OpcUa_InitializeStatus(OpcUa_Module_HttpStream, "SetSequenceNumber");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_pStream);
+    OpcUa_ReturnErrorIfArgumentNull(a_pStream->Handle);
+
+    if(a_pStream->Type == OpcUa_StreamType_Input)
+    {
+        ((OpcUa_HttpsInputStream*)a_pStream->Handle)->uSequenceNumber = a_uSequenceNumber;
+    }
+    else
+    {
+        ((OpcUa_HttpsOutputStream*)a_pStream->Handle)->uSequenceNumber = a_uSequenceNumber;
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * OpcUa_HttpsStream_GetSequenceNumber
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_HttpsStream_GetSequenceNumber(
+    OpcUa_Stream*   a_pStream,
+    OpcUa_UInt32*   a_puSequenceNumber)
+{
+OpcUa_InitializeStatus(OpcUa_Module_HttpStream, "GetSequenceNumber");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_pStream);
+    OpcUa_ReturnErrorIfArgumentNull(a_pStream->Handle);
+    OpcUa_ReturnErrorIfArgumentNull(a_puSequenceNumber);
+
+    if(a_pStream->Type == OpcUa_StreamType_Input)
+    {
+        *a_puSequenceNumber = ((OpcUa_HttpsInputStream*)a_pStream->Handle)->uSequenceNumber;
+    }
+    else
+    {
+        *a_puSequenceNumber = ((OpcUa_HttpsOutputStream*)a_pStream->Handle)->uSequenceNumber;
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * OpcUa_HttpsStream_SetSecurityPolicy
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_HttpsStream_SetSecurityPolicy(
+    OpcUa_OutputStream* a_pOutputStream,
+    OpcUa_String*       a_pSecurityPolicy)
+{
+    OpcUa_HttpsOutputStream* pHttpOutputStream = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_HttpStream, "SetSecurityPolicy");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_pOutputStream);
+    OpcUa_ReturnErrorIfArgumentNull(a_pOutputStream->Handle);
+    OpcUa_ReturnErrorIfArgumentNull(a_pSecurityPolicy);
+    OpcUa_ReturnErrorIfTrue(a_pOutputStream->Type != OpcUa_StreamType_Output, OpcUa_BadInvalidArgument);
+
+    pHttpOutputStream = (OpcUa_HttpsOutputStream*)a_pOutputStream->Handle;
+
+    OpcUa_String_Clear(&pHttpOutputStream->SecurityPolicy);
+
+    if(OpcUa_String_IsNull(a_pSecurityPolicy) == OpcUa_False)
+    {
+        uStatus = OpcUa_String_StrnCpy( &pHttpOutputStream->SecurityPolicy,
+                                        a_pSecurityPolicy,
+                                        OPCUA_STRING_LENDONTCARE);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * OpcUa_HttpsStream_GetSecurityPolicy
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_HttpsStream_GetSecurityPolicy(
+    OpcUa_OutputStream* a_pOutputStream,
+    OpcUa_String**      a_ppSecurityPolicy)
+{
+OpcUa_InitializeStatus(OpcUa_Module_HttpStream, "GetSecurityPolicy");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_pOutputStream);
+    OpcUa_ReturnErrorIfArgumentNull(a_pOutputStream->Handle);
+    OpcUa_ReturnErrorIfArgumentNull(a_ppSecurityPolicy);
+    OpcUa_ReturnErrorIfTrue(a_pOutputStream->Type != OpcUa_StreamType_Output, OpcUa_BadInvalidArgument);
+
+    *a_ppSecurityPolicy = &((OpcUa_HttpsOutputStream*)a_pOutputStream->Handle)->SecurityPolicy;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
 /*============================================================================
  * OpcUa_HttpsStream_CreateInput
  *===========================================================================*/
@@ -1797,6 +2026,72 @@ OpcUa_BeginErrorHandling;
 OpcUa_FinishErrorHandling;
 }
 
+/*============================================================================
+ * OpcUa_HttpsStream_CreatePipelinedInput
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_HttpsStream_CreatePipelinedInput(
+    OpcUa_InputStream*              a_pInputStream,
+    OpcUa_InputStream**             a_ppNextInputStream)
+{
+    OpcUa_HttpsInputStream* pHttpInputStream    = OpcUa_Null;
+    OpcUa_HttpsInputStream* pNextInputStream    = OpcUa_Null;
+    OpcUa_UInt32            uBufferSize         = OPCUA_HTTPS_MAX_RECV_BUFFER_LENGTH;
+
+OpcUa_InitializeStatus(OpcUa_Module_HttpStream, "CreatePipelinedInput");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_pInputStream);
+    OpcUa_ReturnErrorIfArgumentNull(a_pInputStream->Handle);
+    OpcUa_ReturnErrorIfArgumentNull(a_ppNextInputStream);
+    OpcUa_ReturnErrorIfTrue(a_pInputStream->Type != OpcUa_StreamType_Input,
+                            OpcUa_BadInvalidArgument);
+
+    *a_ppNextInputStream = OpcUa_Null;
+
+    pHttpInputStream = (OpcUa_HttpsInputStream*)a_pInputStream->Handle;
+
+    if(pHttpInputStream->pPipelinedData == OpcUa_Null)
+    {
+        OpcUa_ReturnStatusCode;
+    }
+
+    uStatus = OpcUa_HttpsStream_CreateInput(pHttpInputStream->Socket,
+                                            pHttpInputStream->MessageType,
+                                            a_ppNextInputStream);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    pNextInputStream = (OpcUa_HttpsInputStream*)(*a_ppNextInputStream)->Handle;
+
+    uStatus = OpcUa_HttpsHeaderCollection_Create(&pNextInputStream->Headers);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    if(pHttpInputStream->uPipelinedLength > uBufferSize)
+    {
+        uBufferSize = pHttpInputStream->uPipelinedLength;
+    }
+
+    /* the next message starts with the data already received */
+    uStatus = OpcUa_Buffer_Initialize(&pNextInputStream->Buffer[0],
+                                      pHttpInputStream->pPipelinedData,
+                                      pHttpInputStream->uPipelinedLength,
+                                      uBufferSize,
+                                      uBufferSize,
+                                      OpcUa_True);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    pHttpInputStream->pPipelinedData   = OpcUa_Null;
+    pHttpInputStream->uPipelinedLength = 0;
+
+    pNextInputStream->State      = OpcUa_HttpsStream_State_StartLine;
+    pNextInputStream->bPreloaded = OpcUa_True;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_HttpsStream_Delete((OpcUa_Stream**)a_ppNextInputStream);
+
+OpcUa_FinishErrorHandling;
+}
+
 /*============================================================================
  * OpcUa_HttpsStream_CreateOutput
  *===========================================================================*/
@@ -1833,6 +2128,8 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpStream, "CreateOutput");
     pHttpOutputStream->Closed             = OpcUa_False;
     pHttpOutputStream->Socket             = a_hSocket;
 
+    OpcUa_String_Initialize(&pHttpOutputStream->SecurityPolicy);
+
     /* create message start line */
     if(a_eMessageType == OpcUa_HttpsStream_MessageType_Request)
     {
@@ -2089,6 +2386,75 @@ OpcUa_BeginErrorHandling;
 OpcUa_FinishErrorHandling;
 }
 
+/*============================================================================
+ * OpcUa_HttpsStream_KeepPipelinedData
+ *===========================================================================*/
+/** @brief Moves data received behind the end of the current message out of
+  *        the message buffers, so it can start the next pipelined message.
+  *
+  * @param a_pHttpInputStream [in] The stream holding a complete message.
+  * @param a_uBuffer          [in] Index of the buffer in which the message ends.
+  * @param a_uEndOfMessage    [in] Offset of the message end in that buffer.
+  */
+static OpcUa_StatusCode OpcUa_HttpsStream_KeepPipelinedData(
+    OpcUa_HttpsInputStream* a_pHttpInputStream,
+    OpcUa_UInt32            a_uBuffer,
+    OpcUa_UInt32            a_uEndOfMessage)
+{
+    OpcUa_UInt32            uLength             = 0;
+    OpcUa_UInt32            uBufferSize         = OPCUA_HTTPS_MAX_RECV_BUFFER_LENGTH;
+    OpcUa_UInt32            uCurrentBuffer      = 0;
+    OpcUa_UInt32            uCopyLength         = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_HttpStream, "KeepPipelinedData");
+
+    uLength = a_pHttpInputStream->Buffer[a_uBuffer].EndOfData - a_uEndOfMessage;
+    for(uCurrentBuffer = a_uBuffer + 1; uCurrentBuffer <= a_pHttpInputStream->nBuffers; uCurrentBuffer++)
+    {
+        uLength += a_pHttpInputStream->Buffer[uCurrentBuffer].EndOfData;
+    }
+
+    if(uLength == 0)
+    {
+        OpcUa_ReturnStatusCode;
+    }
+
+    OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsStream_KeepPipelinedData: %u bytes of the next message received.\n", uLength);
+
+    if(uLength > uBufferSize)
+    {
+        uBufferSize = uLength;
+    }
+
+    a_pHttpInputStream->pPipelinedData = (OpcUa_Byte*)OpcUa_Alloc(uBufferSize);
+    OpcUa_GotoErrorIfAllocFailed(a_pHttpInputStream->pPipelinedData);
+
+    uCopyLength = a_pHttpInputStream->Buffer[a_uBuffer].EndOfData - a_uEndOfMessage;
+    OpcUa_MemCpy(a_pHttpInputStream->pPipelinedData,
+                 uBufferSize,
+                 &a_pHttpInputStream->Buffer[a_uBuffer].Data[a_uEndOfMessage],
+                 uCopyLength);
+    a_pHttpInputStream->uPipelinedLength = uCopyLength;
+    a_pHttpInputStream->Buffer[a_uBuffer].EndOfData = a_uEndOfMessage;
+
+    for(uCurrentBuffer = a_uBuffer + 1; uCurrentBuffer <= a_pHttpInputStream->nBuffers; uCurrentBuffer++)
+    {
+        uCopyLength = a_pHttpInputStream->Buffer[uCurrentBuffer].EndOfData;
+        OpcUa_MemCpy(&a_pHttpInputStream->pPipelinedData[a_pHttpInputStream->uPipelinedLength],
+                     uBufferSize - a_pHttpInputStream->uPipelinedLength,
+                     a_pHttpInputStream->Buffer[uCurrentBuffer].Data,
+                     uCopyLength);
+        a_pHttpInputStream->uPipelinedLength += uCopyLength;
+        OpcUa_Buffer_Clear(&a_pHttpInputStream->Buffer[uCurrentBuffer]);
+    }
+
+    a_pHttpInputStream->nBuffers = a_uBuffer;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
 /*============================================================================
  * OpcUa_HttpsStream_Receive
  *===========================================================================*/
@@ -2150,19 +2516,27 @@ OpcUa_FinishErrorHandling;
 /*============================================================================
  * OpcUa_HttpsStream_ReadLine
  *===========================================================================*/
-/** @brief reads a line of characters */
+/** @brief reads a line of characters
+  *
+  * The line feed is searched with memchr over the buffered data instead of
+  * reading character by character. A line lying in one buffer is attached
+  * in place; only a line spanning two buffers is copied.
+  */
 static OpcUa_StatusCode OpcUa_HttpsStream_ReadLine(
     OpcUa_InputStream*  a_pInputStream,
     OpcUa_String*       a_pMessageLine)
 {
-    OpcUa_UInt32            LineStart           = 0;
-    OpcUa_UInt32            LineEnd             = 0;
     OpcUa_HttpsInputStream* pHttpInputStream    = OpcUa_Null;
+    OpcUa_Buffer*           pBuffer             = OpcUa_Null;
+    OpcUa_Buffer*           pNextBuffer         = OpcUa_Null;
+    OpcUa_CharA*            pLineStart          = OpcUa_Null;
+    OpcUa_CharA*            pLineFeed           = OpcUa_Null;
     OpcUa_CharA*            pLineContent        = OpcUa_Null;
-    OpcUa_CharA             chAsciiChar         = '\x00';
-    OpcUa_UInt32            uCharCount          = 0;
     OpcUa_UInt32            uCurrentReadBuffer  = 0;
-    OpcUa_Boolean           bCR                 = OpcUa_False;
+    OpcUa_UInt32            uLineStart          = 0;
+    OpcUa_UInt32            uFirstPart          = 0;
+    OpcUa_UInt32            uSecondPart         = 0;
+    OpcUa_UInt32            uScanLength         = 0;
 
 OpcUa_InitializeStatus(OpcUa_Module_HttpStream, "ReadLine");
 
@@ -2170,93 +2544,85 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpStream, "ReadLine");
     OpcUa_ReturnErrorIfArgumentNull(a_pInputStream->Handle);
     OpcUa_ReturnErrorIfArgumentNull(a_pMessageLine);
 
-    pHttpInputStream = (OpcUa_HttpsInputStream*)a_pInputStream->Handle;
+    pHttpInputStream   = (OpcUa_HttpsInputStream*)a_pInputStream->Handle;
     uCurrentReadBuffer = pHttpInputStream->nCurrentReadBuffer;
+    pBuffer            = &pHttpInputStream->Buffer[uCurrentReadBuffer];
+    uLineStart         = pBuffer->Position;
 
-    uStatus = OpcUa_Buffer_GetPosition(&pHttpInputStream->Buffer[uCurrentReadBuffer],
-                                       &LineStart);
-    OpcUa_ReturnErrorIfBad(uStatus);
-
-    for(uCharCount = 0; uCharCount < OPCUA_HTTPS_MAX_RECV_HEADER_LINE_LENGTH; uCharCount++)
+    if(     uLineStart == pBuffer->EndOfData
+        &&  uCurrentReadBuffer < pHttpInputStream->nBuffers)
     {
-        do
-        {
-            uStatus = OpcUa_Https_ReadCharFromBuffer(&pHttpInputStream->Buffer[uCurrentReadBuffer], &chAsciiChar);
+        /* the line starts in the next buffer */
+        uCurrentReadBuffer++;
+        pBuffer    = &pHttpInputStream->Buffer[uCurrentReadBuffer];
+        uLineStart = 0;
+    }
 
-            if(uStatus == OpcUa_BadEndOfStream)
-            {
-                if(uCurrentReadBuffer > pHttpInputStream->nCurrentReadBuffer)
-                {
-                    /* header must not span more than two buffers */
-                    OpcUa_GotoErrorWithStatus(OpcUa_BadDecodingError);
-                }
-                else if(uCurrentReadBuffer < pHttpInputStream->nBuffers)
-                {
-                    uCurrentReadBuffer++;
-                    uStatus = OpcUa_GoodCallAgain;
-                }
-                else
-                {
-                    OpcUa_GotoErrorWithStatus(OpcUa_GoodCallAgain);
-                }
-            }
+    pLineStart  = (OpcUa_CharA*)&pBuffer->Data[uLineStart];
+    uFirstPart  = pBuffer->EndOfData - uLineStart;
+    uScanLength = (uFirstPart < OPCUA_HTTPS_MAX_RECV_HEADER_LINE_LENGTH)? uFirstPart: OPCUA_HTTPS_MAX_RECV_HEADER_LINE_LENGTH;
 
-        } while(uStatus == OpcUa_GoodCallAgain);
+    pLineFeed = (OpcUa_CharA*)OpcUa_MemChr(pLineStart, '\n', uScanLength);
 
-        OpcUa_GotoErrorIfBad(uStatus);
+    if(pLineFeed == OpcUa_Null)
+    {
+        OpcUa_GotoErrorIfTrue(uFirstPart >= OPCUA_HTTPS_MAX_RECV_HEADER_LINE_LENGTH, OpcUa_BadDecodingError);
 
-        if(chAsciiChar == '\r')
+        if(uCurrentReadBuffer == pHttpInputStream->nBuffers)
         {
-            OpcUa_GotoErrorIfTrue(bCR != OpcUa_False, OpcUa_BadDecodingError);
-            bCR = OpcUa_True;
+            /* line not complete yet */
+            OpcUa_GotoErrorWithStatus(OpcUa_GoodCallAgain);
         }
-        else if(chAsciiChar == '\n')
+
+        /* the line continues in the next buffer */
+        pNextBuffer = &pHttpInputStream->Buffer[uCurrentReadBuffer + 1];
+        uScanLength = OPCUA_HTTPS_MAX_RECV_HEADER_LINE_LENGTH - uFirstPart;
+        if(pNextBuffer->EndOfData < uScanLength)
         {
-            OpcUa_GotoErrorIfTrue(bCR != OpcUa_True, OpcUa_BadDecodingError);
-            break;
+            uScanLength = pNextBuffer->EndOfData;
         }
-    } /* peek until \r\n */
-
-    uStatus = OpcUa_Buffer_GetPosition(&pHttpInputStream->Buffer[uCurrentReadBuffer],
-                                       &LineEnd);
-    OpcUa_GotoErrorIfBad(uStatus);
-
-    /* assuming that a message line is not longer than a whole buffer */
-    if(LineEnd > LineStart)
-    {
-        uCharCount = LineEnd - LineStart;
-        OpcUa_GotoErrorIfTrue(uCharCount < 2, OpcUa_BadInternalError);
 
-        /* do not include CR and LF characters into the resulting string */
-        uCharCount -= 2;
+        pLineFeed = (OpcUa_CharA*)OpcUa_MemChr(pNextBuffer->Data, '\n', uScanLength);
 
-        pLineContent = (OpcUa_CharA*)&(pHttpInputStream->Buffer[uCurrentReadBuffer].Data[LineStart]);
+        if(pLineFeed == OpcUa_Null)
+        {
+            /* header must not span more than two buffers */
+            OpcUa_GotoErrorIfTrue(    uScanLength < pNextBuffer->EndOfData
+                                   || uCurrentReadBuffer + 1 < pHttpInputStream->nBuffers,
+                                   OpcUa_BadDecodingError);
+            OpcUa_GotoErrorWithStatus(OpcUa_GoodCallAgain);
+        }
 
-        uStatus = OpcUa_String_AttachToString(pLineContent,
-                                              uCharCount,
-                                              uCharCount,
-#if OPCUA_HTTPS_COPYHEADERS
-                                              OpcUa_True,
-#else
-                                              OpcUa_False,
-#endif
-                                              OpcUa_False,
-                                              a_pMessageLine);
-        OpcUa_GotoErrorIfBad(uStatus);
+        uSecondPart = (OpcUa_UInt32)(pLineFeed - (OpcUa_CharA*)pNextBuffer->Data);
     }
-    else if(LineEnd == 1)
+    else
     {
-        uCharCount = LineEnd + (pHttpInputStream->Buffer[pHttpInputStream->nCurrentReadBuffer].EndOfData - LineStart);
-        OpcUa_GotoErrorIfTrue(uCharCount < 2, OpcUa_BadInternalError);
+        uFirstPart = (OpcUa_UInt32)(pLineFeed - pLineStart);
+    }
 
-        /* do not include CR and LF characters into the resulting string */
-        uCharCount -= 2;
+    /* do not include CR and LF characters into the resulting string */
+    if(uSecondPart > 0)
+    {
+        OpcUa_GotoErrorIfTrue(pNextBuffer->Data[uSecondPart - 1] != '\r', OpcUa_BadDecodingError);
+        uSecondPart--;
+    }
+    else
+    {
+        OpcUa_GotoErrorIfTrue(uFirstPart == 0 || pLineStart[uFirstPart - 1] != '\r', OpcUa_BadDecodingError);
+        uFirstPart--;
+    }
 
-        pLineContent = (OpcUa_CharA*)&(pHttpInputStream->Buffer[pHttpInputStream->nCurrentReadBuffer].Data[LineStart]);
+    /* a carriage return is only allowed in front of the line feed */
+    OpcUa_GotoErrorIfTrue(OpcUa_MemChr(pLineStart, '\r', uFirstPart) != OpcUa_Null, OpcUa_BadDecodingError);
+    OpcUa_GotoErrorIfTrue(    pNextBuffer != OpcUa_Null
+                           && OpcUa_MemChr(pNextBuffer->Data, '\r', uSecondPart) != OpcUa_Null,
+                           OpcUa_BadDecodingError);
 
-        uStatus = OpcUa_String_AttachToString(pLineContent,
-                                              uCharCount,
-                                              uCharCount,
+    if(uSecondPart == 0)
+    {
+        uStatus = OpcUa_String_AttachToString(pLineStart,
+                                              uFirstPart,
+                                              uFirstPart,
 #if OPCUA_HTTPS_COPYHEADERS
                                               OpcUa_True,
 #else
@@ -2265,57 +2631,54 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpStream, "ReadLine");
                                               OpcUa_False,
                                               a_pMessageLine);
         OpcUa_GotoErrorIfBad(uStatus);
-
-        pHttpInputStream->nCurrentReadBuffer = uCurrentReadBuffer;
     }
     else
     {
-        OpcUa_String sTemp = OPCUA_STRING_STATICINITIALIZER;
-        uCharCount = LineEnd + (pHttpInputStream->Buffer[pHttpInputStream->nCurrentReadBuffer].EndOfData - LineStart);
-        OpcUa_GotoErrorIfTrue(uCharCount < 2, OpcUa_BadInternalError);
+        /* join both parts; the string owns the copy */
+        pLineContent = (OpcUa_CharA*)OpcUa_Alloc(uFirstPart + uSecondPart + 1);
+        OpcUa_GotoErrorIfAllocFailed(pLineContent);
 
-        pLineContent = (OpcUa_CharA*)&(pHttpInputStream->Buffer[pHttpInputStream->nCurrentReadBuffer].Data[LineStart]);
+        OpcUa_MemCpy(pLineContent, uFirstPart, pLineStart, uFirstPart);
+        OpcUa_MemCpy(&pLineContent[uFirstPart], uSecondPart, pNextBuffer->Data, uSecondPart);
+        pLineContent[uFirstPart + uSecondPart] = '\0';
 
         uStatus = OpcUa_String_AttachToString(pLineContent,
-                                              pHttpInputStream->Buffer[pHttpInputStream->nCurrentReadBuffer].EndOfData - LineStart,
-                                              pHttpInputStream->Buffer[pHttpInputStream->nCurrentReadBuffer].EndOfData - LineStart,
-                                              OpcUa_True,
+                                              uFirstPart + uSecondPart,
+                                              uFirstPart + uSecondPart,
                                               OpcUa_False,
+                                              OpcUa_True,
                                               a_pMessageLine);
         OpcUa_GotoErrorIfBad(uStatus);
+        pLineContent = OpcUa_Null;
+    }
 
-        uStatus = OpcUa_String_AttachToString((OpcUa_CharA*)pHttpInputStream->Buffer[uCurrentReadBuffer].Data,
-                                              LineEnd - 2,
-                                              LineEnd - 2,
-                                              OpcUa_False,
-                                              OpcUa_False,
-                                              &sTemp);
-        OpcUa_GotoErrorIfBad(uStatus);
-
-        uStatus = OpcUa_String_StrnCat( a_pMessageLine,
-                                        &sTemp,
-                                        LineEnd - 2); /* do not include CR and LF characters into the resulting string */
-        OpcUa_GotoErrorIfBad(uStatus);
-
-        pHttpInputStream->nCurrentReadBuffer = uCurrentReadBuffer;
+    /* consume the line including CR and LF */
+    if(pNextBuffer != OpcUa_Null)
+    {
+        pBuffer->Position     = pBuffer->EndOfData;
+        pNextBuffer->Position = (OpcUa_UInt32)(pLineFeed - (OpcUa_CharA*)pNextBuffer->Data) + 1;
+        uCurrentReadBuffer++;
+    }
+    else
+    {
+        pBuffer->Position = uLineStart + uFirstPart + 2;
     }
 
+    pHttpInputStream->nCurrentReadBuffer = uCurrentReadBuffer;
+
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
 
     if(OpcUa_IsBad(uStatus))
     {
-        OpcUa_Trace(OPCUA_TRACE_LEVEL_WARNING, "OpcUa_HttpsStream_ReadLine: Error reading HTTP protocol line. %u character read.\n", uCharCount);
+        OpcUa_Trace(OPCUA_TRACE_LEVEL_WARNING, "OpcUa_HttpsStream_ReadLine: Error reading HTTP protocol line. %u character read.\n", uFirstPart + uSecondPart);
     }
 
-    if(uCurrentReadBuffer > pHttpInputStream->nCurrentReadBuffer)
+    if(pLineContent != OpcUa_Null)
     {
-        OpcUa_Buffer_SetPosition(&pHttpInputStream->Buffer[uCurrentReadBuffer], 0);
+        OpcUa_Free(pLineContent);
     }
 
-    OpcUa_Buffer_SetPosition(&pHttpInputStream->Buffer[pHttpInputStream->nCurrentReadBuffer],
-                             LineStart);
-
     OpcUa_String_Clear(a_pMessageLine);
 
 OpcUa_FinishErrorHandling;
@@ -2328,10 +2691,10 @@ static OpcUa_StatusCode OpcUa_HttpsStream_ReadChunkLength(  OpcUa_InputStream*
                                                             OpcUa_Int32*        a_piChunkLength)
 {
     OpcUa_String            sChunkHeader        = OPCUA_STRING_STATICINITIALIZER;
-    OpcUa_Int               iResult             = 0;
-#if !OPCUA_HTTPS_COPYHEADERS
-    OpcUa_CharA             chRawString[20];
-#endif
+    const OpcUa_CharA*      pChunkHeader        = OpcUa_Null;
+    OpcUa_UInt32            uHeaderLength       = 0;
+    OpcUa_UInt32            uDigits             = 0;
+    OpcUa_UInt32            uChunkLength        = 0;
 
 OpcUa_InitializeStatus(OpcUa_Module_HttpStream, "ReadChunkLength");
 
@@ -2351,20 +2714,27 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpStream, "ReadChunkLength");
         OpcUa_GotoError;
     }
 
-#if OPCUA_HTTPS_COPYHEADERS
-    iResult = OpcUa_SScanfA(OpcUa_String_GetRawString(&sChunkHeader), "%X", a_piChunkLength);
-#else
-    OpcUa_MemSet(chRawString, 0, sizeof(chRawString));
-    uStatus = OpcUa_MemCpy(chRawString, sizeof(chRawString)-1, OpcUa_String_GetRawString(&sChunkHeader), OpcUa_String_StrSize(&sChunkHeader));
-    OpcUa_GotoErrorIfBad(uStatus);
-    iResult = OpcUa_SScanfA(chRawString, "%X", a_piChunkLength);
-#endif
-    if((iResult != 1) || (*a_piChunkLength < 0) || (*a_piChunkLength > OPCUA_HTTPS_MAX_RECV_MESSAGE_LENGTH))
+    /* the size is parsed in place; chunk extensions after it are ignored */
+    pChunkHeader  = OpcUa_String_GetRawString(&sChunkHeader);
+    uHeaderLength = OpcUa_String_StrSize(&sChunkHeader);
+    if(pChunkHeader != OpcUa_Null)
+    {
+        uDigits = OpcUa_Https_ParseNumber(pChunkHeader, uHeaderLength, 16,
+                                          OPCUA_HTTPS_MAX_RECV_MESSAGE_LENGTH, &uChunkLength);
+    }
+
+    if(     uDigits == 0
+        || (    uDigits < uHeaderLength
+            &&  pChunkHeader[uDigits] != ';'
+            &&  pChunkHeader[uDigits] != ' '
+            &&  pChunkHeader[uDigits] != '\t'))
     {
         OpcUa_Trace(OPCUA_TRACE_LEVEL_WARNING, "OpcUa_HttpsStream_ReadChunkLength: Chunk size could not be read!\n");
         OpcUa_GotoErrorWithStatus(OpcUa_BadRequestHeaderInvalid);
     }
 
+    *a_piChunkLength = (OpcUa_Int32)uChunkLength;
+
     OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsStream_ReadChunkLength: chunk length is %i.\n", *a_piChunkLength);
 
     OpcUa_String_Clear(&sChunkHeader);
@@ -2387,6 +2757,10 @@ static OpcUa_StatusCode OpcUa_HttpsStream_ProcessHeaders(
     OpcUa_HttpsInputStream* pHttpInputStream    = OpcUa_Null;
     OpcUa_HttpsHeader*      pHttpHeader         = OpcUa_Null;
     OpcUa_Boolean           bLengthValid        = OpcUa_False;
+    const OpcUa_CharA*      pValue              = OpcUa_Null;
+    OpcUa_UInt32            uValueLength        = 0;
+    OpcUa_UInt32            uDigits             = 0;
+    OpcUa_UInt32            uContentLength      = 0;
 
 OpcUa_InitializeStatus(OpcUa_Module_HttpStream, "ProcessHeaders");
 
@@ -2403,7 +2777,7 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpStream, "ProcessHeaders");
     while(pHttpHeader != OpcUa_Null)
     {
         /* check for content length header */
-        if(OpcUa_String_StrnCmp(&pHttpHeader->Name, OpcUa_String_FromCString("Content-Length"), OPCUA_STRING_LENDONTCARE, OpcUa_True) == 0)
+        if(OpcUa_Https_IsToken(&pHttpHeader->Name, "content-length", 14))
         {
             if(OpcUa_String_IsEmpty(&pHttpHeader->Value))
             {
@@ -2413,13 +2787,25 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpStream, "ProcessHeaders");
             /* error if content length already set by other header. */
             OpcUa_GotoErrorIfTrue((pHttpInputStream->iContentLength != 0), OpcUa_BadRequestHeaderInvalid);
 
-            pHttpInputStream->iContentLength = (OpcUa_Int32)OpcUa_CharAToInt(OpcUa_String_GetRawString(&pHttpHeader->Value));
-            OpcUa_GotoErrorIfTrue((pHttpInputStream->iContentLength <= 0), OpcUa_BadRequestHeaderInvalid);
+            /* the value is not zero terminated if headers are not copied */
+            pValue       = OpcUa_String_GetRawString(&pHttpHeader->Value);
+            uValueLength = OpcUa_String_StrSize(&pHttpHeader->Value);
+            uDigits      = OpcUa_Https_ParseNumber(pValue, uValueLength, 10,
+                                                   OPCUA_HTTPS_MAX_RECV_MESSAGE_LENGTH, &uContentLength);
+            OpcUa_GotoErrorIfTrue((uDigits == 0 || uContentLength == 0), OpcUa_BadRequestHeaderInvalid);
+
+            while(uDigits < uValueLength)
+            {
+                OpcUa_GotoErrorIfTrue((pValue[uDigits] != ' ' && pValue[uDigits] != '\t'), OpcUa_BadRequestHeaderInvalid);
+                uDigits++;
+            }
+
+            pHttpInputStream->iContentLength = (OpcUa_Int32)uContentLength;
             bLengthValid = OpcUa_True;
         }
 
         /* check for transfer encoding header. */
-        if(OpcUa_String_StrnCmp(&pHttpHeader->Name, OpcUa_String_FromCString("Transfer-Encoding"), OPCUA_STRING_LENDONTCARE, OpcUa_True) == 0)
+        if(OpcUa_Https_IsToken(&pHttpHeader->Name, "transfer-encoding", 17))
         {
             if(OpcUa_String_IsEmpty(&pHttpHeader->Value))
             {
@@ -2598,57 +2984,67 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpStream, "DataReady");
             OpcUa_GotoErrorIfBad(uStatus);
         }
 
-        if(pHttpInputStream->Buffer[pHttpInputStream->nBuffers].EndOfData < pHttpInputStream->Buffer[pHttpInputStream->nBuffers].Size)
+        if(pHttpInputStream->bPreloaded != OpcUa_False)
         {
-            /* calculate length of data to read */
-            if(pHttpInputStream->State == OpcUa_HttpsStream_State_Body &&
-               pHttpInputStream->iContentLength > 0)
-            {
-                uActualLength = pHttpInputStream->Buffer[pHttpInputStream->nBuffers].EndOfData - pHttpInputStream->Buffer[pHttpInputStream->nBuffers].Position;
-                uExpectedLength = pHttpInputStream->iContentLength - uActualLength;
-            }
-            else
-            {
-                uExpectedLength = pHttpInputStream->Buffer[pHttpInputStream->nBuffers].Size - pHttpInputStream->Buffer[pHttpInputStream->nBuffers].EndOfData;
-            }
+            /* parse the pipelined data received with the previous message first */
+            pHttpInputStream->bPreloaded = OpcUa_False;
+            uActualLength = 0;
+            uStatus = OpcUa_Good;
         }
         else
         {
-            /* last buffer is filled - switch to the next one if possible */
-            if(pHttpInputStream->nBuffers < OPCUA_HTTPS_MAX_RECV_BUFFER_COUNT - 1)
+            if(pHttpInputStream->Buffer[pHttpInputStream->nBuffers].EndOfData < pHttpInputStream->Buffer[pHttpInputStream->nBuffers].Size)
             {
-                /* This is a new stream and a new message. */
-                OpcUa_Byte* pBufferData = (OpcUa_Byte*)OpcUa_Alloc(OPCUA_HTTPS_MAX_RECV_BUFFER_LENGTH);
-                OpcUa_GotoErrorIfAllocFailed(pBufferData);
-
-                OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsStream_DataReady: Preparing new buffer of size %u.\n", OPCUA_HTTPS_MAX_RECV_BUFFER_LENGTH);
-
-                /* skip current receive buffer index. */
-                pHttpInputStream->nBuffers++;
-
-                uStatus = OpcUa_Buffer_Initialize(&pHttpInputStream->Buffer[pHttpInputStream->nBuffers],
-                                                  pBufferData,
-                                                  0,
-                                                  OPCUA_HTTPS_MAX_RECV_BUFFER_LENGTH,
-                                                  OPCUA_HTTPS_MAX_RECV_BUFFER_LENGTH,
-                                                  OpcUa_True);
-                if(OpcUa_IsBad(uStatus))
+                /* calculate length of data to read */
+                if(pHttpInputStream->State == OpcUa_HttpsStream_State_Body &&
+                   pHttpInputStream->iContentLength > 0)
                 {
-                    OpcUa_Buffer_Clear(&pHttpInputStream->Buffer[pHttpInputStream->nBuffers]);
-                    OpcUa_ReturnStatusCode;
+                    uActualLength = pHttpInputStream->Buffer[pHttpInputStream->nBuffers].EndOfData - pHttpInputStream->Buffer[pHttpInputStream->nBuffers].Position;
+                    uExpectedLength = pHttpInputStream->iContentLength - uActualLength;
+                }
+                else
+                {
+                    uExpectedLength = pHttpInputStream->Buffer[pHttpInputStream->nBuffers].Size - pHttpInputStream->Buffer[pHttpInputStream->nBuffers].EndOfData;
                 }
-
-                OpcUa_Buffer_SetEmpty(&pHttpInputStream->Buffer[pHttpInputStream->nBuffers]);
-                uExpectedLength = OPCUA_HTTPS_MAX_RECV_BUFFER_LENGTH;
             }
             else
             {
-                OpcUa_GotoErrorWithStatus(OpcUa_BadRequestTooLarge);
+                /* last buffer is filled - switch to the next one if possible */
+                if(pHttpInputStream->nBuffers < OPCUA_HTTPS_MAX_RECV_BUFFER_COUNT - 1)
+                {
+                    /* This is a new stream and a new message. */
+                    OpcUa_Byte* pBufferData = (OpcUa_Byte*)OpcUa_Alloc(OPCUA_HTTPS_MAX_RECV_BUFFER_LENGTH);
+                    OpcUa_GotoErrorIfAllocFailed(pBufferData);
+
+                    OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsStream_DataReady: Preparing new buffer of size %u.\n", OPCUA_HTTPS_MAX_RECV_BUFFER_LENGTH);
+
+                    /* skip current receive buffer index. */
+                    pHttpInputStream->nBuffers++;
+
+                    uStatus = OpcUa_Buffer_Initialize(&pHttpInputStream->Buffer[pHttpInputStream->nBuffers],
+                                                      pBufferData,
+                                                      0,
+                                                      OPCUA_HTTPS_MAX_RECV_BUFFER_LENGTH,
+                                                      OPCUA_HTTPS_MAX_RECV_BUFFER_LENGTH,
+                                                      OpcUa_True);
+                    if(OpcUa_IsBad(uStatus))
+                    {
+                        OpcUa_Buffer_Clear(&pHttpInputStream->Buffer[pHttpInputStream->nBuffers]);
+                        OpcUa_ReturnStatusCode;
+                    }
+
+                    OpcUa_Buffer_SetEmpty(&pHttpInputStream->Buffer[pHttpInputStream->nBuffers]);
+                    uExpectedLength = OPCUA_HTTPS_MAX_RECV_BUFFER_LENGTH;
+                }
+                else
+                {
+                    OpcUa_GotoErrorWithStatus(OpcUa_BadRequestTooLarge);
+                }
             }
-        }
 
-        /* receive data from the network */
-        uStatus = OpcUa_HttpsStream_Receive(a_pInputStream, uExpectedLength, &uActualLength);
+            /* receive data from the network */
+            uStatus = OpcUa_HttpsStream_Receive(a_pInputStream, uExpectedLength, &uActualLength);
+        }
 
         /* check if all bytes were read or more are available. */
         if(OpcUa_IsEqual(OpcUa_GoodCallAgain))
@@ -2772,6 +3168,14 @@ OpcUa_InitializeStatus(OpcUa_Module_HttpStream, "DataReady");
                     pHttpInputStream->iCurrentChunkDataReceived = pHttpInputStream->Buffer[pHttpInputStream->nBuffers].EndOfData - pHttpInputStream->Buffer[pHttpInputStream->nBuffers].Position;
                     uActualLength = 0;
                 }
+                else
+                {
+                    /* message without body; anything behind the header belongs to the next message */
+                    uStatus = OpcUa_HttpsStream_KeepPipelinedData(pHttpInputStream,
+                                                                  pHttpInputStream->nCurrentReadBuffer,
+                                                                  pHttpInputStream->Buffer[pHttpInputStream->nCurrentReadBuffer].Position);
+                    OpcUa_GotoErrorIfBad(uStatus);
+                }
             }
             /* fall thru */
             case OpcUa_HttpsStream_State_Body:/******************************************************************************/
@@ -2793,6 +3197,17 @@ OpcUa_HttpsStream_State_Body:
                         uStatus = OpcUa_GoodCallAgain;
                         break;
                     }
+
+                    if(pHttpInputStream->iCurrentChunkDataReceived > pHttpInputStream->iContentLength)
+                    {
+                        /* the surplus was received with the last read and belongs to the next message */
+                        uStatus = OpcUa_HttpsStream_KeepPipelinedData(pHttpInputStream,
+                                                                      pHttpInputStream->nBuffers,
+                                                                      pHttpInputStream->Buffer[pHttpInputStream->nBuffers].EndOfData
+                                                                      - (OpcUa_UInt32)(pHttpInputStream->iCurrentChunkDataReceived - pHttpInputStream->iContentLength));
+                        OpcUa_GotoErrorIfBad(uStatus);
+                        pHttpInputStream->iCurrentChunkDataReceived = pHttpInputStream->iContentLength;
+                    }
                 }
                 else if(pHttpInputStream->iContentLength < 0)
                 {
@@ -2877,6 +3292,11 @@ OpcUa_HttpsStream_State_Footers:
                     OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_HttpsStream_DataReady: Data in %u buffers complete.\n", pHttpInputStream->nBuffers + 1);
                     pHttpInputStream->State = OpcUa_HttpsStream_State_MessageComplete;
 
+                    uStatus = OpcUa_HttpsStream_KeepPipelinedData(pHttpInputStream,
+                                                                  pHttpInputStream->nCurrentReadBuffer,
+                                                                  pHttpInputStream->Buffer[pHttpInputStream->nCurrentReadBuffer].Position);
+                    OpcUa_GotoErrorIfBad(uStatus);
+
                     /* reset state variables to prepare stream for reading */
                     pHttpInputStream->Buffer[0].Position = 0;
                     pHttpInputStream->nCurrentReadBuffer = 0;
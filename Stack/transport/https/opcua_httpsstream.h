@@ -110,6 +110,17 @@ OPCUA_EXPORT OpcUa_StatusCode OpcUa_HttpsStream_CreateInput(
     OpcUa_HttpsStream_MessageType   a_eMessageType,
     OpcUa_InputStream**             a_ppInputStream);
 
+/*============================================================================
+ * OpcUa_HttpsStream_CreatePipelinedInput
+ *===========================================================================*/
+/** @brief Creates the stream for the message received behind a complete message.
+ *  @param a_pInputStream       [in]  The stream holding a complete message.
+ *  @param a_ppNextInputStream  [out] The stream preloaded with the pipelined data or OpcUa_Null if there is none.
+ */
+OpcUa_StatusCode OpcUa_HttpsStream_CreatePipelinedInput(
+    OpcUa_InputStream*              a_pInputStream,
+    OpcUa_InputStream**             a_ppNextInputStream);
+
 /*============================================================================
  * OpcUa_HttpsStream_CreateRequest
  *===========================================================================*/
@@ -238,6 +249,45 @@ OpcUa_StatusCode OpcUa_HttpsStream_GetState(
     OpcUa_InputStream*       a_pInputStream,
     OpcUa_HttpsStream_State* a_pStreamState);
 
+/*============================================================================
+ * OpcUa_HttpsStream_SetSequenceNumber
+ *===========================================================================*/
+/** @brief Sets the position of the message in the request order of its connection. */
+OpcUa_StatusCode OpcUa_HttpsStream_SetSequenceNumber(
+    OpcUa_Stream*   a_pStream,
+    OpcUa_UInt32    a_uSequenceNumber);
+
+/*============================================================================
+ * OpcUa_HttpsStream_GetSequenceNumber
+ *===========================================================================*/
+/** @brief Gets the position of the message in the request order of its connection. */
+OpcUa_StatusCode OpcUa_HttpsStream_GetSequenceNumber(
+    OpcUa_Stream*   a_pStream,
+    OpcUa_UInt32*   a_puSequenceNumber);
+
+/*============================================================================
+ * OpcUa_HttpsStream_SetSecurityPolicy
+ *===========================================================================*/
+/** @brief Stores a copy of the security policy requested with the message being answered. */
+OpcUa_StatusCode OpcUa_HttpsStream_SetSecurityPolicy(
+    OpcUa_OutputStream* a_pOutputStream,
+    OpcUa_String*       a_pSecurityPolicy);
+
+/*============================================================================
+ * OpcUa_HttpsStream_GetSecurityPolicy
+ *===========================================================================*/
+/** @brief Gets the security policy of the response; it lives as long as the stream. */
+OpcUa_StatusCode OpcUa_HttpsStream_GetSecurityPolicy(
+    OpcUa_OutputStream* a_pOutputStream,
+    OpcUa_String**      a_ppSecurityPolicy);
+
+/*============================================================================
+ * OpcUa_HttpsStream_Finish
+ *===========================================================================*/
+/** @brief Completes the message like Close but leaves all data in the stream
+ *         buffers, so they can be detached and sent later. */
+OpcUa_StatusCode OpcUa_HttpsStream_Finish(OpcUa_OutputStream* a_pOutputStream);
+
 /*============================================================================
 * OpcUa_HttpsStream_SetSocket
 *===========================================================================*/
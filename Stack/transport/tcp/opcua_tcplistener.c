@@ -25,6 +25,7 @@
 #include <opcua_statuscodes.h>
 #include <opcua_list.h>
 #include <opcua_utilities.h>
+#include <opcua_latency.h>
 
 #include <opcua_tcpstream.h>
 #include <opcua_binaryencoder.h>
@@ -107,6 +108,14 @@ OpcUa_StatusCode OpcUa_TcpListener_CheckProtocolVersion(
     OpcUa_Handle                    a_hConnection,
     OpcUa_UInt32                    a_uProtocolVersion);
 
+OpcUa_StatusCode OpcUa_TcpListener_AddConnectionReference(
+    OpcUa_Listener*                 a_pListener,
+    OpcUa_Handle                    a_hConnection);
+
+OpcUa_StatusCode OpcUa_TcpListener_ReleaseConnectionReference(
+    OpcUa_Listener*                 a_pListener,
+    OpcUa_Handle                    a_hConnection);
+
 /*============================================================================
  * OpcUa_TcpListener_SanityCheck
  *===========================================================================*/
@@ -241,6 +250,8 @@ OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "Create");
     (*a_pListener)->AddToSendQueue          = OpcUa_TcpListener_AddToSendQueue;
     (*a_pListener)->GetPeerInfo             = OpcUa_TcpListener_GetPeerInfo;
     (*a_pListener)->CheckProtocolVersion    = OpcUa_TcpListener_CheckProtocolVersion;
+    (*a_pListener)->AddConnectionReference  = OpcUa_TcpListener_AddConnectionReference;
+    (*a_pListener)->ReleaseConnectionReference = OpcUa_TcpListener_ReleaseConnectionReference;
 
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
@@ -369,6 +380,33 @@ OpcUa_BeginErrorHandling;
 OpcUa_FinishErrorHandling;
 }
 
+/*============================================================================
+ * OpcUa_TcpListener_GetConnectionCounters
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_TcpListener_GetConnectionCounters(   OpcUa_Listener*                 a_pListener,
+                                                            OpcUa_UInt32                    a_uMaxCounters,
+                                                            OpcUa_TcpConnectionCounters*    a_pCounters,
+                                                            OpcUa_UInt32*                   a_pNoOfCounters)
+{
+    OpcUa_TcpListener*  pTcpListener = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "GetConnectionCounters");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_pListener);
+    OpcUa_ReturnErrorIfArgumentNull(a_pListener->Handle);
+
+    pTcpListener = (OpcUa_TcpListener*)a_pListener->Handle;
+
+    uStatus = OpcUa_TcpListener_ConnectionManager_GetConnectionCounters(pTcpListener->ConnectionManager,
+                                                                        a_uMaxCounters,
+                                                                        a_pCounters,
+                                                                        a_pNoOfCounters);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
 
 /*============================================================================
  * OpcUa_TcpListener_CheckProtocolVersion
@@ -384,6 +422,9 @@ OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "CheckProtocolVersion");
     OpcUa_ReturnErrorIfArgumentNull(a_hConnection);
     OpcUa_ReferenceParameter(a_pListener);
 
+    /* a referenced connection outlives its disconnect */
+    OpcUa_GotoErrorIfTrue((pTcpListenerConnection->bConnected == OpcUa_False), OpcUa_BadConnectionClosed);
+
     if(a_uProtocolVersion != pTcpListenerConnection->uProtocolVersion)
     {
         OpcUa_GotoErrorWithStatus(OpcUa_BadProtocolVersionUnsupported);
@@ -394,6 +435,55 @@ OpcUa_BeginErrorHandling;
 OpcUa_FinishErrorHandling;
 }
 
+/*============================================================================
+ * OpcUa_TcpListener_AddConnectionReference
+ *===========================================================================*/
+/** @brief Keep the connection object alive for a worker thread. */
+OpcUa_StatusCode OpcUa_TcpListener_AddConnectionReference(OpcUa_Listener*   a_pListener,
+                                                          OpcUa_Handle      a_hConnection)
+{
+    OpcUa_TcpListener* pTcpListener = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "AddConnectionReference");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_pListener);
+    OpcUa_ReturnErrorIfArgumentNull(a_hConnection);
+
+    pTcpListener = (OpcUa_TcpListener*)a_pListener->Handle;
+
+    OpcUa_TcpListener_ConnectionManager_AddReference(   pTcpListener->ConnectionManager,
+                                                        (OpcUa_TcpListener_Connection*)a_hConnection);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * OpcUa_TcpListener_ReleaseConnectionReference
+ *===========================================================================*/
+/** @brief Release a reference taken with OpcUa_TcpListener_AddConnectionReference. */
+OpcUa_StatusCode OpcUa_TcpListener_ReleaseConnectionReference(OpcUa_Listener*   a_pListener,
+                                                              OpcUa_Handle      a_hConnection)
+{
+    OpcUa_TcpListener*              pTcpListener            = OpcUa_Null;
+    OpcUa_TcpListener_Connection*   pTcpListenerConnection  = (OpcUa_TcpListener_Connection*)a_hConnection;
+
+OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "ReleaseConnectionReference");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_pListener);
+    OpcUa_ReturnErrorIfArgumentNull(a_hConnection);
+
+    pTcpListener = (OpcUa_TcpListener*)a_pListener->Handle;
+
+    OpcUa_TcpListener_ConnectionManager_ReleaseConnection(  pTcpListener->ConnectionManager,
+                                                            &pTcpListenerConnection);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
 
 /*============================================================================
  * OpcUa_TcpListener_CloseConnection
@@ -431,8 +521,10 @@ OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "CloseConnection");
 
     if(OpcUa_IsGood(uStatus))
     {
+        pTcpListenerConnection->bConnected = OpcUa_False;
         uStatus = OPCUA_P_SOCKET_CLOSE(pTcpListenerConnection->Socket);
-        OpcUa_TcpListener_Connection_Delete(&pTcpListenerConnection);
+        OpcUa_TcpListener_ConnectionManager_ReleaseConnection(  pTcpListener->ConnectionManager,
+                                                                &pTcpListenerConnection);
     }
     else
     {
@@ -460,6 +552,24 @@ static OpcUa_Void OpcUa_TcpListener_ConnectionDisconnectCB(OpcUa_Handle a_hConne
     OpcUa_Trace(OPCUA_TRACE_LEVEL_INFO, "OpcUa_TcpListener_ConnectionDisconnectCB: Connection %p is being reported as disconnected!\n", a_hConnection);
 }
 
+/*============================================================================
+ * OpcUa_TcpListener_CountOutput
+ *===========================================================================*/
+/** @brief Adds what an outstream wrote to the socket to the counters of the connection. */
+static OpcUa_Void OpcUa_TcpListener_CountOutput(OpcUa_TcpListener_Connection*   a_pTcpConnection,
+                                                OpcUa_OutputStream*             a_pOstrm)
+{
+    OpcUa_TcpOutputStream* pTcpOutputStream = (OpcUa_TcpOutputStream*)a_pOstrm->Handle;
+
+    if(a_pTcpConnection != OpcUa_Null && pTcpOutputStream != OpcUa_Null)
+    {
+        OpcUa_TcpListener_Connection_AddCounter(a_pTcpConnection, BytesOut, pTcpOutputStream->BytesWritten);
+        OpcUa_TcpListener_Connection_AddCounter(a_pTcpConnection, ChunksOut, pTcpOutputStream->ChunksWritten);
+        pTcpOutputStream->BytesWritten  = 0;
+        pTcpOutputStream->ChunksWritten = 0;
+    }
+}
+
 /*============================================================================
  * OpcUa_TcpListener_BeginSendResponse
  *===========================================================================*/
@@ -490,6 +600,9 @@ OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "BeginSendResponse");
     (*a_ppTransportIStrm)->Close((OpcUa_Stream*)(*a_ppTransportIStrm));
     (*a_ppTransportIStrm)->Delete((OpcUa_Stream**)a_ppTransportIStrm);
 
+    /* a referenced connection outlives its disconnect; its socket does not */
+    OpcUa_ReturnErrorIfTrue((pTcpListenerConnection->bConnected == OpcUa_False), OpcUa_BadConnectionClosed);
+
     /* create buffer for writing */
     uStatus = OpcUa_TcpStream_CreateOutput( pTcpListenerConnection->Socket,            /* create stream on that socket */
                                             OpcUa_TcpStream_MessageType_SecureChannel, /* initialize as chunk */
@@ -608,6 +721,7 @@ OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "SendErrorMessage");
             0);
         OpcUa_Buffer_Clear(&Buffer);
     }
+    OpcUa_TcpListener_CountOutput(a_pTcpConnection, pOutputStream);
     OpcUa_GotoErrorIfBad(uStatus);
 
     /* finish stream and delete it */
@@ -635,6 +749,8 @@ OpcUa_StatusCode OpcUa_TcpListener_EndSendResponse(
     OpcUa_StatusCode        a_uStatus,
     OpcUa_OutputStream**    a_ppOstrm)
 {
+    OpcUa_TcpListener_Connection*   pTcpListenerConnection  = OpcUa_Null;
+
 OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "OpcUa_TcpListener_EndSendResponse");
 
     OpcUa_ReturnErrorIfArgumentNull(a_pListener);
@@ -645,6 +761,8 @@ OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "OpcUa_TcpListener_EndSendRespo
 
     OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_TcpListener_EndSendResponse: Status 0x%08X\n", a_uStatus);
 
+    pTcpListenerConnection = (OpcUa_TcpListener_Connection*)((OpcUa_TcpOutputStream*)(*a_ppOstrm)->Handle)->hConnection;
+
     /* trigger error message */
     if(OpcUa_IsGood(a_uStatus))
     {
@@ -652,6 +770,13 @@ OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "OpcUa_TcpListener_EndSendRespo
         uStatus = (*a_ppOstrm)->Close((OpcUa_Stream*)*a_ppOstrm);
     }
 
+    OpcUa_TcpListener_CountOutput(pTcpListenerConnection, *a_ppOstrm);
+
+    if(OpcUa_IsBad(uStatus) && OpcUa_IsNotEqual(OpcUa_BadWouldBlock) && pTcpListenerConnection != OpcUa_Null)
+    {
+        OpcUa_TcpListener_Connection_AddCounter(pTcpListenerConnection, Errors, 1);
+    }
+
     /* delete without flushing and decrement request count */
     OpcUa_TcpStream_Delete((OpcUa_Stream**)a_ppOstrm);
 
@@ -679,6 +804,13 @@ OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "OpcUa_TcpListener_AbortSendRes
 
     if(a_ppOutputStream != OpcUa_Null)
     {
+        if(*a_ppOutputStream != OpcUa_Null)
+        {
+            /* chunks of the aborted message may already be on the wire */
+            OpcUa_TcpListener_CountOutput((OpcUa_TcpListener_Connection*)((OpcUa_TcpOutputStream*)(*a_ppOutputStream)->Handle)->hConnection,
+                                          *a_ppOutputStream);
+        }
+
         /* clean up */
         OpcUa_TcpStream_Delete((OpcUa_Stream**)a_ppOutputStream);
     }
@@ -929,6 +1061,7 @@ OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "SendAcknowledgeMessage");
             OPCUA_LISTENER_NO_RCV_UNTIL_DONE);
         OpcUa_Buffer_Clear(&Buffer);
     }
+    OpcUa_TcpListener_CountOutput(a_pTcpConnection, pOutputStream);
     OpcUa_GotoErrorIfBad(uStatus);
 
     uStatus = pOutputStream->Close((OpcUa_Stream*)pOutputStream);
@@ -1179,7 +1312,9 @@ OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "ProcessDisconnect");
 
     OPCUA_P_MUTEX_UNLOCK(a_pTcpConnection->Mutex);
 
-    OpcUa_TcpListener_Connection_Delete(&a_pTcpConnection);
+    /* workers may still reference the connection */
+    OpcUa_TcpListener_ConnectionManager_ReleaseConnection(  pTcpListener->ConnectionManager,
+                                                            &a_pTcpConnection);
 
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
@@ -1207,6 +1342,7 @@ OpcUa_StatusCode OpcUa_TcpListener_ReadEventHandler(
     OpcUa_TcpListener_Connection*   pTcpListenerConnection  = OpcUa_Null;
     OpcUa_InputStream*              pInputStream            = OpcUa_Null;
     OpcUa_TcpInputStream*           pTcpInputStream         = OpcUa_Null;
+    OpcUa_UInt64                    uLatencyStart           = 0;
 
 OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "ReadEventHandler");
 
@@ -1277,7 +1413,10 @@ OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "ReadEventHandler");
     /******************************************************************************************************/
 
     /* now, we have a stream -> read the available data; further processing takes place in the callback */
+    /* the stage covers the socket reads only; decoding and dispatching below are measured by their own stages */
+    uLatencyStart = OpcUa_Latency_Begin();
     uStatus = OpcUa_TcpStream_DataReady(pInputStream);
+    OpcUa_Latency_End(OpcUa_LatencyStage_TransportReceive, 0, uLatencyStart);
 
     /******************************************************************************************************/
 
@@ -1374,6 +1513,9 @@ OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "ReadEventHandler");
 
                     if(pTcpListenerConnection != OpcUa_Null)
                     {
+                        OpcUa_TcpListener_Connection_AddCounter(pTcpListenerConnection, ChunksIn, 1);
+                        OpcUa_TcpListener_Connection_AddCounter(pTcpListenerConnection, BytesIn, pTcpInputStream->MessageLength);
+
                         uStatus = OpcUa_TcpListener_ProcessRequest( a_pListener,
                                                                     pTcpListenerConnection,
                                                                     &pInputStream);
@@ -1390,6 +1532,7 @@ OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "ReadEventHandler");
                             /* this is probably intended: mask trace to make it not look like an error */
                             if(OpcUa_IsNotEqual(OpcUa_BadDisconnect))
                             {
+                                OpcUa_TcpListener_Connection_AddCounter(pTcpListenerConnection, Errors, 1);
                                 OpcUa_Trace(OPCUA_TRACE_LEVEL_WARNING, "OpcUa_TcpListener_ReadEventHandler: Process Request returned an error (0x%08X)!\n", uStatus);
                             }
                         }
@@ -1427,6 +1570,11 @@ OpcUa_BeginErrorHandling;
 
     if(pTcpListenerConnection != OpcUa_Null)
     {
+        if(OpcUa_IsNotEqual(OpcUa_BadDisconnect) && OpcUa_IsNotEqual(OpcUa_BadConnectionClosed))
+        {
+            OpcUa_TcpListener_Connection_AddCounter(pTcpListenerConnection, Errors, 1);
+        }
+
         /* Notify about connection loss. */
         OpcUa_TcpListener_ProcessDisconnect(    a_pListener,
                                                 pTcpListenerConnection);
@@ -1561,9 +1709,13 @@ OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "WriteEventHandler");
                                                                 OpcUa_False);
                 if(iDataWritten<0)
                 {
+                    OpcUa_TcpListener_Connection_AddCounter(pTcpListenerConnection, Errors, 1);
                     return OpcUa_TcpListener_TimeoutEventHandler(a_pListener, a_pSocket);
                 }
-                else if(iDataWritten<iDataLength)
+
+                OpcUa_TcpListener_Connection_AddCounter(pTcpListenerConnection, BytesOut, iDataWritten);
+
+                if(iDataWritten<iDataLength)
                 {
                     pCurrentBuffer->Buffer.Position += iDataWritten;
                     if((pTcpListenerConnection->bNoRcvUntilDone == OpcUa_False) &&
@@ -1576,6 +1728,7 @@ OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "WriteEventHandler");
                 }
                 else
                 {
+                    OpcUa_TcpListener_Connection_AddCounter(pTcpListenerConnection, ChunksOut, 1);
                     pTcpListenerConnection->pSendQueue = pCurrentBuffer->pNext;
                     OpcUa_Buffer_Clear(&pCurrentBuffer->Buffer);
                     OpcUa_Free(pCurrentBuffer);
@@ -1805,6 +1958,8 @@ OpcUa_Void OpcUa_TcpListener_ConnectionDeleteCallback(  OpcUa_Listener*
             a_pTcpConnection->Socket);
 #endif
 
+    a_pTcpConnection->bConnected = OpcUa_False;
+
     if(a_pTcpConnection->Socket != OpcUa_Null)
     {
         /* OPCUA_P_SOCKET_CLOSE(a_pTcpConnection->Socket); */
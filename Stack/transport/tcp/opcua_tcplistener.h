@@ -21,6 +21,28 @@
 
 OPCUA_BEGIN_EXTERN_C
 
+/**
+ * @brief Traffic counters of a connection accepted by a tcp listener.
+ *        Updated with atomic operations and readable while the connection is in use.
+ */
+typedef struct _OpcUa_TcpConnectionCounters
+{
+    /** @brief Address and port of the client. */
+    OpcUa_CharA         PeerInfo[OPCUA_P_PEERINFO_MIN_SIZE];
+    /** @brief The time when the connection was made. */
+    OpcUa_DateTime      ConnectTime;
+    /** @brief Bytes of the secure channel chunks received. */
+    OpcUa_UInt64        BytesIn;
+    /** @brief Bytes written to the socket. */
+    OpcUa_UInt64        BytesOut;
+    /** @brief Secure channel chunks received. */
+    OpcUa_UInt64        ChunksIn;
+    /** @brief Chunks completely written to the socket. */
+    OpcUa_UInt64        ChunksOut;
+    /** @brief Messages that could not be received or sent. */
+    OpcUa_UInt64        Errors;
+} OpcUa_TcpConnectionCounters;
+
 /**
   @brief Creates a new tcp listener object.
 
@@ -28,6 +50,20 @@ OPCUA_BEGIN_EXTERN_C
 */
 OPCUA_EXPORT OpcUa_StatusCode OpcUa_TcpListener_Create(OpcUa_Listener** listener);
 
+/**
+  @brief Copies the traffic counters of all connections of the listener.
+
+  @param pListener      [in]  The tcp listener.
+  @param uMaxCounters   [in]  Capacity of pCounters.
+  @param pCounters      [out] Receives the counters of one connection each.
+  @param pNoOfCounters  [out] Number of counters written.
+*/
+OpcUa_StatusCode OpcUa_TcpListener_GetConnectionCounters(
+    OpcUa_Listener*                 pListener,
+    OpcUa_UInt32                    uMaxCounters,
+    OpcUa_TcpConnectionCounters*    pCounters,
+    OpcUa_UInt32*                   pNoOfCounters);
+
 OPCUA_END_EXTERN_C
 
 #endif /* _OpcUa_TcpListener_H_ */
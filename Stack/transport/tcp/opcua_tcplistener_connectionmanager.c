@@ -194,6 +194,56 @@ OpcUa_StatusCode OpcUa_TcpListener_ConnectionManager_RemoveConnection(
 }
 
 
+/*==============================================================================*/
+/*                                                                              */
+/*==============================================================================*/
+/**
+* @brief Add a reference to a connection the caller already holds a reference to.
+*/
+OpcUa_Void OpcUa_TcpListener_ConnectionManager_AddReference(
+    OpcUa_TcpListener_ConnectionManager*    a_pConnectionManager,
+    OpcUa_TcpListener_Connection*           a_pConnection)
+{
+    OpcUa_List_Enter(a_pConnectionManager->Connections);
+    a_pConnection->iReferenceCount++;
+    OpcUa_List_Leave(a_pConnectionManager->Connections);
+}
+
+/*==============================================================================*/
+/*                                                                              */
+/*==============================================================================*/
+/**
+* @brief Release reference to given connection. The connection must already be
+* removed from the list when the last reference goes.
+*
+* @return: Status Code;
+*/
+OpcUa_StatusCode OpcUa_TcpListener_ConnectionManager_ReleaseConnection(
+    OpcUa_TcpListener_ConnectionManager*    a_pConnectionManager,
+    OpcUa_TcpListener_Connection**          a_ppConnection)
+{
+    /* OpcUa_GoodCallAgain indicates that connection still exists. */
+    OpcUa_StatusCode uStatus = OpcUa_GoodCallAgain;
+
+    OpcUa_List_Enter(a_pConnectionManager->Connections);
+
+    (*a_ppConnection)->iReferenceCount--;
+
+    if((*a_ppConnection)->iReferenceCount <= 0)
+    {
+        OpcUa_TcpListener_Connection_Delete(a_ppConnection);
+        uStatus = OpcUa_Good;
+    }
+    else
+    {
+        *a_ppConnection = OpcUa_Null;
+    }
+
+    OpcUa_List_Leave(a_pConnectionManager->Connections);
+
+    return uStatus;
+}
+
 /*==============================================================================*/
 /*                                                                              */
 /*==============================================================================*/
@@ -258,8 +308,8 @@ OpcUa_StatusCode OpcUa_TcpListener_ConnectionManager_RemoveConnections(
                                     tcpConnection);
         }
 
-        OpcUa_TcpListener_Connection_Delete((&tcpConnection));
         OpcUa_List_DeleteCurrentElement(a_pConnectionManager->Connections);
+        OpcUa_TcpListener_ConnectionManager_ReleaseConnection(a_pConnectionManager, &tcpConnection);
         tcpConnection = (OpcUa_TcpListener_Connection*)OpcUa_List_GetCurrentElement(a_pConnectionManager->Connections);
     }
 
@@ -293,6 +343,7 @@ OpcUa_StatusCode OpcUa_TcpListener_Connection_Create(OpcUa_TcpListener_Connectio
     OpcUa_MemSet(pConnection, 0, sizeof(OpcUa_TcpListener_Connection));
 
     pConnection->uCurrentChunk  = 0;
+    pConnection->iReferenceCount = 1;
 
     OpcUa_TcpListener_Connection_Initialize(pConnection);
 
@@ -345,6 +396,8 @@ OpcUa_StatusCode OpcUa_TcpListener_Connection_Initialize(OpcUa_TcpListener_Conne
     a_pConnection->bNoRcvUntilDone          = OpcUa_False;
     a_pConnection->bRcvDataPending          = OpcUa_False;
 
+    OpcUa_MemSet(&a_pConnection->Counters, 0, sizeof(OpcUa_TcpConnectionCounters));
+
     return OpcUa_Good;
 }
 
@@ -438,6 +491,76 @@ OpcUa_BeginErrorHandling;
 OpcUa_FinishErrorHandling;
 }
 
+/*==============================================================================*/
+/* OpcUa_TcpListener_ConnectionManager_GetConnectionCounters                    */
+/*==============================================================================*/
+OpcUa_StatusCode OpcUa_TcpListener_ConnectionManager_GetConnectionCounters(
+    OpcUa_TcpListener_ConnectionManager*    a_pConnectionManager,
+    OpcUa_UInt32                            a_uMaxCounters,
+    OpcUa_TcpConnectionCounters*            a_pCounters,
+    OpcUa_UInt32*                           a_pNoOfCounters)
+{
+    OpcUa_TcpListener_Connection*   pTmpConnection  = OpcUa_Null;
+    OpcUa_TcpConnectionCounters*    pTarget         = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "GetConnectionCounters");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_pConnectionManager);
+    OpcUa_ReturnErrorIfArgumentNull(a_pNoOfCounters);
+    OpcUa_ReturnErrorIfTrue(a_uMaxCounters > 0 && a_pCounters == OpcUa_Null, OpcUa_BadInvalidArgument);
+
+    *a_pNoOfCounters = 0;
+
+    /* the list lock only keeps the connections alive; the counters are read without stopping traffic */
+    OpcUa_List_Enter(a_pConnectionManager->Connections);
+
+    OpcUa_List_ResetCurrent(a_pConnectionManager->Connections);
+    pTmpConnection = (OpcUa_TcpListener_Connection*)OpcUa_List_GetCurrentElement(a_pConnectionManager->Connections);
+
+    while(pTmpConnection != OpcUa_Null)
+    {
+        if(*a_pNoOfCounters == a_uMaxCounters)
+        {
+            OpcUa_GotoErrorWithStatus(OpcUa_BadEncodingLimitsExceeded);
+        }
+
+        pTarget = &a_pCounters[(*a_pNoOfCounters)++];
+
+#if OPCUA_P_SOCKETGETPEERINFO_V2
+        OpcUa_MemCpy(pTarget->PeerInfo, OPCUA_P_PEERINFO_MIN_SIZE, pTmpConnection->achPeerInfo, OPCUA_P_PEERINFO_MIN_SIZE);
+#else /* OPCUA_P_SOCKETGETPEERINFO_V2 */
+        OpcUa_SPrintfA( pTarget->PeerInfo,
+#if OPCUA_USE_SAFE_FUNCTIONS
+                        OPCUA_P_PEERINFO_MIN_SIZE,
+#endif /* OPCUA_USE_SAFE_FUNCTIONS */
+                        "%u.%u.%u.%u:%u",
+                        (pTmpConnection->PeerIp >> 24) & 0xFF,
+                        (pTmpConnection->PeerIp >> 16) & 0xFF,
+                        (pTmpConnection->PeerIp >> 8) & 0xFF,
+                        pTmpConnection->PeerIp & 0xFF,
+                        pTmpConnection->PeerPort);
+#endif /* OPCUA_P_SOCKETGETPEERINFO_V2 */
+
+        pTarget->ConnectTime    = pTmpConnection->ConnectTime;
+        pTarget->BytesIn        = OpcUa_Atomic_Load64(&pTmpConnection->Counters.BytesIn);
+        pTarget->BytesOut       = OpcUa_Atomic_Load64(&pTmpConnection->Counters.BytesOut);
+        pTarget->ChunksIn       = OpcUa_Atomic_Load64(&pTmpConnection->Counters.ChunksIn);
+        pTarget->ChunksOut      = OpcUa_Atomic_Load64(&pTmpConnection->Counters.ChunksOut);
+        pTarget->Errors         = OpcUa_Atomic_Load64(&pTmpConnection->Counters.Errors);
+
+        pTmpConnection = (OpcUa_TcpListener_Connection*)OpcUa_List_GetNextElement(a_pConnectionManager->Connections);
+    }
+
+    OpcUa_List_Leave(a_pConnectionManager->Connections);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_List_Leave(a_pConnectionManager->Connections);
+
+OpcUa_FinishErrorHandling;
+}
+
 #endif /* OPCUA_HAVE_SERVERAPI */
 
 /*==============================================================================*/
@@ -69,10 +69,20 @@ struct _OpcUa_TcpListener_Connection
     OpcUa_Boolean       bNoRcvUntilDone;
     /** @brief Tells wether data has been delayed because of bNoRcvUntilDone. */
     OpcUa_Boolean       bRcvDataPending;
+    /** @brief The listener holds one reference until disconnect; workers may hold more. */
+    OpcUa_Int32         iReferenceCount;
+    /** @brief Traffic counters; only the numeric fields are maintained here. */
+    OpcUa_TcpConnectionCounters Counters;
 };
 
 typedef struct _OpcUa_TcpListener_Connection OpcUa_TcpListener_Connection;
 
+/**
+ * @brief Adds a value to a connection counter.
+ */
+#define OpcUa_TcpListener_Connection_AddCounter(xConnection, xCounter, xValue) \
+    OpcUa_Atomic_Add64((OpcUa_Int64*)&(xConnection)->Counters.xCounter, (OpcUa_Int64)(xValue))
+
 /** @brief Allocate and initialize a TcpListener_Connection */
 OpcUa_StatusCode        OpcUa_TcpListener_Connection_Create(              OpcUa_TcpListener_Connection**   ppConnection);
 
@@ -138,6 +148,16 @@ OpcUa_StatusCode        OpcUa_TcpListener_ConnectionManager_RemoveConnection(
     OpcUa_TcpListener_ConnectionManager*    ConnectionManager,
     OpcUa_TcpListener_Connection*           pConnection);
 
+/* @brief Add a reference to a connection the caller already holds a reference to. */
+OpcUa_Void              OpcUa_TcpListener_ConnectionManager_AddReference(
+    OpcUa_TcpListener_ConnectionManager*    ConnectionManager,
+    OpcUa_TcpListener_Connection*           pConnection);
+
+/* @brief Release reference to given connection and delete it with the last one. Pointer gets nulled on return. */
+OpcUa_StatusCode        OpcUa_TcpListener_ConnectionManager_ReleaseConnection(
+    OpcUa_TcpListener_ConnectionManager*    ConnectionManager,
+    OpcUa_TcpListener_Connection**          ppConnection);
+
 /* @brief Remove all connections managed by the listener and call the given function for everyone. */
 OpcUa_StatusCode        OpcUa_TcpListener_ConnectionManager_RemoveConnections(
     OpcUa_TcpListener_ConnectionManager*    ConnectionManager,
@@ -147,3 +167,10 @@ OpcUa_StatusCode        OpcUa_TcpListener_ConnectionManager_RemoveConnections(
 OpcUa_StatusCode        OpcUa_TcpListener_ConnectionManager_GetConnectionCount(
     OpcUa_TcpListener_ConnectionManager*    ConnectionManager,
     OpcUa_UInt32*                           pNoOfConnections);
+
+/* @brief Copies the traffic counters of all managed connections. */
+OpcUa_StatusCode        OpcUa_TcpListener_ConnectionManager_GetConnectionCounters(
+    OpcUa_TcpListener_ConnectionManager*    ConnectionManager,
+    OpcUa_UInt32                            uMaxCounters,
+    OpcUa_TcpConnectionCounters*            pCounters,
+    OpcUa_UInt32*                           pNoOfCounters);
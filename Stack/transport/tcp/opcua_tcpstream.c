@@ -337,6 +337,11 @@ OpcUa_InitializeStatus(OpcUa_Module_TcpStream, "Flush");
 
         pTcpOutputStream->NoOfFlushes++;
 
+        if(iDataWritten > 0)
+        {
+            pTcpOutputStream->BytesWritten += (OpcUa_UInt32)iDataWritten;
+        }
+
         if(iDataWritten < (OpcUa_Int32)tempDataLength)
         {
             if(iDataWritten < (OpcUa_Int32)0)
@@ -363,6 +368,8 @@ OpcUa_InitializeStatus(OpcUa_Module_TcpStream, "Flush");
             }
         }
 
+        pTcpOutputStream->ChunksWritten++;
+
         /* prepare new flags */
         if(a_bLastCall == OpcUa_False)
         {
@@ -173,6 +173,10 @@ struct _OpcUa_TcpOutputStream
     OpcUa_UInt32                        NoOfFlushes;
     /** @brief Maximum number of times this stream may flush its buffer. */
     OpcUa_UInt32                        MaxNoOfFlushes;
+    /** @brief Number of bytes this stream has written to the socket. */
+    OpcUa_UInt32                        BytesWritten;
+    /** @brief Number of chunks this stream has completely written to the socket. */
+    OpcUa_UInt32                        ChunksWritten;
     /** @brief Disconnect notification callback. */
     OpcUa_TcpStream_PfnNotifyDisconnect* NotifyDisconnect;
 };
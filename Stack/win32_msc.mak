@@ -24,13 +24,14 @@ OPENSSLINC = $(OPENSSLDIR)\include
 
 CFLAGS = /MT /Ox /W3 /Gs0 /GF /Gy /nologo /Zl /Zi /Fd$(TARGET).pdb \
          /Icore /Istackcore /Isecurechannel /Itransport\tcp /Itransport\https \
-         /Iproxystub\clientproxy /Iproxystub\serverstub /Iplatforms\win32 /I$(OPENSSLINC)
+         /Iproxystub\clientproxy /Iproxystub\serverstub /Iplatforms\win32 /Iplatforms\shared /I$(OPENSSLINC)
 
 OBJECTS = \
 	$(ODIR)\opcua_buffer.obj \
 	$(ODIR)\opcua_core.obj \
 	$(ODIR)\opcua_datetime.obj \
 	$(ODIR)\opcua_guid.obj \
+	$(ODIR)\opcua_latency.obj \
 	$(ODIR)\opcua_list.obj \
 	$(ODIR)\opcua_memory.obj \
 	$(ODIR)\opcua_memorystream.obj \
@@ -104,6 +105,7 @@ OBJECTS = \
 	$(ODIR)\opcua_p_socket_interface.obj \
 	$(ODIR)\opcua_p_socket_internal.obj \
 	$(ODIR)\opcua_p_socket_ssl.obj \
+	$(ODIR)\opcua_p_socket_ssl_profile.obj \
 	$(ODIR)\opcua_p_string.obj \
 	$(ODIR)\opcua_p_thread.obj \
 	$(ODIR)\opcua_p_timer.obj \
@@ -151,3 +153,6 @@ $(TARGET): $(TARGET_DIR) $(ODIR) $(OBJECTS)
 
 {platforms\win32}.c{$(ODIR)}.obj:
 	$(CC) $(CFLAGS) /Fo$@ /c $<
+
+{platforms\shared}.c{$(ODIR)}.obj:
+	$(CC) $(CFLAGS) /Fo$@ /c $<
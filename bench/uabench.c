@@ -0,0 +1,396 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+/******************************************************************************************************/
+/* Microbenchmarks for the hot paths of the stack.                                                    */
+/*                                                                                                    */
+/* Every case is calibrated until one run takes at least the minimum time, then measured several     */
+/* times. The median run is reported as one JSON object per line:                                    */
+/*                                                                                                    */
+/*   {"name":"encode/ReadResponse","param":100,"iterations":4096,"ns_per_op":...,                     */
+/*    "allocs_per_op":...,"bytes_per_op":...}                                                         */
+/*                                                                                                    */
+/* Allocations are counted by wrapping the memory functions of the platform layer call table, so     */
+/* only allocations made through OpcUa_Alloc/OpcUa_ReAlloc are included.                              */
+/******************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <opcua_proxystub.h>
+#include <opcua_datetime.h>
+
+#include "uabench.h"
+
+/*============================================================================
+ * Settings
+ *===========================================================================*/
+/** @brief Default minimum duration of a measured run in milliseconds. */
+#define UABENCH_DEFAULT_MIN_TIME    200
+/** @brief Default number of measured runs per case. */
+#define UABENCH_DEFAULT_RUNS        5
+/** @brief Upper limit for the number of measured runs. */
+#define UABENCH_MAX_RUNS            31
+
+/*============================================================================
+ * Globals
+ *===========================================================================*/
+static OpcUa_Handle                 UaBench_g_PlatformLayerHandle   = OpcUa_Null;
+static OpcUa_Port_CallTable         UaBench_g_CountingCallTable;
+static OpcUa_ProxyStubConfiguration UaBench_g_ProxyStubConfiguration;
+
+static OpcUa_UInt64                 UaBench_g_uAllocCount           = 0;
+static OpcUa_UInt64                 UaBench_g_uAllocBytes           = 0;
+
+static UaBench_Case*                UaBench_g_CaseTables[]          =
+{
+    UaBench_g_EncoderCases,
+    UaBench_g_CryptoCases,
+    UaBench_g_CoreCases,
+    OpcUa_Null
+};
+
+/** @brief Result of one measured run. */
+typedef struct _UaBench_Run
+{
+    OpcUa_Double    NsPerOp;
+    OpcUa_Double    AllocsPerOp;
+    OpcUa_Double    BytesPerOp;
+} UaBench_Run;
+
+/*============================================================================
+ * UaBench_MemAlloc
+ *===========================================================================*/
+static OpcUa_Void* OPCUA_DLLCALL UaBench_MemAlloc(OpcUa_UInt32 a_uSize)
+{
+    OpcUa_Atomic_Add64(&UaBench_g_uAllocCount, 1);
+    OpcUa_Atomic_Add64(&UaBench_g_uAllocBytes, a_uSize);
+
+    return ((OpcUa_Port_CallTable*)UaBench_g_PlatformLayerHandle)->MemAlloc(a_uSize);
+}
+
+/*============================================================================
+ * UaBench_MemReAlloc
+ *===========================================================================*/
+static OpcUa_Void* OPCUA_DLLCALL UaBench_MemReAlloc(OpcUa_Void*  a_pBuffer,
+                                                    OpcUa_UInt32 a_uSize)
+{
+    OpcUa_Atomic_Add64(&UaBench_g_uAllocCount, 1);
+    OpcUa_Atomic_Add64(&UaBench_g_uAllocBytes, a_uSize);
+
+    return ((OpcUa_Port_CallTable*)UaBench_g_PlatformLayerHandle)->MemReAlloc(a_pBuffer, a_uSize);
+}
+
+/*============================================================================
+ * UaBench_GetMicroseconds
+ *===========================================================================*/
+static OpcUa_UInt64 UaBench_GetMicroseconds(OpcUa_Void)
+{
+    OpcUa_TimeVal tNow;
+
+    OpcUa_DateTime_GetTimeOfDay(&tNow);
+
+    return (OpcUa_UInt64)tNow.uintSeconds * 1000000 + tNow.uintMicroSeconds;
+}
+
+/*============================================================================
+ * UaBench_Initialize
+ *===========================================================================*/
+static OpcUa_StatusCode UaBench_Initialize(OpcUa_Void)
+{
+    OpcUa_StatusCode uStatus = OpcUa_Good;
+
+    memset(&UaBench_g_ProxyStubConfiguration, 0, sizeof(OpcUa_ProxyStubConfiguration));
+
+    UaBench_g_ProxyStubConfiguration.bProxyStub_Trace_Enabled              = OpcUa_False;
+    UaBench_g_ProxyStubConfiguration.uProxyStub_Trace_Level                = OPCUA_TRACE_OUTPUT_LEVEL_NONE;
+    UaBench_g_ProxyStubConfiguration.iSerializer_MaxAlloc                  = -1;
+    UaBench_g_ProxyStubConfiguration.iSerializer_MaxStringLength           = -1;
+    UaBench_g_ProxyStubConfiguration.iSerializer_MaxByteStringLength       = -1;
+    UaBench_g_ProxyStubConfiguration.iSerializer_MaxArrayLength            = -1;
+    UaBench_g_ProxyStubConfiguration.iSerializer_MaxMessageSize            = -1;
+    UaBench_g_ProxyStubConfiguration.iSerializer_MaxRecursionDepth         = -1;
+    UaBench_g_ProxyStubConfiguration.bSecureListener_ThreadPool_Enabled    = OpcUa_False;
+    UaBench_g_ProxyStubConfiguration.iSecureListener_ThreadPool_MinThreads = -1;
+    UaBench_g_ProxyStubConfiguration.iSecureListener_ThreadPool_MaxThreads = -1;
+    UaBench_g_ProxyStubConfiguration.iSecureListener_ThreadPool_MaxJobs    = -1;
+    UaBench_g_ProxyStubConfiguration.bSecureListener_ThreadPool_BlockOnAdd = OpcUa_True;
+    UaBench_g_ProxyStubConfiguration.uSecureListener_ThreadPool_Timeout    = OPCUA_INFINITE;
+    UaBench_g_ProxyStubConfiguration.iSecureListener_CryptoPool_Threads    = -1;
+    UaBench_g_ProxyStubConfiguration.iSecureListener_CryptoPool_MaxJobs    = -1;
+    UaBench_g_ProxyStubConfiguration.bTcpListener_ClientThreadsEnabled     = OpcUa_False;
+    UaBench_g_ProxyStubConfiguration.iTcpListener_DefaultChunkSize         = -1;
+    UaBench_g_ProxyStubConfiguration.iTcpConnection_DefaultChunkSize       = -1;
+    UaBench_g_ProxyStubConfiguration.iTcpTransport_MaxMessageLength        = -1;
+    UaBench_g_ProxyStubConfiguration.iTcpTransport_MaxChunkCount           = -1;
+    UaBench_g_ProxyStubConfiguration.bTcpStream_ExpectWriteToBlock         = OpcUa_True;
+    UaBench_g_ProxyStubConfiguration.iHttpsTransport_MaxPipelinedRequests  = -1;
+
+    uStatus = OpcUa_P_Initialize(&UaBench_g_PlatformLayerHandle);
+    if(OpcUa_IsBad(uStatus))
+    {
+        return uStatus;
+    }
+
+    /* the stack gets a copy of the call table with counting memory functions */
+    UaBench_g_CountingCallTable             = *(OpcUa_Port_CallTable*)UaBench_g_PlatformLayerHandle;
+    UaBench_g_CountingCallTable.MemAlloc    = UaBench_MemAlloc;
+    UaBench_g_CountingCallTable.MemReAlloc  = UaBench_MemReAlloc;
+
+    uStatus = OpcUa_ProxyStub_Initialize(   (OpcUa_Handle)&UaBench_g_CountingCallTable,
+                                            &UaBench_g_ProxyStubConfiguration);
+    if(OpcUa_IsBad(uStatus))
+    {
+        OpcUa_P_Clean(&UaBench_g_PlatformLayerHandle);
+    }
+
+    return uStatus;
+}
+
+/*============================================================================
+ * UaBench_Clear
+ *===========================================================================*/
+static OpcUa_Void UaBench_Clear(OpcUa_Void)
+{
+    OpcUa_ProxyStub_Clear();
+    OpcUa_P_Clean(&UaBench_g_PlatformLayerHandle);
+}
+
+/*============================================================================
+ * UaBench_MeasureRun
+ *===========================================================================*/
+static OpcUa_StatusCode UaBench_MeasureRun( UaBench_Case*   a_pCase,
+                                            OpcUa_Void*     a_pContext,
+                                            OpcUa_UInt32    a_uIterations,
+                                            OpcUa_UInt64*   a_puElapsed,
+                                            UaBench_Run*    a_pRun)
+{
+    OpcUa_StatusCode    uStatus         = OpcUa_Good;
+    OpcUa_UInt64        uAllocCount     = 0;
+    OpcUa_UInt64        uAllocBytes     = 0;
+    OpcUa_UInt64        uStart          = 0;
+    OpcUa_UInt64        uElapsed        = 0;
+
+    uAllocCount = OpcUa_Atomic_Load64(&UaBench_g_uAllocCount);
+    uAllocBytes = OpcUa_Atomic_Load64(&UaBench_g_uAllocBytes);
+    uStart      = UaBench_GetMicroseconds();
+
+    uStatus = a_pCase->Run(a_pContext, a_uIterations);
+
+    uElapsed    = UaBench_GetMicroseconds() - uStart;
+    uAllocCount = OpcUa_Atomic_Load64(&UaBench_g_uAllocCount) - uAllocCount;
+    uAllocBytes = OpcUa_Atomic_Load64(&UaBench_g_uAllocBytes) - uAllocBytes;
+
+    *a_puElapsed        = uElapsed;
+    a_pRun->NsPerOp     = ((OpcUa_Double)uElapsed * 1000.0) / a_uIterations;
+    a_pRun->AllocsPerOp = (OpcUa_Double)uAllocCount / a_uIterations;
+    a_pRun->BytesPerOp  = (OpcUa_Double)uAllocBytes / a_uIterations;
+
+    return uStatus;
+}
+
+/*============================================================================
+ * UaBench_CompareRuns
+ *===========================================================================*/
+static int UaBench_CompareRuns(const void* a_pLeft, const void* a_pRight)
+{
+    const UaBench_Run* pLeft  = (const UaBench_Run*)a_pLeft;
+    const UaBench_Run* pRight = (const UaBench_Run*)a_pRight;
+
+    if(pLeft->NsPerOp < pRight->NsPerOp)
+    {
+        return -1;
+    }
+
+    return (pLeft->NsPerOp > pRight->NsPerOp)?1:0;
+}
+
+/*============================================================================
+ * UaBench_RunCase
+ *===========================================================================*/
+static OpcUa_StatusCode UaBench_RunCase(UaBench_Case*   a_pCase,
+                                        OpcUa_UInt32    a_uMinTime,
+                                        OpcUa_UInt32    a_uRuns)
+{
+    OpcUa_StatusCode    uStatus         = OpcUa_Good;
+    OpcUa_Void*         pContext        = OpcUa_Null;
+    OpcUa_UInt32        uIterations     = 1;
+    OpcUa_UInt64        uElapsed        = 0;
+    OpcUa_UInt32        uRun            = 0;
+    UaBench_Run         aRuns[UABENCH_MAX_RUNS];
+
+    uStatus = a_pCase->Setup(a_pCase->Parameter, a_pCase->Argument, &pContext);
+    if(OpcUa_IsBad(uStatus))
+    {
+        fprintf(stderr, "%s(%u): setup failed with 0x%08X\n", a_pCase->Name, a_pCase->Parameter, uStatus);
+        return uStatus;
+    }
+
+    /* warm up caches and lazily created state */
+    uStatus = UaBench_MeasureRun(a_pCase, pContext, 1, &uElapsed, &aRuns[0]);
+
+    /* double the iterations until a run takes the minimum time */
+    while(OpcUa_IsGood(uStatus) && uElapsed < (OpcUa_UInt64)a_uMinTime * 1000 && uIterations < 0x40000000)
+    {
+        if(uElapsed == 0)
+        {
+            uIterations *= 2;
+        }
+        else
+        {
+            /* extrapolate with some headroom but never grow more than 100 times */
+            OpcUa_UInt64 uNext = (OpcUa_UInt64)uIterations * a_uMinTime * 1200 / uElapsed;
+
+            if(uNext > (OpcUa_UInt64)uIterations * 100)
+            {
+                uNext = (OpcUa_UInt64)uIterations * 100;
+            }
+
+            uIterations = (uNext > uIterations)?(OpcUa_UInt32)((uNext < 0x40000000)?uNext:0x40000000):uIterations * 2;
+        }
+
+        uStatus = UaBench_MeasureRun(a_pCase, pContext, uIterations, &uElapsed, &aRuns[0]);
+    }
+
+    for(uRun = 0; OpcUa_IsGood(uStatus) && uRun < a_uRuns; uRun++)
+    {
+        uStatus = UaBench_MeasureRun(a_pCase, pContext, uIterations, &uElapsed, &aRuns[uRun]);
+    }
+
+    a_pCase->Clear(pContext);
+
+    if(OpcUa_IsBad(uStatus))
+    {
+        fprintf(stderr, "%s(%u): run failed with 0x%08X\n", a_pCase->Name, a_pCase->Parameter, uStatus);
+        return uStatus;
+    }
+
+    qsort(aRuns, a_uRuns, sizeof(UaBench_Run), UaBench_CompareRuns);
+
+    printf("{\"name\":\"%s\",\"param\":%u,\"iterations\":%u,\"runs\":%u,"
+           "\"ns_per_op\":%.1f,\"ns_per_op_min\":%.1f,\"ns_per_op_max\":%.1f,"
+           "\"allocs_per_op\":%.2f,\"bytes_per_op\":%.1f}\n",
+           a_pCase->Name,
+           a_pCase->Parameter,
+           uIterations,
+           a_uRuns,
+           aRuns[a_uRuns/2].NsPerOp,
+           aRuns[0].NsPerOp,
+           aRuns[a_uRuns - 1].NsPerOp,
+           aRuns[a_uRuns/2].AllocsPerOp,
+           aRuns[a_uRuns/2].BytesPerOp);
+    fflush(stdout);
+
+    return OpcUa_Good;
+}
+
+/*============================================================================
+ * UaBench_Usage
+ *===========================================================================*/
+static OpcUa_Void UaBench_Usage(const char* a_sProgram)
+{
+    fprintf(stderr,
+            "usage: %s [-l] [-f filter] [-t milliseconds] [-r runs]\n"
+            "  -l  list the cases and exit\n"
+            "  -f  only run cases whose name contains filter\n"
+            "  -t  minimum duration of a measured run (default %u)\n"
+            "  -r  number of measured runs, the median is reported (default %u, max %u)\n",
+            a_sProgram,
+            UABENCH_DEFAULT_MIN_TIME,
+            UABENCH_DEFAULT_RUNS,
+            UABENCH_MAX_RUNS);
+}
+
+/*============================================================================
+ * main
+ *===========================================================================*/
+int main(int argc, char* argv[])
+{
+    OpcUa_StatusCode    uStatus     = OpcUa_Good;
+    const char*         sFilter     = OpcUa_Null;
+    OpcUa_UInt32        uMinTime    = UABENCH_DEFAULT_MIN_TIME;
+    OpcUa_UInt32        uRuns       = UABENCH_DEFAULT_RUNS;
+    OpcUa_Boolean       bList       = OpcUa_False;
+    OpcUa_UInt32        uFailed     = 0;
+    UaBench_Case*       pCase       = OpcUa_Null;
+    int                 iArg        = 0;
+    int                 iTable      = 0;
+
+    for(iArg = 1; iArg < argc; iArg++)
+    {
+        if(strcmp(argv[iArg], "-l") == 0)
+        {
+            bList = OpcUa_True;
+        }
+        else if(strcmp(argv[iArg], "-f") == 0 && iArg + 1 < argc)
+        {
+            sFilter = argv[++iArg];
+        }
+        else if(strcmp(argv[iArg], "-t") == 0 && iArg + 1 < argc)
+        {
+            uMinTime = (OpcUa_UInt32)strtoul(argv[++iArg], OpcUa_Null, 10);
+        }
+        else if(strcmp(argv[iArg], "-r") == 0 && iArg + 1 < argc)
+        {
+            uRuns = (OpcUa_UInt32)strtoul(argv[++iArg], OpcUa_Null, 10);
+        }
+        else
+        {
+            UaBench_Usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if(uRuns == 0 || uRuns > UABENCH_MAX_RUNS)
+    {
+        UaBench_Usage(argv[0]);
+        return 2;
+    }
+
+    uStatus = UaBench_Initialize();
+    if(OpcUa_IsBad(uStatus))
+    {
+        fprintf(stderr, "initialization failed with 0x%08X\n", uStatus);
+        return 1;
+    }
+
+    for(iTable = 0; UaBench_g_CaseTables[iTable] != OpcUa_Null; iTable++)
+    {
+        for(pCase = UaBench_g_CaseTables[iTable]; pCase->Name != OpcUa_Null; pCase++)
+        {
+            if(sFilter != OpcUa_Null && strstr(pCase->Name, sFilter) == OpcUa_Null)
+            {
+                continue;
+            }
+
+            if(bList != OpcUa_False)
+            {
+                printf("%s %u\n", pCase->Name, pCase->Parameter);
+                continue;
+            }
+
+            if(OpcUa_IsBad(UaBench_RunCase(pCase, uMinTime, uRuns)))
+            {
+                uFailed++;
+            }
+        }
+    }
+
+    UaBench_Clear();
+
+    return (uFailed == 0)?0:1;
+}
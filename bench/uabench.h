@@ -0,0 +1,74 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#ifndef _UaBench_H_
+#define _UaBench_H_ 1
+
+#include <opcua.h>
+
+OPCUA_BEGIN_EXTERN_C
+
+/**
+ * @brief Prepares the state of a benchmark. Not measured.
+ *
+ * @param uParameter    [in]  The numeric parameter of the case (message size, element count, ...).
+ * @param pArgument     [in]  The argument of the case (security policy uri, ...) or OpcUa_Null.
+ * @param ppContext     [out] The state passed to the run and clear functions.
+ */
+typedef OpcUa_StatusCode (UaBench_PfnSetup)(    OpcUa_UInt32    uParameter,
+                                                OpcUa_Void*     pArgument,
+                                                OpcUa_Void**    ppContext);
+
+/**
+ * @brief Executes the measured operation uIterations times.
+ */
+typedef OpcUa_StatusCode (UaBench_PfnRun)(      OpcUa_Void*     pContext,
+                                                OpcUa_UInt32    uIterations);
+
+/**
+ * @brief Frees the state created by the setup function.
+ */
+typedef OpcUa_Void       (UaBench_PfnClear)(    OpcUa_Void*     pContext);
+
+/**
+ * @brief A benchmark case.
+ */
+typedef struct _UaBench_Case
+{
+    /** @brief Unique name; groups are separated with '/'. */
+    const OpcUa_CharA*  Name;
+    /** @brief Passed to Setup and reported with the result. */
+    OpcUa_UInt32        Parameter;
+    /** @brief Passed to Setup. */
+    OpcUa_Void*         Argument;
+    UaBench_PfnSetup*   Setup;
+    UaBench_PfnRun*     Run;
+    UaBench_PfnClear*   Clear;
+} UaBench_Case;
+
+/** @brief Terminates a case table. */
+#define UABENCH_CASE_END { OpcUa_Null, 0, OpcUa_Null, OpcUa_Null, OpcUa_Null, OpcUa_Null }
+
+/*============================================================================
+ * Case tables of the benchmark modules.
+ *===========================================================================*/
+extern UaBench_Case UaBench_g_EncoderCases[];
+extern UaBench_Case UaBench_g_CryptoCases[];
+extern UaBench_Case UaBench_g_CoreCases[];
+
+OPCUA_END_EXTERN_C
+
+#endif /* _UaBench_H_ */
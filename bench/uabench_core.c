@@ -0,0 +1,331 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+/******************************************************************************************************/
+/* Benchmarks for the containers and the thread pool of the core module.                              */
+/******************************************************************************************************/
+
+#include <opcua.h>
+#include <opcua_core.h>
+#include <opcua_list.h>
+#include <opcua_threadpool.h>
+
+#include "uabench.h"
+
+/** @brief Capacity of the job queue of the thread pool. */
+#define UABENCH_THREADPOOL_MAXJOBS      1024
+
+/**
+ * @brief State of a list benchmark.
+ */
+typedef struct _UaBench_ListContext
+{
+    OpcUa_List*     pList;
+    /** @brief Dummy payload; the list only stores pointers. */
+    OpcUa_UInt32*   pValues;
+    OpcUa_UInt32    uNoOfValues;
+} UaBench_ListContext;
+
+/**
+ * @brief State of a thread pool benchmark.
+ */
+typedef struct _UaBench_ThreadPoolContext
+{
+    OpcUa_ThreadPool    hThreadPool;
+    OpcUa_Semaphore     hDone;
+    /** @brief Number of jobs still to be executed in the current run. */
+    OpcUa_UInt32        uPending;
+} UaBench_ThreadPoolContext;
+
+/*============================================================================
+ * UaBench_List_Clear
+ *===========================================================================*/
+static OpcUa_Void UaBench_List_Clear(OpcUa_Void* a_pContext)
+{
+    UaBench_ListContext* pContext = (UaBench_ListContext*)a_pContext;
+
+    if(pContext == OpcUa_Null)
+    {
+        return;
+    }
+
+    if(pContext->pList != OpcUa_Null)
+    {
+        OpcUa_List_Delete(&pContext->pList);
+    }
+
+    OpcUa_Free(pContext->pValues);
+    OpcUa_Free(pContext);
+}
+
+/*============================================================================
+ * UaBench_List_Setup
+ *===========================================================================*/
+/* a_uParameter is the number of elements in the list */
+static OpcUa_StatusCode UaBench_List_Setup( OpcUa_UInt32    a_uParameter,
+                                            OpcUa_Void*     a_pArgument,
+                                            OpcUa_Void**    a_ppContext)
+{
+    UaBench_ListContext*    pContext    = OpcUa_Null;
+    OpcUa_UInt32            uIndex      = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_Server, "List_Setup");
+
+    OpcUa_ReferenceParameter(a_pArgument);
+
+    pContext = (UaBench_ListContext*)OpcUa_Alloc(sizeof(UaBench_ListContext));
+    OpcUa_GotoErrorIfAllocFailed(pContext);
+    OpcUa_MemSet(pContext, 0, sizeof(UaBench_ListContext));
+
+    /* one spare value for the element added by the run functions */
+    pContext->uNoOfValues = a_uParameter;
+    pContext->pValues = (OpcUa_UInt32*)OpcUa_Alloc((a_uParameter + 1) * sizeof(OpcUa_UInt32));
+    OpcUa_GotoErrorIfAllocFailed(pContext->pValues);
+
+    uStatus = OpcUa_List_Create(&pContext->pList);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    for(uIndex = 0; uIndex <= a_uParameter; uIndex++)
+    {
+        pContext->pValues[uIndex] = uIndex;
+    }
+
+    for(uIndex = 0; uIndex < a_uParameter; uIndex++)
+    {
+        uStatus = OpcUa_List_AddElementToEnd(pContext->pList, &pContext->pValues[uIndex]);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+    *a_ppContext = pContext;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaBench_List_Clear(pContext);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaBench_List_RunQueue
+ *===========================================================================*/
+/* enqueue at the end and dequeue from the front, as done for pending requests */
+static OpcUa_StatusCode UaBench_List_RunQueue(  OpcUa_Void*     a_pContext,
+                                                OpcUa_UInt32    a_uIterations)
+{
+    UaBench_ListContext*    pContext    = (UaBench_ListContext*)a_pContext;
+    OpcUa_Void*             pValue      = &pContext->pValues[pContext->uNoOfValues];
+    OpcUa_UInt32            uIteration  = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_Server, "List_RunQueue");
+
+    for(uIteration = 0; uIteration < a_uIterations; uIteration++)
+    {
+        OpcUa_List_Enter(pContext->pList);
+        uStatus = OpcUa_List_AddElementToEnd(pContext->pList, pValue);
+        pValue = OpcUa_List_RemoveFirstElement(pContext->pList);
+        OpcUa_List_Leave(pContext->pList);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaBench_List_RunAddDelete
+ *===========================================================================*/
+/* add at the end and delete by value, as done for channels and connections */
+static OpcUa_StatusCode UaBench_List_RunAddDelete(  OpcUa_Void*     a_pContext,
+                                                    OpcUa_UInt32    a_uIterations)
+{
+    UaBench_ListContext*    pContext    = (UaBench_ListContext*)a_pContext;
+    OpcUa_Void*             pValue      = &pContext->pValues[pContext->uNoOfValues];
+    OpcUa_UInt32            uIteration  = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_Server, "List_RunAddDelete");
+
+    for(uIteration = 0; uIteration < a_uIterations; uIteration++)
+    {
+        OpcUa_List_Enter(pContext->pList);
+        uStatus = OpcUa_List_AddElementToEnd(pContext->pList, pValue);
+        if(OpcUa_IsGood(uStatus))
+        {
+            uStatus = OpcUa_List_DeleteElement(pContext->pList, pValue);
+        }
+        OpcUa_List_Leave(pContext->pList);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaBench_List_RunIterate
+ *===========================================================================*/
+/* one operation is a walk over the whole list */
+static OpcUa_StatusCode UaBench_List_RunIterate(OpcUa_Void*     a_pContext,
+                                                OpcUa_UInt32    a_uIterations)
+{
+    UaBench_ListContext*    pContext    = (UaBench_ListContext*)a_pContext;
+    OpcUa_UInt32*           pValue      = OpcUa_Null;
+    OpcUa_UInt32            uSum        = 0;
+    OpcUa_UInt32            uIteration  = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_Server, "List_RunIterate");
+
+    for(uIteration = 0; uIteration < a_uIterations; uIteration++)
+    {
+        OpcUa_List_Enter(pContext->pList);
+        OpcUa_List_ResetCurrent(pContext->pList);
+        pValue = (OpcUa_UInt32*)OpcUa_List_GetCurrentElement(pContext->pList);
+        while(pValue != OpcUa_Null)
+        {
+            uSum += *pValue;
+            pValue = (OpcUa_UInt32*)OpcUa_List_GetNextElement(pContext->pList);
+        }
+        OpcUa_List_Leave(pContext->pList);
+    }
+
+    /* the sum keeps the walk from being optimized away */
+    OpcUa_GotoErrorIfTrue(uSum == 1, OpcUa_BadInternalError);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaBench_ThreadPool_Job
+ *===========================================================================*/
+static OpcUa_Void UaBench_ThreadPool_Job(OpcUa_Void* a_pArgument)
+{
+    UaBench_ThreadPoolContext* pContext = (UaBench_ThreadPoolContext*)a_pArgument;
+
+    if(OpcUa_Atomic_Add32(&pContext->uPending, (OpcUa_UInt32)-1) == 0)
+    {
+        OpcUa_Semaphore_Post(pContext->hDone, 1);
+    }
+}
+
+/*============================================================================
+ * UaBench_ThreadPool_Clear
+ *===========================================================================*/
+static OpcUa_Void UaBench_ThreadPool_Clear(OpcUa_Void* a_pContext)
+{
+    UaBench_ThreadPoolContext* pContext = (UaBench_ThreadPoolContext*)a_pContext;
+
+    if(pContext == OpcUa_Null)
+    {
+        return;
+    }
+
+    if(pContext->hThreadPool != OpcUa_Null)
+    {
+        OpcUa_ThreadPool_Delete(&pContext->hThreadPool);
+    }
+
+    if(pContext->hDone != OpcUa_Null)
+    {
+        OpcUa_Semaphore_Delete(&pContext->hDone);
+    }
+
+    OpcUa_Free(pContext);
+}
+
+/*============================================================================
+ * UaBench_ThreadPool_Setup
+ *===========================================================================*/
+/* a_uParameter is the number of worker threads */
+static OpcUa_StatusCode UaBench_ThreadPool_Setup(   OpcUa_UInt32    a_uParameter,
+                                                    OpcUa_Void*     a_pArgument,
+                                                    OpcUa_Void**    a_ppContext)
+{
+    UaBench_ThreadPoolContext* pContext = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_Server, "ThreadPool_Setup");
+
+    OpcUa_ReferenceParameter(a_pArgument);
+
+    pContext = (UaBench_ThreadPoolContext*)OpcUa_Alloc(sizeof(UaBench_ThreadPoolContext));
+    OpcUa_GotoErrorIfAllocFailed(pContext);
+    OpcUa_MemSet(pContext, 0, sizeof(UaBench_ThreadPoolContext));
+
+    uStatus = OpcUa_Semaphore_Create(&pContext->hDone, 0, 1);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = OpcUa_ThreadPool_Create(  &pContext->hThreadPool,
+                                        a_uParameter,
+                                        a_uParameter,
+                                        UABENCH_THREADPOOL_MAXJOBS,
+                                        OpcUa_True,
+                                        OPCUA_INFINITE);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    *a_ppContext = pContext;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaBench_ThreadPool_Clear(pContext);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaBench_ThreadPool_Run
+ *===========================================================================*/
+/* one operation is queuing and executing an empty job */
+static OpcUa_StatusCode UaBench_ThreadPool_Run( OpcUa_Void*     a_pContext,
+                                                OpcUa_UInt32    a_uIterations)
+{
+    UaBench_ThreadPoolContext*  pContext    = (UaBench_ThreadPoolContext*)a_pContext;
+    OpcUa_UInt32                uIteration  = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_Server, "ThreadPool_Run");
+
+    OpcUa_Atomic_Store32(&pContext->uPending, a_uIterations);
+
+    for(uIteration = 0; uIteration < a_uIterations; uIteration++)
+    {
+        uStatus = OpcUa_ThreadPool_AddJob(pContext->hThreadPool, UaBench_ThreadPool_Job, pContext);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+    uStatus = OpcUa_Semaphore_Wait(pContext->hDone);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * Case table
+ *===========================================================================*/
+UaBench_Case UaBench_g_CoreCases[] =
+{
+    { "list/queue",         100,    OpcUa_Null, UaBench_List_Setup,         UaBench_List_RunQueue,      UaBench_List_Clear },
+    { "list/add_delete",    10,     OpcUa_Null, UaBench_List_Setup,         UaBench_List_RunAddDelete,  UaBench_List_Clear },
+    { "list/add_delete",    1000,   OpcUa_Null, UaBench_List_Setup,         UaBench_List_RunAddDelete,  UaBench_List_Clear },
+    { "list/iterate",       1000,   OpcUa_Null, UaBench_List_Setup,         UaBench_List_RunIterate,    UaBench_List_Clear },
+    { "threadpool/job",     1,      OpcUa_Null, UaBench_ThreadPool_Setup,   UaBench_ThreadPool_Run,     UaBench_ThreadPool_Clear },
+    { "threadpool/job",     4,      OpcUa_Null, UaBench_ThreadPool_Setup,   UaBench_ThreadPool_Run,     UaBench_ThreadPool_Clear },
+    UABENCH_CASE_END
+};
@@ -0,0 +1,647 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+/******************************************************************************************************/
+/* Crypto provider benchmarks per security policy.                                                   */
+/*                                                                                                    */
+/* The symmetric cases use keys derived like OpcUa_SecureChannel_DeriveKeys does for a new token;    */
+/* "chunk" writes a message through OpcUa_SecureStream on an opened channel, which cuts it into       */
+/* chunks, signs and encrypts them and hands them to a transport stream that only counts the bytes.  */
+/* The asymmetric cases use a generated RSA key pair.                                                 */
+/******************************************************************************************************/
+
+#include <opcua.h>
+#include <opcua_cryptofactory.h>
+#include <opcua_securechannel.h>
+#include <opcua_tcpsecurechannel.h>
+#include <opcua_securestream.h>
+
+#include "uabench.h"
+
+#if OPCUA_HAVE_OPENSSL
+
+/** @brief Block size of the symmetric encryption algorithms (AES). */
+#define UABENCH_CRYPTO_BLOCKSIZE        16
+/** @brief Upper limit for the symmetric signature size (HMAC-SHA256). */
+#define UABENCH_CRYPTO_MAXSIGNATURE     32
+/** @brief Length of the nonces the keys are derived from. */
+#define UABENCH_CRYPTO_NONCELENGTH      32
+/** @brief Length of the data encrypted with RSA; the size of a nonce. */
+#define UABENCH_CRYPTO_RSADATALENGTH    32
+/** @brief Chunk length of the transport stream below the secure stream. */
+#define UABENCH_CRYPTO_CHUNKLENGTH      8192
+
+/**
+ * @brief State of a crypto benchmark.
+ */
+typedef struct _UaBench_CryptoContext
+{
+    OpcUa_CryptoProvider    Provider;
+    OpcUa_Boolean           bProviderCreated;
+    /** @brief Symmetric keys of the sending side. */
+    OpcUa_SecurityKeyset*   pClientKeyset;
+    OpcUa_SecurityKeyset*   pServerKeyset;
+    /** @brief Asymmetric keys. */
+    OpcUa_Key               PublicKey;
+    OpcUa_Key               PrivateKey;
+    /** @brief Data to process; followed by room for signature and padding. */
+    OpcUa_Byte*             pData;
+    OpcUa_UInt32            uDataLength;
+    /** @brief Output of the encryption. */
+    OpcUa_Byte*             pCipherText;
+    OpcUa_UInt32            uCipherTextLength;
+    /** @brief Signature output; the RSA signature is created in setup for the verify case. */
+    OpcUa_ByteString        Signature;
+    /** @brief Opened channel of the chunk case; owns the keysets once opened. */
+    OpcUa_SecureChannel*    pSecureChannel;
+    /** @brief Transport stream of the chunk case and the chunk handed to it. */
+    OpcUa_OutputStream      TransportStream;
+    OpcUa_Buffer            TransportBuffer;
+    OpcUa_UInt32            uBytesSent;
+} UaBench_CryptoContext;
+
+/*============================================================================
+ * UaBench_Crypto_Clear
+ *===========================================================================*/
+static OpcUa_Void UaBench_Crypto_Clear(OpcUa_Void* a_pContext)
+{
+    UaBench_CryptoContext* pContext = (UaBench_CryptoContext*)a_pContext;
+
+    if(pContext == OpcUa_Null)
+    {
+        return;
+    }
+
+    if(pContext->pSecureChannel != OpcUa_Null)
+    {
+        OpcUa_TcpSecureChannel_Delete(&pContext->pSecureChannel);
+    }
+
+    if(pContext->pClientKeyset != OpcUa_Null)
+    {
+        OpcUa_SecurityKeyset_Clear(pContext->pClientKeyset);
+        OpcUa_Free(pContext->pClientKeyset);
+    }
+
+    if(pContext->pServerKeyset != OpcUa_Null)
+    {
+        OpcUa_SecurityKeyset_Clear(pContext->pServerKeyset);
+        OpcUa_Free(pContext->pServerKeyset);
+    }
+
+    OpcUa_Key_Clear(&pContext->PublicKey);
+    OpcUa_Key_Clear(&pContext->PrivateKey);
+    OpcUa_ByteString_Clear(&pContext->Signature);
+    OpcUa_Free(pContext->pData);
+    OpcUa_Free(pContext->pCipherText);
+
+    if(pContext->bProviderCreated != OpcUa_False)
+    {
+        OPCUA_P_CRYPTOFACTORY_DELETECRYPTOPROVIDER(&pContext->Provider);
+    }
+
+    OpcUa_Free(pContext);
+}
+
+/*============================================================================
+ * UaBench_Crypto_Create
+ *===========================================================================*/
+static OpcUa_StatusCode UaBench_Crypto_Create(  OpcUa_StringA               a_sSecurityPolicy,
+                                                OpcUa_UInt32                a_uDataLength,
+                                                UaBench_CryptoContext**     a_ppContext)
+{
+    UaBench_CryptoContext*  pContext    = OpcUa_Null;
+    OpcUa_UInt32            uIndex      = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_Server, "Crypto_Create");
+
+    pContext = (UaBench_CryptoContext*)OpcUa_Alloc(sizeof(UaBench_CryptoContext));
+    OpcUa_GotoErrorIfAllocFailed(pContext);
+    OpcUa_MemSet(pContext, 0, sizeof(UaBench_CryptoContext));
+
+    OpcUa_Key_Initialize(&pContext->PublicKey);
+    OpcUa_Key_Initialize(&pContext->PrivateKey);
+    OpcUa_ByteString_Initialize(&pContext->Signature);
+
+    uStatus = OPCUA_P_CRYPTOFACTORY_CREATECRYPTOPROVIDER(a_sSecurityPolicy, &pContext->Provider);
+    OpcUa_GotoErrorIfBad(uStatus);
+    pContext->bProviderCreated = OpcUa_True;
+
+    /* room for a signature and a padding block behind the data */
+    pContext->uDataLength = a_uDataLength;
+    pContext->pData = (OpcUa_Byte*)OpcUa_Alloc(a_uDataLength + UABENCH_CRYPTO_MAXSIGNATURE + UABENCH_CRYPTO_BLOCKSIZE);
+    OpcUa_GotoErrorIfAllocFailed(pContext->pData);
+
+    for(uIndex = 0; uIndex < a_uDataLength + UABENCH_CRYPTO_MAXSIGNATURE + UABENCH_CRYPTO_BLOCKSIZE; uIndex++)
+    {
+        pContext->pData[uIndex] = (OpcUa_Byte)(uIndex * 31 + 7);
+    }
+
+    *a_ppContext = pContext;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaBench_Crypto_Clear(pContext);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaBench_Crypto_SetupSymmetric
+ *===========================================================================*/
+/* a_uParameter is the size of the data in bytes */
+static OpcUa_StatusCode UaBench_Crypto_SetupSymmetric(  OpcUa_UInt32    a_uParameter,
+                                                        OpcUa_Void*     a_pArgument,
+                                                        OpcUa_Void**    a_ppContext)
+{
+    UaBench_CryptoContext*  pContext        = OpcUa_Null;
+    OpcUa_Byte              abClientNonce[UABENCH_CRYPTO_NONCELENGTH];
+    OpcUa_Byte              abServerNonce[UABENCH_CRYPTO_NONCELENGTH];
+    OpcUa_ByteString        bsClientNonce;
+    OpcUa_ByteString        bsServerNonce;
+    OpcUa_UInt32            uIndex          = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_Server, "Crypto_SetupSymmetric");
+
+    OpcUa_ReturnErrorIfTrue((a_uParameter % UABENCH_CRYPTO_BLOCKSIZE) != 0, OpcUa_BadInvalidArgument);
+
+    uStatus = UaBench_Crypto_Create((OpcUa_StringA)a_pArgument, a_uParameter, &pContext);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* fixed nonces make the runs reproducible */
+    for(uIndex = 0; uIndex < UABENCH_CRYPTO_NONCELENGTH; uIndex++)
+    {
+        abClientNonce[uIndex] = (OpcUa_Byte)uIndex;
+        abServerNonce[uIndex] = (OpcUa_Byte)(0xFF - uIndex);
+    }
+
+    bsClientNonce.Length = UABENCH_CRYPTO_NONCELENGTH;
+    bsClientNonce.Data   = abClientNonce;
+    bsServerNonce.Length = UABENCH_CRYPTO_NONCELENGTH;
+    bsServerNonce.Data   = abServerNonce;
+
+    uStatus = OpcUa_SecureChannel_DeriveKeys(   OpcUa_MessageSecurityMode_SignAndEncrypt,
+                                                &pContext->Provider,
+                                                &bsClientNonce,
+                                                &bsServerNonce,
+                                                &pContext->pClientKeyset,
+                                                &pContext->pServerKeyset);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    pContext->uCipherTextLength = a_uParameter + UABENCH_CRYPTO_MAXSIGNATURE + UABENCH_CRYPTO_BLOCKSIZE;
+    pContext->pCipherText = (OpcUa_Byte*)OpcUa_Alloc(pContext->uCipherTextLength);
+    OpcUa_GotoErrorIfAllocFailed(pContext->pCipherText);
+
+    pContext->Signature.Data = (OpcUa_Byte*)OpcUa_Alloc(UABENCH_CRYPTO_MAXSIGNATURE);
+    OpcUa_GotoErrorIfAllocFailed(pContext->Signature.Data);
+    pContext->Signature.Length = UABENCH_CRYPTO_MAXSIGNATURE;
+
+    *a_ppContext = pContext;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaBench_Crypto_Clear(pContext);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaBench_Crypto_Transport_GetChunkLength
+ *===========================================================================*/
+static OpcUa_StatusCode UaBench_Crypto_Transport_GetChunkLength(OpcUa_Stream*  a_pStrm,
+                                                                OpcUa_UInt32*  a_puLength)
+{
+    OpcUa_ReferenceParameter(a_pStrm);
+
+    *a_puLength = UABENCH_CRYPTO_CHUNKLENGTH;
+
+    return OpcUa_Good;
+}
+
+/*============================================================================
+ * UaBench_Crypto_Transport_AttachBuffer
+ *===========================================================================*/
+static OpcUa_StatusCode UaBench_Crypto_Transport_AttachBuffer(  OpcUa_Stream*  a_pStrm,
+                                                                OpcUa_Buffer*  a_pBuffer)
+{
+    UaBench_CryptoContext* pContext = (UaBench_CryptoContext*)a_pStrm->Handle;
+
+    pContext->TransportBuffer = *a_pBuffer;
+
+    return OpcUa_Good;
+}
+
+/*============================================================================
+ * UaBench_Crypto_Transport_DetachBuffer
+ *===========================================================================*/
+static OpcUa_StatusCode UaBench_Crypto_Transport_DetachBuffer(  OpcUa_Stream*  a_pStrm,
+                                                                OpcUa_Buffer*  a_pBuffer)
+{
+    UaBench_CryptoContext* pContext = (UaBench_CryptoContext*)a_pStrm->Handle;
+
+    *a_pBuffer = pContext->TransportBuffer;
+    OpcUa_MemSet(&pContext->TransportBuffer, 0, sizeof(OpcUa_Buffer));
+
+    return OpcUa_Good;
+}
+
+/*============================================================================
+ * UaBench_Crypto_Transport_Flush
+ *===========================================================================*/
+/* stands in for the socket write; the chunk stays with the secure stream */
+static OpcUa_StatusCode UaBench_Crypto_Transport_Flush( OpcUa_OutputStream* a_pOstrm,
+                                                        OpcUa_Boolean       a_bLastCall)
+{
+    UaBench_CryptoContext* pContext = (UaBench_CryptoContext*)a_pOstrm->Handle;
+
+    OpcUa_ReferenceParameter(a_bLastCall);
+
+    pContext->uBytesSent += pContext->TransportBuffer.EndOfData;
+
+    return OpcUa_Good;
+}
+
+/*============================================================================
+ * UaBench_Crypto_SetupChunk
+ *===========================================================================*/
+/* a_uParameter is the size of the message body in bytes */
+static OpcUa_StatusCode UaBench_Crypto_SetupChunk(  OpcUa_UInt32    a_uParameter,
+                                                    OpcUa_Void*     a_pArgument,
+                                                    OpcUa_Void**    a_ppContext)
+{
+    UaBench_CryptoContext*      pContext        = OpcUa_Null;
+    OpcUa_CryptoProvider*       pCryptoProvider = OpcUa_Null;
+    OpcUa_ChannelSecurityToken  Token;
+
+OpcUa_InitializeStatus(OpcUa_Module_Server, "Crypto_SetupChunk");
+
+    uStatus = UaBench_Crypto_SetupSymmetric(a_uParameter, a_pArgument, (OpcUa_Void**)&pContext);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    pContext->TransportStream.Type              = OpcUa_StreamType_Output;
+    pContext->TransportStream.Handle            = pContext;
+    pContext->TransportStream.Flush             = UaBench_Crypto_Transport_Flush;
+    pContext->TransportStream.AttachBuffer      = UaBench_Crypto_Transport_AttachBuffer;
+    pContext->TransportStream.DetachBuffer      = UaBench_Crypto_Transport_DetachBuffer;
+    pContext->TransportStream.GetChunkLength    = UaBench_Crypto_Transport_GetChunkLength;
+
+    /* the channel deletes its crypto provider, so it gets its own */
+    pCryptoProvider = (OpcUa_CryptoProvider*)OpcUa_Alloc(sizeof(OpcUa_CryptoProvider));
+    OpcUa_GotoErrorIfAllocFailed(pCryptoProvider);
+    OpcUa_MemSet(pCryptoProvider, 0, sizeof(OpcUa_CryptoProvider));
+
+    uStatus = OPCUA_P_CRYPTOFACTORY_CREATECRYPTOPROVIDER((OpcUa_StringA)a_pArgument, pCryptoProvider);
+    if(OpcUa_IsBad(uStatus))
+    {
+        OpcUa_Free(pCryptoProvider);
+        OpcUa_GotoError;
+    }
+
+    uStatus = OpcUa_TcpSecureChannel_Create(&pContext->pSecureChannel);
+    if(OpcUa_IsBad(uStatus))
+    {
+        OPCUA_P_CRYPTOFACTORY_DELETECRYPTOPROVIDER(pCryptoProvider);
+        OpcUa_Free(pCryptoProvider);
+        OpcUa_GotoError;
+    }
+    pContext->pSecureChannel->SecureChannelId = 1;
+
+    OpcUa_ChannelSecurityToken_Initialize(&Token);
+    Token.ChannelId         = 1;
+    Token.TokenId           = 1;
+    Token.RevisedLifetime   = 3600000;
+
+    /* the server sends with its keyset; the stream only checks that a transport connection is set */
+    pContext->pSecureChannel->pCurrentCryptoProvider = pCryptoProvider;
+    uStatus = pContext->pSecureChannel->Open(   pContext->pSecureChannel,
+                                                (OpcUa_Handle)&pContext->TransportStream,
+                                                Token,
+                                                OpcUa_MessageSecurityMode_SignAndEncrypt,
+                                                OpcUa_Null,
+                                                OpcUa_Null,
+                                                pContext->pClientKeyset,
+                                                pContext->pServerKeyset,
+                                                pCryptoProvider);
+    /* the channel owns the keysets now or has freed them */
+    pContext->pClientKeyset = OpcUa_Null;
+    pContext->pServerKeyset = OpcUa_Null;
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    *a_ppContext = pContext;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaBench_Crypto_Clear(pContext);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaBench_Crypto_SetupAsymmetric
+ *===========================================================================*/
+/* a_uParameter is the key length in bits */
+static OpcUa_StatusCode UaBench_Crypto_SetupAsymmetric( OpcUa_UInt32    a_uParameter,
+                                                        OpcUa_Void*     a_pArgument,
+                                                        OpcUa_Void**    a_ppContext)
+{
+    UaBench_CryptoContext*  pContext    = OpcUa_Null;
+    OpcUa_ByteString        bsData;
+
+OpcUa_InitializeStatus(OpcUa_Module_Server, "Crypto_SetupAsymmetric");
+
+    uStatus = UaBench_Crypto_Create((OpcUa_StringA)a_pArgument, UABENCH_CRYPTO_RSADATALENGTH, &pContext);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = pContext->Provider.GenerateAsymmetricKeypair(     &pContext->Provider,
+                                                                OpcUa_Crypto_Rsa_Id,
+                                                                a_uParameter,
+                                                                &pContext->PublicKey,
+                                                                &pContext->PrivateKey);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* one RSA block for cipher text and signature */
+    pContext->uCipherTextLength = a_uParameter / 8;
+    pContext->pCipherText = (OpcUa_Byte*)OpcUa_Alloc(pContext->uCipherTextLength);
+    OpcUa_GotoErrorIfAllocFailed(pContext->pCipherText);
+
+    pContext->Signature.Data = (OpcUa_Byte*)OpcUa_Alloc(pContext->uCipherTextLength);
+    OpcUa_GotoErrorIfAllocFailed(pContext->Signature.Data);
+    pContext->Signature.Length = (OpcUa_Int32)pContext->uCipherTextLength;
+
+    /* sign and encrypt once; the verify and decrypt cases work on the results */
+    bsData.Length = (OpcUa_Int32)pContext->uDataLength;
+    bsData.Data   = pContext->pData;
+
+    uStatus = pContext->Provider.AsymmetricSign(&pContext->Provider, bsData, &pContext->PrivateKey, &pContext->Signature);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = pContext->Provider.AsymmetricEncrypt( &pContext->Provider,
+                                                    pContext->pData,
+                                                    pContext->uDataLength,
+                                                    &pContext->PublicKey,
+                                                    pContext->pCipherText,
+                                                    &pContext->uCipherTextLength);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    *a_ppContext = pContext;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaBench_Crypto_Clear(pContext);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaBench_Crypto_RunSymmetricSign
+ *===========================================================================*/
+static OpcUa_StatusCode UaBench_Crypto_RunSymmetricSign(OpcUa_Void*     a_pContext,
+                                                        OpcUa_UInt32    a_uIterations)
+{
+    UaBench_CryptoContext*  pContext    = (UaBench_CryptoContext*)a_pContext;
+    OpcUa_UInt32            uIteration  = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_Server, "Crypto_RunSymmetricSign");
+
+    for(uIteration = 0; uIteration < a_uIterations; uIteration++)
+    {
+        pContext->Signature.Length = UABENCH_CRYPTO_MAXSIGNATURE;
+
+        uStatus = pContext->Provider.SymmetricSign( &pContext->Provider,
+                                                    pContext->pData,
+                                                    pContext->uDataLength,
+                                                    &pContext->pServerKeyset->SigningKey,
+                                                    &pContext->Signature);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaBench_Crypto_RunSymmetricEncrypt
+ *===========================================================================*/
+static OpcUa_StatusCode UaBench_Crypto_RunSymmetricEncrypt( OpcUa_Void*     a_pContext,
+                                                            OpcUa_UInt32    a_uIterations)
+{
+    UaBench_CryptoContext*  pContext            = (UaBench_CryptoContext*)a_pContext;
+    OpcUa_UInt32            uIteration          = 0;
+    OpcUa_UInt32            uCipherTextLength   = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_Server, "Crypto_RunSymmetricEncrypt");
+
+    for(uIteration = 0; uIteration < a_uIterations; uIteration++)
+    {
+        uStatus = pContext->Provider.SymmetricEncrypt(  &pContext->Provider,
+                                                        pContext->pData,
+                                                        pContext->uDataLength,
+                                                        &pContext->pServerKeyset->EncryptionKey,
+                                                        pContext->pServerKeyset->InitializationVector.Key.Data,
+                                                        pContext->pCipherText,
+                                                        &uCipherTextLength);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaBench_Crypto_RunChunk
+ *===========================================================================*/
+/* sends one message per iteration the way OpcUa_SecureConnection does */
+static OpcUa_StatusCode UaBench_Crypto_RunChunk(OpcUa_Void*     a_pContext,
+                                                OpcUa_UInt32    a_uIterations)
+{
+    UaBench_CryptoContext*  pContext        = (UaBench_CryptoContext*)a_pContext;
+    OpcUa_OutputStream*     pSecureOstrm    = OpcUa_Null;
+    OpcUa_UInt32            uIteration      = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_Server, "Crypto_RunChunk");
+
+    for(uIteration = 0; uIteration < a_uIterations; uIteration++)
+    {
+        uStatus = OpcUa_SecureStream_CreateOutput(  &pContext->TransportStream,
+                                                    eOpcUa_SecureStream_Types_StandardMessage,
+                                                    uIteration + 1,
+                                                    pContext->pSecureChannel,
+                                                    &pSecureOstrm);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        uStatus = pSecureOstrm->Write(pSecureOstrm, pContext->pData, pContext->uDataLength);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        uStatus = pSecureOstrm->Flush(pSecureOstrm, OpcUa_True);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        OpcUa_Stream_Delete((OpcUa_Stream**)&pSecureOstrm);
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_Stream_Delete((OpcUa_Stream**)&pSecureOstrm);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaBench_Crypto_RunAsymmetricSign
+ *===========================================================================*/
+static OpcUa_StatusCode UaBench_Crypto_RunAsymmetricSign(   OpcUa_Void*     a_pContext,
+                                                            OpcUa_UInt32    a_uIterations)
+{
+    UaBench_CryptoContext*  pContext    = (UaBench_CryptoContext*)a_pContext;
+    OpcUa_UInt32            uIteration  = 0;
+    OpcUa_ByteString        bsData;
+
+OpcUa_InitializeStatus(OpcUa_Module_Server, "Crypto_RunAsymmetricSign");
+
+    bsData.Length = (OpcUa_Int32)pContext->uDataLength;
+    bsData.Data   = pContext->pData;
+
+    for(uIteration = 0; uIteration < a_uIterations; uIteration++)
+    {
+        pContext->Signature.Length = (OpcUa_Int32)pContext->uCipherTextLength;
+
+        uStatus = pContext->Provider.AsymmetricSign(&pContext->Provider, bsData, &pContext->PrivateKey, &pContext->Signature);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaBench_Crypto_RunAsymmetricVerify
+ *===========================================================================*/
+static OpcUa_StatusCode UaBench_Crypto_RunAsymmetricVerify( OpcUa_Void*     a_pContext,
+                                                            OpcUa_UInt32    a_uIterations)
+{
+    UaBench_CryptoContext*  pContext    = (UaBench_CryptoContext*)a_pContext;
+    OpcUa_UInt32            uIteration  = 0;
+    OpcUa_ByteString        bsData;
+
+OpcUa_InitializeStatus(OpcUa_Module_Server, "Crypto_RunAsymmetricVerify");
+
+    bsData.Length = (OpcUa_Int32)pContext->uDataLength;
+    bsData.Data   = pContext->pData;
+
+    for(uIteration = 0; uIteration < a_uIterations; uIteration++)
+    {
+        uStatus = pContext->Provider.AsymmetricVerify(&pContext->Provider, bsData, &pContext->PublicKey, &pContext->Signature);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaBench_Crypto_RunAsymmetricEncrypt
+ *===========================================================================*/
+static OpcUa_StatusCode UaBench_Crypto_RunAsymmetricEncrypt(OpcUa_Void*     a_pContext,
+                                                            OpcUa_UInt32    a_uIterations)
+{
+    UaBench_CryptoContext*  pContext            = (UaBench_CryptoContext*)a_pContext;
+    OpcUa_UInt32            uIteration          = 0;
+    OpcUa_UInt32            uCipherTextLength   = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_Server, "Crypto_RunAsymmetricEncrypt");
+
+    for(uIteration = 0; uIteration < a_uIterations; uIteration++)
+    {
+        uStatus = pContext->Provider.AsymmetricEncrypt( &pContext->Provider,
+                                                        pContext->pData,
+                                                        pContext->uDataLength,
+                                                        &pContext->PublicKey,
+                                                        pContext->pCipherText,
+                                                        &uCipherTextLength);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaBench_Crypto_RunAsymmetricDecrypt
+ *===========================================================================*/
+static OpcUa_StatusCode UaBench_Crypto_RunAsymmetricDecrypt(OpcUa_Void*     a_pContext,
+                                                            OpcUa_UInt32    a_uIterations)
+{
+    UaBench_CryptoContext*  pContext            = (UaBench_CryptoContext*)a_pContext;
+    OpcUa_UInt32            uIteration          = 0;
+    OpcUa_UInt32            uPlainTextLength    = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_Server, "Crypto_RunAsymmetricDecrypt");
+
+    for(uIteration = 0; uIteration < a_uIterations; uIteration++)
+    {
+        uStatus = pContext->Provider.AsymmetricDecrypt( &pContext->Provider,
+                                                        pContext->pCipherText,
+                                                        pContext->uCipherTextLength,
+                                                        &pContext->PrivateKey,
+                                                        pContext->pData,
+                                                        &uPlainTextLength);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * Case table
+ *===========================================================================*/
+#define UABENCH_CRYPTO_CASES(xName, xPolicy) \
+    { "crypto/" xName "/hmac_sign",     8192,   (OpcUa_Void*)xPolicy,   UaBench_Crypto_SetupSymmetric,  UaBench_Crypto_RunSymmetricSign,        UaBench_Crypto_Clear }, \
+    { "crypto/" xName "/aes_encrypt",   8192,   (OpcUa_Void*)xPolicy,   UaBench_Crypto_SetupSymmetric,  UaBench_Crypto_RunSymmetricEncrypt,     UaBench_Crypto_Clear }, \
+    { "crypto/" xName "/chunk",         65536,  (OpcUa_Void*)xPolicy,   UaBench_Crypto_SetupChunk,      UaBench_Crypto_RunChunk,                UaBench_Crypto_Clear }, \
+    { "crypto/" xName "/rsa_sign",      2048,   (OpcUa_Void*)xPolicy,   UaBench_Crypto_SetupAsymmetric, UaBench_Crypto_RunAsymmetricSign,       UaBench_Crypto_Clear }, \
+    { "crypto/" xName "/rsa_verify",    2048,   (OpcUa_Void*)xPolicy,   UaBench_Crypto_SetupAsymmetric, UaBench_Crypto_RunAsymmetricVerify,     UaBench_Crypto_Clear }, \
+    { "crypto/" xName "/rsa_encrypt",   2048,   (OpcUa_Void*)xPolicy,   UaBench_Crypto_SetupAsymmetric, UaBench_Crypto_RunAsymmetricEncrypt,    UaBench_Crypto_Clear }, \
+    { "crypto/" xName "/rsa_decrypt",   2048,   (OpcUa_Void*)xPolicy,   UaBench_Crypto_SetupAsymmetric, UaBench_Crypto_RunAsymmetricDecrypt,    UaBench_Crypto_Clear }
+
+UaBench_Case UaBench_g_CryptoCases[] =
+{
+    UABENCH_CRYPTO_CASES("Basic128Rsa15",           OpcUa_SecurityPolicy_Basic128Rsa15),
+    UABENCH_CRYPTO_CASES("Basic256",                OpcUa_SecurityPolicy_Basic256),
+    UABENCH_CRYPTO_CASES("Basic256Sha256",          OpcUa_SecurityPolicy_Basic256Sha256),
+    UABENCH_CRYPTO_CASES("Aes128_Sha256_RsaOaep",   OpcUa_SecurityPolicy_Aes128Sha256RsaOaep),
+    UABENCH_CRYPTO_CASES("Aes256_Sha256_RsaPss",    OpcUa_SecurityPolicy_Aes256Sha256RsaPss),
+    UABENCH_CASE_END
+};
+
+#else /* OPCUA_HAVE_OPENSSL */
+
+UaBench_Case UaBench_g_CryptoCases[] =
+{
+    UABENCH_CASE_END
+};
+
+#endif /* OPCUA_HAVE_OPENSSL */
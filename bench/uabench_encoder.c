@@ -0,0 +1,435 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+/******************************************************************************************************/
+/* Binary encoder and decoder benchmarks on representative service responses.                        */
+/******************************************************************************************************/
+
+#include <opcua.h>
+#include <opcua_core.h>
+#include <opcua_types.h>
+#include <opcua_memorystream.h>
+#include <opcua_binaryencoder.h>
+#include <opcua_encodeableobject.h>
+#include <opcua_identifiers.h>
+
+#include "uabench.h"
+
+extern OpcUa_EncodeableTypeTable    OpcUa_ProxyStub_g_EncodeableTypes;
+extern OpcUa_StringTable            OpcUa_ProxyStub_g_NamespaceUris;
+
+/** @brief The kinds of messages built by UaBench_Encoder_Setup. */
+#define UABENCH_MESSAGE_READ_SCALARS    0
+#define UABENCH_MESSAGE_READ_ARRAY      1
+#define UABENCH_MESSAGE_BROWSE          2
+
+/** @brief Growth size of the memory streams. */
+#define UABENCH_STREAM_BLOCKSIZE        65536
+
+/**
+ * @brief State of an encoder benchmark.
+ */
+typedef struct _UaBench_EncoderContext
+{
+    OpcUa_MessageContext    MessageContext;
+    OpcUa_EncodeableType*   pMessageType;
+    OpcUa_Void*             pMessage;
+    OpcUa_Encoder*          pEncoder;
+    OpcUa_Decoder*          pDecoder;
+    /** @brief Target of the encode benchmark; rewound for every message. */
+    OpcUa_OutputStream*     pOutputStream;
+    /** @brief Encoded copy of pMessage for the decode benchmark. */
+    OpcUa_OutputStream*     pEncodedStream;
+    /** @brief Reads from the buffer of pEncodedStream; rewound for every message. */
+    OpcUa_InputStream*      pInputStream;
+} UaBench_EncoderContext;
+
+/*============================================================================
+ * UaBench_Encoder_CreateReadResponse
+ *===========================================================================*/
+static OpcUa_StatusCode UaBench_Encoder_CreateReadResponse( OpcUa_UInt32        a_uNoOfValues,
+                                                            OpcUa_UInt32        a_uArrayLength,
+                                                            OpcUa_ReadResponse* a_pResponse)
+{
+    OpcUa_UInt32    uIndex  = 0;
+    OpcUa_UInt32    uItem   = 0;
+    OpcUa_DateTime  tNow    = OpcUa_DateTime_UtcNow();
+    OpcUa_DataValue* pValue = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_Server, "CreateReadResponse");
+
+    a_pResponse->ResponseHeader.Timestamp       = tNow;
+    a_pResponse->ResponseHeader.RequestHandle   = 1;
+    a_pResponse->ResponseHeader.ServiceResult   = OpcUa_Good;
+
+    a_pResponse->Results = (OpcUa_DataValue*)OpcUa_Alloc(a_uNoOfValues * sizeof(OpcUa_DataValue));
+    OpcUa_GotoErrorIfAllocFailed(a_pResponse->Results);
+    a_pResponse->NoOfResults = (OpcUa_Int32)a_uNoOfValues;
+
+    for(uIndex = 0; uIndex < a_uNoOfValues; uIndex++)
+    {
+        pValue = &a_pResponse->Results[uIndex];
+
+        OpcUa_DataValue_Initialize(pValue);
+        pValue->StatusCode      = OpcUa_Good;
+        pValue->SourceTimestamp = tNow;
+        pValue->ServerTimestamp = tNow;
+
+        if(a_uArrayLength == 0)
+        {
+            pValue->Value.Datatype          = OpcUaType_Double;
+            pValue->Value.ArrayType         = OpcUa_VariantArrayType_Scalar;
+            pValue->Value.Value.Double      = uIndex * 0.5;
+        }
+        else
+        {
+            pValue->Value.Datatype          = OpcUaType_Double;
+            pValue->Value.ArrayType         = OpcUa_VariantArrayType_Array;
+            pValue->Value.Value.Array.Value.DoubleArray = (OpcUa_Double*)OpcUa_Alloc(a_uArrayLength * sizeof(OpcUa_Double));
+            OpcUa_GotoErrorIfAllocFailed(pValue->Value.Value.Array.Value.DoubleArray);
+            pValue->Value.Value.Array.Length = (OpcUa_Int32)a_uArrayLength;
+
+            for(uItem = 0; uItem < a_uArrayLength; uItem++)
+            {
+                pValue->Value.Value.Array.Value.DoubleArray[uItem] = uItem * 0.25;
+            }
+        }
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaBench_Encoder_CreateBrowseResponse
+ *===========================================================================*/
+static OpcUa_StatusCode UaBench_Encoder_CreateBrowseResponse(   OpcUa_UInt32            a_uNoOfReferences,
+                                                                OpcUa_BrowseResponse*   a_pResponse)
+{
+    OpcUa_UInt32                uIndex      = 0;
+    OpcUa_ReferenceDescription* pReference  = OpcUa_Null;
+    OpcUa_CharA                 sName[32];
+
+OpcUa_InitializeStatus(OpcUa_Module_Server, "CreateBrowseResponse");
+
+    a_pResponse->ResponseHeader.Timestamp       = OpcUa_DateTime_UtcNow();
+    a_pResponse->ResponseHeader.RequestHandle   = 1;
+    a_pResponse->ResponseHeader.ServiceResult   = OpcUa_Good;
+
+    a_pResponse->Results = (OpcUa_BrowseResult*)OpcUa_Alloc(sizeof(OpcUa_BrowseResult));
+    OpcUa_GotoErrorIfAllocFailed(a_pResponse->Results);
+    OpcUa_BrowseResult_Initialize(a_pResponse->Results);
+    a_pResponse->NoOfResults = 1;
+
+    a_pResponse->Results->References = (OpcUa_ReferenceDescription*)OpcUa_Alloc(a_uNoOfReferences * sizeof(OpcUa_ReferenceDescription));
+    OpcUa_GotoErrorIfAllocFailed(a_pResponse->Results->References);
+    a_pResponse->Results->NoOfReferences = (OpcUa_Int32)a_uNoOfReferences;
+
+    for(uIndex = 0; uIndex < a_uNoOfReferences; uIndex++)
+    {
+        pReference = &a_pResponse->Results->References[uIndex];
+
+        OpcUa_ReferenceDescription_Initialize(pReference);
+        OpcUa_SPrintfA(sName,
+#if OPCUA_USE_SAFE_FUNCTIONS
+                       sizeof(sName),
+#endif
+                       "Variable%u",
+                       (unsigned int)uIndex);
+
+        pReference->ReferenceTypeId.IdentifierType      = OpcUa_IdentifierType_Numeric;
+        pReference->ReferenceTypeId.Identifier.Numeric  = OpcUaId_Organizes;
+        pReference->IsForward                           = OpcUa_True;
+        pReference->NodeId.NodeId.IdentifierType        = OpcUa_IdentifierType_Numeric;
+        pReference->NodeId.NodeId.NamespaceIndex        = 1;
+        pReference->NodeId.NodeId.Identifier.Numeric    = 1000 + uIndex;
+        pReference->BrowseName.NamespaceIndex           = 1;
+        pReference->NodeClass                           = OpcUa_NodeClass_Variable;
+        pReference->TypeDefinition.NodeId.IdentifierType     = OpcUa_IdentifierType_Numeric;
+        pReference->TypeDefinition.NodeId.Identifier.Numeric = OpcUaId_BaseDataVariableType;
+
+        uStatus = OpcUa_String_AttachCopy(&pReference->BrowseName.Name, sName);
+        OpcUa_GotoErrorIfBad(uStatus);
+        uStatus = OpcUa_String_AttachCopy(&pReference->DisplayName.Text, sName);
+        OpcUa_GotoErrorIfBad(uStatus);
+        uStatus = OpcUa_String_AttachReadOnly(&pReference->DisplayName.Locale, "en");
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaBench_Encoder_Clear
+ *===========================================================================*/
+static OpcUa_Void UaBench_Encoder_Clear(OpcUa_Void* a_pContext)
+{
+    UaBench_EncoderContext* pContext = (UaBench_EncoderContext*)a_pContext;
+
+    if(pContext == OpcUa_Null)
+    {
+        return;
+    }
+
+    if(pContext->pInputStream != OpcUa_Null)
+    {
+        pContext->pInputStream->Close((OpcUa_Stream*)pContext->pInputStream);
+        pContext->pInputStream->Delete((OpcUa_Stream**)&pContext->pInputStream);
+    }
+
+    if(pContext->pEncodedStream != OpcUa_Null)
+    {
+        pContext->pEncodedStream->Delete((OpcUa_Stream**)&pContext->pEncodedStream);
+    }
+
+    if(pContext->pOutputStream != OpcUa_Null)
+    {
+        pContext->pOutputStream->Close((OpcUa_Stream*)pContext->pOutputStream);
+        pContext->pOutputStream->Delete((OpcUa_Stream**)&pContext->pOutputStream);
+    }
+
+    OpcUa_Encoder_Delete(&pContext->pEncoder);
+    OpcUa_Decoder_Delete(&pContext->pDecoder);
+
+    if(pContext->pMessage != OpcUa_Null)
+    {
+        OpcUa_EncodeableObject_Delete(pContext->pMessageType, &pContext->pMessage);
+    }
+
+    OpcUa_MessageContext_Clear(&pContext->MessageContext);
+
+    OpcUa_Free(pContext);
+}
+
+/*============================================================================
+ * UaBench_Encoder_Setup
+ *===========================================================================*/
+static OpcUa_StatusCode UaBench_Encoder_Setup(  OpcUa_UInt32    a_uMessage,
+                                                OpcUa_UInt32    a_uCount,
+                                                OpcUa_Void**    a_ppContext)
+{
+    UaBench_EncoderContext* pContext        = OpcUa_Null;
+    OpcUa_Handle            hEncodeContext  = OpcUa_Null;
+    OpcUa_Byte*             pBuffer         = OpcUa_Null;
+    OpcUa_UInt32            uBufferSize     = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_Server, "Encoder_Setup");
+
+    pContext = (UaBench_EncoderContext*)OpcUa_Alloc(sizeof(UaBench_EncoderContext));
+    OpcUa_GotoErrorIfAllocFailed(pContext);
+    OpcUa_MemSet(pContext, 0, sizeof(UaBench_EncoderContext));
+
+    OpcUa_MessageContext_Initialize(&pContext->MessageContext);
+    pContext->MessageContext.KnownTypes         = &OpcUa_ProxyStub_g_EncodeableTypes;
+    pContext->MessageContext.NamespaceUris      = &OpcUa_ProxyStub_g_NamespaceUris;
+    pContext->MessageContext.AlwaysCheckLengths = OpcUa_False;
+
+    switch(a_uMessage)
+    {
+    case UABENCH_MESSAGE_READ_SCALARS:
+    case UABENCH_MESSAGE_READ_ARRAY:
+        {
+            pContext->pMessageType = &OpcUa_ReadResponse_EncodeableType;
+            uStatus = OpcUa_EncodeableObject_Create(pContext->pMessageType, &pContext->pMessage);
+            OpcUa_GotoErrorIfBad(uStatus);
+
+            if(a_uMessage == UABENCH_MESSAGE_READ_SCALARS)
+            {
+                uStatus = UaBench_Encoder_CreateReadResponse(a_uCount, 0, (OpcUa_ReadResponse*)pContext->pMessage);
+            }
+            else
+            {
+                uStatus = UaBench_Encoder_CreateReadResponse(1, a_uCount, (OpcUa_ReadResponse*)pContext->pMessage);
+            }
+            OpcUa_GotoErrorIfBad(uStatus);
+            break;
+        }
+    case UABENCH_MESSAGE_BROWSE:
+        {
+            pContext->pMessageType = &OpcUa_BrowseResponse_EncodeableType;
+            uStatus = OpcUa_EncodeableObject_Create(pContext->pMessageType, &pContext->pMessage);
+            OpcUa_GotoErrorIfBad(uStatus);
+
+            uStatus = UaBench_Encoder_CreateBrowseResponse(a_uCount, (OpcUa_BrowseResponse*)pContext->pMessage);
+            OpcUa_GotoErrorIfBad(uStatus);
+            break;
+        }
+    default:
+        {
+            OpcUa_GotoErrorWithStatus(OpcUa_BadInvalidArgument);
+        }
+    }
+
+    uStatus = OpcUa_BinaryEncoder_Create(&pContext->pEncoder);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = OpcUa_BinaryDecoder_Create(&pContext->pDecoder);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = OpcUa_MemoryStream_CreateWriteable(UABENCH_STREAM_BLOCKSIZE, 0, &pContext->pOutputStream);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* encode the message once for the decode benchmark */
+    uStatus = OpcUa_MemoryStream_CreateWriteable(UABENCH_STREAM_BLOCKSIZE, 0, &pContext->pEncodedStream);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = pContext->pEncoder->Open(pContext->pEncoder, pContext->pEncodedStream, &pContext->MessageContext, &hEncodeContext);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = pContext->pEncoder->WriteMessage((OpcUa_Encoder*)hEncodeContext, pContext->pMessage, pContext->pMessageType);
+    OpcUa_Encoder_Close(pContext->pEncoder, &hEncodeContext);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = pContext->pEncodedStream->Close((OpcUa_Stream*)pContext->pEncodedStream);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = OpcUa_MemoryStream_GetBuffer(pContext->pEncodedStream, &pBuffer, &uBufferSize);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = OpcUa_MemoryStream_CreateReadable(pBuffer, uBufferSize, &pContext->pInputStream);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    *a_ppContext = pContext;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaBench_Encoder_Clear(pContext);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaBench_Encoder_SetupReadScalars
+ *===========================================================================*/
+/* ReadResponse with a_uParameter scalar Double values */
+static OpcUa_StatusCode UaBench_Encoder_SetupReadScalars(   OpcUa_UInt32    a_uParameter,
+                                                            OpcUa_Void*     a_pArgument,
+                                                            OpcUa_Void**    a_ppContext)
+{
+    OpcUa_ReferenceParameter(a_pArgument);
+    return UaBench_Encoder_Setup(UABENCH_MESSAGE_READ_SCALARS, a_uParameter, a_ppContext);
+}
+
+/*============================================================================
+ * UaBench_Encoder_SetupReadArray
+ *===========================================================================*/
+/* ReadResponse with one Double array of a_uParameter elements */
+static OpcUa_StatusCode UaBench_Encoder_SetupReadArray( OpcUa_UInt32    a_uParameter,
+                                                        OpcUa_Void*     a_pArgument,
+                                                        OpcUa_Void**    a_ppContext)
+{
+    OpcUa_ReferenceParameter(a_pArgument);
+    return UaBench_Encoder_Setup(UABENCH_MESSAGE_READ_ARRAY, a_uParameter, a_ppContext);
+}
+
+/*============================================================================
+ * UaBench_Encoder_SetupBrowse
+ *===========================================================================*/
+/* BrowseResponse with one result of a_uParameter references */
+static OpcUa_StatusCode UaBench_Encoder_SetupBrowse(OpcUa_UInt32    a_uParameter,
+                                                    OpcUa_Void*     a_pArgument,
+                                                    OpcUa_Void**    a_ppContext)
+{
+    OpcUa_ReferenceParameter(a_pArgument);
+    return UaBench_Encoder_Setup(UABENCH_MESSAGE_BROWSE, a_uParameter, a_ppContext);
+}
+
+/*============================================================================
+ * UaBench_Encoder_RunEncode
+ *===========================================================================*/
+static OpcUa_StatusCode UaBench_Encoder_RunEncode(  OpcUa_Void*     a_pContext,
+                                                    OpcUa_UInt32    a_uIterations)
+{
+    UaBench_EncoderContext* pContext        = (UaBench_EncoderContext*)a_pContext;
+    OpcUa_Handle            hEncodeContext  = OpcUa_Null;
+    OpcUa_UInt32            uIteration      = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_Server, "Encoder_RunEncode");
+
+    for(uIteration = 0; uIteration < a_uIterations; uIteration++)
+    {
+        uStatus = pContext->pOutputStream->SetPosition((OpcUa_Stream*)pContext->pOutputStream, 0);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        uStatus = pContext->pEncoder->Open(pContext->pEncoder, pContext->pOutputStream, &pContext->MessageContext, &hEncodeContext);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        uStatus = pContext->pEncoder->WriteMessage((OpcUa_Encoder*)hEncodeContext, pContext->pMessage, pContext->pMessageType);
+        OpcUa_Encoder_Close(pContext->pEncoder, &hEncodeContext);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaBench_Encoder_RunDecode
+ *===========================================================================*/
+static OpcUa_StatusCode UaBench_Encoder_RunDecode(  OpcUa_Void*     a_pContext,
+                                                    OpcUa_UInt32    a_uIterations)
+{
+    UaBench_EncoderContext* pContext        = (UaBench_EncoderContext*)a_pContext;
+    OpcUa_Handle            hDecodeContext  = OpcUa_Null;
+    OpcUa_EncodeableType*   pMessageType    = OpcUa_Null;
+    OpcUa_Void*             pMessage        = OpcUa_Null;
+    OpcUa_UInt32            uIteration      = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_Server, "Encoder_RunDecode");
+
+    for(uIteration = 0; uIteration < a_uIterations; uIteration++)
+    {
+        uStatus = pContext->pInputStream->SetPosition((OpcUa_Stream*)pContext->pInputStream, 0);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        uStatus = pContext->pDecoder->Open(pContext->pDecoder, pContext->pInputStream, &pContext->MessageContext, &hDecodeContext);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        pMessageType = pContext->pMessageType;
+        uStatus = pContext->pDecoder->ReadMessage((OpcUa_Decoder*)hDecodeContext, &pMessageType, &pMessage);
+        OpcUa_Decoder_Close(pContext->pDecoder, &hDecodeContext);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        OpcUa_EncodeableObject_Delete(pMessageType, &pMessage);
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * Case table
+ *===========================================================================*/
+UaBench_Case UaBench_g_EncoderCases[] =
+{
+    { "encode/ReadResponse",        1,      OpcUa_Null, UaBench_Encoder_SetupReadScalars,   UaBench_Encoder_RunEncode,  UaBench_Encoder_Clear },
+    { "encode/ReadResponse",        100,    OpcUa_Null, UaBench_Encoder_SetupReadScalars,   UaBench_Encoder_RunEncode,  UaBench_Encoder_Clear },
+    { "encode/ReadResponse",        1000,   OpcUa_Null, UaBench_Encoder_SetupReadScalars,   UaBench_Encoder_RunEncode,  UaBench_Encoder_Clear },
+    { "encode/ReadResponseArray",   10000,  OpcUa_Null, UaBench_Encoder_SetupReadArray,     UaBench_Encoder_RunEncode,  UaBench_Encoder_Clear },
+    { "encode/BrowseResponse",      100,    OpcUa_Null, UaBench_Encoder_SetupBrowse,        UaBench_Encoder_RunEncode,  UaBench_Encoder_Clear },
+    { "decode/ReadResponse",        1,      OpcUa_Null, UaBench_Encoder_SetupReadScalars,   UaBench_Encoder_RunDecode,  UaBench_Encoder_Clear },
+    { "decode/ReadResponse",        100,    OpcUa_Null, UaBench_Encoder_SetupReadScalars,   UaBench_Encoder_RunDecode,  UaBench_Encoder_Clear },
+    { "decode/ReadResponse",        1000,   OpcUa_Null, UaBench_Encoder_SetupReadScalars,   UaBench_Encoder_RunDecode,  UaBench_Encoder_Clear },
+    { "decode/ReadResponseArray",   10000,  OpcUa_Null, UaBench_Encoder_SetupReadArray,     UaBench_Encoder_RunDecode,  UaBench_Encoder_Clear },
+    { "decode/BrowseResponse",      100,    OpcUa_Null, UaBench_Encoder_SetupBrowse,        UaBench_Encoder_RunDecode,  UaBench_Encoder_Clear },
+    UABENCH_CASE_END
+};
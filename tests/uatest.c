@@ -0,0 +1,234 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+/******************************************************************************************************/
+/* Behavioral tests for the stack and the sample server modules.                                     */
+/*                                                                                                    */
+/* Every case runs on a freshly initialized platform layer and proxy stub. A case reports each failed */
+/* check with file and line and ends with its result:                                                 */
+/*                                                                                                    */
+/*   ok sample/nodeindex                                                                              */
+/*   FAILED sample/nodeindex (0x80000000)                                                             */
+/******************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <opcua_proxystub.h>
+
+#include "uatest.h"
+
+/*============================================================================
+ * Globals
+ *===========================================================================*/
+static OpcUa_Handle                 UaTest_g_PlatformLayerHandle    = OpcUa_Null;
+static OpcUa_ProxyStubConfiguration UaTest_g_ProxyStubConfiguration;
+
+static UaTest_Case*                 UaTest_g_CaseTables[]           =
+{
+    UaTest_g_BrowseCases,
+    UaTest_g_SessionCases,
+    UaTest_g_ValueStoreCases,
+    UaTest_g_SubscriptionCases,
+    UaTest_g_ReadCases,
+    UaTest_g_AddressSpaceImageCases,
+    UaTest_g_ServerCases,
+    UaTest_g_HttpsCases,
+    UaTest_g_HttpsStreamCases,
+    UaTest_g_SecureListenerCases,
+    UaTest_g_SecureStreamCases,
+    UaTest_g_SecureConnectionCases,
+    UaTest_g_LatencyCases,
+    UaTest_g_PkiCases,
+    UaTest_g_EndpointCases,
+    UaTest_g_TraceCases,
+    UaTest_g_SslProfileCases,
+    OpcUa_Null
+};
+
+/*============================================================================
+ * UaTest_Fail
+ *===========================================================================*/
+OpcUa_Void UaTest_Fail( const OpcUa_CharA*  a_sFile,
+                        OpcUa_Int           a_iLine,
+                        const OpcUa_CharA*  a_sCondition)
+{
+    fprintf(stderr, "%s(%d): check failed: %s\n", a_sFile, a_iLine, a_sCondition);
+    fflush(stderr);
+}
+
+/*============================================================================
+ * UaTest_Initialize
+ *===========================================================================*/
+static OpcUa_StatusCode UaTest_Initialize(OpcUa_Void)
+{
+    OpcUa_StatusCode uStatus = OpcUa_Good;
+
+    memset(&UaTest_g_ProxyStubConfiguration, 0, sizeof(OpcUa_ProxyStubConfiguration));
+
+    UaTest_g_ProxyStubConfiguration.bProxyStub_Trace_Enabled              = OpcUa_False;
+    UaTest_g_ProxyStubConfiguration.uProxyStub_Trace_Level                = OPCUA_TRACE_OUTPUT_LEVEL_NONE;
+    UaTest_g_ProxyStubConfiguration.iSerializer_MaxAlloc                  = -1;
+    UaTest_g_ProxyStubConfiguration.iSerializer_MaxStringLength           = -1;
+    UaTest_g_ProxyStubConfiguration.iSerializer_MaxByteStringLength       = -1;
+    UaTest_g_ProxyStubConfiguration.iSerializer_MaxArrayLength            = -1;
+    UaTest_g_ProxyStubConfiguration.iSerializer_MaxMessageSize            = -1;
+    UaTest_g_ProxyStubConfiguration.iSerializer_MaxRecursionDepth         = -1;
+    UaTest_g_ProxyStubConfiguration.bSecureListener_ThreadPool_Enabled    = OpcUa_False;
+    UaTest_g_ProxyStubConfiguration.iSecureListener_ThreadPool_MinThreads = -1;
+    UaTest_g_ProxyStubConfiguration.iSecureListener_ThreadPool_MaxThreads = -1;
+    UaTest_g_ProxyStubConfiguration.iSecureListener_ThreadPool_MaxJobs    = -1;
+    UaTest_g_ProxyStubConfiguration.bSecureListener_ThreadPool_BlockOnAdd = OpcUa_True;
+    UaTest_g_ProxyStubConfiguration.uSecureListener_ThreadPool_Timeout    = OPCUA_INFINITE;
+    UaTest_g_ProxyStubConfiguration.iSecureListener_CryptoPool_Threads    = -1;
+    UaTest_g_ProxyStubConfiguration.iSecureListener_CryptoPool_MaxJobs    = -1;
+    UaTest_g_ProxyStubConfiguration.bTcpListener_ClientThreadsEnabled     = OpcUa_False;
+    UaTest_g_ProxyStubConfiguration.iTcpListener_DefaultChunkSize         = -1;
+    UaTest_g_ProxyStubConfiguration.iTcpConnection_DefaultChunkSize       = -1;
+    UaTest_g_ProxyStubConfiguration.iTcpTransport_MaxMessageLength        = -1;
+    UaTest_g_ProxyStubConfiguration.iTcpTransport_MaxChunkCount           = -1;
+    UaTest_g_ProxyStubConfiguration.bTcpStream_ExpectWriteToBlock         = OpcUa_True;
+    UaTest_g_ProxyStubConfiguration.iHttpsTransport_MaxPipelinedRequests  = -1;
+
+    uStatus = OpcUa_P_Initialize(&UaTest_g_PlatformLayerHandle);
+    if(OpcUa_IsBad(uStatus))
+    {
+        return uStatus;
+    }
+
+    uStatus = OpcUa_ProxyStub_Initialize(   UaTest_g_PlatformLayerHandle,
+                                            &UaTest_g_ProxyStubConfiguration);
+    if(OpcUa_IsBad(uStatus))
+    {
+        OpcUa_P_Clean(&UaTest_g_PlatformLayerHandle);
+    }
+
+    return uStatus;
+}
+
+/*============================================================================
+ * UaTest_Clear
+ *===========================================================================*/
+static OpcUa_Void UaTest_Clear(OpcUa_Void)
+{
+    OpcUa_ProxyStub_Clear();
+    OpcUa_P_Clean(&UaTest_g_PlatformLayerHandle);
+}
+
+/*============================================================================
+ * UaTest_RunCase
+ *===========================================================================*/
+static OpcUa_StatusCode UaTest_RunCase(UaTest_Case* a_pCase)
+{
+    OpcUa_StatusCode uStatus = OpcUa_Good;
+
+    uStatus = UaTest_Initialize();
+    if(OpcUa_IsBad(uStatus))
+    {
+        fprintf(stderr, "%s: initialization failed with 0x%08X\n", a_pCase->Name, uStatus);
+        return uStatus;
+    }
+
+    uStatus = a_pCase->Run();
+
+    UaTest_Clear();
+
+    if(OpcUa_IsBad(uStatus))
+    {
+        printf("FAILED %s (0x%08X)\n", a_pCase->Name, uStatus);
+    }
+    else
+    {
+        printf("ok %s\n", a_pCase->Name);
+    }
+    fflush(stdout);
+
+    return uStatus;
+}
+
+/*============================================================================
+ * UaTest_Usage
+ *===========================================================================*/
+static OpcUa_Void UaTest_Usage(const char* a_sProgram)
+{
+    fprintf(stderr,
+            "usage: %s [-l] [-f filter]\n"
+            "  -l  list the cases and exit\n"
+            "  -f  only run cases whose name contains filter\n",
+            a_sProgram);
+}
+
+/*============================================================================
+ * main
+ *===========================================================================*/
+int main(int argc, char* argv[])
+{
+    const char*         sFilter     = OpcUa_Null;
+    OpcUa_Boolean       bList       = OpcUa_False;
+    OpcUa_UInt32        uRun        = 0;
+    OpcUa_UInt32        uFailed     = 0;
+    UaTest_Case*        pCase       = OpcUa_Null;
+    int                 iArg        = 0;
+    int                 iTable      = 0;
+
+    for(iArg = 1; iArg < argc; iArg++)
+    {
+        if(strcmp(argv[iArg], "-l") == 0)
+        {
+            bList = OpcUa_True;
+        }
+        else if(strcmp(argv[iArg], "-f") == 0 && iArg + 1 < argc)
+        {
+            sFilter = argv[++iArg];
+        }
+        else
+        {
+            UaTest_Usage(argv[0]);
+            return 2;
+        }
+    }
+
+    for(iTable = 0; UaTest_g_CaseTables[iTable] != OpcUa_Null; iTable++)
+    {
+        for(pCase = UaTest_g_CaseTables[iTable]; pCase->Name != OpcUa_Null; pCase++)
+        {
+            if(sFilter != OpcUa_Null && strstr(pCase->Name, sFilter) == OpcUa_Null)
+            {
+                continue;
+            }
+
+            if(bList != OpcUa_False)
+            {
+                printf("%s\n", pCase->Name);
+                continue;
+            }
+
+            uRun++;
+            if(OpcUa_IsBad(UaTest_RunCase(pCase)))
+            {
+                uFailed++;
+            }
+        }
+    }
+
+    if(bList == OpcUa_False && uRun == 0)
+    {
+        fprintf(stderr, "no case matches the filter\n");
+        return 2;
+    }
+
+    return (uFailed == 0)?0:1;
+}
@@ -0,0 +1,78 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#ifndef _UaTest_H_
+#define _UaTest_H_ 1
+
+#include <opcua.h>
+
+OPCUA_BEGIN_EXTERN_C
+
+/**
+ * @brief Executes one test case. Bad if a check failed.
+ */
+typedef OpcUa_StatusCode (UaTest_PfnRun)(OpcUa_Void);
+
+/**
+ * @brief A test case.
+ */
+typedef struct _UaTest_Case
+{
+    /** @brief Unique name; groups are separated with '/'. */
+    const OpcUa_CharA*  Name;
+    UaTest_PfnRun*      Run;
+} UaTest_Case;
+
+/** @brief Terminates a case table. */
+#define UATEST_CASE_END { OpcUa_Null, OpcUa_Null }
+
+/**
+ * @brief Reports a failed check.
+ */
+OpcUa_Void UaTest_Fail( const OpcUa_CharA*  sFile,
+                        OpcUa_Int           iLine,
+                        const OpcUa_CharA*  sCondition);
+
+/**
+ * @brief Fails the case and jumps to its error handling if the condition is false.
+ */
+#define UATEST_CHECK(xCondition) \
+    do { if(!(xCondition)) { UaTest_Fail(__FILE__, __LINE__, #xCondition); uStatus = OpcUa_Bad; goto Error; } } while(0)
+
+/*============================================================================
+ * Case tables of the test modules.
+ *===========================================================================*/
+extern UaTest_Case UaTest_g_BrowseCases[];
+extern UaTest_Case UaTest_g_SessionCases[];
+extern UaTest_Case UaTest_g_ValueStoreCases[];
+extern UaTest_Case UaTest_g_SubscriptionCases[];
+extern UaTest_Case UaTest_g_ReadCases[];
+extern UaTest_Case UaTest_g_AddressSpaceImageCases[];
+extern UaTest_Case UaTest_g_ServerCases[];
+extern UaTest_Case UaTest_g_HttpsCases[];
+extern UaTest_Case UaTest_g_HttpsStreamCases[];
+extern UaTest_Case UaTest_g_SecureListenerCases[];
+extern UaTest_Case UaTest_g_SecureStreamCases[];
+extern UaTest_Case UaTest_g_SecureConnectionCases[];
+extern UaTest_Case UaTest_g_LatencyCases[];
+extern UaTest_Case UaTest_g_PkiCases[];
+extern UaTest_Case UaTest_g_EndpointCases[];
+extern UaTest_Case UaTest_g_TraceCases[];
+extern UaTest_Case UaTest_g_SslProfileCases[];
+
+OPCUA_END_EXTERN_C
+
+#endif /* _UaTest_H_ */
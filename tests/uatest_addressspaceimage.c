@@ -0,0 +1,653 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+
+/******************************************************************************************************/
+/* Tests for the address space image of the sample server: a compiled and mapped image describes     */
+/* the same address space as its source, and damaged images are not mapped.                         */
+/******************************************************************************************************/
+
+#include <opcua_serverstub.h>
+#include <opcua_memory.h>
+#include <opcua_string.h>
+
+#include "addressspace.h"
+#include "addressspace_image.h"
+#include "browseservice.h"
+
+#include "uatest.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*============================================================================
+ * Types and constants
+ *===========================================================================*/
+#define UATEST_IMAGE_PATH_LENGTH    64
+
+/** @brief The image file and the bytes of the image compiled from the built-in address space. */
+typedef struct _UaTest_Image
+{
+    OpcUa_CharA     sFile[UATEST_IMAGE_PATH_LENGTH];
+    OpcUa_Byte*     pImage;
+    OpcUa_UInt32    uSize;
+} UaTest_Image;
+
+/** @brief Damages one field of an image. */
+typedef OpcUa_Void (UaTest_Image_PfnDamage)(OpcUa_Byte* a_pImage, OpcUa_UInt32* a_puSize);
+
+static UaTest_Image UaTest_g_Image;
+
+/*============================================================================
+ * UaTest_Image_CreateFile
+ *===========================================================================*/
+static OpcUa_StatusCode UaTest_Image_CreateFile(OpcUa_Void)
+{
+    int iFile = -1;
+
+    strcpy(UaTest_g_Image.sFile, "/tmp/uatest_image_XXXXXX");
+    iFile = mkstemp(UaTest_g_Image.sFile);
+    if(iFile < 0)
+    {
+        UaTest_g_Image.sFile[0] = '\0';
+        return OpcUa_BadInternalError;
+    }
+    close(iFile);
+    return OpcUa_Good;
+}
+
+/*============================================================================
+ * UaTest_Image_Open
+ *===========================================================================*/
+/* compiles the built-in address space into a temporary file and reads the file back */
+static OpcUa_StatusCode UaTest_Image_Open(OpcUa_Void)
+{
+    _AddressSpaceTables_    Tables;
+    FILE*                   pFile   = OpcUa_Null;
+    long                    iSize   = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Image_Open");
+
+    OpcUa_MemSet(&UaTest_g_Image, 0, sizeof(UaTest_g_Image));
+
+    uStatus = UaTest_Image_CreateFile();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    get_builtin_addressspace(&Tables);
+    uStatus = compile_addressspace_image(&Tables, UaTest_g_Image.sFile);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    pFile = fopen(UaTest_g_Image.sFile, "rb");
+    OpcUa_GotoErrorIfTrue(pFile == OpcUa_Null, OpcUa_BadInternalError);
+    fseek(pFile, 0, SEEK_END);
+    iSize = ftell(pFile);
+    fseek(pFile, 0, SEEK_SET);
+    OpcUa_GotoErrorIfTrue(iSize < (long)sizeof(_ImageHeader_), OpcUa_BadInternalError);
+
+    UaTest_g_Image.uSize = (OpcUa_UInt32)iSize;
+    UaTest_g_Image.pImage = (OpcUa_Byte*)OpcUa_Alloc(UaTest_g_Image.uSize);
+    OpcUa_GotoErrorIfAllocFailed(UaTest_g_Image.pImage);
+    OpcUa_GotoErrorIfTrue(fread(UaTest_g_Image.pImage, 1, UaTest_g_Image.uSize, pFile) != UaTest_g_Image.uSize, OpcUa_BadInternalError);
+    fclose(pFile);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    if(pFile != OpcUa_Null)
+    {
+        fclose(pFile);
+    }
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Image_Clear
+ *===========================================================================*/
+static OpcUa_Void UaTest_Image_Clear(OpcUa_Void)
+{
+    unmap_addressspace_image();
+    clear_node_index();
+
+    if(UaTest_g_Image.sFile[0] != '\0')
+    {
+        unlink(UaTest_g_Image.sFile);
+    }
+    if(UaTest_g_Image.pImage != OpcUa_Null)
+    {
+        OpcUa_Free(UaTest_g_Image.pImage);
+    }
+    OpcUa_MemSet(&UaTest_g_Image, 0, sizeof(UaTest_g_Image));
+}
+
+/*============================================================================
+ * UaTest_Image_SameString
+ *===========================================================================*/
+static OpcUa_Boolean UaTest_Image_SameString(OpcUa_StringA a_sMapped, OpcUa_StringA a_sSource)
+{
+    if(a_sMapped == OpcUa_Null || a_sSource == OpcUa_Null)
+    {
+        return (OpcUa_Boolean)(a_sMapped == a_sSource);
+    }
+    return (OpcUa_Boolean)(strcmp(a_sMapped, a_sSource) == 0);
+}
+
+/*============================================================================
+ * UaTest_Image_SameNodeId
+ *===========================================================================*/
+static OpcUa_Boolean UaTest_Image_SameNodeId(const OpcUa_NodeId* a_pMapped, const OpcUa_NodeId* a_pSource)
+{
+    return (OpcUa_Boolean)(    a_pMapped->IdentifierType == OpcUa_IdentifierType_Numeric
+                            && a_pSource->IdentifierType == OpcUa_IdentifierType_Numeric
+                            && a_pMapped->NamespaceIndex == a_pSource->NamespaceIndex
+                            && a_pMapped->Identifier.Numeric == a_pSource->Identifier.Numeric);
+}
+
+/*============================================================================
+ * UaTest_Image_SameBase
+ *===========================================================================*/
+/* the common attributes and every reference of a node */
+static OpcUa_Boolean UaTest_Image_SameBase(const _BaseAttribute_* a_pMapped, const _BaseAttribute_* a_pSource)
+{
+    const _ReferenceNode_*  pMapped = OpcUa_Null;
+    const _ReferenceNode_*  pSource = OpcUa_Null;
+    OpcUa_Int32             i       = 0;
+
+    if(    UaTest_Image_SameNodeId(&a_pMapped->NodeId, &a_pSource->NodeId) == OpcUa_False
+        || a_pMapped->NodeClass != a_pSource->NodeClass
+        || UaTest_Image_SameString(a_pMapped->BrowseName, a_pSource->BrowseName) == OpcUa_False
+        || UaTest_Image_SameString(a_pMapped->DisplayName, a_pSource->DisplayName) == OpcUa_False
+        || a_pMapped->NoOfReferences != a_pSource->NoOfReferences)
+    {
+        return OpcUa_False;
+    }
+
+    for(i = 0; i < a_pSource->NoOfReferences; i++)
+    {
+        pMapped = &a_pMapped->References[i];
+        pSource = &a_pSource->References[i];
+        if(    UaTest_Image_SameNodeId(&pMapped->ReferenceTypeId, &pSource->ReferenceTypeId) == OpcUa_False
+            || UaTest_Image_SameNodeId(&pMapped->Target_NodeId, &pSource->Target_NodeId) == OpcUa_False
+            || (pMapped->IsInverse != OpcUa_False) != (pSource->IsInverse != OpcUa_False)
+            || UaTest_Image_SameString(pMapped->Target_NamespaceUri, pSource->Target_NamespaceUri) == OpcUa_False)
+        {
+            return OpcUa_False;
+        }
+    }
+    return OpcUa_True;
+}
+
+/*============================================================================
+ * UaTest_Image_SameTables
+ *===========================================================================*/
+/* every node of every node class, in the order of the source */
+static OpcUa_StatusCode UaTest_Image_SameTables(const _AddressSpaceTables_* a_pMapped, const _AddressSpaceTables_* a_pSource)
+{
+    OpcUa_Int i = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Image_SameTables");
+
+    UATEST_CHECK(a_pMapped->NoOfObjectTypes == a_pSource->NoOfObjectTypes);
+    UATEST_CHECK(a_pMapped->NoOfObjects == a_pSource->NoOfObjects);
+    UATEST_CHECK(a_pMapped->NoOfReferenceTypes == a_pSource->NoOfReferenceTypes);
+    UATEST_CHECK(a_pMapped->NoOfVariables == a_pSource->NoOfVariables);
+    UATEST_CHECK(a_pMapped->NoOfVariableTypes == a_pSource->NoOfVariableTypes);
+    UATEST_CHECK(a_pMapped->NoOfDataTypes == a_pSource->NoOfDataTypes);
+
+    for(i = 0; i < a_pSource->NoOfObjectTypes; i++)
+    {
+        UATEST_CHECK(UaTest_Image_SameBase(&a_pMapped->ObjectTypes[i].BaseAttribute, &a_pSource->ObjectTypes[i].BaseAttribute));
+        UATEST_CHECK(a_pMapped->ObjectTypes[i].IsAbstract == a_pSource->ObjectTypes[i].IsAbstract);
+    }
+    for(i = 0; i < a_pSource->NoOfObjects; i++)
+    {
+        UATEST_CHECK(UaTest_Image_SameBase(&a_pMapped->Objects[i].BaseAttribute, &a_pSource->Objects[i].BaseAttribute));
+        UATEST_CHECK(a_pMapped->Objects[i].EventNotifier == a_pSource->Objects[i].EventNotifier);
+    }
+    for(i = 0; i < a_pSource->NoOfReferenceTypes; i++)
+    {
+        const _ReferenceTypeKnoten_* pMapped = &a_pMapped->ReferenceTypes[i];
+        const _ReferenceTypeKnoten_* pSource = &a_pSource->ReferenceTypes[i];
+
+        UATEST_CHECK(UaTest_Image_SameBase(&pMapped->BaseAttribute, &pSource->BaseAttribute));
+        UATEST_CHECK(pMapped->IsAbstract == pSource->IsAbstract);
+        UATEST_CHECK(pMapped->Symmetric == pSource->Symmetric);
+        UATEST_CHECK(UaTest_Image_SameString(pMapped->InverseName_text, pSource->InverseName_text));
+        UATEST_CHECK(UaTest_Image_SameString(pMapped->InverseName_locale, pSource->InverseName_locale));
+    }
+    for(i = 0; i < a_pSource->NoOfVariables; i++)
+    {
+        const _VariableKnoten_* pMapped = &a_pMapped->Variables[i];
+        const _VariableKnoten_* pSource = &a_pSource->Variables[i];
+
+        UATEST_CHECK(UaTest_Image_SameBase(&pMapped->BaseAttribute, &pSource->BaseAttribute));
+        UATEST_CHECK(pMapped->ValueIndex == pSource->ValueIndex);
+        UATEST_CHECK(UaTest_Image_SameNodeId(&pMapped->DataType, &pSource->DataType));
+        UATEST_CHECK(pMapped->ValueRank == pSource->ValueRank);
+        UATEST_CHECK(pMapped->NoOfArrayDimensions == pSource->NoOfArrayDimensions);
+        UATEST_CHECK(pMapped->ArrayDimensions == pSource->ArrayDimensions);
+        UATEST_CHECK(pMapped->AccessLevel == pSource->AccessLevel);
+        UATEST_CHECK(pMapped->UserAccessLevel == pSource->UserAccessLevel);
+        UATEST_CHECK(pMapped->Historizing == pSource->Historizing);
+    }
+    for(i = 0; i < a_pSource->NoOfVariableTypes; i++)
+    {
+        const _VariableTypeKnoten_* pMapped = &a_pMapped->VariableTypes[i];
+        const _VariableTypeKnoten_* pSource = &a_pSource->VariableTypes[i];
+
+        UATEST_CHECK(UaTest_Image_SameBase(&pMapped->BaseAttribute, &pSource->BaseAttribute));
+        UATEST_CHECK(pMapped->ValueIndex == pSource->ValueIndex);
+        UATEST_CHECK(UaTest_Image_SameNodeId(&pMapped->DataType, &pSource->DataType));
+        UATEST_CHECK(pMapped->ValueRank == pSource->ValueRank);
+        UATEST_CHECK(pMapped->NoOfArrayDimensions == pSource->NoOfArrayDimensions);
+        UATEST_CHECK(pMapped->ArrayDimensions == pSource->ArrayDimensions);
+        UATEST_CHECK(pMapped->IsAbstract == pSource->IsAbstract);
+    }
+    for(i = 0; i < a_pSource->NoOfDataTypes; i++)
+    {
+        UATEST_CHECK(UaTest_Image_SameBase(&a_pMapped->DataTypes[i].BaseAttribute, &a_pSource->DataTypes[i].BaseAttribute));
+        UATEST_CHECK(a_pMapped->DataTypes[i].IsAbstract == a_pSource->DataTypes[i].IsAbstract);
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Image_SameAddressSpace
+ *===========================================================================*/
+/* the image of the built-in address space maps to the same nodes, and the index finds them there */
+static OpcUa_StatusCode UaTest_Image_SameAddressSpace(OpcUa_Void)
+{
+    _AddressSpaceTables_    Source;
+    _AddressSpaceTables_    Mapped;
+    _BaseAttribute_*        pFound  = OpcUa_Null;
+    OpcUa_Int               i       = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Image_SameAddressSpace");
+
+    uStatus = UaTest_Image_Open();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    get_builtin_addressspace(&Source);
+    UATEST_CHECK(Source.NoOfObjectTypes > 0);
+    UATEST_CHECK(Source.NoOfObjects > 0);
+    UATEST_CHECK(Source.NoOfReferenceTypes > 0);
+    UATEST_CHECK(Source.NoOfVariables > 0);
+    UATEST_CHECK(Source.NoOfVariableTypes > 0);
+    UATEST_CHECK(Source.NoOfDataTypes > 0);
+
+    OpcUa_MemSet(&Mapped, 0, sizeof(Mapped));
+    uStatus = map_addressspace_image(UaTest_g_Image.sFile, &Mapped);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = UaTest_Image_SameTables(&Mapped, &Source);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* the strings are used in the mapping, not taken from the source */
+    UATEST_CHECK(Mapped.Objects[0].BaseAttribute.BrowseName != Source.Objects[0].BaseAttribute.BrowseName);
+
+    uStatus = build_node_index(&Mapped);
+    OpcUa_GotoErrorIfBad(uStatus);
+    for(i = 0; i < Source.NoOfVariables; i++)
+    {
+        pFound = (_BaseAttribute_*)search_for_node(Source.Variables[i].BaseAttribute.NodeId);
+        UATEST_CHECK(pFound == &Mapped.Variables[i].BaseAttribute);
+    }
+
+    /* a second image maps over the first */
+    uStatus = map_addressspace_image(UaTest_g_Image.sFile, &Mapped);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_Image_SameTables(&Mapped, &Source);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    UaTest_Image_Clear();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_Image_Clear();
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Image_NumericNodeId
+ *===========================================================================*/
+static OpcUa_Void UaTest_Image_NumericNodeId(OpcUa_NodeId* a_pNodeId, OpcUa_UInt16 a_uNamespaceIndex, OpcUa_UInt32 a_uIdentifier)
+{
+    OpcUa_NodeId_Initialize(a_pNodeId);
+    a_pNodeId->NamespaceIndex       = a_uNamespaceIndex;
+    a_pNodeId->Identifier.Numeric   = a_uIdentifier;
+}
+
+/*============================================================================
+ * UaTest_Image_AllAttributes
+ *===========================================================================*/
+/* one node per node class with no attribute left at zero, so every attribute the image carries is seen */
+static OpcUa_StatusCode UaTest_Image_AllAttributes(OpcUa_Void)
+{
+    _ObjectTypeKnoten_      ObjectType;
+    _ObjectKnoten_          Object;
+    _ReferenceTypeKnoten_   ReferenceType;
+    _VariableKnoten_        Variable;
+    _VariableTypeKnoten_    VariableType;
+    _DataTypeKnoten_        DataType;
+    _ReferenceNode_         aReferences[3];
+    _AddressSpaceTables_    Source;
+    _AddressSpaceTables_    Mapped;
+    _BaseAttribute_*        apBases[6];
+    OpcUa_Int               i       = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Image_AllAttributes");
+
+    OpcUa_MemSet(&UaTest_g_Image, 0, sizeof(UaTest_g_Image));
+    OpcUa_MemSet(&ObjectType, 0, sizeof(ObjectType));
+    OpcUa_MemSet(&Object, 0, sizeof(Object));
+    OpcUa_MemSet(&ReferenceType, 0, sizeof(ReferenceType));
+    OpcUa_MemSet(&Variable, 0, sizeof(Variable));
+    OpcUa_MemSet(&VariableType, 0, sizeof(VariableType));
+    OpcUa_MemSet(&DataType, 0, sizeof(DataType));
+
+    /* the namespace uri of the second reference repeats the one of the first */
+    UaTest_Image_NumericNodeId(&aReferences[0].ReferenceTypeId, 0, 47);
+    UaTest_Image_NumericNodeId(&aReferences[0].Target_NodeId, 3, 7002);
+    aReferences[0].IsInverse            = OpcUa_True;
+    aReferences[0].Target_NamespaceUri  = "urn:UaTest:Image";
+    UaTest_Image_NumericNodeId(&aReferences[1].ReferenceTypeId, 3, 7003);
+    UaTest_Image_NumericNodeId(&aReferences[1].Target_NodeId, 0, 85);
+    aReferences[1].IsInverse            = OpcUa_False;
+    aReferences[1].Target_NamespaceUri  = "urn:UaTest:Image";
+    UaTest_Image_NumericNodeId(&aReferences[2].ReferenceTypeId, 0, 40);
+    UaTest_Image_NumericNodeId(&aReferences[2].Target_NodeId, 3, 7001);
+    aReferences[2].IsInverse            = OpcUa_True;
+    aReferences[2].Target_NamespaceUri  = OpcUa_Null;
+
+    apBases[0] = &ObjectType.BaseAttribute;
+    apBases[1] = &Object.BaseAttribute;
+    apBases[2] = &ReferenceType.BaseAttribute;
+    apBases[3] = &Variable.BaseAttribute;
+    apBases[4] = &VariableType.BaseAttribute;
+    apBases[5] = &DataType.BaseAttribute;
+    for(i = 0; i < 6; i++)
+    {
+        UaTest_Image_NumericNodeId(&apBases[i]->NodeId, 3, (OpcUa_UInt32)(7001 + i));
+        apBases[i]->BrowseName  = "UaTestBrowseName";
+        apBases[i]->DisplayName = "UaTestDisplayName";
+    }
+    ObjectType.BaseAttribute.NodeClass      = OpcUa_NodeClass_ObjectType;
+    Object.BaseAttribute.NodeClass          = OpcUa_NodeClass_Object;
+    ReferenceType.BaseAttribute.NodeClass   = OpcUa_NodeClass_ReferenceType;
+    Variable.BaseAttribute.NodeClass        = OpcUa_NodeClass_Variable;
+    VariableType.BaseAttribute.NodeClass    = OpcUa_NodeClass_VariableType;
+    DataType.BaseAttribute.NodeClass        = OpcUa_NodeClass_DataType;
+    Object.BaseAttribute.DisplayName        = OpcUa_Null;
+    Object.BaseAttribute.NoOfReferences     = 2;
+    Object.BaseAttribute.References         = aReferences;
+    Variable.BaseAttribute.NoOfReferences   = 1;
+    Variable.BaseAttribute.References       = &aReferences[2];
+
+    ObjectType.IsAbstract               = OpcUa_True;
+    Object.EventNotifier                = 5;
+    ReferenceType.IsAbstract            = OpcUa_True;
+    ReferenceType.Symmetric             = OpcUa_True;
+    ReferenceType.InverseName_text      = "UaTestInverse";
+    ReferenceType.InverseName_locale    = "de";
+    Variable.ValueIndex                 = 3;
+    UaTest_Image_NumericNodeId(&Variable.DataType, 0, 11);
+    Variable.ValueRank                  = 1;
+    Variable.NoOfArrayDimensions        = 1;
+    Variable.ArrayDimensions            = 16;
+    Variable.AccessLevel                = 3;
+    Variable.UserAccessLevel            = 1;
+    Variable.Historizing                = OpcUa_True;
+    VariableType.ValueIndex             = 4;
+    UaTest_Image_NumericNodeId(&VariableType.DataType, 0, 12);
+    VariableType.ValueRank              = 2;
+    VariableType.NoOfArrayDimensions    = 2;
+    VariableType.ArrayDimensions        = 8;
+    VariableType.IsAbstract             = OpcUa_True;
+    DataType.IsAbstract                 = OpcUa_True;
+
+    OpcUa_MemSet(&Source, 0, sizeof(Source));
+    Source.ObjectTypes          = &ObjectType;
+    Source.NoOfObjectTypes      = 1;
+    Source.Objects              = &Object;
+    Source.NoOfObjects          = 1;
+    Source.ReferenceTypes       = &ReferenceType;
+    Source.NoOfReferenceTypes   = 1;
+    Source.Variables            = &Variable;
+    Source.NoOfVariables        = 1;
+    Source.VariableTypes        = &VariableType;
+    Source.NoOfVariableTypes    = 1;
+    Source.DataTypes            = &DataType;
+    Source.NoOfDataTypes        = 1;
+
+    uStatus = UaTest_Image_CreateFile();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = compile_addressspace_image(&Source, UaTest_g_Image.sFile);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    OpcUa_MemSet(&Mapped, 0, sizeof(Mapped));
+    uStatus = map_addressspace_image(UaTest_g_Image.sFile, &Mapped);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = UaTest_Image_SameTables(&Mapped, &Source);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    UaTest_Image_Clear();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_Image_Clear();
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * Damages
+ *===========================================================================*/
+#define UATEST_IMAGE_HEADER(xImage)     ((_ImageHeader_*)(xImage))
+#define UATEST_IMAGE_NODES(xImage)      ((_ImageNode_*)((xImage) + UATEST_IMAGE_HEADER(xImage)->NodesOffset))
+#define UATEST_IMAGE_REFERENCES(xImage) ((_ImageReference_*)((xImage) + UATEST_IMAGE_HEADER(xImage)->ReferencesOffset))
+
+static OpcUa_Void UaTest_Image_Truncate(OpcUa_Byte* a_pImage, OpcUa_UInt32* a_puSize)
+{
+    OpcUa_ReferenceParameter(a_pImage);
+    (*a_puSize)--;
+}
+
+static OpcUa_Void UaTest_Image_HeaderOnly(OpcUa_Byte* a_pImage, OpcUa_UInt32* a_puSize)
+{
+    OpcUa_ReferenceParameter(a_pImage);
+    *a_puSize = sizeof(_ImageHeader_) - 1;
+}
+
+static OpcUa_Void UaTest_Image_Magic(OpcUa_Byte* a_pImage, OpcUa_UInt32* a_puSize)
+{
+    OpcUa_ReferenceParameter(a_puSize);
+    UATEST_IMAGE_HEADER(a_pImage)->Magic ^= 1;
+}
+
+static OpcUa_Void UaTest_Image_Version(OpcUa_Byte* a_pImage, OpcUa_UInt32* a_puSize)
+{
+    OpcUa_ReferenceParameter(a_puSize);
+    UATEST_IMAGE_HEADER(a_pImage)->Version++;
+}
+
+static OpcUa_Void UaTest_Image_NoOfNodes(OpcUa_Byte* a_pImage, OpcUa_UInt32* a_puSize)
+{
+    OpcUa_ReferenceParameter(a_puSize);
+    UATEST_IMAGE_HEADER(a_pImage)->NoOfNodes = 0x10000000;
+}
+
+static OpcUa_Void UaTest_Image_StringsLength(OpcUa_Byte* a_pImage, OpcUa_UInt32* a_puSize)
+{
+    OpcUa_ReferenceParameter(a_puSize);
+    UATEST_IMAGE_HEADER(a_pImage)->StringsLength++;
+}
+
+static OpcUa_Void UaTest_Image_Unterminated(OpcUa_Byte* a_pImage, OpcUa_UInt32* a_puSize)
+{
+    OpcUa_ReferenceParameter(a_puSize);
+    a_pImage[UATEST_IMAGE_HEADER(a_pImage)->StringsOffset + UATEST_IMAGE_HEADER(a_pImage)->StringsLength - 1] = 'x';
+}
+
+static OpcUa_Void UaTest_Image_NodeClass(OpcUa_Byte* a_pImage, OpcUa_UInt32* a_puSize)
+{
+    OpcUa_ReferenceParameter(a_puSize);
+    UATEST_IMAGE_NODES(a_pImage)[0].NodeClass = 0xFF;
+}
+
+static OpcUa_Void UaTest_Image_BrowseName(OpcUa_Byte* a_pImage, OpcUa_UInt32* a_puSize)
+{
+    OpcUa_ReferenceParameter(a_puSize);
+    UATEST_IMAGE_NODES(a_pImage)[0].BrowseName = UATEST_IMAGE_HEADER(a_pImage)->StringsLength;
+}
+
+static OpcUa_Void UaTest_Image_References(OpcUa_Byte* a_pImage, OpcUa_UInt32* a_puSize)
+{
+    OpcUa_ReferenceParameter(a_puSize);
+    UATEST_IMAGE_NODES(a_pImage)[0].NoOfReferences = UATEST_IMAGE_HEADER(a_pImage)->NoOfReferences + 1;
+}
+
+static OpcUa_Void UaTest_Image_NamespaceUri(OpcUa_Byte* a_pImage, OpcUa_UInt32* a_puSize)
+{
+    OpcUa_ReferenceParameter(a_puSize);
+    UATEST_IMAGE_REFERENCES(a_pImage)[0].Target_NamespaceUri = UATEST_IMAGE_HEADER(a_pImage)->StringsLength;
+}
+
+static UaTest_Image_PfnDamage* UaTest_g_apfnImageDamages[] =
+{
+    UaTest_Image_Truncate,
+    UaTest_Image_HeaderOnly,
+    UaTest_Image_Magic,
+    UaTest_Image_Version,
+    UaTest_Image_NoOfNodes,
+    UaTest_Image_StringsLength,
+    UaTest_Image_Unterminated,
+    UaTest_Image_NodeClass,
+    UaTest_Image_BrowseName,
+    UaTest_Image_References,
+    UaTest_Image_NamespaceUri
+};
+
+/*============================================================================
+ * UaTest_Image_Store
+ *===========================================================================*/
+/* writes the compiled image to the file, damaged by a_pfnDamage if given */
+static OpcUa_Boolean UaTest_Image_Store(UaTest_Image_PfnDamage* a_pfnDamage)
+{
+    OpcUa_Byte*     pImage  = OpcUa_Null;
+    OpcUa_UInt32    uSize   = UaTest_g_Image.uSize;
+    FILE*           pFile   = OpcUa_Null;
+    OpcUa_Boolean   bStored = OpcUa_False;
+
+    pImage = (OpcUa_Byte*)OpcUa_Alloc(uSize);
+    if(pImage == OpcUa_Null)
+    {
+        return OpcUa_False;
+    }
+    OpcUa_MemCpy(pImage, uSize, UaTest_g_Image.pImage, uSize);
+    if(a_pfnDamage != OpcUa_Null)
+    {
+        a_pfnDamage(pImage, &uSize);
+    }
+
+    pFile = fopen(UaTest_g_Image.sFile, "wb");
+    if(pFile != OpcUa_Null)
+    {
+        bStored = (OpcUa_Boolean)(fwrite(pImage, 1, uSize, pFile) == uSize);
+        bStored = (OpcUa_Boolean)(fclose(pFile) == 0 && bStored != OpcUa_False);
+    }
+    OpcUa_Free(pImage);
+    return bStored;
+}
+
+/*============================================================================
+ * UaTest_Image_Rejected
+ *===========================================================================*/
+/* images which do not fit together are not mapped, and the tables of the caller stay untouched */
+static OpcUa_StatusCode UaTest_Image_Rejected(OpcUa_Void)
+{
+    _AddressSpaceTables_    Tables;
+    _AddressSpaceTables_    Untouched;
+    _VariableKnoten_        Variable;
+    OpcUa_StatusCode        uMapStatus  = OpcUa_Good;
+    OpcUa_UInt32            i           = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Image_Rejected");
+
+    uStatus = UaTest_Image_Open();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* the image is damaged once per field the check covers; the undamaged one maps */
+    UATEST_CHECK(UaTest_Image_Store(OpcUa_Null));
+    uStatus = map_addressspace_image(UaTest_g_Image.sFile, &Tables);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(UATEST_IMAGE_HEADER(UaTest_g_Image.pImage)->NoOfReferences > 0);
+
+    OpcUa_MemSet(&Untouched, 0x5A, sizeof(Untouched));
+    for(i = 0; i < sizeof(UaTest_g_apfnImageDamages) / sizeof(UaTest_g_apfnImageDamages[0]); i++)
+    {
+        UATEST_CHECK(UaTest_Image_Store(UaTest_g_apfnImageDamages[i]));
+        OpcUa_MemSet(&Tables, 0x5A, sizeof(Tables));
+        uMapStatus = map_addressspace_image(UaTest_g_Image.sFile, &Tables);
+        UATEST_CHECK(uMapStatus == OpcUa_BadDecodingError);
+        UATEST_CHECK(memcmp(&Tables, &Untouched, sizeof(Tables)) == 0);
+    }
+
+    /* a missing file */
+    unlink(UaTest_g_Image.sFile);
+    uMapStatus = map_addressspace_image(UaTest_g_Image.sFile, &Tables);
+    UATEST_CHECK(uMapStatus == OpcUa_BadNotFound);
+    UaTest_g_Image.sFile[0] = '\0';
+
+    /* the image format knows numeric NodeIds only */
+    OpcUa_MemSet(&Variable, 0, sizeof(Variable));
+    Variable.BaseAttribute.NodeClass                = OpcUa_NodeClass_Variable;
+    Variable.BaseAttribute.NodeId.IdentifierType    = OpcUa_IdentifierType_String;
+    OpcUa_MemSet(&Tables, 0, sizeof(Tables));
+    Tables.Variables    = &Variable;
+    Tables.NoOfVariables = 1;
+    UATEST_CHECK(compile_addressspace_image(&Tables, "/tmp/uatest_image_unwritten") == OpcUa_BadNotSupported);
+    UATEST_CHECK(access("/tmp/uatest_image_unwritten", F_OK) != 0);
+
+    UaTest_Image_Clear();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_Image_Clear();
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * Case table
+ *===========================================================================*/
+UaTest_Case UaTest_g_AddressSpaceImageCases[] =
+{
+    { "sample/addressspaceimage/sameaddressspace",  UaTest_Image_SameAddressSpace },
+    { "sample/addressspaceimage/allattributes",     UaTest_Image_AllAttributes },
+    { "sample/addressspaceimage/rejected",          UaTest_Image_Rejected },
+    UATEST_CASE_END
+};
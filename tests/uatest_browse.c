@@ -0,0 +1,829 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+/******************************************************************************************************/
+/* Tests for the Browse side of the sample server: the NodeId index and the ContinuationPoints.      */
+/******************************************************************************************************/
+
+#include <opcua_serverstub.h>
+#include <opcua_memory.h>
+#include <opcua_string.h>
+
+#include "addressspace.h"
+#include "browseservice.h"
+#include "sessiontable.h"
+
+#include "uatest.h"
+#include "uatest_sample.h"
+
+#include <string.h>
+
+/*============================================================================
+ * UaTest_NodeIndex_NoOfNodes
+ *===========================================================================*/
+static OpcUa_Int UaTest_NodeIndex_NoOfNodes(const _AddressSpaceTables_* a_pTables)
+{
+    return  a_pTables->NoOfObjectTypes
+          + a_pTables->NoOfObjects
+          + a_pTables->NoOfReferenceTypes
+          + a_pTables->NoOfVariables
+          + a_pTables->NoOfVariableTypes
+          + a_pTables->NoOfDataTypes;
+}
+
+/*============================================================================
+ * UaTest_NodeIndex_GetNode
+ *===========================================================================*/
+/* the nodes in the order of the linear search */
+static _BaseAttribute_* UaTest_NodeIndex_GetNode(   const _AddressSpaceTables_* a_pTables,
+                                                    OpcUa_Int                   a_iNode)
+{
+    if(a_iNode < a_pTables->NoOfObjectTypes)
+    {
+        return &a_pTables->ObjectTypes[a_iNode].BaseAttribute;
+    }
+    a_iNode -= a_pTables->NoOfObjectTypes;
+    if(a_iNode < a_pTables->NoOfObjects)
+    {
+        return &a_pTables->Objects[a_iNode].BaseAttribute;
+    }
+    a_iNode -= a_pTables->NoOfObjects;
+    if(a_iNode < a_pTables->NoOfReferenceTypes)
+    {
+        return &a_pTables->ReferenceTypes[a_iNode].BaseAttribute;
+    }
+    a_iNode -= a_pTables->NoOfReferenceTypes;
+    if(a_iNode < a_pTables->NoOfVariables)
+    {
+        return &a_pTables->Variables[a_iNode].BaseAttribute;
+    }
+    a_iNode -= a_pTables->NoOfVariables;
+    if(a_iNode < a_pTables->NoOfVariableTypes)
+    {
+        return &a_pTables->VariableTypes[a_iNode].BaseAttribute;
+    }
+    a_iNode -= a_pTables->NoOfVariableTypes;
+    return &a_pTables->DataTypes[a_iNode].BaseAttribute;
+}
+
+/*============================================================================
+ * UaTest_NodeIndex_MatchesLinearSearch
+ *===========================================================================*/
+/* every node of the built-in address space is found as the linear search finds it */
+static OpcUa_StatusCode UaTest_NodeIndex_MatchesLinearSearch(OpcUa_Void)
+{
+    _AddressSpaceTables_    Tables;
+    OpcUa_Void**            ppIndexed   = OpcUa_Null;
+    OpcUa_NodeId            Unknown;
+    OpcUa_Int               iNoOfNodes  = 0;
+    OpcUa_Int               iNode       = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "NodeIndex_MatchesLinearSearch");
+
+    get_builtin_addressspace(&Tables);
+    iNoOfNodes = UaTest_NodeIndex_NoOfNodes(&Tables);
+    UATEST_CHECK(iNoOfNodes > 0);
+
+    ppIndexed = (OpcUa_Void**)OpcUa_Alloc(iNoOfNodes * sizeof(OpcUa_Void*));
+    OpcUa_GotoErrorIfAllocFailed(ppIndexed);
+
+    uStatus = build_node_index(OpcUa_Null);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    for(iNode = 0; iNode < iNoOfNodes; iNode++)
+    {
+        ppIndexed[iNode] = search_for_node(UaTest_NodeIndex_GetNode(&Tables, iNode)->NodeId);
+        UATEST_CHECK(ppIndexed[iNode] != OpcUa_Null);
+    }
+
+    OpcUa_NodeId_Initialize(&Unknown);
+    Unknown.Identifier.Numeric = 0xFFFFFFF0;
+    UATEST_CHECK(search_for_node(Unknown) == OpcUa_Null);
+
+    /* without an index search_for_node falls back to the linear search */
+    clear_node_index();
+
+    for(iNode = 0; iNode < iNoOfNodes; iNode++)
+    {
+        UATEST_CHECK(search_for_node(UaTest_NodeIndex_GetNode(&Tables, iNode)->NodeId) == ppIndexed[iNode]);
+    }
+    UATEST_CHECK(search_for_node(Unknown) == OpcUa_Null);
+
+    OpcUa_Free(ppIndexed);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    clear_node_index();
+    OpcUa_Free(ppIndexed);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_NodeIndex_ComparesByValue
+ *===========================================================================*/
+/* string, Guid and opaque identifiers are found through a copy of the NodeId */
+static OpcUa_StatusCode UaTest_NodeIndex_ComparesByValue(OpcUa_Void)
+{
+    _AddressSpaceTables_    Tables;
+    _ObjectKnoten_          aObjects[4];
+    OpcUa_Guid              Guid;
+    OpcUa_Guid              GuidCopy;
+    OpcUa_Byte              aOpaque[]       = { 0x01, 0x02, 0x03, 0x04, 0x05 };
+    OpcUa_Byte              aOpaqueCopy[]   = { 0x01, 0x02, 0x03, 0x04, 0x05 };
+    OpcUa_CharA             sName[]         = "Pump.1";
+    OpcUa_CharA             sNameCopy[]     = "Pump.1";
+    OpcUa_NodeId            Probe;
+    OpcUa_Int               i               = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "NodeIndex_ComparesByValue");
+
+    OpcUa_MemSet(&Tables, 0, sizeof(Tables));
+    OpcUa_MemSet(aObjects, 0, sizeof(aObjects));
+    OpcUa_MemSet(&Guid, 0, sizeof(Guid));
+    Guid.Data1 = 0x12345678;
+    Guid.Data4[7] = 0x9A;
+    GuidCopy = Guid;
+
+    for(i = 0; i < 4; i++)
+    {
+        aObjects[i].BaseAttribute.NodeClass     = OpcUa_NodeClass_Object;
+        aObjects[i].BaseAttribute.NodeId.NamespaceIndex = 2;
+    }
+
+    aObjects[0].BaseAttribute.NodeId.IdentifierType = OpcUa_IdentifierType_String;
+    OpcUa_String_AttachReadOnly(&aObjects[0].BaseAttribute.NodeId.Identifier.String, sName);
+    aObjects[1].BaseAttribute.NodeId.IdentifierType = OpcUa_IdentifierType_Guid;
+    aObjects[1].BaseAttribute.NodeId.Identifier.Guid = &Guid;
+    aObjects[2].BaseAttribute.NodeId.IdentifierType = OpcUa_IdentifierType_Opaque;
+    aObjects[2].BaseAttribute.NodeId.Identifier.ByteString.Data = aOpaque;
+    aObjects[2].BaseAttribute.NodeId.Identifier.ByteString.Length = sizeof(aOpaque);
+    aObjects[3].BaseAttribute.NodeId.IdentifierType = OpcUa_IdentifierType_Numeric;
+    aObjects[3].BaseAttribute.NodeId.Identifier.Numeric = 85;
+
+    Tables.Objects      = aObjects;
+    Tables.NoOfObjects  = 4;
+
+    uStatus = build_node_index(&Tables);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    OpcUa_MemSet(&Probe, 0, sizeof(Probe));
+    Probe.NamespaceIndex = 2;
+    Probe.IdentifierType = OpcUa_IdentifierType_String;
+    OpcUa_String_AttachReadOnly(&Probe.Identifier.String, sNameCopy);
+    UATEST_CHECK(search_for_node(Probe) == &aObjects[0].BaseAttribute);
+
+    /* same text in another namespace */
+    Probe.NamespaceIndex = 3;
+    UATEST_CHECK(search_for_node(Probe) == OpcUa_Null);
+
+    OpcUa_MemSet(&Probe, 0, sizeof(Probe));
+    Probe.NamespaceIndex = 2;
+    Probe.IdentifierType = OpcUa_IdentifierType_Guid;
+    Probe.Identifier.Guid = &GuidCopy;
+    UATEST_CHECK(search_for_node(Probe) == &aObjects[1].BaseAttribute);
+    GuidCopy.Data4[7]++;
+    UATEST_CHECK(search_for_node(Probe) == OpcUa_Null);
+
+    OpcUa_MemSet(&Probe, 0, sizeof(Probe));
+    Probe.NamespaceIndex = 2;
+    Probe.IdentifierType = OpcUa_IdentifierType_Opaque;
+    Probe.Identifier.ByteString.Data = aOpaqueCopy;
+    Probe.Identifier.ByteString.Length = sizeof(aOpaqueCopy);
+    UATEST_CHECK(search_for_node(Probe) == &aObjects[2].BaseAttribute);
+    Probe.Identifier.ByteString.Length--;
+    UATEST_CHECK(search_for_node(Probe) == OpcUa_Null);
+
+    OpcUa_MemSet(&Probe, 0, sizeof(Probe));
+    Probe.NamespaceIndex = 2;
+    Probe.Identifier.Numeric = 85;
+    UATEST_CHECK(search_for_node(Probe) == &aObjects[3].BaseAttribute);
+    Probe.NamespaceIndex = 0;
+    UATEST_CHECK(search_for_node(Probe) == OpcUa_Null);
+
+    clear_node_index();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    clear_node_index();
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_ContinuationPoints_Store
+ *===========================================================================*/
+/* a ContinuationPoint at the start of the Objects folder, one reference per page */
+static OpcUa_StatusCode UaTest_ContinuationPoints_Store(OpcUa_UInt32        a_uSessionId,
+                                                        OpcUa_ByteString*   a_pContinuationPoint)
+{
+    OpcUa_BrowseDescription NodeToBrowse;
+    _BaseAttribute_*        pNode   = OpcUa_Null;
+
+    OpcUa_BrowseDescription_Initialize(&NodeToBrowse);
+    NodeToBrowse.NodeId.Identifier.Numeric          = OpcUaId_ObjectsFolder;
+    NodeToBrowse.BrowseDirection                    = OpcUa_BrowseDirection_Forward;
+    NodeToBrowse.ReferenceTypeId.Identifier.Numeric = OpcUaId_HierarchicalReferences;
+    NodeToBrowse.IncludeSubtypes                    = OpcUa_True;
+    NodeToBrowse.ResultMask                         = OpcUa_BrowseResultMask_All;
+
+    pNode = (_BaseAttribute_*)search_for_node(NodeToBrowse.NodeId);
+    if(pNode == OpcUa_Null)
+    {
+        return OpcUa_BadNodeIdUnknown;
+    }
+
+    return store_continuationpoint(a_uSessionId, &NodeToBrowse, pNode, 0, 1, a_pContinuationPoint);
+}
+
+/*============================================================================
+ * UaTest_ContinuationPoints_Next
+ *===========================================================================*/
+/* calls BrowseNext; a_pNext, if given, receives the ContinuationPoint of the first result */
+static OpcUa_StatusCode UaTest_ContinuationPoints_Next( const OpcUa_RequestHeader*  a_pRequestHeader,
+                                                        OpcUa_Boolean               a_bRelease,
+                                                        OpcUa_Int32                 a_nNoOfContinuationPoints,
+                                                        const OpcUa_ByteString*     a_pContinuationPoints,
+                                                        OpcUa_StatusCode*           a_pResults,
+                                                        OpcUa_ByteString*           a_pNext)
+{
+    OpcUa_ResponseHeader    ResponseHeader;
+    OpcUa_BrowseResult*     pResults            = OpcUa_Null;
+    OpcUa_DiagnosticInfo*   pDiagnosticInfos    = OpcUa_Null;
+    OpcUa_Int32             nNoOfResults        = 0;
+    OpcUa_Int32             nNoOfDiagnosticInfos = 0;
+    OpcUa_Int32             i                   = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "ContinuationPoints_Next");
+
+    OpcUa_ResponseHeader_Initialize(&ResponseHeader);
+
+    /* the sample does not look at the endpoint and the context */
+    uStatus = my_BrowseNext((OpcUa_Endpoint)&ResponseHeader,
+                            (OpcUa_Handle)&ResponseHeader,
+                            a_pRequestHeader,
+                            a_bRelease,
+                            a_nNoOfContinuationPoints,
+                            a_pContinuationPoints,
+                            &ResponseHeader,
+                            &nNoOfResults,
+                            &pResults,
+                            &nNoOfDiagnosticInfos,
+                            &pDiagnosticInfos);
+    OpcUa_GotoErrorIfBad(uStatus);
+    OpcUa_GotoErrorIfTrue(nNoOfResults != a_nNoOfContinuationPoints, OpcUa_BadUnexpectedError);
+
+    for(i = 0; i < nNoOfResults; i++)
+    {
+        a_pResults[i] = pResults[i].StatusCode;
+    }
+
+    if(a_pNext != OpcUa_Null)
+    {
+        *a_pNext = pResults[0].ContinuationPoint;
+        OpcUa_ByteString_Initialize(&pResults[0].ContinuationPoint);
+    }
+
+    for(i = 0; i < nNoOfResults; i++)
+    {
+        OpcUa_BrowseResult_Clear(&pResults[i]);
+    }
+    OpcUa_Free(pResults);
+    OpcUa_ResponseHeader_Clear(&ResponseHeader);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    for(i = 0; i < nNoOfResults; i++)
+    {
+        OpcUa_BrowseResult_Clear(&pResults[i]);
+    }
+    OpcUa_Free(pResults);
+    OpcUa_ResponseHeader_Clear(&ResponseHeader);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_ContinuationPoints_EvictsLeastRecentlyUsed
+ *===========================================================================*/
+/* a session beyond MAX_BROWSE_CONTINUATIONPOINTS loses the point it used last longest ago */
+static OpcUa_StatusCode UaTest_ContinuationPoints_EvictsLeastRecentlyUsed(OpcUa_Void)
+{
+    OpcUa_RequestHeader Session;
+    OpcUa_RequestHeader Other;
+    OpcUa_ByteString    aPoints[MAX_BROWSE_CONTINUATIONPOINTS + 1];
+    OpcUa_ByteString    aOtherPoints[2];
+    OpcUa_ByteString    Used;
+    OpcUa_StatusCode    aResults[MAX_BROWSE_CONTINUATIONPOINTS + 1];
+    OpcUa_UInt32        uSessionId  = 0;
+    OpcUa_UInt32        uOtherId    = 0;
+    OpcUa_Int           i           = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "ContinuationPoints_EvictsLeastRecentlyUsed");
+
+    OpcUa_RequestHeader_Initialize(&Session);
+    OpcUa_RequestHeader_Initialize(&Other);
+    OpcUa_ByteString_Initialize(&Used);
+    for(i = 0; i < MAX_BROWSE_CONTINUATIONPOINTS + 1; i++)
+    {
+        OpcUa_ByteString_Initialize(&aPoints[i]);
+    }
+    for(i = 0; i < 2; i++)
+    {
+        OpcUa_ByteString_Initialize(&aOtherPoints[i]);
+    }
+
+    uStatus = initialize_sessions();
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = initialize_continuationpoints();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = UaTest_Sample_OpenSession(60000, &Session, &uSessionId);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_Sample_OpenSession(60000, &Other, &uOtherId);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    for(i = 0; i < MAX_BROWSE_CONTINUATIONPOINTS; i++)
+    {
+        uStatus = UaTest_ContinuationPoints_Store(uSessionId, &aPoints[i]);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+    for(i = 0; i < 2; i++)
+    {
+        uStatus = UaTest_ContinuationPoints_Store(uOtherId, &aOtherPoints[i]);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+    /* BrowseNext on the oldest point replaces it by a fresh one */
+    uStatus = UaTest_ContinuationPoints_Next(&Session, OpcUa_False, 1, &aPoints[0], aResults, &Used);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(aResults[0] == OpcUa_Good);
+    UATEST_CHECK(Used.Length == sizeof(OpcUa_UInt32));
+    uStatus = UaTest_ContinuationPoints_Next(&Session, OpcUa_True, 1, &aPoints[0], aResults, OpcUa_Null);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(aResults[0] == OpcUa_BadContinuationPointInvalid);
+    OpcUa_ByteString_Clear(&aPoints[0]);
+    aPoints[0] = Used;
+    OpcUa_ByteString_Initialize(&Used);
+
+    /* one more point pushes out aPoints[1], now the least recently used */
+    uStatus = UaTest_ContinuationPoints_Store(uSessionId, &aPoints[MAX_BROWSE_CONTINUATIONPOINTS]);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* the other session can neither see nor release them */
+    uStatus = UaTest_ContinuationPoints_Next(&Other, OpcUa_True, MAX_BROWSE_CONTINUATIONPOINTS + 1, aPoints, aResults, OpcUa_Null);
+    OpcUa_GotoErrorIfBad(uStatus);
+    for(i = 0; i < MAX_BROWSE_CONTINUATIONPOINTS + 1; i++)
+    {
+        UATEST_CHECK(aResults[i] == OpcUa_BadContinuationPointInvalid);
+    }
+
+    uStatus = UaTest_ContinuationPoints_Next(&Session, OpcUa_True, MAX_BROWSE_CONTINUATIONPOINTS + 1, aPoints, aResults, OpcUa_Null);
+    OpcUa_GotoErrorIfBad(uStatus);
+    for(i = 0; i < MAX_BROWSE_CONTINUATIONPOINTS + 1; i++)
+    {
+        UATEST_CHECK(aResults[i] == ((i == 1)? OpcUa_BadContinuationPointInvalid: OpcUa_Good));
+    }
+
+    /* the points of the other session were left alone */
+    uStatus = UaTest_ContinuationPoints_Next(&Other, OpcUa_True, 2, aOtherPoints, aResults, OpcUa_Null);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(aResults[0] == OpcUa_Good);
+    UATEST_CHECK(aResults[1] == OpcUa_Good);
+
+    for(i = 0; i < MAX_BROWSE_CONTINUATIONPOINTS + 1; i++)
+    {
+        OpcUa_ByteString_Clear(&aPoints[i]);
+    }
+    for(i = 0; i < 2; i++)
+    {
+        OpcUa_ByteString_Clear(&aOtherPoints[i]);
+    }
+    OpcUa_RequestHeader_Clear(&Session);
+    OpcUa_RequestHeader_Clear(&Other);
+    clear_continuationpoints();
+    clear_sessions();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_ByteString_Clear(&Used);
+    for(i = 0; i < MAX_BROWSE_CONTINUATIONPOINTS + 1; i++)
+    {
+        OpcUa_ByteString_Clear(&aPoints[i]);
+    }
+    for(i = 0; i < 2; i++)
+    {
+        OpcUa_ByteString_Clear(&aOtherPoints[i]);
+    }
+    OpcUa_RequestHeader_Clear(&Session);
+    OpcUa_RequestHeader_Clear(&Other);
+    clear_continuationpoints();
+    clear_sessions();
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_References
+ *===========================================================================*/
+/* ReferenceTypes A > B > C (HasSubtype) and D; N references the objects T1..T6 and its ObjectType */
+#define UATEST_REFERENCES_NAMESPACE     2
+#define UATEST_REFERENCES_TYPE_A        1
+#define UATEST_REFERENCES_TYPE_B        2
+#define UATEST_REFERENCES_TYPE_C        3
+#define UATEST_REFERENCES_TYPE_D        4
+#define UATEST_REFERENCES_NODE          10
+#define UATEST_REFERENCES_OBJECTTYPE    20
+
+typedef struct _UaTest_References
+{
+    _ReferenceTypeKnoten_   aReferenceTypes[4];
+    _ReferenceNode_         aSubtypeOfA[1];
+    _ReferenceNode_         aSubtypeOfB[1];
+    _ObjectTypeKnoten_      ObjectType;
+    _ObjectKnoten_          aObjects[7];
+    _ReferenceNode_         aNodeReferences[7];
+    _AddressSpaceTables_    Tables;
+} UaTest_References;
+
+static UaTest_References UaTest_g_References;
+
+/*============================================================================
+ * UaTest_References_NodeId
+ *===========================================================================*/
+static OpcUa_Void UaTest_References_NodeId(OpcUa_NodeId* a_pNodeId, OpcUa_UInt16 a_uNamespaceIndex, OpcUa_UInt32 a_uIdentifier)
+{
+    OpcUa_NodeId_Initialize(a_pNodeId);
+    a_pNodeId->NamespaceIndex       = a_uNamespaceIndex;
+    a_pNodeId->Identifier.Numeric   = a_uIdentifier;
+}
+
+/*============================================================================
+ * UaTest_References_Reference
+ *===========================================================================*/
+static OpcUa_Void UaTest_References_Reference(  _ReferenceNode_*    a_pReference,
+                                                OpcUa_UInt16        a_uTypeNamespaceIndex,
+                                                OpcUa_UInt32        a_uType,
+                                                OpcUa_Boolean       a_bIsInverse,
+                                                OpcUa_UInt32        a_uTarget)
+{
+    UaTest_References_NodeId(&a_pReference->ReferenceTypeId, a_uTypeNamespaceIndex, a_uType);
+    UaTest_References_NodeId(&a_pReference->Target_NodeId, UATEST_REFERENCES_NAMESPACE, a_uTarget);
+    a_pReference->IsInverse             = a_bIsInverse;
+    a_pReference->Target_NamespaceUri   = OpcUa_Null;
+}
+
+/*============================================================================
+ * UaTest_References_Open
+ *===========================================================================*/
+/* the references of N in the order of the References array:
+   A T1, C T2, inverse B T3, D T4, B T5, C T6, HasTypeDefinition ObjectType */
+static OpcUa_StatusCode UaTest_References_Open(OpcUa_Void)
+{
+    UaTest_References*  pFixture    = &UaTest_g_References;
+    OpcUa_Int           i           = 0;
+
+    OpcUa_MemSet(pFixture, 0, sizeof(UaTest_References));
+
+    for(i = 0; i < 4; i++)
+    {
+        UaTest_References_NodeId(&pFixture->aReferenceTypes[i].BaseAttribute.NodeId, UATEST_REFERENCES_NAMESPACE, (OpcUa_UInt32)(UATEST_REFERENCES_TYPE_A + i));
+        pFixture->aReferenceTypes[i].BaseAttribute.NodeClass    = OpcUa_NodeClass_ReferenceType;
+        pFixture->aReferenceTypes[i].BaseAttribute.BrowseName   = "UaTestReferenceType";
+        pFixture->aReferenceTypes[i].BaseAttribute.DisplayName  = "UaTestReferenceType";
+    }
+    UaTest_References_Reference(&pFixture->aSubtypeOfA[0], 0, OpcUaId_HasSubtype, OpcUa_False, UATEST_REFERENCES_TYPE_B);
+    UaTest_References_Reference(&pFixture->aSubtypeOfB[0], 0, OpcUaId_HasSubtype, OpcUa_False, UATEST_REFERENCES_TYPE_C);
+    pFixture->aReferenceTypes[0].BaseAttribute.NoOfReferences   = 1;
+    pFixture->aReferenceTypes[0].BaseAttribute.References       = pFixture->aSubtypeOfA;
+    pFixture->aReferenceTypes[1].BaseAttribute.NoOfReferences   = 1;
+    pFixture->aReferenceTypes[1].BaseAttribute.References       = pFixture->aSubtypeOfB;
+
+    UaTest_References_NodeId(&pFixture->ObjectType.BaseAttribute.NodeId, UATEST_REFERENCES_NAMESPACE, UATEST_REFERENCES_OBJECTTYPE);
+    pFixture->ObjectType.BaseAttribute.NodeClass    = OpcUa_NodeClass_ObjectType;
+    pFixture->ObjectType.BaseAttribute.BrowseName   = "UaTestObjectType";
+    pFixture->ObjectType.BaseAttribute.DisplayName  = "UaTestObjectType";
+
+    for(i = 0; i < 7; i++)
+    {
+        UaTest_References_NodeId(&pFixture->aObjects[i].BaseAttribute.NodeId, UATEST_REFERENCES_NAMESPACE, (OpcUa_UInt32)(UATEST_REFERENCES_NODE + i));
+        pFixture->aObjects[i].BaseAttribute.NodeClass   = OpcUa_NodeClass_Object;
+        pFixture->aObjects[i].BaseAttribute.BrowseName  = "UaTestObject";
+        pFixture->aObjects[i].BaseAttribute.DisplayName = "UaTestObject";
+    }
+    UaTest_References_Reference(&pFixture->aNodeReferences[0], UATEST_REFERENCES_NAMESPACE, UATEST_REFERENCES_TYPE_A, OpcUa_False, UATEST_REFERENCES_NODE + 1);
+    UaTest_References_Reference(&pFixture->aNodeReferences[1], UATEST_REFERENCES_NAMESPACE, UATEST_REFERENCES_TYPE_C, OpcUa_False, UATEST_REFERENCES_NODE + 2);
+    UaTest_References_Reference(&pFixture->aNodeReferences[2], UATEST_REFERENCES_NAMESPACE, UATEST_REFERENCES_TYPE_B, OpcUa_True,  UATEST_REFERENCES_NODE + 3);
+    UaTest_References_Reference(&pFixture->aNodeReferences[3], UATEST_REFERENCES_NAMESPACE, UATEST_REFERENCES_TYPE_D, OpcUa_False, UATEST_REFERENCES_NODE + 4);
+    UaTest_References_Reference(&pFixture->aNodeReferences[4], UATEST_REFERENCES_NAMESPACE, UATEST_REFERENCES_TYPE_B, OpcUa_False, UATEST_REFERENCES_NODE + 5);
+    UaTest_References_Reference(&pFixture->aNodeReferences[5], UATEST_REFERENCES_NAMESPACE, UATEST_REFERENCES_TYPE_C, OpcUa_False, UATEST_REFERENCES_NODE + 6);
+    UaTest_References_Reference(&pFixture->aNodeReferences[6], 0, OpcUaId_HasTypeDefinition, OpcUa_False, UATEST_REFERENCES_OBJECTTYPE);
+    pFixture->aObjects[0].BaseAttribute.NoOfReferences  = 7;
+    pFixture->aObjects[0].BaseAttribute.References      = pFixture->aNodeReferences;
+
+    pFixture->Tables.ReferenceTypes     = pFixture->aReferenceTypes;
+    pFixture->Tables.NoOfReferenceTypes = 4;
+    pFixture->Tables.ObjectTypes        = &pFixture->ObjectType;
+    pFixture->Tables.NoOfObjectTypes    = 1;
+    pFixture->Tables.Objects            = pFixture->aObjects;
+    pFixture->Tables.NoOfObjects        = 7;
+
+    return build_node_index(&pFixture->Tables);
+}
+
+/*============================================================================
+ * UaTest_References_Expect
+ *===========================================================================*/
+/* the references next_reference yields for the filter are exactly a_pExpected (indices in the References array of N), in this order */
+static OpcUa_Boolean UaTest_References_Expect(  OpcUa_UInt32            a_uReferenceType,
+                                                OpcUa_Boolean           a_bIncludeSubtypes,
+                                                OpcUa_BrowseDirection   a_eDirection,
+                                                OpcUa_UInt32            a_uNodeClassMask,
+                                                const OpcUa_Int*        a_pExpected,
+                                                OpcUa_Int               a_iNoOfExpected)
+{
+    OpcUa_BrowseDescription NodeToBrowse;
+    _BaseAttribute_*        pNode       = &UaTest_g_References.aObjects[0].BaseAttribute;
+    _BaseAttribute_*        pTarget     = OpcUa_Null;
+    _ReferenceNode_*        pReference  = OpcUa_Null;
+    OpcUa_Int               iPosition   = 0;
+    OpcUa_Int               iFound      = 0;
+
+    OpcUa_BrowseDescription_Initialize(&NodeToBrowse);
+    NodeToBrowse.NodeId             = pNode->NodeId;
+    NodeToBrowse.BrowseDirection    = a_eDirection;
+    NodeToBrowse.IncludeSubtypes    = a_bIncludeSubtypes;
+    NodeToBrowse.NodeClassMask      = a_uNodeClassMask;
+    if(a_uReferenceType != 0)
+    {
+        UaTest_References_NodeId(&NodeToBrowse.ReferenceTypeId, UATEST_REFERENCES_NAMESPACE, a_uReferenceType);
+    }
+
+    for(iPosition = 0; (pReference = next_reference(&NodeToBrowse, pNode, &iPosition, &pTarget)) != OpcUa_Null; iPosition++)
+    {
+        if(    iFound >= a_iNoOfExpected
+            || pReference != &UaTest_g_References.aNodeReferences[a_pExpected[iFound]]
+            || pTarget != (_BaseAttribute_*)search_for_node(pReference->Target_NodeId))
+        {
+            return OpcUa_False;
+        }
+        iFound++;
+    }
+    return (OpcUa_Boolean)(iFound == a_iNoOfExpected);
+}
+
+/*============================================================================
+ * UaTest_References_Subtypes
+ *===========================================================================*/
+/* the references of a node are grouped forward first, by ReferenceType in order of appearance,
+   and a filter matches its ReferenceType and, with IncludeSubtypes, all of its transitive subtypes */
+static OpcUa_StatusCode UaTest_References_Subtypes(OpcUa_Void)
+{
+    static const OpcUa_Int aAll[]           = { 0, 1, 5, 3, 4, 6, 2 };
+    static const OpcUa_Int aBForward[]      = { 1, 5, 4 };
+    static const OpcUa_Int aBBoth[]         = { 1, 5, 4, 2 };
+    static const OpcUa_Int aBInverse[]      = { 2 };
+    static const OpcUa_Int aBOnlyForward[]  = { 4 };
+    static const OpcUa_Int aAForward[]      = { 0, 1, 5, 4 };
+    static const OpcUa_Int aAOnly[]         = { 0 };
+    static const OpcUa_Int aC[]             = { 1, 5 };
+    static const OpcUa_Int aD[]             = { 3 };
+    static const OpcUa_Int aObjectType[]    = { 6 };
+    const OpcUa_NodeId*    pTypeDefinition  = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "References_Subtypes");
+
+    uStatus = UaTest_References_Open();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    UATEST_CHECK(UaTest_References_Expect(0, OpcUa_True, OpcUa_BrowseDirection_Both, 0, aAll, 7));
+    UATEST_CHECK(UaTest_References_Expect(UATEST_REFERENCES_TYPE_B, OpcUa_True, OpcUa_BrowseDirection_Forward, 0, aBForward, 3));
+    UATEST_CHECK(UaTest_References_Expect(UATEST_REFERENCES_TYPE_B, OpcUa_True, OpcUa_BrowseDirection_Both, 0, aBBoth, 4));
+    UATEST_CHECK(UaTest_References_Expect(UATEST_REFERENCES_TYPE_B, OpcUa_False, OpcUa_BrowseDirection_Inverse, 0, aBInverse, 1));
+    UATEST_CHECK(UaTest_References_Expect(UATEST_REFERENCES_TYPE_B, OpcUa_False, OpcUa_BrowseDirection_Forward, 0, aBOnlyForward, 1));
+    UATEST_CHECK(UaTest_References_Expect(UATEST_REFERENCES_TYPE_A, OpcUa_True, OpcUa_BrowseDirection_Forward, 0, aAForward, 4));
+    UATEST_CHECK(UaTest_References_Expect(UATEST_REFERENCES_TYPE_A, OpcUa_False, OpcUa_BrowseDirection_Both, 0, aAOnly, 1));
+    /* a subtype does not match its supertypes */
+    UATEST_CHECK(UaTest_References_Expect(UATEST_REFERENCES_TYPE_C, OpcUa_True, OpcUa_BrowseDirection_Both, 0, aC, 2));
+    UATEST_CHECK(UaTest_References_Expect(UATEST_REFERENCES_TYPE_D, OpcUa_True, OpcUa_BrowseDirection_Both, 0, aD, 1));
+    UATEST_CHECK(UaTest_References_Expect(UATEST_REFERENCES_TYPE_D, OpcUa_True, OpcUa_BrowseDirection_Inverse, 0, OpcUa_Null, 0));
+    UATEST_CHECK(UaTest_References_Expect(0, OpcUa_True, OpcUa_BrowseDirection_Forward, OpcUa_NodeClass_ObjectType, aObjectType, 1));
+
+    pTypeDefinition = type_definition(&UaTest_g_References.aObjects[0].BaseAttribute);
+    UATEST_CHECK(pTypeDefinition == &UaTest_g_References.aNodeReferences[6].Target_NodeId);
+    UATEST_CHECK(type_definition(&UaTest_g_References.aObjects[1].BaseAttribute) == OpcUa_Null);
+
+    clear_node_index();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    clear_node_index();
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_References_Pages
+ *===========================================================================*/
+/* browse() pages through the grouped order: a page ends where the next one starts */
+static OpcUa_StatusCode UaTest_References_Pages(OpcUa_Void)
+{
+    static const OpcUa_UInt32   aTargets[] = { UATEST_REFERENCES_NODE + 1, UATEST_REFERENCES_NODE + 2,
+                                               UATEST_REFERENCES_NODE + 6, UATEST_REFERENCES_NODE + 5 };
+    OpcUa_BrowseDescription     NodeToBrowse;
+    OpcUa_BrowseResult          Result;
+    OpcUa_Int                   iPosition   = 0;
+    OpcUa_Int                   iNext       = 0;
+    OpcUa_Int                   iPage       = 0;
+    OpcUa_Int32                 i           = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "References_Pages");
+
+    OpcUa_BrowseResult_Initialize(&Result);
+
+    uStatus = UaTest_References_Open();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    OpcUa_BrowseDescription_Initialize(&NodeToBrowse);
+    NodeToBrowse.NodeId             = UaTest_g_References.aObjects[0].BaseAttribute.NodeId;
+    NodeToBrowse.BrowseDirection    = OpcUa_BrowseDirection_Forward;
+    NodeToBrowse.IncludeSubtypes    = OpcUa_True;
+    NodeToBrowse.ResultMask         = OpcUa_BrowseResultMask_All;
+    UaTest_References_NodeId(&NodeToBrowse.ReferenceTypeId, UATEST_REFERENCES_NAMESPACE, UATEST_REFERENCES_TYPE_A);
+
+    for(iPage = 0; iPage < 2; iPage++)
+    {
+        uStatus = browse(&NodeToBrowse, &Result, iPosition, 2, &iNext);
+        OpcUa_GotoErrorIfBad(uStatus);
+        UATEST_CHECK(Result.NoOfReferences == 2);
+        for(i = 0; i < Result.NoOfReferences; i++)
+        {
+            UATEST_CHECK(Result.References[i].NodeId.NodeId.Identifier.Numeric == aTargets[2 * iPage + i]);
+            UATEST_CHECK(Result.References[i].IsForward == OpcUa_True);
+        }
+        OpcUa_BrowseResult_Clear(&Result);
+        iPosition = iNext;
+        UATEST_CHECK((iPage == 0)? iNext > 0: iNext == -1);
+    }
+
+    clear_node_index();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_BrowseResult_Clear(&Result);
+    clear_node_index();
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_References_Filters
+ *===========================================================================*/
+#define UATEST_REFERENCES_NOOFFILTERS   8
+/** @brief Filters, with and without subtypes, in the three browse directions. */
+#define UATEST_REFERENCES_NOOFCASES     (UATEST_REFERENCES_NOOFFILTERS * 2 * 3)
+
+static const OpcUa_UInt32   UaTest_g_auReferenceFilters[UATEST_REFERENCES_NOOFFILTERS]  =
+{
+    0,
+    OpcUaId_HierarchicalReferences,
+    OpcUaId_HasChild,
+    OpcUaId_Aggregates,
+    OpcUaId_HasComponent,
+    OpcUaId_Organizes,
+    OpcUaId_HasTypeDefinition,
+    OpcUaId_HasSubtype
+};
+
+/*============================================================================
+ * UaTest_References_Match
+ *===========================================================================*/
+/* counts in a_pMatched, per case and reference of the node, how often next_reference yields the reference */
+static OpcUa_Void UaTest_References_Match(_BaseAttribute_* a_pNode, OpcUa_Byte* a_pMatched)
+{
+    OpcUa_BrowseDescription NodeToBrowse;
+    _BaseAttribute_*        pTarget     = OpcUa_Null;
+    _ReferenceNode_*        pReference  = OpcUa_Null;
+    OpcUa_Int               iPosition   = 0;
+    OpcUa_Int               iCase       = 0;
+
+    for(iCase = 0; iCase < UATEST_REFERENCES_NOOFCASES; iCase++)
+    {
+        OpcUa_BrowseDescription_Initialize(&NodeToBrowse);
+        NodeToBrowse.NodeId                             = a_pNode->NodeId;
+        NodeToBrowse.BrowseDirection                    = (OpcUa_BrowseDirection)(iCase % 3);
+        NodeToBrowse.IncludeSubtypes                    = (OpcUa_Boolean)((iCase / 3) % 2);
+        NodeToBrowse.ReferenceTypeId.Identifier.Numeric = UaTest_g_auReferenceFilters[iCase / 6];
+
+        for(iPosition = 0; (pReference = next_reference(&NodeToBrowse, a_pNode, &iPosition, &pTarget)) != OpcUa_Null; iPosition++)
+        {
+            a_pMatched[pReference - a_pNode->References]++;
+        }
+        a_pMatched += a_pNode->NoOfReferences;
+    }
+}
+
+/*============================================================================
+ * UaTest_References_MatchesScan
+ *===========================================================================*/
+/* over the built-in address space the grouped references match what the scan of the References array matches */
+static OpcUa_StatusCode UaTest_References_MatchesScan(OpcUa_Void)
+{
+    _AddressSpaceTables_    Tables;
+    _BaseAttribute_*        pNode           = OpcUa_Null;
+    const OpcUa_NodeId**    ppTypeDefinitions = OpcUa_Null;
+    OpcUa_Byte*             pIndexed        = OpcUa_Null;
+    OpcUa_Byte*             pScanned        = OpcUa_Null;
+    OpcUa_UInt32            uSize           = 0;
+    OpcUa_UInt32            uOffset         = 0;
+    OpcUa_Int               iNoOfNodes      = 0;
+    OpcUa_Int               iNode           = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "References_MatchesScan");
+
+    get_builtin_addressspace(&Tables);
+    iNoOfNodes = UaTest_NodeIndex_NoOfNodes(&Tables);
+    for(iNode = 0; iNode < iNoOfNodes; iNode++)
+    {
+        uSize += (OpcUa_UInt32)UaTest_NodeIndex_GetNode(&Tables, iNode)->NoOfReferences;
+    }
+    uSize *= UATEST_REFERENCES_NOOFCASES;
+
+    pIndexed = (OpcUa_Byte*)OpcUa_Alloc(uSize);
+    OpcUa_GotoErrorIfAllocFailed(pIndexed);
+    pScanned = (OpcUa_Byte*)OpcUa_Alloc(uSize);
+    OpcUa_GotoErrorIfAllocFailed(pScanned);
+    ppTypeDefinitions = (const OpcUa_NodeId**)OpcUa_Alloc(iNoOfNodes * sizeof(OpcUa_NodeId*));
+    OpcUa_GotoErrorIfAllocFailed(ppTypeDefinitions);
+    OpcUa_MemSet(pIndexed, 0, uSize);
+    OpcUa_MemSet(pScanned, 0, uSize);
+
+    uStatus = build_node_index(OpcUa_Null);
+    OpcUa_GotoErrorIfBad(uStatus);
+    for(iNode = 0, uOffset = 0; iNode < iNoOfNodes; iNode++)
+    {
+        pNode = UaTest_NodeIndex_GetNode(&Tables, iNode);
+        UaTest_References_Match(pNode, pIndexed + uOffset);
+        uOffset += (OpcUa_UInt32)pNode->NoOfReferences * UATEST_REFERENCES_NOOFCASES;
+        ppTypeDefinitions[iNode] = type_definition(pNode);
+    }
+
+    /* without the tables next_reference scans the References array */
+    clear_node_index();
+    for(iNode = 0, uOffset = 0; iNode < iNoOfNodes; iNode++)
+    {
+        pNode = UaTest_NodeIndex_GetNode(&Tables, iNode);
+        UaTest_References_Match(pNode, pScanned + uOffset);
+        uOffset += (OpcUa_UInt32)pNode->NoOfReferences * UATEST_REFERENCES_NOOFCASES;
+        UATEST_CHECK(type_definition(pNode) == ppTypeDefinitions[iNode]);
+    }
+
+    UATEST_CHECK(memcmp(pIndexed, pScanned, uSize) == 0);
+
+    OpcUa_Free(pIndexed);
+    OpcUa_Free(pScanned);
+    OpcUa_Free((OpcUa_Void*)ppTypeDefinitions);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    clear_node_index();
+    OpcUa_Free(pIndexed);
+    OpcUa_Free(pScanned);
+    OpcUa_Free((OpcUa_Void*)ppTypeDefinitions);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * Case table
+ *===========================================================================*/
+UaTest_Case UaTest_g_BrowseCases[] =
+{
+    { "sample/nodeindex/linearsearch",  UaTest_NodeIndex_MatchesLinearSearch },
+    { "sample/nodeindex/values",        UaTest_NodeIndex_ComparesByValue },
+    { "sample/continuationpoints/lru",  UaTest_ContinuationPoints_EvictsLeastRecentlyUsed },
+    { "sample/references/subtypes",     UaTest_References_Subtypes },
+    { "sample/references/pages",        UaTest_References_Pages },
+    { "sample/references/matchesscan",  UaTest_References_MatchesScan },
+    UATEST_CASE_END
+};
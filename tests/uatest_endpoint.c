@@ -0,0 +1,505 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+/******************************************************************************************************/
+/* Tests for the endpoint: a client calls a service through a real endpoint. The service, secure    */
+/* channel and connection counters are compared against each other, and stored pre-encoded          */
+/* responses are sent in place of the service.                                                       */
+/******************************************************************************************************/
+
+#include <opcua_serverstub.h>
+#include <opcua_memory.h>
+#include <opcua_string.h>
+#include <opcua_thread.h>
+#include <opcua_core.h>
+
+#include "uatest.h"
+#include "uatest_loopback.h"
+
+#if defined(OPCUA_HAVE_CLIENTAPI) && defined(OPCUA_HAVE_SERVERAPI)
+
+#include <opcua_securechannel.h>
+#include <opcua_tcplistener.h>
+
+#include <string.h>
+
+/*============================================================================
+ * Test settings
+ *===========================================================================*/
+/** @brief Header bytes of a single chunk message under the None policy: transport, channel id, token id, sequence header. */
+#define UATEST_ENDPOINT_NONEHEADER      24
+/** @brief Servers in the stored responses; enough for a response of several chunks. */
+#define UATEST_ENDPOINT_SERVERS         2000
+
+/*============================================================================
+ * UaTest_Endpoint
+ *===========================================================================*/
+typedef struct _UaTest_Endpoint
+{
+    UaTest_Loopback                                 Loopback;
+    OpcUa_ServiceType                               FindServersType;
+    OpcUa_ServiceType*                              apServices[2];
+    /** @brief Servers returned by FindServers, all with sServerUri. */
+    OpcUa_Int32                                     nNoOfServers;
+    OpcUa_StringA                                   sServerUri;
+    /** @brief FindServers stores its response, keyed by the number of locale ids. */
+    OpcUa_Boolean                                   bStoreResponse;
+    OpcUa_UInt32                                    uNoOfInvokes;
+} UaTest_Endpoint;
+
+static UaTest_Endpoint UaTest_g_Endpoint;
+
+/*============================================================================
+ * UaTest_Endpoint_FindServers
+ *===========================================================================*/
+/* server uris make the call fail with a fault, locale ids only set a bad service result */
+static OpcUa_StatusCode UaTest_Endpoint_FindServers(
+    OpcUa_Endpoint                 a_hEndpoint,
+    OpcUa_Handle                   a_hContext,
+    const OpcUa_RequestHeader*     a_pRequestHeader,
+    const OpcUa_String*            a_pEndpointUrl,
+    OpcUa_Int32                    a_nNoOfLocaleIds,
+    const OpcUa_String*            a_pLocaleIds,
+    OpcUa_Int32                    a_nNoOfServerUris,
+    const OpcUa_String*            a_pServerUris,
+    OpcUa_ResponseHeader*          a_pResponseHeader,
+    OpcUa_Int32*                   a_pNoOfServers,
+    OpcUa_ApplicationDescription** a_pServers)
+{
+    UaTest_Endpoint*    pTest   = &UaTest_g_Endpoint;
+    OpcUa_Int32         i       = 0;
+
+    OpcUa_ReferenceParameter(a_hContext);
+    OpcUa_ReferenceParameter(a_pEndpointUrl);
+    OpcUa_ReferenceParameter(a_pLocaleIds);
+    OpcUa_ReferenceParameter(a_pServerUris);
+
+    pTest->uNoOfInvokes++;
+
+    if(a_nNoOfServerUris > 0)
+    {
+        return OpcUa_BadNotFound;
+    }
+
+    a_pResponseHeader->RequestHandle = a_pRequestHeader->RequestHandle;
+    a_pResponseHeader->Timestamp     = OpcUa_DateTime_UtcNow();
+    a_pResponseHeader->ServiceResult = (a_nNoOfLocaleIds > 0)?OpcUa_BadNothingToDo:OpcUa_Good;
+
+    *a_pNoOfServers = 0;
+    *a_pServers     = OpcUa_Null;
+
+    if(pTest->nNoOfServers > 0)
+    {
+        *a_pServers = (OpcUa_ApplicationDescription*)OpcUa_Alloc(pTest->nNoOfServers * sizeof(OpcUa_ApplicationDescription));
+        if(*a_pServers == OpcUa_Null)
+        {
+            return OpcUa_BadOutOfMemory;
+        }
+        for(i = 0; i < pTest->nNoOfServers; i++)
+        {
+            OpcUa_ApplicationDescription_Initialize(&(*a_pServers)[i]);
+            OpcUa_String_AttachCopy(&(*a_pServers)[i].ApplicationUri, pTest->sServerUri);
+        }
+        *a_pNoOfServers = pTest->nNoOfServers;
+    }
+
+#ifdef OPCUA_SUPPORT_PREENCODED_MESSAGES
+    if(pTest->bStoreResponse != OpcUa_False)
+    {
+        /* shallow copy, not cleared */
+        OpcUa_FindServersResponse Response;
+        OpcUa_FindServersResponse_Initialize(&Response);
+        Response.ResponseHeader = *a_pResponseHeader;
+        Response.NoOfServers    = *a_pNoOfServers;
+        Response.Servers        = *a_pServers;
+        OpcUa_Endpoint_SetEncodedResponse(  a_hEndpoint,
+                                            OpcUaId_FindServersRequest,
+                                            (OpcUa_UInt32)a_nNoOfLocaleIds,
+                                            &Response,
+                                            &OpcUa_FindServersResponse_EncodeableType);
+    }
+#else /* OPCUA_SUPPORT_PREENCODED_MESSAGES */
+    OpcUa_ReferenceParameter(a_hEndpoint);
+#endif /* OPCUA_SUPPORT_PREENCODED_MESSAGES */
+
+    return OpcUa_Good;
+}
+
+#ifdef OPCUA_SUPPORT_PREENCODED_MESSAGES
+/*============================================================================
+ * UaTest_Endpoint_BeginFindServers
+ *===========================================================================*/
+/* sends the response stored for the number of locale ids, else calls the service */
+static OpcUa_StatusCode UaTest_Endpoint_BeginFindServers(
+    OpcUa_Endpoint          a_hEndpoint,
+    OpcUa_Handle            a_hContext,
+    OpcUa_Void**            a_ppRequest,
+    OpcUa_EncodeableType*   a_pRequestType)
+{
+    OpcUa_FindServersRequest*   pRequest    = (OpcUa_FindServersRequest*)*a_ppRequest;
+    OpcUa_StatusCode            uStatus     = OpcUa_Good;
+
+    uStatus = OpcUa_Endpoint_EndSendEncodedResponse(a_hEndpoint,
+                                                    &a_hContext,
+                                                    (OpcUa_UInt32)pRequest->NoOfLocaleIds,
+                                                    pRequest->RequestHeader.RequestHandle);
+    if(uStatus != OpcUa_BadNotFound)
+    {
+        return uStatus;
+    }
+
+    return OpcUa_Server_BeginFindServers(a_hEndpoint, a_hContext, a_ppRequest, a_pRequestType);
+}
+#endif /* OPCUA_SUPPORT_PREENCODED_MESSAGES */
+
+/*============================================================================
+ * UaTest_Endpoint_Open
+ *===========================================================================*/
+/* opens an endpoint for FindServers and connects a channel to it */
+static OpcUa_StatusCode UaTest_Endpoint_Open(OpcUa_PfnBeginInvokeService* a_pfnBeginInvoke)
+{
+    UaTest_Endpoint* pTest = &UaTest_g_Endpoint;
+
+    memset(pTest, 0, sizeof(UaTest_Endpoint));
+
+    pTest->FindServersType.RequestTypeId = OpcUaId_FindServersRequest;
+    pTest->FindServersType.ResponseType  = &OpcUa_FindServersResponse_EncodeableType;
+    pTest->FindServersType.BeginInvoke   = a_pfnBeginInvoke;
+    pTest->FindServersType.Invoke        = (OpcUa_PfnInvokeService*)UaTest_Endpoint_FindServers;
+    pTest->apServices[0] = &pTest->FindServersType;
+    pTest->apServices[1] = OpcUa_Null;
+
+    return UaTest_Loopback_Open(&pTest->Loopback, pTest->apServices);
+}
+
+/*============================================================================
+ * UaTest_Endpoint_Call
+ *===========================================================================*/
+/* calls FindServers and returns the service result the client received */
+static OpcUa_StatusCode UaTest_Endpoint_Call(   OpcUa_Int32         a_nNoOfLocaleIds,
+                                                OpcUa_Int32         a_nNoOfServerUris,
+                                                OpcUa_StatusCode*   a_pServiceResult)
+{
+    UaTest_Endpoint*                pTest       = &UaTest_g_Endpoint;
+    OpcUa_RequestHeader             RequestHeader;
+    OpcUa_ResponseHeader            ResponseHeader;
+    OpcUa_String                    sEndpointUrl;
+    OpcUa_String                    sEntry;
+    OpcUa_Int32                     nNoOfServers = 0;
+    OpcUa_ApplicationDescription*   pServers     = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Endpoint_Call");
+
+    OpcUa_RequestHeader_Initialize(&RequestHeader);
+    OpcUa_ResponseHeader_Initialize(&ResponseHeader);
+    OpcUa_String_Initialize(&sEndpointUrl);
+    OpcUa_String_Initialize(&sEntry);
+
+    RequestHeader.Timestamp     = OpcUa_DateTime_UtcNow();
+    RequestHeader.RequestHandle = 1;
+    RequestHeader.TimeoutHint   = UATEST_LOOPBACK_TIMEOUT;
+    OpcUa_String_AttachReadOnly(&sEndpointUrl, pTest->Loopback.sUrl);
+    OpcUa_String_AttachReadOnly(&sEntry, "en");
+
+    uStatus = OpcUa_ClientApi_FindServers(  pTest->Loopback.hChannel,
+                                            &RequestHeader,
+                                            &sEndpointUrl,
+                                            a_nNoOfLocaleIds,
+                                            &sEntry,
+                                            a_nNoOfServerUris,
+                                            &sEntry,
+                                            &ResponseHeader,
+                                            &nNoOfServers,
+                                            &pServers);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    *a_pServiceResult = ResponseHeader.ServiceResult;
+
+    OpcUa_ResponseHeader_Clear(&ResponseHeader);
+    OpcUa_RequestHeader_Clear(&RequestHeader);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_ResponseHeader_Clear(&ResponseHeader);
+    OpcUa_RequestHeader_Clear(&RequestHeader);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Endpoint_Counters
+ *===========================================================================*/
+/* the endpoint, its secure channel and its connection account the same three calls */
+static OpcUa_StatusCode UaTest_Endpoint_Counters(OpcUa_Void)
+{
+    UaTest_Endpoint*                pTest           = &UaTest_g_Endpoint;
+    OpcUa_SecureChannelCounters     ChannelBefore;
+    OpcUa_SecureChannelCounters     ChannelAfter;
+    OpcUa_TcpConnectionCounters     ConnectionBefore;
+    OpcUa_TcpConnectionCounters     ConnectionAfter;
+    OpcUa_ServiceCounters           Service;
+    OpcUa_UInt32                    uNoOfCounters   = 0;
+    OpcUa_StatusCode                uServiceResult  = OpcUa_Good;
+    OpcUa_UInt32                    uWaited         = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Endpoint_Counters");
+
+    uStatus = UaTest_Endpoint_Open(OpcUa_Server_BeginFindServers);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = OpcUa_Endpoint_GetSecureChannelCounters(pTest->Loopback.hEndpoint, 1, &ChannelBefore, &uNoOfCounters);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(uNoOfCounters == 1);
+    uStatus = OpcUa_Endpoint_GetConnectionCounters(pTest->Loopback.hEndpoint, 1, &ConnectionBefore, &uNoOfCounters);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(uNoOfCounters == 1);
+    UATEST_CHECK(ConnectionBefore.ChunksIn > 0 && ConnectionBefore.ChunksOut > 0);
+    UATEST_CHECK(ConnectionBefore.PeerInfo[0] != '\0');
+
+    /* a response, a response with a bad service result and a service fault */
+    uStatus = UaTest_Endpoint_Call(0, 0, &uServiceResult);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(uServiceResult == OpcUa_Good);
+    uStatus = UaTest_Endpoint_Call(1, 0, &uServiceResult);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(uServiceResult == OpcUa_BadNothingToDo);
+    uStatus = UaTest_Endpoint_Call(0, 1, &uServiceResult);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(uServiceResult == OpcUa_BadNotFound);
+
+    /* the client may see the last response before the server accounted it */
+    do
+    {
+        uStatus = OpcUa_Endpoint_GetServiceCounters(pTest->Loopback.hEndpoint, 1, &Service, &uNoOfCounters);
+        OpcUa_GotoErrorIfBad(uStatus);
+        uStatus = OpcUa_Endpoint_GetSecureChannelCounters(pTest->Loopback.hEndpoint, 1, &ChannelAfter, &uNoOfCounters);
+        OpcUa_GotoErrorIfBad(uStatus);
+        uStatus = OpcUa_Endpoint_GetConnectionCounters(pTest->Loopback.hEndpoint, 1, &ConnectionAfter, &uNoOfCounters);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        if(     Service.Calls == 3
+            &&  ChannelAfter.MessagesOut - ChannelBefore.MessagesOut == 3
+            &&  ConnectionAfter.ChunksOut - ConnectionBefore.ChunksOut == 3)
+        {
+            break;
+        }
+
+        OpcUa_Thread_Sleep(10);
+        uWaited += 10;
+    } while(uWaited < UATEST_LOOPBACK_TIMEOUT);
+
+    UATEST_CHECK(Service.RequestTypeId == OpcUaId_FindServersRequest);
+    UATEST_CHECK(Service.Calls == 3);
+    UATEST_CHECK(Service.Faults == 1);
+    UATEST_CHECK(Service.BytesIn > 0);
+
+    /* the service measures the message bodies the channel wraps into single chunks */
+    UATEST_CHECK(ChannelAfter.MessagesOut - ChannelBefore.MessagesOut == 3);
+    UATEST_CHECK(ChannelAfter.ChunksOut - ChannelBefore.ChunksOut == 3);
+    UATEST_CHECK(ChannelAfter.BytesOut - ChannelBefore.BytesOut == Service.BytesOut + 3 * UATEST_ENDPOINT_NONEHEADER);
+
+    /* the connection carries exactly the chunks of the channel */
+    UATEST_CHECK(ConnectionAfter.ChunksIn - ConnectionBefore.ChunksIn == 3);
+    UATEST_CHECK(ConnectionAfter.ChunksOut - ConnectionBefore.ChunksOut == 3);
+    UATEST_CHECK(ConnectionAfter.BytesIn - ConnectionBefore.BytesIn == ChannelAfter.BytesIn - ChannelBefore.BytesIn);
+    UATEST_CHECK(ConnectionAfter.BytesOut - ConnectionBefore.BytesOut == ChannelAfter.BytesOut - ChannelBefore.BytesOut);
+    UATEST_CHECK(ConnectionAfter.Errors == 0);
+
+    UaTest_Loopback_Clear(&pTest->Loopback);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_Loopback_Clear(&pTest->Loopback);
+
+OpcUa_FinishErrorHandling;
+}
+
+#ifdef OPCUA_SUPPORT_PREENCODED_MESSAGES
+/*============================================================================
+ * UaTest_Endpoint_CallStored
+ *===========================================================================*/
+/* calls FindServers and checks the servers and the patched response header the client received */
+static OpcUa_StatusCode UaTest_Endpoint_CallStored( OpcUa_Int32     a_nNoOfLocaleIds,
+                                                    OpcUa_UInt32    a_uRequestHandle,
+                                                    OpcUa_StringA   a_sServerUri,
+                                                    OpcUa_Int32     a_nNoOfServers)
+{
+    UaTest_Endpoint*                pTest       = &UaTest_g_Endpoint;
+    OpcUa_RequestHeader             RequestHeader;
+    OpcUa_ResponseHeader            ResponseHeader;
+    OpcUa_String                    sEndpointUrl;
+    OpcUa_String                    sLocaleId;
+    OpcUa_DateTime                  Sent;
+    OpcUa_Int32                     nNoOfServers = 0;
+    OpcUa_ApplicationDescription*   pServers     = OpcUa_Null;
+    OpcUa_Int32                     i            = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Endpoint_CallStored");
+
+    OpcUa_RequestHeader_Initialize(&RequestHeader);
+    OpcUa_ResponseHeader_Initialize(&ResponseHeader);
+    OpcUa_String_Initialize(&sEndpointUrl);
+    OpcUa_String_Initialize(&sLocaleId);
+
+    Sent = OpcUa_DateTime_UtcNow();
+    RequestHeader.Timestamp     = Sent;
+    RequestHeader.RequestHandle = a_uRequestHandle;
+    RequestHeader.TimeoutHint   = UATEST_LOOPBACK_TIMEOUT;
+    OpcUa_String_AttachReadOnly(&sEndpointUrl, pTest->Loopback.sUrl);
+    OpcUa_String_AttachReadOnly(&sLocaleId, "en");
+
+    uStatus = OpcUa_ClientApi_FindServers(  pTest->Loopback.hChannel,
+                                            &RequestHeader,
+                                            &sEndpointUrl,
+                                            a_nNoOfLocaleIds,
+                                            &sLocaleId,
+                                            0,
+                                            OpcUa_Null,
+                                            &ResponseHeader,
+                                            &nNoOfServers,
+                                            &pServers);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* the stored response carries the handle and the time of this request */
+    UATEST_CHECK(ResponseHeader.RequestHandle == a_uRequestHandle);
+    UATEST_CHECK(       ResponseHeader.Timestamp.dwHighDateTime > Sent.dwHighDateTime
+                    || (ResponseHeader.Timestamp.dwHighDateTime == Sent.dwHighDateTime
+                        && ResponseHeader.Timestamp.dwLowDateTime >= Sent.dwLowDateTime));
+
+    UATEST_CHECK(nNoOfServers == a_nNoOfServers);
+    for(i = 0; i < nNoOfServers; i++)
+    {
+        UATEST_CHECK(OpcUa_StrCmpA(OpcUa_String_GetRawString(&pServers[i].ApplicationUri), a_sServerUri) == 0);
+    }
+
+    for(i = 0; i < nNoOfServers; i++)
+    {
+        OpcUa_ApplicationDescription_Clear(&pServers[i]);
+    }
+    OpcUa_Free(pServers);
+    OpcUa_ResponseHeader_Clear(&ResponseHeader);
+    OpcUa_RequestHeader_Clear(&RequestHeader);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    for(i = 0; i < nNoOfServers; i++)
+    {
+        OpcUa_ApplicationDescription_Clear(&pServers[i]);
+    }
+    OpcUa_Free(pServers);
+    OpcUa_ResponseHeader_Clear(&ResponseHeader);
+    OpcUa_RequestHeader_Clear(&RequestHeader);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Endpoint_EncodedResponse
+ *===========================================================================*/
+/* a stored response is sent instead of calling the service, per request type and fingerprint,
+   until it is replaced or removed */
+static OpcUa_StatusCode UaTest_Endpoint_EncodedResponse(OpcUa_Void)
+{
+    UaTest_Endpoint*                pTest   = &UaTest_g_Endpoint;
+    OpcUa_FindServersResponse       Response;
+    OpcUa_ApplicationDescription    Server;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Endpoint_EncodedResponse");
+
+    uStatus = UaTest_Endpoint_Open(UaTest_Endpoint_BeginFindServers);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    pTest->nNoOfServers   = UATEST_ENDPOINT_SERVERS;
+    pTest->sServerUri     = "urn:UaTest:Endpoint:Stored";
+    pTest->bStoreResponse = OpcUa_True;
+
+    /* the first call stores the response, the second one gets it */
+    uStatus = UaTest_Endpoint_CallStored(0, 1, "urn:UaTest:Endpoint:Stored", UATEST_ENDPOINT_SERVERS);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(pTest->uNoOfInvokes == 1);
+
+    pTest->bStoreResponse = OpcUa_False;
+    pTest->sServerUri     = "urn:UaTest:Endpoint:Invoked";
+
+    uStatus = UaTest_Endpoint_CallStored(0, 2, "urn:UaTest:Endpoint:Stored", UATEST_ENDPOINT_SERVERS);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(pTest->uNoOfInvokes == 1);
+
+    /* another fingerprint has nothing stored */
+    uStatus = UaTest_Endpoint_CallStored(1, 3, "urn:UaTest:Endpoint:Invoked", UATEST_ENDPOINT_SERVERS);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(pTest->uNoOfInvokes == 2);
+
+    /* the application replaces the stored response */
+    OpcUa_ApplicationDescription_Initialize(&Server);
+    OpcUa_String_AttachReadOnly(&Server.ApplicationUri, "urn:UaTest:Endpoint:Replaced");
+    OpcUa_FindServersResponse_Initialize(&Response);
+    Response.NoOfServers = 1;
+    Response.Servers     = &Server;
+    uStatus = OpcUa_Endpoint_SetEncodedResponse(pTest->Loopback.hEndpoint,
+                                                OpcUaId_FindServersRequest,
+                                                0,
+                                                &Response,
+                                                &OpcUa_FindServersResponse_EncodeableType);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = UaTest_Endpoint_CallStored(0, 4, "urn:UaTest:Endpoint:Replaced", 1);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(pTest->uNoOfInvokes == 2);
+
+    /* and removes it */
+    uStatus = OpcUa_Endpoint_SetEncodedResponse(pTest->Loopback.hEndpoint, OpcUaId_FindServersRequest, 0, OpcUa_Null, OpcUa_Null);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = UaTest_Endpoint_CallStored(0, 5, "urn:UaTest:Endpoint:Invoked", UATEST_ENDPOINT_SERVERS);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(pTest->uNoOfInvokes == 3);
+
+    /* a stored response left behind is freed with the endpoint */
+    pTest->bStoreResponse = OpcUa_True;
+    uStatus = UaTest_Endpoint_CallStored(0, 6, "urn:UaTest:Endpoint:Invoked", UATEST_ENDPOINT_SERVERS);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(pTest->uNoOfInvokes == 4);
+
+    UaTest_Loopback_Clear(&pTest->Loopback);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_Loopback_Clear(&pTest->Loopback);
+
+OpcUa_FinishErrorHandling;
+}
+#endif /* OPCUA_SUPPORT_PREENCODED_MESSAGES */
+
+#endif /* OPCUA_HAVE_CLIENTAPI && OPCUA_HAVE_SERVERAPI */
+
+/*============================================================================
+ * Case table
+ *===========================================================================*/
+UaTest_Case UaTest_g_EndpointCases[] =
+{
+#if defined(OPCUA_HAVE_CLIENTAPI) && defined(OPCUA_HAVE_SERVERAPI)
+    { "stack/endpoint/counters",          UaTest_Endpoint_Counters },
+#ifdef OPCUA_SUPPORT_PREENCODED_MESSAGES
+    { "stack/endpoint/encodedresponse",   UaTest_Endpoint_EncodedResponse },
+#endif /* OPCUA_SUPPORT_PREENCODED_MESSAGES */
+#endif /* OPCUA_HAVE_CLIENTAPI && OPCUA_HAVE_SERVERAPI */
+    UATEST_CASE_END
+};
@@ -0,0 +1,722 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+/******************************************************************************************************/
+/* Tests for the HTTPS listener: pipelined requests are answered in request order, each on its own.  */
+/******************************************************************************************************/
+
+#include <opcua_serverstub.h>
+#include <opcua_memory.h>
+#include <opcua_string.h>
+#include <opcua_thread.h>
+#include <opcua_listener.h>
+
+#include "uatest.h"
+
+#ifdef OPCUA_HAVE_HTTPS
+
+#include <opcua_httpslistener.h>
+#include <opcua_p_types.h>
+
+#include <openssl/evp.h>
+#include <openssl/rsa.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+/*============================================================================
+ * Types and constants
+ *===========================================================================*/
+/** @brief First port tried for the listener; the next ones are tried if it is taken. */
+#define UATEST_HTTPS_PORT               48443
+#define UATEST_HTTPS_NOOFPORTS          10
+/** @brief Upper bound of the requests one case sends. */
+#define UATEST_HTTPS_MAXREQUESTS        32
+/** @brief How long the listener gets to dispatch the requests. */
+#define UATEST_HTTPS_TIMEOUT            10000
+/** @brief How long the test watches for requests beyond the pipeline depth. */
+#define UATEST_HTTPS_SETTLETIME         100
+/** @brief Room for the responses the client has received but not looked at. */
+#define UATEST_HTTPS_MAXRECEIVED        16384
+
+/** @brief What the client takes from one response. */
+typedef struct _UaTest_Https_Response
+{
+    unsigned int                            uStatus;
+    OpcUa_Boolean                           bKeepAlive;
+    char                                    sBody[32];
+} UaTest_Https_Response;
+
+typedef struct _UaTest_Https
+{
+    OpcUa_Listener*                         pListener;
+    /** @brief Credentials and PKI of the listener; they have to outlive it. */
+    OpcUa_ByteString                        Certificate;
+    OpcUa_Key                               Key;
+    OpcUa_P_OpenSSL_CertificateStore_Config PkiConfig;
+    OpcUa_PKIProvider                       PkiOverride;
+    X509*                                   pCertificate;
+    EVP_PKEY*                               pKey;
+    /** @brief The client side of the connection. */
+    SSL_CTX*                                pSslContext;
+    BIO*                                    pClient;
+    OpcUa_CharA                             sHost[32];
+    char                                    sReceived[UATEST_HTTPS_MAXRECEIVED];
+    int                                     iReceived;
+    /** @brief Response streams of the dispatched requests, by request number. */
+    OpcUa_OutputStream*                     apResponses[UATEST_HTTPS_MAXREQUESTS];
+    OpcUa_UInt32                            uNoOfDispatched;
+    OpcUa_UInt32                            uNoOfAnswered;
+    OpcUa_UInt32                            uNoOfBadRequests;
+} UaTest_Https;
+
+static UaTest_Https         UaTest_g_Https;
+
+/*============================================================================
+ * UaTest_Https_CreateCredentials
+ *===========================================================================*/
+/* a self-signed RSA certificate; listener and client both use it */
+static OpcUa_StatusCode UaTest_Https_CreateCredentials( X509**              a_ppCertificate,
+                                                        EVP_PKEY**          a_ppKey,
+                                                        OpcUa_ByteString*   a_pCertificate,
+                                                        OpcUa_Key*          a_pKey)
+{
+    EVP_PKEY_CTX*   pContext    = OpcUa_Null;
+    X509_NAME*      pName       = OpcUa_Null;
+    OpcUa_Byte*     pData       = OpcUa_Null;
+    int             iLength     = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Https_CreateCredentials");
+
+    pContext = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, OpcUa_Null);
+    OpcUa_GotoErrorIfAllocFailed(pContext);
+    OpcUa_GotoErrorIfTrue(EVP_PKEY_keygen_init(pContext) <= 0, OpcUa_BadInternalError);
+    OpcUa_GotoErrorIfTrue(EVP_PKEY_CTX_set_rsa_keygen_bits(pContext, 2048) <= 0, OpcUa_BadInternalError);
+    OpcUa_GotoErrorIfTrue(EVP_PKEY_keygen(pContext, a_ppKey) <= 0, OpcUa_BadInternalError);
+
+    *a_ppCertificate = X509_new();
+    OpcUa_GotoErrorIfAllocFailed(*a_ppCertificate);
+    X509_set_version(*a_ppCertificate, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(*a_ppCertificate), 1);
+    X509_gmtime_adj(X509_getm_notBefore(*a_ppCertificate), 0);
+    X509_gmtime_adj(X509_getm_notAfter(*a_ppCertificate), 3600);
+    X509_set_pubkey(*a_ppCertificate, *a_ppKey);
+    pName = X509_get_subject_name(*a_ppCertificate);
+    X509_NAME_add_entry_by_txt(pName, "CN", MBSTRING_ASC, (const unsigned char*)"UaTest", -1, -1, 0);
+    X509_set_issuer_name(*a_ppCertificate, pName);
+    OpcUa_GotoErrorIfTrue(X509_sign(*a_ppCertificate, *a_ppKey, EVP_sha256()) <= 0, OpcUa_BadInternalError);
+
+    iLength = i2d_X509(*a_ppCertificate, OpcUa_Null);
+    OpcUa_GotoErrorIfTrue(iLength <= 0, OpcUa_BadInternalError);
+    a_pCertificate->Data = (OpcUa_Byte*)OpcUa_Alloc((OpcUa_UInt32)iLength);
+    OpcUa_GotoErrorIfAllocFailed(a_pCertificate->Data);
+    pData = a_pCertificate->Data;
+    a_pCertificate->Length = i2d_X509(*a_ppCertificate, &pData);
+
+    iLength = i2d_PrivateKey(*a_ppKey, OpcUa_Null);
+    OpcUa_GotoErrorIfTrue(iLength <= 0, OpcUa_BadInternalError);
+    a_pKey->Type = OpcUa_Crypto_KeyType_Rsa_Private;
+    a_pKey->Key.Data = (OpcUa_Byte*)OpcUa_Alloc((OpcUa_UInt32)iLength);
+    OpcUa_GotoErrorIfAllocFailed(a_pKey->Key.Data);
+    pData = a_pKey->Key.Data;
+    a_pKey->Key.Length = i2d_PrivateKey(*a_ppKey, &pData);
+
+    EVP_PKEY_CTX_free(pContext);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    EVP_PKEY_CTX_free(pContext);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * PKI and secure channel callbacks
+ *===========================================================================*/
+/* the client presents the listener's own certificate; it is not checked further */
+static OpcUa_StatusCode UaTest_Https_OpenCertificateStore(  OpcUa_PKIProvider*  a_pProvider,
+                                                            OpcUa_Void**        a_ppCertificateStore)
+{
+    OpcUa_ReferenceParameter(a_pProvider);
+    *a_ppCertificateStore = (OpcUa_Void*)&UaTest_g_Https;
+    return OpcUa_Good;
+}
+
+static OpcUa_StatusCode UaTest_Https_CloseCertificateStore( OpcUa_PKIProvider*  a_pProvider,
+                                                            OpcUa_Void**        a_ppCertificateStore)
+{
+    OpcUa_ReferenceParameter(a_pProvider);
+    *a_ppCertificateStore = OpcUa_Null;
+    return OpcUa_Good;
+}
+
+static OpcUa_StatusCode UaTest_Https_ValidateCertificate(   OpcUa_PKIProvider*  a_pProvider,
+                                                            OpcUa_ByteString*   a_pCertificate,
+                                                            OpcUa_Void*         a_pCertificateStore,
+                                                            OpcUa_Int*          a_pValidationCode)
+{
+    OpcUa_ReferenceParameter(a_pProvider);
+    OpcUa_ReferenceParameter(a_pCertificate);
+    OpcUa_ReferenceParameter(a_pCertificateStore);
+    *a_pValidationCode = X509_V_OK;
+    return OpcUa_Good;
+}
+
+static OpcUa_StatusCode UaTest_Https_OnSecureChannelEvent(  OpcUa_UInt32                            a_uSecureChannelId,
+                                                            OpcUa_SecureListener_SecureChannelEvent a_eEvent,
+                                                            OpcUa_StatusCode                        a_uStatus,
+                                                            OpcUa_ByteString*                       a_pbsClientCertificate,
+                                                            OpcUa_String*                           a_sSecurityPolicy,
+                                                            OpcUa_UInt16                            a_uMessageSecurityModes,
+                                                            OpcUa_Void*                             a_pCallbackData)
+{
+    OpcUa_ReferenceParameter(a_uSecureChannelId);
+    OpcUa_ReferenceParameter(a_eEvent);
+    OpcUa_ReferenceParameter(a_uStatus);
+    OpcUa_ReferenceParameter(a_pbsClientCertificate);
+    OpcUa_ReferenceParameter(a_sSecurityPolicy);
+    OpcUa_ReferenceParameter(a_uMessageSecurityModes);
+    OpcUa_ReferenceParameter(a_pCallbackData);
+    return OpcUa_Good;
+}
+
+/*============================================================================
+ * UaTest_Https_OnNotify
+ *===========================================================================*/
+/* reads the request number from the body and parks the response stream under it */
+static OpcUa_StatusCode UaTest_Https_OnNotify(  OpcUa_Listener*         a_pListener,
+                                                OpcUa_Void*             a_pCallbackData,
+                                                OpcUa_ListenerEvent     a_eEvent,
+                                                OpcUa_Handle            a_hConnection,
+                                                OpcUa_InputStream**     a_ppInputStream,
+                                                OpcUa_StatusCode        a_uOperationStatus)
+{
+    UaTest_Https*       pHttps      = (UaTest_Https*)a_pCallbackData;
+    OpcUa_OutputStream* pResponse   = OpcUa_Null;
+    OpcUa_StatusCode    uReadStatus = OpcUa_Good;
+    OpcUa_CharA         sBody[32];
+    OpcUa_UInt32        uLength     = sizeof(sBody) - 1;
+    unsigned int        uRequest    = 0;
+
+    OpcUa_ReferenceParameter(a_uOperationStatus);
+
+    if(a_eEvent != OpcUa_ListenerEvent_Request)
+    {
+        return OpcUa_Good;
+    }
+
+    /* the body is shorter than the buffer, so the read ends with the stream */
+    OpcUa_MemSet(sBody, 0, sizeof(sBody));
+    uReadStatus = OpcUa_Stream_Read(*a_ppInputStream, (OpcUa_Byte*)sBody, &uLength);
+    if(     (OpcUa_IsBad(uReadStatus) && uReadStatus != OpcUa_BadEndOfStream)
+        ||  sscanf(sBody, "request %u", &uRequest) != 1
+        ||  uRequest != OpcUa_Atomic_Load32(&pHttps->uNoOfDispatched)
+        ||  uRequest >= UATEST_HTTPS_MAXREQUESTS)
+    {
+        OpcUa_Atomic_Add32(&pHttps->uNoOfBadRequests, 1);
+    }
+
+    if(OpcUa_IsBad(OpcUa_Listener_BeginSendResponse(a_pListener, a_hConnection, a_ppInputStream, &pResponse)))
+    {
+        OpcUa_Atomic_Add32(&pHttps->uNoOfBadRequests, 1);
+        return OpcUa_BadInternalError;
+    }
+
+    if(uRequest >= UATEST_HTTPS_MAXREQUESTS)
+    {
+        OpcUa_Listener_EndSendResponse(a_pListener, OpcUa_BadInvalidArgument, &pResponse);
+        return OpcUa_BadInvalidArgument;
+    }
+
+    pHttps->apResponses[uRequest] = pResponse;
+    OpcUa_Atomic_Add32(&pHttps->uNoOfDispatched, 1);
+
+    return OpcUa_Good;
+}
+
+/*============================================================================
+ * UaTest_Https_WaitForDispatched
+ *===========================================================================*/
+/* OpcUa_True once exactly a_uNoOfDispatched requests are dispatched and no more follow */
+static OpcUa_Boolean UaTest_Https_WaitForDispatched(OpcUa_UInt32 a_uNoOfDispatched)
+{
+    OpcUa_UInt32 uWaited = 0;
+
+    while(OpcUa_Atomic_Load32(&UaTest_g_Https.uNoOfDispatched) < a_uNoOfDispatched)
+    {
+        if(uWaited >= UATEST_HTTPS_TIMEOUT)
+        {
+            return OpcUa_False;
+        }
+        OpcUa_Thread_Sleep(10);
+        uWaited += 10;
+    }
+
+    OpcUa_Thread_Sleep(UATEST_HTTPS_SETTLETIME);
+    return (OpcUa_Boolean)(OpcUa_Atomic_Load32(&UaTest_g_Https.uNoOfDispatched) == a_uNoOfDispatched);
+}
+
+/*============================================================================
+ * UaTest_Https_Answer
+ *===========================================================================*/
+/* answers the dispatched requests from the last to the first */
+static OpcUa_StatusCode UaTest_Https_Answer(OpcUa_UInt32 a_uFirst,
+                                            OpcUa_UInt32 a_uEnd)
+{
+    OpcUa_CharA     sBody[32];
+    OpcUa_UInt32    uRequest    = a_uEnd;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Https_Answer");
+
+    while(uRequest > a_uFirst)
+    {
+        uRequest--;
+        OpcUa_SnPrintfA(sBody, sizeof(sBody), "response %u", (unsigned int)uRequest);
+        uStatus = OpcUa_Stream_Write(UaTest_g_Https.apResponses[uRequest], (OpcUa_Byte*)sBody, (OpcUa_UInt32)strlen(sBody));
+        OpcUa_GotoErrorIfBad(uStatus);
+        uStatus = OpcUa_Listener_EndSendResponse(UaTest_g_Https.pListener, OpcUa_Good, &UaTest_g_Https.apResponses[uRequest]);
+        UaTest_g_Https.apResponses[uRequest] = OpcUa_Null;
+        OpcUa_GotoErrorIfBad(uStatus);
+        UaTest_g_Https.uNoOfAnswered++;
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Https_ReadResponse
+ *===========================================================================*/
+/* OpcUa_False if the connection closes before a complete response arrived */
+static OpcUa_Boolean UaTest_Https_ReadResponse(UaTest_Https_Response* a_pResponse)
+{
+    UaTest_Https*   pHttps      = &UaTest_g_Https;
+    char*           pHeaderEnd  = OpcUa_Null;
+    char*           pLength     = OpcUa_Null;
+    char*           pKeepAlive  = OpcUa_Null;
+    int             iRead       = 0;
+    int             iHeader     = 0;
+    int             iBody       = 0;
+
+    OpcUa_MemSet(a_pResponse, 0, sizeof(UaTest_Https_Response));
+
+    for(;;)
+    {
+        pHttps->sReceived[pHttps->iReceived] = '\0';
+        pHeaderEnd = strstr(pHttps->sReceived, "\r\n\r\n");
+        pLength = strstr(pHttps->sReceived, "Content-Length: ");
+        if(pHeaderEnd != OpcUa_Null && pLength != OpcUa_Null && pLength < pHeaderEnd)
+        {
+            iHeader = (int)(pHeaderEnd - pHttps->sReceived) + 4;
+            iBody = atoi(pLength + 16);
+            if(pHttps->iReceived >= iHeader + iBody)
+            {
+                break;
+            }
+        }
+
+        if(pHttps->iReceived >= (int)sizeof(pHttps->sReceived) - 1)
+        {
+            return OpcUa_False;
+        }
+        iRead = BIO_read(pHttps->pClient, pHttps->sReceived + pHttps->iReceived, (int)sizeof(pHttps->sReceived) - 1 - pHttps->iReceived);
+        if(iRead <= 0)
+        {
+            return OpcUa_False;
+        }
+        pHttps->iReceived += iRead;
+    }
+
+    if(sscanf(pHttps->sReceived, "HTTP/1.1 %u", &a_pResponse->uStatus) != 1)
+    {
+        return OpcUa_False;
+    }
+    pKeepAlive = strstr(pHttps->sReceived, "Connection: keep-alive\r\n");
+    a_pResponse->bKeepAlive = (OpcUa_Boolean)(pKeepAlive != OpcUa_Null && pKeepAlive < pHeaderEnd);
+    if(iBody < (int)sizeof(a_pResponse->sBody))
+    {
+        memcpy(a_pResponse->sBody, pHttps->sReceived + iHeader, (size_t)iBody);
+    }
+
+    pHttps->iReceived -= iHeader + iBody;
+    memmove(pHttps->sReceived, pHttps->sReceived + iHeader + iBody, (size_t)pHttps->iReceived);
+
+    return OpcUa_True;
+}
+
+/*============================================================================
+ * UaTest_Https_ReadResponses
+ *===========================================================================*/
+/* OpcUa_True if the client receives the responses to its a_uNoOfRequests requests in order */
+static OpcUa_Boolean UaTest_Https_ReadResponses(OpcUa_UInt32 a_uNoOfRequests)
+{
+    UaTest_Https_Response   Response;
+    char                    sExpected[32];
+    OpcUa_UInt32            uResponse   = 0;
+
+    for(uResponse = 0; uResponse < a_uNoOfRequests; uResponse++)
+    {
+        if(UaTest_Https_ReadResponse(&Response) == OpcUa_False || Response.uStatus != 200)
+        {
+            return OpcUa_False;
+        }
+        OpcUa_SnPrintfA(sExpected, sizeof(sExpected), "response %u", (unsigned int)uResponse);
+        if(strcmp(Response.sBody, sExpected) != 0)
+        {
+            return OpcUa_False;
+        }
+    }
+
+    /* nothing follows the last response */
+    return (OpcUa_Boolean)(UaTest_g_Https.iReceived == 0);
+}
+
+/*============================================================================
+ * UaTest_Https_Clear
+ *===========================================================================*/
+/* abandons the parked responses, closes the connection and the listener */
+static OpcUa_Void UaTest_Https_Clear(OpcUa_Void)
+{
+    OpcUa_UInt32 i = 0;
+
+    if(UaTest_g_Https.pClient != OpcUa_Null)
+    {
+        BIO_free_all(UaTest_g_Https.pClient);
+    }
+    if(UaTest_g_Https.pSslContext != OpcUa_Null)
+    {
+        SSL_CTX_free(UaTest_g_Https.pSslContext);
+    }
+    for(i = 0; i < UATEST_HTTPS_MAXREQUESTS; i++)
+    {
+        if(UaTest_g_Https.apResponses[i] != OpcUa_Null)
+        {
+            OpcUa_Listener_EndSendResponse(UaTest_g_Https.pListener, OpcUa_BadShutdown, &UaTest_g_Https.apResponses[i]);
+        }
+    }
+    if(UaTest_g_Https.pListener != OpcUa_Null)
+    {
+        OpcUa_Listener_Close(UaTest_g_Https.pListener);
+        OpcUa_Listener_Delete(&UaTest_g_Https.pListener);
+    }
+    if(UaTest_g_Https.pCertificate != OpcUa_Null)
+    {
+        X509_free(UaTest_g_Https.pCertificate);
+    }
+    if(UaTest_g_Https.pKey != OpcUa_Null)
+    {
+        EVP_PKEY_free(UaTest_g_Https.pKey);
+    }
+    OpcUa_ByteString_Clear(&UaTest_g_Https.Certificate);
+    OpcUa_Key_Clear(&UaTest_g_Https.Key);
+    OpcUa_MemSet(&UaTest_g_Https, 0, sizeof(UaTest_g_Https));
+}
+
+/*============================================================================
+ * UaTest_Https_Open
+ *===========================================================================*/
+/* a listener with a self-signed credential and a client connected to it */
+static OpcUa_StatusCode UaTest_Https_Open(OpcUa_Void)
+{
+    UaTest_Https*   pHttps          = &UaTest_g_Https;
+    OpcUa_String    sUrl;
+    OpcUa_CharA     sUrlBuffer[64];
+    OpcUa_UInt32    i               = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Https_Open");
+
+    OpcUa_MemSet(pHttps, 0, sizeof(UaTest_Https));
+    OpcUa_String_Initialize(&sUrl);
+
+    uStatus = UaTest_Https_CreateCredentials(&pHttps->pCertificate, &pHttps->pKey, &pHttps->Certificate, &pHttps->Key);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    pHttps->PkiOverride.OpenCertificateStore    = UaTest_Https_OpenCertificateStore;
+    pHttps->PkiOverride.CloseCertificateStore   = UaTest_Https_CloseCertificateStore;
+    pHttps->PkiOverride.ValidateCertificate     = UaTest_Https_ValidateCertificate;
+    pHttps->PkiConfig.PkiType                   = OpcUa_Override;
+    pHttps->PkiConfig.Override                  = &pHttps->PkiOverride;
+
+    uStatus = OpcUa_HttpsListener_Create(   &pHttps->Certificate,
+                                            &pHttps->Key,
+                                            &pHttps->PkiConfig,
+                                            UaTest_Https_OnSecureChannelEvent,
+                                            OpcUa_Null,
+                                            &pHttps->pListener);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* a port another process holds does not fail the test */
+    for(i = 0; i < UATEST_HTTPS_NOOFPORTS; i++)
+    {
+        OpcUa_SnPrintfA(pHttps->sHost, sizeof(pHttps->sHost), "localhost:%u", (unsigned int)(UATEST_HTTPS_PORT + i));
+        OpcUa_SnPrintfA(sUrlBuffer, sizeof(sUrlBuffer), "https://%s", pHttps->sHost);
+        OpcUa_String_Clear(&sUrl);
+        OpcUa_String_AttachReadOnly(&sUrl, sUrlBuffer);
+        uStatus = OpcUa_Listener_Open(pHttps->pListener, &sUrl, OpcUa_False, UaTest_Https_OnNotify, pHttps);
+        if(OpcUa_IsGood(uStatus))
+        {
+            break;
+        }
+    }
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* the listener asks for a client certificate */
+    pHttps->pSslContext = SSL_CTX_new(SSLv23_client_method());
+    OpcUa_GotoErrorIfAllocFailed(pHttps->pSslContext);
+    OpcUa_GotoErrorIfTrue(SSL_CTX_use_certificate(pHttps->pSslContext, pHttps->pCertificate) <= 0, OpcUa_BadInternalError);
+    OpcUa_GotoErrorIfTrue(SSL_CTX_use_PrivateKey(pHttps->pSslContext, pHttps->pKey) <= 0, OpcUa_BadInternalError);
+    SSL_CTX_set_verify(pHttps->pSslContext, SSL_VERIFY_NONE, OpcUa_Null);
+
+    pHttps->pClient = BIO_new_ssl_connect(pHttps->pSslContext);
+    OpcUa_GotoErrorIfAllocFailed(pHttps->pClient);
+    BIO_set_conn_hostname(pHttps->pClient, pHttps->sHost);
+    OpcUa_GotoErrorIfTrue(BIO_do_connect(pHttps->pClient) <= 0, OpcUa_BadConnectionRejected);
+
+    OpcUa_String_Clear(&sUrl);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_String_Clear(&sUrl);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Https_AppendRequest
+ *===========================================================================*/
+/* appends a request with the given method and extra headers; returns the new length */
+static int UaTest_Https_AppendRequest(  char*           a_sRequests,
+                                        int             a_iUsed,
+                                        int             a_iSize,
+                                        const char*     a_sMethod,
+                                        const char*     a_sHeaders,
+                                        OpcUa_UInt32    a_uRequest)
+{
+    char sBody[32];
+
+    OpcUa_SnPrintfA(sBody, sizeof(sBody), "request %u", (unsigned int)a_uRequest);
+    return a_iUsed + OpcUa_SnPrintfA(   a_sRequests + a_iUsed,
+                                        (OpcUa_UInt32)(a_iSize - a_iUsed),
+                                        "%s / HTTP/1.1\r\n"
+                                        "Host: %s\r\n"
+                                        "%s"
+                                        "Content-Type: application/octet-stream\r\n"
+                                        "Content-Length: %u\r\n"
+                                        "\r\n"
+                                        "%s",
+                                        a_sMethod,
+                                        UaTest_g_Https.sHost,
+                                        a_sHeaders,
+                                        (unsigned int)strlen(sBody),
+                                        sBody);
+}
+
+/*============================================================================
+ * UaTest_Https_Pipeline
+ *===========================================================================*/
+/* sends a_uNoOfRequests requests in one go and answers each dispatched batch in reverse */
+static OpcUa_StatusCode UaTest_Https_Pipeline(OpcUa_UInt32 a_uNoOfRequests)
+{
+    UaTest_Https*   pHttps          = &UaTest_g_Https;
+    char            sRequests[UATEST_HTTPS_MAXREQUESTS * 160];
+    OpcUa_UInt32    uDepth          = (OpcUa_UInt32)OpcUa_ProxyStub_g_Configuration.iHttpsTransport_MaxPipelinedRequests;
+    OpcUa_UInt32    uBatch          = 0;
+    OpcUa_UInt32    i               = 0;
+    int             iUsed           = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Https_Pipeline");
+
+    OpcUa_GotoErrorIfTrue(a_uNoOfRequests > UATEST_HTTPS_MAXREQUESTS, OpcUa_BadInvalidArgument);
+
+    uStatus = UaTest_Https_Open();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* all requests leave before the first response is written */
+    for(i = 0; i < a_uNoOfRequests; i++)
+    {
+        iUsed = UaTest_Https_AppendRequest(sRequests, iUsed, (int)sizeof(sRequests), "POST", "", i);
+    }
+    OpcUa_GotoErrorIfTrue(BIO_write(pHttps->pClient, sRequests, iUsed) != iUsed, OpcUa_BadCommunicationError);
+
+    /* the listener takes no more requests than the pipeline holds, until responses leave */
+    while(pHttps->uNoOfAnswered < a_uNoOfRequests)
+    {
+        uBatch = a_uNoOfRequests - pHttps->uNoOfAnswered;
+        if(uBatch > uDepth)
+        {
+            uBatch = uDepth;
+        }
+        UATEST_CHECK(UaTest_Https_WaitForDispatched(pHttps->uNoOfAnswered + uBatch) != OpcUa_False);
+        uStatus = UaTest_Https_Answer(pHttps->uNoOfAnswered, pHttps->uNoOfAnswered + uBatch);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+    UATEST_CHECK(UaTest_Https_ReadResponses(a_uNoOfRequests) != OpcUa_False);
+    UATEST_CHECK(pHttps->uNoOfBadRequests == 0);
+
+    UaTest_Https_Clear();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_Https_Clear();
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Https_InOrder
+ *===========================================================================*/
+/* responses finished last to first still leave in request order */
+static OpcUa_StatusCode UaTest_Https_InOrder(OpcUa_Void)
+{
+    return UaTest_Https_Pipeline(4);
+}
+
+/*============================================================================
+ * UaTest_Https_PipelineDepth
+ *===========================================================================*/
+/* requests beyond the pipeline depth wait until responses leave */
+static OpcUa_StatusCode UaTest_Https_PipelineDepth(OpcUa_Void)
+{
+    return UaTest_Https_Pipeline((OpcUa_UInt32)OpcUa_ProxyStub_g_Configuration.iHttpsTransport_MaxPipelinedRequests + 3);
+}
+
+/*============================================================================
+ * UaTest_Https_PerRequest
+ *===========================================================================*/
+/* security policy and keep-alive of pipelined requests do not leak into each other */
+static OpcUa_StatusCode UaTest_Https_PerRequest(OpcUa_Void)
+{
+    UaTest_Https*                                       pHttps      = &UaTest_g_Https;
+    OpcUa_SecureListener_SecurityPolicyConfiguration    Policy;
+    UaTest_Https_Response                               Response;
+    char                                                sRequests[2 * 256];
+    int                                                 iUsed       = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Https_PerRequest");
+
+    uStatus = UaTest_Https_Open();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    iUsed = UaTest_Https_AppendRequest( sRequests, iUsed, (int)sizeof(sRequests), "POST",
+                                        "OPCUA-SecurityPolicy: " OpcUa_SecurityPolicy_Basic256Sha256 "\r\n"
+                                        "Connection: keep-alive\r\n",
+                                        0);
+    iUsed = UaTest_Https_AppendRequest(sRequests, iUsed, (int)sizeof(sRequests), "POST", "", 1);
+    OpcUa_GotoErrorIfTrue(BIO_write(pHttps->pClient, sRequests, iUsed) != iUsed, OpcUa_BadCommunicationError);
+
+    UATEST_CHECK(UaTest_Https_WaitForDispatched(2) != OpcUa_False);
+
+    /* the first request keeps its policy although the second one came in since */
+    OpcUa_MemSet(&Policy, 0, sizeof(Policy));
+    uStatus = OpcUa_HttpsListener_GetSecurityPolicyConfiguration(pHttps->pListener, pHttps->apResponses[0], &Policy);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(OpcUa_StrCmpA(OpcUa_String_GetRawString(&Policy.sSecurityPolicy), OpcUa_SecurityPolicy_Basic256Sha256) == 0);
+
+    OpcUa_MemSet(&Policy, 0, sizeof(Policy));
+    uStatus = OpcUa_HttpsListener_GetSecurityPolicyConfiguration(pHttps->pListener, pHttps->apResponses[1], &Policy);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(OpcUa_StrCmpA(OpcUa_String_GetRawString(&Policy.sSecurityPolicy), OpcUa_SecurityPolicy_None) == 0);
+
+    uStatus = UaTest_Https_Answer(0, 2);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* only the request which asked for it is answered with keep-alive */
+    UATEST_CHECK(UaTest_Https_ReadResponse(&Response) != OpcUa_False);
+    UATEST_CHECK(Response.uStatus == 200 && Response.bKeepAlive != OpcUa_False);
+    UATEST_CHECK(UaTest_Https_ReadResponse(&Response) != OpcUa_False);
+    UATEST_CHECK(Response.uStatus == 200 && Response.bKeepAlive == OpcUa_False);
+    UATEST_CHECK(pHttps->uNoOfBadRequests == 0);
+
+    UaTest_Https_Clear();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_Https_Clear();
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Https_Rejected
+ *===========================================================================*/
+/* a rejected request is answered after the requests before it; nothing behind it is read */
+static OpcUa_StatusCode UaTest_Https_Rejected(OpcUa_Void)
+{
+    UaTest_Https*           pHttps      = &UaTest_g_Https;
+    UaTest_Https_Response   Response;
+    char                    sRequests[3 * 256];
+    int                     iUsed       = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Https_Rejected");
+
+    uStatus = UaTest_Https_Open();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    iUsed = UaTest_Https_AppendRequest(sRequests, iUsed, (int)sizeof(sRequests), "POST", "", 0);
+    iUsed = UaTest_Https_AppendRequest(sRequests, iUsed, (int)sizeof(sRequests), "OPTIONS", "", 1);
+    iUsed = UaTest_Https_AppendRequest(sRequests, iUsed, (int)sizeof(sRequests), "POST", "", 2);
+    OpcUa_GotoErrorIfTrue(BIO_write(pHttps->pClient, sRequests, iUsed) != iUsed, OpcUa_BadCommunicationError);
+
+    UATEST_CHECK(UaTest_Https_WaitForDispatched(1) != OpcUa_False);
+
+    uStatus = UaTest_Https_Answer(0, 1);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    UATEST_CHECK(UaTest_Https_ReadResponse(&Response) != OpcUa_False);
+    UATEST_CHECK(Response.uStatus == 200 && strcmp(Response.sBody, "response 0") == 0);
+    UATEST_CHECK(UaTest_Https_ReadResponse(&Response) != OpcUa_False);
+    UATEST_CHECK(Response.uStatus == 405); /* Method Not Allowed */
+
+    /* then the listener closes the connection */
+    UATEST_CHECK(UaTest_Https_ReadResponse(&Response) == OpcUa_False);
+    UATEST_CHECK(OpcUa_Atomic_Load32(&pHttps->uNoOfDispatched) == 1);
+    UATEST_CHECK(pHttps->uNoOfBadRequests == 0);
+
+    UaTest_Https_Clear();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_Https_Clear();
+
+OpcUa_FinishErrorHandling;
+}
+
+#endif /* OPCUA_HAVE_HTTPS */
+
+/*============================================================================
+ * Case table
+ *===========================================================================*/
+UaTest_Case UaTest_g_HttpsCases[] =
+{
+#ifdef OPCUA_HAVE_HTTPS
+    { "stack/https/pipeline/inorder",       UaTest_Https_InOrder },
+    { "stack/https/pipeline/depth",         UaTest_Https_PipelineDepth },
+    { "stack/https/pipeline/perrequest",    UaTest_Https_PerRequest },
+    { "stack/https/pipeline/rejected",      UaTest_Https_Rejected },
+#endif /* OPCUA_HAVE_HTTPS */
+    UATEST_CASE_END
+};
+
@@ -0,0 +1,462 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+
+/******************************************************************************************************/
+/* Tests for the HTTPS message parser: lines split across reads and buffers, stray carriage returns, */
+/* overlong lines and out of range lengths.                                                          */
+/******************************************************************************************************/
+
+#include <opcua.h>
+#include <opcua_string.h>
+
+#include "uatest.h"
+
+#ifdef OPCUA_HAVE_HTTPS
+
+#include <opcua_httpsstream.h>
+#include <opcua_p_internal.h>
+#include <opcua_p_socket.h>
+#include <opcua_p_socket_internal.h>
+
+#include <stdio.h>
+#include <string.h>
+
+/*============================================================================
+ * Types and constants
+ *===========================================================================*/
+/** @brief Room for a message which fills more than one receive buffer. */
+#define UATEST_HTTPSSTREAM_MAXMESSAGE   (2 * OPCUA_HTTPS_MAX_RECV_BUFFER_LENGTH)
+
+/** @brief Start of every request; the headers of the case follow. */
+#define UATEST_HTTPSSTREAM_REQUESTLINE  "POST /uatest HTTP/1.1\r\n"
+
+/**
+ * @brief A socket which hands out the released part of a message, one read at a time.
+ */
+typedef struct _UaTest_HttpsStreamSocket
+{
+    /** @brief The platform layer calls through this table; it must come first. */
+    OpcUa_SocketServiceTable*   pSocketServiceTable;
+    OpcUa_UInt32                uReleased;
+    OpcUa_UInt32                uRead;
+} UaTest_HttpsStreamSocket;
+
+/*============================================================================
+ * Globals
+ *===========================================================================*/
+static OpcUa_CharA              UaTest_g_sHttpsMessage[UATEST_HTTPSSTREAM_MAXMESSAGE];
+static UaTest_HttpsStreamSocket UaTest_g_HttpsStreamSocket;
+
+/*============================================================================
+ * UaTest_HttpsStream_SocketRead
+ *===========================================================================*/
+static OpcUa_StatusCode UaTest_HttpsStream_SocketRead(  OpcUa_Socket    a_hSocket,
+                                                        OpcUa_Byte*     a_pBuffer,
+                                                        OpcUa_UInt32    a_uBufferSize,
+                                                        OpcUa_UInt32*   a_puBytesRead)
+{
+    UaTest_HttpsStreamSocket*   pSocket = (UaTest_HttpsStreamSocket*)a_hSocket;
+    OpcUa_UInt32                uLength = pSocket->uReleased - pSocket->uRead;
+
+    if(uLength == 0)
+    {
+        *a_puBytesRead = 0;
+        return OpcUa_BadWouldBlock;
+    }
+
+    if(uLength > a_uBufferSize)
+    {
+        uLength = a_uBufferSize;
+    }
+
+    memcpy(a_pBuffer, &UaTest_g_sHttpsMessage[pSocket->uRead], uLength);
+    pSocket->uRead += uLength;
+    *a_puBytesRead = uLength;
+    return OpcUa_Good;
+}
+
+static OpcUa_SocketServiceTable UaTest_g_HttpsStreamSocketServiceTable =
+{
+    UaTest_HttpsStream_SocketRead,
+    OpcUa_Null,
+    OpcUa_Null,
+    OpcUa_Null,
+    OpcUa_Null,
+    OpcUa_Null
+};
+
+/*============================================================================
+ * UaTest_HttpsStream_Create
+ *===========================================================================*/
+/* an input stream for a request on the scripted socket; the message is set up by the caller */
+static OpcUa_StatusCode UaTest_HttpsStream_Create(OpcUa_InputStream** a_ppInputStream)
+{
+    UaTest_g_HttpsStreamSocket.pSocketServiceTable = &UaTest_g_HttpsStreamSocketServiceTable;
+    UaTest_g_HttpsStreamSocket.uReleased           = 0;
+    UaTest_g_HttpsStreamSocket.uRead               = 0;
+
+    return OpcUa_HttpsStream_CreateInput(   (OpcUa_Socket)&UaTest_g_HttpsStreamSocket,
+                                            OpcUa_HttpsStream_MessageType_Request,
+                                            a_ppInputStream);
+}
+
+/*============================================================================
+ * UaTest_HttpsStream_Feed
+ *===========================================================================*/
+/* releases the next a_uLength bytes of the message and lets the stream parse them */
+static OpcUa_StatusCode UaTest_HttpsStream_Feed(OpcUa_InputStream*  a_pInputStream,
+                                                OpcUa_UInt32        a_uLength)
+{
+    UaTest_g_HttpsStreamSocket.uReleased += a_uLength;
+    return OpcUa_HttpsStream_DataReady(a_pInputStream);
+}
+
+/*============================================================================
+ * UaTest_HttpsStream_Parse
+ *===========================================================================*/
+/* parses the request in UaTest_g_sHttpsMessage at once and returns the result */
+static OpcUa_StatusCode UaTest_HttpsStream_Parse(OpcUa_Void)
+{
+    OpcUa_InputStream*  pInputStream    = OpcUa_Null;
+    OpcUa_StatusCode    uResult         = OpcUa_Good;
+
+    uResult = UaTest_HttpsStream_Create(&pInputStream);
+    if(OpcUa_IsGood(uResult))
+    {
+        uResult = UaTest_HttpsStream_Feed(pInputStream, (OpcUa_UInt32)strlen(UaTest_g_sHttpsMessage));
+        OpcUa_HttpsStream_Delete((OpcUa_Stream**)&pInputStream);
+    }
+
+    return uResult;
+}
+
+/*============================================================================
+ * UaTest_HttpsStream_HasHeader
+ *===========================================================================*/
+static OpcUa_Boolean UaTest_HttpsStream_HasHeader(  OpcUa_InputStream*  a_pInputStream,
+                                                    const OpcUa_CharA*  a_sName,
+                                                    const OpcUa_CharA*  a_sValue)
+{
+    OpcUa_String    sName       = OPCUA_STRING_STATICINITIALIZER;
+    OpcUa_String    sValue      = OPCUA_STRING_STATICINITIALIZER;
+    OpcUa_Boolean   bResult     = OpcUa_False;
+
+    OpcUa_String_AttachReadOnly(&sName, (OpcUa_StringA)a_sName);
+
+    if(OpcUa_IsGood(OpcUa_HttpsStream_GetHeader((OpcUa_Stream*)a_pInputStream, &sName, OpcUa_True, &sValue)))
+    {
+        bResult = (OpcUa_Boolean)(     OpcUa_String_StrSize(&sValue) == strlen(a_sValue)
+                                   &&  memcmp(OpcUa_String_GetRawString(&sValue), a_sValue, strlen(a_sValue)) == 0);
+    }
+
+    OpcUa_String_Clear(&sValue);
+    OpcUa_String_Clear(&sName);
+    return bResult;
+}
+
+/*============================================================================
+ * UaTest_HttpsStream_SplitLine
+ *===========================================================================*/
+/* lines cut anywhere by the reads, even between CR and LF, are joined */
+static OpcUa_StatusCode UaTest_HttpsStream_SplitLine(OpcUa_Void)
+{
+    static const OpcUa_CharA*   asParts[]       = { UATEST_HTTPSSTREAM_REQUESTLINE "X-Ua",
+                                                    "Test: split\r",
+                                                    "\n",
+                                                    "Content-Length: 5\r\n\r\nhel",
+                                                    "lo" };
+    OpcUa_InputStream*          pInputStream    = OpcUa_Null;
+    OpcUa_Byte                  Body[5];
+    OpcUa_UInt32                uLength         = 0;
+    OpcUa_UInt32                i               = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "HttpsStream_SplitLine");
+
+    UaTest_g_sHttpsMessage[0] = '\0';
+    for(i = 0; i < sizeof(asParts) / sizeof(asParts[0]); i++)
+    {
+        strcat(UaTest_g_sHttpsMessage, asParts[i]);
+    }
+
+    uStatus = UaTest_HttpsStream_Create(&pInputStream);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    for(i = 0; i < sizeof(asParts) / sizeof(asParts[0]); i++)
+    {
+        uStatus = UaTest_HttpsStream_Feed(pInputStream, (OpcUa_UInt32)strlen(asParts[i]));
+        UATEST_CHECK(uStatus == ((i + 1 < sizeof(asParts) / sizeof(asParts[0]))? OpcUa_GoodCallAgain: OpcUa_Good));
+    }
+
+    UATEST_CHECK(UaTest_HttpsStream_HasHeader(pInputStream, "X-UaTest", "split"));
+
+    uLength = sizeof(Body);
+    uStatus = pInputStream->Read(pInputStream, Body, &uLength);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(uLength == sizeof(Body) && memcmp(Body, "hello", sizeof(Body)) == 0);
+
+    OpcUa_HttpsStream_Delete((OpcUa_Stream**)&pInputStream);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_HttpsStream_Delete((OpcUa_Stream**)&pInputStream);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_HttpsStream_SplitBuffers
+ *===========================================================================*/
+/* a chunk size line whose digits start in the first receive buffer and end in the second one */
+static OpcUa_StatusCode UaTest_HttpsStream_SplitBuffers(OpcUa_Void)
+{
+    static const OpcUa_CharA    sHeaders[]      = UATEST_HTTPSSTREAM_REQUESTLINE "Transfer-Encoding: chunked\r\n\r\n";
+    static const OpcUa_CharA    sSecondChunk[]  = "00005;x=y\r\nhello\r\n0\r\n\r\n";
+    OpcUa_InputStream*          pInputStream    = OpcUa_Null;
+    OpcUa_Byte*                 pBody           = OpcUa_Null;
+    OpcUa_UInt32                uFirstChunk     = 0;
+    OpcUa_UInt32                uLength         = 0;
+    OpcUa_UInt32                i               = 0;
+    int                         iPos            = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "HttpsStream_SplitBuffers");
+
+    /* headers, a four digit size line, the data and its CRLF end three bytes before the buffer does */
+    uFirstChunk = OPCUA_HTTPS_MAX_RECV_BUFFER_LENGTH - 3 - (OpcUa_UInt32)strlen(sHeaders) - 6 - 2;
+    UATEST_CHECK(uFirstChunk >= 0x1000 && uFirstChunk <= 0xFFFF);
+
+    iPos = sprintf(UaTest_g_sHttpsMessage, "%s%04x\r\n", sHeaders, uFirstChunk);
+    for(i = 0; i < uFirstChunk; i++)
+    {
+        UaTest_g_sHttpsMessage[iPos++] = (OpcUa_CharA)('a' + i % 26);
+    }
+    sprintf(&UaTest_g_sHttpsMessage[iPos], "\r\n%s", sSecondChunk);
+    UATEST_CHECK(iPos + 2 == OPCUA_HTTPS_MAX_RECV_BUFFER_LENGTH - 3);
+
+    uStatus = UaTest_HttpsStream_Create(&pInputStream);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = UaTest_HttpsStream_Feed(pInputStream, (OpcUa_UInt32)strlen(UaTest_g_sHttpsMessage));
+    UATEST_CHECK(uStatus == OpcUa_Good);
+
+    pBody = (OpcUa_Byte*)OpcUa_Alloc(uFirstChunk + 5);
+    OpcUa_GotoErrorIfAllocFailed(pBody);
+
+    uLength = uFirstChunk + 5;
+    uStatus = pInputStream->Read(pInputStream, pBody, &uLength);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(uLength == uFirstChunk + 5);
+    for(i = 0; i < uFirstChunk; i++)
+    {
+        UATEST_CHECK(pBody[i] == (OpcUa_Byte)('a' + i % 26));
+    }
+    UATEST_CHECK(memcmp(&pBody[uFirstChunk], "hello", 5) == 0);
+
+    OpcUa_Free(pBody);
+    OpcUa_HttpsStream_Delete((OpcUa_Stream**)&pInputStream);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    if(pBody != OpcUa_Null)
+    {
+        OpcUa_Free(pBody);
+    }
+    OpcUa_HttpsStream_Delete((OpcUa_Stream**)&pInputStream);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_HttpsStream_BareCr
+ *===========================================================================*/
+/* a carriage return only ends a line together with the line feed */
+static OpcUa_StatusCode UaTest_HttpsStream_BareCr(OpcUa_Void)
+{
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "HttpsStream_BareCr");
+
+    strcpy(UaTest_g_sHttpsMessage, UATEST_HTTPSSTREAM_REQUESTLINE "X-UaTest: a\rb\r\nContent-Length: 1\r\n\r\nx");
+    UATEST_CHECK(UaTest_HttpsStream_Parse() == OpcUa_BadDecodingError);
+
+    strcpy(UaTest_g_sHttpsMessage, UATEST_HTTPSSTREAM_REQUESTLINE "X-UaTest: a\r\rContent-Length: 1\r\n\r\nx");
+    UATEST_CHECK(UaTest_HttpsStream_Parse() == OpcUa_BadDecodingError);
+
+    /* neither is a line feed alone */
+    strcpy(UaTest_g_sHttpsMessage, UATEST_HTTPSSTREAM_REQUESTLINE "X-UaTest: a\nContent-Length: 1\r\n\r\nx");
+    UATEST_CHECK(UaTest_HttpsStream_Parse() == OpcUa_BadDecodingError);
+
+    strcpy(UaTest_g_sHttpsMessage, UATEST_HTTPSSTREAM_REQUESTLINE "X-UaTest: a\r\nContent-Length: 1\r\n\r\nx");
+    UATEST_CHECK(UaTest_HttpsStream_Parse() == OpcUa_Good);
+
+    uStatus = OpcUa_Good;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_HttpsStream_RequestLine
+ *===========================================================================*/
+/* the version ends the request line; a prefix or a longer token is no version */
+static OpcUa_StatusCode UaTest_HttpsStream_RequestLine(OpcUa_Void)
+{
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "HttpsStream_RequestLine");
+
+    strcpy(UaTest_g_sHttpsMessage, "POST /uatest HTTP/1\r\nContent-Length: 1\r\n\r\nx");
+    UATEST_CHECK(UaTest_HttpsStream_Parse() == OpcUa_BadInvalidArgument);
+
+    strcpy(UaTest_g_sHttpsMessage, "POST /uatest HTTP/1.1x\r\nContent-Length: 1\r\n\r\nx");
+    UATEST_CHECK(UaTest_HttpsStream_Parse() == OpcUa_BadInvalidArgument);
+
+    uStatus = OpcUa_Good;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_HttpsStream_SetHeaderLine
+ *===========================================================================*/
+/* a request with one header line of a_uLineLength characters including CRLF */
+static OpcUa_Void UaTest_HttpsStream_SetHeaderLine(OpcUa_UInt32 a_uLineLength)
+{
+    int iPos = sprintf(UaTest_g_sHttpsMessage, "%sX-UaTest: ", UATEST_HTTPSSTREAM_REQUESTLINE);
+    int iEnd = iPos + (int)a_uLineLength - (int)sizeof("X-UaTest: \r\n") + 1;
+
+    while(iPos < iEnd)
+    {
+        UaTest_g_sHttpsMessage[iPos++] = 'v';
+    }
+    strcpy(&UaTest_g_sHttpsMessage[iPos], "\r\nContent-Length: 1\r\n\r\nx");
+}
+
+/*============================================================================
+ * UaTest_HttpsStream_LongLine
+ *===========================================================================*/
+/* lines up to OPCUA_HTTPS_MAX_RECV_HEADER_LINE_LENGTH are accepted, longer ones before their end arrives */
+static OpcUa_StatusCode UaTest_HttpsStream_LongLine(OpcUa_Void)
+{
+    OpcUa_InputStream*  pInputStream    = OpcUa_Null;
+    OpcUa_UInt32        uRequestLine    = (OpcUa_UInt32)strlen(UATEST_HTTPSSTREAM_REQUESTLINE);
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "HttpsStream_LongLine");
+
+    UaTest_HttpsStream_SetHeaderLine(OPCUA_HTTPS_MAX_RECV_HEADER_LINE_LENGTH);
+    UATEST_CHECK(UaTest_HttpsStream_Parse() == OpcUa_Good);
+
+    UaTest_HttpsStream_SetHeaderLine(OPCUA_HTTPS_MAX_RECV_HEADER_LINE_LENGTH + 1);
+    UATEST_CHECK(UaTest_HttpsStream_Parse() == OpcUa_BadDecodingError);
+
+    /* an unterminated line is rejected as soon as it is too long */
+    uStatus = UaTest_HttpsStream_Create(&pInputStream);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = UaTest_HttpsStream_Feed(pInputStream, uRequestLine + OPCUA_HTTPS_MAX_RECV_HEADER_LINE_LENGTH - 1);
+    UATEST_CHECK(uStatus == OpcUa_GoodCallAgain);
+    uStatus = UaTest_HttpsStream_Feed(pInputStream, 1);
+    UATEST_CHECK(uStatus == OpcUa_BadDecodingError);
+
+    OpcUa_HttpsStream_Delete((OpcUa_Stream**)&pInputStream);
+    uStatus = OpcUa_Good;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_HttpsStream_Delete((OpcUa_Stream**)&pInputStream);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_HttpsStream_ContentLength
+ *===========================================================================*/
+/* lengths beyond the message limit or the 32 bit range are invalid, not wrapped */
+static OpcUa_StatusCode UaTest_HttpsStream_ContentLength(OpcUa_Void)
+{
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "HttpsStream_ContentLength");
+
+    strcpy(UaTest_g_sHttpsMessage, UATEST_HTTPSSTREAM_REQUESTLINE "Content-Length: 4294967297\r\n\r\nx");
+    UATEST_CHECK(UaTest_HttpsStream_Parse() == OpcUa_BadRequestHeaderInvalid);
+
+    strcpy(UaTest_g_sHttpsMessage, UATEST_HTTPSSTREAM_REQUESTLINE "Content-Length: 99999999999999999999\r\n\r\nx");
+    UATEST_CHECK(UaTest_HttpsStream_Parse() == OpcUa_BadRequestHeaderInvalid);
+
+    sprintf(UaTest_g_sHttpsMessage, "%sContent-Length: %u\r\n\r\nx",
+            UATEST_HTTPSSTREAM_REQUESTLINE, (unsigned int)OPCUA_HTTPS_MAX_RECV_MESSAGE_LENGTH + 1);
+    UATEST_CHECK(UaTest_HttpsStream_Parse() == OpcUa_BadRequestHeaderInvalid);
+
+    strcpy(UaTest_g_sHttpsMessage, UATEST_HTTPSSTREAM_REQUESTLINE "Content-Length: 1x\r\n\r\nx");
+    UATEST_CHECK(UaTest_HttpsStream_Parse() == OpcUa_BadRequestHeaderInvalid);
+
+    strcpy(UaTest_g_sHttpsMessage, UATEST_HTTPSSTREAM_REQUESTLINE "content-length: 1 \r\n\r\nx");
+    UATEST_CHECK(UaTest_HttpsStream_Parse() == OpcUa_Good);
+
+    uStatus = OpcUa_Good;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_HttpsStream_ChunkSize
+ *===========================================================================*/
+/* chunk sizes beyond the message limit or the 32 bit range are invalid, not wrapped */
+static OpcUa_StatusCode UaTest_HttpsStream_ChunkSize(OpcUa_Void)
+{
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "HttpsStream_ChunkSize");
+
+    strcpy(UaTest_g_sHttpsMessage, UATEST_HTTPSSTREAM_REQUESTLINE "Transfer-Encoding: chunked\r\n\r\n100000001\r\nx\r\n0\r\n\r\n");
+    UATEST_CHECK(UaTest_HttpsStream_Parse() == OpcUa_BadRequestHeaderInvalid);
+
+    sprintf(UaTest_g_sHttpsMessage, "%sTransfer-Encoding: chunked\r\n\r\n%x\r\nx\r\n0\r\n\r\n",
+            UATEST_HTTPSSTREAM_REQUESTLINE, (unsigned int)OPCUA_HTTPS_MAX_RECV_MESSAGE_LENGTH + 1);
+    UATEST_CHECK(UaTest_HttpsStream_Parse() == OpcUa_BadRequestHeaderInvalid);
+
+    strcpy(UaTest_g_sHttpsMessage, UATEST_HTTPSSTREAM_REQUESTLINE "Transfer-Encoding: chunked\r\n\r\n1x\r\nx\r\n0\r\n\r\n");
+    UATEST_CHECK(UaTest_HttpsStream_Parse() == OpcUa_BadRequestHeaderInvalid);
+
+    strcpy(UaTest_g_sHttpsMessage, UATEST_HTTPSSTREAM_REQUESTLINE "Transfer-Encoding: chunked\r\n\r\n1;x=y\r\nx\r\n0\r\n\r\n");
+    UATEST_CHECK(UaTest_HttpsStream_Parse() == OpcUa_Good);
+
+    uStatus = OpcUa_Good;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+#endif /* OPCUA_HAVE_HTTPS */
+
+/*============================================================================
+ * Case table
+ *===========================================================================*/
+UaTest_Case UaTest_g_HttpsStreamCases[] =
+{
+#ifdef OPCUA_HAVE_HTTPS
+    { "stack/https/parser/splitline",       UaTest_HttpsStream_SplitLine },
+    { "stack/https/parser/splitbuffers",    UaTest_HttpsStream_SplitBuffers },
+    { "stack/https/parser/barecr",          UaTest_HttpsStream_BareCr },
+    { "stack/https/parser/requestline",     UaTest_HttpsStream_RequestLine },
+    { "stack/https/parser/longline",        UaTest_HttpsStream_LongLine },
+    { "stack/https/parser/contentlength",   UaTest_HttpsStream_ContentLength },
+    { "stack/https/parser/chunksize",       UaTest_HttpsStream_ChunkSize },
+#endif /* OPCUA_HAVE_HTTPS */
+    UATEST_CASE_END
+};
@@ -0,0 +1,209 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+/******************************************************************************************************/
+/* Tests for the latency statistics: histogram summaries and clearing while threads record.          */
+/******************************************************************************************************/
+
+#include <opcua.h>
+#include <opcua_thread.h>
+#include <opcua_latency.h>
+
+#include "uatest.h"
+
+#ifdef OPCUA_HAVE_LATENCYSTATISTICS
+
+/*============================================================================
+ * Types and constants
+ *===========================================================================*/
+/** @brief Elapsed time of the recorded samples in microseconds. */
+#define UATEST_LATENCY_ELAPSED      100000
+#define UATEST_LATENCY_SAMPLES      100
+/** @brief Request type id the service samples are recorded for. */
+#define UATEST_LATENCY_SERVICE      631
+#define UATEST_LATENCY_THREADS      4
+/** @brief Clears done while the threads record. */
+#define UATEST_LATENCY_CLEARS       50
+
+typedef struct _UaTest_LatencyThread
+{
+    OpcUa_Thread    hThread;
+    OpcUa_UInt32    uNoOfRecords;
+} UaTest_LatencyThread;
+
+/*============================================================================
+ * Globals
+ *===========================================================================*/
+static OpcUa_UInt32         UaTest_g_bLatencyStop = 0;
+
+/*============================================================================
+ * UaTest_Latency_Summary
+ *===========================================================================*/
+/* samples land in the stage and service histograms and are dropped by a reset */
+static OpcUa_StatusCode UaTest_Latency_Summary(OpcUa_Void)
+{
+    OpcUa_LatencySummary    Summary;
+    OpcUa_UInt32            auServiceTypeIds[4];
+    OpcUa_UInt32            uNoOfServiceTypeIds = 0;
+    OpcUa_UInt64            uPrevious           = 0;
+    OpcUa_UInt64            uNow                = 0;
+    OpcUa_UInt32            i                   = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Latency_Summary");
+
+    /* the clock never runs backwards */
+    uPrevious = OpcUa_Latency_Now();
+    for(i = 0; i < 1000; i++)
+    {
+        uNow = OpcUa_Latency_Now();
+        UATEST_CHECK(uNow >= uPrevious);
+        uPrevious = uNow;
+    }
+
+    for(i = 0; i < UATEST_LATENCY_SAMPLES; i++)
+    {
+        OpcUa_Latency_Record(OpcUa_LatencyStage_Service, UATEST_LATENCY_SERVICE, OpcUa_Latency_Now() - UATEST_LATENCY_ELAPSED);
+    }
+    OpcUa_Latency_Record(OpcUa_LatencyStage_Decode, 0, OpcUa_Latency_Now());
+
+    uStatus = OpcUa_Latency_GetSummary(OpcUa_LatencyStage_Service, 0, &Summary);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(Summary.Count == UATEST_LATENCY_SAMPLES);
+    UATEST_CHECK(Summary.Sum >= (OpcUa_UInt64)UATEST_LATENCY_SAMPLES * UATEST_LATENCY_ELAPSED);
+    /* the buckets are exact to 1/8 of the value */
+    UATEST_CHECK(Summary.P50 >= UATEST_LATENCY_ELAPSED && Summary.P50 < UATEST_LATENCY_ELAPSED + UATEST_LATENCY_ELAPSED / 4);
+    UATEST_CHECK(Summary.P50 <= Summary.P99 && Summary.P99 <= Summary.P999 && Summary.P999 <= Summary.Max);
+
+    uStatus = OpcUa_Latency_GetSummary(OpcUa_LatencyStage_Service, UATEST_LATENCY_SERVICE, &Summary);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(Summary.Count == UATEST_LATENCY_SAMPLES);
+
+    uStatus = OpcUa_Latency_GetSummary(OpcUa_LatencyStage_Decode, 0, &Summary);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(Summary.Count == 1);
+    UATEST_CHECK(Summary.Max < UATEST_LATENCY_ELAPSED);
+
+    uStatus = OpcUa_Latency_GetServiceTypeIds(4, auServiceTypeIds, &uNoOfServiceTypeIds);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(uNoOfServiceTypeIds == 1 && auServiceTypeIds[0] == UATEST_LATENCY_SERVICE);
+    UATEST_CHECK(OpcUa_Latency_GetSummary(OpcUa_LatencyStage_Service, UATEST_LATENCY_SERVICE + 1, &Summary) == OpcUa_BadNotFound);
+
+    /* a reset drops the samples before the next one is recorded */
+    OpcUa_Latency_Reset();
+    uStatus = OpcUa_Latency_GetSummary(OpcUa_LatencyStage_Service, 0, &Summary);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(Summary.Count == 0);
+
+    OpcUa_Latency_Record(OpcUa_LatencyStage_Service, UATEST_LATENCY_SERVICE, OpcUa_Latency_Now());
+    uStatus = OpcUa_Latency_GetSummary(OpcUa_LatencyStage_Service, UATEST_LATENCY_SERVICE, &Summary);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(Summary.Count == 1);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Latency_Recorder
+ *===========================================================================*/
+static OpcUa_Void UaTest_Latency_Recorder(OpcUa_Void* a_pArgument)
+{
+    UaTest_LatencyThread*   pThread = (UaTest_LatencyThread*)a_pArgument;
+    OpcUa_UInt32            uTypeId = 0;
+
+    while(OpcUa_Atomic_Load32(&UaTest_g_bLatencyStop) == 0)
+    {
+        /* new service types allocate per service histograms on the way */
+        uTypeId = 1 + pThread->uNoOfRecords % 8;
+        OpcUa_Latency_Record(OpcUa_LatencyStage_Service, uTypeId, OpcUa_Latency_Now());
+        pThread->uNoOfRecords++;
+    }
+}
+
+/*============================================================================
+ * UaTest_Latency_ClearWhileRecording
+ *===========================================================================*/
+/* clear frees the recorders only after the threads left OpcUa_Latency_Record */
+static OpcUa_StatusCode UaTest_Latency_ClearWhileRecording(OpcUa_Void)
+{
+    UaTest_LatencyThread    aThreads[UATEST_LATENCY_THREADS];
+    OpcUa_Int               i           = 0;
+    OpcUa_Int               j           = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Latency_ClearWhileRecording");
+
+    OpcUa_MemSet(aThreads, 0, sizeof(aThreads));
+    UaTest_g_bLatencyStop = 0;
+
+    for(i = 0; i < UATEST_LATENCY_THREADS; i++)
+    {
+        uStatus = OpcUa_Thread_Create(&aThreads[i].hThread, UaTest_Latency_Recorder, &aThreads[i]);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+    for(i = 0; i < UATEST_LATENCY_THREADS; i++)
+    {
+        uStatus = OpcUa_Thread_Start(aThreads[i].hThread);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+    for(j = 0; j < UATEST_LATENCY_CLEARS; j++)
+    {
+        /* let the threads record into the new generation before it is freed again */
+        OpcUa_Thread_Sleep(2);
+
+        OpcUa_Latency_Clear();
+        uStatus = OpcUa_Latency_Initialize();
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+    OpcUa_Atomic_Store32(&UaTest_g_bLatencyStop, 1);
+    for(i = 0; i < UATEST_LATENCY_THREADS; i++)
+    {
+        OpcUa_Thread_WaitForShutdown(aThreads[i].hThread, OPCUA_INFINITE);
+        UATEST_CHECK(aThreads[i].uNoOfRecords > 0);
+        OpcUa_Thread_Delete(&aThreads[i].hThread);
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_Atomic_Store32(&UaTest_g_bLatencyStop, 1);
+    for(i = 0; i < UATEST_LATENCY_THREADS; i++)
+    {
+        if(aThreads[i].hThread != OpcUa_Null)
+        {
+            OpcUa_Thread_WaitForShutdown(aThreads[i].hThread, OPCUA_INFINITE);
+            OpcUa_Thread_Delete(&aThreads[i].hThread);
+        }
+    }
+
+OpcUa_FinishErrorHandling;
+}
+
+#endif /* OPCUA_HAVE_LATENCYSTATISTICS */
+
+/*============================================================================
+ * Case table
+ *===========================================================================*/
+UaTest_Case UaTest_g_LatencyCases[] =
+{
+#ifdef OPCUA_HAVE_LATENCYSTATISTICS
+    { "stack/latency/summary",              UaTest_Latency_Summary },
+    { "stack/latency/clearwhilerecording",  UaTest_Latency_ClearWhileRecording },
+#endif /* OPCUA_HAVE_LATENCYSTATISTICS */
+    UATEST_CASE_END
+};
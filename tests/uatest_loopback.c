@@ -0,0 +1,176 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+/******************************************************************************************************/
+/* An endpoint and a client channel in the test process, for tests that call services for real.      */
+/******************************************************************************************************/
+
+#include <opcua_serverstub.h>
+#include <opcua_string.h>
+
+#include "uatest.h"
+#include "uatest_loopback.h"
+
+#if defined(OPCUA_HAVE_CLIENTAPI) && defined(OPCUA_HAVE_SERVERAPI)
+
+#include <stdio.h>
+#include <string.h>
+
+/*============================================================================
+ * Settings
+ *===========================================================================*/
+/** @brief First port tried for the endpoint. */
+#define UATEST_LOOPBACK_PORT            48850
+/** @brief Number of ports tried for the endpoint. */
+#define UATEST_LOOPBACK_NOOFPORTS       10
+/** @brief Stands in for certificate and key; the None policy does not use them. */
+#define UATEST_LOOPBACK_NOCREDENTIALS   "UaTest"
+
+/*============================================================================
+ * UaTest_Loopback_OnEndpoint
+ *===========================================================================*/
+static OpcUa_StatusCode UaTest_Loopback_OnEndpoint(
+    OpcUa_Endpoint          a_hEndpoint,
+    OpcUa_Void*             a_pvCallbackData,
+    OpcUa_Endpoint_Event    a_eEvent,
+    OpcUa_StatusCode        a_uStatus,
+    OpcUa_UInt32            a_uSecureChannelId,
+    OpcUa_ByteString*       a_pbsClientCertificate,
+    OpcUa_String*           a_pSecurityPolicy,
+    OpcUa_UInt16            a_uSecurityMode)
+{
+    OpcUa_ReferenceParameter(a_hEndpoint);
+    OpcUa_ReferenceParameter(a_pvCallbackData);
+    OpcUa_ReferenceParameter(a_eEvent);
+    OpcUa_ReferenceParameter(a_uStatus);
+    OpcUa_ReferenceParameter(a_uSecureChannelId);
+    OpcUa_ReferenceParameter(a_pbsClientCertificate);
+    OpcUa_ReferenceParameter(a_pSecurityPolicy);
+    OpcUa_ReferenceParameter(a_uSecurityMode);
+
+    return OpcUa_Good;
+}
+
+/*============================================================================
+ * UaTest_Loopback_OnChannel
+ *===========================================================================*/
+static OpcUa_StatusCode UaTest_Loopback_OnChannel(
+    OpcUa_Channel       a_hChannel,
+    OpcUa_Void*         a_pCallbackData,
+    OpcUa_Channel_Event a_eEvent,
+    OpcUa_StatusCode    a_uStatus)
+{
+    OpcUa_ReferenceParameter(a_hChannel);
+    OpcUa_ReferenceParameter(a_pCallbackData);
+    OpcUa_ReferenceParameter(a_eEvent);
+    OpcUa_ReferenceParameter(a_uStatus);
+
+    return OpcUa_Good;
+}
+
+/*============================================================================
+ * UaTest_Loopback_Clear
+ *===========================================================================*/
+OpcUa_Void UaTest_Loopback_Clear(UaTest_Loopback* a_pLoopback)
+{
+    if(a_pLoopback->hChannel != OpcUa_Null)
+    {
+        OpcUa_Channel_Disconnect(a_pLoopback->hChannel);
+        OpcUa_Channel_Delete(&a_pLoopback->hChannel);
+    }
+
+    if(a_pLoopback->hEndpoint != OpcUa_Null)
+    {
+        OpcUa_Endpoint_Close(a_pLoopback->hEndpoint);
+        OpcUa_Endpoint_Delete(&a_pLoopback->hEndpoint);
+    }
+
+    memset(a_pLoopback, 0, sizeof(UaTest_Loopback));
+}
+
+/*============================================================================
+ * UaTest_Loopback_Open
+ *===========================================================================*/
+OpcUa_StatusCode UaTest_Loopback_Open(  UaTest_Loopback*    a_pLoopback,
+                                        OpcUa_ServiceType** a_pServices)
+{
+    OpcUa_String    sPolicy;
+    OpcUa_UInt32    i       = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Loopback_Open");
+
+    memset(a_pLoopback, 0, sizeof(UaTest_Loopback));
+    OpcUa_String_Initialize(&sPolicy);
+
+    a_pLoopback->PkiConfig.PkiType = OpcUa_NO_PKI;
+    a_pLoopback->Certificate.Data = (OpcUa_Byte*)UATEST_LOOPBACK_NOCREDENTIALS;
+    a_pLoopback->Certificate.Length = (OpcUa_Int32)strlen(UATEST_LOOPBACK_NOCREDENTIALS);
+    a_pLoopback->Key.Type = OpcUa_Crypto_KeyType_Rsa_Private;
+    a_pLoopback->Key.Key = a_pLoopback->Certificate;
+    OpcUa_String_AttachReadOnly(&a_pLoopback->Policy.sSecurityPolicy, OpcUa_SecurityPolicy_None);
+    a_pLoopback->Policy.uMessageSecurityModes = OPCUA_ENDPOINT_MESSAGESECURITYMODE_NONE;
+
+    uStatus = OpcUa_Endpoint_Create(&a_pLoopback->hEndpoint, OpcUa_Endpoint_SerializerType_Binary, a_pServices);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* a port another process holds does not fail the test */
+    for(i = 0; i < UATEST_LOOPBACK_NOOFPORTS; i++)
+    {
+        OpcUa_SnPrintfA(a_pLoopback->sUrl, sizeof(a_pLoopback->sUrl), "opc.tcp://localhost:%u", (unsigned int)(UATEST_LOOPBACK_PORT + i));
+        uStatus = OpcUa_Endpoint_Open(  a_pLoopback->hEndpoint,
+                                        a_pLoopback->sUrl,
+                                        OpcUa_False,
+                                        UaTest_Loopback_OnEndpoint,
+                                        OpcUa_Null,
+                                        &a_pLoopback->Certificate,
+                                        &a_pLoopback->Key,
+                                        &a_pLoopback->PkiConfig,
+                                        1,
+                                        &a_pLoopback->Policy);
+        if(OpcUa_IsGood(uStatus))
+        {
+            break;
+        }
+    }
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = OpcUa_Channel_Create(&a_pLoopback->hChannel, OpcUa_Channel_SerializerType_Binary);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    OpcUa_String_AttachReadOnly(&sPolicy, OpcUa_SecurityPolicy_None);
+    uStatus = OpcUa_Channel_Connect(a_pLoopback->hChannel,
+                                    a_pLoopback->sUrl,
+                                    UaTest_Loopback_OnChannel,
+                                    OpcUa_Null,
+                                    &a_pLoopback->NoCertificate,
+                                    &a_pLoopback->NoKey,
+                                    &a_pLoopback->NoCertificate,
+                                    &a_pLoopback->PkiConfig,
+                                    &sPolicy,
+                                    600000,
+                                    OpcUa_MessageSecurityMode_None,
+                                    UATEST_LOOPBACK_TIMEOUT);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_Loopback_Clear(a_pLoopback);
+
+OpcUa_FinishErrorHandling;
+}
+
+#endif /* OPCUA_HAVE_CLIENTAPI && OPCUA_HAVE_SERVERAPI */
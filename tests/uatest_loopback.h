@@ -0,0 +1,53 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#ifndef _UaTest_Loopback_H_
+#define _UaTest_Loopback_H_ 1
+
+#if defined(OPCUA_HAVE_CLIENTAPI) && defined(OPCUA_HAVE_SERVERAPI)
+
+#include <opcua_clientproxy.h>
+
+/*============================================================================
+ * An endpoint on localhost and a channel connected to it, both with the None policy.
+ *===========================================================================*/
+typedef struct _UaTest_Loopback
+{
+    OpcUa_Endpoint                                  hEndpoint;
+    OpcUa_Channel                                   hChannel;
+    OpcUa_P_OpenSSL_CertificateStore_Config         PkiConfig;
+    OpcUa_ByteString                                Certificate;
+    OpcUa_Key                                       Key;
+    OpcUa_ByteString                                NoCertificate;
+    OpcUa_Key                                       NoKey;
+    OpcUa_Endpoint_SecurityPolicyConfiguration      Policy;
+    /** @brief The URL the endpoint listens on. */
+    OpcUa_CharA                                     sUrl[64];
+} UaTest_Loopback;
+
+/** @brief Timeout of the channel in milliseconds; requests should use it as their timeout hint. */
+#define UATEST_LOOPBACK_TIMEOUT         10000
+
+/** @brief Opens an endpoint for the services in a_pServices and connects a channel to it. */
+OpcUa_StatusCode UaTest_Loopback_Open(  UaTest_Loopback*    a_pLoopback,
+                                        OpcUa_ServiceType** a_pServices);
+
+/** @brief Disconnects the channel and closes the endpoint. */
+OpcUa_Void UaTest_Loopback_Clear(UaTest_Loopback* a_pLoopback);
+
+#endif /* OPCUA_HAVE_CLIENTAPI && OPCUA_HAVE_SERVERAPI */
+
+#endif /* _UaTest_Loopback_H_ */
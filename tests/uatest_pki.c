@@ -0,0 +1,429 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+/******************************************************************************************************/
+/* Tests for the OpenSSL PKI provider: cached validation results follow changes of the store files   */
+/* and end where the validity of the certificate begins or ends.                                      */
+/******************************************************************************************************/
+
+#include <opcua_serverstub.h>
+#include <opcua_memory.h>
+#include <opcua_core.h>
+
+#include "uatest.h"
+
+#include <opcua_p_openssl_pki.h>
+
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/*============================================================================
+ * Types and constants
+ *===========================================================================*/
+#define UATEST_PKI_PATH_LENGTH      256
+
+/** @brief A certificate with its key, signed by itself or by an issuer. */
+typedef struct _UaTest_PkiCredentials
+{
+    X509*               pCertificate;
+    EVP_PKEY*           pKey;
+    OpcUa_ByteString    Certificate;
+} UaTest_PkiCredentials;
+
+/** @brief Temporary store directories and the credentials stored in them. */
+typedef struct _UaTest_Pki
+{
+    char                    sRoot[UATEST_PKI_PATH_LENGTH];
+    char                    sTrusted[UATEST_PKI_PATH_LENGTH];
+    char                    sUntrusted[UATEST_PKI_PATH_LENGTH];
+    char                    sRevoked[UATEST_PKI_PATH_LENGTH];
+    char                    sCaFile[UATEST_PKI_PATH_LENGTH];
+    char                    sCrlFile[UATEST_PKI_PATH_LENGTH];
+    UaTest_PkiCredentials   Ca;
+    UaTest_PkiCredentials   OtherCa;
+    UaTest_PkiCredentials   Leaf;
+    UaTest_PkiCredentials   ShortLived;
+    OpcUa_P_OpenSSL_CertificateStore_Config Config;
+    OpcUa_PKIProvider       Provider;
+    OpcUa_Boolean           bProvider;
+} UaTest_Pki;
+
+/*============================================================================
+ * Globals
+ *===========================================================================*/
+static UaTest_Pki           UaTest_g_Pki;
+
+/*============================================================================
+ * UaTest_Pki_CreateCredentials
+ *===========================================================================*/
+/* a CA certificate if a_pIssuer is null, else a leaf certificate signed by a_pIssuer; validity in seconds from now */
+static OpcUa_StatusCode UaTest_Pki_CreateCredentials(   const char*             a_sName,
+                                                        long                    a_iSerial,
+                                                        long                    a_iNotBefore,
+                                                        long                    a_iNotAfter,
+                                                        UaTest_PkiCredentials*  a_pIssuer,
+                                                        UaTest_PkiCredentials*  a_pCredentials)
+{
+    EVP_PKEY_CTX*   pContext    = OpcUa_Null;
+    X509_EXTENSION* pExtension  = OpcUa_Null;
+    X509V3_CTX      ExtensionContext;
+    OpcUa_Byte*     pData       = OpcUa_Null;
+    int             iLength     = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Pki_CreateCredentials");
+
+    pContext = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, OpcUa_Null);
+    OpcUa_GotoErrorIfAllocFailed(pContext);
+    OpcUa_GotoErrorIfTrue(EVP_PKEY_keygen_init(pContext) <= 0, OpcUa_BadInternalError);
+    OpcUa_GotoErrorIfTrue(EVP_PKEY_CTX_set_rsa_keygen_bits(pContext, 2048) <= 0, OpcUa_BadInternalError);
+    OpcUa_GotoErrorIfTrue(EVP_PKEY_keygen(pContext, &a_pCredentials->pKey) <= 0, OpcUa_BadInternalError);
+
+    a_pCredentials->pCertificate = X509_new();
+    OpcUa_GotoErrorIfAllocFailed(a_pCredentials->pCertificate);
+    X509_set_version(a_pCredentials->pCertificate, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(a_pCredentials->pCertificate), a_iSerial);
+    X509_gmtime_adj(X509_getm_notBefore(a_pCredentials->pCertificate), a_iNotBefore);
+    X509_gmtime_adj(X509_getm_notAfter(a_pCredentials->pCertificate), a_iNotAfter);
+    X509_set_pubkey(a_pCredentials->pCertificate, a_pCredentials->pKey);
+    X509_NAME_add_entry_by_txt(X509_get_subject_name(a_pCredentials->pCertificate), "CN", MBSTRING_ASC, (const unsigned char*)a_sName, -1, -1, 0);
+    X509_set_issuer_name(   a_pCredentials->pCertificate,
+                            X509_get_subject_name((a_pIssuer != OpcUa_Null)?a_pIssuer->pCertificate:a_pCredentials->pCertificate));
+
+    X509V3_set_ctx(&ExtensionContext, (a_pIssuer != OpcUa_Null)?a_pIssuer->pCertificate:a_pCredentials->pCertificate, a_pCredentials->pCertificate, OpcUa_Null, OpcUa_Null, 0);
+    pExtension = X509V3_EXT_conf_nid(OpcUa_Null, &ExtensionContext, NID_basic_constraints, (a_pIssuer != OpcUa_Null)?"CA:FALSE":"critical,CA:TRUE");
+    OpcUa_GotoErrorIfAllocFailed(pExtension);
+    X509_add_ext(a_pCredentials->pCertificate, pExtension, -1);
+    X509_EXTENSION_free(pExtension);
+
+    OpcUa_GotoErrorIfTrue(X509_sign(a_pCredentials->pCertificate,
+                                    (a_pIssuer != OpcUa_Null)?a_pIssuer->pKey:a_pCredentials->pKey,
+                                    EVP_sha256()) <= 0, OpcUa_BadInternalError);
+
+    iLength = i2d_X509(a_pCredentials->pCertificate, OpcUa_Null);
+    OpcUa_GotoErrorIfTrue(iLength <= 0, OpcUa_BadInternalError);
+    a_pCredentials->Certificate.Data = (OpcUa_Byte*)OpcUa_Alloc((OpcUa_UInt32)iLength);
+    OpcUa_GotoErrorIfAllocFailed(a_pCredentials->Certificate.Data);
+    pData = a_pCredentials->Certificate.Data;
+    a_pCredentials->Certificate.Length = i2d_X509(a_pCredentials->pCertificate, &pData);
+
+    EVP_PKEY_CTX_free(pContext);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    EVP_PKEY_CTX_free(pContext);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Pki_ClearCredentials
+ *===========================================================================*/
+static OpcUa_Void UaTest_Pki_ClearCredentials(UaTest_PkiCredentials* a_pCredentials)
+{
+    X509_free(a_pCredentials->pCertificate);
+    EVP_PKEY_free(a_pCredentials->pKey);
+    OpcUa_ByteString_Clear(&a_pCredentials->Certificate);
+    OpcUa_MemSet(a_pCredentials, 0, sizeof(UaTest_PkiCredentials));
+}
+
+/*============================================================================
+ * UaTest_Pki_WriteCertificate
+ *===========================================================================*/
+/* (over)writes a DER certificate file in place */
+static OpcUa_Boolean UaTest_Pki_WriteCertificate(   const char*             a_sFile,
+                                                    UaTest_PkiCredentials*  a_pCredentials)
+{
+    FILE*   pFile   = fopen(a_sFile, "wb");
+    size_t  uLength = 0;
+
+    if(pFile == OpcUa_Null)
+    {
+        return OpcUa_False;
+    }
+
+    uLength = fwrite(a_pCredentials->Certificate.Data, 1, (size_t)a_pCredentials->Certificate.Length, pFile);
+    fclose(pFile);
+
+    return (OpcUa_Boolean)(uLength == (size_t)a_pCredentials->Certificate.Length);
+}
+
+/*============================================================================
+ * UaTest_Pki_WriteCrl
+ *===========================================================================*/
+/* (over)writes the PEM CRL of the CA in place; revokes the leaf certificate if requested */
+static OpcUa_Boolean UaTest_Pki_WriteCrl(OpcUa_Boolean a_bRevokeLeaf)
+{
+    X509_CRL*       pCrl        = X509_CRL_new();
+    X509_REVOKED*   pRevoked    = OpcUa_Null;
+    ASN1_TIME*      pTime       = ASN1_TIME_new();
+    FILE*           pFile       = OpcUa_Null;
+    OpcUa_Boolean   bDone       = OpcUa_False;
+
+    if(pCrl == OpcUa_Null || pTime == OpcUa_Null)
+    {
+        goto Done;
+    }
+
+    X509_CRL_set_version(pCrl, 1);
+    X509_CRL_set_issuer_name(pCrl, X509_get_subject_name(UaTest_g_Pki.Ca.pCertificate));
+    X509_gmtime_adj(pTime, -60);
+    X509_CRL_set1_lastUpdate(pCrl, pTime);
+
+    if(a_bRevokeLeaf != OpcUa_False)
+    {
+        pRevoked = X509_REVOKED_new();
+        if(pRevoked == OpcUa_Null)
+        {
+            goto Done;
+        }
+        X509_REVOKED_set_serialNumber(pRevoked, X509_get_serialNumber(UaTest_g_Pki.Leaf.pCertificate));
+        X509_REVOKED_set_revocationDate(pRevoked, pTime);
+        X509_CRL_add0_revoked(pCrl, pRevoked);
+    }
+
+    X509_gmtime_adj(pTime, 3600);
+    X509_CRL_set1_nextUpdate(pCrl, pTime);
+    X509_CRL_sort(pCrl);
+
+    if(X509_CRL_sign(pCrl, UaTest_g_Pki.Ca.pKey, EVP_sha256()) <= 0)
+    {
+        goto Done;
+    }
+
+    pFile = fopen(UaTest_g_Pki.sCrlFile, "wb");
+    if(pFile != OpcUa_Null)
+    {
+        bDone = (OpcUa_Boolean)(PEM_write_X509_CRL(pFile, pCrl) == 1);
+        fclose(pFile);
+    }
+
+Done:
+    X509_CRL_free(pCrl);
+    ASN1_TIME_free(pTime);
+
+    return bDone;
+}
+
+/*============================================================================
+ * UaTest_Pki_Validate
+ *===========================================================================*/
+/* validates a certificate against a freshly opened store */
+static OpcUa_StatusCode UaTest_Pki_Validate(UaTest_PkiCredentials* a_pCredentials)
+{
+    OpcUa_Void*         pStore          = OpcUa_Null;
+    OpcUa_Int           iValidationCode = 0;
+    OpcUa_StatusCode    uStatus         = OpcUa_Good;
+
+    uStatus = UaTest_g_Pki.Provider.OpenCertificateStore(&UaTest_g_Pki.Provider, &pStore);
+    if(OpcUa_IsGood(uStatus))
+    {
+        uStatus = UaTest_g_Pki.Provider.ValidateCertificate(&UaTest_g_Pki.Provider, &a_pCredentials->Certificate, pStore, &iValidationCode);
+        UaTest_g_Pki.Provider.CloseCertificateStore(&UaTest_g_Pki.Provider, &pStore);
+    }
+
+    return uStatus;
+}
+
+/*============================================================================
+ * UaTest_Pki_Clear
+ *===========================================================================*/
+static OpcUa_Void UaTest_Pki_Clear(OpcUa_Void)
+{
+    if(UaTest_g_Pki.bProvider != OpcUa_False)
+    {
+        OpcUa_PKIProvider_Delete(&UaTest_g_Pki.Provider);
+    }
+
+    if(UaTest_g_Pki.sRoot[0] != '\0')
+    {
+        unlink(UaTest_g_Pki.sCaFile);
+        unlink(UaTest_g_Pki.sCrlFile);
+        rmdir(UaTest_g_Pki.sTrusted);
+        rmdir(UaTest_g_Pki.sUntrusted);
+        rmdir(UaTest_g_Pki.sRevoked);
+        rmdir(UaTest_g_Pki.sRoot);
+    }
+
+    UaTest_Pki_ClearCredentials(&UaTest_g_Pki.Ca);
+    UaTest_Pki_ClearCredentials(&UaTest_g_Pki.OtherCa);
+    UaTest_Pki_ClearCredentials(&UaTest_g_Pki.Leaf);
+    UaTest_Pki_ClearCredentials(&UaTest_g_Pki.ShortLived);
+    OpcUa_MemSet(&UaTest_g_Pki, 0, sizeof(UaTest_g_Pki));
+}
+
+/*============================================================================
+ * UaTest_Pki_Open
+ *===========================================================================*/
+/* a trust list with the CA, an empty CRL of the CA and a leaf certificate the CA signed */
+static OpcUa_StatusCode UaTest_Pki_Open(OpcUa_Void)
+{
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Pki_Open");
+
+    OpcUa_MemSet(&UaTest_g_Pki, 0, sizeof(UaTest_g_Pki));
+
+    strcpy(UaTest_g_Pki.sRoot, "/tmp/uatest_pki_XXXXXX");
+    OpcUa_GotoErrorIfTrue(mkdtemp(UaTest_g_Pki.sRoot) == OpcUa_Null, OpcUa_BadInternalError);
+    sprintf(UaTest_g_Pki.sTrusted,   "%s/trusted",   UaTest_g_Pki.sRoot);
+    sprintf(UaTest_g_Pki.sUntrusted, "%s/untrusted", UaTest_g_Pki.sRoot);
+    sprintf(UaTest_g_Pki.sRevoked,   "%s/revoked",   UaTest_g_Pki.sRoot);
+    sprintf(UaTest_g_Pki.sCaFile,    "%s/ca.der",    UaTest_g_Pki.sTrusted);
+    sprintf(UaTest_g_Pki.sCrlFile,   "%s/ca.crl",    UaTest_g_Pki.sRevoked);
+    OpcUa_GotoErrorIfTrue(mkdir(UaTest_g_Pki.sTrusted, 0700) != 0, OpcUa_BadInternalError);
+    OpcUa_GotoErrorIfTrue(mkdir(UaTest_g_Pki.sUntrusted, 0700) != 0, OpcUa_BadInternalError);
+    OpcUa_GotoErrorIfTrue(mkdir(UaTest_g_Pki.sRevoked, 0700) != 0, OpcUa_BadInternalError);
+
+    uStatus = UaTest_Pki_CreateCredentials("UaTest CA", 1, -60, 3600, OpcUa_Null, &UaTest_g_Pki.Ca);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_Pki_CreateCredentials("UaTest CA", 2, -60, 3600, OpcUa_Null, &UaTest_g_Pki.OtherCa);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_Pki_CreateCredentials("UaTest Leaf", 3, -60, 3600, &UaTest_g_Pki.Ca, &UaTest_g_Pki.Leaf);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    OpcUa_GotoErrorIfTrue(UaTest_Pki_WriteCertificate(UaTest_g_Pki.sCaFile, &UaTest_g_Pki.Ca) == OpcUa_False, OpcUa_BadInternalError);
+    OpcUa_GotoErrorIfTrue(UaTest_Pki_WriteCrl(OpcUa_False) == OpcUa_False, OpcUa_BadInternalError);
+
+    UaTest_g_Pki.Config.PkiType                             = OpcUa_OpenSSL_PKI;
+    UaTest_g_Pki.Config.CertificateTrustListLocation        = UaTest_g_Pki.sTrusted;
+    UaTest_g_Pki.Config.CertificateUntrustedListLocation    = UaTest_g_Pki.sUntrusted;
+    UaTest_g_Pki.Config.CertificateRevocationListLocation   = UaTest_g_Pki.sRevoked;
+    UaTest_g_Pki.Config.Flags                               = OPCUA_P_PKI_OPENSSL_CHECK_REVOCATION_ALL;
+
+    uStatus = OpcUa_PKIProvider_Create(&UaTest_g_Pki.Config, &UaTest_g_Pki.Provider);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UaTest_g_Pki.bProvider = OpcUa_True;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_Pki_Clear();
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Pki_Expiry
+ *===========================================================================*/
+/* a cached result is revalidated when the certificate becomes valid and when it expires */
+static OpcUa_StatusCode UaTest_Pki_Expiry(OpcUa_Void)
+{
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Pki_Expiry");
+
+    uStatus = UaTest_Pki_Open();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* both results would outlive the certificate by far with the plain time to live */
+    uStatus = UaTest_Pki_CreateCredentials("UaTest Short Lived", 4, 2, 4, &UaTest_g_Pki.Ca, &UaTest_g_Pki.ShortLived);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    UATEST_CHECK(UaTest_Pki_Validate(&UaTest_g_Pki.ShortLived) == OpcUa_BadCertificateTimeInvalid);
+    UATEST_CHECK(UaTest_Pki_Validate(&UaTest_g_Pki.ShortLived) == OpcUa_BadCertificateTimeInvalid);
+
+    sleep(3);
+    UATEST_CHECK(UaTest_Pki_Validate(&UaTest_g_Pki.ShortLived) == OpcUa_Good);
+    UATEST_CHECK(UaTest_Pki_Validate(&UaTest_g_Pki.ShortLived) == OpcUa_Good);
+
+    sleep(2);
+    UATEST_CHECK(UaTest_Pki_Validate(&UaTest_g_Pki.ShortLived) == OpcUa_BadCertificateTimeInvalid);
+
+    UaTest_Pki_Clear();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_Pki_Clear();
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Pki_Revoked
+ *===========================================================================*/
+/* a CRL rewritten in place revokes a certificate that was validated before */
+static OpcUa_StatusCode UaTest_Pki_Revoked(OpcUa_Void)
+{
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Pki_Revoked");
+
+    uStatus = UaTest_Pki_Open();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    UATEST_CHECK(UaTest_Pki_Validate(&UaTest_g_Pki.Leaf) == OpcUa_Good);
+    UATEST_CHECK(UaTest_Pki_Validate(&UaTest_g_Pki.Leaf) == OpcUa_Good);
+
+    /* same file name in the same directory; the directory itself does not change */
+    UATEST_CHECK(UaTest_Pki_WriteCrl(OpcUa_True) != OpcUa_False);
+    uStatus = OpcUa_P_OpenSSL_PKI_ReloadCertificateStore(&UaTest_g_Pki.Provider);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    UATEST_CHECK(UaTest_Pki_Validate(&UaTest_g_Pki.Leaf) == OpcUa_BadCertificateRevoked);
+
+    UaTest_Pki_Clear();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_Pki_Clear();
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Pki_Untrusted
+ *===========================================================================*/
+/* a trust list file replaced in place by another CA untrusts a certificate that was validated before */
+static OpcUa_StatusCode UaTest_Pki_Untrusted(OpcUa_Void)
+{
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Pki_Untrusted");
+
+    uStatus = UaTest_Pki_Open();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    UATEST_CHECK(UaTest_Pki_Validate(&UaTest_g_Pki.Leaf) == OpcUa_Good);
+
+    UATEST_CHECK(UaTest_Pki_WriteCertificate(UaTest_g_Pki.sCaFile, &UaTest_g_Pki.OtherCa) != OpcUa_False);
+    uStatus = OpcUa_P_OpenSSL_PKI_ReloadCertificateStore(&UaTest_g_Pki.Provider);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    UATEST_CHECK(UaTest_Pki_Validate(&UaTest_g_Pki.Leaf) != OpcUa_Good);
+
+    UaTest_Pki_Clear();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_Pki_Clear();
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * Case table
+ *===========================================================================*/
+UaTest_Case UaTest_g_PkiCases[] =
+{
+    { "stack/pki/validationcache/revoked",      UaTest_Pki_Revoked },
+    { "stack/pki/validationcache/untrusted",    UaTest_Pki_Untrusted },
+    { "stack/pki/validationcache/expiry",       UaTest_Pki_Expiry },
+    UATEST_CASE_END
+};
@@ -0,0 +1,474 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+
+
+/******************************************************************************************************/
+/* Tests for the Read service of the sample server without copies: the results borrow NodeIds and    */
+/* strings from the address space, and values are whole even while a writer changes them.            */
+/******************************************************************************************************/
+
+#include <opcua_serverstub.h>
+#include <opcua_memory.h>
+#include <opcua_core.h>
+#include <opcua_thread.h>
+
+#include "addressspace.h"
+#include "browseservice.h"
+#include "readservice.h"
+#include "sessiontable.h"
+#include "valuestore.h"
+
+#include "uatest.h"
+#include "uatest_loopback.h"
+#include "uatest_sample.h"
+
+#if defined(OPCUA_HAVE_CLIENTAPI) && defined(OPCUA_HAVE_SERVERAPI) && defined(READ_ZERO_COPY)
+
+#include <string.h>
+
+/*============================================================================
+ * Test settings
+ *===========================================================================*/
+/** @brief Values of the two variables in the value store. */
+#define UATEST_READ_STRINGINDEX         0
+#define UATEST_READ_ARRAYINDEX          1
+/** @brief Numeric NodeIds of the variables in namespace 2. */
+#define UATEST_READ_STRINGNODEID        5101
+#define UATEST_READ_ARRAYNODEID         5102
+#define UATEST_READ_UNKNOWNNODEID       5199
+#define UATEST_READ_ELEMENTS            1024
+/** @brief Reads of the array done while the writer runs. */
+#define UATEST_READ_CONCURRENTREADS     200
+
+/*============================================================================
+ * UaTest_Read
+ *===========================================================================*/
+typedef struct _UaTest_Read
+{
+    UaTest_Loopback                 Loopback;
+    OpcUa_ServiceType               ReadType;
+    OpcUa_ServiceType*              apServices[2];
+    _VariableKnoten_                aVariables[2];
+    _AddressSpaceTables_            Tables;
+    OpcUa_RequestHeader             RequestHeader;
+    my_Variant                      aSaved[2];
+    OpcUa_Thread                    hWriter;
+    OpcUa_UInt32                    uStopWriter;
+    OpcUa_UInt32                    uNoOfWrites;
+} UaTest_Read;
+
+static UaTest_Read UaTest_g_Read;
+
+/*============================================================================
+ * Globals
+ *===========================================================================*/
+extern my_Variant           all_ValueAttribute_of_VariableTypeNodes_VariableNodes[];
+
+static OpcUa_Double         UaTest_g_aReadElements[UATEST_READ_ELEMENTS];
+
+/*============================================================================
+ * UaTest_Read_WriteArray
+ *===========================================================================*/
+/* value k: all elements are k, the source timestamp is k */
+static OpcUa_Void UaTest_Read_WriteArray(OpcUa_UInt32 a_uValue)
+{
+    my_Variant*     pValue  = &all_ValueAttribute_of_VariableTypeNodes_VariableNodes[UATEST_READ_ARRAYINDEX];
+    OpcUa_DateTime  SourceTimestamp;
+    OpcUa_Int32     i       = 0;
+
+    OpcUa_MemSet(&SourceTimestamp, 0, sizeof(SourceTimestamp));
+    SourceTimestamp.dwLowDateTime = a_uValue;
+
+    write_value_begin(UATEST_READ_ARRAYINDEX);
+    for(i = 0; i < pValue->Value.Array.Length; i++)
+    {
+        pValue->Value.Array.Value.DoubleArray[i] = (OpcUa_Double)a_uValue;
+    }
+    write_value_end(UATEST_READ_ARRAYINDEX, &SourceTimestamp);
+}
+
+/*============================================================================
+ * UaTest_Read_CheckArray
+ *===========================================================================*/
+/* OpcUa_True if the result is one value as UaTest_Read_WriteArray left it */
+static OpcUa_Boolean UaTest_Read_CheckArray(const OpcUa_DataValue* a_pResult)
+{
+    OpcUa_Double    dValue  = 0;
+    OpcUa_Int32     i       = 0;
+
+    if(    OpcUa_IsBad(a_pResult->StatusCode)
+        || a_pResult->Value.Datatype != OpcUaType_Double
+        || a_pResult->Value.ArrayType != OpcUa_VariantArrayType_Array
+        || a_pResult->Value.Value.Array.Length != UATEST_READ_ELEMENTS)
+    {
+        return OpcUa_False;
+    }
+
+    dValue = a_pResult->Value.Value.Array.Value.DoubleArray[0];
+    if(a_pResult->SourceTimestamp.dwLowDateTime != (OpcUa_UInt32)dValue)
+    {
+        return OpcUa_False;
+    }
+    for(i = 1; i < UATEST_READ_ELEMENTS; i++)
+    {
+        if(a_pResult->Value.Value.Array.Value.DoubleArray[i] != dValue)
+        {
+            return OpcUa_False;
+        }
+    }
+    return OpcUa_True;
+}
+
+/*============================================================================
+ * UaTest_Read_Writer
+ *===========================================================================*/
+static OpcUa_Void UaTest_Read_Writer(OpcUa_Void* a_pArgument)
+{
+    UaTest_Read* pTest = (UaTest_Read*)a_pArgument;
+
+    while(OpcUa_Atomic_Load32(&pTest->uStopWriter) == 0)
+    {
+        pTest->uNoOfWrites++;
+        UaTest_Read_WriteArray(pTest->uNoOfWrites);
+    }
+}
+
+/*============================================================================
+ * UaTest_Read_Open
+ *===========================================================================*/
+/* indexes a string and an array variable, opens a session and connects a channel to my_BeginRead */
+static OpcUa_StatusCode UaTest_Read_Open(OpcUa_Void)
+{
+    UaTest_Read*    pTest       = &UaTest_g_Read;
+    my_Variant*     pValues     = all_ValueAttribute_of_VariableTypeNodes_VariableNodes;
+    OpcUa_UInt32    uSessionId  = 0;
+    OpcUa_Int       i           = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Read_Open");
+
+    memset(pTest, 0, sizeof(UaTest_Read));
+    OpcUa_RequestHeader_Initialize(&pTest->RequestHeader);
+
+    pTest->aSaved[0] = pValues[UATEST_READ_STRINGINDEX];
+    pTest->aSaved[1] = pValues[UATEST_READ_ARRAYINDEX];
+
+    initialize_value_store();
+    pValues[UATEST_READ_STRINGINDEX].Datatype                       = OpcUaId_String;
+    pValues[UATEST_READ_STRINGINDEX].ArrayType                      = OpcUa_VariantArrayType_Scalar;
+    pValues[UATEST_READ_STRINGINDEX].Value.String                   = "UaTestValue";
+    pValues[UATEST_READ_ARRAYINDEX].Datatype                        = OpcUaId_Double;
+    pValues[UATEST_READ_ARRAYINDEX].ArrayType                       = OpcUa_VariantArrayType_Array;
+    pValues[UATEST_READ_ARRAYINDEX].Value.Array.Length              = UATEST_READ_ELEMENTS;
+    pValues[UATEST_READ_ARRAYINDEX].Value.Array.Value.DoubleArray   = UaTest_g_aReadElements;
+    UaTest_Read_WriteArray(7);
+
+    for(i = 0; i < 2; i++)
+    {
+        pTest->aVariables[i].BaseAttribute.NodeId.NamespaceIndex    = 2;
+        pTest->aVariables[i].BaseAttribute.NodeClass                = OpcUa_NodeClass_Variable;
+        pTest->aVariables[i].DataType.Identifier.Numeric            = (i == 0)?OpcUaId_String:OpcUaId_Double;
+        pTest->aVariables[i].AccessLevel                            = OpcUa_AccessLevels_CurrentRead;
+        pTest->aVariables[i].UserAccessLevel                        = OpcUa_AccessLevels_CurrentRead;
+    }
+    pTest->aVariables[0].BaseAttribute.NodeId.Identifier.Numeric    = UATEST_READ_STRINGNODEID;
+    pTest->aVariables[0].BaseAttribute.BrowseName                   = "UaTestString";
+    pTest->aVariables[0].BaseAttribute.DisplayName                  = "UaTest String";
+    pTest->aVariables[0].ValueIndex                                 = UATEST_READ_STRINGINDEX;
+    pTest->aVariables[1].BaseAttribute.NodeId.Identifier.Numeric    = UATEST_READ_ARRAYNODEID;
+    pTest->aVariables[1].BaseAttribute.BrowseName                   = "UaTestArray";
+    pTest->aVariables[1].BaseAttribute.DisplayName                  = "UaTest Array";
+    pTest->aVariables[1].ValueIndex                                 = UATEST_READ_ARRAYINDEX;
+    pTest->Tables.Variables                                         = pTest->aVariables;
+    pTest->Tables.NoOfVariables                                     = 2;
+
+    uStatus = build_node_index(&pTest->Tables);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = initialize_sessions();
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_Sample_OpenSession(60000, &pTest->RequestHeader, &uSessionId);
+    OpcUa_GotoErrorIfBad(uStatus);
+    pTest->RequestHeader.TimeoutHint = UATEST_LOOPBACK_TIMEOUT;
+
+    pTest->ReadType.RequestTypeId   = OpcUaId_ReadRequest;
+    pTest->ReadType.ResponseType    = &OpcUa_ReadResponse_EncodeableType;
+    pTest->ReadType.BeginInvoke     = (OpcUa_PfnBeginInvokeService*)my_BeginRead;
+    pTest->ReadType.Invoke          = (OpcUa_PfnInvokeService*)my_Read;
+    pTest->apServices[0] = &pTest->ReadType;
+    pTest->apServices[1] = OpcUa_Null;
+
+    uStatus = UaTest_Loopback_Open(&pTest->Loopback, pTest->apServices);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Read_Clear
+ *===========================================================================*/
+/* the writer stops before the endpoint goes away, the values are restored last */
+static OpcUa_Void UaTest_Read_Clear(OpcUa_Void)
+{
+    UaTest_Read*    pTest   = &UaTest_g_Read;
+    my_Variant*     pValues = all_ValueAttribute_of_VariableTypeNodes_VariableNodes;
+
+    if(pTest->hWriter != OpcUa_Null)
+    {
+        OpcUa_Atomic_Store32(&pTest->uStopWriter, 1);
+        OpcUa_Thread_WaitForShutdown(pTest->hWriter, OPCUA_INFINITE);
+        OpcUa_Thread_Delete(&pTest->hWriter);
+    }
+    UaTest_Loopback_Clear(&pTest->Loopback);
+    clear_sessions();
+    clear_node_index();
+    OpcUa_RequestHeader_Clear(&pTest->RequestHeader);
+
+    pValues[UATEST_READ_STRINGINDEX] = pTest->aSaved[0];
+    pValues[UATEST_READ_ARRAYINDEX]  = pTest->aSaved[1];
+}
+
+/*============================================================================
+ * UaTest_Read_Call
+ *===========================================================================*/
+/* reads the attributes of a_pNodesToRead with both timestamps */
+static OpcUa_StatusCode UaTest_Read_Call(   OpcUa_Int32             a_nNoOfNodesToRead,
+                                            OpcUa_ReadValueId*      a_pNodesToRead,
+                                            OpcUa_Int32*            a_pNoOfResults,
+                                            OpcUa_DataValue**       a_pResults)
+{
+    UaTest_Read*            pTest                   = &UaTest_g_Read;
+    OpcUa_ResponseHeader    ResponseHeader;
+    OpcUa_Int32             nNoOfDiagnosticInfos    = 0;
+    OpcUa_DiagnosticInfo*   pDiagnosticInfos        = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Read_Call");
+
+    OpcUa_ResponseHeader_Initialize(&ResponseHeader);
+
+    pTest->RequestHeader.RequestHandle++;
+    pTest->RequestHeader.Timestamp = OpcUa_DateTime_UtcNow();
+
+    uStatus = OpcUa_ClientApi_Read( pTest->Loopback.hChannel,
+                                    &pTest->RequestHeader,
+                                    0,
+                                    OpcUa_TimestampsToReturn_Both,
+                                    a_nNoOfNodesToRead,
+                                    a_pNodesToRead,
+                                    &ResponseHeader,
+                                    a_pNoOfResults,
+                                    a_pResults,
+                                    &nNoOfDiagnosticInfos,
+                                    &pDiagnosticInfos);
+    OpcUa_GotoErrorIfBad(uStatus);
+    OpcUa_GotoErrorIfBad(ResponseHeader.ServiceResult);
+    OpcUa_GotoErrorIfTrue(*a_pNoOfResults != a_nNoOfNodesToRead, OpcUa_BadUnexpectedError);
+
+    OpcUa_ResponseHeader_Clear(&ResponseHeader);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_ResponseHeader_Clear(&ResponseHeader);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Read_ClearResults
+ *===========================================================================*/
+static OpcUa_Void UaTest_Read_ClearResults( OpcUa_Int32*        a_pNoOfResults,
+                                            OpcUa_DataValue**   a_pResults)
+{
+    OpcUa_Int32 i = 0;
+
+    for(i = 0; i < *a_pNoOfResults && *a_pResults != OpcUa_Null; i++)
+    {
+        OpcUa_DataValue_Clear(&(*a_pResults)[i]);
+    }
+    OpcUa_Free(*a_pResults);
+    *a_pResults     = OpcUa_Null;
+    *a_pNoOfResults = 0;
+}
+
+/*============================================================================
+ * UaTest_Read_SetNodeToRead
+ *===========================================================================*/
+static OpcUa_Void UaTest_Read_SetNodeToRead(OpcUa_ReadValueId*  a_pNodeToRead,
+                                            OpcUa_UInt32        a_uNodeId,
+                                            OpcUa_UInt32        a_uAttributeId)
+{
+    OpcUa_ReadValueId_Initialize(a_pNodeToRead);
+    a_pNodeToRead->NodeId.NamespaceIndex        = 2;
+    a_pNodeToRead->NodeId.Identifier.Numeric    = a_uNodeId;
+    a_pNodeToRead->AttributeId                  = a_uAttributeId;
+}
+
+/*============================================================================
+ * UaTest_Read_Borrowed
+ *===========================================================================*/
+/* the client receives what the nodes hold, and the nodes keep it after the responses are deleted */
+static OpcUa_StatusCode UaTest_Read_Borrowed(OpcUa_Void)
+{
+    UaTest_Read*            pTest           = &UaTest_g_Read;
+    my_Variant*             pValues         = all_ValueAttribute_of_VariableTypeNodes_VariableNodes;
+    OpcUa_ReadValueId       aNodesToRead[7];
+    OpcUa_Int32             nNoOfResults    = 0;
+    OpcUa_DataValue*        pResults        = OpcUa_Null;
+    OpcUa_Int               iRound          = 0;
+    OpcUa_Int32             i               = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Read_Borrowed");
+
+    uStatus = UaTest_Read_Open();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    UaTest_Read_SetNodeToRead(&aNodesToRead[0], UATEST_READ_STRINGNODEID,   OpcUa_Attributes_NodeId);
+    UaTest_Read_SetNodeToRead(&aNodesToRead[1], UATEST_READ_STRINGNODEID,   OpcUa_Attributes_BrowseName);
+    UaTest_Read_SetNodeToRead(&aNodesToRead[2], UATEST_READ_STRINGNODEID,   OpcUa_Attributes_DisplayName);
+    UaTest_Read_SetNodeToRead(&aNodesToRead[3], UATEST_READ_STRINGNODEID,   OpcUa_Attributes_DataType);
+    UaTest_Read_SetNodeToRead(&aNodesToRead[4], UATEST_READ_STRINGNODEID,   OpcUa_Attributes_Value);
+    UaTest_Read_SetNodeToRead(&aNodesToRead[5], UATEST_READ_ARRAYNODEID,    OpcUa_Attributes_Value);
+    UaTest_Read_SetNodeToRead(&aNodesToRead[6], UATEST_READ_UNKNOWNNODEID,  OpcUa_Attributes_Value);
+
+    /* the second round finds what the first one borrowed still in place */
+    for(iRound = 0; iRound < 2; iRound++)
+    {
+        uStatus = UaTest_Read_Call(7, aNodesToRead, &nNoOfResults, &pResults);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        for(i = 0; i < 6; i++)
+        {
+            UATEST_CHECK(OpcUa_IsGood(pResults[i].StatusCode));
+        }
+        UATEST_CHECK(pResults[6].StatusCode == OpcUa_BadNodeIdUnknown);
+
+        UATEST_CHECK(pResults[0].Value.Datatype == OpcUaType_NodeId);
+        UATEST_CHECK(pResults[0].Value.Value.NodeId->NamespaceIndex == 2);
+        UATEST_CHECK(pResults[0].Value.Value.NodeId->Identifier.Numeric == UATEST_READ_STRINGNODEID);
+
+        UATEST_CHECK(pResults[1].Value.Datatype == OpcUaType_QualifiedName);
+        UATEST_CHECK(strcmp(OpcUa_String_GetRawString(&pResults[1].Value.Value.QualifiedName->Name), "UaTestString") == 0);
+
+        UATEST_CHECK(pResults[2].Value.Datatype == OpcUaType_LocalizedText);
+        UATEST_CHECK(strcmp(OpcUa_String_GetRawString(&pResults[2].Value.Value.LocalizedText->Text), "UaTest String") == 0);
+        UATEST_CHECK(strcmp(OpcUa_String_GetRawString(&pResults[2].Value.Value.LocalizedText->Locale), "en") == 0);
+
+        UATEST_CHECK(pResults[3].Value.Datatype == OpcUaType_NodeId);
+        UATEST_CHECK(pResults[3].Value.Value.NodeId->Identifier.Numeric == OpcUaId_String);
+
+        UATEST_CHECK(pResults[4].Value.Datatype == OpcUaType_String);
+        UATEST_CHECK(pResults[4].Value.ArrayType == OpcUa_VariantArrayType_Scalar);
+        UATEST_CHECK(strcmp(OpcUa_String_GetRawString(&pResults[4].Value.Value.String), "UaTestValue") == 0);
+
+        UATEST_CHECK(UaTest_Read_CheckArray(&pResults[5]));
+        UATEST_CHECK(pResults[5].Value.Value.Array.Value.DoubleArray[0] == 7);
+
+        UaTest_Read_ClearResults(&nNoOfResults, &pResults);
+    }
+
+    /* the response was deleted without taking anything of the nodes with it */
+    UATEST_CHECK(pTest->aVariables[0].BaseAttribute.NodeId.NamespaceIndex == 2);
+    UATEST_CHECK(pTest->aVariables[0].BaseAttribute.NodeId.Identifier.Numeric == UATEST_READ_STRINGNODEID);
+    UATEST_CHECK(pTest->aVariables[0].DataType.Identifier.Numeric == OpcUaId_String);
+    UATEST_CHECK(strcmp(pValues[UATEST_READ_STRINGINDEX].Value.String, "UaTestValue") == 0);
+    UATEST_CHECK(pValues[UATEST_READ_ARRAYINDEX].Value.Array.Value.DoubleArray == UaTest_g_aReadElements);
+    for(i = 0; i < UATEST_READ_ELEMENTS; i++)
+    {
+        UATEST_CHECK(UaTest_g_aReadElements[i] == 7);
+    }
+
+    UaTest_Read_Clear();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_Read_ClearResults(&nNoOfResults, &pResults);
+    UaTest_Read_Clear();
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Read_ConcurrentWrite
+ *===========================================================================*/
+/* every encoded array is one whole value while a writer changes it in place */
+static OpcUa_StatusCode UaTest_Read_ConcurrentWrite(OpcUa_Void)
+{
+    UaTest_Read*            pTest           = &UaTest_g_Read;
+    OpcUa_ReadValueId       NodeToRead;
+    OpcUa_Int32             nNoOfResults    = 0;
+    OpcUa_DataValue*        pResults        = OpcUa_Null;
+    OpcUa_Double            dFirst          = 0;
+    OpcUa_Double            dLast           = 0;
+    OpcUa_Int               i               = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Read_ConcurrentWrite");
+
+    uStatus = UaTest_Read_Open();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    UaTest_Read_SetNodeToRead(&NodeToRead, UATEST_READ_ARRAYNODEID, OpcUa_Attributes_Value);
+
+    uStatus = OpcUa_Thread_Create(&pTest->hWriter, UaTest_Read_Writer, pTest);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = OpcUa_Thread_Start(pTest->hWriter);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    for(i = 0; i < UATEST_READ_CONCURRENTREADS; i++)
+    {
+        uStatus = UaTest_Read_Call(1, &NodeToRead, &nNoOfResults, &pResults);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        UATEST_CHECK(UaTest_Read_CheckArray(&pResults[0]));
+        if(i == 0)
+        {
+            dFirst = pResults[0].Value.Value.Array.Value.DoubleArray[0];
+        }
+        dLast = pResults[0].Value.Value.Array.Value.DoubleArray[0];
+
+        UaTest_Read_ClearResults(&nNoOfResults, &pResults);
+    }
+
+    /* the reads saw the writer's progress */
+    UATEST_CHECK(dLast > dFirst);
+
+    UaTest_Read_Clear();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_Read_ClearResults(&nNoOfResults, &pResults);
+    UaTest_Read_Clear();
+
+OpcUa_FinishErrorHandling;
+}
+
+#endif /* OPCUA_HAVE_CLIENTAPI && OPCUA_HAVE_SERVERAPI && READ_ZERO_COPY */
+
+/*============================================================================
+ * Case table
+ *===========================================================================*/
+UaTest_Case UaTest_g_ReadCases[] =
+{
+#if defined(OPCUA_HAVE_CLIENTAPI) && defined(OPCUA_HAVE_SERVERAPI) && defined(READ_ZERO_COPY)
+    { "sample/read/borrowed",           UaTest_Read_Borrowed },
+    { "sample/read/concurrentwrite",    UaTest_Read_ConcurrentWrite },
+#endif /* OPCUA_HAVE_CLIENTAPI && OPCUA_HAVE_SERVERAPI && READ_ZERO_COPY */
+    UATEST_CASE_END
+};
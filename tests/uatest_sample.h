@@ -0,0 +1,43 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#ifndef _UaTest_Sample_H_
+#define _UaTest_Sample_H_ 1
+
+/*============================================================================
+ * State recorded by the replacements of ansicservermain.c.
+ *===========================================================================*/
+/** @brief Number of sessions whose subscriptions the session table ended. */
+extern OpcUa_UInt32 UaTest_g_uNoOfEndedSessions;
+/** @brief SessionId of the last of them. */
+extern OpcUa_UInt32 UaTest_g_uLastEndedSession;
+
+/*============================================================================
+ * subscriptionservice.c is built with its delete_session_subscriptions renamed to this.
+ *===========================================================================*/
+OpcUa_Void UaTest_Sample_DeleteSessionSubscriptions(OpcUa_UInt32        a_uSessionId,
+                                                    OpcUa_StatusCode    a_uStatus);
+
+/*============================================================================
+ * Helpers
+ *===========================================================================*/
+/** @brief Creates and activates a session of a_uTimeout milliseconds.
+ *  a_pRequestHeader carries its AuthenticationToken afterwards and must be cleared by the caller. */
+OpcUa_StatusCode UaTest_Sample_OpenSession( OpcUa_UInt32            a_uTimeout,
+                                            OpcUa_RequestHeader*    a_pRequestHeader,
+                                            OpcUa_UInt32*           a_puSessionId);
+
+#endif /* _UaTest_Sample_H_ */
@@ -0,0 +1,121 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+/******************************************************************************************************/
+/* The parts of ansicservermain.c the sample modules under test call back into, and shared helpers.  */
+/******************************************************************************************************/
+
+#include <opcua_serverstub.h>
+#include <opcua_string.h>
+
+#include "addressspace.h"
+#include "general_header.h"
+#include "sessiontable.h"
+#include "subscriptionservice.h"
+
+#include "uatest_sample.h"
+
+/*============================================================================
+ * Globals
+ *===========================================================================*/
+my_Variant      all_ValueAttribute_of_VariableTypeNodes_VariableNodes[ARRAYSIZE_OF_VALUEATTRIBUTE];
+
+OpcUa_UInt32    UaTest_g_uNoOfEndedSessions     = 0;
+OpcUa_UInt32    UaTest_g_uLastEndedSession      = 0;
+
+/*============================================================================
+ * check_useridentitytoken
+ *===========================================================================*/
+/* every session is anonymous */
+OpcUa_StatusCode check_useridentitytoken(   const OpcUa_ExtensionObject*    a_pUserIdentityToken,
+                                            OpcUa_String**                  a_ppUserName)
+{
+    OpcUa_ReferenceParameter(a_pUserIdentityToken);
+    OpcUa_ReferenceParameter(a_ppUserName);
+
+    return OpcUa_Good;
+}
+
+/*============================================================================
+ * username_free
+ *===========================================================================*/
+OpcUa_Void username_free(OpcUa_String** a_ppUserName)
+{
+    OpcUa_String_Delete(a_ppUserName);
+}
+
+/*============================================================================
+ * response_header_ausfuellen
+ *===========================================================================*/
+OpcUa_StatusCode response_header_ausfuellen(OpcUa_ResponseHeader*       a_pResponseHeader,
+                                            const OpcUa_RequestHeader*  a_pRequestHeader,
+                                            OpcUa_StatusCode            a_uServiceResult)
+{
+    OpcUa_ReturnErrorIfArgumentNull(a_pResponseHeader);
+    OpcUa_ReturnErrorIfArgumentNull(a_pRequestHeader);
+
+    OpcUa_ResponseHeader_Initialize(a_pResponseHeader);
+    a_pResponseHeader->RequestHandle = a_pRequestHeader->RequestHandle;
+    a_pResponseHeader->ServiceResult = a_uServiceResult;
+
+    return OpcUa_Good;
+}
+
+/*============================================================================
+ * delete_session_subscriptions
+ *===========================================================================*/
+/* records the sessions the session table ends and ends their subscriptions */
+OpcUa_Void delete_session_subscriptions(OpcUa_UInt32        a_uSessionId,
+                                        OpcUa_StatusCode    a_uStatus)
+{
+    UaTest_g_uNoOfEndedSessions++;
+    UaTest_g_uLastEndedSession = a_uSessionId;
+
+    UaTest_Sample_DeleteSessionSubscriptions(a_uSessionId, a_uStatus);
+}
+
+/*============================================================================
+ * UaTest_Sample_OpenSession
+ *===========================================================================*/
+/* creates and activates a session; a_pRequestHeader carries its token afterwards */
+OpcUa_StatusCode UaTest_Sample_OpenSession(   OpcUa_UInt32            a_uTimeout,
+                                              OpcUa_RequestHeader*    a_pRequestHeader,
+                                              OpcUa_UInt32*           a_puSessionId)
+{
+    OpcUa_NodeId            SessionId;
+    OpcUa_ExtensionObject   UserIdentityToken;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Sample_OpenSession");
+
+    OpcUa_NodeId_Initialize(&SessionId);
+    OpcUa_ExtensionObject_Initialize(&UserIdentityToken);
+    OpcUa_RequestHeader_Initialize(a_pRequestHeader);
+
+    uStatus = create_session(1, a_uTimeout, &SessionId, &a_pRequestHeader->AuthenticationToken);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = activate_session(a_pRequestHeader, 1, &UserIdentityToken);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    *a_puSessionId = SessionId.Identifier.Numeric;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_RequestHeader_Clear(a_pRequestHeader);
+
+OpcUa_FinishErrorHandling;
+}
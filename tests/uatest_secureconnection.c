@@ -0,0 +1,574 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+
+/******************************************************************************************************/
+/* Tests for the client side of the secure channel: the renew timer is spread over a part of the     */
+/* token lifetime, and renewals work with the server thumbprint computed at connect.                 */
+/******************************************************************************************************/
+
+#include <opcua_serverstub.h>
+#include <opcua_memory.h>
+#include <opcua_string.h>
+#include <opcua_thread.h>
+#include <opcua_core.h>
+
+#include "uatest.h"
+
+#ifdef OPCUA_HAVE_CLIENTAPI
+
+#include <opcua_clientproxy.h>
+#include <opcua_binaryencoder.h>
+#include <opcua_secureconnection.h>
+#include <opcua_channel_internal.h>
+
+#include <stdio.h>
+#include <string.h>
+
+/*============================================================================
+ * Types and constants
+ *===========================================================================*/
+/** @brief Channels whose renew intervals the jitter test computes. */
+#define UATEST_RENEW_CHANNELS           1000
+/** @brief Parts of the jitter range each of which some channel has to renew in. */
+#define UATEST_RENEW_BUCKETS            10
+
+#if defined(OPCUA_HAVE_SERVERAPI) && OPCUA_HAVE_OPENSSL
+
+#include <opcua_timer.h>
+#include <opcua_p_types.h>
+
+#include <openssl/evp.h>
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+
+/** @brief First port tried for the endpoint; the next ones are tried if it is taken. */
+#define UATEST_RENEW_PORT               48860
+#define UATEST_RENEW_NOOFPORTS          10
+/** @brief Timeout of the channel and of the wait for a renewed token. */
+#define UATEST_RENEW_TIMEOUT            10000
+/** @brief Token lifetime the client asks for; the renewals are started by the test. */
+#define UATEST_RENEW_LIFETIME           600000
+/** @brief Renewals the test starts one after another. */
+#define UATEST_RENEW_COUNT              3
+
+/** @brief A DER encoded certificate and its private key. */
+typedef struct _UaTest_RenewCredentials
+{
+    OpcUa_ByteString                                Certificate;
+    OpcUa_Key                                       Key;
+} UaTest_RenewCredentials;
+
+typedef struct _UaTest_Renew
+{
+    OpcUa_Endpoint                                  hEndpoint;
+    OpcUa_Channel                                   hChannel;
+    OpcUa_ServiceType                               FindServersType;
+    OpcUa_ServiceType*                              apServices[2];
+    /** @brief Both sides accept any certificate. */
+    OpcUa_P_OpenSSL_CertificateStore_Config         PkiConfig;
+    OpcUa_PKIProvider                               PkiOverride;
+    UaTest_RenewCredentials                         Server;
+    UaTest_RenewCredentials                         Client;
+    OpcUa_Endpoint_SecurityPolicyConfiguration      Policy;
+    OpcUa_CharA                                     sUrl[64];
+    OpcUa_UInt32                                    uNoOfInvokes;
+} UaTest_Renew;
+
+static UaTest_Renew UaTest_g_Renew;
+
+/* not exported; the test starts the renewals instead of waiting for the timer */
+extern OpcUa_StatusCode OPCUA_DLLCALL OpcUa_SecureConnection_RenewTimerCallback(OpcUa_Void*     a_pvCallbackData,
+                                                                                OpcUa_Timer     a_hTimer,
+                                                                                OpcUa_UInt32    a_msecElapsed);
+
+#endif /* OPCUA_HAVE_SERVERAPI && OPCUA_HAVE_OPENSSL */
+
+#if OPCUA_SECURECONNECTION_RENEW_JITTER
+/*============================================================================
+ * UaTest_Renew_Interval
+ *===========================================================================*/
+/* channels renew within the jitter range before 75% of the lifetime, spread over all of it */
+static OpcUa_StatusCode UaTest_Renew_Interval(OpcUa_Void)
+{
+    static const OpcUa_UInt32 auLifetimes[] = { OPCUA_SECURITYTOKEN_LIFETIME_MIN, OPCUA_SECURITYTOKEN_LIFETIME_MAX };
+    OpcUa_UInt32    auBuckets[UATEST_RENEW_BUCKETS];
+    OpcUa_UInt32    uLatest     = 0;
+    OpcUa_UInt32    uJitter     = 0;
+    OpcUa_UInt32    uInterval   = 0;
+    OpcUa_UInt32    uChannelId  = 0;
+    OpcUa_UInt32    i           = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Renew_Interval");
+
+    for(i = 0; i < sizeof(auLifetimes) / sizeof(auLifetimes[0]); i++)
+    {
+        uLatest = (OpcUa_UInt32)(auLifetimes[i] * 0.75);
+        uJitter = (auLifetimes[i] / 100) * OPCUA_SECURECONNECTION_RENEW_JITTER;
+        memset(auBuckets, 0, sizeof(auBuckets));
+
+        for(uChannelId = 1; uChannelId <= UATEST_RENEW_CHANNELS; uChannelId++)
+        {
+            uInterval = OpcUa_SecureConnection_GetRenewInterval(uChannelId, auLifetimes[i]);
+            UATEST_CHECK(uInterval <= uLatest);
+            UATEST_CHECK(uInterval > uLatest - uJitter);
+            auBuckets[((uLatest - uInterval) * UATEST_RENEW_BUCKETS) / uJitter]++;
+        }
+
+        for(uChannelId = 0; uChannelId < UATEST_RENEW_BUCKETS; uChannelId++)
+        {
+            UATEST_CHECK(auBuckets[uChannelId] > 0);
+        }
+    }
+
+    /* too short a lifetime has no room for jitter */
+    UATEST_CHECK(OpcUa_SecureConnection_GetRenewInterval(1, 99) == 74);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+#endif /* OPCUA_SECURECONNECTION_RENEW_JITTER */
+
+#if defined(OPCUA_HAVE_SERVERAPI) && OPCUA_HAVE_OPENSSL
+/*============================================================================
+ * UaTest_Renew_CreateCredentials
+ *===========================================================================*/
+/* a self-signed RSA certificate */
+static OpcUa_StatusCode UaTest_Renew_CreateCredentials( const char*                 a_sName,
+                                                        UaTest_RenewCredentials*    a_pCredentials)
+{
+    EVP_PKEY_CTX*   pContext        = OpcUa_Null;
+    EVP_PKEY*       pKey            = OpcUa_Null;
+    X509*           pCertificate    = OpcUa_Null;
+    X509_NAME*      pName           = OpcUa_Null;
+    OpcUa_Byte*     pData           = OpcUa_Null;
+    int             iLength         = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Renew_CreateCredentials");
+
+    pContext = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, OpcUa_Null);
+    OpcUa_GotoErrorIfAllocFailed(pContext);
+    OpcUa_GotoErrorIfTrue(EVP_PKEY_keygen_init(pContext) <= 0, OpcUa_BadInternalError);
+    OpcUa_GotoErrorIfTrue(EVP_PKEY_CTX_set_rsa_keygen_bits(pContext, 2048) <= 0, OpcUa_BadInternalError);
+    OpcUa_GotoErrorIfTrue(EVP_PKEY_keygen(pContext, &pKey) <= 0, OpcUa_BadInternalError);
+
+    pCertificate = X509_new();
+    OpcUa_GotoErrorIfAllocFailed(pCertificate);
+    X509_set_version(pCertificate, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(pCertificate), 1);
+    X509_gmtime_adj(X509_getm_notBefore(pCertificate), 0);
+    X509_gmtime_adj(X509_getm_notAfter(pCertificate), 3600);
+    X509_set_pubkey(pCertificate, pKey);
+    pName = X509_get_subject_name(pCertificate);
+    X509_NAME_add_entry_by_txt(pName, "CN", MBSTRING_ASC, (const unsigned char*)a_sName, -1, -1, 0);
+    X509_set_issuer_name(pCertificate, pName);
+    OpcUa_GotoErrorIfTrue(X509_sign(pCertificate, pKey, EVP_sha256()) <= 0, OpcUa_BadInternalError);
+
+    iLength = i2d_X509(pCertificate, OpcUa_Null);
+    OpcUa_GotoErrorIfTrue(iLength <= 0, OpcUa_BadInternalError);
+    a_pCredentials->Certificate.Data = (OpcUa_Byte*)OpcUa_Alloc((OpcUa_UInt32)iLength);
+    OpcUa_GotoErrorIfAllocFailed(a_pCredentials->Certificate.Data);
+    pData = a_pCredentials->Certificate.Data;
+    a_pCredentials->Certificate.Length = i2d_X509(pCertificate, &pData);
+
+    iLength = i2d_PrivateKey(pKey, OpcUa_Null);
+    OpcUa_GotoErrorIfTrue(iLength <= 0, OpcUa_BadInternalError);
+    a_pCredentials->Key.Type = OpcUa_Crypto_KeyType_Rsa_Private;
+    a_pCredentials->Key.Key.Data = (OpcUa_Byte*)OpcUa_Alloc((OpcUa_UInt32)iLength);
+    OpcUa_GotoErrorIfAllocFailed(a_pCredentials->Key.Key.Data);
+    pData = a_pCredentials->Key.Key.Data;
+    a_pCredentials->Key.Key.Length = i2d_PrivateKey(pKey, &pData);
+
+    X509_free(pCertificate);
+    EVP_PKEY_free(pKey);
+    EVP_PKEY_CTX_free(pContext);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    if(pCertificate != OpcUa_Null)
+    {
+        X509_free(pCertificate);
+    }
+    if(pKey != OpcUa_Null)
+    {
+        EVP_PKEY_free(pKey);
+    }
+    EVP_PKEY_CTX_free(pContext);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * PKI, endpoint and channel callbacks
+ *===========================================================================*/
+static OpcUa_StatusCode UaTest_Renew_OpenCertificateStore(  OpcUa_PKIProvider*  a_pProvider,
+                                                            OpcUa_Void**        a_ppCertificateStore)
+{
+    OpcUa_ReferenceParameter(a_pProvider);
+    *a_ppCertificateStore = (OpcUa_Void*)&UaTest_g_Renew;
+    return OpcUa_Good;
+}
+
+static OpcUa_StatusCode UaTest_Renew_CloseCertificateStore( OpcUa_PKIProvider*  a_pProvider,
+                                                            OpcUa_Void**        a_ppCertificateStore)
+{
+    OpcUa_ReferenceParameter(a_pProvider);
+    *a_ppCertificateStore = OpcUa_Null;
+    return OpcUa_Good;
+}
+
+static OpcUa_StatusCode UaTest_Renew_ValidateCertificate(   OpcUa_PKIProvider*  a_pProvider,
+                                                            OpcUa_ByteString*   a_pCertificate,
+                                                            OpcUa_Void*         a_pCertificateStore,
+                                                            OpcUa_Int*          a_pValidationCode)
+{
+    OpcUa_ReferenceParameter(a_pProvider);
+    OpcUa_ReferenceParameter(a_pCertificate);
+    OpcUa_ReferenceParameter(a_pCertificateStore);
+    *a_pValidationCode = X509_V_OK;
+    return OpcUa_Good;
+}
+
+static OpcUa_StatusCode UaTest_Renew_OnEndpoint(
+    OpcUa_Endpoint          a_hEndpoint,
+    OpcUa_Void*             a_pvCallbackData,
+    OpcUa_Endpoint_Event    a_eEvent,
+    OpcUa_StatusCode        a_uStatus,
+    OpcUa_UInt32            a_uSecureChannelId,
+    OpcUa_ByteString*       a_pbsClientCertificate,
+    OpcUa_String*           a_pSecurityPolicy,
+    OpcUa_UInt16            a_uSecurityMode)
+{
+    OpcUa_ReferenceParameter(a_hEndpoint);
+    OpcUa_ReferenceParameter(a_pvCallbackData);
+    OpcUa_ReferenceParameter(a_eEvent);
+    OpcUa_ReferenceParameter(a_uStatus);
+    OpcUa_ReferenceParameter(a_uSecureChannelId);
+    OpcUa_ReferenceParameter(a_pbsClientCertificate);
+    OpcUa_ReferenceParameter(a_pSecurityPolicy);
+    OpcUa_ReferenceParameter(a_uSecurityMode);
+
+    return OpcUa_Good;
+}
+
+static OpcUa_StatusCode UaTest_Renew_OnChannel(
+    OpcUa_Channel       a_hChannel,
+    OpcUa_Void*         a_pCallbackData,
+    OpcUa_Channel_Event a_eEvent,
+    OpcUa_StatusCode    a_uStatus)
+{
+    OpcUa_ReferenceParameter(a_hChannel);
+    OpcUa_ReferenceParameter(a_pCallbackData);
+    OpcUa_ReferenceParameter(a_eEvent);
+    OpcUa_ReferenceParameter(a_uStatus);
+
+    return OpcUa_Good;
+}
+
+/*============================================================================
+ * UaTest_Renew_FindServers
+ *===========================================================================*/
+/* answers with no servers; the test only needs a request that goes through */
+static OpcUa_StatusCode UaTest_Renew_FindServers(
+    OpcUa_Endpoint                 a_hEndpoint,
+    OpcUa_Handle                   a_hContext,
+    const OpcUa_RequestHeader*     a_pRequestHeader,
+    const OpcUa_String*            a_pEndpointUrl,
+    OpcUa_Int32                    a_nNoOfLocaleIds,
+    const OpcUa_String*            a_pLocaleIds,
+    OpcUa_Int32                    a_nNoOfServerUris,
+    const OpcUa_String*            a_pServerUris,
+    OpcUa_ResponseHeader*          a_pResponseHeader,
+    OpcUa_Int32*                   a_pNoOfServers,
+    OpcUa_ApplicationDescription** a_pServers)
+{
+    OpcUa_ReferenceParameter(a_hEndpoint);
+    OpcUa_ReferenceParameter(a_hContext);
+    OpcUa_ReferenceParameter(a_pEndpointUrl);
+    OpcUa_ReferenceParameter(a_nNoOfLocaleIds);
+    OpcUa_ReferenceParameter(a_pLocaleIds);
+    OpcUa_ReferenceParameter(a_nNoOfServerUris);
+    OpcUa_ReferenceParameter(a_pServerUris);
+
+    UaTest_g_Renew.uNoOfInvokes++;
+
+    a_pResponseHeader->RequestHandle = a_pRequestHeader->RequestHandle;
+    a_pResponseHeader->Timestamp     = OpcUa_DateTime_UtcNow();
+    a_pResponseHeader->ServiceResult = OpcUa_Good;
+
+    *a_pNoOfServers = 0;
+    *a_pServers     = OpcUa_Null;
+
+    return OpcUa_Good;
+}
+
+/*============================================================================
+ * UaTest_Renew_Clear
+ *===========================================================================*/
+static OpcUa_Void UaTest_Renew_Clear(OpcUa_Void)
+{
+    UaTest_Renew* pTest = &UaTest_g_Renew;
+
+    if(pTest->hChannel != OpcUa_Null)
+    {
+        OpcUa_Channel_Disconnect(pTest->hChannel);
+        OpcUa_Channel_Delete(&pTest->hChannel);
+    }
+    if(pTest->hEndpoint != OpcUa_Null)
+    {
+        OpcUa_Endpoint_Close(pTest->hEndpoint);
+        OpcUa_Endpoint_Delete(&pTest->hEndpoint);
+    }
+    OpcUa_ByteString_Clear(&pTest->Server.Certificate);
+    OpcUa_Key_Clear(&pTest->Server.Key);
+    OpcUa_ByteString_Clear(&pTest->Client.Certificate);
+    OpcUa_Key_Clear(&pTest->Client.Key);
+    OpcUa_MemSet(pTest, 0, sizeof(UaTest_Renew));
+}
+
+/*============================================================================
+ * UaTest_Renew_Open
+ *===========================================================================*/
+/* an endpoint for FindServers and a channel connected to it, both with Basic256Sha256 SignAndEncrypt */
+static OpcUa_StatusCode UaTest_Renew_Open(OpcUa_Void)
+{
+    UaTest_Renew*   pTest   = &UaTest_g_Renew;
+    OpcUa_String    sPolicy;
+    OpcUa_UInt32    i       = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Renew_Open");
+
+    OpcUa_MemSet(pTest, 0, sizeof(UaTest_Renew));
+    OpcUa_String_Initialize(&sPolicy);
+
+    uStatus = UaTest_Renew_CreateCredentials("UaTest Server", &pTest->Server);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_Renew_CreateCredentials("UaTest Client", &pTest->Client);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    pTest->PkiOverride.OpenCertificateStore     = UaTest_Renew_OpenCertificateStore;
+    pTest->PkiOverride.CloseCertificateStore    = UaTest_Renew_CloseCertificateStore;
+    pTest->PkiOverride.ValidateCertificate      = UaTest_Renew_ValidateCertificate;
+    pTest->PkiConfig.PkiType                    = OpcUa_Override;
+    pTest->PkiConfig.Override                   = &pTest->PkiOverride;
+
+    OpcUa_String_AttachReadOnly(&pTest->Policy.sSecurityPolicy, OpcUa_SecurityPolicy_Basic256Sha256);
+    pTest->Policy.uMessageSecurityModes = OPCUA_ENDPOINT_MESSAGESECURITYMODE_SIGNANDENCRYPT;
+
+    pTest->FindServersType.RequestTypeId = OpcUaId_FindServersRequest;
+    pTest->FindServersType.ResponseType  = &OpcUa_FindServersResponse_EncodeableType;
+    pTest->FindServersType.BeginInvoke   = OpcUa_Server_BeginFindServers;
+    pTest->FindServersType.Invoke        = (OpcUa_PfnInvokeService*)UaTest_Renew_FindServers;
+    pTest->apServices[0] = &pTest->FindServersType;
+    pTest->apServices[1] = OpcUa_Null;
+
+    uStatus = OpcUa_Endpoint_Create(&pTest->hEndpoint, OpcUa_Endpoint_SerializerType_Binary, pTest->apServices);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* a port another process holds does not fail the test */
+    for(i = 0; i < UATEST_RENEW_NOOFPORTS; i++)
+    {
+        OpcUa_SnPrintfA(pTest->sUrl, sizeof(pTest->sUrl), "opc.tcp://localhost:%u", (unsigned int)(UATEST_RENEW_PORT + i));
+        uStatus = OpcUa_Endpoint_Open(  pTest->hEndpoint,
+                                        pTest->sUrl,
+                                        OpcUa_False,
+                                        UaTest_Renew_OnEndpoint,
+                                        OpcUa_Null,
+                                        &pTest->Server.Certificate,
+                                        &pTest->Server.Key,
+                                        &pTest->PkiConfig,
+                                        1,
+                                        &pTest->Policy);
+        if(OpcUa_IsGood(uStatus))
+        {
+            break;
+        }
+    }
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = OpcUa_Channel_Create(&pTest->hChannel, OpcUa_Channel_SerializerType_Binary);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    OpcUa_String_AttachReadOnly(&sPolicy, OpcUa_SecurityPolicy_Basic256Sha256);
+    uStatus = OpcUa_Channel_Connect(pTest->hChannel,
+                                    pTest->sUrl,
+                                    UaTest_Renew_OnChannel,
+                                    OpcUa_Null,
+                                    &pTest->Client.Certificate,
+                                    &pTest->Client.Key,
+                                    &pTest->Server.Certificate,
+                                    &pTest->PkiConfig,
+                                    &sPolicy,
+                                    UATEST_RENEW_LIFETIME,
+                                    OpcUa_MessageSecurityMode_SignAndEncrypt,
+                                    UATEST_RENEW_TIMEOUT);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Renew_Call
+ *===========================================================================*/
+/* calls FindServers and checks that the service ran */
+static OpcUa_StatusCode UaTest_Renew_Call(OpcUa_Void)
+{
+    UaTest_Renew*                   pTest           = &UaTest_g_Renew;
+    OpcUa_RequestHeader             RequestHeader;
+    OpcUa_ResponseHeader            ResponseHeader;
+    OpcUa_String                    sEndpointUrl;
+    OpcUa_Int32                     nNoOfServers    = 0;
+    OpcUa_ApplicationDescription*   pServers        = OpcUa_Null;
+    OpcUa_UInt32                    uNoOfInvokes    = pTest->uNoOfInvokes;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Renew_Call");
+
+    OpcUa_RequestHeader_Initialize(&RequestHeader);
+    OpcUa_ResponseHeader_Initialize(&ResponseHeader);
+    OpcUa_String_Initialize(&sEndpointUrl);
+
+    RequestHeader.Timestamp     = OpcUa_DateTime_UtcNow();
+    RequestHeader.RequestHandle = uNoOfInvokes + 1;
+    RequestHeader.TimeoutHint   = UATEST_RENEW_TIMEOUT;
+    OpcUa_String_AttachReadOnly(&sEndpointUrl, pTest->sUrl);
+
+    uStatus = OpcUa_ClientApi_FindServers(  pTest->hChannel,
+                                            &RequestHeader,
+                                            &sEndpointUrl,
+                                            0,
+                                            OpcUa_Null,
+                                            0,
+                                            OpcUa_Null,
+                                            &ResponseHeader,
+                                            &nNoOfServers,
+                                            &pServers);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(ResponseHeader.ServiceResult == OpcUa_Good);
+    UATEST_CHECK(ResponseHeader.RequestHandle == uNoOfInvokes + 1);
+    UATEST_CHECK(pTest->uNoOfInvokes == uNoOfInvokes + 1);
+
+    OpcUa_ResponseHeader_Clear(&ResponseHeader);
+    OpcUa_RequestHeader_Clear(&RequestHeader);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_ResponseHeader_Clear(&ResponseHeader);
+    OpcUa_RequestHeader_Clear(&RequestHeader);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Renew_WaitForToken
+ *===========================================================================*/
+/* waits until the client has switched away from the given token */
+static OpcUa_Boolean UaTest_Renew_WaitForToken( OpcUa_Connection*   a_pConnection,
+                                                OpcUa_UInt32        a_uTokenId,
+                                                OpcUa_UInt32*       a_puNewTokenId)
+{
+    OpcUa_UInt32 uWaited = 0;
+
+    *a_puNewTokenId = a_uTokenId;
+
+    while(*a_puNewTokenId == a_uTokenId)
+    {
+        if(    uWaited >= UATEST_RENEW_TIMEOUT
+            || OpcUa_IsBad(OpcUa_SecureConnection_GetCurrentTokenId(a_pConnection, a_puNewTokenId)))
+        {
+            return OpcUa_False;
+        }
+        OpcUa_Thread_Sleep(10);
+        uWaited += 10;
+    }
+    return OpcUa_True;
+}
+
+/*============================================================================
+ * UaTest_Renew_Tokens
+ *===========================================================================*/
+/* every renewal sends the thumbprint kept from the connect; the server takes it and the new token works */
+static OpcUa_StatusCode UaTest_Renew_Tokens(OpcUa_Void)
+{
+    OpcUa_Connection*   pConnection = OpcUa_Null;
+    OpcUa_UInt32        uChannelId  = 0;
+    OpcUa_UInt32        uTokenId    = 0;
+    OpcUa_UInt32        uNewTokenId = 0;
+    OpcUa_UInt32        uNewChannel = 0;
+    OpcUa_UInt32        i           = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Renew_Tokens");
+
+    uStatus = UaTest_Renew_Open();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    pConnection = ((OpcUa_InternalChannel*)UaTest_g_Renew.hChannel)->SecureConnection;
+    uStatus = OpcUa_SecureConnection_GetChannelId(pConnection, &uChannelId);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = OpcUa_SecureConnection_GetCurrentTokenId(pConnection, &uTokenId);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = UaTest_Renew_Call();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    for(i = 0; i < UATEST_RENEW_COUNT; i++)
+    {
+        uStatus = OpcUa_SecureConnection_RenewTimerCallback(pConnection, OpcUa_Null, 0);
+        OpcUa_GotoErrorIfBad(uStatus);
+
+        UATEST_CHECK(UaTest_Renew_WaitForToken(pConnection, uTokenId, &uNewTokenId));
+        uStatus = OpcUa_SecureConnection_GetChannelId(pConnection, &uNewChannel);
+        OpcUa_GotoErrorIfBad(uStatus);
+        UATEST_CHECK(uNewChannel == uChannelId);
+        uTokenId = uNewTokenId;
+
+        /* the first request under the new token makes the server switch too */
+        uStatus = UaTest_Renew_Call();
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+    UaTest_Renew_Clear();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_Renew_Clear();
+
+OpcUa_FinishErrorHandling;
+}
+#endif /* OPCUA_HAVE_SERVERAPI && OPCUA_HAVE_OPENSSL */
+
+#endif /* OPCUA_HAVE_CLIENTAPI */
+
+/*============================================================================
+ * Case table
+ *===========================================================================*/
+UaTest_Case UaTest_g_SecureConnectionCases[] =
+{
+#ifdef OPCUA_HAVE_CLIENTAPI
+#if OPCUA_SECURECONNECTION_RENEW_JITTER
+    { "stack/secureconnection/renew/interval",  UaTest_Renew_Interval },
+#endif /* OPCUA_SECURECONNECTION_RENEW_JITTER */
+#if defined(OPCUA_HAVE_SERVERAPI) && OPCUA_HAVE_OPENSSL
+    { "stack/secureconnection/renew/tokens",    UaTest_Renew_Tokens },
+#endif /* OPCUA_HAVE_SERVERAPI && OPCUA_HAVE_OPENSSL */
+#endif /* OPCUA_HAVE_CLIENTAPI */
+    UATEST_CASE_END
+};
@@ -0,0 +1,506 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+
+/******************************************************************************************************/
+/* Tests for the secure listener: OpenSecureChannel requests handed to the crypto pool.              */
+/******************************************************************************************************/
+
+#include <opcua_serverstub.h>
+#include <opcua_memory.h>
+#include <opcua_string.h>
+#include <opcua_thread.h>
+#include <opcua_listener.h>
+
+#include "uatest.h"
+
+#ifdef OPCUA_HAVE_THREADPOOL
+
+#include <opcua_binaryencoder.h>
+#include <opcua_tcplistener.h>
+#include <opcua_securelistener.h>
+
+#include <openssl/bio.h>
+
+#include <stdio.h>
+#include <string.h>
+
+extern OpcUa_StringTable OpcUa_ProxyStub_g_NamespaceUris;
+
+/*============================================================================
+ * Types and constants
+ *===========================================================================*/
+/** @brief First port tried for the listener; the next ones are tried if it is taken. */
+#define UATEST_CRYPTO_PORT              48840
+#define UATEST_CRYPTO_NOOFPORTS         10
+/** @brief How long the test waits for the worker. */
+#define UATEST_CRYPTO_TIMEOUT           10000
+/** @brief How long the listener gets to pick up what the client did. */
+#define UATEST_CRYPTO_SETTLETIME        300
+/** @brief Upper bound of a message the client reads. */
+#define UATEST_CRYPTO_MAXMESSAGE        8192
+/** @brief Stands in for the server certificate and key. */
+#define UATEST_CRYPTO_NOCREDENTIALS     "UaTest"
+
+typedef struct _UaTest_Crypto
+{
+    OpcUa_Listener*                                     pTransportListener;
+    OpcUa_Listener*                                     pSecureListener;
+    OpcUa_Encoder*                                      pEncoder;
+    OpcUa_Decoder*                                      pDecoder;
+    OpcUa_P_OpenSSL_CertificateStore_Config             PkiConfig;
+    /** @brief Required by the listener but unused by the None policy. */
+    OpcUa_ByteString                                    Certificate;
+    OpcUa_Key                                           Key;
+    OpcUa_SecureListener_SecurityPolicyConfiguration    Policy;
+    /** @brief The stack types, with the request decode of OpenSecureChannel wrapped. */
+    OpcUa_EncodeableType                                OpenRequestType;
+    OpcUa_EncodeableType*                               apTypes[3];
+    OpcUa_EncodeableTypeTable                           KnownTypes;
+    OpcUa_CharA                                         sHost[32];
+    OpcUa_CharA                                         sUrl[64];
+    /** @brief Set by the worker while it holds the first request. */
+    OpcUa_UInt32                                        uBlocked;
+    /** @brief Set by the test to let the worker go on. */
+    OpcUa_UInt32                                        uRelease;
+    OpcUa_UInt32                                        uNoOfDecoded;
+} UaTest_Crypto;
+
+static UaTest_Crypto        UaTest_g_Crypto;
+
+/*============================================================================
+ * UaTest_Crypto_DecodeOpenRequest
+ *===========================================================================*/
+/* runs in the crypto worker; the first request keeps the only worker busy */
+static OpcUa_StatusCode UaTest_Crypto_DecodeOpenRequest(OpcUa_Void*             a_pValue,
+                                                        struct _OpcUa_Decoder*  a_pDecoder)
+{
+    UaTest_Crypto*  pCrypto = &UaTest_g_Crypto;
+    OpcUa_UInt32    uWaited = 0;
+
+    if(OpcUa_Atomic_Add32(&pCrypto->uNoOfDecoded, 1) == 1)
+    {
+        OpcUa_Atomic_Store32(&pCrypto->uBlocked, 1);
+        while(OpcUa_Atomic_Load32(&pCrypto->uRelease) == 0 && uWaited < UATEST_CRYPTO_TIMEOUT)
+        {
+            OpcUa_Thread_Sleep(10);
+            uWaited += 10;
+        }
+    }
+
+    return OpcUa_OpenSecureChannelRequest_EncodeableType.Decode(a_pValue, a_pDecoder);
+}
+
+/*============================================================================
+ * UaTest_Crypto_OnNotify
+ *===========================================================================*/
+/* no client gets beyond OpenSecureChannel */
+static OpcUa_StatusCode UaTest_Crypto_OnNotify( OpcUa_Listener*         a_pListener,
+                                                OpcUa_Void*             a_pCallbackData,
+                                                OpcUa_ListenerEvent     a_eEvent,
+                                                OpcUa_Handle            a_hConnection,
+                                                OpcUa_InputStream**     a_ppInputStream,
+                                                OpcUa_StatusCode        a_uOperationStatus)
+{
+    OpcUa_ReferenceParameter(a_pListener);
+    OpcUa_ReferenceParameter(a_pCallbackData);
+    OpcUa_ReferenceParameter(a_eEvent);
+    OpcUa_ReferenceParameter(a_hConnection);
+    OpcUa_ReferenceParameter(a_ppInputStream);
+    OpcUa_ReferenceParameter(a_uOperationStatus);
+    return OpcUa_Good;
+}
+
+/*============================================================================
+ * Message helpers
+ *===========================================================================*/
+static int UaTest_Crypto_PutUInt32(unsigned char* a_pBuffer, int a_iOffset, OpcUa_UInt32 a_uValue)
+{
+    a_pBuffer[a_iOffset]     = (unsigned char)(a_uValue & 0xFF);
+    a_pBuffer[a_iOffset + 1] = (unsigned char)((a_uValue >> 8) & 0xFF);
+    a_pBuffer[a_iOffset + 2] = (unsigned char)((a_uValue >> 16) & 0xFF);
+    a_pBuffer[a_iOffset + 3] = (unsigned char)((a_uValue >> 24) & 0xFF);
+    return a_iOffset + 4;
+}
+
+static OpcUa_UInt32 UaTest_Crypto_GetUInt32(const unsigned char* a_pBuffer)
+{
+    return (OpcUa_UInt32)a_pBuffer[0]
+        | ((OpcUa_UInt32)a_pBuffer[1] << 8)
+        | ((OpcUa_UInt32)a_pBuffer[2] << 16)
+        | ((OpcUa_UInt32)a_pBuffer[3] << 24);
+}
+
+/* a null string or byte string is encoded with length -1 */
+static int UaTest_Crypto_PutString(unsigned char* a_pBuffer, int a_iOffset, const char* a_sValue)
+{
+    int iLength = (a_sValue == OpcUa_Null)? -1 : (int)strlen(a_sValue);
+
+    a_iOffset = UaTest_Crypto_PutUInt32(a_pBuffer, a_iOffset, (OpcUa_UInt32)iLength);
+    if(iLength > 0)
+    {
+        memcpy(a_pBuffer + a_iOffset, a_sValue, (size_t)iLength);
+        a_iOffset += iLength;
+    }
+    return a_iOffset;
+}
+
+/*============================================================================
+ * UaTest_Crypto_ReadMessage
+ *===========================================================================*/
+/* reads one message; OpcUa_False on a closed connection or an oversized message */
+static OpcUa_Boolean UaTest_Crypto_ReadMessage( BIO*            a_pClient,
+                                                unsigned char*  a_pMessage,
+                                                OpcUa_UInt32*   a_puLength)
+{
+    int             iUsed   = 0;
+    int             iRead   = 0;
+    OpcUa_UInt32    uLength = 8;
+
+    while((OpcUa_UInt32)iUsed < uLength)
+    {
+        iRead = BIO_read(a_pClient, a_pMessage + iUsed, (int)uLength - iUsed);
+        if(iRead <= 0)
+        {
+            return OpcUa_False;
+        }
+        iUsed += iRead;
+
+        if(iUsed == 8 && uLength == 8)
+        {
+            uLength = UaTest_Crypto_GetUInt32(a_pMessage + 4);
+            if(uLength < 8 || uLength > UATEST_CRYPTO_MAXMESSAGE)
+            {
+                return OpcUa_False;
+            }
+        }
+    }
+
+    *a_puLength = uLength;
+    return OpcUa_True;
+}
+
+/*============================================================================
+ * UaTest_Crypto_Connect
+ *===========================================================================*/
+/* connects a client and completes the transport handshake */
+static OpcUa_StatusCode UaTest_Crypto_Connect(BIO** a_ppClient)
+{
+    unsigned char   aMessage[UATEST_CRYPTO_MAXMESSAGE];
+    OpcUa_UInt32    uLength = 0;
+    int             iUsed   = 8;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Crypto_Connect");
+
+    *a_ppClient = BIO_new_connect(UaTest_g_Crypto.sHost);
+    OpcUa_GotoErrorIfAllocFailed(*a_ppClient);
+    OpcUa_GotoErrorIfTrue(BIO_do_connect(*a_ppClient) <= 0, OpcUa_BadConnectionRejected);
+
+    memcpy(aMessage, "HELF", 4);
+    iUsed = UaTest_Crypto_PutUInt32(aMessage, iUsed, 0);        /* ProtocolVersion */
+    iUsed = UaTest_Crypto_PutUInt32(aMessage, iUsed, 65536);    /* ReceiveBufferSize */
+    iUsed = UaTest_Crypto_PutUInt32(aMessage, iUsed, 65536);    /* SendBufferSize */
+    iUsed = UaTest_Crypto_PutUInt32(aMessage, iUsed, 0);        /* MaxMessageSize */
+    iUsed = UaTest_Crypto_PutUInt32(aMessage, iUsed, 0);        /* MaxChunkCount */
+    iUsed = UaTest_Crypto_PutString(aMessage, iUsed, UaTest_g_Crypto.sUrl);
+    UaTest_Crypto_PutUInt32(aMessage, 4, (OpcUa_UInt32)iUsed);
+
+    OpcUa_GotoErrorIfTrue(BIO_write(*a_ppClient, aMessage, iUsed) != iUsed, OpcUa_BadCommunicationError);
+    OpcUa_GotoErrorIfTrue(UaTest_Crypto_ReadMessage(*a_ppClient, aMessage, &uLength) == OpcUa_False, OpcUa_BadCommunicationError);
+    OpcUa_GotoErrorIfTrue(memcmp(aMessage, "ACKF", 4) != 0, OpcUa_BadConnectionRejected);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Crypto_SendOpen
+ *===========================================================================*/
+/* sends an unsecured OpenSecureChannel request for a new channel */
+static OpcUa_StatusCode UaTest_Crypto_SendOpen( BIO*            a_pClient,
+                                                OpcUa_UInt32    a_uRequestId)
+{
+    unsigned char   aMessage[256];
+    int             iUsed   = 8;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Crypto_SendOpen");
+
+    memcpy(aMessage, "OPNF", 4);
+    iUsed = UaTest_Crypto_PutUInt32(aMessage, iUsed, 0);                        /* SecureChannelId */
+    iUsed = UaTest_Crypto_PutString(aMessage, iUsed, OpcUa_SecurityPolicy_None);
+    iUsed = UaTest_Crypto_PutString(aMessage, iUsed, OpcUa_Null);               /* SenderCertificate */
+    iUsed = UaTest_Crypto_PutString(aMessage, iUsed, OpcUa_Null);               /* ReceiverCertificateThumbprint */
+    iUsed = UaTest_Crypto_PutUInt32(aMessage, iUsed, a_uRequestId);             /* SequenceNumber */
+    iUsed = UaTest_Crypto_PutUInt32(aMessage, iUsed, a_uRequestId);             /* RequestId */
+
+    /* OpenSecureChannelRequest_Encoding_DefaultBinary as four byte node id */
+    aMessage[iUsed++] = 0x01;
+    aMessage[iUsed++] = 0x00;
+    aMessage[iUsed++] = (unsigned char)(OpcUaId_OpenSecureChannelRequest_Encoding_DefaultBinary & 0xFF);
+    aMessage[iUsed++] = (unsigned char)(OpcUaId_OpenSecureChannelRequest_Encoding_DefaultBinary >> 8);
+
+    /* RequestHeader */
+    aMessage[iUsed++] = 0x00;                                                   /* AuthenticationToken */
+    aMessage[iUsed++] = 0x00;
+    iUsed = UaTest_Crypto_PutUInt32(aMessage, iUsed, 0);                        /* Timestamp */
+    iUsed = UaTest_Crypto_PutUInt32(aMessage, iUsed, 0);
+    iUsed = UaTest_Crypto_PutUInt32(aMessage, iUsed, a_uRequestId);             /* RequestHandle */
+    iUsed = UaTest_Crypto_PutUInt32(aMessage, iUsed, 0);                        /* ReturnDiagnostics */
+    iUsed = UaTest_Crypto_PutString(aMessage, iUsed, OpcUa_Null);               /* AuditEntryId */
+    iUsed = UaTest_Crypto_PutUInt32(aMessage, iUsed, 0);                        /* TimeoutHint */
+    aMessage[iUsed++] = 0x00;                                                   /* AdditionalHeader */
+    aMessage[iUsed++] = 0x00;
+    aMessage[iUsed++] = 0x00;
+
+    iUsed = UaTest_Crypto_PutUInt32(aMessage, iUsed, 0);                        /* ClientProtocolVersion */
+    iUsed = UaTest_Crypto_PutUInt32(aMessage, iUsed, OpcUa_SecurityTokenRequestType_Issue);
+    iUsed = UaTest_Crypto_PutUInt32(aMessage, iUsed, OpcUa_MessageSecurityMode_None);
+    iUsed = UaTest_Crypto_PutString(aMessage, iUsed, OpcUa_Null);               /* ClientNonce */
+    iUsed = UaTest_Crypto_PutUInt32(aMessage, iUsed, 600000);                   /* RequestedLifetime */
+    UaTest_Crypto_PutUInt32(aMessage, 4, (OpcUa_UInt32)iUsed);
+
+    OpcUa_GotoErrorIfTrue(BIO_write(a_pClient, aMessage, iUsed) != iUsed, OpcUa_BadCommunicationError);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Crypto_ReadOpenResponse
+ *===========================================================================*/
+/* OpcUa_True if the next message is the OpenSecureChannel response to a_uRequestId */
+static OpcUa_Boolean UaTest_Crypto_ReadOpenResponse(BIO*            a_pClient,
+                                                    OpcUa_UInt32    a_uRequestId)
+{
+    unsigned char   aMessage[UATEST_CRYPTO_MAXMESSAGE];
+    OpcUa_UInt32    uLength = 0;
+    OpcUa_UInt32    uOffset = 12;
+    OpcUa_UInt32    uField  = 0;
+    OpcUa_UInt32    i       = 0;
+
+    if(UaTest_Crypto_ReadMessage(a_pClient, aMessage, &uLength) == OpcUa_False || memcmp(aMessage, "OPNF", 4) != 0)
+    {
+        return OpcUa_False;
+    }
+
+    /* skip SecurityPolicyUri, SenderCertificate and ReceiverCertificateThumbprint */
+    for(i = 0; i < 3; i++)
+    {
+        if(uOffset + 4 > uLength)
+        {
+            return OpcUa_False;
+        }
+        uField = UaTest_Crypto_GetUInt32(aMessage + uOffset);
+        uOffset += 4;
+        if(uField != 0xFFFFFFFF)
+        {
+            uOffset += uField;
+        }
+    }
+
+    /* SequenceNumber and RequestId */
+    if(uOffset + 8 > uLength)
+    {
+        return OpcUa_False;
+    }
+    return (OpcUa_Boolean)(UaTest_Crypto_GetUInt32(aMessage + uOffset + 4) == a_uRequestId);
+}
+
+/*============================================================================
+ * UaTest_Crypto_Clear
+ *===========================================================================*/
+/* the secure listener goes first; it stops the worker, which references transport connections */
+static OpcUa_Void UaTest_Crypto_Clear(OpcUa_Void)
+{
+    OpcUa_Atomic_Store32(&UaTest_g_Crypto.uRelease, 1);
+
+    if(UaTest_g_Crypto.pSecureListener != OpcUa_Null)
+    {
+        OpcUa_Listener_Close(UaTest_g_Crypto.pSecureListener);
+        OpcUa_Listener_Delete(&UaTest_g_Crypto.pSecureListener);
+    }
+    if(UaTest_g_Crypto.pTransportListener != OpcUa_Null)
+    {
+        OpcUa_Listener_Delete(&UaTest_g_Crypto.pTransportListener);
+    }
+    OpcUa_Encoder_Delete(&UaTest_g_Crypto.pEncoder);
+    OpcUa_Decoder_Delete(&UaTest_g_Crypto.pDecoder);
+    OpcUa_EncodeableTypeTable_Delete(&UaTest_g_Crypto.KnownTypes);
+    OpcUa_MemSet(&UaTest_g_Crypto, 0, sizeof(UaTest_g_Crypto));
+}
+
+/*============================================================================
+ * UaTest_Crypto_Open
+ *===========================================================================*/
+/* a secure listener with a single crypto worker and the None policy */
+static OpcUa_StatusCode UaTest_Crypto_Open(OpcUa_Void)
+{
+    UaTest_Crypto*  pCrypto = &UaTest_g_Crypto;
+    OpcUa_String    sUrl;
+    OpcUa_UInt32    i       = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Crypto_Open");
+
+    OpcUa_MemSet(pCrypto, 0, sizeof(UaTest_Crypto));
+    OpcUa_String_Initialize(&sUrl);
+
+    OpcUa_ProxyStub_g_Configuration.iSecureListener_CryptoPool_Threads = 1;
+
+    pCrypto->PkiConfig.PkiType = OpcUa_NO_PKI;
+    pCrypto->Certificate.Data = (OpcUa_Byte*)UATEST_CRYPTO_NOCREDENTIALS;
+    pCrypto->Certificate.Length = (OpcUa_Int32)strlen(UATEST_CRYPTO_NOCREDENTIALS);
+    pCrypto->Key.Type = OpcUa_Crypto_KeyType_Rsa_Private;
+    pCrypto->Key.Key = pCrypto->Certificate;
+    OpcUa_String_AttachReadOnly(&pCrypto->Policy.sSecurityPolicy, OpcUa_SecurityPolicy_None);
+    pCrypto->Policy.uMessageSecurityModes = OPCUA_SECURECHANNEL_MESSAGESECURITYMODE_NONE;
+
+    pCrypto->OpenRequestType = OpcUa_OpenSecureChannelRequest_EncodeableType;
+    pCrypto->OpenRequestType.Decode = UaTest_Crypto_DecodeOpenRequest;
+    pCrypto->apTypes[0] = &pCrypto->OpenRequestType;
+    pCrypto->apTypes[1] = &OpcUa_OpenSecureChannelResponse_EncodeableType;
+    pCrypto->apTypes[2] = OpcUa_Null;
+
+    uStatus = OpcUa_EncodeableTypeTable_Create(&pCrypto->KnownTypes);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = OpcUa_EncodeableTypeTable_AddTypes(&pCrypto->KnownTypes, pCrypto->apTypes);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = OpcUa_BinaryEncoder_Create(&pCrypto->pEncoder);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = OpcUa_BinaryDecoder_Create(&pCrypto->pDecoder);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = OpcUa_TcpListener_Create(&pCrypto->pTransportListener);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = OpcUa_SecureListener_Create(  pCrypto->pTransportListener,
+                                            pCrypto->pDecoder,
+                                            pCrypto->pEncoder,
+                                            &OpcUa_ProxyStub_g_NamespaceUris,
+                                            &pCrypto->KnownTypes,
+                                            &pCrypto->Certificate,
+                                            &pCrypto->Key,
+                                            &pCrypto->PkiConfig,
+                                            1,
+                                            &pCrypto->Policy,
+                                            OpcUa_Null,
+                                            OpcUa_Null,
+                                            &pCrypto->pSecureListener);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* a port another process holds does not fail the test */
+    for(i = 0; i < UATEST_CRYPTO_NOOFPORTS; i++)
+    {
+        OpcUa_SnPrintfA(pCrypto->sHost, sizeof(pCrypto->sHost), "localhost:%u", (unsigned int)(UATEST_CRYPTO_PORT + i));
+        OpcUa_SnPrintfA(pCrypto->sUrl, sizeof(pCrypto->sUrl), "opc.tcp://%s", pCrypto->sHost);
+        OpcUa_String_Clear(&sUrl);
+        OpcUa_String_AttachReadOnly(&sUrl, pCrypto->sUrl);
+        uStatus = OpcUa_Listener_Open(pCrypto->pSecureListener, &sUrl, OpcUa_False, UaTest_Crypto_OnNotify, pCrypto);
+        if(OpcUa_IsGood(uStatus))
+        {
+            break;
+        }
+    }
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    OpcUa_String_Clear(&sUrl);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_String_Clear(&sUrl);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Crypto_DisconnectPending
+ *===========================================================================*/
+/* a client that disconnects while the worker holds its request leaves no trace */
+static OpcUa_StatusCode UaTest_Crypto_DisconnectPending(OpcUa_Void)
+{
+    UaTest_Crypto*  pCrypto     = &UaTest_g_Crypto;
+    BIO*            pGone       = OpcUa_Null;
+    BIO*            pLate       = OpcUa_Null;
+    OpcUa_UInt32    uWaited     = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Crypto_DisconnectPending");
+
+    uStatus = UaTest_Crypto_Open();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* the worker stops in the middle of the first request */
+    uStatus = UaTest_Crypto_Connect(&pGone);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_Crypto_SendOpen(pGone, 1);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    while(OpcUa_Atomic_Load32(&pCrypto->uBlocked) == 0 && uWaited < UATEST_CRYPTO_TIMEOUT)
+    {
+        OpcUa_Thread_Sleep(10);
+        uWaited += 10;
+    }
+    UATEST_CHECK(OpcUa_Atomic_Load32(&pCrypto->uBlocked) != 0);
+
+    /* its client goes away and a new one connects before the worker goes on */
+    BIO_free_all(pGone);
+    pGone = OpcUa_Null;
+    OpcUa_Thread_Sleep(UATEST_CRYPTO_SETTLETIME);
+
+    uStatus = UaTest_Crypto_Connect(&pLate);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    OpcUa_Atomic_Store32(&pCrypto->uRelease, 1);
+    OpcUa_Thread_Sleep(UATEST_CRYPTO_SETTLETIME);
+
+    /* the abandoned request neither answers nor closes the new connection */
+    uStatus = UaTest_Crypto_SendOpen(pLate, 2);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(UaTest_Crypto_ReadOpenResponse(pLate, 2) != OpcUa_False);
+
+    BIO_free_all(pLate);
+    UaTest_Crypto_Clear();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    if(pGone != OpcUa_Null)
+    {
+        BIO_free_all(pGone);
+    }
+    if(pLate != OpcUa_Null)
+    {
+        BIO_free_all(pLate);
+    }
+    UaTest_Crypto_Clear();
+
+OpcUa_FinishErrorHandling;
+}
+
+#endif /* OPCUA_HAVE_THREADPOOL */
+
+/*============================================================================
+ * Case table
+ *===========================================================================*/
+UaTest_Case UaTest_g_SecureListenerCases[] =
+{
+#ifdef OPCUA_HAVE_THREADPOOL
+    { "stack/securelistener/cryptopool/disconnectpending",  UaTest_Crypto_DisconnectPending },
+#endif /* OPCUA_HAVE_THREADPOOL */
+    UATEST_CASE_END
+};
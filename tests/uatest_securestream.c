@@ -0,0 +1,915 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+
+/******************************************************************************************************/
+/* Tests for the secure stream: the symmetric chunks a message is cut into are full, carry the       */
+/* token in use and decrypt and verify to the message body, whatever token, security mode and chunk  */
+/* length the channel had when the output stream was created, and whether the stream was new or      */
+/* taken from the stream cache of the channel.                                                       */
+/******************************************************************************************************/
+
+#include <opcua.h>
+#include <opcua_cryptofactory.h>
+#include <opcua_securechannel.h>
+#include <opcua_tcpsecurechannel.h>
+#include <opcua_securestream.h>
+
+#include "uatest.h"
+
+#include <string.h>
+
+#if OPCUA_HAVE_OPENSSL
+
+/*============================================================================
+ * Types and constants
+ *===========================================================================*/
+/** @brief Channel id of the test channel. */
+#define UATEST_SECURESTREAM_CHANNELID       1
+/** @brief Upper limit for the chunk length of the transport stream. */
+#define UATEST_SECURESTREAM_MAXCHUNKLENGTH  8192
+/** @brief Upper limit for the chunks of one message. */
+#define UATEST_SECURESTREAM_MAXCHUNKS       32
+/** @brief Block size of the symmetric encryption algorithms (AES). */
+#define UATEST_SECURESTREAM_BLOCKSIZE       16
+/** @brief Length of message header, channel id and token id; the encryption starts behind them. */
+#define UATEST_SECURESTREAM_PLAINHEADER     16
+/** @brief Length of the sequence header in front of the body. */
+#define UATEST_SECURESTREAM_SEQUENCEHEADER  8
+/** @brief Length of the nonces the keys are derived from. */
+#define UATEST_SECURESTREAM_NONCELENGTH     32
+
+/**
+ * @brief A token the channel was opened or renewed with and what the chunks sent with it look like.
+ */
+typedef struct _UaTest_SecureStreamToken
+{
+    OpcUa_UInt32                uTokenId;
+    OpcUa_MessageSecurityMode   eMode;
+    OpcUa_UInt32                uSignatureSize;
+    /** @brief Owned by the channel. */
+    OpcUa_CryptoProvider*       pCryptoProvider;
+    OpcUa_SecurityKeyset*       pSendingKeyset;
+} UaTest_SecureStreamToken;
+
+typedef struct _UaTest_SecureStream
+{
+    OpcUa_SecureChannel*        pSecureChannel;
+    /** @brief Transport stream below the secure stream and the chunk handed to it. */
+    OpcUa_OutputStream          TransportStream;
+    OpcUa_Buffer                TransportBuffer;
+    OpcUa_UInt32                uChunkLength;
+    /** @brief Set to let the transport take the chunk and finish the write later. */
+    OpcUa_Boolean               bWouldBlock;
+    /** @brief Chunks the transport received since the last message started. */
+    OpcUa_Byte                  aabChunks[UATEST_SECURESTREAM_MAXCHUNKS][UATEST_SECURESTREAM_MAXCHUNKLENGTH];
+    OpcUa_UInt32                auChunkLengths[UATEST_SECURESTREAM_MAXCHUNKS];
+    OpcUa_UInt32                uNoOfChunks;
+    /** @brief Plain text of the chunk being checked. */
+    OpcUa_Byte                  abPlainText[UATEST_SECURESTREAM_MAXCHUNKLENGTH];
+    /** @brief Body of the message being sent and what the chunks carried of it. */
+    OpcUa_Byte                  abBody[UATEST_SECURESTREAM_MAXCHUNKS * UATEST_SECURESTREAM_MAXCHUNKLENGTH];
+    OpcUa_Byte                  abReceived[UATEST_SECURESTREAM_MAXCHUNKS * UATEST_SECURESTREAM_MAXCHUNKLENGTH];
+} UaTest_SecureStream;
+
+/*============================================================================
+ * Globals
+ *===========================================================================*/
+static UaTest_SecureStream UaTest_g_SecureStream;
+
+/*============================================================================
+ * UaTest_SecureStream_GetUInt32
+ *===========================================================================*/
+static OpcUa_UInt32 UaTest_SecureStream_GetUInt32(const OpcUa_Byte* a_pData)
+{
+    return    (OpcUa_UInt32)a_pData[0]
+           | ((OpcUa_UInt32)a_pData[1] << 8)
+           | ((OpcUa_UInt32)a_pData[2] << 16)
+           | ((OpcUa_UInt32)a_pData[3] << 24);
+}
+
+/*============================================================================
+ * UaTest_SecureStream_Transport_GetChunkLength
+ *===========================================================================*/
+static OpcUa_StatusCode UaTest_SecureStream_Transport_GetChunkLength(   OpcUa_Stream*  a_pStrm,
+                                                                        OpcUa_UInt32*  a_puLength)
+{
+    OpcUa_ReferenceParameter(a_pStrm);
+
+    *a_puLength = UaTest_g_SecureStream.uChunkLength;
+
+    return OpcUa_Good;
+}
+
+/*============================================================================
+ * UaTest_SecureStream_Transport_AttachBuffer
+ *===========================================================================*/
+static OpcUa_StatusCode UaTest_SecureStream_Transport_AttachBuffer( OpcUa_Stream*  a_pStrm,
+                                                                    OpcUa_Buffer*  a_pBuffer)
+{
+    OpcUa_ReferenceParameter(a_pStrm);
+
+    UaTest_g_SecureStream.TransportBuffer = *a_pBuffer;
+
+    return OpcUa_Good;
+}
+
+/*============================================================================
+ * UaTest_SecureStream_Transport_DetachBuffer
+ *===========================================================================*/
+static OpcUa_StatusCode UaTest_SecureStream_Transport_DetachBuffer( OpcUa_Stream*  a_pStrm,
+                                                                    OpcUa_Buffer*  a_pBuffer)
+{
+    OpcUa_ReferenceParameter(a_pStrm);
+
+    *a_pBuffer = UaTest_g_SecureStream.TransportBuffer;
+    OpcUa_MemSet(&UaTest_g_SecureStream.TransportBuffer, 0, sizeof(OpcUa_Buffer));
+
+    return OpcUa_Good;
+}
+
+/*============================================================================
+ * UaTest_SecureStream_Transport_Flush
+ *===========================================================================*/
+/* keeps a copy of the chunk; too many or too long chunks fail the flush */
+static OpcUa_StatusCode UaTest_SecureStream_Transport_Flush(OpcUa_OutputStream* a_pOstrm,
+                                                            OpcUa_Boolean       a_bLastCall)
+{
+    UaTest_SecureStream*    pTest   = &UaTest_g_SecureStream;
+    OpcUa_UInt32            uLength = pTest->TransportBuffer.EndOfData;
+
+    OpcUa_ReferenceParameter(a_pOstrm);
+    OpcUa_ReferenceParameter(a_bLastCall);
+
+    if(pTest->uNoOfChunks >= UATEST_SECURESTREAM_MAXCHUNKS || uLength > UATEST_SECURESTREAM_MAXCHUNKLENGTH)
+    {
+        return OpcUa_BadTcpMessageTooLarge;
+    }
+
+    memcpy(pTest->aabChunks[pTest->uNoOfChunks], pTest->TransportBuffer.Data, uLength);
+    pTest->auChunkLengths[pTest->uNoOfChunks] = uLength;
+    pTest->uNoOfChunks++;
+
+    return (pTest->bWouldBlock != OpcUa_False)? OpcUa_BadWouldBlock: OpcUa_Good;
+}
+
+/*============================================================================
+ * UaTest_SecureStream_CreateToken
+ *===========================================================================*/
+/* derives the keysets of a token; creates the crypto provider of the policy unless one is passed in */
+static OpcUa_StatusCode UaTest_SecureStream_CreateToken(OpcUa_StringA               a_sSecurityPolicy,
+                                                        OpcUa_MessageSecurityMode   a_eMode,
+                                                        OpcUa_CryptoProvider**      a_ppCryptoProvider,
+                                                        OpcUa_SecurityKeyset**      a_ppReceivingKeyset,
+                                                        OpcUa_SecurityKeyset**      a_ppSendingKeyset)
+{
+    OpcUa_CryptoProvider*   pCryptoProvider = OpcUa_Null;
+    OpcUa_Byte              abClientNonce[UATEST_SECURESTREAM_NONCELENGTH];
+    OpcUa_Byte              abServerNonce[UATEST_SECURESTREAM_NONCELENGTH];
+    OpcUa_ByteString        bsClientNonce;
+    OpcUa_ByteString        bsServerNonce;
+    OpcUa_UInt32            uIndex          = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "SecureStream_CreateToken");
+
+    if(*a_ppCryptoProvider == OpcUa_Null)
+    {
+        pCryptoProvider = (OpcUa_CryptoProvider*)OpcUa_Alloc(sizeof(OpcUa_CryptoProvider));
+        OpcUa_GotoErrorIfAllocFailed(pCryptoProvider);
+        OpcUa_MemSet(pCryptoProvider, 0, sizeof(OpcUa_CryptoProvider));
+
+        uStatus = OPCUA_P_CRYPTOFACTORY_CREATECRYPTOPROVIDER(a_sSecurityPolicy, pCryptoProvider);
+        if(OpcUa_IsBad(uStatus))
+        {
+            OpcUa_Free(pCryptoProvider);
+            pCryptoProvider = OpcUa_Null;
+            OpcUa_GotoError;
+        }
+    }
+
+    for(uIndex = 0; uIndex < UATEST_SECURESTREAM_NONCELENGTH; uIndex++)
+    {
+        abClientNonce[uIndex] = (OpcUa_Byte)uIndex;
+        abServerNonce[uIndex] = (OpcUa_Byte)(0xFF - uIndex);
+    }
+
+    bsClientNonce.Length = UATEST_SECURESTREAM_NONCELENGTH;
+    bsClientNonce.Data   = abClientNonce;
+    bsServerNonce.Length = UATEST_SECURESTREAM_NONCELENGTH;
+    bsServerNonce.Data   = abServerNonce;
+
+    /* the server sends with its own keyset */
+    uStatus = OpcUa_SecureChannel_DeriveKeys(   a_eMode,
+                                                (pCryptoProvider != OpcUa_Null)? pCryptoProvider: *a_ppCryptoProvider,
+                                                &bsClientNonce,
+                                                &bsServerNonce,
+                                                a_ppReceivingKeyset,
+                                                a_ppSendingKeyset);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    if(pCryptoProvider != OpcUa_Null)
+    {
+        *a_ppCryptoProvider = pCryptoProvider;
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    if(pCryptoProvider != OpcUa_Null)
+    {
+        OPCUA_P_CRYPTOFACTORY_DELETECRYPTOPROVIDER(pCryptoProvider);
+        OpcUa_Free(pCryptoProvider);
+    }
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_SecureStream_Clear
+ *===========================================================================*/
+static OpcUa_Void UaTest_SecureStream_Clear(OpcUa_Void)
+{
+    if(UaTest_g_SecureStream.pSecureChannel != OpcUa_Null)
+    {
+        OpcUa_TcpSecureChannel_Delete(&UaTest_g_SecureStream.pSecureChannel);
+    }
+}
+
+/*============================================================================
+ * UaTest_SecureStream_Open
+ *===========================================================================*/
+/* opens the channel with token 1 of the given policy, as the server side */
+static OpcUa_StatusCode UaTest_SecureStream_Open(   OpcUa_StringA               a_sSecurityPolicy,
+                                                    OpcUa_MessageSecurityMode   a_eMode,
+                                                    OpcUa_UInt32                a_uSignatureSize,
+                                                    UaTest_SecureStreamToken*   a_pToken)
+{
+    UaTest_SecureStream*        pTest               = &UaTest_g_SecureStream;
+    OpcUa_CryptoProvider*       pCryptoProvider     = OpcUa_Null;
+    OpcUa_SecurityKeyset*       pReceivingKeyset    = OpcUa_Null;
+    OpcUa_SecurityKeyset*       pSendingKeyset      = OpcUa_Null;
+    OpcUa_ChannelSecurityToken  Token;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "SecureStream_Open");
+
+    OpcUa_MemSet(pTest, 0, sizeof(UaTest_SecureStream));
+    pTest->uChunkLength                         = UATEST_SECURESTREAM_MAXCHUNKLENGTH;
+    pTest->TransportStream.Type                 = OpcUa_StreamType_Output;
+    pTest->TransportStream.Handle               = pTest;
+    pTest->TransportStream.Flush                = UaTest_SecureStream_Transport_Flush;
+    pTest->TransportStream.AttachBuffer         = UaTest_SecureStream_Transport_AttachBuffer;
+    pTest->TransportStream.DetachBuffer         = UaTest_SecureStream_Transport_DetachBuffer;
+    pTest->TransportStream.GetChunkLength       = UaTest_SecureStream_Transport_GetChunkLength;
+
+    uStatus = UaTest_SecureStream_CreateToken(a_sSecurityPolicy, a_eMode, &pCryptoProvider, &pReceivingKeyset, &pSendingKeyset);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = OpcUa_TcpSecureChannel_Create(&pTest->pSecureChannel);
+    if(OpcUa_IsBad(uStatus))
+    {
+        OpcUa_SecurityKeyset_Clear(pReceivingKeyset);
+        OpcUa_SecurityKeyset_Clear(pSendingKeyset);
+        OpcUa_Free(pReceivingKeyset);
+        OpcUa_Free(pSendingKeyset);
+        OPCUA_P_CRYPTOFACTORY_DELETECRYPTOPROVIDER(pCryptoProvider);
+        OpcUa_Free(pCryptoProvider);
+        OpcUa_GotoError;
+    }
+    pTest->pSecureChannel->SecureChannelId = UATEST_SECURESTREAM_CHANNELID;
+
+    OpcUa_ChannelSecurityToken_Initialize(&Token);
+    Token.ChannelId         = UATEST_SECURESTREAM_CHANNELID;
+    Token.TokenId           = 1;
+    Token.RevisedLifetime   = 3600000;
+
+    /* the channel deletes the crypto provider and the keysets */
+    pTest->pSecureChannel->pCurrentCryptoProvider = pCryptoProvider;
+    uStatus = pTest->pSecureChannel->Open(  pTest->pSecureChannel,
+                                            (OpcUa_Handle)&pTest->TransportStream,
+                                            Token,
+                                            a_eMode,
+                                            OpcUa_Null,
+                                            OpcUa_Null,
+                                            pReceivingKeyset,
+                                            pSendingKeyset,
+                                            pCryptoProvider);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    a_pToken->uTokenId          = Token.TokenId;
+    a_pToken->eMode             = a_eMode;
+    a_pToken->uSignatureSize    = a_uSignatureSize;
+    a_pToken->pCryptoProvider   = pCryptoProvider;
+    a_pToken->pSendingKeyset    = pSendingKeyset;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_SecureStream_Clear();
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_SecureStream_Renew
+ *===========================================================================*/
+/* renews the channel with a token of the given policy; the channel sends with it once activated.
+   A crypto provider passed in is the channel's current one, handed over again. */
+static OpcUa_StatusCode UaTest_SecureStream_Renew(  OpcUa_StringA               a_sSecurityPolicy,
+                                                    OpcUa_MessageSecurityMode   a_eMode,
+                                                    OpcUa_UInt32                a_uSignatureSize,
+                                                    OpcUa_UInt32                a_uTokenId,
+                                                    OpcUa_CryptoProvider*       a_pCryptoProvider,
+                                                    UaTest_SecureStreamToken*   a_pToken)
+{
+    UaTest_SecureStream*        pTest               = &UaTest_g_SecureStream;
+    OpcUa_CryptoProvider*       pCryptoProvider     = a_pCryptoProvider;
+    OpcUa_SecurityKeyset*       pReceivingKeyset    = OpcUa_Null;
+    OpcUa_SecurityKeyset*       pSendingKeyset      = OpcUa_Null;
+    OpcUa_ChannelSecurityToken  Token;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "SecureStream_Renew");
+
+    uStatus = UaTest_SecureStream_CreateToken(a_sSecurityPolicy, a_eMode, &pCryptoProvider, &pReceivingKeyset, &pSendingKeyset);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    OpcUa_ChannelSecurityToken_Initialize(&Token);
+    Token.ChannelId         = UATEST_SECURESTREAM_CHANNELID;
+    Token.TokenId           = a_uTokenId;
+    Token.RevisedLifetime   = 3600000;
+
+    /* the channel takes the keysets in any case */
+    uStatus = pTest->pSecureChannel->Renew( pTest->pSecureChannel,
+                                            (OpcUa_Handle)&pTest->TransportStream,
+                                            Token,
+                                            a_eMode,
+                                            OpcUa_Null,
+                                            OpcUa_Null,
+                                            pReceivingKeyset,
+                                            pSendingKeyset,
+                                            pCryptoProvider);
+    if(OpcUa_IsBad(uStatus) && a_pCryptoProvider == OpcUa_Null)
+    {
+        OPCUA_P_CRYPTOFACTORY_DELETECRYPTOPROVIDER(pCryptoProvider);
+        OpcUa_Free(pCryptoProvider);
+    }
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    a_pToken->uTokenId          = a_uTokenId;
+    a_pToken->eMode             = a_eMode;
+    a_pToken->uSignatureSize    = a_uSignatureSize;
+    a_pToken->pCryptoProvider   = pCryptoProvider;
+    a_pToken->pSendingKeyset    = pSendingKeyset;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_SecureStream_Activate
+ *===========================================================================*/
+/* what the first chunk the client sends with the renewed token does */
+static OpcUa_StatusCode UaTest_SecureStream_Activate(OpcUa_UInt32 a_uTokenId)
+{
+    OpcUa_SecureChannel* pSecureChannel = UaTest_g_SecureStream.pSecureChannel;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "SecureStream_Activate");
+
+    uStatus = pSecureChannel->GetSecuritySet(pSecureChannel, a_uTokenId, OpcUa_Null, OpcUa_Null, OpcUa_Null);
+    OpcUa_GotoErrorIfBad(uStatus);
+    pSecureChannel->ReleaseSecuritySet(pSecureChannel, a_uTokenId);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_SecureStream_Create
+ *===========================================================================*/
+static OpcUa_StatusCode UaTest_SecureStream_Create( OpcUa_UInt32            a_uRequestId,
+                                                    OpcUa_OutputStream**    a_ppOstrm)
+{
+    return OpcUa_SecureStream_CreateOutput( &UaTest_g_SecureStream.TransportStream,
+                                            eOpcUa_SecureStream_Types_StandardMessage,
+                                            a_uRequestId,
+                                            UaTest_g_SecureStream.pSecureChannel,
+                                            a_ppOstrm);
+}
+
+/*============================================================================
+ * UaTest_SecureStream_Write
+ *===========================================================================*/
+/* writes a body of the given length, which differs for every request, and flushes the last chunk */
+static OpcUa_StatusCode UaTest_SecureStream_Write(  OpcUa_OutputStream* a_pOstrm,
+                                                    OpcUa_UInt32        a_uRequestId,
+                                                    OpcUa_UInt32        a_uBodyLength)
+{
+    UaTest_SecureStream*    pTest   = &UaTest_g_SecureStream;
+    OpcUa_UInt32            uIndex  = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "SecureStream_Write");
+
+    for(uIndex = 0; uIndex < a_uBodyLength; uIndex++)
+    {
+        pTest->abBody[uIndex] = (OpcUa_Byte)(uIndex * 7 + a_uRequestId);
+    }
+
+    pTest->uNoOfChunks = 0;
+
+    uStatus = a_pOstrm->Write(a_pOstrm, pTest->abBody, a_uBodyLength);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = a_pOstrm->Flush(a_pOstrm, OpcUa_True);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_SecureStream_Send
+ *===========================================================================*/
+/* sends one message the way OpcUa_SecureConnection does */
+static OpcUa_StatusCode UaTest_SecureStream_Send(   OpcUa_UInt32    a_uRequestId,
+                                                    OpcUa_UInt32    a_uBodyLength)
+{
+    OpcUa_OutputStream* pOstrm = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "SecureStream_Send");
+
+    uStatus = UaTest_SecureStream_Create(a_uRequestId, &pOstrm);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = UaTest_SecureStream_Write(pOstrm, a_uRequestId, a_uBodyLength);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    OpcUa_Stream_Delete((OpcUa_Stream**)&pOstrm);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_Stream_Delete((OpcUa_Stream**)&pOstrm);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_SecureStream_Check
+ *===========================================================================*/
+/* every chunk but the last is as long as the chunk length allows; all of them carry the token and
+   verify, and their bodies make up the message */
+static OpcUa_StatusCode UaTest_SecureStream_Check(  UaTest_SecureStreamToken*   a_pToken,
+                                                    OpcUa_UInt32                a_uRequestId,
+                                                    OpcUa_UInt32                a_uBodyLength)
+{
+    UaTest_SecureStream*    pTest           = &UaTest_g_SecureStream;
+    OpcUa_Byte*             pChunk          = OpcUa_Null;
+    OpcUa_UInt32            uLength         = 0;
+    OpcUa_UInt32            uFullLength     = 0;
+    OpcUa_UInt32            uPlainLength    = 0;
+    OpcUa_UInt32            uBodyLength     = 0;
+    OpcUa_UInt32            uReceived       = 0;
+    OpcUa_UInt32            uChunk          = 0;
+    OpcUa_Byte              abIV[UATEST_SECURESTREAM_BLOCKSIZE];
+    OpcUa_ByteString        Signature;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "SecureStream_Check");
+
+    /* the encrypted part of a full chunk is cut to whole blocks */
+    uFullLength = pTest->uChunkLength;
+    if(a_pToken->eMode == OpcUa_MessageSecurityMode_SignAndEncrypt)
+    {
+        uFullLength =   UATEST_SECURESTREAM_PLAINHEADER
+                      + (uFullLength - UATEST_SECURESTREAM_PLAINHEADER) / UATEST_SECURESTREAM_BLOCKSIZE * UATEST_SECURESTREAM_BLOCKSIZE;
+    }
+
+    UATEST_CHECK(pTest->uNoOfChunks > 0);
+
+    for(uChunk = 0; uChunk < pTest->uNoOfChunks; uChunk++)
+    {
+        pChunk  = pTest->aabChunks[uChunk];
+        uLength = pTest->auChunkLengths[uChunk];
+
+        UATEST_CHECK(uLength <= pTest->uChunkLength);
+        UATEST_CHECK(uLength >= UATEST_SECURESTREAM_PLAINHEADER + UATEST_SECURESTREAM_SEQUENCEHEADER + a_pToken->uSignatureSize);
+        UATEST_CHECK(uChunk == pTest->uNoOfChunks - 1 || uLength == uFullLength);
+        UATEST_CHECK(memcmp(pChunk, "MSG", 3) == 0);
+        UATEST_CHECK(pChunk[3] == ((uChunk == pTest->uNoOfChunks - 1)? 'F': 'C'));
+        UATEST_CHECK(UaTest_SecureStream_GetUInt32(pChunk + 4)  == uLength);
+        UATEST_CHECK(UaTest_SecureStream_GetUInt32(pChunk + 8)  == UATEST_SECURESTREAM_CHANNELID);
+        UATEST_CHECK(UaTest_SecureStream_GetUInt32(pChunk + 12) == a_pToken->uTokenId);
+
+        /* header in the clear, then the decrypted rest */
+        memcpy(pTest->abPlainText, pChunk, UATEST_SECURESTREAM_PLAINHEADER);
+        uPlainLength = uLength - UATEST_SECURESTREAM_PLAINHEADER;
+        if(a_pToken->eMode == OpcUa_MessageSecurityMode_SignAndEncrypt)
+        {
+            UATEST_CHECK((uLength - UATEST_SECURESTREAM_PLAINHEADER) % UATEST_SECURESTREAM_BLOCKSIZE == 0);
+
+            /* the keyset stays as it is */
+            memcpy(abIV, a_pToken->pSendingKeyset->InitializationVector.Key.Data, UATEST_SECURESTREAM_BLOCKSIZE);
+            uStatus = a_pToken->pCryptoProvider->SymmetricDecrypt(  a_pToken->pCryptoProvider,
+                                                                    pChunk + UATEST_SECURESTREAM_PLAINHEADER,
+                                                                    uLength - UATEST_SECURESTREAM_PLAINHEADER,
+                                                                    &a_pToken->pSendingKeyset->EncryptionKey,
+                                                                    abIV,
+                                                                    pTest->abPlainText + UATEST_SECURESTREAM_PLAINHEADER,
+                                                                    &uPlainLength);
+            UATEST_CHECK(OpcUa_IsGood(uStatus));
+        }
+        else
+        {
+            memcpy(pTest->abPlainText + UATEST_SECURESTREAM_PLAINHEADER, pChunk + UATEST_SECURESTREAM_PLAINHEADER, uPlainLength);
+        }
+        uPlainLength += UATEST_SECURESTREAM_PLAINHEADER;
+
+        if(a_pToken->eMode != OpcUa_MessageSecurityMode_None)
+        {
+            Signature.Length = (OpcUa_Int32)a_pToken->uSignatureSize;
+            Signature.Data   = pTest->abPlainText + uPlainLength - a_pToken->uSignatureSize;
+            uStatus = a_pToken->pCryptoProvider->SymmetricVerify(   a_pToken->pCryptoProvider,
+                                                                    pTest->abPlainText,
+                                                                    uPlainLength - a_pToken->uSignatureSize,
+                                                                    &a_pToken->pSendingKeyset->SigningKey,
+                                                                    &Signature);
+            UATEST_CHECK(OpcUa_IsGood(uStatus));
+            uPlainLength -= a_pToken->uSignatureSize;
+        }
+
+        if(a_pToken->eMode == OpcUa_MessageSecurityMode_SignAndEncrypt)
+        {
+            /* padding bytes and their count all hold the count */
+            UATEST_CHECK(uPlainLength > UATEST_SECURESTREAM_PLAINHEADER + UATEST_SECURESTREAM_SEQUENCEHEADER + pTest->abPlainText[uPlainLength - 1]);
+            uPlainLength -= pTest->abPlainText[uPlainLength - 1] + 1;
+        }
+
+        UATEST_CHECK(UaTest_SecureStream_GetUInt32(pTest->abPlainText + 20) == a_uRequestId);
+
+        uBodyLength = uPlainLength - UATEST_SECURESTREAM_PLAINHEADER - UATEST_SECURESTREAM_SEQUENCEHEADER;
+        UATEST_CHECK(uReceived + uBodyLength <= a_uBodyLength);
+        memcpy(pTest->abReceived + uReceived,
+               pTest->abPlainText + UATEST_SECURESTREAM_PLAINHEADER + UATEST_SECURESTREAM_SEQUENCEHEADER,
+               uBodyLength);
+        uReceived += uBodyLength;
+    }
+
+    UATEST_CHECK(uReceived == a_uBodyLength);
+    UATEST_CHECK(memcmp(pTest->abReceived, pTest->abBody, a_uBodyLength) == 0);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_SecureStream_SendAll
+ *===========================================================================*/
+/* sends messages of one to many chunks with each chunk length in turn, on the same token; it starts
+   with the chunk length it ends with, so only a new token changes the layout of the first messages */
+static OpcUa_StatusCode UaTest_SecureStream_SendAll(UaTest_SecureStreamToken* a_pToken)
+{
+    static const OpcUa_UInt32 auChunkLengths[] = { 4096, 8192, 1000, 4096 };
+    static const OpcUa_UInt32 auBodyLengths[]  = { 0, 1, 2000, 20000 };
+    OpcUa_OutputStream* pOstrm      = OpcUa_Null;
+    OpcUa_SecureStream* pStream     = OpcUa_Null;
+    OpcUa_UInt32        uRequestId  = 0;
+    OpcUa_UInt32        i           = 0;
+    OpcUa_UInt32        j           = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "SecureStream_SendAll");
+
+    for(i = 0; i < sizeof(auChunkLengths) / sizeof(auChunkLengths[0]); i++)
+    {
+        UaTest_g_SecureStream.uChunkLength = auChunkLengths[i];
+
+        for(j = 0; j < sizeof(auBodyLengths) / sizeof(auBodyLengths[0]); j++)
+        {
+            uRequestId++;
+            uStatus = UaTest_SecureStream_Send(uRequestId, auBodyLengths[j]);
+            UATEST_CHECK(OpcUa_IsGood(uStatus));
+            uStatus = UaTest_SecureStream_Check(a_pToken, uRequestId, auBodyLengths[j]);
+            OpcUa_GotoErrorIfBad(uStatus);
+        }
+
+        /* the layout the stream got is the one of the channel */
+        uStatus = UaTest_SecureStream_Create(++uRequestId, &pOstrm);
+        OpcUa_GotoErrorIfBad(uStatus);
+        pStream = (OpcUa_SecureStream*)pOstrm->Handle;
+
+        UATEST_CHECK(UaTest_g_SecureStream.pSecureChannel->SymmetricChunkLayout.bValid != OpcUa_False);
+        UATEST_CHECK(UaTest_g_SecureStream.pSecureChannel->SymmetricChunkLayout.uTokenId == a_pToken->uTokenId);
+        UATEST_CHECK(UaTest_g_SecureStream.pSecureChannel->SymmetricChunkLayout.uChunkLength == auChunkLengths[i]);
+        UATEST_CHECK(UaTest_g_SecureStream.pSecureChannel->SymmetricChunkLayout.uFlushTrigger == pStream->uFlushTrigger);
+        UATEST_CHECK(pStream->uSignatureSize == a_pToken->uSignatureSize);
+
+        OpcUa_Stream_Delete((OpcUa_Stream**)&pOstrm);
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_Stream_Delete((OpcUa_Stream**)&pOstrm);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_SecureStream_Modes
+ *===========================================================================*/
+/* the chunk layout fits each security mode and chunk length */
+static OpcUa_StatusCode UaTest_SecureStream_Modes(OpcUa_Void)
+{
+    UaTest_SecureStreamToken Token;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "SecureStream_Modes");
+
+    uStatus = UaTest_SecureStream_Open(OpcUa_SecurityPolicy_None, OpcUa_MessageSecurityMode_None, 0, &Token);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_SecureStream_SendAll(&Token);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UaTest_SecureStream_Clear();
+
+    uStatus = UaTest_SecureStream_Open(OpcUa_SecurityPolicy_Basic256Sha256, OpcUa_MessageSecurityMode_Sign, 32, &Token);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_SecureStream_SendAll(&Token);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UaTest_SecureStream_Clear();
+
+    uStatus = UaTest_SecureStream_Open(OpcUa_SecurityPolicy_Basic256Sha256, OpcUa_MessageSecurityMode_SignAndEncrypt, 32, &Token);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_SecureStream_SendAll(&Token);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UaTest_SecureStream_Clear();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_SecureStream_Clear();
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_SecureStream_Renewal
+ *===========================================================================*/
+/* the layout follows the token the channel sends with; policy and mode stay those of the channel */
+static OpcUa_StatusCode UaTest_SecureStream_Renewal(OpcUa_Void)
+{
+    UaTest_SecureStreamToken First;
+    UaTest_SecureStreamToken Second;
+    UaTest_SecureStreamToken Third;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "SecureStream_Renewal");
+
+    uStatus = UaTest_SecureStream_Open(OpcUa_SecurityPolicy_Basic256Sha256, OpcUa_MessageSecurityMode_SignAndEncrypt, 32, &First);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_SecureStream_SendAll(&First);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = UaTest_SecureStream_Renew(OpcUa_SecurityPolicy_Basic256Sha256, OpcUa_MessageSecurityMode_SignAndEncrypt, 32, 2, OpcUa_Null, &Second);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* the client has not used the new token yet */
+    uStatus = UaTest_SecureStream_SendAll(&First);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = UaTest_SecureStream_Activate(2);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_SecureStream_SendAll(&Second);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* same provider as before, as if the new one was allocated where an old one was freed */
+    uStatus = UaTest_SecureStream_Renew(OpcUa_SecurityPolicy_Basic256Sha256, OpcUa_MessageSecurityMode_SignAndEncrypt, 32, 3, Second.pCryptoProvider, &Third);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_SecureStream_Activate(3);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_SecureStream_SendAll(&Third);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    UaTest_SecureStream_Clear();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_SecureStream_Clear();
+
+OpcUa_FinishErrorHandling;
+}
+
+#if OPCUA_SECURECHANNEL_STREAMCACHE_SIZE
+
+/*============================================================================
+ * UaTest_SecureStream_CacheReuse
+ *===========================================================================*/
+/* a deleted stream is handed out again with its chunk buffer; the cache keeps no more than its size */
+static OpcUa_StatusCode UaTest_SecureStream_CacheReuse(OpcUa_Void)
+{
+    UaTest_SecureStreamToken    Token;
+    OpcUa_SecureChannel*        pSecureChannel  = OpcUa_Null;
+    OpcUa_OutputStream*         apOstrms[OPCUA_SECURECHANNEL_STREAMCACHE_SIZE + 1];
+    OpcUa_OutputStream*         pCached         = OpcUa_Null;
+    OpcUa_Byte*                 pCachedData     = OpcUa_Null;
+    OpcUa_UInt32                i               = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "SecureStream_CacheReuse");
+
+    OpcUa_MemSet(apOstrms, 0, sizeof(apOstrms));
+
+    uStatus = UaTest_SecureStream_Open(OpcUa_SecurityPolicy_Basic256Sha256, OpcUa_MessageSecurityMode_SignAndEncrypt, 32, &Token);
+    OpcUa_GotoErrorIfBad(uStatus);
+    pSecureChannel = UaTest_g_SecureStream.pSecureChannel;
+
+    uStatus = UaTest_SecureStream_Send(1, 2000);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_SecureStream_Check(&Token, 1, 2000);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    UATEST_CHECK(pSecureChannel->uNoOfCachedStreams == 1);
+    pCached     = pSecureChannel->apCachedStreams[0];
+    pCachedData = ((OpcUa_SecureStream*)pCached->Handle)->Buffers[0].Data;
+    UATEST_CHECK(pCachedData != OpcUa_Null);
+
+    /* the first stream comes from the cache, the others are new */
+    for(i = 0; i <= OPCUA_SECURECHANNEL_STREAMCACHE_SIZE; i++)
+    {
+        uStatus = UaTest_SecureStream_Create(2 + i, &apOstrms[i]);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+    UATEST_CHECK(apOstrms[0] == pCached);
+    UATEST_CHECK(((OpcUa_SecureStream*)apOstrms[0]->Handle)->Buffers[0].Data == pCachedData);
+    UATEST_CHECK(pSecureChannel->uNoOfCachedStreams == 0);
+
+    for(i = 0; i <= OPCUA_SECURECHANNEL_STREAMCACHE_SIZE; i++)
+    {
+        uStatus = UaTest_SecureStream_Write(apOstrms[i], 2 + i, 3000 * (i + 1));
+        OpcUa_GotoErrorIfBad(uStatus);
+        uStatus = UaTest_SecureStream_Check(&Token, 2 + i, 3000 * (i + 1));
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+    for(i = 0; i <= OPCUA_SECURECHANNEL_STREAMCACHE_SIZE; i++)
+    {
+        OpcUa_Stream_Delete((OpcUa_Stream**)&apOstrms[i]);
+    }
+    UATEST_CHECK(pSecureChannel->uNoOfCachedStreams == OPCUA_SECURECHANNEL_STREAMCACHE_SIZE);
+
+    /* reused streams also cut long messages into chunks */
+    uStatus = UaTest_SecureStream_Send(10, 20000);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_SecureStream_Check(&Token, 10, 20000);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* deleting the channel deletes the cached streams */
+    UaTest_SecureStream_Clear();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    for(i = 0; i <= OPCUA_SECURECHANNEL_STREAMCACHE_SIZE; i++)
+    {
+        OpcUa_Stream_Delete((OpcUa_Stream**)&apOstrms[i]);
+    }
+    UaTest_SecureStream_Clear();
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_SecureStream_CacheChunkLength
+ *===========================================================================*/
+/* a cached stream gets a new chunk buffer when the chunk length changed */
+static OpcUa_StatusCode UaTest_SecureStream_CacheChunkLength(OpcUa_Void)
+{
+    UaTest_SecureStreamToken    Token;
+    OpcUa_OutputStream*         pOstrm  = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "SecureStream_CacheChunkLength");
+
+    uStatus = UaTest_SecureStream_Open(OpcUa_SecurityPolicy_Basic256Sha256, OpcUa_MessageSecurityMode_SignAndEncrypt, 32, &Token);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = UaTest_SecureStream_Send(1, 100);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(UaTest_g_SecureStream.pSecureChannel->uNoOfCachedStreams == 1);
+
+    UaTest_g_SecureStream.uChunkLength = 1000;
+    uStatus = UaTest_SecureStream_Create(2, &pOstrm);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(((OpcUa_SecureStream*)pOstrm->Handle)->Buffers[0].MaxSize == 1000);
+
+    uStatus = UaTest_SecureStream_Write(pOstrm, 2, 5000);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_SecureStream_Check(&Token, 2, 5000);
+    OpcUa_GotoErrorIfBad(uStatus);
+    OpcUa_Stream_Delete((OpcUa_Stream**)&pOstrm);
+
+    UaTest_g_SecureStream.uChunkLength = UATEST_SECURESTREAM_MAXCHUNKLENGTH;
+    uStatus = UaTest_SecureStream_Send(3, 20000);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_SecureStream_Check(&Token, 3, 20000);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    UaTest_SecureStream_Clear();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_Stream_Delete((OpcUa_Stream**)&pOstrm);
+    UaTest_SecureStream_Clear();
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_SecureStream_CacheWouldBlock
+ *===========================================================================*/
+/* a stream whose chunk went to the pending sends of the channel is cached without it */
+static OpcUa_StatusCode UaTest_SecureStream_CacheWouldBlock(OpcUa_Void)
+{
+    UaTest_SecureStreamToken    Token;
+    OpcUa_SecureChannel*        pSecureChannel  = OpcUa_Null;
+    OpcUa_BufferList*           pPending        = OpcUa_Null;
+    OpcUa_OutputStream*         pOstrm          = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "SecureStream_CacheWouldBlock");
+
+    uStatus = UaTest_SecureStream_Open(OpcUa_SecurityPolicy_Basic256Sha256, OpcUa_MessageSecurityMode_SignAndEncrypt, 32, &Token);
+    OpcUa_GotoErrorIfBad(uStatus);
+    pSecureChannel = UaTest_g_SecureStream.pSecureChannel;
+
+    UaTest_g_SecureStream.bWouldBlock = OpcUa_True;
+    uStatus = UaTest_SecureStream_Create(1, &pOstrm);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_SecureStream_Write(pOstrm, 1, 100);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_SecureStream_Check(&Token, 1, 100);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    UATEST_CHECK(pSecureChannel->pPendingSendBuffers != OpcUa_Null);
+    UATEST_CHECK(((OpcUa_SecureStream*)pOstrm->Handle)->Buffers[0].Data == OpcUa_Null);
+    OpcUa_Stream_Delete((OpcUa_Stream**)&pOstrm);
+    UATEST_CHECK(pSecureChannel->uNoOfCachedStreams == 1);
+
+    /* the transport finished the write and freed the chunk */
+    UaTest_g_SecureStream.bWouldBlock = OpcUa_False;
+    while(pSecureChannel->pPendingSendBuffers != OpcUa_Null)
+    {
+        pPending = pSecureChannel->pPendingSendBuffers;
+        pSecureChannel->pPendingSendBuffers = pPending->pNext;
+        OpcUa_Buffer_Clear(&pPending->Buffer);
+        OpcUa_Free(pPending);
+    }
+    pSecureChannel->bAsyncWriteInProgress = OpcUa_False;
+
+    uStatus = UaTest_SecureStream_Send(2, 20000);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_SecureStream_Check(&Token, 2, 20000);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(pSecureChannel->uNoOfCachedStreams == 1);
+
+    UaTest_SecureStream_Clear();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_Stream_Delete((OpcUa_Stream**)&pOstrm);
+    UaTest_SecureStream_Clear();
+
+OpcUa_FinishErrorHandling;
+}
+
+#endif /* OPCUA_SECURECHANNEL_STREAMCACHE_SIZE */
+
+#endif /* OPCUA_HAVE_OPENSSL */
+
+/*============================================================================
+ * Case table
+ *===========================================================================*/
+UaTest_Case UaTest_g_SecureStreamCases[] =
+{
+#if OPCUA_HAVE_OPENSSL
+    { "stack/securestream/chunklayout/modes",       UaTest_SecureStream_Modes },
+    { "stack/securestream/chunklayout/renewal",     UaTest_SecureStream_Renewal },
+#if OPCUA_SECURECHANNEL_STREAMCACHE_SIZE
+    { "stack/securestream/streamcache/reuse",       UaTest_SecureStream_CacheReuse },
+    { "stack/securestream/streamcache/chunklength", UaTest_SecureStream_CacheChunkLength },
+    { "stack/securestream/streamcache/wouldblock",  UaTest_SecureStream_CacheWouldBlock },
+#endif /* OPCUA_SECURECHANNEL_STREAMCACHE_SIZE */
+#endif /* OPCUA_HAVE_OPENSSL */
+    UATEST_CASE_END
+};
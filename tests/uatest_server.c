@@ -0,0 +1,345 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+
+/******************************************************************************************************/
+/* Tests for the sample server process: SIGTERM and SIGINT stop a daemon the same way as x stops a   */
+/* server on a console, with a clean shutdown and exit code 0.                                       */
+/******************************************************************************************************/
+
+#include <opcua.h>
+
+#include "uatest.h"
+
+#if defined(__linux__) && defined(UATEST_SAMPLE_SERVER)
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
+/*============================================================================
+ * Types and constants
+ *===========================================================================*/
+/** @brief The port of UATESTSERVER_ENDPOINT_URL; the server is ready once it accepts connections. */
+#define UATEST_SERVER_PORT          4840
+/** @brief Milliseconds the server gets to start and to stop. */
+#define UATEST_SERVER_TIMEOUT       10000
+/** @brief How long the server gets to act on console input it should ignore. */
+#define UATEST_SERVER_SETTLETIME    100
+/** @brief Room for what the server prints; the rest is read and dropped. */
+#define UATEST_SERVER_MAXOUTPUT     4096
+
+typedef struct _UaTest_Server
+{
+    pid_t   iPid;
+    /** @brief Write end of the standard input of the server. */
+    int     iInput;
+    /** @brief Read end of the standard output of the server. */
+    int     iOutput;
+    char    sOutput[UATEST_SERVER_MAXOUTPUT];
+    size_t  uOutput;
+} UaTest_Server;
+
+static UaTest_Server UaTest_g_Server;
+
+/*============================================================================
+ * UaTest_Server_IsListening
+ *===========================================================================*/
+static OpcUa_Boolean UaTest_Server_IsListening(OpcUa_Void)
+{
+    struct sockaddr_in  Address;
+    OpcUa_Boolean       bListening  = OpcUa_False;
+    int                 iSocket     = socket(AF_INET, SOCK_STREAM, 0);
+
+    if(iSocket < 0)
+    {
+        return OpcUa_False;
+    }
+
+    memset(&Address, 0, sizeof(Address));
+    Address.sin_family      = AF_INET;
+    Address.sin_port        = htons(UATEST_SERVER_PORT);
+    Address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bListening = (connect(iSocket, (struct sockaddr*)&Address, sizeof(Address)) == 0)?OpcUa_True:OpcUa_False;
+    close(iSocket);
+
+    return bListening;
+}
+
+/*============================================================================
+ * UaTest_Server_Clear
+ *===========================================================================*/
+/* kills a server the test did not get to stop */
+static OpcUa_Void UaTest_Server_Clear(OpcUa_Void)
+{
+    UaTest_Server* pServer = &UaTest_g_Server;
+
+    if(pServer->iPid > 0)
+    {
+        kill(pServer->iPid, SIGKILL);
+        waitpid(pServer->iPid, OpcUa_Null, 0);
+    }
+    if(pServer->iInput >= 0)
+    {
+        close(pServer->iInput);
+    }
+    if(pServer->iOutput >= 0)
+    {
+        close(pServer->iOutput);
+    }
+    memset(pServer, 0, sizeof(UaTest_Server));
+    pServer->iInput  = -1;
+    pServer->iOutput = -1;
+}
+
+/*============================================================================
+ * UaTest_Server_Start
+ *===========================================================================*/
+/* starts the sample server with pipes for its console and waits until it listens */
+static OpcUa_StatusCode UaTest_Server_Start(OpcUa_Boolean a_bDaemon)
+{
+    UaTest_Server*  pServer     = &UaTest_g_Server;
+    int             aiInput[2]  = { -1, -1 };
+    int             aiOutput[2] = { -1, -1 };
+    OpcUa_UInt32    uWaited     = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Server_Start");
+
+    memset(pServer, 0, sizeof(UaTest_Server));
+    pServer->iInput  = -1;
+    pServer->iOutput = -1;
+
+    /* the port must not be taken by someone else */
+    UATEST_CHECK(!UaTest_Server_IsListening());
+
+    OpcUa_GotoErrorIfTrue(pipe(aiInput) != 0, OpcUa_BadInternalError);
+    OpcUa_GotoErrorIfTrue(pipe(aiOutput) != 0, OpcUa_BadInternalError);
+
+    pServer->iPid = fork();
+    OpcUa_GotoErrorIfTrue(pServer->iPid < 0, OpcUa_BadInternalError);
+
+    if(pServer->iPid == 0)
+    {
+        dup2(aiInput[0], STDIN_FILENO);
+        dup2(aiOutput[1], STDOUT_FILENO);
+        dup2(aiOutput[1], STDERR_FILENO);
+        close(aiInput[0]);
+        close(aiInput[1]);
+        close(aiOutput[0]);
+        close(aiOutput[1]);
+        if(a_bDaemon != OpcUa_False)
+        {
+            execl(UATEST_SAMPLE_SERVER, UATEST_SAMPLE_SERVER, "-daemon", (char*)OpcUa_Null);
+        }
+        else
+        {
+            execl(UATEST_SAMPLE_SERVER, UATEST_SAMPLE_SERVER, (char*)OpcUa_Null);
+        }
+        _exit(127);
+    }
+
+    close(aiInput[0]);
+    close(aiOutput[1]);
+    pServer->iInput  = aiInput[1];
+    pServer->iOutput = aiOutput[0];
+    aiInput[0]  = aiInput[1]  = -1;
+    aiOutput[0] = aiOutput[1] = -1;
+
+    /* past the warning a console server waits on */
+    if(a_bDaemon == OpcUa_False)
+    {
+        OpcUa_GotoErrorIfTrue(write(pServer->iInput, "\n", 1) != 1, OpcUa_BadInternalError);
+    }
+
+    while(!UaTest_Server_IsListening())
+    {
+        UATEST_CHECK(waitpid(pServer->iPid, OpcUa_Null, WNOHANG) == 0);
+        UATEST_CHECK(uWaited < UATEST_SERVER_TIMEOUT);
+        usleep(10000);
+        uWaited += 10;
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    for(uWaited = 0; uWaited < 2; uWaited++)
+    {
+        if(aiInput[uWaited] >= 0)
+        {
+            close(aiInput[uWaited]);
+        }
+        if(aiOutput[uWaited] >= 0)
+        {
+            close(aiOutput[uWaited]);
+        }
+    }
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Server_WaitForExit
+ *===========================================================================*/
+/* collects the output of the server until it exits; true if it exited with 0 */
+static OpcUa_Boolean UaTest_Server_WaitForExit(OpcUa_Void)
+{
+    UaTest_Server*  pServer     = &UaTest_g_Server;
+    struct pollfd   Output;
+    char            sDropped[256];
+    ssize_t         iRead       = 0;
+    int             iStatus     = 0;
+    OpcUa_UInt32    uWaited     = 0;
+
+    /* the output ends when the server exits */
+    Output.fd     = pServer->iOutput;
+    Output.events = POLLIN;
+    for(;;)
+    {
+        Output.revents = 0;
+        if(uWaited >= UATEST_SERVER_TIMEOUT || poll(&Output, 1, 10) < 0)
+        {
+            return OpcUa_False;
+        }
+        uWaited += 10;
+        if((Output.revents & (POLLIN | POLLHUP)) == 0)
+        {
+            continue;
+        }
+        if(pServer->uOutput < sizeof(pServer->sOutput) - 1)
+        {
+            iRead = read(pServer->iOutput, pServer->sOutput + pServer->uOutput, sizeof(pServer->sOutput) - 1 - pServer->uOutput);
+            if(iRead > 0)
+            {
+                pServer->uOutput += (size_t)iRead;
+                pServer->sOutput[pServer->uOutput] = '\0';
+            }
+        }
+        else
+        {
+            iRead = read(pServer->iOutput, sDropped, sizeof(sDropped));
+        }
+        if(iRead == 0)
+        {
+            break;
+        }
+        if(iRead < 0 && errno != EINTR)
+        {
+            return OpcUa_False;
+        }
+    }
+
+    if(waitpid(pServer->iPid, &iStatus, 0) != pServer->iPid)
+    {
+        return OpcUa_False;
+    }
+    pServer->iPid = 0;
+
+    return (WIFEXITED(iStatus) && WEXITSTATUS(iStatus) == 0)?OpcUa_True:OpcUa_False;
+}
+
+/*============================================================================
+ * UaTest_Server_Signal
+ *===========================================================================*/
+/* a daemon ignores the console, stops on the signal and runs the same shutdown as on x */
+static OpcUa_StatusCode UaTest_Server_Signal(int a_iSignal)
+{
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Server_Signal");
+
+    uStatus = UaTest_Server_Start(OpcUa_True);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    UATEST_CHECK(write(UaTest_g_Server.iInput, "x\n", 2) == 2);
+    usleep(UATEST_SERVER_SETTLETIME * 1000);
+    UATEST_CHECK(UaTest_Server_IsListening());
+
+    UATEST_CHECK(kill(UaTest_g_Server.iPid, a_iSignal) == 0);
+    UATEST_CHECK(UaTest_Server_WaitForExit());
+    UATEST_CHECK(strstr(UaTest_g_Server.sOutput, "Server stopped!") != OpcUa_Null);
+    UATEST_CHECK(strstr(UaTest_g_Server.sOutput, "Shutdown complete!") != OpcUa_Null);
+    /* a daemon never prompts */
+    UATEST_CHECK(strstr(UaTest_g_Server.sOutput, "Press enter") == OpcUa_Null);
+
+    UaTest_Server_Clear();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_Server_Clear();
+
+OpcUa_FinishErrorHandling;
+}
+
+static OpcUa_StatusCode UaTest_Server_SigTerm(OpcUa_Void)
+{
+    return UaTest_Server_Signal(SIGTERM);
+}
+
+static OpcUa_StatusCode UaTest_Server_SigInt(OpcUa_Void)
+{
+    return UaTest_Server_Signal(SIGINT);
+}
+
+/*============================================================================
+ * UaTest_Server_Console
+ *===========================================================================*/
+/* x on the console stops the server; it ignores other input */
+static OpcUa_StatusCode UaTest_Server_Console(OpcUa_Void)
+{
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Server_Console");
+
+    uStatus = UaTest_Server_Start(OpcUa_False);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    UATEST_CHECK(write(UaTest_g_Server.iInput, "a\n", 2) == 2);
+    usleep(UATEST_SERVER_SETTLETIME * 1000);
+    UATEST_CHECK(UaTest_Server_IsListening());
+
+    /* the line end answers the prompt before the exit */
+    UATEST_CHECK(write(UaTest_g_Server.iInput, "x\n", 2) == 2);
+    UATEST_CHECK(UaTest_Server_WaitForExit());
+    UATEST_CHECK(strstr(UaTest_g_Server.sOutput, "Shutdown complete!") != OpcUa_Null);
+
+    UaTest_Server_Clear();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_Server_Clear();
+
+OpcUa_FinishErrorHandling;
+}
+
+#endif /* __linux__ && UATEST_SAMPLE_SERVER */
+
+/*============================================================================
+ * Case table
+ *===========================================================================*/
+UaTest_Case UaTest_g_ServerCases[] =
+{
+#if defined(__linux__) && defined(UATEST_SAMPLE_SERVER)
+    { "sample/server/sigterm",  UaTest_Server_SigTerm },
+    { "sample/server/sigint",   UaTest_Server_SigInt },
+    { "sample/server/console",  UaTest_Server_Console },
+#endif /* __linux__ && UATEST_SAMPLE_SERVER */
+    UATEST_CASE_END
+};
@@ -0,0 +1,171 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+/******************************************************************************************************/
+/* Tests for the session table of the sample server: expiry on the timer wheel.                      */
+/******************************************************************************************************/
+
+#include <opcua_serverstub.h>
+#include <opcua_memory.h>
+
+#include "sessiontable.h"
+
+#include "uatest.h"
+#include "uatest_sample.h"
+
+/*============================================================================
+ * UaTest_Sessions_Expire
+ *===========================================================================*/
+/* idle sessions end on the tick their timeout runs out, also beyond one round of the wheel */
+static OpcUa_StatusCode UaTest_Sessions_Expire(OpcUa_Void)
+{
+    OpcUa_RequestHeader Short;
+    OpcUa_RequestHeader Long;
+    OpcUa_UInt32        uShortId    = 0;
+    OpcUa_UInt32        uLongId     = 0;
+    OpcUa_UInt32        uLongTime   = (SESSION_WHEEL_SLOTS + 44) * SESSION_TICK;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Sessions_Expire");
+
+    OpcUa_RequestHeader_Initialize(&Short);
+    OpcUa_RequestHeader_Initialize(&Long);
+    UaTest_g_uNoOfEndedSessions = 0;
+
+    uStatus = initialize_sessions();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = UaTest_Sample_OpenSession(10 * SESSION_TICK, &Short, &uShortId);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_Sample_OpenSession(uLongTime, &Long, &uLongId);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* a request one tick before the timeout moves the deadline */
+    expire_sessions(9 * SESSION_TICK);
+    UATEST_CHECK(UaTest_g_uNoOfEndedSessions == 0);
+    UATEST_CHECK(check_session(&Short, OpcUa_Null) == OpcUa_Good);
+
+    expire_sessions(9 * SESSION_TICK);
+    UATEST_CHECK(UaTest_g_uNoOfEndedSessions == 0);
+
+    /* elapsed time below a tick is carried over */
+    expire_sessions(SESSION_TICK / 2);
+    UATEST_CHECK(UaTest_g_uNoOfEndedSessions == 0);
+    expire_sessions(SESSION_TICK - SESSION_TICK / 2);
+    UATEST_CHECK(UaTest_g_uNoOfEndedSessions == 1);
+    UATEST_CHECK(UaTest_g_uLastEndedSession == uShortId);
+    UATEST_CHECK(check_session(&Short, OpcUa_Null) == OpcUa_BadSessionIdInvalid);
+
+    /* the long session passes its slot once before its round comes */
+    expire_sessions(uLongTime - 19 * SESSION_TICK - 1);
+    UATEST_CHECK(UaTest_g_uNoOfEndedSessions == 1);
+    expire_sessions(1);
+    UATEST_CHECK(UaTest_g_uNoOfEndedSessions == 2);
+    UATEST_CHECK(UaTest_g_uLastEndedSession == uLongId);
+    UATEST_CHECK(check_session(&Long, OpcUa_Null) == OpcUa_BadSessionIdInvalid);
+
+    OpcUa_RequestHeader_Clear(&Short);
+    OpcUa_RequestHeader_Clear(&Long);
+    clear_sessions();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_RequestHeader_Clear(&Short);
+    OpcUa_RequestHeader_Clear(&Long);
+    clear_sessions();
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Sessions_KeepAlive
+ *===========================================================================*/
+/* requests keep a session alive for many timeouts; it ends one timeout after the last one */
+static OpcUa_StatusCode UaTest_Sessions_KeepAlive(OpcUa_Void)
+{
+    OpcUa_RequestHeader Active;
+    OpcUa_RequestHeader Idle;
+    OpcUa_UInt32        uActiveId   = 0;
+    OpcUa_UInt32        uIdleId     = 0;
+    OpcUa_UInt32        uSessionId  = 0;
+    OpcUa_Int           i           = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Sessions_KeepAlive");
+
+    OpcUa_RequestHeader_Initialize(&Active);
+    OpcUa_RequestHeader_Initialize(&Idle);
+    UaTest_g_uNoOfEndedSessions = 0;
+
+    uStatus = initialize_sessions();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = UaTest_Sample_OpenSession(10 * SESSION_TICK, &Active, &uActiveId);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_Sample_OpenSession(10 * SESSION_TICK, &Idle, &uIdleId);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    for(i = 0; i < 20; i++)
+    {
+        expire_sessions(5 * SESSION_TICK);
+        UATEST_CHECK(check_session(&Active, &uSessionId) == OpcUa_Good);
+        UATEST_CHECK(uSessionId == uActiveId);
+    }
+
+    /* only the idle session ended meanwhile */
+    UATEST_CHECK(UaTest_g_uNoOfEndedSessions == 1);
+    UATEST_CHECK(UaTest_g_uLastEndedSession == uIdleId);
+    UATEST_CHECK(check_session(&Idle, OpcUa_Null) == OpcUa_BadSessionIdInvalid);
+
+    expire_sessions(10 * SESSION_TICK - 1);
+    UATEST_CHECK(UaTest_g_uNoOfEndedSessions == 1);
+    expire_sessions(1);
+    UATEST_CHECK(UaTest_g_uNoOfEndedSessions == 2);
+    UATEST_CHECK(UaTest_g_uLastEndedSession == uActiveId);
+
+    /* closing ends the subscriptions as well, only once */
+    OpcUa_RequestHeader_Clear(&Idle);
+    uStatus = UaTest_Sample_OpenSession(10 * SESSION_TICK, &Idle, &uIdleId);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(close_session(&Idle) == OpcUa_Good);
+    UATEST_CHECK(UaTest_g_uNoOfEndedSessions == 3);
+    UATEST_CHECK(UaTest_g_uLastEndedSession == uIdleId);
+    UATEST_CHECK(close_session(&Idle) == OpcUa_BadSessionIdInvalid);
+    expire_sessions(20 * SESSION_TICK);
+    UATEST_CHECK(UaTest_g_uNoOfEndedSessions == 3);
+
+    OpcUa_RequestHeader_Clear(&Active);
+    OpcUa_RequestHeader_Clear(&Idle);
+    clear_sessions();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_RequestHeader_Clear(&Active);
+    OpcUa_RequestHeader_Clear(&Idle);
+    clear_sessions();
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * Case table
+ *===========================================================================*/
+UaTest_Case UaTest_g_SessionCases[] =
+{
+    { "sample/sessions/expire",     UaTest_Sessions_Expire },
+    { "sample/sessions/keepalive",  UaTest_Sessions_KeepAlive },
+    UATEST_CASE_END
+};
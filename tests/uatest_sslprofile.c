@@ -0,0 +1,228 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+
+/******************************************************************************************************/
+/* Tests for the client SSL profiles: connections share a context only if certificate, private key,  */
+/* PKI configuration and remote address all match.                                                   */
+/******************************************************************************************************/
+
+#include <opcua.h>
+
+#include "uatest.h"
+
+#include <opcua_p_internal.h>
+#include <opcua_p_socket_ssl_profile.h>
+
+#include <string.h>
+
+#if OPCUA_P_SOCKETMANAGER_SUPPORT_SSL
+
+/*============================================================================
+ * Types and constants
+ *===========================================================================*/
+/** @brief Connections created by the key test. */
+#define UATEST_SSLPROFILE_CONNECTIONS   7
+
+/*============================================================================
+ * Globals
+ *===========================================================================*/
+/** @brief Contexts the profiles built; the stub loads no credentials. */
+static OpcUa_UInt32     UaTest_g_uNoOfSslContexts   = 0;
+static OpcUa_StatusCode UaTest_g_uSslContextStatus  = OpcUa_Good;
+
+static OpcUa_Byte       UaTest_g_SslCertificate[]   = "client certificate";
+static OpcUa_Byte       UaTest_g_SslKey[]           = "client key";
+static OpcUa_Byte       UaTest_g_SslOtherKey[]      = "other client key";
+static OpcUa_CharA      UaTest_g_sSslTrusted[]      = "/pki/trusted";
+static OpcUa_CharA      UaTest_g_sSslTrustedCopy[]  = "/pki/trusted";
+static OpcUa_CharA      UaTest_g_sSslOtherTrusted[] = "/pki/other";
+static OpcUa_CharA      UaTest_g_sSslServer[]       = "opc.https://localhost:4843";
+static OpcUa_CharA      UaTest_g_sSslServerCopy[]   = "opc.https://localhost:4843";
+static OpcUa_CharA      UaTest_g_sSslOtherServer[]  = "opc.https://localhost:4844";
+
+/*============================================================================
+ * UaTest_SslProfile_InitializeContext
+ *===========================================================================*/
+static OpcUa_StatusCode UaTest_SslProfile_InitializeContext(SSL_CTX*          a_pSslContext,
+                                                            OpcUa_ByteString* a_pCertificate,
+                                                            OpcUa_Key*        a_pPrivateKey)
+{
+    OpcUa_ReferenceParameter(a_pSslContext);
+    OpcUa_ReferenceParameter(a_pCertificate);
+    OpcUa_ReferenceParameter(a_pPrivateKey);
+
+    UaTest_g_uNoOfSslContexts++;
+    return UaTest_g_uSslContextStatus;
+}
+
+/*============================================================================
+ * UaTest_SslProfile_Connect
+ *===========================================================================*/
+static OpcUa_StatusCode UaTest_SslProfile_Connect(  OpcUa_Byte*                              a_pKey,
+                                                    OpcUa_P_OpenSSL_CertificateStore_Config* a_pPKIConfig,
+                                                    OpcUa_StringA                            a_sRemoteAddress,
+                                                    SSL**                                    a_ppSsl)
+{
+    OpcUa_ByteString Certificate;
+    OpcUa_Key        PrivateKey;
+
+    OpcUa_MemSet(&PrivateKey, 0, sizeof(PrivateKey));
+    Certificate.Data       = UaTest_g_SslCertificate;
+    Certificate.Length     = (OpcUa_Int32)sizeof(UaTest_g_SslCertificate);
+    PrivateKey.Type        = OpcUa_Crypto_KeyType_Rsa_Private;
+    PrivateKey.Key.Data    = a_pKey;
+    PrivateKey.Key.Length  = (OpcUa_Int32)strlen((char*)a_pKey);
+
+    return OpcUa_P_SslClientProfile_CreateConnection(   &Certificate,
+                                                        &PrivateKey,
+                                                        a_pPKIConfig,
+                                                        a_sRemoteAddress,
+                                                        UaTest_SslProfile_InitializeContext,
+                                                        a_ppSsl);
+}
+
+/*============================================================================
+ * UaTest_SslProfile_Key
+ *===========================================================================*/
+/* equal settings in other buffers share the context; any other key, trust list or server does not */
+static OpcUa_StatusCode UaTest_SslProfile_Key(OpcUa_Void)
+{
+    OpcUa_P_OpenSSL_CertificateStore_Config Config;
+    OpcUa_P_OpenSSL_CertificateStore_Config CopyConfig;
+    OpcUa_P_OpenSSL_CertificateStore_Config OtherConfig;
+    SSL*            apSsl[UATEST_SSLPROFILE_CONNECTIONS];
+    SSL_CTX*        pContext    = OpcUa_Null;
+    OpcUa_UInt32    i           = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "SslProfile_Key");
+
+    OpcUa_MemSet(apSsl, 0, sizeof(apSsl));
+    OpcUa_MemSet(&Config, 0, sizeof(Config));
+    Config.PkiType                      = OpcUa_OpenSSL_PKI;
+    Config.CertificateTrustListLocation = UaTest_g_sSslTrusted;
+    CopyConfig                              = Config;
+    CopyConfig.CertificateTrustListLocation = UaTest_g_sSslTrustedCopy;
+    OtherConfig                              = Config;
+    OtherConfig.CertificateTrustListLocation = UaTest_g_sSslOtherTrusted;
+    UaTest_g_uNoOfSslContexts  = 0;
+    UaTest_g_uSslContextStatus = OpcUa_Good;
+
+    uStatus = UaTest_SslProfile_Connect(UaTest_g_SslKey, &Config, UaTest_g_sSslServer, &apSsl[0]);
+    OpcUa_GotoErrorIfBad(uStatus);
+    pContext = SSL_get_SSL_CTX(apSsl[0]);
+
+    uStatus = UaTest_SslProfile_Connect(UaTest_g_SslKey, &CopyConfig, UaTest_g_sSslServerCopy, &apSsl[1]);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(SSL_get_SSL_CTX(apSsl[1]) == pContext);
+    UATEST_CHECK(UaTest_g_uNoOfSslContexts == 1);
+
+    uStatus = UaTest_SslProfile_Connect(UaTest_g_SslOtherKey, &Config, UaTest_g_sSslServer, &apSsl[2]);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(SSL_get_SSL_CTX(apSsl[2]) != pContext);
+
+    uStatus = UaTest_SslProfile_Connect(UaTest_g_SslKey, &OtherConfig, UaTest_g_sSslServer, &apSsl[3]);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(SSL_get_SSL_CTX(apSsl[3]) != pContext);
+
+    Config.Flags = OPCUA_P_PKI_OPENSSL_CHECK_REVOCATION_ALL;
+    uStatus = UaTest_SslProfile_Connect(UaTest_g_SslKey, &Config, UaTest_g_sSslServer, &apSsl[4]);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(SSL_get_SSL_CTX(apSsl[4]) != pContext);
+    Config.Flags = 0;
+
+    uStatus = UaTest_SslProfile_Connect(UaTest_g_SslKey, &Config, UaTest_g_sSslOtherServer, &apSsl[5]);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(SSL_get_SSL_CTX(apSsl[5]) != pContext);
+    UATEST_CHECK(UaTest_g_uNoOfSslContexts == 5);
+
+    /* all five profiles fit, so the first one is found again */
+    uStatus = UaTest_SslProfile_Connect(UaTest_g_SslKey, &Config, UaTest_g_sSslServer, &apSsl[6]);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(SSL_get_SSL_CTX(apSsl[6]) == pContext);
+    UATEST_CHECK(UaTest_g_uNoOfSslContexts == 5);
+
+    for(i = 0; i < UATEST_SSLPROFILE_CONNECTIONS; i++)
+    {
+        SSL_free(apSsl[i]);
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    for(i = 0; i < UATEST_SSLPROFILE_CONNECTIONS; i++)
+    {
+        if(apSsl[i] != OpcUa_Null)
+        {
+            SSL_free(apSsl[i]);
+        }
+    }
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_SslProfile_FailedInit
+ *===========================================================================*/
+/* a context whose credentials failed to load is not handed out again */
+static OpcUa_StatusCode UaTest_SslProfile_FailedInit(OpcUa_Void)
+{
+    OpcUa_P_OpenSSL_CertificateStore_Config Config;
+    SSL*            pSsl        = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "SslProfile_FailedInit");
+
+    OpcUa_MemSet(&Config, 0, sizeof(Config));
+    Config.PkiType                      = OpcUa_OpenSSL_PKI;
+    Config.CertificateTrustListLocation = UaTest_g_sSslTrusted;
+    UaTest_g_uNoOfSslContexts  = 0;
+    UaTest_g_uSslContextStatus = OpcUa_BadInternalError;
+
+    uStatus = UaTest_SslProfile_Connect(UaTest_g_SslKey, &Config, UaTest_g_sSslServer, &pSsl);
+    UATEST_CHECK(uStatus == OpcUa_BadInternalError);
+    UATEST_CHECK(pSsl == OpcUa_Null);
+
+    UaTest_g_uSslContextStatus = OpcUa_Good;
+    uStatus = UaTest_SslProfile_Connect(UaTest_g_SslKey, &Config, UaTest_g_sSslServer, &pSsl);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(UaTest_g_uNoOfSslContexts == 2);
+
+    SSL_free(pSsl);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    if(pSsl != OpcUa_Null)
+    {
+        SSL_free(pSsl);
+    }
+
+OpcUa_FinishErrorHandling;
+}
+
+#endif /* OPCUA_P_SOCKETMANAGER_SUPPORT_SSL */
+
+/*============================================================================
+ * Case table
+ *===========================================================================*/
+UaTest_Case UaTest_g_SslProfileCases[] =
+{
+#if OPCUA_P_SOCKETMANAGER_SUPPORT_SSL
+    { "stack/ssl/clientprofile/key",        UaTest_SslProfile_Key },
+    { "stack/ssl/clientprofile/failedinit", UaTest_SslProfile_FailedInit },
+#endif /* OPCUA_P_SOCKETMANAGER_SUPPORT_SSL */
+    UATEST_CASE_END
+};
@@ -0,0 +1,766 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+
+/******************************************************************************************************/
+/* Tests for the subscriptions of the sample server: a client creates a subscription and monitored   */
+/* items through a real endpoint and publishes the changes of the value store.                       */
+/******************************************************************************************************/
+
+#include <opcua_serverstub.h>
+#include <opcua_memory.h>
+#include <opcua_core.h>
+
+#include "addressspace.h"
+#include "browseservice.h"
+#include "sessiontable.h"
+#include "subscriptionservice.h"
+#include "valuestore.h"
+
+#include "uatest.h"
+#include "uatest_loopback.h"
+#include "uatest_sample.h"
+
+#if defined(OPCUA_HAVE_CLIENTAPI) && defined(OPCUA_HAVE_SERVERAPI)
+
+#include <opcua_binaryencoder.h>
+#include <opcua_memorystream.h>
+
+#include <string.h>
+
+/*============================================================================
+ * Test settings
+ *===========================================================================*/
+/** @brief Number of variables which can be monitored. */
+#define UATEST_SUBSCRIPTION_VARIABLES       3
+/** @brief Value the first variable refers to; the last one of the value store. The others use the ones before it. */
+#define UATEST_SUBSCRIPTION_VALUEINDEX      (ARRAYSIZE_OF_VALUEATTRIBUTE - 1)
+/** @brief Numeric NodeId of the first variable in namespace 2; the others follow it. */
+#define UATEST_SUBSCRIPTION_NODEID          5001
+/** @brief Client handle of the item of the first variable; the others follow it. */
+#define UATEST_SUBSCRIPTION_CLIENTHANDLE    42
+
+/*============================================================================
+ * UaTest_Subscription
+ *===========================================================================*/
+typedef struct _UaTest_Subscription
+{
+    UaTest_Loopback                 Loopback;
+    OpcUa_ServiceType               CreateSubscriptionType;
+    OpcUa_ServiceType               CreateMonitoredItemsType;
+    OpcUa_ServiceType               DeleteSubscriptionsType;
+    OpcUa_ServiceType               PublishType;
+    /** @brief The PublishResponse type with an Encode that checks the sizes of the notification bodies. */
+    OpcUa_EncodeableType            PublishResponseType;
+    /** @brief Notification bodies with a size given in advance, and how many of them had a wrong one. */
+    OpcUa_UInt32                    uNoOfBodies;
+    OpcUa_UInt32                    uNoOfBodySizeErrors;
+    OpcUa_ServiceType*              apServices[5];
+    _VariableKnoten_                aVariables[UATEST_SUBSCRIPTION_VARIABLES];
+    _AddressSpaceTables_            Tables;
+    OpcUa_RequestHeader             RequestHeader;
+    OpcUa_UInt32                    uSubscriptionId;
+} UaTest_Subscription;
+
+static UaTest_Subscription UaTest_g_Subscription;
+
+/*============================================================================
+ * Globals
+ *===========================================================================*/
+extern my_Variant                   all_ValueAttribute_of_VariableTypeNodes_VariableNodes[];
+extern OpcUa_EncodeableTypeTable    OpcUa_ProxyStub_g_EncodeableTypes;
+extern OpcUa_StringTable            OpcUa_ProxyStub_g_NamespaceUris;
+
+/*============================================================================
+ * UaTest_Subscription_Write
+ *===========================================================================*/
+/* the monitored variable becomes a Double with the value as its source timestamp */
+static OpcUa_Void UaTest_Subscription_Write(OpcUa_Double a_dValue)
+{
+    my_Variant*     pValue  = &all_ValueAttribute_of_VariableTypeNodes_VariableNodes[UATEST_SUBSCRIPTION_VALUEINDEX];
+    OpcUa_DateTime  SourceTimestamp;
+
+    OpcUa_MemSet(&SourceTimestamp, 0, sizeof(SourceTimestamp));
+    SourceTimestamp.dwLowDateTime = (OpcUa_UInt32)a_dValue;
+
+    write_value_begin(UATEST_SUBSCRIPTION_VALUEINDEX);
+    pValue->Datatype        = OpcUaId_Double;
+    pValue->ArrayType       = OpcUa_VariantArrayType_Scalar;
+    pValue->Value.Double    = a_dValue;
+    write_value_end(UATEST_SUBSCRIPTION_VALUEINDEX, &SourceTimestamp);
+}
+
+/*============================================================================
+ * UaTest_Subscription_Set
+ *===========================================================================*/
+/* a variable gets a value with its number plus one as its source timestamp */
+static OpcUa_Void UaTest_Subscription_Set(  OpcUa_UInt32        a_uVariable,
+                                            const my_Variant*   a_pValue)
+{
+    OpcUa_Int       iIndex  = UATEST_SUBSCRIPTION_VALUEINDEX - (OpcUa_Int)a_uVariable;
+    OpcUa_DateTime  SourceTimestamp;
+
+    OpcUa_MemSet(&SourceTimestamp, 0, sizeof(SourceTimestamp));
+    SourceTimestamp.dwLowDateTime = a_uVariable + 1;
+
+    write_value_begin(iIndex);
+    all_ValueAttribute_of_VariableTypeNodes_VariableNodes[iIndex] = *a_pValue;
+    write_value_end(iIndex, &SourceTimestamp);
+}
+
+/*============================================================================
+ * UaTest_Subscription_GetBodySize
+ *===========================================================================*/
+/* the length of the encoded body of an extension object; -1 if it cannot be encoded */
+static OpcUa_Int32 UaTest_Subscription_GetBodySize(OpcUa_ExtensionObject* a_pBody)
+{
+    OpcUa_MessageContext    Context;
+    OpcUa_OutputStream*     pOstrm          = OpcUa_Null;
+    OpcUa_Encoder*          pEncoder        = OpcUa_Null;
+    OpcUa_Handle            hEncodeContext  = OpcUa_Null;
+    OpcUa_UInt32            uPosition       = 0;
+    OpcUa_Int32             iSize           = -1;
+
+    OpcUa_MessageContext_Initialize(&Context);
+    Context.KnownTypes      = &OpcUa_ProxyStub_g_EncodeableTypes;
+    Context.NamespaceUris   = &OpcUa_ProxyStub_g_NamespaceUris;
+
+    if(    OpcUa_IsGood(OpcUa_MemoryStream_CreateWriteable(1024, 0, &pOstrm))
+        && OpcUa_IsGood(OpcUa_BinaryEncoder_Create(&pEncoder))
+        && OpcUa_IsGood(pEncoder->Open(pEncoder, pOstrm, &Context, &hEncodeContext)))
+    {
+        if(    OpcUa_IsGood(pEncoder->WriteEncodeable(  (struct _OpcUa_Encoder*)hEncodeContext,
+                                                        OpcUa_Null,
+                                                        a_pBody->Body.EncodeableObject.Object,
+                                                        a_pBody->Body.EncodeableObject.Type,
+                                                        OpcUa_Null))
+            && OpcUa_IsGood(OpcUa_Stream_GetPosition((OpcUa_Stream*)pOstrm, &uPosition)))
+        {
+            iSize = (OpcUa_Int32)uPosition;
+        }
+        OpcUa_Encoder_Close(pEncoder, &hEncodeContext);
+    }
+
+    if(pEncoder != OpcUa_Null)
+    {
+        OpcUa_Encoder_Delete(&pEncoder);
+    }
+    if(pOstrm != OpcUa_Null)
+    {
+        OpcUa_Stream_Delete((OpcUa_Stream**)&pOstrm);
+    }
+    OpcUa_MessageContext_Clear(&Context);
+
+    return iSize;
+}
+
+/*============================================================================
+ * UaTest_Subscription_EncodePublishResponse
+ *===========================================================================*/
+/* the decoder of the stack only warns about a wrong body size, so it is checked before the response goes out */
+static OpcUa_StatusCode UaTest_Subscription_EncodePublishResponse(  OpcUa_Void*             a_pValue,
+                                                                    struct _OpcUa_Encoder*  a_pEncoder)
+{
+    OpcUa_PublishResponse*  pResponse   = (OpcUa_PublishResponse*)a_pValue;
+    OpcUa_ExtensionObject*  pBody       = OpcUa_Null;
+    OpcUa_Int32             i;
+
+    for(i = 0; i < pResponse->NotificationMessage.NoOfNotificationData; i++)
+    {
+        pBody = &pResponse->NotificationMessage.NotificationData[i];
+        if(pBody->Encoding != OpcUa_ExtensionObjectEncoding_EncodeableObject || pBody->BodySize <= 0)
+        {
+            continue;
+        }
+
+        if(UaTest_Subscription_GetBodySize(pBody) != pBody->BodySize)
+        {
+            OpcUa_Atomic_Add32(&UaTest_g_Subscription.uNoOfBodySizeErrors, 1);
+        }
+        OpcUa_Atomic_Add32(&UaTest_g_Subscription.uNoOfBodies, 1);
+    }
+
+    return OpcUa_PublishResponse_EncodeableType.Encode(a_pValue, a_pEncoder);
+}
+
+/*============================================================================
+ * UaTest_Subscription_Open
+ *===========================================================================*/
+/* indexes the variables, opens a session and connects a channel to the subscription services */
+static OpcUa_StatusCode UaTest_Subscription_Open(OpcUa_Void)
+{
+    UaTest_Subscription* pTest = &UaTest_g_Subscription;
+    _VariableKnoten_*    pVariable  = OpcUa_Null;
+    OpcUa_UInt32         uSessionId = 0;
+    OpcUa_UInt32         i;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Subscription_Open");
+
+    memset(pTest, 0, sizeof(UaTest_Subscription));
+    OpcUa_RequestHeader_Initialize(&pTest->RequestHeader);
+
+    for(i = 0; i < UATEST_SUBSCRIPTION_VARIABLES; i++)
+    {
+        pVariable = &pTest->aVariables[i];
+        pVariable->BaseAttribute.NodeId.NamespaceIndex      = 2;
+        pVariable->BaseAttribute.NodeId.Identifier.Numeric  = UATEST_SUBSCRIPTION_NODEID + i;
+        pVariable->BaseAttribute.NodeClass                  = OpcUa_NodeClass_Variable;
+        pVariable->BaseAttribute.BrowseName                 = "UaTestVariable";
+        pVariable->BaseAttribute.DisplayName                = "UaTestVariable";
+        pVariable->ValueIndex                               = UATEST_SUBSCRIPTION_VALUEINDEX - (OpcUa_Int)i;
+        pVariable->AccessLevel                              = OpcUa_AccessLevels_CurrentRead;
+        pVariable->UserAccessLevel                          = OpcUa_AccessLevels_CurrentRead;
+    }
+    pTest->Tables.Variables                                 = pTest->aVariables;
+    pTest->Tables.NoOfVariables                             = UATEST_SUBSCRIPTION_VARIABLES;
+
+    uStatus = build_node_index(&pTest->Tables);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = initialize_sessions();
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_Sample_OpenSession(60000, &pTest->RequestHeader, &uSessionId);
+    OpcUa_GotoErrorIfBad(uStatus);
+    pTest->RequestHeader.TimeoutHint = UATEST_LOOPBACK_TIMEOUT;
+
+    uStatus = initialize_subscriptions();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    pTest->CreateSubscriptionType.RequestTypeId     = OpcUaId_CreateSubscriptionRequest;
+    pTest->CreateSubscriptionType.ResponseType      = &OpcUa_CreateSubscriptionResponse_EncodeableType;
+    pTest->CreateSubscriptionType.BeginInvoke       = OpcUa_Server_BeginCreateSubscription;
+    pTest->CreateSubscriptionType.Invoke            = (OpcUa_PfnInvokeService*)my_CreateSubscription;
+    pTest->CreateMonitoredItemsType.RequestTypeId   = OpcUaId_CreateMonitoredItemsRequest;
+    pTest->CreateMonitoredItemsType.ResponseType    = &OpcUa_CreateMonitoredItemsResponse_EncodeableType;
+    pTest->CreateMonitoredItemsType.BeginInvoke     = OpcUa_Server_BeginCreateMonitoredItems;
+    pTest->CreateMonitoredItemsType.Invoke          = (OpcUa_PfnInvokeService*)my_CreateMonitoredItems;
+    pTest->DeleteSubscriptionsType.RequestTypeId    = OpcUaId_DeleteSubscriptionsRequest;
+    pTest->DeleteSubscriptionsType.ResponseType     = &OpcUa_DeleteSubscriptionsResponse_EncodeableType;
+    pTest->DeleteSubscriptionsType.BeginInvoke      = OpcUa_Server_BeginDeleteSubscriptions;
+    pTest->DeleteSubscriptionsType.Invoke           = (OpcUa_PfnInvokeService*)my_DeleteSubscriptions;
+    pTest->PublishType.RequestTypeId                = OpcUaId_PublishRequest;
+    pTest->PublishResponseType                      = OpcUa_PublishResponse_EncodeableType;
+    pTest->PublishResponseType.Encode               = UaTest_Subscription_EncodePublishResponse;
+    pTest->PublishType.ResponseType                 = &pTest->PublishResponseType;
+    pTest->PublishType.BeginInvoke                  = (OpcUa_PfnBeginInvokeService*)my_BeginPublish;
+    pTest->PublishType.Invoke                       = (OpcUa_PfnInvokeService*)OpcUa_ServerApi_Publish;
+    pTest->apServices[0] = &pTest->CreateSubscriptionType;
+    pTest->apServices[1] = &pTest->CreateMonitoredItemsType;
+    pTest->apServices[2] = &pTest->DeleteSubscriptionsType;
+    pTest->apServices[3] = &pTest->PublishType;
+    pTest->apServices[4] = OpcUa_Null;
+
+    uStatus = UaTest_Loopback_Open(&pTest->Loopback, pTest->apServices);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Subscription_Clear
+ *===========================================================================*/
+/* the timer stops before the endpoint goes away, the tables after it */
+static OpcUa_Void UaTest_Subscription_Clear(OpcUa_Void)
+{
+    UaTest_Subscription* pTest = &UaTest_g_Subscription;
+
+    stop_subscriptions();
+    UaTest_Loopback_Clear(&pTest->Loopback);
+    clear_subscriptions();
+    clear_sessions();
+    clear_node_index();
+    OpcUa_RequestHeader_Clear(&pTest->RequestHeader);
+}
+
+/*============================================================================
+ * UaTest_Subscription_Create
+ *===========================================================================*/
+/* a subscription of 100 msec whose keep-alive is due after five empty cycles */
+static OpcUa_StatusCode UaTest_Subscription_Create(OpcUa_UInt32 a_uMaxNotificationsPerPublish)
+{
+    UaTest_Subscription*    pTest                       = &UaTest_g_Subscription;
+    OpcUa_ResponseHeader    ResponseHeader;
+    OpcUa_Double            dRevisedPublishingInterval  = 0;
+    OpcUa_UInt32            uRevisedLifetimeCount       = 0;
+    OpcUa_UInt32            uRevisedMaxKeepAliveCount   = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Subscription_Create");
+
+    OpcUa_ResponseHeader_Initialize(&ResponseHeader);
+
+    pTest->RequestHeader.RequestHandle++;
+    uStatus = OpcUa_ClientApi_CreateSubscription(   pTest->Loopback.hChannel,
+                                                    &pTest->RequestHeader,
+                                                    100,
+                                                    100,
+                                                    5,
+                                                    a_uMaxNotificationsPerPublish,
+                                                    OpcUa_True,
+                                                    0,
+                                                    &ResponseHeader,
+                                                    &pTest->uSubscriptionId,
+                                                    &dRevisedPublishingInterval,
+                                                    &uRevisedLifetimeCount,
+                                                    &uRevisedMaxKeepAliveCount);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(ResponseHeader.ServiceResult == OpcUa_Good);
+    UATEST_CHECK(pTest->uSubscriptionId != 0);
+    UATEST_CHECK(dRevisedPublishingInterval == 100);
+    UATEST_CHECK(uRevisedMaxKeepAliveCount == 5);
+
+    OpcUa_ResponseHeader_Clear(&ResponseHeader);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_ResponseHeader_Clear(&ResponseHeader);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Subscription_Monitor
+ *===========================================================================*/
+/* reports the first a_uNoOfVariables variables with both timestamps, sampled every 50 msec */
+static OpcUa_StatusCode UaTest_Subscription_Monitor(OpcUa_UInt32 a_uNoOfVariables)
+{
+    UaTest_Subscription*                pTest           = &UaTest_g_Subscription;
+    OpcUa_ResponseHeader                ResponseHeader;
+    OpcUa_MonitoredItemCreateRequest    aItemsToCreate[UATEST_SUBSCRIPTION_VARIABLES];
+    OpcUa_Int32                         nNoOfResults    = 0;
+    OpcUa_MonitoredItemCreateResult*    pItemResults    = OpcUa_Null;
+    OpcUa_Int32                         nNoOfDiagnosticInfos = 0;
+    OpcUa_DiagnosticInfo*               pDiagnosticInfos = OpcUa_Null;
+    OpcUa_UInt32                        i;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Subscription_Monitor");
+
+    OpcUa_ResponseHeader_Initialize(&ResponseHeader);
+
+    for(i = 0; i < a_uNoOfVariables; i++)
+    {
+        OpcUa_MonitoredItemCreateRequest_Initialize(&aItemsToCreate[i]);
+        aItemsToCreate[i].ItemToMonitor.NodeId.NamespaceIndex       = 2;
+        aItemsToCreate[i].ItemToMonitor.NodeId.Identifier.Numeric   = UATEST_SUBSCRIPTION_NODEID + i;
+        aItemsToCreate[i].ItemToMonitor.AttributeId                 = OpcUa_Attributes_Value;
+        aItemsToCreate[i].MonitoringMode                            = OpcUa_MonitoringMode_Reporting;
+        aItemsToCreate[i].RequestedParameters.ClientHandle          = UATEST_SUBSCRIPTION_CLIENTHANDLE + i;
+        aItemsToCreate[i].RequestedParameters.SamplingInterval      = 50;
+        aItemsToCreate[i].RequestedParameters.QueueSize             = 1;
+    }
+
+    pTest->RequestHeader.RequestHandle++;
+    uStatus = OpcUa_ClientApi_CreateMonitoredItems( pTest->Loopback.hChannel,
+                                                    &pTest->RequestHeader,
+                                                    pTest->uSubscriptionId,
+                                                    OpcUa_TimestampsToReturn_Both,
+                                                    (OpcUa_Int32)a_uNoOfVariables,
+                                                    aItemsToCreate,
+                                                    &ResponseHeader,
+                                                    &nNoOfResults,
+                                                    &pItemResults,
+                                                    &nNoOfDiagnosticInfos,
+                                                    &pDiagnosticInfos);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(ResponseHeader.ServiceResult == OpcUa_Good);
+    UATEST_CHECK(nNoOfResults == (OpcUa_Int32)a_uNoOfVariables);
+    for(i = 0; i < a_uNoOfVariables; i++)
+    {
+        UATEST_CHECK(pItemResults[i].StatusCode == OpcUa_Good);
+        UATEST_CHECK(pItemResults[i].MonitoredItemId != 0);
+    }
+
+    OpcUa_Free(pItemResults);
+    OpcUa_ResponseHeader_Clear(&ResponseHeader);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_Free(pItemResults);
+    OpcUa_ResponseHeader_Clear(&ResponseHeader);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Subscription_Delete
+ *===========================================================================*/
+static OpcUa_StatusCode UaTest_Subscription_Delete(OpcUa_Void)
+{
+    UaTest_Subscription*    pTest           = &UaTest_g_Subscription;
+    OpcUa_ResponseHeader    ResponseHeader;
+    OpcUa_Int32             nNoOfResults    = 0;
+    OpcUa_StatusCode*       pDeleteResults  = OpcUa_Null;
+    OpcUa_Int32             nNoOfDiagnosticInfos = 0;
+    OpcUa_DiagnosticInfo*   pDiagnosticInfos = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Subscription_Delete");
+
+    OpcUa_ResponseHeader_Initialize(&ResponseHeader);
+
+    pTest->RequestHeader.RequestHandle++;
+    uStatus = OpcUa_ClientApi_DeleteSubscriptions(  pTest->Loopback.hChannel,
+                                                    &pTest->RequestHeader,
+                                                    1,
+                                                    &pTest->uSubscriptionId,
+                                                    &ResponseHeader,
+                                                    &nNoOfResults,
+                                                    &pDeleteResults,
+                                                    &nNoOfDiagnosticInfos,
+                                                    &pDiagnosticInfos);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(ResponseHeader.ServiceResult == OpcUa_Good);
+    UATEST_CHECK(nNoOfResults == 1);
+    UATEST_CHECK(pDeleteResults[0] == OpcUa_Good);
+
+    OpcUa_Free(pDeleteResults);
+    OpcUa_ResponseHeader_Clear(&ResponseHeader);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_Free(pDeleteResults);
+    OpcUa_ResponseHeader_Clear(&ResponseHeader);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Subscription_Publish
+ *===========================================================================*/
+/* sends a Publish with at most one acknowledgement and returns the message, its flag for more and the ack result */
+static OpcUa_StatusCode UaTest_Subscription_Publish(OpcUa_UInt32                a_uAcknowledge,
+                                                    OpcUa_UInt32*               a_puSubscriptionId,
+                                                    OpcUa_NotificationMessage*  a_pMessage,
+                                                    OpcUa_Boolean*              a_pbMoreNotifications,
+                                                    OpcUa_StatusCode*           a_pAckResult)
+{
+    UaTest_Subscription*                    pTest               = &UaTest_g_Subscription;
+    OpcUa_SubscriptionAcknowledgement       Ack;
+    OpcUa_ResponseHeader                    ResponseHeader;
+    OpcUa_Int32                             nNoOfAvailable      = 0;
+    OpcUa_UInt32*                           pAvailable          = OpcUa_Null;
+    OpcUa_Int32                             nNoOfResults        = 0;
+    OpcUa_StatusCode*                       pResults            = OpcUa_Null;
+    OpcUa_Int32                             nNoOfDiagnosticInfos = 0;
+    OpcUa_DiagnosticInfo*                   pDiagnosticInfos    = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Subscription_Publish");
+
+    OpcUa_ResponseHeader_Initialize(&ResponseHeader);
+    Ack.SubscriptionId = pTest->uSubscriptionId;
+    Ack.SequenceNumber = a_uAcknowledge;
+
+    pTest->RequestHeader.RequestHandle++;
+    pTest->RequestHeader.Timestamp = OpcUa_DateTime_UtcNow();
+
+    uStatus = OpcUa_ClientApi_Publish(  pTest->Loopback.hChannel,
+                                        &pTest->RequestHeader,
+                                        (a_uAcknowledge != 0)?1:0,
+                                        (a_uAcknowledge != 0)?&Ack:OpcUa_Null,
+                                        &ResponseHeader,
+                                        a_puSubscriptionId,
+                                        &nNoOfAvailable,
+                                        &pAvailable,
+                                        a_pbMoreNotifications,
+                                        a_pMessage,
+                                        &nNoOfResults,
+                                        &pResults,
+                                        &nNoOfDiagnosticInfos,
+                                        &pDiagnosticInfos);
+    OpcUa_GotoErrorIfBad(uStatus);
+    OpcUa_GotoErrorIfBad(ResponseHeader.ServiceResult);
+
+    *a_pAckResult = OpcUa_Good;
+    if(a_uAcknowledge != 0)
+    {
+        OpcUa_GotoErrorIfTrue(nNoOfResults != 1, OpcUa_BadUnexpectedError);
+        *a_pAckResult = pResults[0];
+    }
+
+    OpcUa_Free(pAvailable);
+    OpcUa_Free(pResults);
+    OpcUa_ResponseHeader_Clear(&ResponseHeader);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_Free(pAvailable);
+    OpcUa_Free(pResults);
+    OpcUa_ResponseHeader_Clear(&ResponseHeader);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Subscription_GetChanges
+ *===========================================================================*/
+/* the single DataChangeNotification of a message if it has a_nNoOfItems items, else null */
+static OpcUa_DataChangeNotification* UaTest_Subscription_GetChanges(const OpcUa_NotificationMessage*    a_pMessage,
+                                                                    OpcUa_Int32                         a_nNoOfItems)
+{
+    OpcUa_DataChangeNotification*   pNotification   = OpcUa_Null;
+
+    if(    a_pMessage->NoOfNotificationData != 1
+        || a_pMessage->NotificationData[0].Encoding != OpcUa_ExtensionObjectEncoding_EncodeableObject
+        || a_pMessage->NotificationData[0].Body.EncodeableObject.Type != &OpcUa_DataChangeNotification_EncodeableType)
+    {
+        return OpcUa_Null;
+    }
+
+    pNotification = (OpcUa_DataChangeNotification*)a_pMessage->NotificationData[0].Body.EncodeableObject.Object;
+    if(    pNotification->NoOfMonitoredItems != a_nNoOfItems
+        || pNotification->NoOfDiagnosticInfos > 0)
+    {
+        return OpcUa_Null;
+    }
+
+    return pNotification;
+}
+
+/*============================================================================
+ * UaTest_Subscription_CheckChange
+ *===========================================================================*/
+/* OpcUa_True if the message carries exactly the change of the first variable to a_dValue */
+static OpcUa_Boolean UaTest_Subscription_CheckChange(   const OpcUa_NotificationMessage*    a_pMessage,
+                                                        OpcUa_Double                        a_dValue)
+{
+    OpcUa_DataChangeNotification*   pNotification   = UaTest_Subscription_GetChanges(a_pMessage, 1);
+    OpcUa_DataValue*                pValue          = OpcUa_Null;
+
+    if(    pNotification == OpcUa_Null
+        || pNotification->MonitoredItems[0].ClientHandle != UATEST_SUBSCRIPTION_CLIENTHANDLE)
+    {
+        return OpcUa_False;
+    }
+
+    pValue = &pNotification->MonitoredItems[0].Value;
+    return (OpcUa_Boolean)(    OpcUa_IsGood(pValue->StatusCode)
+                            && pValue->Value.Datatype == OpcUaType_Double
+                            && pValue->Value.ArrayType == OpcUa_VariantArrayType_Scalar
+                            && pValue->Value.Value.Double == a_dValue
+                            && pValue->SourceTimestamp.dwLowDateTime == (OpcUa_UInt32)a_dValue
+                            && pValue->SourceTimestamp.dwHighDateTime == 0
+                            && (pValue->ServerTimestamp.dwLowDateTime != 0 || pValue->ServerTimestamp.dwHighDateTime != 0));
+}
+
+/*============================================================================
+ * UaTest_Subscription_PublishRoundTrip
+ *===========================================================================*/
+/* the client creates a subscription and an item, and receives the first value, a change and a keep-alive */
+static OpcUa_StatusCode UaTest_Subscription_PublishRoundTrip(OpcUa_Void)
+{
+    UaTest_Subscription*                pTest           = &UaTest_g_Subscription;
+    my_Variant*                         pValue          = &all_ValueAttribute_of_VariableTypeNodes_VariableNodes[UATEST_SUBSCRIPTION_VALUEINDEX];
+    my_Variant                          Saved           = *pValue;
+    OpcUa_NotificationMessage           Message;
+    OpcUa_UInt32                        uSubscriptionId = 0;
+    OpcUa_Boolean                       bMoreNotifications = OpcUa_False;
+    OpcUa_StatusCode                    uAckResult      = OpcUa_Good;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Subscription_PublishRoundTrip");
+
+    OpcUa_NotificationMessage_Initialize(&Message);
+
+    initialize_value_store();
+    UaTest_Subscription_Write(42.0);
+
+    uStatus = UaTest_Subscription_Open();
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_Subscription_Create(0);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_Subscription_Monitor(1);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* the first sample is always reported */
+    uStatus = UaTest_Subscription_Publish(0, &uSubscriptionId, &Message, &bMoreNotifications, &uAckResult);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(uSubscriptionId == pTest->uSubscriptionId);
+    UATEST_CHECK(Message.SequenceNumber == 1);
+    UATEST_CHECK(UaTest_Subscription_CheckChange(&Message, 42.0));
+    OpcUa_NotificationMessage_Clear(&Message);
+
+    /* a change goes out with the next sequence number; the first message is acknowledged */
+    UaTest_Subscription_Write(43.0);
+    uStatus = UaTest_Subscription_Publish(1, &uSubscriptionId, &Message, &bMoreNotifications, &uAckResult);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(uAckResult == OpcUa_Good);
+    UATEST_CHECK(Message.SequenceNumber == 2);
+    UATEST_CHECK(UaTest_Subscription_CheckChange(&Message, 43.0));
+    OpcUa_NotificationMessage_Clear(&Message);
+
+    /* without a change only the keep-alive comes; it announces the next sequence number */
+    uStatus = UaTest_Subscription_Publish(5, &uSubscriptionId, &Message, &bMoreNotifications, &uAckResult);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(uAckResult == OpcUa_BadSequenceNumberUnknown);
+    UATEST_CHECK(uSubscriptionId == pTest->uSubscriptionId);
+    UATEST_CHECK(Message.SequenceNumber == 3);
+    UATEST_CHECK(Message.NoOfNotificationData == 0);
+    OpcUa_NotificationMessage_Clear(&Message);
+
+    uStatus = UaTest_Subscription_Delete();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    UaTest_Subscription_Clear();
+    *pValue = Saved;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_NotificationMessage_Clear(&Message);
+    UaTest_Subscription_Clear();
+    *pValue = Saved;
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Subscription_PublishBatch
+ *===========================================================================*/
+/* strings, arrays and null strings encoded from the batch decode to what the variables hold, */
+/* and MaxNotificationsPerPublish splits the pending values over two messages                 */
+static OpcUa_StatusCode UaTest_Subscription_PublishBatch(OpcUa_Void)
+{
+    static OpcUa_Double                 aDoubles[]      = { 1.5, -2.5, 1e300 };
+    static OpcUa_StringA                asStrings[]     = { "UaTest", OpcUa_Null, "" };
+    UaTest_Subscription*                pTest           = &UaTest_g_Subscription;
+    my_Variant*                         pValues         = &all_ValueAttribute_of_VariableTypeNodes_VariableNodes[UATEST_SUBSCRIPTION_VALUEINDEX - UATEST_SUBSCRIPTION_VARIABLES + 1];
+    my_Variant                          aSaved[UATEST_SUBSCRIPTION_VARIABLES];
+    my_Variant                          Value;
+    OpcUa_NotificationMessage           Message;
+    OpcUa_DataChangeNotification*       pNotification   = OpcUa_Null;
+    OpcUa_DataValue*                    pDataValue      = OpcUa_Null;
+    OpcUa_UInt32                        uSubscriptionId = 0;
+    OpcUa_Boolean                       bMoreNotifications = OpcUa_False;
+    OpcUa_StatusCode                    uAckResult      = OpcUa_Good;
+    OpcUa_Int32                         i;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Subscription_PublishBatch");
+
+    OpcUa_NotificationMessage_Initialize(&Message);
+    OpcUa_MemCpy(aSaved, sizeof(aSaved), pValues, sizeof(aSaved));
+
+    initialize_value_store();
+    OpcUa_MemSet(&Value, 0, sizeof(Value));
+    Value.Datatype                      = OpcUaId_String;
+    Value.ArrayType                     = OpcUa_VariantArrayType_Scalar;
+    Value.Value.String                  = "UaTest String";
+    UaTest_Subscription_Set(0, &Value);
+    Value.Datatype                      = OpcUaId_Double;
+    Value.ArrayType                     = OpcUa_VariantArrayType_Array;
+    Value.Value.Array.Length            = 3;
+    Value.Value.Array.Value.DoubleArray = aDoubles;
+    UaTest_Subscription_Set(1, &Value);
+    Value.Datatype                      = OpcUaId_String;
+    Value.Value.Array.Length            = 3;
+    Value.Value.Array.Value.StringArray = asStrings;
+    UaTest_Subscription_Set(2, &Value);
+
+    uStatus = UaTest_Subscription_Open();
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_Subscription_Create(2);
+    OpcUa_GotoErrorIfBad(uStatus);
+    uStatus = UaTest_Subscription_Monitor(UATEST_SUBSCRIPTION_VARIABLES);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* the first two items; the third one is announced */
+    uStatus = UaTest_Subscription_Publish(0, &uSubscriptionId, &Message, &bMoreNotifications, &uAckResult);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(uSubscriptionId == pTest->uSubscriptionId);
+    UATEST_CHECK(Message.SequenceNumber == 1);
+    UATEST_CHECK(bMoreNotifications != OpcUa_False);
+    pNotification = UaTest_Subscription_GetChanges(&Message, 2);
+    UATEST_CHECK(pNotification != OpcUa_Null);
+    for(i = 0; i < 2; i++)
+    {
+        pDataValue = &pNotification->MonitoredItems[i].Value;
+        UATEST_CHECK(pNotification->MonitoredItems[i].ClientHandle == UATEST_SUBSCRIPTION_CLIENTHANDLE + (OpcUa_UInt32)i);
+        UATEST_CHECK(OpcUa_IsGood(pDataValue->StatusCode));
+        UATEST_CHECK(pDataValue->SourceTimestamp.dwLowDateTime == (OpcUa_UInt32)i + 1);
+        UATEST_CHECK(pDataValue->SourceTimestamp.dwHighDateTime == 0);
+        UATEST_CHECK(pDataValue->ServerTimestamp.dwLowDateTime != 0 || pDataValue->ServerTimestamp.dwHighDateTime != 0);
+    }
+
+    pDataValue = &pNotification->MonitoredItems[0].Value;
+    UATEST_CHECK(pDataValue->Value.Datatype == OpcUaType_String);
+    UATEST_CHECK(pDataValue->Value.ArrayType == OpcUa_VariantArrayType_Scalar);
+    UATEST_CHECK(OpcUa_StrCmpA(OpcUa_String_GetRawString(&pDataValue->Value.Value.String), "UaTest String") == 0);
+
+    pDataValue = &pNotification->MonitoredItems[1].Value;
+    UATEST_CHECK(pDataValue->Value.Datatype == OpcUaType_Double);
+    UATEST_CHECK(pDataValue->Value.ArrayType == OpcUa_VariantArrayType_Array);
+    UATEST_CHECK(pDataValue->Value.Value.Array.Length == 3);
+    for(i = 0; i < 3; i++)
+    {
+        UATEST_CHECK(pDataValue->Value.Value.Array.Value.DoubleArray[i] == aDoubles[i]);
+    }
+    OpcUa_NotificationMessage_Clear(&Message);
+
+    /* the rest goes out at once, since the subscription is late */
+    uStatus = UaTest_Subscription_Publish(1, &uSubscriptionId, &Message, &bMoreNotifications, &uAckResult);
+    OpcUa_GotoErrorIfBad(uStatus);
+    UATEST_CHECK(uAckResult == OpcUa_Good);
+    UATEST_CHECK(Message.SequenceNumber == 2);
+    UATEST_CHECK(bMoreNotifications == OpcUa_False);
+    pNotification = UaTest_Subscription_GetChanges(&Message, 1);
+    UATEST_CHECK(pNotification != OpcUa_Null);
+    UATEST_CHECK(pNotification->MonitoredItems[0].ClientHandle == UATEST_SUBSCRIPTION_CLIENTHANDLE + 2);
+
+    pDataValue = &pNotification->MonitoredItems[0].Value;
+    UATEST_CHECK(pDataValue->SourceTimestamp.dwLowDateTime == 3);
+    UATEST_CHECK(pDataValue->Value.Datatype == OpcUaType_String);
+    UATEST_CHECK(pDataValue->Value.ArrayType == OpcUa_VariantArrayType_Array);
+    UATEST_CHECK(pDataValue->Value.Value.Array.Length == 3);
+    UATEST_CHECK(OpcUa_StrCmpA(OpcUa_String_GetRawString(&pDataValue->Value.Value.Array.Value.StringArray[0]), "UaTest") == 0);
+    UATEST_CHECK(OpcUa_String_IsNull(&pDataValue->Value.Value.Array.Value.StringArray[1]));
+    UATEST_CHECK(OpcUa_String_StrLen(&pDataValue->Value.Value.Array.Value.StringArray[2]) == 0);
+    OpcUa_NotificationMessage_Clear(&Message);
+
+    /* both bodies went out with the size they were encoded with */
+    UATEST_CHECK(OpcUa_Atomic_Load32(&pTest->uNoOfBodies) == 2);
+    UATEST_CHECK(OpcUa_Atomic_Load32(&pTest->uNoOfBodySizeErrors) == 0);
+
+    uStatus = UaTest_Subscription_Delete();
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    UaTest_Subscription_Clear();
+    OpcUa_MemCpy(pValues, sizeof(aSaved), aSaved, sizeof(aSaved));
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_NotificationMessage_Clear(&Message);
+    UaTest_Subscription_Clear();
+    OpcUa_MemCpy(pValues, sizeof(aSaved), aSaved, sizeof(aSaved));
+
+OpcUa_FinishErrorHandling;
+}
+
+#endif /* OPCUA_HAVE_CLIENTAPI && OPCUA_HAVE_SERVERAPI */
+
+/*============================================================================
+ * Case table
+ *===========================================================================*/
+UaTest_Case UaTest_g_SubscriptionCases[] =
+{
+#if defined(OPCUA_HAVE_CLIENTAPI) && defined(OPCUA_HAVE_SERVERAPI)
+    { "sample/subscriptions/publish",  UaTest_Subscription_PublishRoundTrip },
+    { "sample/subscriptions/batch",    UaTest_Subscription_PublishBatch },
+#endif /* OPCUA_HAVE_CLIENTAPI && OPCUA_HAVE_SERVERAPI */
+    UATEST_CASE_END
+};
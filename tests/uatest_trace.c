@@ -0,0 +1,369 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+
+/******************************************************************************************************/
+/* Tests for the trace: inactive levels skip the arguments, records of the asynchronous trace reach  */
+/* the trace device whole and in order, and threads which start after others ended take over their   */
+/* buffers.                                                                                          */
+/******************************************************************************************************/
+
+#include <opcua.h>
+#include <opcua_thread.h>
+#include <opcua_p_interface.h>
+
+#include "uatest.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if OPCUA_TRACE_ENABLE
+
+/*============================================================================
+ * Types and constants
+ *===========================================================================*/
+/** @brief Trace level of the test records; the stack does not trace with it. The async cases
+ *         need it in OPCUA_TRACE_COMPILE_LEVEL. */
+#define UATEST_TRACE_LEVEL          OPCUA_TRACE_LEVEL_YOURTRACELEVEL
+/** @brief Milliseconds to wait for the trace writer. */
+#define UATEST_TRACE_TIMEOUT        10000
+
+/*============================================================================
+ * Globals
+ *===========================================================================*/
+extern OpcUa_P_TraceHook    g_OpcUa_P_TraceHook;
+
+static OpcUa_UInt32         UaTest_g_uNoOfTraceLines        = 0;
+static OpcUa_UInt32         UaTest_g_uNoOfTraceErrors       = 0;
+/** @brief Arguments of the level test evaluated so far. */
+static OpcUa_UInt32         UaTest_g_uNoOfTraceArguments    = 0;
+
+/*============================================================================
+ * UaTest_Trace_LevelHook
+ *===========================================================================*/
+static OpcUa_Void OPCUA_DLLCALL UaTest_Trace_LevelHook(OpcUa_CharA* a_sMessage)
+{
+    unsigned int uArgument = 0;
+
+    if(sscanf(a_sMessage, "UaTest level %u", &uArgument) != 1)
+    {
+        return;
+    }
+
+    if(uArgument != UaTest_g_uNoOfTraceArguments)
+    {
+        OpcUa_Atomic_Add32(&UaTest_g_uNoOfTraceErrors, 1);
+    }
+    OpcUa_Atomic_Add32(&UaTest_g_uNoOfTraceLines, 1);
+}
+
+/*============================================================================
+ * UaTest_Trace_Enable
+ *===========================================================================*/
+/* only the test level reaches the hook */
+static OpcUa_Void UaTest_Trace_Enable(OpcUa_P_TraceHook a_pfnHook)
+{
+    UaTest_g_uNoOfTraceLines  = 0;
+    UaTest_g_uNoOfTraceErrors = 0;
+    g_OpcUa_P_TraceHook = a_pfnHook;
+    OpcUa_Trace_ChangeTraceLevel(UATEST_TRACE_LEVEL);
+    OpcUa_Trace_Toggle(OpcUa_True);
+}
+
+/*============================================================================
+ * UaTest_Trace_Disable
+ *===========================================================================*/
+static OpcUa_Void UaTest_Trace_Disable(OpcUa_Void)
+{
+    OpcUa_Trace_Toggle(OpcUa_False);
+    OpcUa_Trace_ChangeTraceLevel(OPCUA_TRACE_OUTPUT_LEVEL_NONE);
+    g_OpcUa_P_TraceHook = OpcUa_Null;
+}
+
+/*============================================================================
+ * UaTest_Trace_WaitForLines
+ *===========================================================================*/
+static OpcUa_Boolean UaTest_Trace_WaitForLines(OpcUa_UInt32 a_uNoOfLines)
+{
+    OpcUa_UInt32 uWaited = 0;
+
+    while(OpcUa_Atomic_Load32(&UaTest_g_uNoOfTraceLines) < a_uNoOfLines)
+    {
+        if(uWaited >= UATEST_TRACE_TIMEOUT)
+        {
+            return OpcUa_False;
+        }
+        OpcUa_Thread_Sleep(10);
+        uWaited += 10;
+    }
+    return OpcUa_True;
+}
+
+/*============================================================================
+ * UaTest_Trace_NextArgument
+ *===========================================================================*/
+static OpcUa_UInt32 UaTest_Trace_NextArgument(OpcUa_Void)
+{
+    return ++UaTest_g_uNoOfTraceArguments;
+}
+
+/*============================================================================
+ * UaTest_Trace_Level
+ *===========================================================================*/
+/* only an active level evaluates the arguments; toggle and level both update the active levels */
+static OpcUa_StatusCode UaTest_Trace_Level(OpcUa_Void)
+{
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Trace_Level");
+
+    UaTest_g_uNoOfTraceArguments = 0;
+
+    UaTest_Trace_Enable(UaTest_Trace_LevelHook);
+    UATEST_CHECK(OpcUa_Trace_g_uActiveLevels == (UATEST_TRACE_LEVEL & (OPCUA_TRACE_COMPILE_LEVEL)));
+
+    OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "UaTest level %u\n", UaTest_Trace_NextArgument());
+    UATEST_CHECK(UaTest_g_uNoOfTraceArguments == 0);
+
+    OpcUa_Trace(UATEST_TRACE_LEVEL, "UaTest level %u\n", UaTest_Trace_NextArgument());
+#if (OPCUA_TRACE_COMPILE_LEVEL) & UATEST_TRACE_LEVEL
+    UATEST_CHECK(UaTest_g_uNoOfTraceArguments == 1);
+    UATEST_CHECK(UaTest_Trace_WaitForLines(1));
+    UATEST_CHECK(UaTest_g_uNoOfTraceErrors == 0);
+#else /* (OPCUA_TRACE_COMPILE_LEVEL) & UATEST_TRACE_LEVEL */
+    UATEST_CHECK(UaTest_g_uNoOfTraceArguments == 0);
+#endif /* (OPCUA_TRACE_COMPILE_LEVEL) & UATEST_TRACE_LEVEL */
+
+    OpcUa_Trace_Toggle(OpcUa_False);
+    UATEST_CHECK(OpcUa_Trace_g_uActiveLevels == OPCUA_TRACE_OUTPUT_LEVEL_NONE);
+    UaTest_g_uNoOfTraceArguments = 0;
+    OpcUa_Trace(UATEST_TRACE_LEVEL, "UaTest level %u\n", UaTest_Trace_NextArgument());
+    UATEST_CHECK(UaTest_g_uNoOfTraceArguments == 0);
+
+    OpcUa_Trace_Toggle(OpcUa_True);
+    OpcUa_Trace_ChangeTraceLevel(OPCUA_TRACE_OUTPUT_LEVEL_NONE);
+    UATEST_CHECK(OpcUa_Trace_g_uActiveLevels == OPCUA_TRACE_OUTPUT_LEVEL_NONE);
+    OpcUa_Trace(UATEST_TRACE_LEVEL, "UaTest level %u\n", UaTest_Trace_NextArgument());
+    UATEST_CHECK(UaTest_g_uNoOfTraceArguments == 0);
+
+    UaTest_Trace_Disable();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_Trace_Disable();
+
+OpcUa_FinishErrorHandling;
+}
+
+#if OPCUA_TRACE_ASYNC && OPCUA_MULTITHREADED && ((OPCUA_TRACE_COMPILE_LEVEL) & UATEST_TRACE_LEVEL)
+/** @brief Records traced by the thread of the order test. */
+#define UATEST_TRACE_RECORDS        (OPCUA_TRACE_ASYNC_RECORDS / 4)
+/** @brief Threads started at once by the reclaim test; twice as many are started in total. */
+#define UATEST_TRACE_WAVE           (OPCUA_TRACE_ASYNC_MAXTHREADS / 2)
+#define UATEST_TRACE_THREADS        (2 * OPCUA_TRACE_ASYNC_MAXTHREADS)
+
+typedef struct _UaTest_TraceThread
+{
+    OpcUa_Thread    hThread;
+    OpcUa_UInt32    uIndex;
+    OpcUa_UInt32    uThreadId;
+} UaTest_TraceThread;
+
+static UaTest_TraceThread   UaTest_g_aTraceThreads[UATEST_TRACE_THREADS];
+/** @brief Thread which passed line i to the trace device. */
+static OpcUa_UInt32         UaTest_g_auTraceWriters[UATEST_TRACE_THREADS];
+/** @brief Lines the trace device received, in order. */
+static OpcUa_UInt32         UaTest_g_auTraceLines[UATEST_TRACE_RECORDS];
+/** @brief String argument of the order test; fills most of a trace line. */
+static OpcUa_CharA          UaTest_g_sTraceText[OPCUA_TRACE_MAXLENGTH - 32];
+
+/*============================================================================
+ * UaTest_Trace_OrderHook
+ *===========================================================================*/
+/* only the trace writer calls the hook, so no lock is needed */
+static OpcUa_Void OPCUA_DLLCALL UaTest_Trace_OrderHook(OpcUa_CharA* a_sMessage)
+{
+    unsigned int    uLine   = 0;
+    int             iLength = 0;
+
+    if(sscanf(a_sMessage, "UaTest order %u %n", &uLine, &iLength) != 1)
+    {
+        return;
+    }
+
+    if(    UaTest_g_uNoOfTraceLines >= UATEST_TRACE_RECORDS
+        || strcmp(a_sMessage + iLength, UaTest_g_sTraceText) != 0)
+    {
+        UaTest_g_uNoOfTraceErrors++;
+    }
+    else
+    {
+        UaTest_g_auTraceLines[UaTest_g_uNoOfTraceLines] = uLine;
+    }
+    OpcUa_Atomic_Store32(&UaTest_g_uNoOfTraceLines, UaTest_g_uNoOfTraceLines + 1);
+}
+
+/*============================================================================
+ * UaTest_Trace_ReclaimHook
+ *===========================================================================*/
+static OpcUa_Void OPCUA_DLLCALL UaTest_Trace_ReclaimHook(OpcUa_CharA* a_sMessage)
+{
+    unsigned int uIndex = 0;
+
+    if(sscanf(a_sMessage, "UaTest reclaim %u", &uIndex) != 1)
+    {
+        return;
+    }
+
+    if(uIndex >= UATEST_TRACE_THREADS || UaTest_g_auTraceWriters[uIndex] != 0)
+    {
+        OpcUa_Atomic_Add32(&UaTest_g_uNoOfTraceErrors, 1);
+        return;
+    }
+    UaTest_g_auTraceWriters[uIndex] = OpcUa_Thread_GetCurrentThreadId();
+    OpcUa_Atomic_Add32(&UaTest_g_uNoOfTraceLines, 1);
+}
+
+/*============================================================================
+ * UaTest_Trace_Order
+ *===========================================================================*/
+/* the lines of one thread arrive in order, with their string arguments uncut */
+static OpcUa_StatusCode UaTest_Trace_Order(OpcUa_Void)
+{
+    OpcUa_UInt32 uLine = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Trace_Order");
+
+    memset(UaTest_g_sTraceText, 'x', sizeof(UaTest_g_sTraceText) - 1);
+    UaTest_g_sTraceText[sizeof(UaTest_g_sTraceText) - 1] = '\0';
+
+    UaTest_Trace_Enable(UaTest_Trace_OrderHook);
+
+    for(uLine = 0; uLine < UATEST_TRACE_RECORDS; uLine++)
+    {
+        OpcUa_Trace(UATEST_TRACE_LEVEL, "UaTest order %u %s", uLine, UaTest_g_sTraceText);
+    }
+
+    UATEST_CHECK(UaTest_Trace_WaitForLines(UATEST_TRACE_RECORDS));
+    UATEST_CHECK(UaTest_g_uNoOfTraceLines == UATEST_TRACE_RECORDS);
+    UATEST_CHECK(UaTest_g_uNoOfTraceErrors == 0);
+    for(uLine = 0; uLine < UATEST_TRACE_RECORDS; uLine++)
+    {
+        UATEST_CHECK(UaTest_g_auTraceLines[uLine] == uLine);
+    }
+
+    UaTest_Trace_Disable();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    UaTest_Trace_Disable();
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * UaTest_Trace_Tracer
+ *===========================================================================*/
+static OpcUa_Void UaTest_Trace_Tracer(OpcUa_Void* a_pArgument)
+{
+    UaTest_TraceThread* pThread = (UaTest_TraceThread*)a_pArgument;
+
+    pThread->uThreadId = OpcUa_Thread_GetCurrentThreadId();
+    OpcUa_Trace(UATEST_TRACE_LEVEL, "UaTest reclaim %u\n", pThread->uIndex);
+}
+
+/*============================================================================
+ * UaTest_Trace_Reclaim
+ *===========================================================================*/
+/* twice as many threads as there are buffers trace one after another, all through the writer */
+static OpcUa_StatusCode UaTest_Trace_Reclaim(OpcUa_Void)
+{
+    UaTest_TraceThread* pThread = OpcUa_Null;
+    OpcUa_UInt32        uFirst  = 0;
+    OpcUa_UInt32        i       = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "Trace_Reclaim");
+
+    memset(UaTest_g_aTraceThreads, 0, sizeof(UaTest_g_aTraceThreads));
+    memset(UaTest_g_auTraceWriters, 0, sizeof(UaTest_g_auTraceWriters));
+
+    UaTest_Trace_Enable(UaTest_Trace_ReclaimHook);
+
+    for(uFirst = 0; uFirst < UATEST_TRACE_THREADS; uFirst += UATEST_TRACE_WAVE)
+    {
+        for(i = uFirst; i < uFirst + UATEST_TRACE_WAVE; i++)
+        {
+            pThread = &UaTest_g_aTraceThreads[i];
+            pThread->uIndex = i;
+            uStatus = OpcUa_Thread_Create(&pThread->hThread, UaTest_Trace_Tracer, pThread);
+            OpcUa_GotoErrorIfBad(uStatus);
+            uStatus = OpcUa_Thread_Start(pThread->hThread);
+            OpcUa_GotoErrorIfBad(uStatus);
+        }
+        for(i = uFirst; i < uFirst + UATEST_TRACE_WAVE; i++)
+        {
+            OpcUa_Thread_WaitForShutdown(UaTest_g_aTraceThreads[i].hThread, OPCUA_INFINITE);
+            OpcUa_Thread_Delete(&UaTest_g_aTraceThreads[i].hThread);
+        }
+
+        /* the writer has emptied the buffers of the wave before the next one starts */
+        UATEST_CHECK(UaTest_Trace_WaitForLines(uFirst + UATEST_TRACE_WAVE));
+    }
+
+    /* a thread without buffer would have passed its line to the device itself */
+    UATEST_CHECK(UaTest_g_uNoOfTraceErrors == 0);
+    for(i = 0; i < UATEST_TRACE_THREADS; i++)
+    {
+        UATEST_CHECK(UaTest_g_auTraceWriters[i] != 0);
+        UATEST_CHECK(UaTest_g_auTraceWriters[i] != UaTest_g_aTraceThreads[i].uThreadId);
+    }
+
+    UaTest_Trace_Disable();
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    for(i = 0; i < UATEST_TRACE_THREADS; i++)
+    {
+        if(UaTest_g_aTraceThreads[i].hThread != OpcUa_Null)
+        {
+            OpcUa_Thread_WaitForShutdown(UaTest_g_aTraceThreads[i].hThread, OPCUA_INFINITE);
+            OpcUa_Thread_Delete(&UaTest_g_aTraceThreads[i].hThread);
+        }
+    }
+    UaTest_Trace_Disable();
+
+OpcUa_FinishErrorHandling;
+}
+
+#endif /* OPCUA_TRACE_ASYNC && OPCUA_MULTITHREADED && ((OPCUA_TRACE_COMPILE_LEVEL) & UATEST_TRACE_LEVEL) */
+
+#endif /* OPCUA_TRACE_ENABLE */
+
+/*============================================================================
+ * Case table
+ *===========================================================================*/
+UaTest_Case UaTest_g_TraceCases[] =
+{
+#if OPCUA_TRACE_ENABLE
+    { "stack/trace/level/arguments",    UaTest_Trace_Level },
+#if OPCUA_TRACE_ASYNC && OPCUA_MULTITHREADED && ((OPCUA_TRACE_COMPILE_LEVEL) & UATEST_TRACE_LEVEL)
+    { "stack/trace/async/order",        UaTest_Trace_Order },
+    { "stack/trace/async/reclaim",      UaTest_Trace_Reclaim },
+#endif /* OPCUA_TRACE_ASYNC && OPCUA_MULTITHREADED && ((OPCUA_TRACE_COMPILE_LEVEL) & UATEST_TRACE_LEVEL) */
+#endif /* OPCUA_TRACE_ENABLE */
+    UATEST_CASE_END
+};
@@ -0,0 +1,273 @@
+/* Copyright (c) 1996-2018, OPC Foundation. All rights reserved.
+
+   The source code in this file is covered under a dual-license scenario:
+     - RCL: for OPC Foundation members in good-standing
+     - GPL V2: everybody else
+
+   RCL license terms accompanied with this source code. See http://opcfoundation.org/License/RCL/1.00/
+
+   GNU General Public License as published by the Free Software Foundation;
+   version 2 of the License are accompanied with this source code. See http://opcfoundation.org/License/GPLv2
+
+   This source code is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+/******************************************************************************************************/
+/* Tests for the value store of the sample server: consistent reads under concurrent writers.        */
+/******************************************************************************************************/
+
+#include <opcua_serverstub.h>
+#include <opcua_memory.h>
+#include <opcua_thread.h>
+
+#include "addressspace.h"
+#include "valuestore.h"
+
+#include "uatest.h"
+
+/*============================================================================
+ * Types and constants
+ *===========================================================================*/
+/** @brief Index of the value the threads share. */
+#define UATEST_VALUE_INDEX          0
+/** @brief Elements of the array the writers change in place. */
+#define UATEST_VALUE_ELEMENTS       16
+/** @brief Writes done by each writer. */
+#define UATEST_VALUE_WRITES         200000
+#define UATEST_VALUE_WRITERS        2
+#define UATEST_VALUE_READERS        2
+
+typedef struct _UaTest_ValueThread
+{
+    OpcUa_Thread    hThread;
+    OpcUa_UInt32    uFirst;
+    OpcUa_UInt32    uNoOfReads;
+    OpcUa_UInt32    uNoOfErrors;
+} UaTest_ValueThread;
+
+/*============================================================================
+ * Globals
+ *===========================================================================*/
+extern my_Variant           all_ValueAttribute_of_VariableTypeNodes_VariableNodes[];
+
+static OpcUa_Double         UaTest_g_aValueElements[UATEST_VALUE_ELEMENTS];
+static OpcUa_UInt32         UaTest_g_uNoOfWritersDone = 0;
+
+/*============================================================================
+ * UaTest_ValueStore_Write
+ *===========================================================================*/
+/* value k: 1 + k % UATEST_VALUE_ELEMENTS elements of k, source timestamp k */
+static OpcUa_Void UaTest_ValueStore_Write(OpcUa_UInt32 a_uValue)
+{
+    my_Variant*     pValue  = &all_ValueAttribute_of_VariableTypeNodes_VariableNodes[UATEST_VALUE_INDEX];
+    OpcUa_DateTime  SourceTimestamp;
+    OpcUa_Int32     i       = 0;
+
+    OpcUa_MemSet(&SourceTimestamp, 0, sizeof(SourceTimestamp));
+    SourceTimestamp.dwLowDateTime = a_uValue;
+
+    write_value_begin(UATEST_VALUE_INDEX);
+    pValue->Value.Array.Length = 1 + (OpcUa_Int32)(a_uValue % UATEST_VALUE_ELEMENTS);
+    for(i = 0; i < pValue->Value.Array.Length; i++)
+    {
+        pValue->Value.Array.Value.DoubleArray[i] = (OpcUa_Double)a_uValue;
+    }
+    write_value_end(UATEST_VALUE_INDEX, &SourceTimestamp);
+}
+
+/*============================================================================
+ * UaTest_ValueStore_Check
+ *===========================================================================*/
+/* OpcUa_True if the copy is one value as UaTest_ValueStore_Write left it */
+static OpcUa_Boolean UaTest_ValueStore_Check(   const my_Variant*       a_pValue,
+                                                const _ValueVersion_*   a_pVersion)
+{
+    OpcUa_UInt32    uValue  = 0;
+    OpcUa_Int32     i       = 0;
+
+    if(    (a_pVersion->Sequence & 1) != 0
+        || a_pValue->Datatype != OpcUaId_Double
+        || a_pValue->ArrayType != OpcUa_VariantArrayType_Array
+        || a_pValue->Value.Array.Length < 1
+        || a_pValue->Value.Array.Length > UATEST_VALUE_ELEMENTS
+        || a_pValue->Value.Array.Value.DoubleArray == UaTest_g_aValueElements)
+    {
+        return OpcUa_False;
+    }
+
+    uValue = (OpcUa_UInt32)a_pValue->Value.Array.Value.DoubleArray[0];
+    if(    a_pValue->Value.Array.Length != 1 + (OpcUa_Int32)(uValue % UATEST_VALUE_ELEMENTS)
+        || a_pVersion->SourceTimestamp.dwLowDateTime != uValue)
+    {
+        return OpcUa_False;
+    }
+    for(i = 1; i < a_pValue->Value.Array.Length; i++)
+    {
+        if(a_pValue->Value.Array.Value.DoubleArray[i] != (OpcUa_Double)uValue)
+        {
+            return OpcUa_False;
+        }
+    }
+    return OpcUa_True;
+}
+
+/*============================================================================
+ * UaTest_ValueStore_Writer
+ *===========================================================================*/
+static OpcUa_Void UaTest_ValueStore_Writer(OpcUa_Void* a_pArgument)
+{
+    UaTest_ValueThread* pThread = (UaTest_ValueThread*)a_pArgument;
+    OpcUa_UInt32        j       = 0;
+
+    for(j = 0; j < UATEST_VALUE_WRITES; j++)
+    {
+        UaTest_ValueStore_Write(pThread->uFirst + j * UATEST_VALUE_WRITERS);
+    }
+    OpcUa_Atomic_Add32(&UaTest_g_uNoOfWritersDone, 1);
+}
+
+/*============================================================================
+ * UaTest_ValueStore_Reader
+ *===========================================================================*/
+/* reads until the writers are done, and once more after that */
+static OpcUa_Void UaTest_ValueStore_Reader(OpcUa_Void* a_pArgument)
+{
+    UaTest_ValueThread* pThread = (UaTest_ValueThread*)a_pArgument;
+    my_Variant          Value;
+    _ValueVersion_      Version;
+    OpcUa_Boolean       bDone   = OpcUa_False;
+
+    while(bDone == OpcUa_False)
+    {
+        bDone = (OpcUa_Boolean)(OpcUa_Atomic_Load32(&UaTest_g_uNoOfWritersDone) == UATEST_VALUE_WRITERS);
+
+        if(OpcUa_IsBad(read_value(UATEST_VALUE_INDEX, &Value, &Version)))
+        {
+            pThread->uNoOfErrors++;
+            continue;
+        }
+        if(UaTest_ValueStore_Check(&Value, &Version) == OpcUa_False)
+        {
+            pThread->uNoOfErrors++;
+        }
+        pThread->uNoOfReads++;
+        clear_value(&Value);
+    }
+}
+
+/*============================================================================
+ * UaTest_ValueStore_ConsistentReads
+ *===========================================================================*/
+/* readers see whole values while writers change an array in place */
+static OpcUa_StatusCode UaTest_ValueStore_ConsistentReads(OpcUa_Void)
+{
+    my_Variant*         pValue  = &all_ValueAttribute_of_VariableTypeNodes_VariableNodes[UATEST_VALUE_INDEX];
+    my_Variant          Saved   = *pValue;
+    UaTest_ValueThread  aWriters[UATEST_VALUE_WRITERS];
+    UaTest_ValueThread  aReaders[UATEST_VALUE_READERS];
+    OpcUa_UInt32        uVersion = 0;
+    OpcUa_Int           i       = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_TestModule, "ValueStore_ConsistentReads");
+
+    OpcUa_MemSet(aWriters, 0, sizeof(aWriters));
+    OpcUa_MemSet(aReaders, 0, sizeof(aReaders));
+    UaTest_g_uNoOfWritersDone = 0;
+
+    initialize_value_store();
+    pValue->Datatype                    = OpcUaId_Double;
+    pValue->ArrayType                   = OpcUa_VariantArrayType_Array;
+    pValue->Value.Array.Value.DoubleArray = UaTest_g_aValueElements;
+    UaTest_ValueStore_Write(0);
+
+    /* a write moves the version by two and keeps it odd in between */
+    uVersion = value_version(UATEST_VALUE_INDEX);
+    UATEST_CHECK(uVersion == 2);
+    write_value_begin(UATEST_VALUE_INDEX);
+    UATEST_CHECK(value_version(UATEST_VALUE_INDEX) == 3);
+    write_value_end(UATEST_VALUE_INDEX, OpcUa_Null);
+    UATEST_CHECK(value_version(UATEST_VALUE_INDEX) == 4);
+    UaTest_ValueStore_Write(0);
+
+    for(i = 0; i < UATEST_VALUE_READERS; i++)
+    {
+        uStatus = OpcUa_Thread_Create(&aReaders[i].hThread, UaTest_ValueStore_Reader, &aReaders[i]);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+    for(i = 0; i < UATEST_VALUE_WRITERS; i++)
+    {
+        aWriters[i].uFirst = (OpcUa_UInt32)i + 1;
+        uStatus = OpcUa_Thread_Create(&aWriters[i].hThread, UaTest_ValueStore_Writer, &aWriters[i]);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+    for(i = 0; i < UATEST_VALUE_READERS; i++)
+    {
+        uStatus = OpcUa_Thread_Start(aReaders[i].hThread);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+    for(i = 0; i < UATEST_VALUE_WRITERS; i++)
+    {
+        uStatus = OpcUa_Thread_Start(aWriters[i].hThread);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+    for(i = 0; i < UATEST_VALUE_WRITERS; i++)
+    {
+        OpcUa_Thread_WaitForShutdown(aWriters[i].hThread, OPCUA_INFINITE);
+    }
+    for(i = 0; i < UATEST_VALUE_READERS; i++)
+    {
+        OpcUa_Thread_WaitForShutdown(aReaders[i].hThread, OPCUA_INFINITE);
+        UATEST_CHECK(aReaders[i].uNoOfErrors == 0);
+        UATEST_CHECK(aReaders[i].uNoOfReads > 0);
+    }
+
+    /* no write got lost between the writers */
+    UATEST_CHECK(value_version(UATEST_VALUE_INDEX) == 6 + 2 * UATEST_VALUE_WRITERS * UATEST_VALUE_WRITES);
+
+    for(i = 0; i < UATEST_VALUE_WRITERS; i++)
+    {
+        OpcUa_Thread_Delete(&aWriters[i].hThread);
+    }
+    for(i = 0; i < UATEST_VALUE_READERS; i++)
+    {
+        OpcUa_Thread_Delete(&aReaders[i].hThread);
+    }
+    *pValue = Saved;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    /* threads that were started have to end before the value goes away */
+    OpcUa_Atomic_Store32(&UaTest_g_uNoOfWritersDone, UATEST_VALUE_WRITERS);
+    for(i = 0; i < UATEST_VALUE_WRITERS; i++)
+    {
+        if(aWriters[i].hThread != OpcUa_Null)
+        {
+            OpcUa_Thread_WaitForShutdown(aWriters[i].hThread, OPCUA_INFINITE);
+            OpcUa_Thread_Delete(&aWriters[i].hThread);
+        }
+    }
+    for(i = 0; i < UATEST_VALUE_READERS; i++)
+    {
+        if(aReaders[i].hThread != OpcUa_Null)
+        {
+            OpcUa_Thread_WaitForShutdown(aReaders[i].hThread, OPCUA_INFINITE);
+            OpcUa_Thread_Delete(&aReaders[i].hThread);
+        }
+    }
+    *pValue = Saved;
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * Case table
+ *===========================================================================*/
+UaTest_Case UaTest_g_ValueStoreCases[] =
+{
+    { "sample/valuestore/consistentreads",  UaTest_ValueStore_ConsistentReads },
+    UATEST_CASE_END
+};